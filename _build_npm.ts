@@ -10,7 +10,12 @@ console.log("🦕 Building NPM package from Deno source using dnt...");
 await emptyDir("./npm");
 
 await build({
-  entryPoints: ["./src/lib/index.ts"],
+  entryPoints: [
+    "./src/lib/index.ts",
+    { name: "./inflate", path: "./src/lib/inflate.ts" },
+    { name: "./deflate", path: "./src/lib/deflate.ts" },
+    { name: "./node", path: "./src/lib/node.ts" },
+  ],
   outDir: "./npm",
   shims: {
     deno: true,
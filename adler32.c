@@ -7,6 +7,10 @@
 
 #include "zutil.h"
 
+#ifdef __wasm_simd128__
+#  include "src/zlib_simd.h"
+#endif
+
 #define BASE 65521U     /* largest prime smaller than 65536 */
 #define NMAX 5552
 /* NMAX is the largest n such that 255n(n+1)/2 + (n+1)(BASE-1) <= 2^32-1 */
@@ -93,6 +97,13 @@ uLong ZEXPORT adler32_z(uLong adler, const Bytef *buf, z_size_t len) {
         return adler | (sum2 << 16);
     }
 
+#ifdef __wasm_simd128__
+    /* long runs go to the vectorized kernel, which does its own NMAX
+       blocking and modulo reduction */
+    if (len >= 64)
+        return zlib_adler32_simd((uint32_t)(adler | (sum2 << 16)), buf, len);
+#endif
+
     /* do length NMAX blocks -- requires just one modulo operation */
     while (len >= NMAX) {
         len -= NMAX;
@@ -126,7 +137,10 @@ uLong ZEXPORT adler32_z(uLong adler, const Bytef *buf, z_size_t len) {
 
 /* ========================================================================= */
 uLong ZEXPORT adler32(uLong adler, const Bytef *buf, uInt len) {
-    return adler32_z(adler, buf, len);
+    ZSTATS_BEGIN(ZSTATS_ADLER32);
+    adler = adler32_z(adler, buf, len);
+    ZSTATS_END(ZSTATS_ADLER32, len);
+    return adler;
 }
 
 /* ========================================================================= */
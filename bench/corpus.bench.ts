@@ -0,0 +1,648 @@
+/**
+ * zlib.wasm Corpus Benchmarks - every level and strategy over real data
+ * Run with: deno task benchmark:corpus [options]
+ *
+ *   --fetch               Download missing standard corpora into the cache
+ *   --cache <dir>         Corpus cache (default bench/.corpora)
+ *   --corpus <dir>        Add a directory of user files (repeatable)
+ *   --only <names>        Standard corpora to run: canterbury,silesia,enwik8
+ *   --levels <list>       Levels, e.g. 1,6,9 (default 0-10)
+ *   --strategies <list>   Strategy names (default all)
+ *   --max-size <MB>       Skip files larger than this (default 256)
+ *   --min-runs <n>        Runs per measurement, at least (default 5)
+ *   --min-time <ms>       Time per measurement, at least (default 1000)
+ *   --out <file>          JSON report (default bench/corpus-results.json, - for stdout)
+ *   --compare <file>      Report of bench/native/corpus_bench.c to set against
+ *   --ab                  Also run everything on the scalar build, for SIMD speedups
+ *   --baseline <file>     Earlier report of this suite to check for regressions against
+ *   --max-regression <%>  Slowdown per kernel that fails --baseline (default 10)
+ *
+ * Each file goes through createDeflateStream()/createInflateStream(), the
+ * one path that takes both a level and a strategy, in 1 MB chunks. A
+ * measurement is whole-file runs repeated until both --min-runs and
+ * --min-time are met; throughput is bytes over total time, and p50/p99 are
+ * per-run latencies. The first run is checked to round-trip. crc32() and
+ * adler32() are timed the same way per file.
+ *
+ * The native build of the same kernels (cmake -DZLIB_BUILD_BENCHMARK=ON,
+ * then zlib_corpus_bench) takes the same options and writes results and
+ * kernels entries in the same layout. With --compare, each entry found in
+ * both gets nativeMBps and wasmTax, native over WASM throughput, and the
+ * tax per kernel over everything is printed.
+ *
+ * --ab loads zlib-release-scalar.js (./build-dual.sh scalar), the same
+ * sources, flags and exports built without -msimd128, next to the SIMD
+ * build, and measures every file, level and strategy on both in turn.
+ * Each entry gets scalarMBps and simdSpeedup, SIMD over scalar throughput,
+ * sameOutput when both builds produced the very same deflate stream, and
+ * the speedup per kernel over everything is printed.
+ *
+ * --baseline sets this run against a stored report from the same host
+ * class, pairing entries as --compare does: each gets baselineMBps and
+ * speedup, current over baseline throughput. The speedup per kernel
+ * (crc32, adler32, inflate, deflate per level and strategy) over every
+ * shared entry is what is judged, so one noisy file does not fail a run.
+ * A kernel that lost more than --max-regression percent fails the run
+ * after the report is written, as does a baseline sharing no entries.
+ * bench/kernels.fuzz.ts checks the same builds for bit-exact output.
+ */
+
+import Zlib, { ZlibCompression, ZlibStrategy } from "../src/lib/index.ts";
+
+const CHUNK_SIZE = 1024 * 1024;
+const MB = 1024 * 1024;
+
+interface CorpusFile {
+  corpus: string;
+  name: string;
+  data: Uint8Array;
+}
+
+interface Measurement {
+  runs: number;
+  totalMs: number;
+  p50Ms: number;
+  p99Ms: number;
+  mbPerSec: number;
+}
+
+interface Kernels {
+  corpus: string;
+  file: string;
+  size: number;
+  crc32: Measurement;
+  adler32: Measurement;
+}
+
+interface Result {
+  corpus: string;
+  file: string;
+  size: number;
+  level: number;
+  strategy: string;
+  compressedSize: number;
+  // crc32() of the compressed stream, to tell whether two builds agree
+  compressedCrc32: number;
+  ratio: number;
+  compress: Measurement;
+  decompress: Measurement;
+}
+
+const STRATEGIES: Record<string, ZlibStrategy> = {
+  default: ZlibStrategy.DEFAULT_STRATEGY,
+  filtered: ZlibStrategy.FILTERED,
+  huffman: ZlibStrategy.HUFFMAN_ONLY,
+  rle: ZlibStrategy.RLE,
+  fixed: ZlibStrategy.FIXED,
+  quick: ZlibStrategy.QUICK,
+  medium: ZlibStrategy.MEDIUM
+};
+
+// Standard corpora, and how to get their files out of the download
+const STANDARD_CORPORA = {
+  canterbury: {
+    url: "https://corpus.canterbury.ac.nz/resources/cantrbry.tar.gz",
+    unpack: "tar.gz"
+  },
+  silesia: {
+    url: "https://sun.aei.polsl.pl/~sdeor/corpus/silesia.zip",
+    unpack: "zip",
+    names: [
+      "dickens", "mozilla", "mr", "nci", "ooffice", "osdb",
+      "reymont", "samba", "sao", "webster", "x-ray", "xml"
+    ]
+  },
+  enwik8: {
+    url: "https://mattmahoney.net/dc/enwik8.zip",
+    unpack: "zip",
+    names: ["enwik8"],
+    // Prefix slices, so size effects show on the same text
+    slices: [1 * MB, 10 * MB, 100_000_000]
+  }
+} as const;
+
+type CorpusName = keyof typeof STANDARD_CORPORA;
+
+interface Options {
+  fetch: boolean;
+  cache: string;
+  corpora: string[];
+  only: CorpusName[];
+  levels: number[];
+  strategies: string[];
+  maxSize: number;
+  minRuns: number;
+  minTime: number;
+  out: string;
+  compare?: string;
+  ab: boolean;
+  baseline?: string;
+  maxRegression: number;
+}
+
+function parseArgs(args: string[]): Options {
+  const options: Options = {
+    fetch: false,
+    cache: "bench/.corpora",
+    corpora: [],
+    only: Object.keys(STANDARD_CORPORA) as CorpusName[],
+    levels: [0, 1, 2, 3, 4, 5, 6, 7, 8, 9, ZlibCompression.ULTRA_COMPRESSION],
+    strategies: Object.keys(STRATEGIES),
+    maxSize: 256 * MB,
+    minRuns: 5,
+    minTime: 1000,
+    out: "bench/corpus-results.json",
+    ab: false,
+    maxRegression: 10
+  };
+
+  const list = (value: string) => value.split(",").map(s => s.trim()).filter(Boolean);
+  for (let i = 0; i < args.length; i++) {
+    const arg = args[i];
+    const value = () => {
+      if (i + 1 >= args.length) throw new Error(`${arg} needs a value`);
+      return args[++i];
+    };
+    switch (arg) {
+      case "--fetch": options.fetch = true; break;
+      case "--cache": options.cache = value(); break;
+      case "--corpus": options.corpora.push(value()); break;
+      case "--only": options.only = list(value()) as CorpusName[]; break;
+      case "--levels": options.levels = list(value()).map(Number); break;
+      case "--strategies": options.strategies = list(value()); break;
+      case "--max-size": options.maxSize = Number(value()) * MB; break;
+      case "--min-runs": options.minRuns = Number(value()); break;
+      case "--min-time": options.minTime = Number(value()); break;
+      case "--out": options.out = value(); break;
+      case "--compare": options.compare = value(); break;
+      case "--ab": options.ab = true; break;
+      case "--baseline": options.baseline = value(); break;
+      case "--max-regression": options.maxRegression = Number(value()); break;
+      default: throw new Error(`Unknown option ${arg}`);
+    }
+  }
+
+  for (const name of options.only) {
+    if (!(name in STANDARD_CORPORA)) throw new Error(`Unknown corpus ${name}`);
+  }
+  for (const level of options.levels) {
+    if (!Number.isInteger(level) || level < 0 || level > ZlibCompression.ULTRA_COMPRESSION) throw new Error(`Invalid level ${level}`);
+  }
+  for (const strategy of options.strategies) {
+    if (!(strategy in STRATEGIES)) throw new Error(`Unknown strategy ${strategy}`);
+  }
+  // Table order, as the native suite runs them
+  options.strategies = Object.keys(STRATEGIES).filter(s => options.strategies.includes(s));
+  if (!(options.minRuns >= 1) || !(options.minTime >= 0) || !(options.maxSize > 0)) {
+    throw new Error("--min-runs, --min-time and --max-size must be positive");
+  }
+  if (!(options.maxRegression >= 0 && options.maxRegression < 100)) {
+    throw new Error(`Invalid --max-regression ${options.maxRegression}`);
+  }
+  return options;
+}
+
+async function exists(path: string): Promise<boolean> {
+  try {
+    await Deno.stat(path);
+    return true;
+  } catch {
+    return false;
+  }
+}
+
+// Regular files of a ustar/GNU tar archive
+function* untar(tar: Uint8Array): Generator<{ name: string; data: Uint8Array }> {
+  const decoder = new TextDecoder();
+  const field = (offset: number, length: number) =>
+    decoder.decode(tar.subarray(offset, offset + length)).replace(/\0.*$/s, "");
+
+  for (let offset = 0; offset + 512 <= tar.length;) {
+    const name = field(offset, 100);
+    if (!name) break;
+    const size = parseInt(field(offset + 124, 12).trim() || "0", 8);
+    const type = tar[offset + 156];
+    // Only POSIX ustar has a name prefix; old GNU keeps times there
+    const prefix = field(offset + 257, 6) === "ustar" && tar[offset + 262] === 0 ? field(offset + 345, 155) : "";
+    const start = offset + 512;
+    if (type === 0x30 || type === 0) {
+      yield { name: prefix ? `${prefix}/${name}` : name, data: tar.subarray(start, start + size) };
+    }
+    offset = start + Math.ceil(size / 512) * 512;
+  }
+}
+
+// Download a standard corpus and unpack it with zlib.wasm itself
+async function fetchCorpus(zlib: Zlib, name: CorpusName, dir: string): Promise<void> {
+  const corpus = STANDARD_CORPORA[name];
+  console.error(`Fetching ${name} from ${corpus.url}`);
+  const response = await fetch(corpus.url);
+  if (!response.ok) throw new Error(`Fetching ${corpus.url} failed: ${response.status}`);
+  const download = new Uint8Array(await response.arrayBuffer());
+
+  const files: { name: string; data: Uint8Array }[] = [];
+  if (corpus.unpack === "tar.gz") {
+    const tar = (await zlib.decompress(download)).data;
+    for (const file of untar(tar)) files.push({ name: file.name.split("/").pop()!, data: file.data });
+  } else {
+    const reader = zlib.openZip(download);
+    try {
+      for (const entry of corpus.names) {
+        const data = reader.extract(entry) ?? reader.extract(`${name}/${entry}`);
+        if (!data) throw new Error(`${entry} not found in ${corpus.url}`);
+        files.push({ name: entry, data });
+      }
+    } finally {
+      reader.dispose();
+    }
+  }
+
+  const staging = `${dir}.partial`;
+  await Deno.mkdir(staging, { recursive: true });
+  for (const file of files) await Deno.writeFile(`${staging}/${file.name}`, file.data);
+  await Deno.rename(staging, dir);
+}
+
+async function readDirectory(corpus: string, dir: string): Promise<CorpusFile[]> {
+  const files: CorpusFile[] = [];
+  const walk = async (path: string, prefix: string) => {
+    const entries = [];
+    for await (const entry of Deno.readDir(path)) entries.push(entry);
+    entries.sort((a, b) => a.name.localeCompare(b.name));
+    for (const entry of entries) {
+      if (entry.name.startsWith(".")) continue;
+      const name = prefix + entry.name;
+      if (entry.isDirectory) await walk(`${path}/${entry.name}`, `${name}/`);
+      else if (entry.isFile) files.push({ corpus, name, data: await Deno.readFile(`${path}/${entry.name}`) });
+    }
+  };
+  await walk(dir, "");
+  return files;
+}
+
+async function loadCorpora(zlib: Zlib, options: Options): Promise<CorpusFile[]> {
+  const files: CorpusFile[] = [];
+
+  for (const name of options.only) {
+    const dir = `${options.cache}/${name}`;
+    if (!(await exists(dir))) {
+      if (!options.fetch) {
+        console.error(`Skipping ${name}: not in ${options.cache} (run with --fetch to download it)`);
+        continue;
+      }
+      await fetchCorpus(zlib, name, dir);
+    }
+
+    const corpus = STANDARD_CORPORA[name];
+    for (const file of await readDirectory(name, dir)) {
+      if ("slices" in corpus) {
+        for (const slice of corpus.slices) {
+          if (slice > file.data.length) continue;
+          files.push({ corpus: name, name: `${file.name}[0:${slice}]`, data: file.data.subarray(0, slice) });
+        }
+      } else {
+        files.push(file);
+      }
+    }
+  }
+
+  for (const dir of options.corpora) {
+    files.push(...await readDirectory(dir.replace(/\/+$/, "").split("/").pop() || dir, dir));
+  }
+
+  return files.filter(file => {
+    if (file.data.length <= options.maxSize && file.data.length > 0) return true;
+    if (file.data.length > 0) console.error(`Skipping ${file.corpus}/${file.name}: larger than --max-size`);
+    return false;
+  });
+}
+
+// Push data through a transform in CHUNK_SIZE pieces and collect the output
+async function pump(stream: TransformStream<Uint8Array, Uint8Array>, data: Uint8Array): Promise<Uint8Array[]> {
+  const writer = stream.writable.getWriter();
+  const writing = (async () => {
+    for (let offset = 0; offset < data.length; offset += CHUNK_SIZE) {
+      await writer.write(data.subarray(offset, offset + CHUNK_SIZE));
+    }
+    await writer.close();
+  })();
+
+  const chunks: Uint8Array[] = [];
+  const reader = stream.readable.getReader();
+  for (;;) {
+    const { value, done } = await reader.read();
+    if (done) break;
+    chunks.push(value);
+  }
+  await writing;
+  return chunks;
+}
+
+function concat(chunks: Uint8Array[]): Uint8Array {
+  const out = new Uint8Array(chunks.reduce((n, chunk) => n + chunk.length, 0));
+  let offset = 0;
+  for (const chunk of chunks) {
+    out.set(chunk, offset);
+    offset += chunk.length;
+  }
+  return out;
+}
+
+function percentile(sorted: number[], q: number): number {
+  return sorted[Math.min(sorted.length - 1, Math.max(0, Math.ceil(q * sorted.length) - 1))];
+}
+
+async function measure(bytes: number, options: Options, run: () => Promise<void>): Promise<Measurement> {
+  const latencies: number[] = [];
+  let totalMs = 0;
+  while (latencies.length < options.minRuns || totalMs < options.minTime) {
+    const start = performance.now();
+    await run();
+    const elapsed = performance.now() - start;
+    latencies.push(elapsed);
+    totalMs += elapsed;
+  }
+
+  latencies.sort((a, b) => a - b);
+  return {
+    runs: latencies.length,
+    totalMs,
+    p50Ms: percentile(latencies, 0.5),
+    p99Ms: percentile(latencies, 0.99),
+    mbPerSec: (bytes * latencies.length / MB) / (totalMs / 1000)
+  };
+}
+
+function equal(a: Uint8Array, b: Uint8Array): boolean {
+  if (a.length !== b.length) return false;
+  for (let i = 0; i < a.length; i++) if (a[i] !== b[i]) return false;
+  return true;
+}
+
+async function benchmarkFile(zlib: Zlib, file: CorpusFile, level: number, strategy: string, options: Options): Promise<Result> {
+  const streamOptions = { level, strategy: STRATEGIES[strategy], chunkSize: CHUNK_SIZE };
+  const compressed = concat(await pump(zlib.createDeflateStream(streamOptions), file.data));
+  const restored = concat(await pump(zlib.createInflateStream({ chunkSize: CHUNK_SIZE }), compressed));
+  if (!equal(restored, file.data)) {
+    throw new Error(`${file.corpus}/${file.name} did not round-trip at level ${level}, strategy ${strategy}`);
+  }
+
+  const compress = await measure(file.data.length, options, async () => {
+    await pump(zlib.createDeflateStream(streamOptions), file.data);
+  });
+  const decompress = await measure(file.data.length, options, async () => {
+    await pump(zlib.createInflateStream({ chunkSize: CHUNK_SIZE }), compressed);
+  });
+
+  return {
+    corpus: file.corpus,
+    file: file.name,
+    size: file.data.length,
+    level,
+    strategy,
+    compressedSize: compressed.length,
+    compressedCrc32: zlib.crc32(compressed),
+    ratio: file.data.length / compressed.length,
+    compress,
+    decompress
+  };
+}
+
+async function benchmarkKernels(zlib: Zlib, file: CorpusFile, options: Options): Promise<Kernels> {
+  return {
+    corpus: file.corpus,
+    file: file.name,
+    size: file.data.length,
+    crc32: await measure(file.data.length, options, async () => { zlib.crc32(file.data); }),
+    adler32: await measure(file.data.length, options, async () => { zlib.adler32(file.data); })
+  };
+}
+
+// How one run's measurements stand against another's over the entries both
+// have: the other run's MB/s and a ratio of per-byte times, per entry and per
+// kernel over all of them
+interface Pairing {
+  ours: string;                                  // label of this run
+  theirs: string;                                // label of the other
+  ratio: string;                                 // name of the ratio field
+  of: (oursMs: number, theirsMs: number) => number;
+}
+
+function compareRuns(results: Result[], kernels: Kernels[], other: { results: Result[]; kernels: Kernels[] }, pairing: Pairing) {
+  const key = (...parts: (string | number)[]) => parts.join("\0");
+  const otherResults = new Map(other.results.map(r => [key(r.corpus, r.file, r.level, r.strategy), r]));
+  const otherKernels = new Map(other.kernels.map(k => [key(k.corpus, k.file), k]));
+  const totals = new Map<string, { bytes: number; oursMs: number; theirsMs: number }>();
+
+  const entry = (kernel: string, ours: Measurement, theirs: Measurement, size: number) => {
+    const total = totals.get(kernel) ?? { bytes: 0, oursMs: 0, theirsMs: 0 };
+    // Time per byte, so differing run counts weigh the same
+    total.bytes += size;
+    total.oursMs += ours.totalMs / ours.runs;
+    total.theirsMs += theirs.totalMs / theirs.runs;
+    totals.set(kernel, total);
+    return {
+      [`${pairing.theirs}MBps`]: theirs.mbPerSec,
+      [pairing.ratio]: pairing.of(1 / ours.mbPerSec, 1 / theirs.mbPerSec)
+    };
+  };
+
+  const entries = [];
+  for (const r of results) {
+    const o = otherResults.get(key(r.corpus, r.file, r.level, r.strategy));
+    if (!o) continue;
+    entries.push({
+      corpus: r.corpus,
+      file: r.file,
+      level: r.level,
+      strategy: r.strategy,
+      // Reports from the native suite carry no crc of the stream
+      ...(o.compressedCrc32 === undefined ? {} : {
+        sameOutput: r.compressedSize === o.compressedSize && r.compressedCrc32 === o.compressedCrc32
+      }),
+      deflate: entry(`deflate L${r.level} ${r.strategy}`, r.compress, o.compress, r.size),
+      inflate: entry("inflate", r.decompress, o.decompress, r.size)
+    });
+  }
+  for (const k of kernels) {
+    const o = otherKernels.get(key(k.corpus, k.file));
+    if (!o) continue;
+    entries.push({
+      corpus: k.corpus,
+      file: k.file,
+      crc32: entry("crc32", k.crc32, o.crc32, k.size),
+      adler32: entry("adler32", k.adler32, o.adler32, k.size)
+    });
+  }
+
+  const byKernel = [...totals.entries()].map(([kernel, total]) => ({
+    kernel,
+    [`${pairing.ours}MBps`]: (total.bytes / MB) / (total.oursMs / 1000),
+    [`${pairing.theirs}MBps`]: (total.bytes / MB) / (total.theirsMs / 1000),
+    [pairing.ratio]: pairing.of(total.oursMs, total.theirsMs)
+  }));
+  for (const k of byKernel) {
+    console.error(
+      `${k.kernel.padEnd(22)} ${pairing.ours} ${(k[`${pairing.ours}MBps`] as number).toFixed(1).padStart(8)} MB/s  ` +
+      `${pairing.theirs} ${(k[`${pairing.theirs}MBps`] as number).toFixed(1).padStart(8)} MB/s  ` +
+      `${pairing.ratio} ${(k[pairing.ratio] as number).toFixed(2)}x`
+    );
+  }
+  return { kernels: byKernel, entries };
+}
+
+// Native over WASM throughput: how much slower the same kernels run as WASM
+const NATIVE_PAIRING: Pairing = { ours: "wasm", theirs: "native", ratio: "wasmTax", of: (ours, theirs) => ours / theirs };
+
+// SIMD over scalar throughput, between two builds of the same sources
+const SCALAR_PAIRING: Pairing = { ours: "simd", theirs: "scalar", ratio: "simdSpeedup", of: (ours, theirs) => theirs / ours };
+
+// This run over a stored one: below 1 the kernel got slower
+const BASELINE_PAIRING: Pairing = { ours: "current", theirs: "baseline", ratio: "speedup", of: (ours, theirs) => theirs / ours };
+
+// Whole-corpus figures for one level and strategy: bytes over summed time
+function summarize(results: Result[]) {
+  const groups = new Map<string, Result[]>();
+  for (const result of results) {
+    const key = `${result.corpus}\0${result.level}\0${result.strategy}`;
+    if (!groups.has(key)) groups.set(key, []);
+    groups.get(key)!.push(result);
+  }
+
+  return [...groups.values()].map(group => {
+    const size = group.reduce((n, r) => n + r.size, 0);
+    const compressedSize = group.reduce((n, r) => n + r.compressedSize, 0);
+    const rate = (op: "compress" | "decompress") =>
+      (group.reduce((n, r) => n + r.size * r[op].runs, 0) / MB) /
+      (group.reduce((n, r) => n + r[op].totalMs, 0) / 1000);
+    return {
+      corpus: group[0].corpus,
+      level: group[0].level,
+      strategy: group[0].strategy,
+      files: group.length,
+      size,
+      compressedSize,
+      ratio: size / compressedSize,
+      compressMBps: rate("compress"),
+      decompressMBps: rate("decompress")
+    };
+  });
+}
+
+async function runCorpusBenchmarks(args: string[]) {
+  const options = parseArgs(args);
+  const zlib = new Zlib({ simdOptimizations: true, maxMemoryMB: 2048 });
+  await zlib.initialize();
+
+  let scalar: Zlib | null = null;
+  if (options.ab) {
+    scalar = new Zlib({ scalar: true, simdOptimizations: false, maxMemoryMB: 2048 });
+    await scalar.initialize();
+    // Without this the A/B would time one build against itself
+    if (!zlib.getCapabilities().simdSupported || scalar.getCapabilities().simdSupported) {
+      throw new Error("--ab needs zlib-release.js built with SIMD and zlib-release-scalar.js without (./build-dual.sh scalar)");
+    }
+  }
+
+  const files = await loadCorpora(zlib, options);
+  if (files.length === 0) {
+    console.error("No corpus files found; pass --fetch or --corpus <dir>");
+    Deno.exit(1);
+  }
+
+  const results: Result[] = [];
+  const kernels: Kernels[] = [];
+  const scalarResults: Result[] = [];
+  const scalarKernels: Kernels[] = [];
+  for (const file of files) {
+    kernels.push(await benchmarkKernels(zlib, file, options));
+    if (scalar) scalarKernels.push(await benchmarkKernels(scalar, file, options));
+    for (const level of options.levels) {
+      // Stored blocks ignore the strategy
+      const strategies = level === 0 ? options.strategies.slice(0, 1) : options.strategies;
+      for (const strategy of strategies) {
+        const result = await benchmarkFile(zlib, file, level, strategy, options);
+        results.push(result);
+        console.error(
+          `${`${file.corpus}/${file.name}`.padEnd(32)} L${level} ${strategy.padEnd(8)} ` +
+          `ratio ${result.ratio.toFixed(3).padStart(7)}  ` +
+          `deflate ${result.compress.mbPerSec.toFixed(1).padStart(7)} MB/s ` +
+          `(p50 ${result.compress.p50Ms.toFixed(2)} ms, p99 ${result.compress.p99Ms.toFixed(2)} ms)  ` +
+          `inflate ${result.decompress.mbPerSec.toFixed(1).padStart(7)} MB/s ` +
+          `(p50 ${result.decompress.p50Ms.toFixed(2)} ms, p99 ${result.decompress.p99Ms.toFixed(2)} ms)`
+        );
+        if (scalar) {
+          const other = await benchmarkFile(scalar, file, level, strategy, options);
+          scalarResults.push(other);
+          console.error(
+            `${"".padEnd(32)} scalar${other.compressedCrc32 === result.compressedCrc32 ? "" : " (different output)"}  ` +
+            `deflate ${other.compress.mbPerSec.toFixed(1).padStart(7)} MB/s  ` +
+            `inflate ${other.decompress.mbPerSec.toFixed(1).padStart(7)} MB/s`
+          );
+        }
+      }
+    }
+  }
+
+  const capabilities = zlib.getCapabilities();
+  const report = {
+    date: new Date().toISOString(),
+    zlibVersion: capabilities.version,
+    simd: capabilities.simdSupported,
+    runtime: { deno: Deno.version.deno, v8: Deno.version.v8, os: Deno.build.os, arch: Deno.build.arch },
+    settings: {
+      chunkSize: CHUNK_SIZE,
+      minRuns: options.minRuns,
+      minTimeMs: options.minTime,
+      levels: options.levels,
+      strategies: options.strategies
+    },
+    summary: summarize(results),
+    kernels,
+    results,
+    comparison: options.compare
+      ? compareRuns(results, kernels, JSON.parse(await Deno.readTextFile(options.compare)), NATIVE_PAIRING)
+      : undefined,
+    ab: scalar
+      ? compareRuns(results, kernels, { results: scalarResults, kernels: scalarKernels }, SCALAR_PAIRING)
+      : undefined,
+    baseline: options.baseline
+      ? compareRuns(results, kernels, JSON.parse(await Deno.readTextFile(options.baseline)), BASELINE_PAIRING)
+      : undefined
+  };
+  zlib.cleanup();
+  scalar?.cleanup();
+
+  const json = JSON.stringify(report, null, 2) + "\n";
+  if (options.out === "-") {
+    await Deno.stdout.write(new TextEncoder().encode(json));
+  } else {
+    await Deno.writeTextFile(options.out, json);
+    console.error(`Wrote ${results.length} results to ${options.out}`);
+  }
+
+  if (report.baseline) {
+    if (report.baseline.kernels.length === 0) {
+      throw new Error(`${options.baseline} shares no files, levels or strategies with this run`);
+    }
+    const floor = 1 - options.maxRegression / 100;
+    const regressed = report.baseline.kernels.filter(k => (k.speedup as number) < floor);
+    if (regressed.length > 0) {
+      throw new Error(
+        `${regressed.length} kernels regressed more than ${options.maxRegression}% against ${options.baseline}: ` +
+        regressed.map(k => `${k.kernel} ${(k.speedup as number).toFixed(2)}x`).join(", ")
+      );
+    }
+    console.error(`No kernel regressed more than ${options.maxRegression}% against ${options.baseline}`);
+  }
+}
+
+if (import.meta.main) {
+  try {
+    await runCorpusBenchmarks(Deno.args);
+  } catch (error) {
+    const errorMessage = error instanceof Error ? error.message : String(error);
+    console.error("Corpus benchmark failed:", errorMessage);
+    Deno.exit(1);
+  }
+}
@@ -0,0 +1,465 @@
+/**
+ * zlib.wasm kernel differential fuzzing - SIMD build against scalar and puff
+ * Run with: deno task fuzz:kernels [options]
+ *
+ *   --seed <n>            Seed for every case (default random, printed)
+ *   --cases <n>           Random cases to run (default 300)
+ *   --case <n>            Run only this case of --seed, to reproduce a failure
+ *   --max-size <bytes>    Largest generated input (default 262144)
+ *   --corpus <dir>        Also draw slices of these files (repeatable)
+ *   --puff <path>         pufftest binary (default contrib/puff/puff, from make -C contrib/puff)
+ *   --save <dir>          Where failing inputs are written (default bench/.fuzz-failures)
+ *
+ * zlib-release.js (-msimd128) and zlib-release-scalar.js (./build-dual.sh
+ * scalar) are the same sources with and without the SIMD kernels, so they
+ * must agree byte for byte. Each case draws an input (random bytes, small
+ * alphabets, runs, overlapping copies, text, a mix, or a corpus slice) and
+ * deflate settings (level 0-10, strategy, windowBits, memLevel) from its
+ * own seed, then checks that:
+ *
+ *   - compress() gives the same stream on both builds
+ *   - createDeflateStream() fed in the same random pieces does too
+ *   - both builds' decompress() restore the input
+ *   - createInflateStream() fed random pieces restores it
+ *   - contrib/puff/puff.c, the reference decoder, restores it
+ *   - crc32() and adler32() of an unaligned slice match a plain JS reference
+ *
+ * A failing case's input and settings are saved under --save, named by
+ * seed and case, and the run exits non-zero; --seed and --case rerun it.
+ */
+
+import Zlib, { ZlibCompression, ZlibStrategy } from "../src/lib/index.ts";
+
+const STRATEGIES: Record<string, ZlibStrategy> = {
+  default: ZlibStrategy.DEFAULT_STRATEGY,
+  filtered: ZlibStrategy.FILTERED,
+  huffman: ZlibStrategy.HUFFMAN_ONLY,
+  rle: ZlibStrategy.RLE,
+  fixed: ZlibStrategy.FIXED,
+  quick: ZlibStrategy.QUICK,
+  medium: ZlibStrategy.MEDIUM
+};
+
+const DEFAULT_PUFF = "contrib/puff/puff";
+
+interface Options {
+  seed: number;
+  cases: number;
+  only?: number;
+  maxSize: number;
+  corpora: string[];
+  puff?: string;
+  save: string;
+}
+
+interface Settings {
+  level: number;
+  strategy: string;
+  windowBits: number;
+  memLevel: number;
+}
+
+interface Case {
+  index: number;
+  generator: string;
+  input: Uint8Array;
+  settings: Settings;
+}
+
+type Rng = () => number;
+
+function parseArgs(args: string[]): Options {
+  const options: Options = {
+    seed: Math.floor(Math.random() * 0x100000000),
+    cases: 300,
+    maxSize: 256 * 1024,
+    corpora: [],
+    save: "bench/.fuzz-failures"
+  };
+
+  for (let i = 0; i < args.length; i++) {
+    const arg = args[i];
+    const value = () => {
+      if (i + 1 >= args.length) throw new Error(`${arg} needs a value`);
+      return args[++i];
+    };
+    switch (arg) {
+      case "--seed": options.seed = Number(value()) >>> 0; break;
+      case "--cases": options.cases = Number(value()); break;
+      case "--case": options.only = Number(value()); break;
+      case "--max-size": options.maxSize = Number(value()); break;
+      case "--corpus": options.corpora.push(value()); break;
+      case "--puff": options.puff = value(); break;
+      case "--save": options.save = value(); break;
+      default: throw new Error(`Unknown option ${arg}`);
+    }
+  }
+
+  if (!Number.isInteger(options.cases) || options.cases < 1) throw new Error(`Invalid case count ${options.cases}`);
+  if (options.only !== undefined && !(Number.isInteger(options.only) && options.only >= 0)) {
+    throw new Error(`Invalid case ${options.only}`);
+  }
+  if (!Number.isInteger(options.maxSize) || options.maxSize < 1) throw new Error(`Invalid --max-size ${options.maxSize}`);
+  return options;
+}
+
+// mulberry32: small, fast and the same on every host, so a seed names a case
+function mulberry32(seed: number): Rng {
+  let a = seed >>> 0;
+  return () => {
+    a = (a + 0x6d2b79f5) >>> 0;
+    let t = Math.imul(a ^ (a >>> 15), a | 1);
+    t ^= t + Math.imul(t ^ (t >>> 7), t | 61);
+    return ((t ^ (t >>> 14)) >>> 0) / 0x100000000;
+  };
+}
+
+function below(rng: Rng, n: number): number {
+  return Math.floor(rng() * n);
+}
+
+// Mostly small inputs, where block and window edges are dense, some large
+function drawSize(rng: Rng, maxSize: number): number {
+  const r = rng();
+  const cap = r < 0.3 ? 64 : r < 0.6 ? 4096 : maxSize;
+  return below(rng, Math.min(cap, maxSize) + 1);
+}
+
+function randomBytes(rng: Rng, size: number): Uint8Array {
+  const out = new Uint8Array(size);
+  for (let i = 0; i < size; i++) out[i] = below(rng, 256);
+  return out;
+}
+
+// A few symbols with skewed frequencies: literal-heavy Huffman coding
+function alphabetBytes(rng: Rng, size: number): Uint8Array {
+  const symbols = randomBytes(rng, 2 + below(rng, 15));
+  const out = new Uint8Array(size);
+  for (let i = 0; i < size; i++) out[i] = symbols[Math.floor(symbols.length * rng() ** 2)];
+  return out;
+}
+
+// Runs of one byte: distance-1 matches, the RLE strategy's run scan
+function runBytes(rng: Rng, size: number): Uint8Array {
+  const out = new Uint8Array(size);
+  for (let i = 0; i < size;) {
+    const end = Math.min(size, i + 1 + below(rng, 300));
+    out.fill(below(rng, 4) === 0 ? below(rng, 256) : 0, i, end);
+    i = end;
+  }
+  return out;
+}
+
+// Copies from earlier output, many at distances under 16 so they overlap
+// themselves: match length scans and inflate's overlapping chunk copies
+function copyBytes(rng: Rng, size: number): Uint8Array {
+  const out = new Uint8Array(size);
+  let i = Math.min(size, 1 + below(rng, 32));
+  out.set(randomBytes(rng, i));
+  while (i < size) {
+    if (below(rng, 8) === 0) {
+      out[i++] = below(rng, 256);
+      continue;
+    }
+    const dist = 1 + (below(rng, 2) === 0 ? below(rng, 16) : below(rng, Math.min(i, 32768)));
+    const from = Math.max(0, i - dist);
+    const length = Math.min(size - i, 3 + below(rng, below(rng, 4) === 0 ? 600 : 40));
+    for (let k = 0; k < length; k++) out[i + k] = out[from + k];
+    i += length;
+  }
+  return out;
+}
+
+const WORDS = [
+  "the", "of", "and", "deflate", "inflate", "window", "match", "literal", "length",
+  "distance", "block", "huffman", "stream", "\n", "{\"id\":", "\"name\":", "},", "    "
+];
+
+function textBytes(rng: Rng, size: number): Uint8Array {
+  const out = new Uint8Array(size);
+  const encoder = new TextEncoder();
+  let i = 0;
+  while (i < size) {
+    const word = encoder.encode(WORDS[Math.floor(WORDS.length * rng() ** 1.5)] + (below(rng, 3) ? " " : ""));
+    out.set(word.subarray(0, size - i), i);
+    i += word.length;
+  }
+  return out;
+}
+
+const GENERATORS: Record<string, (rng: Rng, size: number) => Uint8Array> = {
+  random: randomBytes,
+  alphabet: alphabetBytes,
+  runs: runBytes,
+  copies: copyBytes,
+  text: textBytes,
+  // Segments of the others back to back, so block types change mid-stream
+  mixed: (rng, size) => {
+    const names = ["random", "alphabet", "runs", "copies", "text"];
+    const out = new Uint8Array(size);
+    for (let i = 0; i < size;) {
+      const length = Math.min(size - i, 1 + below(rng, 8192));
+      out.set(GENERATORS[names[below(rng, names.length)]](rng, length), i);
+      i += length;
+    }
+    return out;
+  }
+};
+
+async function readCorpora(dirs: string[]): Promise<Uint8Array[]> {
+  const files: Uint8Array[] = [];
+  const walk = async (path: string) => {
+    for await (const entry of Deno.readDir(path)) {
+      if (entry.name.startsWith(".")) continue;
+      if (entry.isDirectory) await walk(`${path}/${entry.name}`);
+      else if (entry.isFile) files.push(await Deno.readFile(`${path}/${entry.name}`));
+    }
+  };
+  for (const dir of dirs) await walk(dir);
+  return files.filter(file => file.length > 0);
+}
+
+function drawCase(seed: number, index: number, options: Options, corpus: Uint8Array[]): Case {
+  const rng = mulberry32(seed ^ Math.imul(index + 1, 0x9e3779b1));
+  const size = drawSize(rng, options.maxSize);
+
+  let generator: string;
+  let input: Uint8Array;
+  if (corpus.length > 0 && below(rng, 3) === 0) {
+    generator = "corpus";
+    const file = corpus[below(rng, corpus.length)];
+    const start = below(rng, file.length);
+    input = file.slice(start, start + size);
+  } else {
+    const names = Object.keys(GENERATORS);
+    generator = names[below(rng, names.length)];
+    input = GENERATORS[generator](rng, size);
+  }
+
+  const strategies = Object.keys(STRATEGIES);
+  return {
+    index,
+    generator,
+    input,
+    settings: {
+      level: below(rng, ZlibCompression.ULTRA_COMPRESSION + 1),
+      strategy: strategies[below(rng, strategies.length)],
+      windowBits: 9 + below(rng, 7),
+      memLevel: 1 + below(rng, 9)
+    }
+  };
+}
+
+// Random piece boundaries for feeding a stream, drawn from the case's data
+// so both builds see the same ones
+function pieces(data: Uint8Array, rng: Rng): Uint8Array[] {
+  const out: Uint8Array[] = [];
+  for (let offset = 0; offset < data.length;) {
+    const length = 1 + below(rng, below(rng, 4) === 0 ? 16 : 65536);
+    out.push(data.subarray(offset, offset + length));
+    offset += length;
+  }
+  return out;
+}
+
+async function pump(stream: TransformStream<Uint8Array, Uint8Array>, input: Uint8Array[]): Promise<Uint8Array> {
+  const writer = stream.writable.getWriter();
+  const writing = (async () => {
+    for (const piece of input) await writer.write(piece);
+    await writer.close();
+  })();
+  const output = new Uint8Array(await new Response(stream.readable).arrayBuffer());
+  await writing;
+  return output;
+}
+
+function equal(a: Uint8Array, b: Uint8Array): boolean {
+  if (a.length !== b.length) return false;
+  for (let i = 0; i < a.length; i++) if (a[i] !== b[i]) return false;
+  return true;
+}
+
+// Plain bytewise references, sharing no code with either build
+const CRC_TABLE = (() => {
+  const table = new Uint32Array(256);
+  for (let n = 0; n < 256; n++) {
+    let c = n;
+    for (let k = 0; k < 8; k++) c = c & 1 ? 0xedb88320 ^ (c >>> 1) : c >>> 1;
+    table[n] = c >>> 0;
+  }
+  return table;
+})();
+
+function crc32Reference(data: Uint8Array): number {
+  let crc = 0xffffffff;
+  for (let i = 0; i < data.length; i++) crc = CRC_TABLE[(crc ^ data[i]) & 0xff] ^ (crc >>> 8);
+  return (crc ^ 0xffffffff) >>> 0;
+}
+
+function adler32Reference(data: Uint8Array): number {
+  let a = 1;
+  let b = 0;
+  for (let i = 0; i < data.length; i++) {
+    a = (a + data[i]) % 65521;
+    b = (b + a) % 65521;
+  }
+  return ((b << 16) | a) >>> 0;
+}
+
+// Inflate a zlib stream with puff, skipping the 2-byte header
+async function puffInflate(puff: string, compressed: Uint8Array): Promise<Uint8Array | null> {
+  const child = new Deno.Command(puff, { args: ["-w", "-2"], stdin: "piped", stdout: "piped", stderr: "null" }).spawn();
+  const writer = child.stdin.getWriter();
+  await writer.write(compressed);
+  await writer.close();
+  const { code, stdout } = await child.output();
+  return code === 0 ? stdout : null;
+}
+
+async function exists(path: string): Promise<boolean> {
+  try {
+    await Deno.stat(path);
+    return true;
+  } catch {
+    return false;
+  }
+}
+
+/** The checks of one case that failed, by name; empty when it passed */
+async function runCase(simd: Zlib, scalar: Zlib, c: Case, puff: string | null, seed: number): Promise<string[]> {
+  const failures: string[] = [];
+  const { level, strategy, windowBits, memLevel } = c.settings;
+  const options = { level, strategy: STRATEGIES[strategy], windowBits, memLevel };
+  const check = async (name: string, run: () => Promise<boolean> | boolean) => {
+    try {
+      if (!await run()) failures.push(name);
+    } catch (error) {
+      failures.push(`${name}: ${error instanceof Error ? error.message : String(error)}`);
+    }
+  };
+
+  // The one-shot stream every inflate check reads
+  let stream: Uint8Array;
+  try {
+    stream = (await simd.compress(c.input, options)).data;
+    if (!equal(stream, (await scalar.compress(c.input, options)).data)) failures.push("compress bit-exact");
+  } catch (error) {
+    failures.push(`compress: ${error instanceof Error ? error.message : String(error)}`);
+    return failures;
+  }
+
+  const rng = mulberry32(seed ^ Math.imul(c.index + 1, 0x85ebca6b));
+  const writes = pieces(c.input, rng);
+  await check("stream deflate bit-exact", async () => {
+    const ours = await pump(simd.createDeflateStream(options), writes);
+    const theirs = await pump(scalar.createDeflateStream(options), writes);
+    return equal(ours, theirs) && equal((await scalar.decompress(ours)).data, c.input);
+  });
+
+  await check("simd inflate", async () => equal((await simd.decompress(stream)).data, c.input));
+  await check("scalar inflate", async () => equal((await scalar.decompress(stream)).data, c.input));
+  await check("stream inflate", async () => equal(await pump(simd.createInflateStream(), pieces(stream, rng)), c.input));
+  if (puff) {
+    await check("puff inflate", async () => {
+      const restored = await puffInflate(puff, stream);
+      return restored !== null && equal(restored, c.input);
+    });
+  }
+
+  // Unaligned start and length, so the vector loops' heads and tails run
+  const start = Math.min(c.input.length, below(rng, 16));
+  const slice = c.input.subarray(start, start + below(rng, c.input.length - start + 1));
+  await check("crc32", () => {
+    const expected = crc32Reference(slice);
+    return simd.crc32(slice) === expected && scalar.crc32(slice) === expected;
+  });
+  await check("adler32", () => {
+    const expected = adler32Reference(slice);
+    return simd.adler32(slice) === expected && scalar.adler32(slice) === expected;
+  });
+  return failures;
+}
+
+async function saveFailure(options: Options, seed: number, c: Case, failures: string[]): Promise<string> {
+  await Deno.mkdir(options.save, { recursive: true });
+  const base = `${options.save}/${seed}-${c.index}`;
+  await Deno.writeFile(`${base}.bin`, c.input);
+  await Deno.writeTextFile(`${base}.json`, JSON.stringify({
+    seed,
+    case: c.index,
+    generator: c.generator,
+    size: c.input.length,
+    settings: c.settings,
+    failures
+  }, null, 2) + "\n");
+  return base;
+}
+
+async function runKernelFuzz(args: string[]) {
+  const options = parseArgs(args);
+
+  const simd = new Zlib({ simdOptimizations: true, maxMemoryMB: 1024 });
+  const scalar = new Zlib({ scalar: true, simdOptimizations: false, maxMemoryMB: 1024 });
+  await simd.initialize();
+  await scalar.initialize();
+  // Without this the comparison would check one build against itself
+  if (!simd.getCapabilities().simdSupported || scalar.getCapabilities().simdSupported) {
+    throw new Error("Needs zlib-release.js built with SIMD and zlib-release-scalar.js without (./build-dual.sh scalar)");
+  }
+
+  let puff: string | null = options.puff ?? DEFAULT_PUFF;
+  if (!await exists(puff)) {
+    if (options.puff) throw new Error(`${options.puff} not found`);
+    console.error(`${DEFAULT_PUFF} not found (make -C contrib/puff): skipping the reference decoder`);
+    puff = null;
+  }
+
+  const corpus = await readCorpora(options.corpora);
+  const indexes = options.only !== undefined
+    ? [options.only]
+    : Array.from({ length: options.cases }, (_, i) => i);
+  console.error(`Seed ${options.seed}, ${indexes.length} cases`);
+
+  let failed = 0;
+  let bytes = 0;
+  const start = performance.now();
+  try {
+    for (const index of indexes) {
+      const c = drawCase(options.seed, index, options, corpus);
+      bytes += c.input.length;
+      const failures = await runCase(simd, scalar, c, puff, options.seed);
+      if (failures.length === 0) continue;
+
+      failed++;
+      const saved = await saveFailure(options, options.seed, c, failures);
+      const { level, strategy, windowBits, memLevel } = c.settings;
+      console.error(
+        `Case ${index} (${c.generator}, ${c.input.length} bytes, L${level} ${strategy} ` +
+        `windowBits ${windowBits} memLevel ${memLevel}) failed: ${failures.join("; ")} - saved to ${saved}.bin`
+      );
+    }
+  } finally {
+    simd.cleanup();
+    scalar.cleanup();
+  }
+
+  const seconds = (performance.now() - start) / 1000;
+  console.error(
+    `${indexes.length - failed} of ${indexes.length} cases passed, ${(bytes / 1024 / 1024).toFixed(1)} MB ` +
+    `in ${seconds.toFixed(1)} s (seed ${options.seed}${puff ? "" : ", no puff"})`
+  );
+  if (failed > 0) {
+    console.error(`Rerun one with: deno task fuzz:kernels --seed ${options.seed} --case <n>`);
+    Deno.exit(1);
+  }
+}
+
+if (import.meta.main) {
+  try {
+    await runKernelFuzz(Deno.args);
+  } catch (error) {
+    const errorMessage = error instanceof Error ? error.message : String(error);
+    console.error("Kernel fuzzing failed:", errorMessage);
+    Deno.exit(1);
+  }
+}
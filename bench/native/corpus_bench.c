@@ -0,0 +1,544 @@
+/**
+ * zlib.wasm - Native corpus benchmark
+ *
+ * Copyright 2025 Superstruct Ltd, New Zealand
+ *
+ * This source code is licensed under the Zlib license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * The native counterpart of bench/corpus.bench.ts, built from the same
+ * deflate.c, inflate.c, adler32.c and crc32.c with -DZLIB_BUILD_BENCHMARK=ON.
+ * It reads the same corpus cache and user directories, runs the same levels
+ * and strategies in the same 1 MB chunks, times runs the same way, and
+ * writes the results and kernels entries of its JSON report in the same
+ * layout, so that
+ *
+ *   deno task benchmark:corpus --compare native.json
+ *
+ * can put the WASM build's throughput next to native for every kernel. The
+ * corpora are fetched by the Deno suite (--fetch); this one only reads them.
+ *
+ * The wasm_simd128 paths in the kernels do not exist natively, so native
+ * runs their portable C, as optimized by the native compiler.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include "zlib.h"
+
+#define CHUNK_SIZE (1024 * 1024)
+#define MB (1024.0 * 1024.0)
+#define MAX_LEVELS 16
+#define MAX_CORPORA 32
+
+typedef struct {
+    char corpus[64];
+    char name[512];
+    unsigned char* data;        // shared by an enwik8 file and its slices
+    size_t size;
+    int owner;                  // this entry frees data
+} corpus_file_t;
+
+typedef struct {
+    int runs;
+    double total_ms;
+    double p50_ms;
+    double p99_ms;
+    double mb_per_sec;
+} measurement_t;
+
+typedef struct {
+    const char* cache;
+    const char* corpora[MAX_CORPORA];
+    int corpus_count;
+    char only[256];
+    int levels[MAX_LEVELS];
+    int level_count;
+    char strategies[256];
+    double max_size;
+    int min_runs;
+    double min_time;
+    const char* out;
+} options_t;
+
+static const struct {
+    const char* name;
+    int strategy;
+} strategies[] = {
+    {"default", Z_DEFAULT_STRATEGY},
+    {"filtered", Z_FILTERED},
+    {"huffman", Z_HUFFMAN_ONLY},
+    {"rle", Z_RLE},
+    {"fixed", Z_FIXED},
+    {"quick", Z_QUICK},
+    {"medium", Z_MEDIUM}
+};
+#define STRATEGY_COUNT (int)(sizeof(strategies) / sizeof(strategies[0]))
+
+// Standard corpora, as in bench/corpus.bench.ts; enwik8 runs as slices
+static const char* standard_corpora[] = {"canterbury", "silesia", "enwik8"};
+static const size_t enwik8_slices[] = {1024 * 1024, 10 * 1024 * 1024, 100000000};
+
+static corpus_file_t* files = NULL;
+static int file_count = 0, file_cap = 0;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static void fail(const char* message, const char* detail) {
+    fprintf(stderr, "Corpus benchmark failed: %s%s%s\n", message, detail ? " " : "", detail ? detail : "");
+    exit(1);
+}
+
+static void* xmalloc(size_t size) {
+    void* p = malloc(size ? size : 1);
+    if (!p) fail("out of memory", NULL);
+    return p;
+}
+
+// Whether name is in a comma-separated list
+static int in_list(const char* list, const char* name) {
+    size_t len = strlen(name);
+    for (const char* p = list; *p;) {
+        const char* end = strchr(p, ',');
+        size_t n = end ? (size_t)(end - p) : strlen(p);
+        if (n == len && strncmp(p, name, n) == 0) return 1;
+        if (!end) break;
+        p = end + 1;
+    }
+    return 0;
+}
+
+static void add_file(const char* corpus, const char* name, unsigned char* data, size_t size, int owner) {
+    if (file_count == file_cap) {
+        file_cap = file_cap ? file_cap * 2 : 64;
+        files = (corpus_file_t*)realloc(files, sizeof(corpus_file_t) * file_cap);
+        if (!files) fail("out of memory", NULL);
+    }
+    corpus_file_t* file = &files[file_count++];
+    snprintf(file->corpus, sizeof(file->corpus), "%s", corpus);
+    snprintf(file->name, sizeof(file->name), "%s", name);
+    file->data = data;
+    file->size = size;
+    file->owner = owner;
+}
+
+static unsigned char* read_file(const char* path, size_t* size) {
+    FILE* in = fopen(path, "rb");
+    if (!in) fail("cannot open", path);
+    size_t cap = CHUNK_SIZE, len = 0;
+    unsigned char* data = (unsigned char*)xmalloc(cap);
+    for (;;) {
+        if (len == cap) {
+            cap *= 2;
+            data = (unsigned char*)realloc(data, cap);
+            if (!data) fail("out of memory", NULL);
+        }
+        size_t got = fread(data + len, 1, cap - len, in);
+        len += got;
+        if (got == 0) break;
+    }
+    if (ferror(in)) fail("cannot read", path);
+    fclose(in);
+    *size = len;
+    return data;
+}
+
+static int skip_entry(const struct dirent* entry) {
+    return entry->d_name[0] != '.';
+}
+
+// Every regular file under dir, in name order, as readDirectory() does
+static void walk(const char* corpus, const char* dir, const char* prefix, int slices) {
+    struct dirent** entries;
+    int count = scandir(dir, &entries, skip_entry, alphasort);
+    if (count < 0) fail("cannot read directory", dir);
+
+    for (int i = 0; i < count; i++) {
+        char path[4096], name[512];
+        struct stat st;
+        if ((size_t)snprintf(path, sizeof(path), "%s/%s", dir, entries[i]->d_name) >= sizeof(path)) {
+            fail("path too long under", dir);
+        }
+        if ((size_t)snprintf(name, sizeof(name), "%s%s", prefix, entries[i]->d_name) >= sizeof(name)) {
+            fail("name too long under", dir);
+        }
+        if (stat(path, &st) != 0) fail("cannot stat", path);
+
+        if (S_ISDIR(st.st_mode)) {
+            // Room for name and its trailing '/'
+            char sub[sizeof(name) + 1];
+            snprintf(sub, sizeof(sub), "%s/", name);
+            walk(corpus, path, sub, slices);
+        } else if (S_ISREG(st.st_mode)) {
+            size_t size;
+            unsigned char* data = read_file(path, &size);
+            if (!slices) {
+                add_file(corpus, name, data, size, 1);
+            } else {
+                int owner = 1;
+                for (size_t s = 0; s < sizeof(enwik8_slices) / sizeof(enwik8_slices[0]); s++) {
+                    char slice[600];
+                    if (enwik8_slices[s] > size) continue;
+                    snprintf(slice, sizeof(slice), "%s[0:%zu]", name, enwik8_slices[s]);
+                    add_file(corpus, slice, data, enwik8_slices[s], owner);
+                    owner = 0;
+                }
+                if (owner) free(data);
+            }
+        }
+        free(entries[i]);
+    }
+    free(entries);
+}
+
+static void load_corpora(const options_t* options) {
+    for (size_t i = 0; i < sizeof(standard_corpora) / sizeof(standard_corpora[0]); i++) {
+        const char* name = standard_corpora[i];
+        char dir[4096];
+        struct stat st;
+        if (!in_list(options->only, name)) continue;
+        snprintf(dir, sizeof(dir), "%s/%s", options->cache, name);
+        if (stat(dir, &st) != 0 || !S_ISDIR(st.st_mode)) {
+            fprintf(stderr, "Skipping %s: not in %s (fetch it with deno task benchmark:corpus --fetch)\n",
+                    name, options->cache);
+            continue;
+        }
+        walk(name, dir, "", strcmp(name, "enwik8") == 0);
+    }
+
+    for (int i = 0; i < options->corpus_count; i++) {
+        char dir[4096];
+        snprintf(dir, sizeof(dir), "%s", options->corpora[i]);
+        size_t len = strlen(dir);
+        while (len > 1 && dir[len - 1] == '/') dir[--len] = 0;
+        const char* base = strrchr(dir, '/');
+        walk(base && base[1] ? base + 1 : dir, dir, "", 0);
+    }
+
+    // Drop empty files and those over --max-size
+    int kept = 0;
+    for (int i = 0; i < file_count; i++) {
+        if (files[i].size > 0 && files[i].size <= options->max_size) {
+            files[kept++] = files[i];
+            continue;
+        }
+        if (files[i].size > 0) {
+            fprintf(stderr, "Skipping %s/%s: larger than --max-size\n", files[i].corpus, files[i].name);
+        }
+        // A dropped slice owner hands its data to the next slice of the file
+        if (files[i].owner && i + 1 < file_count && files[i + 1].data == files[i].data) {
+            files[i + 1].owner = 1;
+        } else if (files[i].owner) {
+            free(files[i].data);
+        }
+    }
+    file_count = kept;
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return x < y ? -1 : x > y;
+}
+
+static double percentile(const double* sorted, int n, double q) {
+    int i = (int)(q * n + 0.999999999) - 1;
+    if (i < 0) i = 0;
+    if (i > n - 1) i = n - 1;
+    return sorted[i];
+}
+
+// Output of one deflate or inflate pass; reused between runs
+typedef struct {
+    unsigned char* data;
+    size_t len;
+    size_t cap;
+} sink_t;
+
+static void sink_put(sink_t* sink, const unsigned char* data, size_t len) {
+    if (!sink) return;
+    if (sink->len + len > sink->cap) {
+        while (sink->len + len > sink->cap) sink->cap = sink->cap ? sink->cap * 2 : CHUNK_SIZE;
+        sink->data = (unsigned char*)realloc(sink->data, sink->cap);
+        if (!sink->data) fail("out of memory", NULL);
+    }
+    memcpy(sink->data + sink->len, data, len);
+    sink->len += len;
+}
+
+// Compress or decompress data in CHUNK_SIZE pieces, as the streams do,
+// keeping the output in sink if given
+static void run_stream(int deflating, int level, int strategy, const unsigned char* data, size_t size,
+                       sink_t* sink) {
+    static unsigned char out[CHUNK_SIZE];
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+    int ret = deflating ? deflateInit2(&strm, level, Z_DEFLATED, 15, 8, strategy)
+                        : inflateInit2(&strm, 15 + 32);
+    if (ret != Z_OK) fail("cannot initialize zlib", NULL);
+    if (sink) sink->len = 0;
+
+    size_t offset = 0;
+    do {
+        size_t len = size - offset < CHUNK_SIZE ? size - offset : CHUNK_SIZE;
+        int flush = deflating && offset + len == size ? Z_FINISH : Z_NO_FLUSH;
+        strm.next_in = (Bytef*)data + offset;
+        strm.avail_in = (uInt)len;
+        offset += len;
+        do {
+            strm.next_out = out;
+            strm.avail_out = CHUNK_SIZE;
+            ret = deflating ? deflate(&strm, flush) : inflate(&strm, Z_NO_FLUSH);
+            if (ret == Z_STREAM_ERROR || ret == Z_DATA_ERROR || ret == Z_MEM_ERROR || ret == Z_NEED_DICT) {
+                fail("zlib stream error", NULL);
+            }
+            sink_put(sink, out, CHUNK_SIZE - strm.avail_out);
+        } while (strm.avail_out == 0);
+    } while (offset < size && ret != Z_STREAM_END);
+
+    if (deflating) deflateEnd(&strm);
+    else inflateEnd(&strm);
+}
+
+typedef enum { OP_DEFLATE, OP_INFLATE, OP_CRC32, OP_ADLER32 } op_t;
+
+static volatile unsigned long checksum_sink;
+
+static void run_op(op_t op, int level, int strategy, const unsigned char* data, size_t size) {
+    switch (op) {
+    case OP_DEFLATE: run_stream(1, level, strategy, data, size, NULL); break;
+    case OP_INFLATE: run_stream(0, 0, 0, data, size, NULL); break;
+    case OP_CRC32: checksum_sink = crc32(0, data, (uInt)size); break;
+    case OP_ADLER32: checksum_sink = adler32(1, data, (uInt)size); break;
+    }
+}
+
+static measurement_t measure(const options_t* options, size_t bytes, op_t op, int level, int strategy,
+                             const unsigned char* data, size_t size) {
+    static double* latencies = NULL;
+    static int cap = 0;
+    measurement_t m = {0, 0, 0, 0, 0};
+
+    while (m.runs < options->min_runs || m.total_ms < options->min_time) {
+        double start = now_ms();
+        run_op(op, level, strategy, data, size);
+        double elapsed = now_ms() - start;
+        if (m.runs == cap) {
+            cap = cap ? cap * 2 : 64;
+            latencies = (double*)realloc(latencies, sizeof(double) * cap);
+            if (!latencies) fail("out of memory", NULL);
+        }
+        latencies[m.runs++] = elapsed;
+        m.total_ms += elapsed;
+    }
+
+    qsort(latencies, m.runs, sizeof(double), compare_double);
+    m.p50_ms = percentile(latencies, m.runs, 0.5);
+    m.p99_ms = percentile(latencies, m.runs, 0.99);
+    m.mb_per_sec = (bytes * (double)m.runs / MB) / (m.total_ms / 1000.0);
+    return m;
+}
+
+static void json_string(FILE* out, const char* s) {
+    fputc('"', out);
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') fprintf(out, "\\%c", c);
+        else if (c < 0x20) fprintf(out, "\\u%04x", c);
+        else fputc(c, out);
+    }
+    fputc('"', out);
+}
+
+static void json_measurement(FILE* out, const char* key, const measurement_t* m) {
+    fprintf(out, "\"%s\": {\"runs\": %d, \"totalMs\": %.4f, \"p50Ms\": %.4f, \"p99Ms\": %.4f, \"mbPerSec\": %.4f}",
+            key, m->runs, m->total_ms, m->p50_ms, m->p99_ms, m->mb_per_sec);
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: zlib_corpus_bench [--cache dir] [--corpus dir]... [--only names]\n"
+            "                         [--levels list] [--strategies list] [--max-size MB]\n"
+            "                         [--min-runs n] [--min-time ms] [--out file|-]\n");
+    exit(1);
+}
+
+static void parse_args(int argc, char** argv, options_t* options) {
+    options->cache = "bench/.corpora";
+    snprintf(options->only, sizeof(options->only), "canterbury,silesia,enwik8");
+    options->level_count = 0;
+    for (int level = 0; level <= Z_ULTRA_COMPRESSION; level++) options->levels[options->level_count++] = level;
+    snprintf(options->strategies, sizeof(options->strategies), "default,filtered,huffman,rle,fixed,quick,medium");
+    options->max_size = 256 * MB;
+    options->min_runs = 5;
+    options->min_time = 1000;
+    options->out = "bench/native-results.json";
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (i + 1 >= argc) usage();
+        const char* value = argv[++i];
+        if (strcmp(arg, "--cache") == 0) {
+            options->cache = value;
+        } else if (strcmp(arg, "--corpus") == 0) {
+            if (options->corpus_count == MAX_CORPORA) fail("too many --corpus directories", NULL);
+            options->corpora[options->corpus_count++] = value;
+        } else if (strcmp(arg, "--only") == 0) {
+            snprintf(options->only, sizeof(options->only), "%s", value);
+        } else if (strcmp(arg, "--levels") == 0) {
+            options->level_count = 0;
+            for (const char* p = value; *p;) {
+                char* end;
+                long level = strtol(p, &end, 10);
+                if (end == p || level < 0 || level > Z_ULTRA_COMPRESSION || options->level_count == MAX_LEVELS) {
+                    fail("invalid level in", value);
+                }
+                options->levels[options->level_count++] = (int)level;
+                p = *end == ',' ? end + 1 : end;
+                if (*end && *end != ',') fail("invalid level in", value);
+            }
+        } else if (strcmp(arg, "--strategies") == 0) {
+            snprintf(options->strategies, sizeof(options->strategies), "%s", value);
+        } else if (strcmp(arg, "--max-size") == 0) {
+            options->max_size = atof(value) * MB;
+        } else if (strcmp(arg, "--min-runs") == 0) {
+            options->min_runs = atoi(value);
+        } else if (strcmp(arg, "--min-time") == 0) {
+            options->min_time = atof(value);
+        } else if (strcmp(arg, "--out") == 0) {
+            options->out = value;
+        } else {
+            usage();
+        }
+    }
+
+    for (const char* p = options->strategies; *p;) {
+        int known = 0;
+        for (int s = 0; s < STRATEGY_COUNT; s++) {
+            size_t n = strlen(strategies[s].name);
+            if (strncmp(p, strategies[s].name, n) == 0 && (p[n] == ',' || p[n] == 0)) known = 1;
+        }
+        if (!known) fail("unknown strategy in", options->strategies);
+        p = strchr(p, ',');
+        if (!p) break;
+        p++;
+    }
+    if (options->min_runs < 1 || options->min_time < 0 || options->max_size <= 0) {
+        fail("--min-runs, --min-time and --max-size must be positive", NULL);
+    }
+}
+
+int main(int argc, char** argv) {
+    options_t options;
+    memset(&options, 0, sizeof(options));
+    parse_args(argc, argv, &options);
+    load_corpora(&options);
+    if (file_count == 0) fail("no corpus files found; fetch them or pass --corpus <dir>", NULL);
+
+    FILE* out = strcmp(options.out, "-") == 0 ? stdout : fopen(options.out, "w");
+    if (!out) fail("cannot write", options.out);
+
+    char date[32];
+    time_t now = time(NULL);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+    fprintf(out, "{\n  \"date\": \"%s\",\n  \"zlibVersion\": ", date);
+    json_string(out, zlibVersion());
+    fprintf(out, ",\n  \"simd\": false,\n  \"runtime\": {\"native\": ");
+#ifdef __VERSION__
+    json_string(out, __VERSION__);
+#else
+    json_string(out, "unknown");
+#endif
+    fprintf(out, "},\n  \"settings\": {\"chunkSize\": %d, \"minRuns\": %d, \"minTimeMs\": %g, \"levels\": [",
+            CHUNK_SIZE, options.min_runs, options.min_time);
+    for (int l = 0; l < options.level_count; l++) fprintf(out, "%s%d", l ? ", " : "", options.levels[l]);
+    fprintf(out, "], \"strategies\": [");
+    int listed = 0;
+    for (int s = 0; s < STRATEGY_COUNT; s++) {
+        if (!in_list(options.strategies, strategies[s].name)) continue;
+        fprintf(out, "%s\"%s\"", listed++ ? ", " : "", strategies[s].name);
+    }
+    fprintf(out, "]},\n  \"kernels\": [");
+
+    // Checksums on their own, per file
+    int first = 1;
+    for (int f = 0; f < file_count; f++) {
+        const corpus_file_t* file = &files[f];
+        measurement_t crc = measure(&options, file->size, OP_CRC32, 0, 0, file->data, file->size);
+        measurement_t adler = measure(&options, file->size, OP_ADLER32, 0, 0, file->data, file->size);
+        fprintf(out, "%s\n    {\"corpus\": ", first ? "" : ",");
+        json_string(out, file->corpus);
+        fprintf(out, ", \"file\": ");
+        json_string(out, file->name);
+        fprintf(out, ", \"size\": %zu, ", file->size);
+        json_measurement(out, "crc32", &crc);
+        fprintf(out, ", ");
+        json_measurement(out, "adler32", &adler);
+        fprintf(out, "}");
+        first = 0;
+    }
+    fprintf(out, "\n  ],\n  \"results\": [");
+
+    sink_t compressed = {NULL, 0, 0}, restored = {NULL, 0, 0};
+    first = 1;
+    for (int f = 0; f < file_count; f++) {
+        const corpus_file_t* file = &files[f];
+        for (int l = 0; l < options.level_count; l++) {
+            int level = options.levels[l];
+            int done_stored = 0;
+            for (int s = 0; s < STRATEGY_COUNT; s++) {
+                // Stored blocks ignore the strategy
+                if (!in_list(options.strategies, strategies[s].name) || (level == 0 && done_stored)) continue;
+                done_stored = 1;
+                int strategy = strategies[s].strategy;
+
+                run_stream(1, level, strategy, file->data, file->size, &compressed);
+                run_stream(0, 0, 0, compressed.data, compressed.len, &restored);
+                if (restored.len != file->size || memcmp(restored.data, file->data, file->size) != 0) {
+                    fail("round trip failed for", file->name);
+                }
+
+                measurement_t c = measure(&options, file->size, OP_DEFLATE, level, strategy, file->data, file->size);
+                measurement_t d = measure(&options, file->size, OP_INFLATE, 0, 0, compressed.data, compressed.len);
+
+                fprintf(stderr, "%s/%-24s L%d %-8s ratio %7.3f  deflate %7.1f MB/s (p50 %.2f ms, p99 %.2f ms)"
+                        "  inflate %7.1f MB/s (p50 %.2f ms, p99 %.2f ms)\n",
+                        file->corpus, file->name, level, strategies[s].name,
+                        (double)file->size / compressed.len, c.mb_per_sec, c.p50_ms, c.p99_ms,
+                        d.mb_per_sec, d.p50_ms, d.p99_ms);
+
+                fprintf(out, "%s\n    {\"corpus\": ", first ? "" : ",");
+                json_string(out, file->corpus);
+                fprintf(out, ", \"file\": ");
+                json_string(out, file->name);
+                fprintf(out, ", \"size\": %zu, \"level\": %d, \"strategy\": \"%s\", \"compressedSize\": %zu, "
+                        "\"ratio\": %.6f, ", file->size, level, strategies[s].name, compressed.len,
+                        (double)file->size / compressed.len);
+                json_measurement(out, "compress", &c);
+                fprintf(out, ", ");
+                json_measurement(out, "decompress", &d);
+                fprintf(out, "}");
+                first = 0;
+            }
+        }
+    }
+    fprintf(out, "\n  ]\n}\n");
+    if (out != stdout && fclose(out) != 0) fail("cannot write", options.out);
+    if (out != stdout) fprintf(stderr, "Wrote results to %s\n", options.out);
+
+    free(compressed.data);
+    free(restored.data);
+    for (int f = 0; f < file_count; f++) {
+        if (files[f].owner) free(files[f].data);
+    }
+    free(files);
+    return 0;
+}
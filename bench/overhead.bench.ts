@@ -0,0 +1,188 @@
+/**
+ * zlib.wasm Call Overhead Benchmarks - fixed cost per API call
+ * Run with: deno task benchmark:overhead [options]
+ *
+ *   --sizes <list>        Payload sizes in bytes (default 0,64,1024)
+ *   --batch <n>           Calls per timed batch (default 1000)
+ *   --min-time <ms>       Time per measurement, at least (default 500)
+ *   --max-us <n>          Fail if compress() or decompress() of the smallest
+ *                         payload over 0 bytes takes longer per call (p50)
+ *   --out <file>          JSON report (default bench/overhead-results.json, - for stdout)
+ *
+ * At these sizes deflate and inflate have next to nothing to do, so what is
+ * measured is the wrapper: crossing into WASM, heap allocation, copying the
+ * payload in and the result out, and building the result object. Each
+ * entry point is timed in batches of --batch calls, since one call is below
+ * the resolution of performance.now(); p50/p99 are per-call times over the
+ * batches. compressHeap()/decompressHeap() skip the copies and the result
+ * object, so the gap between them and compress()/decompress() is what the
+ * copying API costs, and crc32() of 0 bytes is close to a bare crossing.
+ */
+
+import Zlib from "../src/lib/index.ts";
+
+interface Options {
+  sizes: number[];
+  batch: number;
+  minTime: number;
+  maxUs?: number;
+  out: string;
+}
+
+interface Measurement {
+  api: string;
+  size: number;
+  calls: number;
+  p50Us: number;
+  p99Us: number;
+  meanUs: number;
+}
+
+function parseArgs(args: string[]): Options {
+  const options: Options = {
+    sizes: [0, 64, 1024],
+    batch: 1000,
+    minTime: 500,
+    out: "bench/overhead-results.json"
+  };
+
+  const list = (value: string) => value.split(",").map(s => s.trim()).filter(Boolean);
+  for (let i = 0; i < args.length; i++) {
+    const arg = args[i];
+    const value = () => {
+      if (i + 1 >= args.length) throw new Error(`${arg} needs a value`);
+      return args[++i];
+    };
+    switch (arg) {
+      case "--sizes": options.sizes = list(value()).map(Number); break;
+      case "--batch": options.batch = Number(value()); break;
+      case "--min-time": options.minTime = Number(value()); break;
+      case "--max-us": options.maxUs = Number(value()); break;
+      case "--out": options.out = value(); break;
+      default: throw new Error(`Unknown option ${arg}`);
+    }
+  }
+
+  for (const size of options.sizes) {
+    if (!Number.isInteger(size) || size < 0) throw new Error(`Invalid size ${size}`);
+  }
+  if (!(options.batch >= 1) || !(options.minTime >= 0)) {
+    throw new Error("--batch and --min-time must be positive");
+  }
+  if (options.maxUs !== undefined && !(options.maxUs > 0)) {
+    throw new Error("--max-us must be positive");
+  }
+  return options;
+}
+
+// Text-like payload, so compress() has matches to find even at 64 bytes
+function payload(size: number): Uint8Array {
+  const text = "The quick brown fox jumps over the lazy dog. ".repeat(Math.ceil(size / 45) + 1);
+  return new TextEncoder().encode(text.slice(0, size));
+}
+
+function percentile(sorted: number[], q: number): number {
+  return sorted[Math.min(sorted.length - 1, Math.max(0, Math.ceil(q * sorted.length) - 1))];
+}
+
+async function measure(api: string, size: number, options: Options, call: () => unknown): Promise<Measurement> {
+  // Warm up: JIT tiers, the heap pool's size classes, lazy module state
+  for (let i = 0; i < options.batch; i++) await call();
+
+  const perCall: number[] = [];
+  let totalMs = 0;
+  while (perCall.length < 5 || totalMs < options.minTime) {
+    const start = performance.now();
+    for (let i = 0; i < options.batch; i++) await call();
+    const elapsed = performance.now() - start;
+    perCall.push(elapsed * 1000 / options.batch);
+    totalMs += elapsed;
+  }
+
+  perCall.sort((a, b) => a - b);
+  return {
+    api,
+    size,
+    calls: perCall.length * options.batch,
+    p50Us: percentile(perCall, 0.5),
+    p99Us: percentile(perCall, 0.99),
+    meanUs: totalMs * 1000 / (perCall.length * options.batch)
+  };
+}
+
+async function runBenchmarks() {
+  const options = parseArgs(Deno.args);
+
+  const zlib = new Zlib();
+  await zlib.initialize();
+
+  const capabilities = zlib.getCapabilities();
+  console.log("zlib.wasm Call Overhead Benchmarks");
+  console.log("==================================");
+  console.log(`zlib ${capabilities.version}, SIMD ${capabilities.simdSupported ? "on" : "off"}, ${options.batch} calls per batch`);
+
+  const results: Measurement[] = [];
+  const report = (m: Measurement) => {
+    results.push(m);
+    console.log(`  ${m.api.padEnd(16)} ${String(m.size).padStart(6)} B  p50 ${m.p50Us.toFixed(2).padStart(8)} us  p99 ${m.p99Us.toFixed(2).padStart(8)} us`);
+  };
+
+  try {
+    report(await measure("getCapabilities", 0, options, () => zlib.getCapabilities()));
+
+    for (const size of options.sizes) {
+      const data = payload(size);
+      const compressed = (await zlib.compress(data)).data;
+
+      console.log(`\n${size} B payload (${compressed.length} B compressed):`);
+      report(await measure("compress", size, options, () => zlib.compress(data)));
+      report(await measure("decompress", size, options, () => zlib.decompress(compressed, { expectedSize: size })));
+
+      const input = zlib.acquireBuffer(size).write(data);
+      const packed = zlib.acquireBuffer(compressed.length).write(compressed);
+      const restored = zlib.acquireBuffer(size);
+      try {
+        report(await measure("compressHeap", size, options, () => zlib.releaseBuffer(zlib.compressHeap(input))));
+        report(await measure("decompressHeap", size, options, () => zlib.decompressHeap(packed, restored)));
+      } finally {
+        zlib.releaseBuffer(input);
+        zlib.releaseBuffer(packed);
+        zlib.releaseBuffer(restored);
+      }
+
+      report(await measure("crc32", size, options, () => zlib.crc32(data)));
+      report(await measure("adler32", size, options, () => zlib.adler32(data)));
+    }
+  } finally {
+    zlib.cleanup();
+  }
+
+  const json = JSON.stringify({ date: new Date().toISOString(), batch: options.batch, results }, null, 2);
+  if (options.out === "-") {
+    console.log(json);
+  } else {
+    await Deno.writeTextFile(options.out, json);
+    console.error(`Wrote ${results.length} results to ${options.out}`);
+  }
+
+  if (options.maxUs !== undefined) {
+    const smallest = Math.min(...options.sizes.filter(size => size > 0));
+    const over = results.filter(m =>
+      m.size === smallest && (m.api === "compress" || m.api === "decompress") && m.p50Us > options.maxUs!
+    );
+    for (const m of over) {
+      console.error(`${m.api} of ${m.size} B takes ${m.p50Us.toFixed(2)} us per call, over the ${options.maxUs} us budget`);
+    }
+    if (over.length > 0) Deno.exit(1);
+  }
+}
+
+if (import.meta.main) {
+  try {
+    await runBenchmarks();
+  } catch (error) {
+    const errorMessage = error instanceof Error ? error.message : String(error);
+    console.error("Overhead benchmark failed:", errorMessage);
+    Deno.exit(1);
+  }
+}
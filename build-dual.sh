@@ -15,6 +15,26 @@ INSTALL_PREFIX="${INSTALL_PREFIX:-./install}"
 BUILD_DIR="${BUILD_DIR:-./build-dual}"
 VARIANT="${1:-all}"
 
+# Serve z_stream state from per-stream arena slabs (ZLIB_ARENA=0 to use plain dlmalloc)
+if [ "${ZLIB_ARENA:-1}" = "1" ]; then
+    ARENA_FLAGS="-DZLIB_WASM_ARENA ../src/zlib_arena.c"
+else
+    ARENA_FLAGS=""
+fi
+
+# Hash chain key for deflate (ZLIB_HASH=mul for the four-byte multiplicative hash)
+if [ "${ZLIB_HASH:-rolling}" = "mul" ]; then
+    ARENA_FLAGS="${ARENA_FLAGS} -DZLIB_HASH_MUL"
+fi
+
+# Hot-path counters and timers read through zlib_get_stats() (ZLIB_STATS=1;
+# not in the -pthread build, since the counters are not shared between threads)
+if [ "${ZLIB_STATS:-0}" = "1" ]; then
+    STATS_FLAGS="-DZLIB_WASM_STATS"
+else
+    STATS_FLAGS=""
+fi
+
 # Colors for output
 RED='\033[0;31m'
 GREEN='\033[0;32m'
@@ -75,10 +95,15 @@ build_zlib_main_module() {
     # Core zlib sources + SIMD compression
     ZLIB_SOURCES="../adler32.c ../compress.c ../crc32.c ../deflate.c ../infback.c ../inffast.c ../inflate.c ../inftrees.c ../trees.c ../uncompr.c ../zutil.c"
     SIMD_SOURCES="../src/zlib_simd_compression.c ../src/zlib_simd_optimized.c"
+    MINIZIP_SOURCES="../contrib/minizip/zip.c ../contrib/minizip/unzip.c ../contrib/minizip/ioapi.c ../contrib/minizip/iomem.c ../src/zlib_zip.c ../src/zlib_unzip.c ../contrib/infback9/infback9.c ../contrib/infback9/inftree9.c"
+    GZ_SOURCES="../gzlib.c ../gzread.c ../gzwrite.c ../gzclose.c ../src/zlib_gzfile.c"
 
     # MAIN_MODULE build with full optimizations + SIMD (DEFAULT)
-    emcc ${ZLIB_SOURCES} ${SIMD_SOURCES} ../src/wasm_module.c \
+    emcc ${ZLIB_SOURCES} ${SIMD_SOURCES} ../src/wasm_module.c ../src/zlib_snapshot.c ../src/zlib_index.c ../src/zlib_gzjoin.c ../src/zlib_bgzf.c ../src/zlib_infback.c ../src/zlib_stats.c ${GZ_SOURCES} ${MINIZIP_SOURCES} ${ARENA_FLAGS} ${STATS_FLAGS} \
         -I.. \
+        -I../contrib/minizip \
+        -I../contrib/infback9 \
+        -DNOCRYPT -DNOUNCRYPT -DIOAPI_NO_64 \
         -DHAVE_UNISTD_H=0 \
         -O3 \
         -flto \
@@ -87,7 +112,7 @@ build_zlib_main_module() {
         -sMODULARIZE=1 \
         -sEXPORT_ES6=1 \
         -sEXPORT_NAME="ZlibModule" \
-        -sEXPORTED_FUNCTIONS='["_zlib_compress_buffer","_zlib_decompress_buffer","_zlib_crc32","_zlib_adler32","_zlib_compress_bound","_zlib_get_version","_zlib_compress_simd","_zlib_crc32_simd_optimized","_zlib_benchmark_simd_compression","_zlib_simd_capabilities","_zlib_simd_analysis","_zlib_slide_hash_simd","_zlib_compare256_simd","_zlib_adler32_simd","_zlib_longest_match_simd","_zlib_chunkmemset_simd","_zlib_compress_simd_full","_zlib_crc32_simd_enhanced","_zlib_simd_capabilities_enhanced","_zlib_simd_performance_analysis","_malloc","_free"]' \
+        -sEXPORTED_FUNCTIONS='["_zlib_compress_buffer","_zlib_compress_batch","_zlib_compress_batch_bound","_zlib_compress_dict","_zlib_compress_auto","_zlib_dict_snapshot_create","_zlib_compress_snapshot","_zlib_index_create","_zlib_index_feed","_zlib_index_finish","_zlib_index_points","_zlib_index_length","_zlib_index_serialize","_zlib_index_load","_zlib_index_serialize_segment","_zlib_index_point_out","_zlib_index_point_in","_zlib_index_extract_begin","_zlib_index_extract_next","_zlib_index_free","_zlib_zip_open","_zlib_zip_open_memory","_zlib_zip_add","_zlib_zip_add_deflated","_zlib_zip_close","_zlib_zip_open_stream","_zlib_zip_take","_zlib_zip_begin","_zlib_zip_write","_zlib_zip_end","_zlib_unzip_open_memory","_zlib_unzip_count","_zlib_unzip_extract","_zlib_unzip_extract_batch","_zlib_unzip_locate","_zlib_unzip_inflate","_zlib_unzip_close","_zlib_decompress_buffer","_zlib_decompress_alloc","_zlib_decompress_dict_alloc","_zlib_decompress_limit_alloc","_zlib_decompress_batch","_zlib_ctx_acquire","_zlib_ctx_release","_zlib_ctx_pool_drain","_zlib_deflate_init","_zlib_deflate_init_profile","_zlib_deflate_process","_zlib_deflate_end","_zlib_inflate_init","_zlib_inflate_process","_zlib_inflate_end","_zlib_inflate_reset","_zlib_deflate_reset","_zlib_deflate_params","_zlib_ctx_memory","_zlib_stream_avail_in","_zlib_stream_avail_out","_zlib_stream_ring","_zlib_deflate_drain","_zlib_inflate_drain","_zlib_crc32","_zlib_adler32","_zlib_gzjoin","_zlib_gzjoin_bound","_zlib_gzip_members","_zlib_bgzf_member","_zlib_bgzf_compress","_zlib_bgzf_bound","_zlib_gzfile_open","_zlib_gzfile_read","_zlib_gzfile_write","_zlib_gzfile_error","_zlib_gzfile_close","_zlib_inflate_back","_zlib_crc32_combine","_zlib_adler32_combine","_zlib_crc32_combine_gen","_zlib_crc32_combine_op","_zlib_compress_block","_zlib_compress_block_bound","_zlib_compress_bound","_zlib_compress_format","_zlib_compress_format_bound","_zlib_rsync_scan","_zlib_rsync_boundaries","_zlib_get_version","_zlib_get_stats","_zlib_reset_stats","_zlib_compress_simd","_zlib_crc32_simd_optimized","_zlib_benchmark_simd_compression","_zlib_simd_capabilities","_zlib_simd_analysis","_zlib_slide_hash_simd","_zlib_compare256_simd","_zlib_adler32_simd","_zlib_longest_match_simd","_zlib_chunkmemset_simd","_zlib_compress_simd_full","_zlib_crc32_simd_enhanced","_zlib_simd_capabilities_enhanced","_zlib_simd_performance_analysis","_malloc","_free"]' \
         -sEXPORTED_RUNTIME_METHODS='["cwrap","ccall","UTF8ToString","getValue","setValue","HEAPU8","HEAP8","HEAP32"]' \
         -sALLOW_MEMORY_GROWTH=1 \
         -sASSERTIONS=1 \
@@ -95,7 +120,7 @@ build_zlib_main_module() {
         -o zlib-release.js
 
     # Also build fallback version for compatibility (less optimized, no SIMD)
-    emcc ${ZLIB_SOURCES} ../src/wasm_module.c \
+    emcc ${ZLIB_SOURCES} ../src/wasm_module.c ../src/zlib_snapshot.c \
         -I.. \
         -DHAVE_UNISTD_H=0 \
         -O2 \
@@ -103,7 +128,7 @@ build_zlib_main_module() {
         -sMODULARIZE=1 \
         -sEXPORT_ES6=1 \
         -sEXPORT_NAME="ZlibModule" \
-        -sEXPORTED_FUNCTIONS='["_zlib_compress_buffer","_zlib_decompress_buffer","_zlib_crc32","_zlib_adler32","_zlib_compress_bound","_zlib_get_version","_malloc","_free"]' \
+        -sEXPORTED_FUNCTIONS='["_zlib_compress_buffer","_zlib_decompress_buffer","_zlib_decompress_alloc","_zlib_crc32","_zlib_adler32","_zlib_compress_bound","_zlib_compress_format","_zlib_compress_format_bound","_zlib_rsync_scan","_zlib_rsync_boundaries","_zlib_get_version","_malloc","_free"]' \
         -sEXPORTED_RUNTIME_METHODS='["cwrap","ccall","UTF8ToString","getValue","setValue","HEAPU8","HEAP8","HEAP32"]' \
         -sALLOW_MEMORY_GROWTH=1 \
         -sASSERTIONS=1 \
@@ -113,6 +138,189 @@ build_zlib_main_module() {
     cd ..
 }
 
+# Build the MAIN_MODULE again without -msimd128, for A/B benchmarks
+build_zlib_main_module_scalar() {
+    log_info "Building scalar zlib.wasm MAIN_MODULE (no SIMD) for A/B benchmarks..."
+
+    mkdir -p "${BUILD_DIR}-main-scalar"
+    cd "${BUILD_DIR}-main-scalar"
+
+    ZLIB_SOURCES="../adler32.c ../compress.c ../crc32.c ../deflate.c ../infback.c ../inffast.c ../inflate.c ../inftrees.c ../trees.c ../uncompr.c ../zutil.c"
+    MINIZIP_SOURCES="../contrib/minizip/zip.c ../contrib/minizip/unzip.c ../contrib/minizip/ioapi.c ../contrib/minizip/iomem.c ../src/zlib_zip.c ../src/zlib_unzip.c ../contrib/infback9/infback9.c ../contrib/infback9/inftree9.c"
+    GZ_SOURCES="../gzlib.c ../gzread.c ../gzwrite.c ../gzclose.c ../src/zlib_gzfile.c"
+
+    # zlib-release.js with every __wasm_simd128__ path compiled out: same
+    # sources, flags and exports apart from the SIMD kernels' own entry
+    # points, so the two modules differ only in the code paths under test
+    emcc ${ZLIB_SOURCES} ../src/wasm_module.c ../src/zlib_snapshot.c ../src/zlib_index.c ../src/zlib_gzjoin.c ../src/zlib_bgzf.c ../src/zlib_infback.c ../src/zlib_stats.c ${GZ_SOURCES} ${MINIZIP_SOURCES} ${ARENA_FLAGS} ${STATS_FLAGS} \
+        -I.. \
+        -I../contrib/minizip \
+        -I../contrib/infback9 \
+        -DNOCRYPT -DNOUNCRYPT -DIOAPI_NO_64 \
+        -DHAVE_UNISTD_H=0 \
+        -O3 \
+        -flto \
+        -sWASM=1 \
+        -sMODULARIZE=1 \
+        -sEXPORT_ES6=1 \
+        -sEXPORT_NAME="ZlibModule" \
+        -sEXPORTED_FUNCTIONS='["_zlib_compress_buffer","_zlib_compress_batch","_zlib_compress_batch_bound","_zlib_compress_dict","_zlib_compress_auto","_zlib_dict_snapshot_create","_zlib_compress_snapshot","_zlib_index_create","_zlib_index_feed","_zlib_index_finish","_zlib_index_points","_zlib_index_length","_zlib_index_serialize","_zlib_index_load","_zlib_index_serialize_segment","_zlib_index_point_out","_zlib_index_point_in","_zlib_index_extract_begin","_zlib_index_extract_next","_zlib_index_free","_zlib_zip_open","_zlib_zip_open_memory","_zlib_zip_add","_zlib_zip_add_deflated","_zlib_zip_close","_zlib_zip_open_stream","_zlib_zip_take","_zlib_zip_begin","_zlib_zip_write","_zlib_zip_end","_zlib_unzip_open_memory","_zlib_unzip_count","_zlib_unzip_extract","_zlib_unzip_extract_batch","_zlib_unzip_locate","_zlib_unzip_inflate","_zlib_unzip_close","_zlib_decompress_buffer","_zlib_decompress_alloc","_zlib_decompress_dict_alloc","_zlib_decompress_limit_alloc","_zlib_decompress_batch","_zlib_ctx_acquire","_zlib_ctx_release","_zlib_ctx_pool_drain","_zlib_deflate_init","_zlib_deflate_init_profile","_zlib_deflate_process","_zlib_deflate_end","_zlib_inflate_init","_zlib_inflate_process","_zlib_inflate_end","_zlib_inflate_reset","_zlib_deflate_reset","_zlib_deflate_params","_zlib_ctx_memory","_zlib_stream_avail_in","_zlib_stream_avail_out","_zlib_stream_ring","_zlib_deflate_drain","_zlib_inflate_drain","_zlib_crc32","_zlib_adler32","_zlib_gzjoin","_zlib_gzjoin_bound","_zlib_gzip_members","_zlib_bgzf_member","_zlib_bgzf_compress","_zlib_bgzf_bound","_zlib_gzfile_open","_zlib_gzfile_read","_zlib_gzfile_write","_zlib_gzfile_error","_zlib_gzfile_close","_zlib_inflate_back","_zlib_crc32_combine","_zlib_adler32_combine","_zlib_crc32_combine_gen","_zlib_crc32_combine_op","_zlib_compress_block","_zlib_compress_block_bound","_zlib_compress_bound","_zlib_compress_format","_zlib_compress_format_bound","_zlib_rsync_scan","_zlib_rsync_boundaries","_zlib_get_version","_zlib_get_stats","_zlib_reset_stats","_malloc","_free"]' \
+        -sEXPORTED_RUNTIME_METHODS='["cwrap","ccall","UTF8ToString","getValue","setValue","HEAPU8","HEAP8","HEAP32"]' \
+        -sALLOW_MEMORY_GROWTH=1 \
+        -sASSERTIONS=1 \
+        -sNO_EXIT_RUNTIME=1 \
+        -o zlib-release-scalar.js
+
+    log_success "scalar MAIN_MODULE build completed: $(pwd)/zlib-release-scalar.js"
+    cd ..
+}
+
+# Build the inflate-only core loaded first by ZlibCore, for fast startup
+build_zlib_core_module() {
+    log_info "Building inflate-only zlib.wasm core for lazy loading..."
+
+    mkdir -p "${BUILD_DIR}-main-core"
+    cd "${BUILD_DIR}-main-core"
+
+    CORE_SOURCES="../adler32.c ../crc32.c ../inffast.c ../inflate.c ../inftrees.c ../zutil.c"
+
+    # Sized for download and compile time rather than speed: no deflate, no
+    # SIMD kernels, no filesystem, emmalloc; the full zlib-release.js is
+    # loaded behind it when anything else is needed
+    emcc ${CORE_SOURCES} ../src/zlib_core.c \
+        -I.. \
+        -DHAVE_UNISTD_H=0 \
+        -Oz \
+        -flto \
+        -sWASM=1 \
+        -sMODULARIZE=1 \
+        -sEXPORT_ES6=1 \
+        -sEXPORT_NAME="ZlibModule" \
+        -sEXPORTED_FUNCTIONS='["_zlib_decompress_dict_alloc","_zlib_decompress_limit_alloc","_zlib_decompress_alloc","_zlib_crc32","_zlib_adler32","_zlib_get_version","_malloc","_free"]' \
+        -sEXPORTED_RUNTIME_METHODS='["HEAPU8","HEAP32"]' \
+        -sALLOW_MEMORY_GROWTH=1 \
+        -sINITIAL_MEMORY=1MB \
+        -sSTACK_SIZE=64KB \
+        -sMALLOC=emmalloc \
+        -sFILESYSTEM=0 \
+        -sNO_EXIT_RUNTIME=1 \
+        -o zlib-release-core.js
+
+    log_success "inflate-only core build completed: $(pwd)/zlib-release-core.js"
+    cd ..
+}
+
+# Build the deflate-only counterpart of the core, for ZlibDeflate
+build_zlib_deflate_module() {
+    log_info "Building deflate-only zlib.wasm slim module..."
+
+    mkdir -p "${BUILD_DIR}-main-deflate"
+    cd "${BUILD_DIR}-main-deflate"
+
+    DEFLATE_SOURCES="../adler32.c ../compress.c ../crc32.c ../deflate.c ../trees.c ../zutil.c"
+
+    # Same size-first settings as the core; no inflate and no SIMD kernels
+    emcc ${DEFLATE_SOURCES} ../src/zlib_deflate_core.c \
+        -I.. \
+        -DHAVE_UNISTD_H=0 \
+        -Oz \
+        -flto \
+        -sWASM=1 \
+        -sMODULARIZE=1 \
+        -sEXPORT_ES6=1 \
+        -sEXPORT_NAME="ZlibModule" \
+        -sEXPORTED_FUNCTIONS='["_zlib_compress_buffer","_zlib_compress_bound","_zlib_deflate_init","_zlib_deflate_process","_zlib_deflate_reset","_zlib_deflate_end","_zlib_stream_avail_in","_zlib_stream_avail_out","_zlib_crc32","_zlib_adler32","_zlib_get_version","_malloc","_free"]' \
+        -sEXPORTED_RUNTIME_METHODS='["HEAPU8","HEAP32"]' \
+        -sALLOW_MEMORY_GROWTH=1 \
+        -sINITIAL_MEMORY=1MB \
+        -sSTACK_SIZE=64KB \
+        -sMALLOC=emmalloc \
+        -sFILESYSTEM=0 \
+        -sNO_EXIT_RUNTIME=1 \
+        -o zlib-release-deflate.js
+
+    log_success "deflate-only build completed: $(pwd)/zlib-release-deflate.js"
+    cd ..
+}
+
+# Build the -sMEMORY64 MAIN_MODULE variant for buffers past 4 GB
+build_zlib_main_module_memory64() {
+    log_info "Building zlib.wasm MAIN_MODULE with a 64-bit heap..."
+
+    mkdir -p "${BUILD_DIR}-main-memory64"
+    cd "${BUILD_DIR}-main-memory64"
+
+    ZLIB_SOURCES="../adler32.c ../compress.c ../crc32.c ../deflate.c ../infback.c ../inffast.c ../inflate.c ../inftrees.c ../trees.c ../uncompr.c ../zutil.c"
+    SIMD_SOURCES="../src/zlib_simd_compression.c ../src/zlib_simd_optimized.c"
+
+    # wasm64: pointers and unsigned long are 64 bits, so one-shot calls and
+    # their length cells reach past the 4 GB wasm32 limit. The exports are
+    # the buffer and streaming calls Zlib uses on this build; the JS side
+    # converts their 64-bit arguments to and from BigInt (memory64.ts)
+    emcc ${ZLIB_SOURCES} ${SIMD_SOURCES} ../src/wasm_module.c ../src/zlib_snapshot.c ${ARENA_FLAGS} \
+        -I.. \
+        -DHAVE_UNISTD_H=0 \
+        -O3 \
+        -flto \
+        -msimd128 \
+        -sMEMORY64=1 \
+        -sWASM=1 \
+        -sMODULARIZE=1 \
+        -sEXPORT_ES6=1 \
+        -sEXPORT_NAME="ZlibModule" \
+        -sEXPORTED_FUNCTIONS='["_zlib_compress_buffer","_zlib_compress_bound","_zlib_compress_format","_zlib_compress_format_bound","_zlib_rsync_scan","_zlib_rsync_boundaries","_zlib_decompress_buffer","_zlib_decompress_alloc","_zlib_decompress_dict_alloc","_zlib_decompress_limit_alloc","_zlib_ctx_pool_drain","_zlib_ctx_memory","_zlib_deflate_init","_zlib_deflate_init_profile","_zlib_deflate_process","_zlib_deflate_reset","_zlib_deflate_params","_zlib_deflate_end","_zlib_inflate_init","_zlib_inflate_process","_zlib_inflate_reset","_zlib_inflate_end","_zlib_stream_avail_in","_zlib_stream_avail_out","_zlib_stream_ring","_zlib_deflate_drain","_zlib_inflate_drain","_zlib_crc32","_zlib_adler32","_zlib_crc32_combine","_zlib_adler32_combine","_zlib_crc32_combine_gen","_zlib_crc32_combine_op","_zlib_get_version","_zlib_simd_capabilities","_malloc","_free"]' \
+        -sEXPORTED_RUNTIME_METHODS='["HEAPU8","HEAP32"]' \
+        -sALLOW_MEMORY_GROWTH=1 \
+        -sMAXIMUM_MEMORY=16GB \
+        -sNO_EXIT_RUNTIME=1 \
+        -o zlib-release-memory64.js
+
+    log_success "memory64 MAIN_MODULE build completed: $(pwd)/zlib-release-memory64.js"
+    cd ..
+}
+
+# Build the -pthread MAIN_MODULE variant with a shared-memory heap
+build_zlib_main_module_threaded() {
+    log_info "Building zlib.wasm pthreads MAIN_MODULE (SharedArrayBuffer heap)..."
+
+    mkdir -p "${BUILD_DIR}-main-mt"
+    cd "${BUILD_DIR}-main-mt"
+
+    ZLIB_SOURCES="../adler32.c ../compress.c ../crc32.c ../deflate.c ../infback.c ../inffast.c ../inflate.c ../inftrees.c ../trees.c ../uncompr.c ../zutil.c"
+    SIMD_SOURCES="../src/zlib_simd_compression.c ../src/zlib_simd_optimized.c"
+    MINIZIP_SOURCES="../contrib/minizip/zip.c ../contrib/minizip/unzip.c ../contrib/minizip/ioapi.c ../contrib/minizip/iomem.c ../src/zlib_zip.c ../src/zlib_unzip.c ../contrib/infback9/infback9.c ../contrib/infback9/inftree9.c"
+    GZ_SOURCES="../gzlib.c ../gzread.c ../gzwrite.c ../gzclose.c ../src/zlib_gzfile.c"
+    THREADS="${ZLIB_THREADS:-8}"
+
+    # Same exports as zlib-release.js plus the native thread-pool compressor;
+    # the pool is created at startup so zlib_compress_parallel never waits on
+    # the browser to spawn a worker
+    emcc ${ZLIB_SOURCES} ${SIMD_SOURCES} ../src/wasm_module.c ../src/zlib_snapshot.c ../src/zlib_index.c ../src/zlib_gzjoin.c ../src/zlib_bgzf.c ../src/zlib_infback.c ../src/zlib_parallel.c ../src/zlib_stats.c ${GZ_SOURCES} ${MINIZIP_SOURCES} ${ARENA_FLAGS} \
+        -I.. \
+        -I../contrib/minizip \
+        -I../contrib/infback9 \
+        -DNOCRYPT -DNOUNCRYPT -DIOAPI_NO_64 \
+        -DHAVE_UNISTD_H=0 \
+        -O3 \
+        -flto \
+        -msimd128 \
+        -pthread \
+        -sPTHREAD_POOL_SIZE=${THREADS} \
+        -sWASM=1 \
+        -sMODULARIZE=1 \
+        -sEXPORT_ES6=1 \
+        -sEXPORT_NAME="ZlibModule" \
+        -sEXPORTED_FUNCTIONS='["_zlib_compress_buffer","_zlib_compress_batch","_zlib_compress_batch_bound","_zlib_compress_dict","_zlib_compress_auto","_zlib_dict_snapshot_create","_zlib_compress_snapshot","_zlib_index_create","_zlib_index_feed","_zlib_index_finish","_zlib_index_points","_zlib_index_length","_zlib_index_serialize","_zlib_index_load","_zlib_index_serialize_segment","_zlib_index_point_out","_zlib_index_point_in","_zlib_index_extract_begin","_zlib_index_extract_next","_zlib_index_free","_zlib_zip_open","_zlib_zip_open_memory","_zlib_zip_add","_zlib_zip_add_deflated","_zlib_zip_close","_zlib_zip_open_stream","_zlib_zip_take","_zlib_zip_begin","_zlib_zip_write","_zlib_zip_end","_zlib_unzip_open_memory","_zlib_unzip_count","_zlib_unzip_extract","_zlib_unzip_extract_batch","_zlib_unzip_locate","_zlib_unzip_inflate","_zlib_unzip_close","_zlib_decompress_buffer","_zlib_decompress_alloc","_zlib_decompress_dict_alloc","_zlib_decompress_limit_alloc","_zlib_decompress_batch","_zlib_ctx_acquire","_zlib_ctx_release","_zlib_ctx_pool_drain","_zlib_deflate_init","_zlib_deflate_init_profile","_zlib_deflate_process","_zlib_deflate_end","_zlib_inflate_init","_zlib_inflate_process","_zlib_inflate_end","_zlib_inflate_reset","_zlib_deflate_reset","_zlib_deflate_params","_zlib_ctx_memory","_zlib_stream_avail_in","_zlib_stream_avail_out","_zlib_stream_ring","_zlib_deflate_drain","_zlib_inflate_drain","_zlib_crc32","_zlib_adler32","_zlib_gzjoin","_zlib_gzjoin_bound","_zlib_gzip_members","_zlib_bgzf_member","_zlib_bgzf_compress","_zlib_bgzf_bound","_zlib_gzfile_open","_zlib_gzfile_read","_zlib_gzfile_write","_zlib_gzfile_error","_zlib_gzfile_close","_zlib_inflate_back","_zlib_crc32_combine","_zlib_adler32_combine","_zlib_crc32_combine_gen","_zlib_crc32_combine_op","_zlib_compress_block","_zlib_compress_block_bound","_zlib_compress_parallel","_zlib_compress_parallel_bound","_zlib_crc32_parallel","_zlib_bgzf_compress_parallel","_zlib_zip_add_parallel","_zlib_unzip_extract_parallel","_zlib_compress_bound","_zlib_compress_format","_zlib_compress_format_bound","_zlib_rsync_scan","_zlib_rsync_boundaries","_zlib_get_version","_zlib_get_stats","_zlib_reset_stats","_malloc","_free"]' \
+        -sEXPORTED_RUNTIME_METHODS='["cwrap","ccall","UTF8ToString","getValue","setValue","HEAPU8","HEAP8","HEAP32"]' \
+        -sALLOW_MEMORY_GROWTH=1 \
+        -sINITIAL_MEMORY=64MB \
+        -sNO_EXIT_RUNTIME=1 \
+        -o zlib-release-mt.js
+
+    log_success "pthreads MAIN_MODULE build completed: $(pwd)/zlib-release-mt.js"
+    cd ..
+}
+
 # Install artifacts
 install_artifacts() {
     log_info "Installing build artifacts..."
@@ -132,6 +340,36 @@ install_artifacts() {
         log_success "Installed MAIN_MODULE: ${INSTALL_PREFIX}/wasm/zlib-release.js"
     fi
     
+    if [ -f "${BUILD_DIR}-main-mt/zlib-release-mt.js" ]; then
+        cp "${BUILD_DIR}-main-mt/zlib-release-mt.js" "${INSTALL_PREFIX}/wasm/"
+        cp "${BUILD_DIR}-main-mt/zlib-release-mt.wasm" "${INSTALL_PREFIX}/wasm/"
+        log_success "Installed pthreads MAIN_MODULE: ${INSTALL_PREFIX}/wasm/zlib-release-mt.js"
+    fi
+
+    if [ -f "${BUILD_DIR}-main-scalar/zlib-release-scalar.js" ]; then
+        cp "${BUILD_DIR}-main-scalar/zlib-release-scalar.js" "${INSTALL_PREFIX}/wasm/"
+        cp "${BUILD_DIR}-main-scalar/zlib-release-scalar.wasm" "${INSTALL_PREFIX}/wasm/"
+        log_success "Installed scalar MAIN_MODULE: ${INSTALL_PREFIX}/wasm/zlib-release-scalar.js"
+    fi
+
+    if [ -f "${BUILD_DIR}-main-memory64/zlib-release-memory64.js" ]; then
+        cp "${BUILD_DIR}-main-memory64/zlib-release-memory64.js" "${INSTALL_PREFIX}/wasm/"
+        cp "${BUILD_DIR}-main-memory64/zlib-release-memory64.wasm" "${INSTALL_PREFIX}/wasm/"
+        log_success "Installed memory64 MAIN_MODULE: ${INSTALL_PREFIX}/wasm/zlib-release-memory64.js"
+    fi
+
+    if [ -f "${BUILD_DIR}-main-core/zlib-release-core.js" ]; then
+        cp "${BUILD_DIR}-main-core/zlib-release-core.js" "${INSTALL_PREFIX}/wasm/"
+        cp "${BUILD_DIR}-main-core/zlib-release-core.wasm" "${INSTALL_PREFIX}/wasm/"
+        log_success "Installed inflate-only core: ${INSTALL_PREFIX}/wasm/zlib-release-core.js"
+    fi
+
+    if [ -f "${BUILD_DIR}-main-deflate/zlib-release-deflate.js" ]; then
+        cp "${BUILD_DIR}-main-deflate/zlib-release-deflate.js" "${INSTALL_PREFIX}/wasm/"
+        cp "${BUILD_DIR}-main-deflate/zlib-release-deflate.wasm" "${INSTALL_PREFIX}/wasm/"
+        log_success "Installed deflate-only module: ${INSTALL_PREFIX}/wasm/zlib-release-deflate.js"
+    fi
+
     if [ -f "${BUILD_DIR}-main-release/zlib-fallback.js" ]; then
         cp "${BUILD_DIR}-main-release/zlib-fallback.js" "${INSTALL_PREFIX}/wasm/"
         cp "${BUILD_DIR}-main-release/zlib-fallback.wasm" "${INSTALL_PREFIX}/wasm/"
@@ -157,7 +395,7 @@ install_artifacts() {
 clean_build() {
     log_info "Cleaning build artifacts..."
     
-    rm -rf "${BUILD_DIR}-side" "${BUILD_DIR}-main-release" "${BUILD_DIR}-main-fallback" "${BUILD_DIR}-main-simd"
+    rm -rf "${BUILD_DIR}-side" "${BUILD_DIR}-main-release" "${BUILD_DIR}-main-fallback" "${BUILD_DIR}-main-simd" "${BUILD_DIR}-main-mt" "${BUILD_DIR}-main-scalar" "${BUILD_DIR}-main-memory64" "${BUILD_DIR}-main-core" "${BUILD_DIR}-main-deflate"
     rm -rf "${INSTALL_PREFIX}"
     rm -rf build/
     rm -rf dist/
@@ -179,13 +417,41 @@ main() {
             build_zlib_main_module
             install_artifacts
             ;;
+        "mt")
+            build_zlib_main_module_threaded
+            install_artifacts
+            ;;
+        "scalar")
+            build_zlib_main_module_scalar
+            install_artifacts
+            ;;
+        "memory64")
+            build_zlib_main_module_memory64
+            install_artifacts
+            ;;
+        "core"|"inflate")
+            build_zlib_core_module
+            install_artifacts
+            ;;
+        "deflate")
+            build_zlib_deflate_module
+            install_artifacts
+            ;;
+        "slim")
+            build_zlib_core_module
+            build_zlib_deflate_module
+            install_artifacts
+            ;;
         "all")
             build_zlib_side_module
             build_zlib_main_module
+            build_zlib_main_module_threaded
+            build_zlib_core_module
+            build_zlib_deflate_module
             install_artifacts
             ;;
         *)
-            log_error "Unknown variant: ${VARIANT}. Use 'clean', 'side', 'main', or 'all'"
+            log_error "Unknown variant: ${VARIANT}. Use 'clean', 'side', 'main', 'mt', 'scalar', 'memory64', 'core' (or 'inflate'), 'deflate', 'slim', or 'all'"
             exit 1
             ;;
     esac
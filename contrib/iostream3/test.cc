@@ -6,7 +6,10 @@
  */
 
 #include "zfstream.h"
+#include "zfseek.h"
 #include <iostream>      // for cout
+#include <vector>        // for bulk buffers
+#include <algorithm>     // for equal
 
 int main() {
 
@@ -45,6 +48,35 @@ int main() {
   }
   inf.close();
 
+  std::vector<char> big(1 << 22), back(1 << 22);
+  for (size_t i = 0; i < big.size(); ++i)
+    big[i] = char(i * 7 + (i >> 12));
+  outf.rdbuf()->pubsetbuf(0,0);
+  outf.rdbuf()->setgzbuffer(1 << 20);
+  outf.open("test3.bin.gz");
+  outf << "header\n";
+  outf.write(&big[0], big.size());
+  outf.close();
+  inf.open("test3.bin.gz");
+  inf.getline(buf,80,'\n');
+  inf.read(&back[0], back.size());
+  std::cout << "\nBulk write and read of 4M through 'test3.bin.gz' "
+            << (inf.gcount() == std::streamsize(back.size()) && big == back ? "succeeded" : "FAILED")
+            << std::endl;
+  inf.close();
+
+  gzseekifstream seekf("test3.bin.gz", 1 << 20);
+  seekf.seekg(7 + 3000000);
+  seekf.read(&back[0], 1000);
+  bool seek_ok = seekf.gcount() == 1000 && std::equal(&back[0], &back[1000], &big[3000000]);
+  seekf.seekg(7 + 100);
+  seekf.read(&back[0], 1000);
+  seek_ok = seek_ok && seekf.tellg() == std::streampos(7 + 1100) &&
+            std::equal(&back[0], &back[1000], &big[100]);
+  std::cout << "Seeking through 'test3.bin.gz' with " << seekf.rdbuf()->points()
+            << " access points " << (seek_ok ? "succeeded" : "FAILED") << std::endl;
+  seekf.close();
+
   return 0;
 
 }
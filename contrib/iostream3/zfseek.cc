@@ -0,0 +1,588 @@
+/*
+ * A seekable C++ input stream over gzip, zlib and raw deflate files
+ *
+ * Index building and extraction follow examples/zran.c by Mark Adler.
+ */
+
+#include "zfseek.h"
+#include <cstring>          // for memcpy, memcmp
+
+// Sliding window size, compressed input chunk and stream buffer size
+#define WINSIZE 32768U
+#define CHUNK 16384
+#define SEEKBUFSIZE 65536
+
+// inflateInit2 windowBits for each stream type
+#define RAW -15
+#define ZLIB 15
+#define GZIP 31
+
+// Saved index layout, as in src/zlib_index.c
+#define INDEX_VERSION 1
+#define INDEX_HEADER_SIZE 24
+#define INDEX_POINT_SIZE 26
+
+namespace
+{
+  // Little-endian integers of the saved index
+  void
+  put_le(std::vector<unsigned char>& out, unsigned long long v, int bytes)
+  {
+    for (int i = 0; i < bytes; ++i)
+      out.push_back((unsigned char)(v >> (8 * i)));
+  }
+
+  unsigned long long
+  get_le(const unsigned char* p, int bytes)
+  {
+    unsigned long long v = 0;
+    for (int i = bytes - 1; i >= 0; --i)
+      v = (v << 8) | p[i];
+    return v;
+  }
+}
+
+/*****************************************************************************/
+
+// Default constructor
+gzseekbuf::gzseekbuf()
+: format(0), length(0), input(CHUNK), buffer(SEEKBUFSIZE),
+  buffer_out(0), positioned(false)
+{
+  std::memset(&strm, 0, sizeof(strm));
+  strm_ready = false;
+  this->setg(0, 0, 0);
+}
+
+// Destructor
+gzseekbuf::~gzseekbuf()
+{
+  this->close();
+}
+
+// Open file and build index
+gzseekbuf*
+gzseekbuf::open(const char* name,
+                std::streamoff span)
+{
+  // Fail if file already open
+  if (this->is_open() || file.is_open())
+    return NULL;
+  if (!file.open(name, std::ios_base::in | std::ios_base::binary))
+    return NULL;
+  if (!this->build(span))
+  {
+    this->close();
+    return NULL;
+  }
+  buffer_out = 0;
+  positioned = false;
+  this->setg(&buffer[0], &buffer[0], &buffer[0]);
+  return this;
+}
+
+// Open file with saved index
+gzseekbuf*
+gzseekbuf::open(const char* name,
+                const char* index_name)
+{
+  // Fail if file already open
+  if (this->is_open() || file.is_open())
+    return NULL;
+  if (!file.open(name, std::ios_base::in | std::ios_base::binary))
+    return NULL;
+  if (!this->load(index_name))
+  {
+    this->close();
+    return NULL;
+  }
+  buffer_out = 0;
+  positioned = false;
+  this->setg(&buffer[0], &buffer[0], &buffer[0]);
+  return this;
+}
+
+// Close file and drop index
+gzseekbuf*
+gzseekbuf::close()
+{
+  // Fail immediately if no file is open
+  if (!file.is_open())
+    return NULL;
+  index.clear();
+  if (strm_ready)
+    inflateEnd(&strm);
+  strm_ready = false;
+  positioned = false;
+  this->setg(0, 0, 0);
+  return file.close() ? this : NULL;
+}
+
+// Save index in the src/zlib_index.c layout
+bool
+gzseekbuf::save_index(const char* index_name) const
+{
+  if (!this->is_open())
+    return false;
+
+  std::vector<unsigned char> out;
+  out.insert(out.end(), "ZIDX", "ZIDX" + 4);
+  put_le(out, INDEX_VERSION, 4);
+  put_le(out, (unsigned)format, 4);
+  put_le(out, length, 8);
+  put_le(out, index.size(), 4);
+  for (std::size_t i = 0; i < index.size(); ++i)
+  {
+    const access_point& point = index[i];
+    put_le(out, point.out, 8);
+    put_le(out, point.in, 8);
+    put_le(out, point.dict, 4);
+    put_le(out, point.window.size(), 4);
+    out.push_back((unsigned char)point.bits);
+    out.push_back(point.prime);
+  }
+  for (std::size_t i = 0; i < index.size(); ++i)
+    out.insert(out.end(), index[i].window.begin(), index[i].window.end());
+
+  std::filebuf saved;
+  if (!saved.open(index_name, std::ios_base::out | std::ios_base::trunc |
+                              std::ios_base::binary))
+    return false;
+  bool ok = saved.sputn((const char*)&out[0], out.size()) == std::streamsize(out.size());
+  return saved.close() && ok;
+}
+
+// Decompress whole file once, as zran's deflate_index_build
+bool
+gzseekbuf::build(std::streamoff span)
+{
+  if (span < 1)
+    return false;
+
+  // Windows are kept raw-deflated
+  z_stream pack;
+  std::memset(&pack, 0, sizeof(pack));
+  if (deflateInit2(&pack, Z_DEFAULT_COMPRESSION, Z_DEFLATED, RAW, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK)
+    return false;
+
+  std::vector<unsigned char> win(WINSIZE);   // output sliding window
+  std::streamoff totin = 0;                  // total bytes read from file
+  std::streamoff totout = 0;                 // total bytes uncompressed
+  std::streamoff last = 0;                   // offset of last access point
+  unsigned char last_byte = 0;               // last byte of previous chunk
+  std::streamoff beg = 0;                    // offset of last history reset
+  int ret = Z_OK;
+
+  format = 0;
+  strm.avail_in = 0;
+  strm.avail_out = 0;
+  do
+  {
+    // Assure available input, at least until reaching EOF
+    if (strm.avail_in == 0)
+    {
+      if (totin)
+        last_byte = input[CHUNK - 1];
+      strm.next_in = &input[0];
+      strm.avail_in = (uInt)file.sgetn((char*)&input[0], CHUNK);
+      totin += strm.avail_in;
+
+      if (format == 0)
+      {
+        // Determine the type at the start of the input, as zran does
+        format = strm.avail_in == 0 ? RAW :
+                 (input[0] & 0xf) == 8 ? ZLIB :
+                 input[0] == 0x1f ? GZIP : RAW;
+        if ((ret = inflateInit2(&strm, format)) != Z_OK)
+          break;
+        strm_ready = true;
+      }
+    }
+
+    // Rotate the output through the sliding window
+    if (strm.avail_out == 0)
+    {
+      strm.avail_out = WINSIZE;
+      strm.next_out = &win[0];
+    }
+
+    if (format == RAW && index.empty())
+      // Add an access point at the very start of raw deflate data
+      strm.data_type = 0x80;
+    else
+    {
+      unsigned before = strm.avail_out;
+      ret = inflate(&strm, Z_BLOCK);
+      totout += before - strm.avail_out;
+    }
+
+    // At the end of a header or a non-last block, and due a new point?
+    if ((strm.data_type & 0xc0) == 0x80 &&
+        (index.empty() || totout - last >= span))
+    {
+      unsigned char prime = strm.next_in > &input[0] ? strm.next_in[-1] : last_byte;
+      index.resize(index.size() + 1);
+      index.back().out = totout;
+      index.back().dict = totout - beg > WINSIZE ? WINSIZE : unsigned(totout - beg);
+      if (!this->add_point(pack, totin - strm.avail_in, prime, &win[0]))
+      {
+        ret = Z_MEM_ERROR;
+        break;
+      }
+      last = totout;
+    }
+
+    // More input after a gzip member starts another member
+    if (ret == Z_STREAM_END && format == GZIP &&
+        (strm.avail_in || file.sgetc() != std::filebuf::traits_type::eof()))
+    {
+      ret = inflateReset2(&strm, GZIP);
+      beg = totout;
+    }
+  } while (ret == Z_OK);
+  deflateEnd(&pack);
+
+  if (ret != Z_STREAM_END)
+  {
+    index.clear();
+    return false;
+  }
+  length = totout;
+  return true;
+}
+
+// Fill in the newest access point, as zran's add_point
+bool
+gzseekbuf::add_point(z_stream& pack,
+                     std::streamoff in,
+                     unsigned char prime,
+                     const unsigned char* window)
+{
+  access_point& point = index.back();
+  point.in = in;
+  point.bits = strm.data_type & 7;
+  point.prime = point.bits ? prime : 0;
+
+  // Unroll the circular window into the stream buffer before packing it
+  unsigned char* dict = (unsigned char*)&buffer[0];
+  unsigned recent = WINSIZE - strm.avail_out;
+  unsigned copy = recent > point.dict ? point.dict : recent;
+  std::memcpy(dict + point.dict - copy, window + recent - copy, copy);
+  copy = point.dict - copy;
+  std::memcpy(dict, window + WINSIZE - copy, copy);
+
+  point.window.resize(deflateBound(&pack, point.dict));
+  deflateReset(&pack);
+  pack.next_in = dict;
+  pack.avail_in = point.dict;
+  pack.next_out = &point.window[0];
+  pack.avail_out = (uInt)point.window.size();
+  if (deflate(&pack, Z_FINISH) != Z_STREAM_END)
+    return false;
+  point.window.resize(pack.total_out);
+  return true;
+}
+
+// Read saved index, checking it as zlib_index_load does
+bool
+gzseekbuf::load(const char* index_name)
+{
+  std::filebuf saved;
+  if (!saved.open(index_name, std::ios_base::in | std::ios_base::binary))
+    return false;
+  std::vector<unsigned char> src;
+  std::streamsize got;
+  do
+  {
+    std::size_t at = src.size();
+    src.resize(at + CHUNK);
+    got = saved.sgetn((char*)&src[at], CHUNK);
+    src.resize(at + got);
+  } while (got == CHUNK);
+  saved.close();
+
+  if (src.size() < INDEX_HEADER_SIZE || std::memcmp(&src[0], "ZIDX", 4) != 0 ||
+      get_le(&src[4], 4) != INDEX_VERSION)
+    return false;
+  int mode = int(get_le(&src[8], 4));
+  std::size_t have = get_le(&src[20], 4);
+  if ((mode != RAW && mode != ZLIB && mode != GZIP) || have == 0 ||
+      (src.size() - INDEX_HEADER_SIZE) / INDEX_POINT_SIZE < have)
+    return false;
+
+  const unsigned char* p = &src[INDEX_HEADER_SIZE];
+  std::size_t window = INDEX_HEADER_SIZE + have * INDEX_POINT_SIZE;
+  index.resize(have);
+  for (std::size_t i = 0; i < have; ++i, p += INDEX_POINT_SIZE)
+  {
+    access_point& point = index[i];
+    point.out = get_le(p, 8);
+    point.in = get_le(p + 8, 8);
+    point.dict = unsigned(get_le(p + 16, 4));
+    std::size_t size = get_le(p + 20, 4);
+    point.bits = p[24];
+    point.prime = p[25];
+    bool ordered = i == 0 ? point.out == 0 : point.out >= index[i - 1].out;
+    if (!ordered || point.dict > WINSIZE || point.bits > 7 ||
+        size > src.size() - window)
+    {
+      index.clear();
+      return false;
+    }
+    point.window.assign(src.begin() + window, src.begin() + window + size);
+    window += size;
+  }
+
+  format = mode;
+  length = get_le(&src[12], 8);
+  if (length < index.back().out || inflateInit2(&strm, RAW) != Z_OK)
+  {
+    index.clear();
+    return false;
+  }
+  strm_ready = true;
+  return true;
+}
+
+// Prime raw inflate with the bits and window of an access point
+bool
+gzseekbuf::jump(const access_point& point)
+{
+  if (point.dict)
+  {
+    inflateReset2(&strm, RAW);
+    strm.next_in = (Bytef*)&point.window[0];
+    strm.avail_in = (uInt)point.window.size();
+    strm.next_out = (Bytef*)&buffer[0];
+    strm.avail_out = WINSIZE;
+    if (inflate(&strm, Z_FINISH) != Z_STREAM_END ||
+        WINSIZE - strm.avail_out != point.dict)
+      return false;
+  }
+
+  if (file.pubseekpos(point.in, std::ios_base::in) != pos_type(point.in))
+    return false;
+  strm.avail_in = 0;
+  inflateReset2(&strm, RAW);
+  if (point.bits)
+    inflatePrime(&strm, point.bits, point.prime >> (8 - point.bits));
+  if (point.dict)
+    inflateSetDictionary(&strm, (Bytef*)&buffer[0], point.dict);
+  return true;
+}
+
+// Refill input buffer if empty
+bool
+gzseekbuf::refill()
+{
+  if (strm.avail_in)
+    return true;
+  strm.next_in = &input[0];
+  strm.avail_in = (uInt)file.sgetn((char*)&input[0], CHUNK);
+  return strm.avail_in > 0;
+}
+
+// Decompress from current position, crossing gzip members
+std::streamsize
+gzseekbuf::fill(char* dest,
+                std::streamsize len)
+{
+  std::streamsize got = 0;
+  while (got < len)
+  {
+    bool more = this->refill();
+    strm.next_out = (Bytef*)dest + got;
+    strm.avail_out = uInt(len - got);
+    int ret = inflate(&strm, Z_NO_FLUSH);
+    got = len - strm.avail_out;
+    if (ret == Z_BUF_ERROR && !more)
+      return got ? got : -1;          // data ends prematurely
+    if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR)
+      return -1;
+    if (ret != Z_STREAM_END)
+      continue;
+    if (format != GZIP)
+      break;
+
+    // Discard the gzip trailer, and stop if no member follows
+    for (int drop = 8; drop; --drop, ++strm.next_in, --strm.avail_in)
+      if (!this->refill())
+        return got ? got : -1;
+    if (!this->refill())
+      break;
+
+    // Skip the next member's header and resume raw inflate after it
+    inflateReset2(&strm, GZIP);
+    do
+    {
+      if (!this->refill())
+        return -1;
+      ret = inflate(&strm, Z_BLOCK);
+    } while (ret == Z_OK && (strm.data_type & 0x80) == 0);
+    if (ret != Z_OK)
+      return -1;
+    inflateReset2(&strm, RAW);
+  }
+  return got;
+}
+
+// Position get area at target, jumping only when it saves work
+bool
+gzseekbuf::locate(std::streamoff target)
+{
+  char* buf = &buffer[0];
+  std::streamoff at = buffer_out + (this->egptr() - this->eback());
+
+  // Already decompressed
+  if (positioned && target >= buffer_out && target < at)
+  {
+    this->setg(this->eback(), this->eback() + (target - buffer_out), this->egptr());
+    return true;
+  }
+
+  // Find the access point closest to but not after target
+  std::size_t lo = 0, hi = index.size();
+  while (hi - lo > 1)
+  {
+    std::size_t mid = (lo + hi) / 2;
+    if (target < index[mid].out)
+      hi = mid;
+    else
+      lo = mid;
+  }
+
+  // Decompressing on from here is cheaper unless the point lies between
+  if (!positioned || at > target || index[lo].out > at)
+  {
+    positioned = this->jump(index[lo]);
+    at = index[lo].out;
+  }
+
+  // Skip uncompressed bytes until the get area holds target
+  while (positioned)
+  {
+    std::streamsize n = at < length ? this->fill(buf, buffer.size()) : 0;
+    if (n < 0 || (n == 0 && at < target))
+      break;
+    if (target < at + n || n == 0)
+    {
+      buffer_out = at;
+      this->setg(buf, buf + (target - at), buf + n);
+      return true;
+    }
+    at += n;
+  }
+  positioned = false;
+  buffer_out = target;
+  this->setg(buf, buf, buf);
+  return false;
+}
+
+// Remaining uncompressed length
+std::streamsize
+gzseekbuf::showmanyc()
+{
+  if (!this->is_open())
+    return -1;
+  std::streamoff left = length - (buffer_out + (this->gptr() - this->eback()));
+  return left > 0 ? std::streamsize(left) : -1;
+}
+
+// Fill get area from the current position
+gzseekbuf::int_type
+gzseekbuf::underflow()
+{
+  if (!this->is_open())
+    return traits_type::eof();
+  if (this->gptr() < this->egptr())
+    return traits_type::to_int_type(*(this->gptr()));
+
+  std::streamoff at = buffer_out + (this->egptr() - this->eback());
+  if (at >= length || !this->locate(at) || this->gptr() == this->egptr())
+    return traits_type::eof();
+  return traits_type::to_int_type(*(this->gptr()));
+}
+
+// Seek relative to beginning, current position or end
+gzseekbuf::pos_type
+gzseekbuf::seekoff(off_type off,
+                   std::ios_base::seekdir way,
+                   std::ios_base::openmode mode)
+{
+  if (!this->is_open() || !(mode & std::ios_base::in))
+    return pos_type(off_type(-1));
+
+  std::streamoff pos = buffer_out + (this->gptr() - this->eback());
+  std::streamoff target = way == std::ios_base::beg ? off :
+                          way == std::ios_base::cur ? pos + off : length + off;
+  // tellg() costs nothing
+  if (target == pos)
+    return pos_type(pos);
+  if (target < 0 || target > length || !this->locate(target))
+    return pos_type(off_type(-1));
+  return pos_type(target);
+}
+
+// Seek to absolute position
+gzseekbuf::pos_type
+gzseekbuf::seekpos(pos_type sp,
+                   std::ios_base::openmode mode)
+{
+  return this->seekoff(off_type(sp), std::ios_base::beg, mode);
+}
+
+/*****************************************************************************/
+
+// Default constructor initializes stream buffer
+gzseekifstream::gzseekifstream()
+: std::istream(NULL), sb()
+{ this->init(&sb); }
+
+// Initialize stream buffer and open and index file
+gzseekifstream::gzseekifstream(const char* name,
+                               std::streamoff span)
+: std::istream(NULL), sb()
+{
+  this->init(&sb);
+  this->open(name, span);
+}
+
+// Initialize stream buffer and open file with saved index
+gzseekifstream::gzseekifstream(const char* name,
+                               const char* index_name)
+: std::istream(NULL), sb()
+{
+  this->init(&sb);
+  this->open(name, index_name);
+}
+
+// Open and index file and go into fail() state if unsuccessful
+void
+gzseekifstream::open(const char* name,
+                     std::streamoff span)
+{
+  if (!sb.open(name, span))
+    this->setstate(std::ios_base::failbit);
+  else
+    this->clear();
+}
+
+// Open file with saved index and go into fail() state if unsuccessful
+void
+gzseekifstream::open(const char* name,
+                     const char* index_name)
+{
+  if (!sb.open(name, index_name))
+    this->setstate(std::ios_base::failbit);
+  else
+    this->clear();
+}
+
+// Close file
+void
+gzseekifstream::close()
+{
+  if (!sb.close())
+    this->setstate(std::ios_base::failbit);
+}
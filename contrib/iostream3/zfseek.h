@@ -0,0 +1,359 @@
+/*
+ * A seekable C++ input stream over gzip, zlib and raw deflate files
+ *
+ * Random access through an index of access points, as in examples/zran.c.
+ * Indexes are saved in the "ZIDX" layout of src/zlib_index.c, so an index
+ * built by zlib.wasm can be loaded here, and the other way around.
+ */
+
+#ifndef ZFSEEK_H
+#define ZFSEEK_H
+
+#include <istream>  // not iostream, since we don't need cin/cout
+#include <fstream>  // for filebuf
+#include <vector>
+#include "zlib.h"
+
+/*****************************************************************************/
+
+/**
+ *  @brief  Seekable compressed file stream buffer class.
+ *
+ *  This class implements a read-only basic_filebuf for gzip, zlib and raw
+ *  deflate files that supports seeking. Opening a file either decompresses
+ *  it once to build an index of access points, each a deflate block
+ *  boundary with the 32K of history before it, or loads an index saved
+ *  earlier. A seek then restarts inflate at the nearest access point at or
+ *  before the target, so at most one span of data is decompressed and
+ *  thrown away, instead of everything from the start of the stream.
+ *  Seeking forward within a span just keeps decompressing.
+*/
+class gzseekbuf : public std::streambuf
+{
+public:
+  //  Default constructor.
+  gzseekbuf();
+
+  //  Destructor.
+  virtual
+  ~gzseekbuf();
+
+  /**
+   *  @brief  Open compressed file and index it.
+   *  @param  name  File name.
+   *  @param  span  Uncompressed bytes between access points.
+   *  @return  @c this on success, NULL on failure.
+   *
+   *  The whole file is decompressed once to build and validate the index.
+   *  A smaller span makes seeks faster, at about 32K of memory per access
+   *  point before the windows are compressed.
+  */
+  gzseekbuf*
+  open(const char* name,
+       std::streamoff span = 1048576);
+
+  /**
+   *  @brief  Open compressed file with a saved index.
+   *  @param  name  File name.
+   *  @param  index_name  Index file written by save_index.
+   *  @return  @c this on success, NULL on failure.
+   *
+   *  The file is not read until needed. The index must have been built
+   *  from this very file.
+  */
+  gzseekbuf*
+  open(const char* name,
+       const char* index_name);
+
+  /**
+   *  @brief  Save index of open file.
+   *  @param  index_name  Index file name.
+   *  @return  True on success.
+  */
+  bool
+  save_index(const char* index_name) const;
+
+  /**
+   *  @brief  Close compressed file.
+   *  @return  @c this on success, NULL on failure.
+  */
+  gzseekbuf*
+  close();
+
+  /**
+   *  @brief  Check if file is open.
+   *  @return  True if file is open.
+  */
+  bool
+  is_open() const { return file.is_open() && !index.empty(); }
+
+  /**
+   *  @brief  Length of uncompressed data.
+   *  @return  Length in bytes, or -1 if no file is open.
+  */
+  std::streamoff
+  size() const { return this->is_open() ? length : -1; }
+
+  /**
+   *  @brief  Number of access points in index.
+  */
+  std::size_t
+  points() const { return index.size(); }
+
+protected:
+  /**
+   *  @brief  Number of characters left in file.
+   *  @return  Remaining uncompressed length, or -1 at the end.
+   *
+   *  Unlike gzfilebuf, this is known exactly from the index.
+  */
+  virtual std::streamsize
+  showmanyc();
+
+  /**
+   *  @brief  Fill get area from compressed file.
+   *  @return  First character in get area on success, EOF on error.
+  */
+  virtual int_type
+  underflow();
+
+  /**
+   *  @brief  Alters the stream position.
+   *  @param  off  Offset value.
+   *  @param  way  Value for ios_base::seekdir.
+   *  @param  mode  Open mode flags (must contain ios::in).
+   *  @return  New uncompressed position, or -1 on failure.
+   *
+   *  A target in the get area only moves the get pointer. A target up to
+   *  the next access point past the data decompressed so far is reached by
+   *  decompressing on; anything else jumps to the nearest access point.
+  */
+  virtual pos_type
+  seekoff(off_type off,
+          std::ios_base::seekdir way,
+          std::ios_base::openmode mode = std::ios_base::in);
+
+  /**
+   *  @brief  Alters the stream position.
+   *  @param  sp  New uncompressed position.
+   *  @param  mode  Open mode flags (must contain ios::in).
+   *  @return  New uncompressed position, or -1 on failure.
+  */
+  virtual pos_type
+  seekpos(pos_type sp,
+          std::ios_base::openmode mode = std::ios_base::in);
+
+private:
+  /**
+   *  @brief  Access point.
+   *
+   *  The window is kept raw-deflated, as it is saved.
+  */
+  struct access_point
+  {
+    std::streamoff out;                 // offset in uncompressed data
+    std::streamoff in;                  // offset in file of first full byte
+    unsigned dict;                      // window bytes used as dictionary
+    int bits;                           // 0, or bits (1-7) from byte at in-1
+    unsigned char prime;                // that byte
+    std::vector<unsigned char> window;  // compressed window
+  };
+
+  /**
+   *  @brief  Decompress whole file, adding access points every span bytes.
+   *  @return  True on success.
+  */
+  bool
+  build(std::streamoff span);
+
+  /**
+   *  @brief  Read index saved by save_index.
+   *  @return  True on success.
+  */
+  bool
+  load(const char* index_name);
+
+  /**
+   *  @brief  Record access point at current position while building.
+   *  @return  True on success.
+  */
+  bool
+  add_point(z_stream& pack,
+            std::streamoff in,
+            unsigned char prime,
+            const unsigned char* window);
+
+  /**
+   *  @brief  Position get area at uncompressed offset.
+   *  @param  target  Offset, at most the length.
+   *  @return  True on success.
+  */
+  bool
+  locate(std::streamoff target);
+
+  /**
+   *  @brief  Restart inflate at access point.
+   *  @return  True on success.
+  */
+  bool
+  jump(const access_point& point);
+
+  /**
+   *  @brief  Decompress from current position.
+   *  @param  dest  Destination.
+   *  @param  len  Maximum number of bytes.
+   *  @return  Number of bytes, 0 at the end of the data, -1 on error.
+   *
+   *  Like zran's deflate_index_extract, this continues across gzip
+   *  members by skipping each trailer and the following header.
+  */
+  std::streamsize
+  fill(char* dest,
+       std::streamsize len);
+
+  /**
+   *  @brief  Refill input buffer if it is empty.
+   *  @return  False on a read error or the end of the file.
+  */
+  bool
+  refill();
+
+  /**
+   *  Underlying compressed file.
+  */
+  std::filebuf file;
+
+  /**
+   *  Inflate engine, for building and reading.
+  */
+  z_stream strm;
+
+  /**
+   *  True if inflate engine is initialized.
+  */
+  bool strm_ready;
+
+  /**
+   *  Stream type, as inflateInit2 windowBits: -15, 15 or 31.
+  */
+  int format;
+
+  /**
+   *  Length of uncompressed data.
+  */
+  std::streamoff length;
+
+  /**
+   *  Access points, in uncompressed order.
+  */
+  std::vector<access_point> index;
+
+  /**
+   *  Compressed input buffer.
+  */
+  std::vector<unsigned char> input;
+
+  /**
+   *  @brief  Stream buffer.
+   *
+   *  Also serves as scratch space for windows.
+  */
+  std::vector<char> buffer;
+
+  /**
+   *  Uncompressed offset of start of get area.
+  */
+  std::streamoff buffer_out;
+
+  /**
+   *  True if inflate is positioned at buffer_out plus the get area size.
+  */
+  bool positioned;
+};
+
+/*****************************************************************************/
+
+/**
+ *  @brief  Seekable compressed file input stream class.
+ *
+ *  This class implements ifstream for gzip, zlib and raw deflate files,
+ *  with seekg and tellg by way of an index. The index can be saved with
+ *  rdbuf()->save_index and handed to open on a later run.
+*/
+class gzseekifstream : public std::istream
+{
+public:
+  //  Default constructor
+  gzseekifstream();
+
+  /**
+   *  @brief  Construct stream on compressed file to be opened and indexed.
+   *  @param  name  File name.
+   *  @param  span  Uncompressed bytes between access points.
+  */
+  explicit
+  gzseekifstream(const char* name,
+                 std::streamoff span = 1048576);
+
+  /**
+   *  @brief  Construct stream on compressed file with a saved index.
+   *  @param  name  File name.
+   *  @param  index_name  Index file written by save_index.
+  */
+  gzseekifstream(const char* name,
+                 const char* index_name);
+
+  /**
+   *  Obtain underlying stream buffer.
+  */
+  gzseekbuf*
+  rdbuf() const
+  { return const_cast<gzseekbuf*>(&sb); }
+
+  /**
+   *  @brief  Check if file is open.
+   *  @return  True if file is open.
+  */
+  bool
+  is_open() { return sb.is_open(); }
+
+  /**
+   *  @brief  Open compressed file and index it.
+   *  @param  name  File name.
+   *  @param  span  Uncompressed bytes between access points.
+   *
+   *  Stream will be in state good() if file opens and indexes
+   *  successfully; otherwise in state fail().
+  */
+  void
+  open(const char* name,
+       std::streamoff span = 1048576);
+
+  /**
+   *  @brief  Open compressed file with a saved index.
+   *  @param  name  File name.
+   *  @param  index_name  Index file written by save_index.
+   *
+   *  Stream will be in state good() if file and index open
+   *  successfully; otherwise in state fail().
+  */
+  void
+  open(const char* name,
+       const char* index_name);
+
+  /**
+   *  @brief  Close compressed file.
+   *
+   *  Stream will be in state fail() if close failed.
+  */
+  void
+  close();
+
+private:
+  /**
+   *  Underlying stream buffer.
+  */
+  gzseekbuf sb;
+};
+
+#endif // ZFSEEK_H
@@ -8,19 +8,26 @@
  */
 
 #include "zfstream.h"
-#include <cstring>          // for strcpy, strcat, strlen (mode strings)
-#include <cstdio>           // for BUFSIZ
+#include <cstring>          // for strcpy, strcat, strlen (mode strings), memcpy
+#include <algorithm>        // for min
 
 // Internal buffer sizes (default and "unbuffered" versions)
-#define BIGBUFSIZE BUFSIZ
+#define BIGBUFSIZE 65536
 #define SMALLBUFSIZE 1
 
+// Default size of zlib's own buffers (gzbuffer)
+#define GZBUFFERSIZE 131072
+
+// Largest single gzread/gzwrite call, which count in int
+#define MAXIOSIZE 0x40000000
+
 /*****************************************************************************/
 
 // Default constructor
 gzfilebuf::gzfilebuf()
 : file(NULL), io_mode(std::ios_base::openmode(0)), own_fd(false),
-  buffer(NULL), buffer_size(BIGBUFSIZE), own_buffer(true)
+  buffer(NULL), buffer_size(BIGBUFSIZE), own_buffer(true),
+  gz_buffer_size(GZBUFFERSIZE)
 {
   // No buffers to start with
   this->disable_buffer();
@@ -46,6 +53,15 @@ gzfilebuf::setcompression(int comp_level,
   return gzsetparams(file, comp_level, comp_strategy);
 }
 
+// Set size of zlib's buffers
+int
+gzfilebuf::setgzbuffer(unsigned size)
+{
+  gz_buffer_size = size;
+  // Only possible before the first read or write on an open file
+  return this->is_open() ? gzbuffer(file, size) : 0;
+}
+
 // Open gzipped file
 gzfilebuf*
 gzfilebuf::open(const char *name,
@@ -66,6 +82,7 @@ gzfilebuf::open(const char *name,
   // Attempt to open file
   if ((file = gzopen(name, char_mode)) == NULL)
     return NULL;
+  gzbuffer(file, gz_buffer_size);
 
   // On success, allocate internal buffer and set flags
   this->enable_buffer();
@@ -94,6 +111,7 @@ gzfilebuf::attach(int fd,
   // Attempt to attach to file
   if ((file = gzdopen(fd, char_mode)) == NULL)
     return NULL;
+  gzbuffer(file, gz_buffer_size);
 
   // On success, allocate internal buffer and set flags
   this->enable_buffer();
@@ -209,6 +227,42 @@ gzfilebuf::underflow()
   return traits_type::to_int_type(*(this->gptr()));
 }
 
+// Read characters in bulk, bypassing the stream buffer for large requests
+std::streamsize
+gzfilebuf::xsgetn(char_type* s,
+                  std::streamsize n)
+{
+  // If the file hasn't been opened for reading, nothing can be read
+  if (!this->is_open() || !(io_mode & std::ios_base::in))
+    return 0;
+
+  // Characters left in the get area come first
+  std::streamsize got = 0;
+  if (this->gptr() && (this->gptr() < this->egptr()))
+  {
+    got = std::min(n, std::streamsize(this->egptr() - this->gptr()));
+    std::memcpy(s, this->gptr(), got);
+    this->gbump(int(got));
+  }
+
+  // A small remainder is served through the stream buffer as usual
+  if (n - got < buffer_size)
+    return got + std::streambuf::xsgetn(s + got, n - got);
+
+  // Otherwise gzread straight into the caller's memory, leaving the get
+  // area empty so the next read goes back to the file
+  while (got < n)
+  {
+    unsigned len = unsigned(std::min(n - got, std::streamsize(MAXIOSIZE)));
+    int bytes_read = gzread(file, s + got, len);
+    if (bytes_read <= 0)
+      break;
+    got += bytes_read;
+  }
+  this->setg(buffer, buffer, buffer);
+  return got;
+}
+
 // Write put area to gzipped file
 gzfilebuf::int_type
 gzfilebuf::overflow(int_type c)
@@ -261,6 +315,33 @@ gzfilebuf::overflow(int_type c)
     return c;
 }
 
+// Write characters in bulk, bypassing the stream buffer if they don't fit
+std::streamsize
+gzfilebuf::xsputn(const char_type* s,
+                  std::streamsize n)
+{
+  // Characters that fit in the put area are buffered as usual
+  if (this->pbase() && n < this->epptr() - this->pptr())
+    return std::streambuf::xsputn(s, n);
+
+  // If the file hasn't been opened for writing, produce error
+  if (!this->is_open() || !(io_mode & std::ios_base::out))
+    return 0;
+  // Keep the order of output: buffered characters go first
+  if (this->sync() == -1)
+    return 0;
+
+  std::streamsize put = 0;
+  while (put < n)
+  {
+    unsigned len = unsigned(std::min(n - put, std::streamsize(MAXIOSIZE)));
+    if (gzwrite(file, s + put, len) != int(len))
+      break;
+    put += len;
+  }
+  return put;
+}
+
 // Assign new buffer
 std::streambuf*
 gzfilebuf::setbuf(char_type* p,
@@ -49,6 +49,18 @@ public:
   setcompression(int comp_level,
                  int comp_strategy = Z_DEFAULT_STRATEGY);
 
+  /**
+   *  @brief  Set the size of zlib's own buffers for the file.
+   *  @param  size  Buffer size in bytes (see gzbuffer in zlib.h).
+   *  @return  0 on success, -1 otherwise.
+   *
+   *  The size applies to files opened from now on, and to the open file
+   *  as long as nothing has been read from or written to it yet. It
+   *  defaults to 128K rather than zlib's 8K.
+  */
+  int
+  setgzbuffer(unsigned size);
+
   /**
    *  @brief  Check if file is open.
    *  @return  True if file is open.
@@ -112,6 +124,20 @@ protected:
   virtual int_type
   underflow();
 
+  /**
+   *  @brief  Read characters from gzipped file in bulk.
+   *  @param  s  Destination.
+   *  @param  n  Number of characters requested.
+   *  @return  Number of characters read.
+   *
+   *  Characters already in the get area are copied first. A remainder
+   *  at least as large as the stream buffer is read by gzread straight
+   *  into s, skipping the copy through the stream buffer.
+  */
+  virtual std::streamsize
+  xsgetn(char_type* s,
+         std::streamsize n);
+
   /**
    *  @brief  Write put area to gzipped file.
    *  @param  c  Extra character to add to buffer contents.
@@ -124,6 +150,19 @@ protected:
   virtual int_type
   overflow(int_type c = traits_type::eof());
 
+  /**
+   *  @brief  Write characters to gzipped file in bulk.
+   *  @param  s  Source.
+   *  @param  n  Number of characters.
+   *  @return  Number of characters written.
+   *
+   *  Characters that fit in the put area are buffered as usual. Otherwise
+   *  the put area is flushed and s goes straight to gzwrite.
+  */
+  virtual std::streamsize
+  xsputn(const char_type* s,
+         std::streamsize n);
+
   /**
    *  @brief  Installs external stream buffer.
    *  @param  p  Pointer to char buffer.
@@ -209,8 +248,7 @@ private:
   /**
    *  @brief  Stream buffer size.
    *
-   *  Defaults to system default buffer size (typically 8192 bytes).
-   *  Modified by setbuf.
+   *  Defaults to 64K. Modified by setbuf.
   */
   std::streamsize buffer_size;
 
@@ -221,6 +259,13 @@ private:
    *  upon destruction.
   */
   bool own_buffer;
+
+  /**
+   *  @brief  Size of zlib's buffers, passed to gzbuffer on opening.
+   *
+   *  Modified by setgzbuffer.
+  */
+  unsigned gz_buffer_size;
 };
 
 /*****************************************************************************/
@@ -0,0 +1,233 @@
+/* iomem.c -- IO base function header for compress/uncompress .zip
+   in memory, without a file system
+
+   For more info read MiniZip_info.txt
+
+   Condition of use and distribution are the same than zlib.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "zlib.h"
+#include "iomem.h"
+
+/* Smallest buffer a growing archive allocates */
+#define MEM_MIN_GROW (64 * 1024)
+
+/* One open stream over a mem_file */
+typedef struct
+{
+    mem_file* file;
+    ZPOS64_T  pos;
+    int       error;
+} mem_stream;
+
+static voidpf ZCALLBACK mem_open64_file_func(voidpf opaque, const void* filename, int mode) {
+    mem_file* file = (mem_file*)opaque;
+    mem_stream* stream;
+    (void)filename;
+
+    if (file == NULL)
+        return NULL;
+    stream = (mem_stream*)malloc(sizeof(mem_stream));
+    if (stream == NULL)
+        return NULL;
+
+    if ((mode & ZLIB_FILEFUNC_MODE_READWRITEFILTER) != ZLIB_FILEFUNC_MODE_READ &&
+        (mode & ZLIB_FILEFUNC_MODE_CREATE))
+        file->size = 0;
+    stream->file = file;
+    stream->pos = 0;
+    stream->error = 0;
+    return stream;
+}
+
+static uLong ZCALLBACK mem_read_file_func(voidpf opaque, voidpf stream, void* buf, uLong size) {
+    mem_stream* s = (mem_stream*)stream;
+    ZPOS64_T left = s->pos < s->file->size ? s->file->size - s->pos : 0;
+    (void)opaque;
+
+    if (size > left)
+        size = (uLong)left;
+    if (size > 0)
+        memcpy(buf, s->file->base + s->pos, size);
+    s->pos += size;
+    return size;
+}
+
+static uLong ZCALLBACK mem_write_file_func(voidpf opaque, voidpf stream, const void* buf, uLong size) {
+    mem_stream* s = (mem_stream*)stream;
+    mem_file* file = s->file;
+    ZPOS64_T end = s->pos + size;
+    (void)opaque;
+
+    if (size == 0)
+        return 0;
+    if (end > file->limit)
+    {
+        ZPOS64_T limit = file->limit * 2;
+        unsigned char* base;
+
+        if (limit < end)
+            limit = end;
+        if (limit < MEM_MIN_GROW)
+            limit = MEM_MIN_GROW;
+        if (!file->grow || limit != (ZPOS64_T)(size_t)limit ||
+            (base = (unsigned char*)realloc(file->base, (size_t)limit)) == NULL)
+        {
+            s->error = 1;
+            return 0;
+        }
+        file->base = base;
+        file->limit = limit;
+    }
+
+    /* A seek past the end leaves a gap, which reads back as zeros */
+    if (s->pos > file->size)
+        memset(file->base + file->size, 0, (size_t)(s->pos - file->size));
+    memcpy(file->base + s->pos, buf, size);
+    s->pos = end;
+    if (end > file->size)
+        file->size = end;
+    return size;
+}
+
+static ZPOS64_T ZCALLBACK mem_tell64_file_func(voidpf opaque, voidpf stream) {
+    (void)opaque;
+    return ((mem_stream*)stream)->pos;
+}
+
+static long ZCALLBACK mem_seek64_file_func(voidpf opaque, voidpf stream, ZPOS64_T offset, int origin) {
+    mem_stream* s = (mem_stream*)stream;
+    ZPOS64_T pos;
+    (void)opaque;
+
+    switch (origin)
+    {
+    case ZLIB_FILEFUNC_SEEK_CUR :
+        pos = s->pos + offset;
+        break;
+    case ZLIB_FILEFUNC_SEEK_END :
+        pos = s->file->size + offset;
+        break;
+    case ZLIB_FILEFUNC_SEEK_SET :
+        pos = offset;
+        break;
+    default: return -1;
+    }
+
+    /* Readers must stay inside the archive; writers may extend it */
+    if (pos > s->file->size && !s->file->grow)
+        return -1;
+    s->pos = pos;
+    return 0;
+}
+
+static int ZCALLBACK mem_close_file_func(voidpf opaque, voidpf stream) {
+    (void)opaque;
+    free(stream);
+    return 0;
+}
+
+static int ZCALLBACK mem_error_file_func(voidpf opaque, voidpf stream) {
+    (void)opaque;
+    return ((mem_stream*)stream)->error;
+}
+
+static voidpf ZCALLBACK sink_open64_file_func(voidpf opaque, const void* filename, int mode) {
+    (void)filename;
+    if (opaque == NULL || (mode & ZLIB_FILEFUNC_MODE_WRITE) == 0)
+        return NULL;
+    return opaque;
+}
+
+static uLong ZCALLBACK sink_read_file_func(voidpf opaque, voidpf stream, void* buf, uLong size) {
+    (void)opaque;
+    (void)stream;
+    (void)buf;
+    (void)size;
+    return 0;
+}
+
+static uLong ZCALLBACK sink_write_file_func(voidpf opaque, voidpf stream, const void* buf, uLong size) {
+    mem_sink* sink = (mem_sink*)stream;
+    ZPOS64_T end = sink->size + size;
+    (void)opaque;
+
+    if (end > sink->limit)
+    {
+        ZPOS64_T limit = sink->limit * 2;
+        unsigned char* base;
+
+        if (limit < end)
+            limit = end;
+        if (limit < MEM_MIN_GROW)
+            limit = MEM_MIN_GROW;
+        if (limit != (ZPOS64_T)(size_t)limit ||
+            (base = (unsigned char*)realloc(sink->base, (size_t)limit)) == NULL)
+            return 0;
+        sink->base = base;
+        sink->limit = limit;
+    }
+    if (size > 0)
+        memcpy(sink->base + sink->size, buf, size);
+    sink->size = end;
+    return size;
+}
+
+static ZPOS64_T ZCALLBACK sink_tell64_file_func(voidpf opaque, voidpf stream) {
+    mem_sink* sink = (mem_sink*)stream;
+    (void)opaque;
+    return sink->taken + sink->size;
+}
+
+static long ZCALLBACK sink_seek64_file_func(voidpf opaque, voidpf stream, ZPOS64_T offset, int origin) {
+    mem_sink* sink = (mem_sink*)stream;
+    ZPOS64_T pos = sink->taken + sink->size;
+    (void)opaque;
+
+    switch (origin)
+    {
+    case ZLIB_FILEFUNC_SEEK_CUR :
+    case ZLIB_FILEFUNC_SEEK_END :
+        return offset == 0 ? 0 : -1;
+    case ZLIB_FILEFUNC_SEEK_SET :
+        return offset == pos ? 0 : -1;
+    default: return -1;
+    }
+}
+
+static int ZCALLBACK sink_close_file_func(voidpf opaque, voidpf stream) {
+    (void)opaque;
+    (void)stream;
+    return 0;
+}
+
+static int ZCALLBACK sink_error_file_func(voidpf opaque, voidpf stream) {
+    (void)opaque;
+    (void)stream;
+    return 0;
+}
+
+void fill_mem_sink_filefunc64(zlib_filefunc64_def* pzlib_filefunc_def, mem_sink* sink) {
+    pzlib_filefunc_def->zopen64_file = sink_open64_file_func;
+    pzlib_filefunc_def->zread_file = sink_read_file_func;
+    pzlib_filefunc_def->zwrite_file = sink_write_file_func;
+    pzlib_filefunc_def->ztell64_file = sink_tell64_file_func;
+    pzlib_filefunc_def->zseek64_file = sink_seek64_file_func;
+    pzlib_filefunc_def->zclose_file = sink_close_file_func;
+    pzlib_filefunc_def->zerror_file = sink_error_file_func;
+    pzlib_filefunc_def->opaque = sink;
+}
+
+void fill_mem_filefunc64(zlib_filefunc64_def* pzlib_filefunc_def, mem_file* file) {
+    pzlib_filefunc_def->zopen64_file = mem_open64_file_func;
+    pzlib_filefunc_def->zread_file = mem_read_file_func;
+    pzlib_filefunc_def->zwrite_file = mem_write_file_func;
+    pzlib_filefunc_def->ztell64_file = mem_tell64_file_func;
+    pzlib_filefunc_def->zseek64_file = mem_seek64_file_func;
+    pzlib_filefunc_def->zclose_file = mem_close_file_func;
+    pzlib_filefunc_def->zerror_file = mem_error_file_func;
+    pzlib_filefunc_def->opaque = file;
+}
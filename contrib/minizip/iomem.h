@@ -0,0 +1,65 @@
+/* iomem.h -- IO base function header for compress/uncompress .zip
+   in memory, without a file system
+
+   For more info read MiniZip_info.txt
+
+   Condition of use and distribution are the same than zlib.
+*/
+
+#ifndef _ZLIBIOMEM_H
+#define _ZLIBIOMEM_H
+
+#ifndef _ZLIBIOAPI_H
+#include "ioapi.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The memory a zip or unzip handle reads and writes */
+typedef struct mem_file_s
+{
+    unsigned char* base;    /* the archive bytes */
+    ZPOS64_T       size;    /* bytes of archive at base */
+    ZPOS64_T       limit;   /* bytes allocated at base */
+    int            grow;    /* if nonzero, writes past limit realloc() base */
+} mem_file;
+
+void fill_mem_filefunc64(zlib_filefunc64_def* pzlib_filefunc_def, mem_file* file);
+/*
+  Fill pzlib_filefunc_def so that zipOpen2_64() and unzOpen2_64() use file
+    in place of a named file; the pathname they are given is ignored.
+  To read an archive, point base at it and set size and limit to its length.
+  To write one, start from base == NULL, size == limit == 0 and grow set
+    (or from a malloc'ed base); after zipClose() the archive is
+    base[0..size-1], and base belongs to the caller, who must free() it.
+    Without grow, writes that do not fit in limit bytes fail.
+  Opening for create (APPEND_STATUS_CREATE) empties file.
+ */
+
+/* Output that is only appended to, and handed on in pieces as it grows */
+typedef struct mem_sink_s
+{
+    unsigned char* base;    /* bytes written and not yet taken */
+    ZPOS64_T       size;    /* bytes at base */
+    ZPOS64_T       limit;   /* bytes allocated at base */
+    ZPOS64_T       taken;   /* bytes handed on before base[0] */
+} mem_sink;
+
+void fill_mem_sink_filefunc64(zlib_filefunc64_def* pzlib_filefunc_def, mem_sink* sink);
+/*
+  Fill pzlib_filefunc_def so that zipOpen2_64() writes to sink, for
+    archives whose entries are opened with flag bit 3 (data descriptors)
+    and so never seek back. Start from a zeroed sink. Whenever it suits,
+    the owner may take base[0..size-1], which is then theirs to free(), and
+    set base to NULL, add size to taken and zero size and limit; memory
+    use stays at what was written since. Reads fail, and seeks succeed
+    only if they stay where the stream already is.
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -151,6 +151,29 @@ typedef struct
 } file_in_zip64_read_info_s;
 
 
+/* unz64_index is the optional name index over the central directory built
+   by unzOpenIndexed64(): entries in directory order, their names packed
+   into one buffer, and an open-addressing hash table of entry numbers */
+typedef struct
+{
+    ZPOS64_T pos_in_central_dir;    /* where the directory record starts */
+    ZPOS64_T num_file;
+    ZPOS64_T offset_curfile;        /* local header, to order batch reads */
+    ZPOS64_T name;                  /* offset of the name in names */
+    uLong    size_filename;
+    uLong    hash;
+} unz64_index_entry;
+
+typedef struct
+{
+    unz64_index_entry* entries;
+    ZPOS64_T count;
+    char* names;
+    ZPOS64_T* slots;                /* 1 + entry number, 0 if unused */
+    ZPOS64_T mask;                  /* slot count - 1 */
+} unz64_index;
+
+
 /* unz64_s contain internal information about the zipfile
 */
 typedef struct
@@ -177,6 +200,8 @@ typedef struct
 
     int isZip64;
 
+    unz64_index* index;        /* name index, or NULL if not built */
+
 #    ifndef NOUNCRYPT
     unsigned long keys[3];     /* keys defining the pseudo-random sequence */
     const z_crc_t* pcrc_32_tab;
@@ -653,6 +678,7 @@ local unzFile unzOpenInternal(const void *path,
     us.central_pos = central_pos;
     us.pfile_in_zip_read = NULL;
     us.encrypted = 0;
+    us.index = NULL;
 
 
     s=(unz64_s*)ALLOC(sizeof(unz64_s));
@@ -713,6 +739,14 @@ extern int ZEXPORT unzClose(unzFile file) {
     if (s->pfile_in_zip_read!=NULL)
         unzCloseCurrentFile(file);
 
+    if (s->index!=NULL)
+    {
+        free(s->index->entries);
+        free(s->index->names);
+        free(s->index->slots);
+        free(s->index);
+    }
+
     ZCLOSE64(s->z_filefunc, s->filestream);
     free(s);
     return UNZ_OK;
@@ -1238,6 +1272,273 @@ extern int ZEXPORT unzGoToFilePos(unzFile file, unz_file_pos* file_pos) {
     return unzGoToFilePos64(file,&file_pos64);
 }
 
+/*
+///////////////////////////////////////////
+// Central directory index
+//
+// The cache wished for above: one pass over the central directory at
+// open time records where every entry's record is, hashed by name, so
+// locating a file no longer walks and compares the whole directory.
+*/
+
+/* FNV-1a */
+local uLong unz64local_HashName(const char* name, uLong size) {
+    uLong hash = 2166136261UL;
+    uLong i;
+    for (i = 0; i < size; i++)
+        hash = ((hash ^ (unsigned char)name[i]) * 16777619UL) & 0xffffffffUL;
+    return hash;
+}
+
+/* Slot holding the entry called name, or the empty slot where it would go */
+local ZPOS64_T unz64local_IndexSlot(const unz64_index* index, const char* name,
+                                    uLong size, uLong hash) {
+    ZPOS64_T slot = hash & index->mask;
+    for (;;)
+    {
+        ZPOS64_T n = index->slots[slot];
+        const unz64_index_entry* entry;
+        if (n == 0)
+            return slot;
+        entry = &index->entries[n - 1];
+        if (entry->hash == hash && entry->size_filename == size &&
+            memcmp(index->names + entry->name, name, size) == 0)
+            return slot;
+        slot = (slot + 1) & index->mask;
+    }
+}
+
+local const unz64_index_entry* unz64local_IndexFind(const unz64_index* index, const char* name) {
+    size_t size = strlen(name);
+    ZPOS64_T n;
+    if (size > 0xffff)
+        return NULL;
+    n = index->slots[unz64local_IndexSlot(index, name, (uLong)size,
+                                          unz64local_HashName(name, (uLong)size))];
+    return n != 0 ? &index->entries[n - 1] : NULL;
+}
+
+local int unz64local_BuildIndex(unz64_s* s) {
+    unz64_index* index;
+    ZPOS64_T capacity = 0;
+    ZPOS64_T names_size = 0;
+    ZPOS64_T names_used = 0;
+    ZPOS64_T slots = 16;
+    ZPOS64_T i;
+    int err = UNZ_OK;
+
+    index = (unz64_index*)calloc(1, sizeof(unz64_index));
+    if (index == NULL)
+        return UNZ_INTERNALERROR;
+
+    s->pos_in_central_dir = s->offset_central_dir;
+    s->num_file = 0;
+    while (s->gi.number_entry != 0)
+    {
+        unz64_index_entry* entry;
+
+        /* Room for another entry, and for the longest possible name */
+        if (index->count == capacity)
+        {
+            ZPOS64_T size = capacity ? capacity * 2 : 1024;
+            entry = (unz64_index_entry*)realloc(index->entries,
+                                                (size_t)size * sizeof(unz64_index_entry));
+            if (entry == NULL)
+            {
+                err = UNZ_INTERNALERROR;
+                break;
+            }
+            index->entries = entry;
+            capacity = size;
+        }
+        if (names_size - names_used < 0xffff)
+        {
+            ZPOS64_T size = names_size ? names_size * 2 : 0x20000;
+            char* names = (char*)realloc(index->names, (size_t)size);
+            if (names == NULL)
+            {
+                err = UNZ_INTERNALERROR;
+                break;
+            }
+            index->names = names;
+            names_size = size;
+        }
+
+        err = unz64local_GetCurrentFileInfoInternal((unzFile)s, &s->cur_file_info,
+                                                   &s->cur_file_info_internal,
+                                                   index->names + names_used, 0xffff,
+                                                   NULL, 0, NULL, 0);
+        if (err != UNZ_OK)
+        {
+            /* Under the 2^16 files overflow hack the count is a lower bound */
+            if (s->gi.number_entry == 0xffff && s->num_file >= 0xffff)
+                err = UNZ_OK;
+            break;
+        }
+
+        entry = &index->entries[index->count++];
+        entry->pos_in_central_dir = s->pos_in_central_dir;
+        entry->num_file = s->num_file;
+        entry->offset_curfile = s->cur_file_info_internal.offset_curfile;
+        entry->name = names_used;
+        entry->size_filename = s->cur_file_info.size_filename;
+        entry->hash = unz64local_HashName(index->names + names_used, entry->size_filename);
+        names_used += entry->size_filename;
+
+        if (s->gi.number_entry != 0xffff && s->num_file + 1 == s->gi.number_entry)
+            break;
+        s->pos_in_central_dir += SIZECENTRALDIRITEM + s->cur_file_info.size_filename +
+                s->cur_file_info.size_file_extra + s->cur_file_info.size_file_comment;
+        s->num_file++;
+    }
+
+    /* At most half full; the first of several entries with one name wins,
+       as with unzLocateFile() */
+    while (slots < 2 * index->count)
+        slots *= 2;
+    if (err == UNZ_OK)
+    {
+        index->slots = (ZPOS64_T*)calloc((size_t)slots, sizeof(ZPOS64_T));
+        if (index->slots == NULL)
+            err = UNZ_INTERNALERROR;
+    }
+    if (err == UNZ_OK)
+    {
+        index->mask = slots - 1;
+        for (i = 0; i < index->count; i++)
+        {
+            const unz64_index_entry* entry = &index->entries[i];
+            ZPOS64_T slot = unz64local_IndexSlot(index, index->names + entry->name,
+                                                 entry->size_filename, entry->hash);
+            if (index->slots[slot] == 0)
+                index->slots[slot] = i + 1;
+        }
+        s->index = index;
+    }
+    else
+    {
+        free(index->entries);
+        free(index->names);
+        free(index);
+    }
+
+    unzGoToFirstFile((unzFile)s);
+    return err;
+}
+
+extern unzFile ZEXPORT unzOpenIndexed64(const void *path,
+                                        zlib_filefunc64_def* pzlib_filefunc_def) {
+    unzFile file = unzOpen2_64(path, pzlib_filefunc_def);
+    if (file != NULL && unz64local_BuildIndex((unz64_s*)file) != UNZ_OK)
+    {
+        unzClose(file);
+        file = NULL;
+    }
+    return file;
+}
+
+extern int ZEXPORT unzLocateFileIndexed(unzFile file, const char *szFileName) {
+    unz64_s* s;
+    const unz64_index_entry* entry;
+    int err;
+
+    if (file==NULL || szFileName==NULL)
+        return UNZ_PARAMERROR;
+    s=(unz64_s*)file;
+    if (s->index == NULL)
+        return unzLocateFile(file, szFileName, 1);
+
+    entry = unz64local_IndexFind(s->index, szFileName);
+    if (entry == NULL)
+        return UNZ_END_OF_LIST_OF_FILE;
+
+    s->pos_in_central_dir = entry->pos_in_central_dir;
+    s->num_file = entry->num_file;
+    err = unz64local_GetCurrentFileInfoInternal(file,&s->cur_file_info,
+                                               &s->cur_file_info_internal,
+                                               NULL,0,NULL,0,NULL,0);
+    s->current_file_ok = (err == UNZ_OK);
+    return err;
+}
+
+typedef struct
+{
+    ZPOS64_T offset_curfile;
+    unz64_file_pos pos;
+    uLong name;                 /* position in the caller's list */
+} unz64_visit;
+
+local int unz64local_CompareVisit(const void* a, const void* b) {
+    const unz64_visit* va = (const unz64_visit*)a;
+    const unz64_visit* vb = (const unz64_visit*)b;
+    if (va->offset_curfile != vb->offset_curfile)
+        return va->offset_curfile < vb->offset_curfile ? -1 : 1;
+    return va->name < vb->name ? -1 : va->name > vb->name;
+}
+
+extern int ZEXPORT unzVisitFiles(unzFile file, const char* const* names, uLong count,
+                                 unz_visit_func visit, voidpf opaque) {
+    unz64_s* s;
+    unz64_visit* order;
+    uLong found = 0;
+    uLong i;
+    int err = UNZ_OK;
+
+    if (file==NULL || (count != 0 && (names==NULL || visit==NULL)))
+        return UNZ_PARAMERROR;
+    if (count == 0)
+        return UNZ_OK;
+    s=(unz64_s*)file;
+
+    order = (unz64_visit*)ALLOC(count * sizeof(unz64_visit));
+    if (order == NULL)
+        return UNZ_INTERNALERROR;
+
+    for (i = 0; i < count && err == UNZ_OK; i++)
+    {
+        if (names[i] == NULL)
+            continue;
+        if (s->index != NULL)
+        {
+            const unz64_index_entry* entry = unz64local_IndexFind(s->index, names[i]);
+            if (entry == NULL)
+                continue;
+            order[found].offset_curfile = entry->offset_curfile;
+            order[found].pos.pos_in_zip_directory = entry->pos_in_central_dir;
+            order[found].pos.num_of_file = entry->num_file;
+        }
+        else
+        {
+            err = unzLocateFile(file, names[i], 1);
+            if (err == UNZ_END_OF_LIST_OF_FILE)
+            {
+                err = UNZ_OK;
+                continue;
+            }
+            if (err != UNZ_OK)
+                break;
+            order[found].offset_curfile = s->cur_file_info_internal.offset_curfile;
+            order[found].pos.pos_in_zip_directory = s->pos_in_central_dir;
+            order[found].pos.num_of_file = s->num_file;
+        }
+        order[found++].name = i;
+    }
+
+    if (err == UNZ_OK)
+        qsort(order, found, sizeof(unz64_visit), unz64local_CompareVisit);
+    for (i = 0; i < found && err == UNZ_OK; i++)
+    {
+        err = unzGoToFilePos64(file, &order[i].pos);
+        if (err == UNZ_OK)
+            err = visit(opaque, file, order[i].name);
+    }
+    free(order);
+
+    if (err == UNZ_OK && found < count)
+        err = UNZ_END_OF_LIST_OF_FILE;
+    return err;
+}
+
 /*
 // Unzip Helper Functions - should be here?
 ///////////////////////////////////////////
@@ -1289,10 +1590,13 @@ local int unz64local_CheckCurrentFileCoherencyHeader(unz64_s* s, uInt* piSizeVar
     else if ((err==UNZ_OK) && (uData!=s->cur_file_info.compression_method))
         err=UNZ_BADZIPFILE;
 
+    /* Deflate64 data is only handed out by unzGetCurrentFileData(), for
+       inflateBack9(); unzOpenCurrentFile3() still refuses it */
     if ((err==UNZ_OK) && (s->cur_file_info.compression_method!=0) &&
 /* #ifdef HAVE_BZIP2 */
                          (s->cur_file_info.compression_method!=Z_BZIP2ED) &&
 /* #endif */
+                         (s->cur_file_info.compression_method!=Z_DEFLATE64) &&
                          (s->cur_file_info.compression_method!=Z_DEFLATED))
         err=UNZ_BADZIPFILE;
 
@@ -1535,6 +1839,32 @@ extern ZPOS64_T ZEXPORT unzGetCurrentFileZStreamPos64(unzFile file) {
 
 /** Addition for GDAL : END */
 
+extern int ZEXPORT unzGetCurrentFileData(unzFile file, unz_file_data* data) {
+    unz64_s* s;
+    uInt iSizeVar;
+    ZPOS64_T offset_local_extrafield;
+    uInt size_local_extrafield;
+
+    if (file==NULL || data==NULL)
+        return UNZ_PARAMERROR;
+    s=(unz64_s*)file;
+    if (!s->current_file_ok)
+        return UNZ_PARAMERROR;
+    if ((s->cur_file_info.flag & 1) != 0)
+        return UNZ_PARAMERROR;
+
+    if (unz64local_CheckCurrentFileCoherencyHeader(s,&iSizeVar, &offset_local_extrafield,&size_local_extrafield)!=UNZ_OK)
+        return UNZ_BADZIPFILE;
+
+    data->pos_in_zipfile = s->cur_file_info_internal.offset_curfile + SIZEZIPLOCALHEADER +
+                           iSizeVar + s->byte_before_the_zipfile;
+    data->compressed_size = s->cur_file_info.compressed_size;
+    data->uncompressed_size = s->cur_file_info.uncompressed_size;
+    data->crc = s->cur_file_info.crc;
+    data->compression_method = (int)s->cur_file_info.compression_method;
+    return UNZ_OK;
+}
+
 /*
   Read bytes from the current file.
   buf contain buffer where data must be copied
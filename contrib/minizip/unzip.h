@@ -60,6 +60,7 @@ extern "C" {
 #endif
 
 #define Z_BZIP2ED 12
+#define Z_DEFLATE64 9
 
 #if defined(STRICTUNZIP) || defined(STRICTZIPUNZIP)
 /* like the STRICT of WIN32, we define a pointer that cannot be converted
@@ -283,6 +284,47 @@ extern int ZEXPORT unzGoToFilePos64(
     unzFile file,
     const unz64_file_pos* file_pos);
 
+/* ****************************************** */
+/* Central directory index */
+
+extern unzFile ZEXPORT unzOpenIndexed64(const void *path,
+                                        zlib_filefunc64_def* pzlib_filefunc_def);
+/*
+  Open like unzOpen2_64, then read the whole central directory once and
+    index the entries by name. The index costs about 40 bytes plus the
+    name per entry and makes unzLocateFileIndexed and unzVisitFiles
+    constant time per name, where unzLocateFile scans the directory.
+  Returns NULL if the archive cannot be opened or its central directory
+    cannot be read to the end.
+*/
+
+extern int ZEXPORT unzLocateFileIndexed(unzFile file,
+                                        const char *szFileName);
+/*
+  Make the entry called szFileName (compared exactly, as unzLocateFile with
+    iCaseSensitivity 1) the current file. Without an index this is
+    unzLocateFile.
+  return UNZ_OK if the file is found, UNZ_END_OF_LIST_OF_FILE if not.
+*/
+
+typedef int (*unz_visit_func)(voidpf opaque, unzFile file, uLong name);
+
+extern int ZEXPORT unzVisitFiles(unzFile file,
+                                 const char* const* names,
+                                 uLong count,
+                                 unz_visit_func visit,
+                                 voidpf opaque);
+/*
+  Locate each of the count names and call visit(opaque, file, i) with
+    names[i] as the current file, e.g. to unzOpenCurrentFile and read it.
+    Entries are visited in the order their data appears in the archive,
+    not the order of names, so reads go front to back through the file.
+  Names not in the archive are skipped. A nonzero return from visit stops
+    the walk and is returned.
+  return UNZ_OK if every name was visited, UNZ_END_OF_LIST_OF_FILE if some
+    were missing.
+*/
+
 /* ****************************************** */
 
 extern int ZEXPORT unzGetCurrentFileInfo64(unzFile file,
@@ -326,6 +368,30 @@ extern ZPOS64_T ZEXPORT unzGetCurrentFileZStreamPos64(unzFile file);
 
 /** Addition for GDAL : END */
 
+/* Where the current file's data lies, for reading it without the handle */
+typedef struct unz_file_data_s
+{
+    ZPOS64_T pos_in_zipfile;        /* of the first data byte, from the start of the stream */
+    ZPOS64_T compressed_size;       /* bytes of data there */
+    ZPOS64_T uncompressed_size;
+    uLong crc;
+    int compression_method;         /* 0 (stored) or Z_DEFLATED, as a rule */
+} unz_file_data;
+
+extern int ZEXPORT unzGetCurrentFileData(unzFile file, unz_file_data* data);
+/*
+  Read the current file's local header and fill data with the position and
+    size of its data, without opening the file.
+  An unzFile has one current file, so unzReadCurrentFile extracts one entry
+    at a time. With unz_file_data in hand, any number of threads can read
+    entries concurrently from the same read-only copy of the archive (e.g.
+    one in memory, see iomem.h): stored data is the file itself, deflated
+    data is a raw stream for inflateInit2(..., -MAX_WBITS), and crc checks
+    the result.
+  return UNZ_OK, UNZ_PARAMERROR if there is no current file or it is
+    encrypted, or UNZ_BADZIPFILE if its local header is bad.
+*/
+
 
 /***************************************************************************/
 /* for reading the content of the current zipfile, you can open it, read data
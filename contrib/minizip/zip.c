@@ -101,6 +101,7 @@ const char zip_copyright[] =" zip 1.01 Copyright 1998-2004 Gilles Vollant - http
 #define LOCALHEADERMAGIC    (0x04034b50)
 #define CENTRALHEADERMAGIC  (0x02014b50)
 #define ENDHEADERMAGIC      (0x06054b50)
+#define DESCRIPTORMAGIC     (0x08074b50)
 #define ZIP64ENDHEADERMAGIC      (0x6064b50)
 #define ZIP64ENDLOCHEADERMAGIC   (0x7064b50)
 
@@ -1614,7 +1615,9 @@ extern int ZEXPORT zipWriteInFileInZip(zipFile file, const void* buf, unsigned i
     if (zi->in_opened_file_inzip == 0)
         return ZIP_PARAMERROR;
 
-    zi->ci.crc32 = crc32(zi->ci.crc32,buf,(uInt)len);
+    /* Raw entries are closed with the caller's crc, so don't compute one */
+    if (!zi->ci.raw)
+        zi->ci.crc32 = crc32(zi->ci.crc32,buf,(uInt)len);
 
 #ifdef HAVE_BZIP2
     if(zi->ci.method == Z_BZIP2ED && (!zi->ci.raw))
@@ -1895,7 +1898,24 @@ extern int ZEXPORT zipCloseFileInZipRaw64(zipFile file, ZPOS64_T uncompressed_si
 
     free(zi->ci.central_header);
 
-    if (err==ZIP_OK)
+    if (err==ZIP_OK && (zi->ci.flag & 8) != 0)
+    {
+        /* Bit 3: the crc and sizes follow the data in a data descriptor, so
+           the local header is never revisited and the output need not seek.
+           With a Zip64 extra field in the local header the sizes are 8 bytes. */
+        if (!zi->ci.zip64 && (uncompressed_size >= 0xffffffff || compressed_size >= 0xffffffff))
+            err = ZIP_BADZIPFILE; /* Caller passed zip64 = 0, so no room for zip64 info -> fatal */
+
+        if (err==ZIP_OK)
+            err = zip64local_putValue(&zi->z_filefunc,zi->filestream,(uLong)DESCRIPTORMAGIC,4);
+        if (err==ZIP_OK)
+            err = zip64local_putValue(&zi->z_filefunc,zi->filestream,crc32,4);
+        if (err==ZIP_OK)
+            err = zip64local_putValue(&zi->z_filefunc,zi->filestream,compressed_size,zi->ci.zip64 ? 8 : 4);
+        if (err==ZIP_OK)
+            err = zip64local_putValue(&zi->z_filefunc,zi->filestream,uncompressed_size,zi->ci.zip64 ? 8 : 4);
+    }
+    else if (err==ZIP_OK)
     {
         /* Update the LocalFileHeader with the new values. */
 
@@ -1947,6 +1967,42 @@ extern int ZEXPORT zipCloseFileInZip(zipFile file) {
     return zipCloseFileInZipRaw (file,0,0);
 }
 
+extern int ZEXPORT zipWriteRawFileInZip64(zipFile file, const char* filename, const zip_fileinfo* zipfi,
+                                          const void* buf, ZPOS64_T compressed_size,
+                                          ZPOS64_T uncompressed_size, uLong crc32,
+                                          int method, int level, uLong flagBase) {
+    zip64_internal* zi;
+    const unsigned char* next = (const unsigned char*)buf;
+    ZPOS64_T left = compressed_size;
+    int zip64 = compressed_size >= 0xffffffff || uncompressed_size >= 0xffffffff;
+    int err;
+
+    if (file == NULL || (buf == NULL && compressed_size != 0))
+        return ZIP_PARAMERROR;
+
+    err = zipOpenNewFileInZip4_64(file, filename, zipfi, NULL, 0, NULL, 0, NULL,
+                                  method, level, 1, -MAX_WBITS, DEF_MEM_LEVEL,
+                                  Z_DEFAULT_STRATEGY, NULL, 0, VERSIONMADEBY, flagBase, zip64);
+    if (err != ZIP_OK)
+        return err;
+    zi = (zip64_internal*)file;
+
+    /* The data goes straight to the stream, not through buffered_data */
+    while (err == ZIP_OK && left > 0)
+    {
+        uLong chunk = left > 0x40000000 ? 0x40000000 : (uLong)left;
+        if (ZWRITE64(zi->z_filefunc, zi->filestream, next, chunk) != chunk)
+            err = ZIP_ERRNO;
+        next += chunk;
+        left -= chunk;
+    }
+    zi->ci.totalCompressedData += compressed_size;
+
+    if (err != ZIP_OK)
+        return err;
+    return zipCloseFileInZipRaw64(file, uncompressed_size, crc32);
+}
+
 local int Write_Zip64EndOfCentralDirectoryLocator(zip64_internal* zi, ZPOS64_T zip64eocd_pos_inzip) {
   int err = ZIP_OK;
   ZPOS64_T pos = zip64eocd_pos_inzip - zi->add_position_when_writing_offset;
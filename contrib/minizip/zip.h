@@ -303,6 +303,12 @@ extern int ZEXPORT zipOpenNewFileInZip4_64(zipFile file,
   Same than zipOpenNewFileInZip4, except
     versionMadeBy : value for Version made by field
     flag : value for flag field (compression level info will be added)
+  If flag has bit 3 (0x8) set, the crc and sizes are written after the
+    data, in a data descriptor, instead of being patched into the local
+    header when the file is closed. The zipfile is then only ever appended
+    to, so it can be a pipe or network stream that cannot seek. The sizes
+    in the descriptor are 8 bytes if zip64 is set, and closing a file of
+    4 GB or more fails if it is not.
  */
 
 
@@ -338,6 +344,29 @@ extern int ZEXPORT zipAlreadyThere(zipFile file,
   uncompressed_size and crc32 are value for the uncompressed size
  */
 
+extern int ZEXPORT zipWriteRawFileInZip64(zipFile file,
+                                          const char* filename,
+                                          const zip_fileinfo* zipfi,
+                                          const void* buf,
+                                          ZPOS64_T compressed_size,
+                                          ZPOS64_T uncompressed_size,
+                                          uLong crc32,
+                                          int method,
+                                          int level,
+                                          uLong flagBase);
+/*
+  Add a whole entry whose data is already compressed: raw deflate data
+    (no zlib header) for method Z_DEFLATED, or the data itself for method 0.
+  Only the local header, buf and the central directory record are written;
+    nothing is compressed or checksummed here, so entries can be deflated
+    elsewhere (on other threads) and handed to the writer as they finish.
+  level only selects the deflate option bits of the general purpose flag,
+    which starts from flagBase (e.g. 0x800 for UTF-8 names).
+  Zip64 extra fields are added when either size needs them.
+  With bit 3 (0x8) in flagBase the entry ends in a data descriptor; see
+    zipOpenNewFileInZip4_64.
+ */
+
 extern int ZEXPORT zipClose(zipFile file,
                             const char* global_comment);
 /*
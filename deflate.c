@@ -51,6 +51,10 @@
 
 #include "deflate.h"
 
+#ifdef __wasm_simd128__
+#  include "src/zlib_simd.h"
+#endif
+
 const char deflate_copyright[] =
    " deflate 1.3.1.1 Copyright 1995-2024 Jean-loup Gailly and Mark Adler ";
 /*
@@ -74,9 +78,12 @@ local block_state deflate_stored(deflate_state *s, int flush);
 local block_state deflate_fast(deflate_state *s, int flush);
 #ifndef FASTEST
 local block_state deflate_slow(deflate_state *s, int flush);
+local block_state deflate_ultra(deflate_state *s, int flush);
 #endif
 local block_state deflate_rle(deflate_state *s, int flush);
 local block_state deflate_huff(deflate_state *s, int flush);
+local block_state deflate_quick(deflate_state *s, int flush);
+local block_state deflate_medium(deflate_state *s, int flush);
 
 /* ===========================================================================
  * Local data
@@ -91,7 +98,7 @@ local block_state deflate_huff(deflate_state *s, int flush);
 /* Matches of length 3 are discarded if their distance exceeds TOO_FAR */
 
 /* Values for max_lazy_match, good_match and max_chain_length, depending on
- * the desired pack level (0..9). The values given below have been tuned to
+ * the desired pack level (0..10). The values given below have been tuned to
  * exclude worst case performance for pathological files. Better values may be
  * found for specific files.
  */
@@ -109,7 +116,7 @@ local const config configuration_table[2] = {
 /* 0 */ {0,    0,  0,    0, deflate_stored},  /* store only */
 /* 1 */ {4,    4,  8,    4, deflate_fast}}; /* max speed, no lazy matches */
 #else
-local const config configuration_table[10] = {
+local const config configuration_table[11] = {
 /*      good lazy nice chain */
 /* 0 */ {0,    0,  0,    0, deflate_stored},  /* store only */
 /* 1 */ {4,    4,  8,    4, deflate_fast}, /* max speed, no lazy matches */
@@ -121,7 +128,8 @@ local const config configuration_table[10] = {
 /* 6 */ {8,   16, 128, 128, deflate_slow},
 /* 7 */ {8,   32, 128, 256, deflate_slow},
 /* 8 */ {32, 128, 258, 1024, deflate_slow},
-/* 9 */ {32, 258, 258, 4096, deflate_slow}}; /* max compression */
+/* 9 */ {32, 258, 258, 4096, deflate_slow},  /* max compression */
+/* 10 */ {32, 258, 258, 4096, deflate_ultra}}; /* optimal parsing */
 #endif
 
 /* Note: the deflate() code requires max_lazy >= MIN_MATCH and max_chain >= 4
@@ -140,6 +148,35 @@ local const config configuration_table[10] = {
  */
 #define UPDATE_HASH(s,h,c) (h = (((h) << s->hash_shift) ^ (c)) & s->hash_mask)
 
+/* ===========================================================================
+ * Set h to the hash key of the string at str. The rolling hash takes h as the
+ * key of the string at str - 1. With ZLIB_HASH_MUL the key is computed from
+ * the four bytes at str alone, so it may read one byte past the window, and
+ * equal keys no longer imply equal third bytes: THIRD_DIFFERS() tests them
+ * where the match routines would otherwise rely on the key.
+ * HASH_AT() is the same key computed from the window alone; for the rolling
+ * hash it equals what UPDATE_HASH() builds over MIN_MATCH bytes, since
+ * hash_shift * MIN_MATCH >= hash_bits.
+ */
+#ifdef ZLIB_HASH_MUL
+#define HASH_AT(s, str) \
+   ((unsigned)(((((ulg)s->window[(str)] | \
+                  (ulg)s->window[(str) + 1] << 8 | \
+                  (ulg)s->window[(str) + 2] << 16 | \
+                  (ulg)s->window[(str) + 3] << 24) * 2654435761UL) & \
+                0xffffffffUL) >> (32 - s->hash_bits)))
+#define HASH_STRING(s, h, str) (h = HASH_AT(s, str))
+#define THIRD_DIFFERS(scan, match) ((scan)[2] != (match)[2])
+#else
+#define HASH_AT(s, str) \
+   (((((unsigned)s->window[(str)] << s->hash_shift) ^ \
+      s->window[(str) + 1]) << s->hash_shift ^ \
+     s->window[(str) + 2]) & s->hash_mask)
+#define HASH_STRING(s, h, str) \
+   UPDATE_HASH(s, h, s->window[(str) + (MIN_MATCH-1)])
+#define THIRD_DIFFERS(scan, match) 0
+#endif
+
 
 /* ===========================================================================
  * Insert string str in the dictionary and set match_head to the previous head
@@ -153,12 +190,12 @@ local const config configuration_table[10] = {
  */
 #ifdef FASTEST
 #define INSERT_STRING(s, str, match_head) \
-   (UPDATE_HASH(s, s->ins_h, s->window[(str) + (MIN_MATCH-1)]), \
+   (HASH_STRING(s, s->ins_h, str), \
     match_head = s->head[s->ins_h], \
     s->head[s->ins_h] = (Pos)(str))
 #else
 #define INSERT_STRING(s, str, match_head) \
-   (UPDATE_HASH(s, s->ins_h, s->window[(str) + (MIN_MATCH-1)]), \
+   (HASH_STRING(s, s->ins_h, str), \
     match_head = s->prev[(str) & s->w_mask] = s->head[s->ins_h], \
     s->head[s->ins_h] = (Pos)(str))
 #endif
@@ -185,6 +222,21 @@ local const config configuration_table[10] = {
 #  endif
 #endif
 local void slide_hash(deflate_state *s) {
+#ifdef __wasm_simd128__
+    /* hash_size and w_size are powers of two >= 256, so the vectorized
+     * version always covers whole tables.
+     */
+#  ifdef FASTEST
+    zlib_slide_hash_simd(s->head, Z_NULL, s->hash_size, 0, (uint16_t)s->w_size);
+#  else
+    if (s->strategy == Z_QUICK)
+        zlib_slide_hash_simd(s->head, Z_NULL, s->hash_size, 0,
+                             (uint16_t)s->w_size);
+    else
+        zlib_slide_hash_simd(s->head, s->prev, s->hash_size, s->w_size,
+                             (uint16_t)s->w_size);
+#  endif
+#else
     unsigned n, m;
     Posf *p;
     uInt wsize = s->w_size;
@@ -197,6 +249,7 @@ local void slide_hash(deflate_state *s) {
     } while (--n);
     n = wsize;
 #ifndef FASTEST
+    if (s->strategy == Z_QUICK) return;     /* prev[] is not kept */
     p = &s->prev[n];
     do {
         m = *--p;
@@ -206,6 +259,52 @@ local void slide_hash(deflate_state *s) {
          */
     } while (--n);
 #endif
+#endif /* __wasm_simd128__ */
+}
+
+/* ===========================================================================
+ * Insert the count strings from str in the dictionary, as count successive
+ * INSERT_STRING() calls would, leaving ins_h as they would leave it. The keys
+ * are computed from the window directly, so -msimd128 builds hash eight
+ * strings per vector before linking them into the chains in order.
+ * IN  assertion: the first MIN_MATCH bytes of each string are valid.
+ */
+#define INSERT_BATCH 64
+
+local void insert_run(deflate_state *s, uInt str, uInt count) {
+    uInt h = s->ins_h;
+#ifdef __wasm_simd128__
+    uint16_t keys[INSERT_BATCH];
+
+    while (count >= 8) {
+        uInt i, n = count < INSERT_BATCH ? count & ~7U : INSERT_BATCH;
+
+#  ifdef ZLIB_HASH_MUL
+        zlib_hash4_keys_simd(s->window + str, n, s->hash_bits, keys);
+#  else
+        zlib_hash3_keys_simd(s->window + str, n, s->hash_shift, s->hash_mask,
+                             keys);
+#  endif
+        for (i = 0; i < n; i++) {
+            h = keys[i];
+#  ifndef FASTEST
+            s->prev[str & s->w_mask] = s->head[h];
+#  endif
+            s->head[h] = (Pos)str;
+            str++;
+        }
+        count -= n;
+    }
+#endif
+    while (count--) {
+        h = HASH_AT(s, str);
+#ifndef FASTEST
+        s->prev[str & s->w_mask] = s->head[h];
+#endif
+        s->head[h] = (Pos)str;
+        str++;
+    }
+    s->ins_h = h;
 }
 
 /* ===========================================================================
@@ -252,6 +351,7 @@ local void fill_window(deflate_state *s) {
     unsigned n;
     unsigned more;    /* Amount of free space at the end of the window. */
     uInt wsize = s->w_size;
+    ZSTATS_BEGIN(ZSTATS_FILL_WINDOW);
 
     Assert(s->lookahead < MIN_LOOKAHEAD, "already enough lookahead");
 
@@ -275,6 +375,7 @@ local void fill_window(deflate_state *s) {
          * move the upper half to the lower one to make room in the upper half.
          */
         if (s->strstart >= wsize + MAX_DIST(s)) {
+            ZSTATS_BEGIN(ZSTATS_SLIDE_HASH);
 
             zmemcpy(s->window, s->window + wsize, (unsigned)wsize - more);
             s->match_start -= wsize;
@@ -283,6 +384,7 @@ local void fill_window(deflate_state *s) {
             if (s->insert > s->strstart)
                 s->insert = s->strstart;
             slide_hash(s);
+            ZSTATS_END(ZSTATS_SLIDE_HASH, s->hash_size + wsize);
             more += wsize;
         }
         if (s->strm->avail_in == 0) break;
@@ -302,6 +404,7 @@ local void fill_window(deflate_state *s) {
 
         n = read_buf(s->strm, s->window + s->strstart + s->lookahead, more);
         s->lookahead += n;
+        ZSTATS_BYTES(ZSTATS_FILL_WINDOW, n);
 
         /* Initialize the hash value now that we have some input: */
         if (s->lookahead + s->insert >= MIN_MATCH) {
@@ -311,17 +414,11 @@ local void fill_window(deflate_state *s) {
 #if MIN_MATCH != 3
             Call UPDATE_HASH() MIN_MATCH-3 more times
 #endif
-            while (s->insert) {
-                UPDATE_HASH(s, s->ins_h, s->window[str + MIN_MATCH-1]);
-#ifndef FASTEST
-                s->prev[str & s->w_mask] = s->head[s->ins_h];
-#endif
-                s->head[s->ins_h] = (Pos)str;
-                str++;
-                s->insert--;
-                if (s->lookahead + s->insert < MIN_MATCH)
-                    break;
-            }
+            /* Stop where fewer than MIN_MATCH bytes follow the string */
+            n = s->lookahead + s->insert - (MIN_MATCH-1);
+            if (n > s->insert) n = s->insert;
+            insert_run(s, str, n);
+            s->insert -= n;
         }
         /* If the whole input has less than MIN_MATCH bytes, ins_h is garbage,
          * but this is not important since only literal bytes will be emitted.
@@ -365,6 +462,7 @@ local void fill_window(deflate_state *s) {
 
     Assert((ulg)s->strstart <= s->window_size - MIN_LOOKAHEAD,
            "not enough room for search");
+    ZSTATS_END(ZSTATS_FILL_WINDOW, 0);
 }
 
 /* ========================================================================= */
@@ -424,8 +522,9 @@ int ZEXPORT deflateInit2_(z_streamp strm, int level, int method,
     }
 #endif
     if (memLevel < 1 || memLevel > MAX_MEM_LEVEL || method != Z_DEFLATED ||
-        windowBits < 8 || windowBits > 15 || level < 0 || level > 9 ||
-        strategy < 0 || strategy > Z_FIXED || (windowBits == 8 && wrap != 1)) {
+        windowBits < 8 || windowBits > 15 || level < 0 ||
+        level > Z_ULTRA_COMPRESSION || strategy < 0 || strategy > Z_MEDIUM ||
+        (windowBits == 8 && wrap != 1)) {
         return Z_STREAM_ERROR;
     }
     if (windowBits == 8) windowBits = 9;  /* until 256-byte window bug fixed */
@@ -446,7 +545,8 @@ int ZEXPORT deflateInit2_(z_streamp strm, int level, int method,
     s->hash_mask = s->hash_size - 1;
     s->hash_shift =  ((s->hash_bits + MIN_MATCH-1) / MIN_MATCH);
 
-    s->window = (Bytef *) ZALLOC(strm, s->w_size, 2*sizeof(Byte));
+    s->window = (Bytef *) ZALLOC(strm, 2 * s->w_size + WINDOW_PAD,
+                                  sizeof(Byte));
     s->prev   = (Posf *)  ZALLOC(strm, s->w_size, sizeof(Pos));
     s->head   = (Posf *)  ZALLOC(strm, s->hash_size, sizeof(Pos));
 
@@ -496,8 +596,13 @@ int ZEXPORT deflateInit2_(z_streamp strm, int level, int method,
     s->pending_buf = (uchf *) ZALLOC(strm, s->lit_bufsize, LIT_BUFS);
     s->pending_buf_size = (ulg)s->lit_bufsize * 4;
 
+    s->ultra_buf = Z_NULL;
+    if (level == Z_ULTRA_COMPRESSION)
+        s->ultra_buf = (uchf *) ZALLOC(strm, s->lit_bufsize + 1, ULTRA_BUFS);
+
     if (s->window == Z_NULL || s->prev == Z_NULL || s->head == Z_NULL ||
-        s->pending_buf == Z_NULL) {
+        s->pending_buf == Z_NULL ||
+        (level == Z_ULTRA_COMPRESSION && s->ultra_buf == Z_NULL)) {
         s->status = FINISH_STATE;
         strm->msg = ERR_MSG(Z_MEM_ERROR);
         deflateEnd (strm);
@@ -550,7 +655,7 @@ local int deflateStateCheck(z_streamp strm) {
 int ZEXPORT deflateSetDictionary(z_streamp strm, const Bytef *dictionary,
                                  uInt  dictLength) {
     deflate_state *s;
-    uInt str, n;
+    uInt n;
     int wrap;
     unsigned avail;
     z_const unsigned char *next;
@@ -586,17 +691,9 @@ int ZEXPORT deflateSetDictionary(z_streamp strm, const Bytef *dictionary,
     strm->next_in = (z_const Bytef *)dictionary;
     fill_window(s);
     while (s->lookahead >= MIN_MATCH) {
-        str = s->strstart;
         n = s->lookahead - (MIN_MATCH-1);
-        do {
-            UPDATE_HASH(s, s->ins_h, s->window[str + MIN_MATCH-1]);
-#ifndef FASTEST
-            s->prev[str & s->w_mask] = s->head[s->ins_h];
-#endif
-            s->head[s->ins_h] = (Pos)str;
-            str++;
-        } while (--n);
-        s->strstart = str;
+        insert_run(s, s->strstart, n);
+        s->strstart += n;
         s->lookahead = MIN_MATCH-1;
         fill_window(s);
     }
@@ -672,6 +769,9 @@ int ZEXPORT deflateResetKeep(z_streamp strm) {
  */
 local void lm_init(deflate_state *s) {
     s->window_size = (ulg)2L*s->w_size;
+#if WINDOW_PAD
+    zmemzero(s->window + s->window_size, WINDOW_PAD);
+#endif
 
     CLEAR_HASH(s);
 
@@ -769,11 +869,16 @@ int ZEXPORT deflateParams(z_streamp strm, int level, int strategy) {
 #else
     if (level == Z_DEFAULT_COMPRESSION) level = 6;
 #endif
-    if (level < 0 || level > 9 || strategy < 0 || strategy > Z_FIXED) {
+    if (level < 0 || level > Z_ULTRA_COMPRESSION || strategy < 0 ||
+        strategy > Z_MEDIUM) {
         return Z_STREAM_ERROR;
     }
     func = configuration_table[s->level].func;
 
+    if (level == Z_ULTRA_COMPRESSION && s->ultra_buf == Z_NULL) {
+        s->ultra_buf = (uchf *) ZALLOC(strm, s->lit_bufsize + 1, ULTRA_BUFS);
+        if (s->ultra_buf == Z_NULL) return Z_MEM_ERROR;
+    }
     if ((strategy != s->strategy || func != configuration_table[level].func) &&
         s->last_flush != -2) {
         /* Flush the last buffer: */
@@ -783,6 +888,11 @@ int ZEXPORT deflateParams(z_streamp strm, int level, int strategy) {
         if (strm->avail_in || (s->strstart - s->block_start) + s->lookahead)
             return Z_BUF_ERROR;
     }
+    if (s->strategy == Z_QUICK && strategy != Z_QUICK &&
+        s->last_flush != -2) {
+        /* Z_QUICK leaves prev[] stale, so no chain may reach back past here */
+        CLEAR_HASH(s);
+    }
     if (s->level != level) {
         if (s->level == 0 && s->matches != 0) {
             if (s->matches == 1)
@@ -815,6 +925,49 @@ int ZEXPORT deflateTune(z_streamp strm, int good_length, int max_lazy,
     return Z_OK;
 }
 
+/* ========================================================================= */
+int ZEXPORT deflateSymbolBits(z_streamp strm, int bits) {
+    deflate_state *s;
+    uInt lit_bufsize;
+    uchf *pending_buf;
+    uchf *ultra_buf = Z_NULL;
+
+    if (deflateStateCheck(strm)) return Z_STREAM_ERROR;
+    s = strm->state;
+    if (bits < 7 || bits > 15 || s->last_flush != -2 || s->pending != 0)
+        return Z_STREAM_ERROR;
+    lit_bufsize = 1U << bits;
+    if (lit_bufsize == s->lit_bufsize)
+        return Z_OK;
+
+    /* On failure the stream is left as it was */
+    pending_buf = (uchf *) ZALLOC(strm, lit_bufsize, LIT_BUFS);
+    if (s->ultra_buf != Z_NULL)
+        ultra_buf = (uchf *) ZALLOC(strm, lit_bufsize + 1, ULTRA_BUFS);
+    if (pending_buf == Z_NULL || (s->ultra_buf != Z_NULL && ultra_buf == Z_NULL)) {
+        TRY_FREE(strm, ultra_buf);
+        TRY_FREE(strm, pending_buf);
+        return Z_MEM_ERROR;
+    }
+    TRY_FREE(strm, s->ultra_buf);
+    ZFREE(strm, s->pending_buf);
+
+    s->ultra_buf = ultra_buf;
+    s->lit_bufsize = lit_bufsize;
+    s->pending_buf = pending_buf;
+    s->pending_buf_size = (ulg)lit_bufsize * 4;
+    s->pending_out = s->pending_buf;
+#ifdef LIT_MEM
+    s->d_buf = (ushf *)(s->pending_buf + (s->lit_bufsize << 1));
+    s->l_buf = s->pending_buf + (s->lit_bufsize << 2);
+    s->sym_end = s->lit_bufsize - 1;
+#else
+    s->sym_buf = s->pending_buf + s->lit_bufsize;
+    s->sym_end = (s->lit_bufsize - 1) * 3;
+#endif
+    return Z_OK;
+}
+
 /* =========================================================================
  * For the default windowBits of 15 and memLevel of 8, this function returns a
  * close to exact, as well as small, upper bound on the compressed size. This
@@ -893,10 +1046,12 @@ uLong ZEXPORT deflateBound(z_streamp strm, uLong sourceLen) {
         wraplen = 18;
     }
 
-    /* if not default parameters, return one of the conservative bounds */
-    if (s->w_bits != 15 || s->hash_bits != 8 + 7)
-        return (s->w_bits <= s->hash_bits && s->level ? fixedlen : storelen) +
-               wraplen;
+    /* if not default parameters, return one of the conservative bounds;
+       windowBits <= memLevel + 7 is w_size <= 2 * lit_bufsize, which also
+       holds for a symbol buffer sized by deflateSymbolBits() */
+    if (s->w_bits != 15 || s->hash_bits != 8 + 7 || s->lit_bufsize != 1 << 14)
+        return (s->w_size <= (ulg)s->lit_bufsize << 1 && s->level ? fixedlen :
+                storelen) + wraplen;
 
     /* default settings: return tight bound for that case -- ~0.03% overhead
        plus a small constant */
@@ -1048,7 +1203,7 @@ int ZEXPORT deflate(z_streamp strm, int flush) {
             put_byte(s, 0);
             put_byte(s, 0);
             put_byte(s, 0);
-            put_byte(s, s->level == 9 ? 2 :
+            put_byte(s, s->level >= 9 ? 2 :
                      (s->strategy >= Z_HUFFMAN_ONLY || s->level < 2 ?
                       4 : 0));
             put_byte(s, OS_CODE);
@@ -1072,7 +1227,7 @@ int ZEXPORT deflate(z_streamp strm, int flush) {
             put_byte(s, (Byte)((s->gzhead->time >> 8) & 0xff));
             put_byte(s, (Byte)((s->gzhead->time >> 16) & 0xff));
             put_byte(s, (Byte)((s->gzhead->time >> 24) & 0xff));
-            put_byte(s, s->level == 9 ? 2 :
+            put_byte(s, s->level >= 9 ? 2 :
                      (s->strategy >= Z_HUFFMAN_ONLY || s->level < 2 ?
                       4 : 0));
             put_byte(s, s->gzhead->os & 0xff);
@@ -1190,6 +1345,8 @@ int ZEXPORT deflate(z_streamp strm, int flush) {
         bstate = s->level == 0 ? deflate_stored(s, flush) :
                  s->strategy == Z_HUFFMAN_ONLY ? deflate_huff(s, flush) :
                  s->strategy == Z_RLE ? deflate_rle(s, flush) :
+                 s->strategy == Z_QUICK ? deflate_quick(s, flush) :
+                 s->strategy == Z_MEDIUM ? deflate_medium(s, flush) :
                  (*(configuration_table[s->level].func))(s, flush);
 
         if (bstate == finish_started || bstate == finish_done) {
@@ -1271,6 +1428,7 @@ int ZEXPORT deflateEnd(z_streamp strm) {
     status = strm->state->status;
 
     /* Deallocate in reverse order of allocations: */
+    TRY_FREE(strm, strm->state->ultra_buf);
     TRY_FREE(strm, strm->state->pending_buf);
     TRY_FREE(strm, strm->state->head);
     TRY_FREE(strm, strm->state->prev);
@@ -1311,18 +1469,25 @@ int ZEXPORT deflateCopy(z_streamp dest, z_streamp source) {
     zmemcpy((voidpf)ds, (voidpf)ss, sizeof(deflate_state));
     ds->strm = dest;
 
-    ds->window = (Bytef *) ZALLOC(dest, ds->w_size, 2*sizeof(Byte));
+    ds->window = (Bytef *) ZALLOC(dest, 2 * ds->w_size + WINDOW_PAD,
+                                   sizeof(Byte));
     ds->prev   = (Posf *)  ZALLOC(dest, ds->w_size, sizeof(Pos));
     ds->head   = (Posf *)  ZALLOC(dest, ds->hash_size, sizeof(Pos));
     ds->pending_buf = (uchf *) ZALLOC(dest, ds->lit_bufsize, LIT_BUFS);
+    /* The parse workspace holds nothing between deflate() calls */
+    ds->ultra_buf = Z_NULL;
+    if (ss->ultra_buf != Z_NULL)
+        ds->ultra_buf = (uchf *) ZALLOC(dest, ds->lit_bufsize + 1, ULTRA_BUFS);
 
     if (ds->window == Z_NULL || ds->prev == Z_NULL || ds->head == Z_NULL ||
-        ds->pending_buf == Z_NULL) {
+        ds->pending_buf == Z_NULL ||
+        (ss->ultra_buf != Z_NULL && ds->ultra_buf == Z_NULL)) {
         deflateEnd (dest);
         return Z_MEM_ERROR;
     }
     /* following zmemcpy do not work for 16-bit MSDOS */
-    zmemcpy(ds->window, ss->window, ds->w_size * 2 * sizeof(Byte));
+    zmemcpy(ds->window, ss->window,
+            (ds->w_size * 2 + WINDOW_PAD) * sizeof(Byte));
     zmemcpy((voidpf)ds->prev, (voidpf)ss->prev, ds->w_size * sizeof(Pos));
     zmemcpy((voidpf)ds->head, (voidpf)ss->head, ds->hash_size * sizeof(Pos));
     zmemcpy(ds->pending_buf, ss->pending_buf, ds->lit_bufsize * LIT_BUFS);
@@ -1376,10 +1541,13 @@ local uInt longest_match(deflate_state *s, IPos cur_match) {
     register ush scan_start = *(ushf*)scan;
     register ush scan_end   = *(ushf*)(scan + best_len - 1);
 #else
+#ifndef __wasm_simd128__
     register Bytef *strend = s->window + s->strstart + MAX_MATCH;
+#endif
     register Byte scan_end1  = scan[best_len - 1];
     register Byte scan_end   = scan[best_len];
 #endif
+    ZSTATS_BEGIN(ZSTATS_LONGEST_MATCH);
 
     /* The code is optimized for HASH_BITS >= 8 and MAX_MATCH-2 multiple of 16.
      * It is easy to get rid of this optimization if necessary.
@@ -1415,11 +1583,13 @@ local uInt longest_match(deflate_state *s, IPos cur_match) {
          * UNALIGNED_OK if your compiler uses a different size.
          */
         if (*(ushf*)(match + best_len - 1) != scan_end ||
-            *(ushf*)match != scan_start) continue;
+            *(ushf*)match != scan_start ||
+            THIRD_DIFFERS(scan, match)) continue;
 
         /* It is not necessary to compare scan[2] and match[2] since they are
          * always equal when the other bytes match, given that the hash keys
-         * are equal and that HASH_BITS >= 8. Compare 2 bytes at a time at
+         * are equal and that HASH_BITS >= 8 (THIRD_DIFFERS() compares them
+         * for ZLIB_HASH_MUL). Compare 2 bytes at a time at
          * strstart + 3, + 5, up to strstart + 257. We check for insufficient
          * lookahead only every 4th comparison; the 128th check will be made
          * at strstart + 257. If MAX_MATCH-2 is not a multiple of 8, it is
@@ -1449,14 +1619,23 @@ local uInt longest_match(deflate_state *s, IPos cur_match) {
         if (match[best_len]     != scan_end  ||
             match[best_len - 1] != scan_end1 ||
             *match              != *scan     ||
+            THIRD_DIFFERS(scan, match)       ||
             *++match            != scan[1])      continue;
 
         /* The check at best_len - 1 can be removed because it will be made
          * again later. (This heuristic is not always a win.)
          * It is not necessary to compare scan[2] and match[2] since they
          * are always equal when the other bytes match, given that
-         * the hash keys are equal and that HASH_BITS >= 8.
+         * the hash keys are equal and that HASH_BITS >= 8, or checked
+         * by THIRD_DIFFERS().
          */
+#ifdef __wasm_simd128__
+        /* Compare strstart + 3 .. strstart + 258 sixteen bytes at a time.
+         * The result is capped exactly as the scalar loop below caps it,
+         * so the output is unchanged.
+         */
+        len = (int)zlib_match_len_simd(scan, s->window + cur_match);
+#else
         scan += 2, match++;
         Assert(*scan == *match, "match[2]?");
 
@@ -1475,6 +1654,7 @@ local uInt longest_match(deflate_state *s, IPos cur_match) {
 
         len = MAX_MATCH - (int)(strend - scan);
         scan = strend - MAX_MATCH;
+#endif /* __wasm_simd128__ */
 
 #endif /* UNALIGNED_OK */
 
@@ -1492,6 +1672,14 @@ local uInt longest_match(deflate_state *s, IPos cur_match) {
     } while ((cur_match = prev[cur_match & wmask]) > limit
              && --chain_length != 0);
 
+    /* Entries probed: the loop stops with chain_length at 0 only when the
+     * budget ran out, and otherwise before counting the last probe.
+     */
+    ZSTATS_CHAIN((s->prev_length >= s->good_match ?
+                  s->max_chain_length >> 2 : s->max_chain_length) -
+                 chain_length + (chain_length != 0));
+    ZSTATS_END(ZSTATS_LONGEST_MATCH, best_len);
+
     if ((uInt)best_len <= s->lookahead) return (uInt)best_len;
     return s->lookahead;
 }
@@ -1521,13 +1709,15 @@ local uInt longest_match(deflate_state *s, IPos cur_match) {
 
     /* Return failure if the match length is less than 2:
      */
-    if (match[0] != scan[0] || match[1] != scan[1]) return MIN_MATCH-1;
+    if (match[0] != scan[0] || match[1] != scan[1] ||
+        THIRD_DIFFERS(scan, match)) return MIN_MATCH-1;
 
     /* The check at best_len - 1 can be removed because it will be made
      * again later. (This heuristic is not always a win.)
      * It is not necessary to compare scan[2] and match[2] since they
      * are always equal when the other bytes match, given that
-     * the hash keys are equal and that HASH_BITS >= 8.
+     * the hash keys are equal and that HASH_BITS >= 8, or checked
+     * by THIRD_DIFFERS().
      */
     scan += 2, match += 2;
     Assert(*scan == *match, "match[2]?");
@@ -1872,15 +2062,13 @@ local block_state deflate_fast(deflate_state *s, int flush) {
 #ifndef FASTEST
             if (s->match_length <= s->max_insert_length &&
                 s->lookahead >= MIN_MATCH) {
-                s->match_length--; /* string at strstart already in table */
-                do {
-                    s->strstart++;
-                    INSERT_STRING(s, s->strstart, hash_head);
-                    /* strstart never exceeds WSIZE-MAX_MATCH, so there are
-                     * always MIN_MATCH bytes ahead.
-                     */
-                } while (--s->match_length != 0);
-                s->strstart++;
+                /* The string at strstart is already in the table. strstart
+                 * never exceeds WSIZE-MAX_MATCH, so there are always
+                 * MIN_MATCH bytes ahead.
+                 */
+                insert_run(s, s->strstart + 1, s->match_length - 1);
+                s->strstart += s->match_length;
+                s->match_length = 0;
             } else
 #endif
             {
@@ -1980,6 +2168,7 @@ local block_state deflate_slow(deflate_state *s, int flush) {
         if (s->prev_length >= MIN_MATCH && s->match_length <= s->prev_length) {
             uInt max_insert = s->strstart + s->lookahead - MIN_MATCH;
             /* Do not insert strings in hash table beyond this. */
+            uInt n;
 
             check_match(s, s->strstart - 1, s->prev_match, s->prev_length);
 
@@ -1992,15 +2181,14 @@ local block_state deflate_slow(deflate_state *s, int flush) {
              * the hash table.
              */
             s->lookahead -= s->prev_length - 1;
-            s->prev_length -= 2;
-            do {
-                if (++s->strstart <= max_insert) {
-                    INSERT_STRING(s, s->strstart, hash_head);
-                }
-            } while (--s->prev_length != 0);
+            n = s->prev_length - 2;
+            if (s->strstart + n > max_insert)
+                n = max_insert > s->strstart ? max_insert - s->strstart : 0;
+            insert_run(s, s->strstart + 1, n);
+            s->strstart += s->prev_length - 1;
+            s->prev_length = 0;
             s->match_available = 0;
             s->match_length = MIN_MATCH-1;
-            s->strstart++;
 
             if (bflush) FLUSH_BLOCK(s, 0);
 
@@ -2051,7 +2239,11 @@ local block_state deflate_slow(deflate_state *s, int flush) {
 local block_state deflate_rle(deflate_state *s, int flush) {
     int bflush;             /* set if current block must be flushed */
     uInt prev;              /* byte at distance one to match */
+#ifdef __wasm_simd128__
+    Bytef *scan;            /* start of the run */
+#else
     Bytef *scan, *strend;   /* scan goes up to strend for length of run */
+#endif
 
     for (;;) {
         /* Make sure that we always have enough lookahead, except
@@ -2071,6 +2263,15 @@ local block_state deflate_rle(deflate_state *s, int flush) {
         if (s->lookahead >= MIN_MATCH && s->strstart > 0) {
             scan = s->window + s->strstart - 1;
             prev = *scan;
+#ifdef __wasm_simd128__
+            /* The first three bytes decide; the vectorized scan measures
+             * the rest of the run, up to the lookahead.
+             */
+            if (prev == scan[1] && prev == scan[2] && prev == scan[3]) {
+                s->match_length = zlib_run_len_simd(scan + 1,
+                    s->lookahead < MAX_MATCH ? s->lookahead : MAX_MATCH);
+            }
+#else
             if (prev == *++scan && prev == *++scan && prev == *++scan) {
                 strend = s->window + s->strstart + MAX_MATCH;
                 do {
@@ -2085,6 +2286,7 @@ local block_state deflate_rle(deflate_state *s, int flush) {
             }
             Assert(scan <= s->window + (uInt)(s->window_size - 1),
                    "wild scan");
+#endif
         }
 
         /* Emit match if have run of MIN_MATCH or longer, else emit literal */
@@ -2115,6 +2317,42 @@ local block_state deflate_rle(deflate_state *s, int flush) {
     return block_done;
 }
 
+#if defined(__wasm_simd128__) && !defined(ZLIB_DEBUG)
+/* ===========================================================================
+ * Tally the literals at strstart for deflate_huff(), as many as the lookahead
+ * and the symbol buffer have room for, and return how many. The symbol
+ * buffer entries and the literal counts come from vectorized kernels rather
+ * than from one _tr_tally_lit() per byte; the block is the same.
+ */
+#define TALLY_BATCH_MIN 64
+
+local uInt tally_literals(deflate_state *s) {
+    Bytef *lit = s->window + s->strstart;
+    uInt room = s->sym_end - s->sym_next;
+    uInt n, c;
+#ifdef LIT_MEM
+    n = s->lookahead < room ? s->lookahead : room;
+    zmemzero(s->d_buf + s->sym_next, n * sizeof(ush));
+    zmemcpy(s->l_buf + s->sym_next, lit, n);
+    s->sym_next += n;
+#else
+    n = s->lookahead < room / 3 ? s->lookahead : room / 3;
+    zlib_literal_syms_simd(lit, n, s->sym_buf + s->sym_next);
+    s->sym_next += 3 * n;
+#endif
+    if (n < TALLY_BATCH_MIN) {
+        /* Too few for the histogram's table sweep to pay */
+        for (c = 0; c < n; c++) s->dyn_ltree[lit[c]].Freq++;
+    } else {
+        uint32_t counts[LITERALS];
+        zmemzero(counts, sizeof(counts));
+        zlib_byte_counts_simd(lit, n, counts);
+        for (c = 0; c < LITERALS; c++) s->dyn_ltree[c].Freq += (ush)counts[c];
+    }
+    return n;
+}
+#endif
+
 /* ===========================================================================
  * For Z_HUFFMAN_ONLY, do not look for matches.  Do not maintain a hash table.
  * (It will be regenerated if this run of deflate switches away from Huffman.)
@@ -2135,10 +2373,19 @@ local block_state deflate_huff(deflate_state *s, int flush) {
 
         /* Output a literal byte */
         s->match_length = 0;
+#if defined(__wasm_simd128__) && !defined(ZLIB_DEBUG)
+        {
+            uInt n = tally_literals(s);
+            s->lookahead -= n;
+            s->strstart += n;
+            bflush = s->sym_next == s->sym_end;
+        }
+#else
         Tracevv((stderr,"%c", s->window[s->strstart]));
         _tr_tally_lit(s, s->window[s->strstart], bflush);
         s->lookahead--;
         s->strstart++;
+#endif
         if (bflush) FLUSH_BLOCK(s, 0);
     }
     s->insert = 0;
@@ -2150,3 +2397,657 @@ local block_state deflate_huff(deflate_state *s, int flush) {
         FLUSH_BLOCK(s, 0);
     return block_done;
 }
+
+/* ===========================================================================
+ * Length of the match at match for the string at scan, at most max bytes, for
+ * deflate_quick(). The caller has compared the first two bytes; the third is
+ * then equal because the hash keys are, or THIRD_DIFFERS() has checked it.
+ */
+local uInt quick_match_len(Bytef *scan, Bytef *match, uInt max) {
+    uInt len;
+#ifdef __wasm_simd128__
+    len = (uInt)zlib_match_len_simd(scan, match);
+#else
+    Bytef *strend = scan + MAX_MATCH;
+    Bytef *start = scan;
+
+    scan += 2, match += 2;
+    Assert(*scan == *match, "match[2]?");
+    do {
+    } while (*++scan == *++match && *++scan == *++match &&
+             *++scan == *++match && *++scan == *++match &&
+             *++scan == *++match && *++scan == *++match &&
+             *++scan == *++match && *++scan == *++match &&
+             scan < strend);
+    len = (uInt)(scan - start);
+#endif
+    return len < max ? len : max;
+}
+
+/* ===========================================================================
+ * For Z_QUICK, check only the most recent string with the same hash at each
+ * position, take any match of MIN_MATCH or more at once, and skip the hash
+ * insertions inside it. No chains are followed, so prev[] is neither written
+ * nor slid. _tr_flush_block() sends the result with the static trees, or
+ * stored, without building dynamic trees.
+ */
+local block_state deflate_quick(deflate_state *s, int flush) {
+    IPos hash_head;       /* most recent string with the same hash */
+    int bflush;           /* set if current block must be flushed */
+
+    for (;;) {
+        /* Make sure that we always have enough lookahead, except
+         * at the end of the input file, as in deflate_fast().
+         */
+        if (s->lookahead < MIN_LOOKAHEAD) {
+            fill_window(s);
+            if (s->lookahead < MIN_LOOKAHEAD && flush == Z_NO_FLUSH) {
+                return need_more;
+            }
+            if (s->lookahead == 0) break; /* flush the current block */
+        }
+
+        s->match_length = 0;
+        if (s->lookahead >= MIN_MATCH) {
+            /* INSERT_STRING() without the prev[] link, which is not read */
+            HASH_STRING(s, s->ins_h, s->strstart);
+            hash_head = s->head[s->ins_h];
+            s->head[s->ins_h] = (Pos)s->strstart;
+            if (hash_head != NIL && s->strstart - hash_head <= MAX_DIST(s)) {
+                Bytef *scan = s->window + s->strstart;
+                Bytef *match = s->window + hash_head;
+                if (scan[0] == match[0] && scan[1] == match[1] &&
+                    !THIRD_DIFFERS(scan, match))
+                    s->match_length = quick_match_len(scan, match,
+                                                       s->lookahead);
+            }
+        }
+
+        if (s->match_length >= MIN_MATCH) {
+            check_match(s, s->strstart, hash_head, s->match_length);
+
+            _tr_tally_dist(s, s->strstart - hash_head,
+                           s->match_length - MIN_MATCH, bflush);
+
+            s->lookahead -= s->match_length;
+            s->strstart += s->match_length;
+            s->match_length = 0;
+            s->ins_h = s->window[s->strstart];
+            UPDATE_HASH(s, s->ins_h, s->window[s->strstart + 1]);
+#if MIN_MATCH != 3
+            Call UPDATE_HASH() MIN_MATCH-3 more times
+#endif
+        } else {
+            /* No match, output a literal byte */
+            Tracevv((stderr,"%c", s->window[s->strstart]));
+            _tr_tally_lit(s, s->window[s->strstart], bflush);
+            s->lookahead--;
+            s->strstart++;
+        }
+        if (bflush) FLUSH_BLOCK(s, 0);
+    }
+    s->insert = s->strstart < MIN_MATCH-1 ? s->strstart : MIN_MATCH-1;
+    if (flush == Z_FINISH) {
+        FLUSH_BLOCK(s, 1);
+        return finish_done;
+    }
+    if (s->sym_next)
+        FLUSH_BLOCK(s, 0);
+    return block_done;
+}
+
+/* ===========================================================================
+ * A match or literal chosen by deflate_medium(): match_length is at least
+ * MIN_MATCH for a match, 1 for a literal, or 0 once the following match has
+ * taken it over.
+ */
+typedef struct medium_match_s {
+    uInt strstart;      /* where it starts */
+    uInt match_start;   /* start of the matched string, for a match */
+    uInt match_length;
+} medium_match;
+
+/* ===========================================================================
+ * Find the longest match for the string at pos, at or after strstart and
+ * within the lookahead, without inserting it in the hash table.
+ */
+local void medium_find(deflate_state *s, medium_match *m, uInt pos) {
+    uInt strstart = s->strstart;
+    uInt lookahead = s->lookahead;
+    uInt len;
+    unsigned h;
+    IPos hash_head;
+
+    m->strstart = pos;
+    m->match_length = 1;
+    if (lookahead - (pos - strstart) < MIN_MATCH) return;
+
+    h = s->window[pos];
+    UPDATE_HASH(s, h, s->window[pos + 1]);
+    HASH_STRING(s, h, pos);
+#if MIN_MATCH != 3
+    Call UPDATE_HASH() MIN_MATCH-3 more times
+#endif
+    hash_head = s->head[h];
+    if (hash_head == NIL || pos - hash_head > MAX_DIST(s)) return;
+
+    /* longest_match() works at strstart and within lookahead */
+    s->strstart = pos;
+    s->lookahead = lookahead - (pos - strstart);
+    s->prev_length = MIN_MATCH-1;
+    len = longest_match(s, hash_head);
+    s->strstart = strstart;
+    s->lookahead = lookahead;
+
+    if (len < MIN_MATCH) return;
+#if TOO_FAR <= 32767
+    if (len == MIN_MATCH && pos - s->match_start > TOO_FAR) return;
+#endif
+    m->match_start = s->match_start;
+    m->match_length = len;
+}
+
+/* ===========================================================================
+ * If next, found right after cur, can be extended back over all of cur, or
+ * all of it but its first byte, move the start of next back and leave cur as
+ * nothing or a literal. A match and its successor then cost one match.
+ */
+local void medium_fizzle(deflate_state *s, medium_match *cur,
+                         medium_match *next) {
+    Bytef *scan = s->window + next->strstart;
+    Bytef *match = s->window + next->match_start;
+    uInt n = cur->match_length - 1;     /* bytes next must take over */
+    uInt i;
+
+    if (cur->match_length < MIN_MATCH || next->match_length < MIN_MATCH ||
+        next->match_start <= n || next->match_length + n > MAX_MATCH)
+        return;
+
+    /* Check the farthest byte first: it fails most often */
+    if (*(scan - n) != *(match - n)) return;
+    for (i = 1; i < n; i++)
+        if (*(scan - i) != *(match - i)) return;
+
+    next->strstart -= n;
+    next->match_start -= n;
+    next->match_length += n;
+    cur->match_length = 1;
+
+    /* Take the first byte too if it matches; no match starts at index 0 */
+    if (next->match_start > 1 && next->match_length < MAX_MATCH &&
+        *(scan - n - 1) == *(match - n - 1)) {
+        next->strstart--;
+        next->match_start--;
+        next->match_length++;
+        cur->match_length = 0;
+    }
+}
+
+#ifdef LIT_MEM
+#  define LAST_SYMBOL(s) ((s)->sym_next + 1 == (s)->sym_end)
+#else
+#  define LAST_SYMBOL(s) ((s)->sym_next + 3 == (s)->sym_end)
+#endif
+/* The next symbol tallied fills the symbol buffer */
+
+/* ===========================================================================
+ * For Z_MEDIUM, take the match found at each position without lazy
+ * evaluation, but look up the match that follows it first so that the
+ * following match can take it over (medium_fizzle()). Each position is
+ * searched once, and the result for the following match is used for the next
+ * round. All positions are inserted in the hash table.
+ */
+local block_state deflate_medium(deflate_state *s, int flush) {
+    medium_match cur, next;
+    uInt hashed = 0;      /* strings before this are in the hash table */
+    uInt end;             /* end of cur */
+    int bflush;           /* set if current block must be flushed */
+
+    next.match_length = 0;
+    for (;;) {
+        /* Make sure that we always have enough lookahead, except
+         * at the end of the input file, as in deflate_fast(). A next match
+         * is only kept when this cannot be needed before it is used.
+         */
+        if (s->lookahead < MIN_LOOKAHEAD) {
+            fill_window(s);
+            if (s->lookahead < MIN_LOOKAHEAD && flush == Z_NO_FLUSH) {
+                return need_more;
+            }
+            if (s->lookahead == 0) break; /* flush the current block */
+        }
+
+        if (next.match_length != 0) {
+            Assert(next.strstart == s->strstart, "lost next match");
+            cur = next;
+        } else {
+            medium_find(s, &cur, s->strstart);
+            hashed = s->strstart;
+        }
+        next.match_length = 0;
+
+        /* Insert the strings cur covers. The start of a taken-over next
+         * match was inserted as part of the one before.
+         */
+        end = cur.strstart + cur.match_length;
+        while (hashed < end &&
+               s->strstart + s->lookahead - hashed >= MIN_MATCH) {
+            HASH_STRING(s, s->ins_h, hashed);
+#ifndef FASTEST
+            s->prev[hashed & s->w_mask] = s->head[s->ins_h];
+#endif
+            s->head[s->ins_h] = (Pos)hashed;
+            hashed++;
+        }
+
+        /* Look up the following match, unless the lookahead may run out
+         * or the block may be flushed before it is used
+         */
+        if (s->lookahead >= cur.match_length + MIN_LOOKAHEAD &&
+            !LAST_SYMBOL(s)) {
+            medium_find(s, &next, end);
+            medium_fizzle(s, &cur, &next);
+        }
+
+        bflush = 0;
+        if (cur.match_length >= MIN_MATCH) {
+            check_match(s, cur.strstart, cur.match_start, cur.match_length);
+
+            _tr_tally_dist(s, cur.strstart - cur.match_start,
+                           cur.match_length - MIN_MATCH, bflush);
+        } else if (cur.match_length == 1) {
+            /* No match, output a literal byte */
+            Tracevv((stderr,"%c", s->window[cur.strstart]));
+            _tr_tally_lit(s, s->window[cur.strstart], bflush);
+        }
+        s->strstart += cur.match_length;
+        s->lookahead -= cur.match_length;
+        if (bflush) FLUSH_BLOCK(s, 0);
+    }
+    s->insert = s->strstart < MIN_MATCH-1 ? s->strstart : MIN_MATCH-1;
+    if (flush == Z_FINISH) {
+        FLUSH_BLOCK(s, 1);
+        return finish_done;
+    }
+    if (s->sym_next)
+        FLUSH_BLOCK(s, 0);
+    return block_done;
+}
+
+#ifndef FASTEST
+#define ULTRA_SHIFT 8
+/* deflate_ultra() keeps bit costs in 1/256 bit units */
+
+#define ULTRA_ITERATIONS 15
+/* Number of times each stretch of input is parsed */
+
+#ifdef LIT_MEM
+#  define SYMBOLS_LEFT(s) ((s)->sym_end - (s)->sym_next)
+#else
+#  define SYMBOLS_LEFT(s) (((s)->sym_end - (s)->sym_next) / 3)
+#endif
+/* Symbols the current block still has room for */
+
+/* ===========================================================================
+ * What deflate_ultra() takes each symbol to cost.
+ */
+typedef struct ultra_model_s {
+    ulg lit[L_CODES];       /* literal or length code, before extra bits */
+    ulg len[MAX_MATCH+1];   /* match length, with its extra bits */
+    ulg dist[D_CODES];      /* distance code, with its extra bits */
+} ultra_model;
+
+/* ===========================================================================
+ * The arrays deflate_ultra() uses, carved out of ultra_buf. Each is indexed
+ * by offset from strstart, except the match lists which run on from one
+ * position to the next.
+ */
+typedef struct ultra_work_s {
+    ulg  *price;        /* cost of the cheapest parse up to each position */
+    ushf *step_len;     /* its last step there: 1 for a literal, or a length */
+    ushf *step_dist;    /* and the distance of a match */
+    ushf *path_len;     /* steps of the parse kept, in order */
+    ushf *path_dist;
+    ushf *match_dist;   /* matches found, nearest first */
+    uchf *count;        /* number of matches found at each position */
+    uchf *match_len;    /* their lengths - MIN_MATCH, in ascending order */
+} ultra_work;
+
+local void ultra_work_init(deflate_state *s, ultra_work *w) {
+    ulg n = (ulg)s->lit_bufsize + 1;
+
+    w->price = (ulg *)s->ultra_buf;
+    w->step_len = (ushf *)(w->price + n);
+    w->step_dist = w->step_len + n;
+    w->path_len = w->step_dist + n;
+    w->path_dist = w->path_len + n;
+    w->match_dist = w->path_dist + n;
+    w->count = (uchf *)(w->match_dist + n * ULTRA_MATCHES);
+    w->match_len = w->count + n;
+}
+
+/* ===========================================================================
+ * Return 256 * log2(x) for x >= 1, taking the fraction one bit at a time by
+ * repeated squaring.
+ */
+local ulg ultra_log2(ulg x) {
+    ulg r = (ulg)15 << ULTRA_SHIFT;
+    int k;
+
+    /* Scale x to [2^15, 2^16) and count the scaling in r */
+    while (x >= 0x10000) x >>= 1, r += 1 << ULTRA_SHIFT;
+    while (x < 0x8000) x <<= 1, r -= 1 << ULTRA_SHIFT;
+    for (k = ULTRA_SHIFT - 1; k >= 0; k--) {
+        x = (x * x) >> 15;
+        if (x >= 0x10000) x >>= 1, r += (ulg)1 << k;
+    }
+    return r;
+}
+
+/* ===========================================================================
+ * Price each of the n symbols at its entropy under freq, within the 1 to
+ * MAX_BITS bits a Huffman code can give it. An unused symbol is priced as
+ * though it were used once.
+ */
+local void ultra_price(ulg *price, const ulg *freq, int n) {
+    ulg total = 0, top, bits;
+    int i;
+
+    for (i = 0; i < n; i++) total += freq[i];
+    top = ultra_log2(total ? total : 1);
+    for (i = 0; i < n; i++) {
+        bits = freq[i] ? ultra_log2(freq[i]) : 0;
+        bits = bits < top ? top - bits : 0;
+        if (bits < 1 << ULTRA_SHIFT) bits = 1 << ULTRA_SHIFT;
+        if (bits > MAX_BITS << ULTRA_SHIFT) bits = MAX_BITS << ULTRA_SHIFT;
+        price[i] = bits;
+    }
+}
+
+/* ===========================================================================
+ * Set m from literal/length and distance code counts, or to the fixed codes
+ * if lfreq is Z_NULL.
+ */
+local void ultra_model_set(ultra_model *m, const ulg *lfreq,
+                           const ulg *dfreq) {
+    int n, code;
+
+    if (lfreq == Z_NULL) {
+        for (n = 0; n < L_CODES; n++)
+            m->lit[n] = (ulg)(n < 144 ? 8 : n < 256 ? 9 : n < 280 ? 7 : 8) <<
+                        ULTRA_SHIFT;
+        for (n = 0; n < D_CODES; n++)
+            m->dist[n] = (ulg)5 << ULTRA_SHIFT;
+    } else {
+        ultra_price(m->lit, lfreq, L_CODES);
+        ultra_price(m->dist, dfreq, D_CODES);
+    }
+    for (n = 0; n < D_CODES; n++)
+        m->dist[n] += (ulg)(n < 4 ? 0 : (n - 2) >> 1) << ULTRA_SHIFT;
+    for (n = MIN_MATCH; n <= MAX_MATCH; n++) {
+        code = _length_code[n - MIN_MATCH];
+        m->len[n] = m->lit[code + LITERALS + 1] +
+                    ((ulg)(code < 8 || code == 28 ? 0 : (code - 4) >> 2) <<
+                     ULTRA_SHIFT);
+    }
+}
+
+/* ===========================================================================
+ * Length of the match between scan and match, which agree on their first
+ * MIN_MATCH bytes, up to max.
+ */
+local uInt ultra_match_len(deflate_state *s, Bytef *scan, Bytef *match,
+                           uInt max) {
+    uInt len = MIN_MATCH;
+
+    /* quick_match_len() reads up to MAX_MATCH + 1 bytes from scan */
+    if (scan + MIN_LOOKAHEAD <= s->window + s->window_size)
+        return quick_match_len(scan, match, max);
+    while (len < max && scan[len] == match[len]) len++;
+    return len;
+}
+
+/* ===========================================================================
+ * Insert the size strings from strstart in the hash table, and list for each
+ * the matches its hash chain gives that are longer than those before them
+ * on the chain, none running past size bytes. So for every length up to the
+ * longest, the first match listed that reaches it has the nearest distance
+ * that does. Past ULTRA_MATCHES, a longer match replaces the last one listed,
+ * and the lengths between them are left to the longer match's distance.
+ */
+local void ultra_find(deflate_state *s, ultra_work *w, uInt size) {
+    uInt i, n, best = 0, max, chain;
+    ulg m = 0;
+    IPos pos, cur, limit, hash_head;
+    Bytef *scan, *match;
+
+    for (i = 0; i < size; i++) {
+        w->count[i] = 0;
+        if (s->lookahead - i < MIN_MATCH) continue;
+
+        pos = s->strstart + i;
+        INSERT_STRING(s, pos, hash_head);
+        max = size - i < MAX_MATCH ? size - i : MAX_MATCH;
+        if (max < MIN_MATCH) continue;
+
+        limit = pos > (IPos)MAX_DIST(s) ? pos - (IPos)MAX_DIST(s) : NIL;
+        chain = s->max_chain_length;
+        if (best >= s->good_match) chain >>= 2;
+        scan = s->window + pos;
+        best = MIN_MATCH-1;
+        n = 0;
+        for (cur = hash_head; cur > limit;
+             cur = s->prev[cur & s->w_mask]) {
+            match = s->window + cur;
+            if (match[best] == scan[best] && match[0] == scan[0] &&
+                match[1] == scan[1] && !THIRD_DIFFERS(scan, match)) {
+                uInt got = ultra_match_len(s, scan, match, max);
+                if (got > best) {
+                    if (n == ULTRA_MATCHES) n--;
+                    w->match_len[m + n] = (uch)(got - MIN_MATCH);
+                    w->match_dist[m + n] = (ush)(pos - cur);
+                    n++;
+                    best = got;
+                    if (best >= max || best >= (uInt)s->nice_match) break;
+                }
+            }
+            if (--chain == 0) break;
+        }
+        w->count[i] = (uch)n;
+        m += n;
+    }
+}
+
+/* ===========================================================================
+ * Find the cheapest parse of the size bytes from strstart under model, as
+ * the last step into each position: a forward shortest path over the
+ * literal at each position and every length of its matches. Where the
+ * longest match runs to MAX_MATCH only that length is tried, which keeps
+ * long runs from costing MAX_MATCH steps per position.
+ */
+local void ultra_parse(deflate_state *s, ultra_work *w,
+                       const ultra_model *model, uInt size) {
+    Bytef *scan = s->window + s->strstart;
+    ulg *price = w->price;
+    ulg p, c, dp;
+    uInt i, k, n, l, top;
+    ulg m = 0;
+    ush d;
+
+    price[0] = 0;
+    for (i = 1; i <= size; i++) price[i] = ~(ulg)0;
+    for (i = 0; i < size; i++) {
+        p = price[i];
+        c = p + model->lit[scan[i]];
+        if (c < price[i + 1]) {
+            price[i + 1] = c;
+            w->step_len[i + 1] = 1;
+        }
+
+        n = w->count[i];
+        if (n == 0) continue;
+        k = 0;
+        l = MIN_MATCH;
+        if (w->match_len[m + n - 1] + MIN_MATCH == MAX_MATCH) {
+            k = n - 1;
+            l = MAX_MATCH;
+        }
+        for (; k < n; k++) {
+            d = w->match_dist[m + k];
+            dp = p + model->dist[d_code(d - 1)];
+            top = w->match_len[m + k] + MIN_MATCH;
+            for (; l <= top; l++) {
+                c = dp + model->len[l];
+                if (c < price[i + l]) {
+                    price[i + l] = c;
+                    w->step_len[i + l] = (ush)l;
+                    w->step_dist[i + l] = d;
+                }
+            }
+        }
+        m += n;
+    }
+}
+
+/* ===========================================================================
+ * Add the symbols of the parse ultra_parse() left to lfreq and dfreq, and
+ * return the number of steps in it.
+ */
+local uInt ultra_count(deflate_state *s, ultra_work *w, uInt size,
+                       ulg *lfreq, ulg *dfreq) {
+    Bytef *scan = s->window + s->strstart;
+    uInt i = size, l, steps = 0;
+
+    while (i > 0) {
+        l = w->step_len[i];
+        if (l == 1) {
+            lfreq[scan[i - 1]]++;
+        } else {
+            lfreq[_length_code[l - MIN_MATCH] + LITERALS + 1]++;
+            dfreq[d_code(w->step_dist[i] - 1)]++;
+        }
+        i -= l;
+        steps++;
+    }
+    return steps;
+}
+
+/* ===========================================================================
+ * Estimated bits for the symbol counts that set m, extra bits included.
+ */
+local ulg ultra_cost(const ultra_model *m, const ulg *lfreq,
+                     const ulg *dfreq) {
+    ulg cost = 0;
+    int n, code;
+
+    for (n = 0; n < L_CODES; n++) {
+        code = n - (LITERALS + 1);
+        cost += lfreq[n] * (m->lit[n] + ((ulg)(code < 8 || code == 28 ? 0 :
+                                         (code - 4) >> 2) << ULTRA_SHIFT));
+    }
+    for (n = 0; n < D_CODES; n++)
+        cost += dfreq[n] * m->dist[n];
+    return cost;
+}
+
+/* ===========================================================================
+ * For level 10, choose the literals and matches of each stretch of input by
+ * iterated optimal parsing, as zopfli does. The positions of a stretch are
+ * searched once, then it is parsed ULTRA_ITERATIONS times: first under the
+ * fixed codes, then each time under the entropy of the symbols the last
+ * parse chose together with those already in the block. The parse that
+ * would code smallest is kept, and blocks are sent by _tr_flush_block() as
+ * at other levels. A stretch is at most what the block has symbols left for,
+ * so it is never cut short by a flush.
+ */
+local block_state deflate_ultra(deflate_state *s, int flush) {
+    ultra_work w;
+    ultra_model model;
+    ulg lfreq[L_CODES], dfreq[D_CODES];
+    ulg cost, last_cost = 0, best_cost;
+    uInt size, steps, best_steps = 0, i, k, l;
+    int iter, n, bflush;
+
+    Assert(s->ultra_buf != Z_NULL, "no ultra_buf");
+    ultra_work_init(s, &w);
+    for (;;) {
+        /* Make sure that we always have enough lookahead, except
+         * at the end of the input file, as in deflate_slow().
+         */
+        if (s->lookahead < MIN_LOOKAHEAD) {
+            fill_window(s);
+            if (s->lookahead < MIN_LOOKAHEAD && flush == Z_NO_FLUSH) {
+                return need_more;
+            }
+            if (s->lookahead == 0) break; /* flush the current block */
+        }
+
+        /* Leave the lookahead the other deflate_*() need while more input
+         * may follow. Send a block with little room left rather than parse
+         * a short stretch into it.
+         */
+        size = s->lookahead;
+        if (flush == Z_NO_FLUSH || s->strm->avail_in != 0)
+            size -= MIN_LOOKAHEAD - 1;
+        if (size > SYMBOLS_LEFT(s)) {
+            if (SYMBOLS_LEFT(s) < s->lit_bufsize >> 4) {
+                FLUSH_BLOCK(s, 0);
+                continue;
+            }
+            size = SYMBOLS_LEFT(s);
+        }
+
+        ultra_find(s, &w, size);
+        ultra_model_set(&model, Z_NULL, Z_NULL);
+        best_cost = ~(ulg)0;
+        for (iter = 0; iter < ULTRA_ITERATIONS; iter++) {
+            ultra_parse(s, &w, &model, size);
+
+            /* Price the next parse by this one and the block so far */
+            for (n = 0; n < L_CODES; n++) lfreq[n] = s->dyn_ltree[n].Freq;
+            for (n = 0; n < D_CODES; n++) dfreq[n] = s->dyn_dtree[n].Freq;
+            steps = ultra_count(s, &w, size, lfreq, dfreq);
+            ultra_model_set(&model, lfreq, dfreq);
+            cost = ultra_cost(&model, lfreq, dfreq);
+
+            if (cost < best_cost) {
+                best_cost = cost;
+                best_steps = steps;
+                for (i = size, k = steps; i > 0; i -= w.step_len[i]) {
+                    k--;
+                    w.path_len[k] = w.step_len[i];
+                    w.path_dist[k] = w.step_dist[i];
+                }
+            }
+
+            /* Fixed codes are priced exactly the first time */
+            if (s->strategy == Z_FIXED || (iter > 0 && cost == last_cost))
+                break;
+            last_cost = cost;
+        }
+
+        bflush = 0;
+        for (k = 0; k < best_steps; k++) {
+            l = w.path_len[k];
+            if (l == 1) {
+                Tracevv((stderr,"%c", s->window[s->strstart]));
+                _tr_tally_lit(s, s->window[s->strstart], bflush);
+            } else {
+                check_match(s, s->strstart, s->strstart - w.path_dist[k], l);
+                _tr_tally_dist(s, w.path_dist[k], l - MIN_MATCH, bflush);
+            }
+            s->strstart += l;
+            s->lookahead -= l;
+        }
+        if (bflush) FLUSH_BLOCK(s, 0);
+    }
+    s->insert = s->strstart < MIN_MATCH-1 ? s->strstart : MIN_MATCH-1;
+    if (flush == Z_FINISH) {
+        FLUSH_BLOCK(s, 1);
+        return finish_done;
+    }
+    if (s->sym_next)
+        FLUSH_BLOCK(s, 0);
+    return block_done;
+}
+#endif /* FASTEST */
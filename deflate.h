@@ -27,6 +27,18 @@
    the cost of a larger memory footprint */
 /* #define LIT_MEM */
 
+/* define ZLIB_HASH_MUL to key the hash chains on a multiplicative hash of four
+   bytes instead of the rolling shift-xor hash of three. Chains are shorter
+   and spread better on binary data, at the cost of some length 3 matches */
+/* #define ZLIB_HASH_MUL */
+
+#ifdef ZLIB_HASH_MUL
+#  define WINDOW_PAD 1
+#else
+#  define WINDOW_PAD 0
+#endif
+/* bytes allocated past the end of the window, which the hash may read */
+
 /* ===========================================================================
  * Internal compression state.
  */
@@ -153,6 +165,7 @@ typedef struct internal_state {
      * step. It must be such that after MIN_MATCH steps, the oldest
      * byte no longer takes part in the hash key, that is:
      *   hash_shift * MIN_MATCH >= hash_bits
+     * Unused with ZLIB_HASH_MUL, which hashes each string afresh.
      */
 
     long block_start;
@@ -189,7 +202,7 @@ typedef struct internal_state {
      * max_insert_length is used only for compression levels <= 3.
      */
 
-    int level;    /* compression level (1..9) */
+    int level;    /* compression level (1..10) */
     int strategy; /* favor or force Huffman coding*/
 
     uInt good_match;
@@ -282,6 +295,15 @@ typedef struct internal_state {
      * updated to the new high water mark.
      */
 
+#define ULTRA_MATCHES 8
+#define ULTRA_BUFS (sizeof(ulg) + 9 + 3 * ULTRA_MATCHES)
+    uchf *ultra_buf;
+    /* Workspace for the optimal parse at level 10: lit_bufsize + 1 positions
+     * of ULTRA_BUFS bytes each, holding up to ULTRA_MATCHES matches found at
+     * every position and the cheapest path through them. Z_NULL at other
+     * levels.
+     */
+
 } FAR deflate_state;
 
 /* Output a byte on the stream.
@@ -321,9 +343,6 @@ void ZLIB_INTERNAL _tr_stored_block(deflate_state *s, charf *buf,
  * used.
  */
 
-#ifndef ZLIB_DEBUG
-/* Inline versions of _tr_tally for speed: */
-
 #if defined(GEN_TREES_H) || !defined(STDC)
   extern uch ZLIB_INTERNAL _length_code[];
   extern uch ZLIB_INTERNAL _dist_code[];
@@ -332,6 +351,9 @@ void ZLIB_INTERNAL _tr_stored_block(deflate_state *s, charf *buf,
   extern const uch ZLIB_INTERNAL _dist_code[];
 #endif
 
+#ifndef ZLIB_DEBUG
+/* Inline versions of _tr_tally for speed: */
+
 #ifdef LIT_MEM
 # define _tr_tally_lit(s, c, flush) \
   { uch cc = (c); \
@@ -155,12 +155,22 @@
    twice this must be able to fit in an unsigned type) */
 #define GZBUFSIZE 8192
 
+/* largest buffer size reading grows to when the application asks for large
+   amounts at a time, unless gzbuffer() chose the size */
+#define GZBUFMAX 131072
+
 /* gzip modes, also provide a little integrity check on the passed structure */
 #define GZ_NONE 0
 #define GZ_READ 7247
 #define GZ_WRITE 31153
 #define GZ_APPEND 1     /* mode set to GZ_WRITE after the file is opened */
 
+/* gz_state fd when reading from a caller's memory region (gzopen_mem) */
+#define GZ_MEM -3
+
+/* gz_state fd when I/O goes through the caller's functions (gzopen_io) */
+#define GZ_IO -4
+
 /* values for gz_state how */
 #define LOOK 0      /* look for a gzip header */
 #define COPY 1      /* copy input directly */
@@ -179,6 +189,7 @@ typedef struct {
     char *path;             /* path or fd for error messages */
     unsigned size;          /* buffer size, zero if not allocated yet */
     unsigned want;          /* requested buffer size, default is GZBUFSIZE */
+    int tuned;              /* true if gzbuffer() set want */
     unsigned char *in;      /* input buffer (double-sized when writing) */
     unsigned char *out;     /* output buffer (double-sized when reading) */
     int direct;             /* 0 if processing gzip, 1 if transparent */
@@ -187,6 +198,11 @@ typedef struct {
     z_off64_t start;        /* where the gzip data started, for rewinding */
     int eof;                /* true if end of input file reached */
     int past;               /* true if read requested past end */
+    const unsigned char *mem;   /* input region if fd is GZ_MEM */
+    z_size_t mem_len;       /* length of the input region */
+    z_size_t mem_pos;       /* offset of the next unread byte in mem */
+        /* used for both reading and writing */
+    gz_io io;               /* I/O functions if fd is GZ_IO */
         /* just for writing */
     int level;              /* compression level */
     int strategy;           /* compression strategy */
@@ -81,8 +81,27 @@ local void gz_reset(gz_statep state) {
     state->strm.avail_in = 0;       /* no input data yet */
 }
 
-/* Open a gzip file either by name or file descriptor. */
-local gzFile gz_open(const void *path, int fd, const char *mode) {
+/* Reposition the input like lseek(), including for input from memory or
+   through the caller's functions. */
+local z_off64_t gz_lseek(gz_statep state, z_off64_t offset, int whence) {
+    z_off64_t pos;
+
+    if (state->fd == GZ_IO)
+        return state->io.seek(state->io.opaque, offset, whence);
+    if (state->fd != GZ_MEM)
+        return LSEEK(state->fd, offset, whence);
+    pos = whence == SEEK_CUR ? (z_off64_t)state->mem_pos + offset : offset;
+    if (pos < 0)
+        return -1;
+    state->mem_pos = (z_size_t)pos > state->mem_len ? state->mem_len :
+                     (z_size_t)pos;
+    return pos;
+}
+
+/* Open a gzip file either by name or file descriptor, for reading memory if
+   fd is GZ_MEM, or for the caller's functions if fd is GZ_IO (io). */
+local gzFile gz_open(const void *path, int fd, const gz_io *io,
+                     const char *mode) {
     gz_statep state;
     z_size_t len;
     int oflag;
@@ -103,7 +122,13 @@ local gzFile gz_open(const void *path, int fd, const char *mode) {
         return NULL;
     state->size = 0;            /* no buffers allocated yet */
     state->want = GZBUFSIZE;    /* requested buffer size */
+    state->tuned = 0;           /* buffer size may grow with large reads */
     state->msg = NULL;          /* no error message yet */
+    state->mem = NULL;          /* no input region */
+    state->mem_len = 0;
+    state->mem_pos = 0;
+    if (fd == GZ_IO)
+        state->io = *io;        /* the caller's I/O functions */
 
     /* interpret mode */
     state->mode = GZ_NONE;
@@ -162,8 +187,12 @@ local gzFile gz_open(const void *path, int fd, const char *mode) {
         mode++;
     }
 
-    /* must provide an "r", "w", or "a" */
-    if (state->mode == GZ_NONE) {
+    /* must provide an "r", "w", or "a", and only "r" for memory, and the
+       functions that mode needs for caller I/O */
+    if (state->mode == GZ_NONE || (fd == GZ_MEM && state->mode != GZ_READ) ||
+            (fd == GZ_IO && (io->seek == NULL || io->close == NULL ||
+                             (state->mode == GZ_READ ? io->read == NULL :
+                                                       io->write == NULL)))) {
         free(state);
         return NULL;
     }
@@ -242,13 +271,13 @@ local gzFile gz_open(const void *path, int fd, const char *mode) {
         return NULL;
     }
     if (state->mode == GZ_APPEND) {
-        LSEEK(state->fd, 0, SEEK_END);  /* so gzoffset() is correct */
+        gz_lseek(state, 0, SEEK_END);   /* so gzoffset() is correct */
         state->mode = GZ_WRITE;         /* simplify later checks */
     }
 
     /* save the current position for rewinding (only if reading) */
     if (state->mode == GZ_READ) {
-        state->start = LSEEK(state->fd, 0, SEEK_CUR);
+        state->start = gz_lseek(state, 0, SEEK_CUR);
         if (state->start == -1) state->start = 0;
     }
 
@@ -261,12 +290,12 @@ local gzFile gz_open(const void *path, int fd, const char *mode) {
 
 /* -- see zlib.h -- */
 gzFile ZEXPORT gzopen(const char *path, const char *mode) {
-    return gz_open(path, -1, mode);
+    return gz_open(path, -1, NULL, mode);
 }
 
 /* -- see zlib.h -- */
 gzFile ZEXPORT gzopen64(const char *path, const char *mode) {
-    return gz_open(path, -1, mode);
+    return gz_open(path, -1, NULL, mode);
 }
 
 /* -- see zlib.h -- */
@@ -274,22 +303,44 @@ gzFile ZEXPORT gzdopen(int fd, const char *mode) {
     char *path;         /* identifier for error messages */
     gzFile gz;
 
-    if (fd == -1 || (path = (char *)malloc(7 + 3 * sizeof(int))) == NULL)
+    if (fd == -1 || fd == GZ_MEM || fd == GZ_IO ||
+            (path = (char *)malloc(7 + 3 * sizeof(int))) == NULL)
         return NULL;
 #if !defined(NO_snprintf) && !defined(NO_vsnprintf)
     (void)snprintf(path, 7 + 3 * sizeof(int), "<fd:%d>", fd);
 #else
     sprintf(path, "<fd:%d>", fd);   /* for debugging */
 #endif
-    gz = gz_open(path, fd, mode);
+    gz = gz_open(path, fd, NULL, mode);
     free(path);
     return gz;
 }
 
+/* -- see zlib.h -- */
+gzFile ZEXPORT gzopen_mem(const void *buf, z_size_t len, const char *mode) {
+    gz_statep state;
+
+    if (buf == NULL && len)
+        return NULL;
+    state = (gz_statep)gz_open("<memory>", GZ_MEM, NULL, mode);
+    if (state == NULL)
+        return NULL;
+    state->mem = (const unsigned char *)buf;
+    state->mem_len = len;
+    return (gzFile)state;
+}
+
+/* -- see zlib.h -- */
+gzFile ZEXPORT gzopen_io(const gz_io *io, const char *mode) {
+    if (io == NULL)
+        return NULL;
+    return gz_open("<io>", GZ_IO, io, mode);
+}
+
 /* -- see zlib.h -- */
 #ifdef WIDECHAR
 gzFile ZEXPORT gzopen_w(const wchar_t *path, const char *mode) {
-    return gz_open(path, -2, mode);
+    return gz_open(path, -2, NULL, mode);
 }
 #endif
 
@@ -314,6 +365,7 @@ int ZEXPORT gzbuffer(gzFile file, unsigned size) {
     if (size < 8)
         size = 8;               /* needed to behave well with flushing */
     state->want = size;
+    state->tuned = 1;
     return 0;
 }
 
@@ -332,7 +384,7 @@ int ZEXPORT gzrewind(gzFile file) {
         return -1;
 
     /* back up and start over */
-    if (LSEEK(state->fd, state->start, SEEK_SET) == -1)
+    if (gz_lseek(state, state->start, SEEK_SET) == -1)
         return -1;
     gz_reset(state);
     return 0;
@@ -369,7 +421,7 @@ z_off64_t ZEXPORT gzseek64(gzFile file, z_off64_t offset, int whence) {
     /* if within raw area while reading, just go there */
     if (state->mode == GZ_READ && state->how == COPY &&
             state->x.pos + offset >= 0) {
-        ret = LSEEK(state->fd, offset - (z_off64_t)state->x.have, SEEK_CUR);
+        ret = gz_lseek(state, offset - (z_off64_t)state->x.have, SEEK_CUR);
         if (ret == -1)
             return -1;
         state->x.have = 0;
@@ -455,7 +507,7 @@ z_off64_t ZEXPORT gzoffset64(gzFile file) {
         return -1;
 
     /* compute and return effective offset in file */
-    offset = LSEEK(state->fd, 0, SEEK_CUR);
+    offset = gz_lseek(state, 0, SEEK_CUR);
     if (offset == -1)
         return -1;
     if (state->mode == GZ_READ)             /* reading */
@@ -8,18 +8,32 @@
 /* Use read() to load a buffer -- return -1 on error, otherwise 0.  Read from
    state->fd, and update state->eof, state->err, and state->msg as appropriate.
    This function needs to loop on read(), since read() is not guaranteed to
-   read the number of bytes requested, depending on the type of descriptor. */
+   read the number of bytes requested, depending on the type of descriptor.
+   Input from memory is copied from the region instead, and gzopen_io() input
+   comes from the caller's read function. */
 local int gz_load(gz_statep state, unsigned char *buf, unsigned len,
                   unsigned *have) {
     int ret;
     unsigned get, max = ((unsigned)-1 >> 2) + 1;
 
     *have = 0;
+    if (state->fd == GZ_MEM) {
+        if ((z_size_t)len > state->mem_len - state->mem_pos)
+            len = (unsigned)(state->mem_len - state->mem_pos);
+        memcpy(buf, state->mem + state->mem_pos, len);
+        state->mem_pos += len;
+        *have = len;
+        if (state->mem_pos == state->mem_len)
+            state->eof = 1;
+        return 0;
+    }
     do {
         get = len - *have;
         if (get > max)
             get = max;
-        ret = read(state->fd, buf + *have, get);
+        ret = state->fd == GZ_IO ?
+              state->io.read(state->io.opaque, buf + *have, get) :
+              read(state->fd, buf + *have, get);
         if (ret <= 0)
             break;
         *have += (unsigned)ret;
@@ -39,14 +53,28 @@ local int gz_load(gz_statep state, unsigned char *buf, unsigned len,
    that data has been used, no more attempts will be made to read the file.
    If strm->avail_in != 0, then the current data is moved to the beginning of
    the input buffer, and then the remainder of the buffer is loaded with the
-   available data from the input file. */
+   available data from the input file.  Input from memory is not copied: the
+   rest of the region, up to what avail_in can count, is added to the input
+   in place, which follows on from any current input since it was taken from
+   the region the same way. */
 local int gz_avail(gz_statep state) {
     unsigned got;
     z_streamp strm = &(state->strm);
 
     if (state->err != Z_OK && state->err != Z_BUF_ERROR)
         return -1;
-    if (state->eof == 0) {
+    if (state->eof == 0 && state->fd == GZ_MEM) {
+        got = (unsigned)-1 - strm->avail_in;
+        if ((z_size_t)got > state->mem_len - state->mem_pos)
+            got = (unsigned)(state->mem_len - state->mem_pos);
+        if (strm->avail_in == 0)
+            strm->next_in = (z_const Bytef *)(state->mem + state->mem_pos);
+        strm->avail_in += got;
+        state->mem_pos += got;
+        if (state->mem_pos == state->mem_len)
+            state->eof = 1;
+    }
+    else if (state->eof == 0) {
         if (strm->avail_in) {       /* copy what's there to the start */
             unsigned char *p = state->in;
             unsigned const char *q = strm->next_in;
@@ -78,10 +106,11 @@ local int gz_look(gz_statep state) {
 
     /* allocate read buffers and inflate memory */
     if (state->size == 0) {
-        /* allocate buffers */
-        state->in = (unsigned char *)malloc(state->want);
+        /* allocate buffers (no input buffer when reading from memory) */
+        state->in = state->fd == GZ_MEM ? NULL :
+                    (unsigned char *)malloc(state->want);
         state->out = (unsigned char *)malloc(state->want << 1);
-        if (state->in == NULL || state->out == NULL) {
+        if ((state->in == NULL && state->fd != GZ_MEM) || state->out == NULL) {
             free(state->out);
             free(state->in);
             gz_error(state, Z_MEM_ERROR, "out of memory");
@@ -138,10 +167,18 @@ local int gz_look(gz_statep state) {
 
     /* doing raw i/o, copy any leftover input to output -- this assumes that
        the output buffer is larger than the input buffer, which also assures
-       space for gzungetc() */
+       space for gzungetc() -- except from memory, where the input may be the
+       whole region, so it is handed back to be copied from there instead */
     state->x.next = state->out;
-    memcpy(state->x.next, strm->next_in, strm->avail_in);
-    state->x.have = strm->avail_in;
+    if (state->fd == GZ_MEM) {
+        state->mem_pos -= strm->avail_in;
+        state->eof = 0;
+        state->x.have = 0;
+    }
+    else {
+        memcpy(state->x.next, strm->next_in, strm->avail_in);
+        state->x.have = strm->avail_in;
+    }
     strm->avail_in = 0;
     state->how = COPY;
     state->direct = 1;
@@ -261,6 +298,40 @@ local int gz_skip(gz_statep state, z_off64_t len) {
     return 0;
 }
 
+/* Grow the read buffers, up to GZBUFMAX, to half of a large request len so
+   that each direct decompression into the application's buffer needs fewer
+   reads of the input. Not done if gzbuffer() set the size, if there is
+   output pending, or for input from memory, which is never buffered. If the new buffers can't be allocated, the current ones
+   are kept. */
+local void gz_grow(gz_statep state, z_size_t len) {
+    unsigned size;
+    unsigned char *in, *out;
+
+    if (state->tuned || state->x.have || state->fd == GZ_MEM)
+        return;
+    size = state->size;
+    while (size < GZBUFMAX && ((z_size_t)size << 1) <= len)
+        size <<= 1;
+    if (size == state->size)
+        return;
+
+    in = (unsigned char *)malloc(size);
+    out = (unsigned char *)malloc(size << 1);
+    if (in == NULL || out == NULL) {
+        free(out);
+        free(in);
+        return;
+    }
+    if (state->strm.avail_in)
+        memcpy(in, state->strm.next_in, state->strm.avail_in);
+    state->strm.next_in = in;
+    free(state->out);
+    free(state->in);
+    state->in = in;
+    state->out = out;
+    state->size = size;
+}
+
 /* Read len bytes into buf from file, or less than len up to the end of the
    input.  Return the number of bytes read.  If zero is returned, either the
    end of file was reached, or there was an error.  state->err must be
@@ -303,9 +374,17 @@ local z_size_t gz_read(gz_statep state, voidp buf, z_size_t len) {
             break;
         }
 
+        /* new stream and large len -- just process the header, so that the
+           data itself can go directly to the user buffer below */
+        else if (state->how == LOOK && n >= state->want) {
+            if (gz_look(state) == -1)
+                return 0;
+            continue;
+        }
+
         /* need output data -- for small len or new stream load up our output
            buffer */
-        else if (state->how == LOOK || n < (state->size << 1)) {
+        else if (state->how == LOOK || n < state->size) {
             /* get more output, looking for header if required */
             if (gz_fetch(state) == -1)
                 return 0;
@@ -322,6 +401,7 @@ local z_size_t gz_read(gz_statep state, voidp buf, z_size_t len) {
 
         /* large len -- decompress directly into user buffer */
         else {  /* state->how == GZIP */
+            gz_grow(state, n);
             state->strm.avail_out = n;
             state->strm.next_out = (unsigned char *)buf;
             if (gz_decomp(state) == -1)
@@ -597,7 +677,9 @@ int ZEXPORT gzclose_r(gzFile file) {
     err = state->err == Z_BUF_ERROR ? Z_BUF_ERROR : Z_OK;
     gz_error(state, Z_OK, NULL);
     free(state->path);
-    ret = close(state->fd);
+    ret = state->fd == GZ_MEM ? 0 :
+          state->fd == GZ_IO ? state->io.close(state->io.opaque) :
+          close(state->fd);
     free(state);
     return ret ? Z_ERRNO : err;
 }
@@ -56,6 +56,14 @@ local int gz_init(gz_statep state) {
     return 0;
 }
 
+/* Write len bytes from buf to the output file, with write() or through the
+   caller's functions.  Return what write() would. */
+local int gz_put(gz_statep state, const unsigned char *buf, unsigned len) {
+    if (state->fd == GZ_IO)
+        return state->io.write(state->io.opaque, buf, len);
+    return (int)write(state->fd, buf, len);
+}
+
 /* Compress whatever is at avail_in and next_in and write to the output file.
    Return -1 if there is an error writing to the output file or if gz_init()
    fails to allocate memory, otherwise 0.  flush is assumed to be a valid
@@ -75,7 +83,7 @@ local int gz_comp(gz_statep state, int flush) {
     if (state->direct) {
         while (strm->avail_in) {
             put = strm->avail_in > max ? max : strm->avail_in;
-            writ = write(state->fd, strm->next_in, put);
+            writ = gz_put(state, strm->next_in, put);
             if (writ < 0) {
                 gz_error(state, Z_ERRNO, zstrerror());
                 return -1;
@@ -105,7 +113,7 @@ local int gz_comp(gz_statep state, int flush) {
             while (strm->next_out > state->x.next) {
                 put = strm->next_out - state->x.next > (int)max ? max :
                       (unsigned)(strm->next_out - state->x.next);
-                writ = write(state->fd, state->x.next, put);
+                writ = gz_put(state, state->x.next, put);
                 if (writ < 0) {
                     gz_error(state, Z_ERRNO, zstrerror());
                     return -1;
@@ -624,7 +632,8 @@ int ZEXPORT gzclose_w(gzFile file) {
     }
     gz_error(state, Z_OK, NULL);
     free(state->path);
-    if (close(state->fd) == -1)
+    if ((state->fd == GZ_IO ? state->io.close(state->io.opaque) :
+                              close(state->fd)) == -1)
         ret = Z_ERRNO;
     free(state);
     return ret;
@@ -8,6 +8,10 @@
 #include "inflate.h"
 #include "inffast.h"
 
+#ifdef __wasm_simd128__
+#  include "src/zlib_simd.h"
+#endif
+
 #ifdef ASMINF
 #  pragma message("Assembler code may have bugs -- use at your own risk")
 #else
@@ -28,6 +32,9 @@
         start >= strm->avail_out
         state->bits < 8
 
+   (INFLATE_FAST_MIN_INPUT and INFLATE_FAST_MIN_OUTPUT in inffast.h give the
+   avail_in and avail_out minimums.)
+
    On return, state->mode is one of:
 
         LEN -- ran out of enough output space or enough available input
@@ -46,7 +53,24 @@
       bytes, which is the maximum length that can be coded.  inflate_fast()
       requires strm->avail_out >= 258 for each loop to avoid checking for
       output space.
+
+    - Where Z_U8 is available the bit accumulator is 64 bits, refilled to at
+      least 56 bits at the top of each loop by one eight-byte load, so the
+      refills after that never run.  The loop then needs eight bytes of input.
+
+    - For a dynamic literal/length table, the first lookup is in the wider
+      literal pair table (see inflate_pairs()), which decodes two short
+      literals at once and otherwise repeats the root table.
  */
+#ifdef Z_U8
+/* The eight bytes at p as a little-endian value */
+local Z_U8 load64(z_const unsigned char FAR *p) {
+    return (Z_U8)p[0] | (Z_U8)p[1] << 8 | (Z_U8)p[2] << 16 |
+           (Z_U8)p[3] << 24 | (Z_U8)p[4] << 32 | (Z_U8)p[5] << 40 |
+           (Z_U8)p[6] << 48 | (Z_U8)p[7] << 56;
+}
+#endif
+
 void ZLIB_INTERNAL inflate_fast(z_streamp strm, unsigned start) {
     struct inflate_state FAR *state;
     z_const unsigned char FAR *in;      /* local strm->next_in */
@@ -61,23 +85,30 @@ void ZLIB_INTERNAL inflate_fast(z_streamp strm, unsigned start) {
     unsigned whave;             /* valid bytes in the window */
     unsigned wnext;             /* window write index */
     unsigned char FAR *window;  /* allocated sliding window, if wsize != 0 */
+#ifdef Z_U8
+    Z_U8 hold;                  /* local strm->hold */
+#else
     unsigned long hold;         /* local strm->hold */
+#endif
     unsigned bits;              /* local strm->bits */
     code const FAR *lcode;      /* local strm->lencode */
     code const FAR *dcode;      /* local strm->distcode */
+    code const FAR *fcode;      /* table for the first length code lookup */
     unsigned lmask;             /* mask for first level of length codes */
     unsigned dmask;             /* mask for first level of distance codes */
+    unsigned fmask;             /* mask for fcode */
     code const *here;           /* retrieved table entry */
     unsigned op;                /* code bits, operation, extra bits, or */
                                 /*  window position, window bytes to copy */
     unsigned len;               /* match length, unused bytes */
     unsigned dist;              /* match distance */
     unsigned char FAR *from;    /* where to copy match from */
+    ZSTATS_BEGIN(ZSTATS_INFLATE_FAST);
 
     /* copy state to local variables */
     state = (struct inflate_state FAR *)strm->state;
     in = strm->next_in;
-    last = in + (strm->avail_in - 5);
+    last = in + (strm->avail_in - (INFLATE_FAST_MIN_INPUT - 1));
     out = strm->next_out;
     beg = out - (start - strm->avail_out);
     end = out + (strm->avail_out - 257);
@@ -94,17 +125,40 @@ void ZLIB_INTERNAL inflate_fast(z_streamp strm, unsigned start) {
     dcode = state->distcode;
     lmask = (1U << state->lenbits) - 1;
     dmask = (1U << state->distbits) - 1;
+    fcode = lcode;
+    fmask = lmask;
+#ifndef INFLATE_NO_PAIRS
+    if (lcode == state->codes) {        /* dynamic, so pairs were built */
+        fcode = state->pairs;
+        fmask = (1U << PAIRBITS) - 1;
+    }
+#endif
 
     /* decode literals and length/distances until end-of-block or not enough
        input data or output space */
     do {
+#ifdef Z_U8
+        hold |= load64(in) << bits;
+        in += (63 - bits) >> 3;
+        bits |= 56;
+#else
         if (bits < 15) {
             hold += (unsigned long)(*in++) << bits;
             bits += 8;
             hold += (unsigned long)(*in++) << bits;
             bits += 8;
         }
-        here = lcode + (hold & lmask);
+#endif
+        here = fcode + (hold & fmask);
+        if (here->op == 128) {                  /* two literals */
+            Tracevv((stderr, "inflate:         literals 0x%02x 0x%02x\n",
+                    here->val & 0xff, here->val >> 8));
+            hold >>= here->bits;
+            bits -= here->bits;
+            *out++ = (unsigned char)(here->val);
+            *out++ = (unsigned char)(here->val >> 8);
+            continue;
+        }
       dolen:
         op = (unsigned)(here->bits);
         hold >>= op;
@@ -247,6 +301,12 @@ void ZLIB_INTERNAL inflate_fast(z_streamp strm, unsigned start) {
                 }
                 else {
                     from = out - dist;          /* copy direct from output */
+#ifdef __wasm_simd128__
+                    /* 16-byte chunks for dist >= 16, pattern splat for
+                       shorter distances */
+                    zlib_chunkmemset_simd(out, from, dist, len);
+                    out += len;
+#else
                     do {                        /* minimum length is three */
                         *out++ = *from++;
                         *out++ = *from++;
@@ -258,6 +318,7 @@ void ZLIB_INTERNAL inflate_fast(z_streamp strm, unsigned start) {
                         if (len > 1)
                             *out++ = *from++;
                     }
+#endif
                 }
             }
             else if ((op & 64) == 0) {          /* 2nd level distance code */
@@ -293,9 +354,12 @@ void ZLIB_INTERNAL inflate_fast(z_streamp strm, unsigned start) {
     hold &= (1U << bits) - 1;
 
     /* update state and return */
+    ZSTATS_END(ZSTATS_INFLATE_FAST, out - strm->next_out);
     strm->next_in = in;
     strm->next_out = out;
-    strm->avail_in = (unsigned)(in < last ? 5 + (last - in) : 5 - (in - last));
+    strm->avail_in = (unsigned)(in < last ?
+                                (INFLATE_FAST_MIN_INPUT - 1) + (last - in) :
+                                (INFLATE_FAST_MIN_INPUT - 1) - (in - last));
     strm->avail_out = (unsigned)(out < end ?
                                  257 + (end - out) : 257 - (out - end));
     state->hold = hold;
@@ -8,4 +8,14 @@
    subject to change. Applications should only use zlib.h.
  */
 
+/* Input and output inflate_fast() must have available on entry.  With a
+   64-bit bit accumulator it refills eight bytes at a time, so it needs two
+   more bytes of input than the 48 bits of a length/distance pair. */
+#ifdef Z_U8
+#  define INFLATE_FAST_MIN_INPUT 8
+#else
+#  define INFLATE_FAST_MIN_INPUT 6
+#endif
+#define INFLATE_FAST_MIN_OUTPUT 258
+
 void ZLIB_INTERNAL inflate_fast(z_streamp strm, unsigned start);
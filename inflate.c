@@ -206,6 +206,7 @@ int ZEXPORT inflateInit2_(z_streamp strm, int windowBits,
     strm->state = (struct internal_state FAR *)state;
     state->strm = strm;
     state->window = Z_NULL;
+    state->keep_nlen = 0;   /* no dynamic tables in codes[] yet */
     state->mode = HEAD;     /* to pass state test in inflateReset2() */
     ret = inflateReset2(strm, windowBits);
     if (ret != Z_OK) {
@@ -351,6 +352,43 @@ void makefixed(void)
 }
 #endif /* MAKEFIXED */
 
+/*
+   Point the decoding tables at the ones left in codes[] by an earlier dynamic
+   block, of this stream or of one before the last reset, if that block had
+   the same code lengths as in lens[] now, and return true.  Producers of many
+   short streams with the same data tend to send the same trees every time,
+   which inflate_table() and inflate_pairs() then need not build again.
+   Otherwise forget those tables, which are about to be overwritten.
+ */
+local int reuse_tables(struct inflate_state FAR *state) {
+    if (state->keep_nlen == state->nlen && state->keep_ndist == state->ndist &&
+        zmemcmp((Bytef *)state->keep_lens, (Bytef *)state->lens,
+                (state->nlen + state->ndist) * sizeof(unsigned short)) == 0) {
+        state->lencode = (const code FAR *)state->codes;
+        state->lenbits = state->keep_lenbits;
+        state->distcode = (const code FAR *)(state->codes + state->keep_dist);
+        state->distbits = state->keep_distbits;
+        state->next = state->codes + state->keep_next;
+        return 1;
+    }
+    state->keep_nlen = 0;
+    return 0;
+}
+
+/*
+   Remember the code lengths the dynamic tables just built in codes[] are for.
+ */
+local void keep_tables(struct inflate_state FAR *state) {
+    zmemcpy((Bytef *)state->keep_lens, (Bytef *)state->lens,
+            (state->nlen + state->ndist) * sizeof(unsigned short));
+    state->keep_nlen = state->nlen;
+    state->keep_ndist = state->ndist;
+    state->keep_lenbits = state->lenbits;
+    state->keep_distbits = state->distbits;
+    state->keep_dist = (unsigned)(state->distcode - state->codes);
+    state->keep_next = (unsigned)(state->next - state->codes);
+}
+
 /*
    Update the window with the last wsize (normally 32K) bytes written before
    returning.  If window does not exist yet, create it.  This is only called
@@ -922,7 +960,7 @@ int ZEXPORT inflate(z_streamp strm, int flush) {
             }
             while (state->have < 19)
                 state->lens[order[state->have++]] = 0;
-            state->next = state->codes;
+            state->next = state->codes + ENOUGH;
             state->lencode = state->distcode = (const code FAR *)(state->next);
             state->lenbits = 7;
             ret = inflate_table(CODES, state->lens, 19, &(state->next),
@@ -994,6 +1032,14 @@ int ZEXPORT inflate(z_streamp strm, int flush) {
                 break;
             }
 
+            /* the tables left in codes[] may be for these very lengths */
+            if (reuse_tables(state)) {
+                Tracev((stderr, "inflate:       codes reused\n"));
+                state->mode = LEN_;
+                if (flush == Z_TREES) goto inf_leave;
+                break;
+            }
+
             /* build code tables -- note: do not change the lenbits or distbits
                values here (9 and 6) without reading the comments in inftrees.h
                concerning the ENOUGH constants, which depend on those values */
@@ -1007,6 +1053,9 @@ int ZEXPORT inflate(z_streamp strm, int flush) {
                 state->mode = BAD;
                 break;
             }
+#ifndef INFLATE_NO_PAIRS
+            inflate_pairs(state->pairs, state->lencode, state->lenbits);
+#endif
             state->distcode = (const code FAR *)(state->next);
             state->distbits = 6;
             ret = inflate_table(DISTS, state->lens + state->nlen, state->ndist,
@@ -1016,6 +1065,7 @@ int ZEXPORT inflate(z_streamp strm, int flush) {
                 state->mode = BAD;
                 break;
             }
+            keep_tables(state);
             Tracev((stderr, "inflate:       codes ok\n"));
             state->mode = LEN_;
             if (flush == Z_TREES) goto inf_leave;
@@ -1024,7 +1074,8 @@ int ZEXPORT inflate(z_streamp strm, int flush) {
             state->mode = LEN;
                 /* fallthrough */
         case LEN:
-            if (have >= 6 && left >= 258) {
+            if (have >= INFLATE_FAST_MIN_INPUT &&
+                left >= INFLATE_FAST_MIN_OUTPUT) {
                 RESTORE();
                 inflate_fast(strm, out);
                 LOAD();
@@ -1466,7 +1517,7 @@ int ZEXPORT inflateCopy(z_streamp dest, z_streamp source) {
     zmemcpy((voidpf)copy, (voidpf)state, sizeof(struct inflate_state));
     copy->strm = dest;
     if (state->lencode >= state->codes &&
-        state->lencode <= state->codes + ENOUGH - 1) {
+        state->lencode <= state->codes + ENOUGH + ENOUGH_CODES - 1) {
         copy->lencode = copy->codes + (state->lencode - state->codes);
         copy->distcode = copy->codes + (state->distcode - state->codes);
     }
@@ -77,8 +77,9 @@ typedef enum {
         CHECK -> LENGTH -> DONE
  */
 
-/* State maintained between inflate() calls -- approximately 7K bytes, not
-   including the allocated sliding window, which is up to 32K bytes. */
+/* State maintained between inflate() calls -- approximately 16K bytes, or 8K
+   with INFLATE_NO_PAIRS, not including the allocated sliding window, which is
+   up to 32K bytes. */
 struct inflate_state {
     z_streamp strm;             /* pointer back to this zlib stream */
     inflate_mode mode;          /* current inflate mode */
@@ -119,7 +120,18 @@ struct inflate_state {
     code FAR *next;             /* next available space in codes[] */
     unsigned short lens[320];   /* temporary storage for code lengths */
     unsigned short work[288];   /* work area for code table building */
-    code codes[ENOUGH];         /* space for code tables */
+    code codes[ENOUGH + ENOUGH_CODES]; /* space for code tables */
+        /* dynamic tables left in codes[] for a later block to reuse */
+    unsigned keep_nlen;         /* nlen they were built for, 0 if none */
+    unsigned keep_ndist;        /* ndist they were built for */
+    unsigned keep_lenbits;      /* lenbits they were built with */
+    unsigned keep_distbits;     /* distbits they were built with */
+    unsigned keep_dist;         /* offset of the distance table in codes[] */
+    unsigned keep_next;         /* offset past the tables in codes[] */
+    unsigned short keep_lens[320]; /* code lengths they were built from */
+#ifndef INFLATE_NO_PAIRS
+    code pairs[1U << PAIRBITS]; /* lencode with literal pairs, when dynamic */
+#endif
     int sane;                   /* if false, allow invalid distance too far */
     int back;                   /* bits back of last unprocessed length/lit */
     unsigned was;               /* initial length of match */
@@ -66,6 +66,7 @@ int ZLIB_INTERNAL inflate_table(codetype type, unsigned short FAR *lens,
         16, 16, 16, 16, 17, 17, 18, 18, 19, 19, 20, 20, 21, 21, 22, 22,
         23, 23, 24, 24, 25, 25, 26, 26, 27, 27,
         28, 28, 29, 29, 64, 64};
+    ZSTATS_BEGIN(ZSTATS_INFLATE_TABLE);
 
     /*
        Process a set of code lengths to create a canonical Huffman code.  The
@@ -116,6 +117,7 @@ int ZLIB_INTERNAL inflate_table(codetype type, unsigned short FAR *lens,
         *(*table)++ = here;             /* make a table to force an error */
         *(*table)++ = here;
         *bits = 1;
+        ZSTATS_END(ZSTATS_INFLATE_TABLE, codes);
         return 0;     /* no symbols, but wait for decoding to report error */
     }
     for (min = 1; min < max; min++)
@@ -295,5 +297,39 @@ int ZLIB_INTERNAL inflate_table(codetype type, unsigned short FAR *lens,
     /* set return parameters */
     *table += used;
     *bits = root;
+    ZSTATS_END(ZSTATS_INFLATE_TABLE, codes);
     return 0;
 }
+
+#ifndef INFLATE_NO_PAIRS
+/*
+   Build the literal pair table for the dynamic literal/length table lencode
+   with root bits lenbits (at most PAIRBITS).  Entry i is the root entry for
+   the low bits of i, except where that is a literal whose code leaves room in
+   PAIRBITS for the whole code of a second literal: the entry then has op 128,
+   the bits of both codes, and both literals in val.  Root entries of codes
+   shorter than the root are replicated, so the second code is found from the
+   remaining bits of i whatever the bits above them.
+ */
+void ZLIB_INTERNAL inflate_pairs(code FAR *pairs, code const FAR *lencode,
+                                 unsigned lenbits) {
+    unsigned i;                 /* pair table index */
+    unsigned mask;              /* mask for a root table index */
+    code here;                  /* first code */
+    code next;                  /* code after it */
+
+    mask = (1U << lenbits) - 1;
+    for (i = 0; i < 1U << PAIRBITS; i++) {
+        here = lencode[i & mask];
+        if (here.op == 0) {
+            next = lencode[(i >> here.bits) & mask];
+            if (next.op == 0 && here.bits + next.bits <= PAIRBITS) {
+                here.op = 128;
+                here.bits += next.bits;
+                here.val = (unsigned short)(here.val + (next.val << 8));
+            }
+        }
+        pairs[i] = here;
+    }
+}
+#endif
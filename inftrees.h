@@ -33,6 +33,8 @@ typedef struct {
     0001eeee - length or distance, eeee is the number of extra bits
     01100000 - end of block
     01000000 - invalid code
+   and by inflate_pairs():
+    10000000 - two literals, val is the first plus the second times 256
  */
 
 /* Maximum size of the dynamic table.  The maximum number of code structures is
@@ -50,6 +52,12 @@ typedef struct {
 #define ENOUGH_DISTS 592
 #define ENOUGH (ENOUGH_LENS+ENOUGH_DISTS)
 
+/* Size of the code length code table, whose lengths of at most 7 bits fit in
+   its 7-bit root table.  inflate() builds it after the ENOUGH entries of the
+   other two, so that a dynamic block's tables stay intact while the next
+   block's header is read, for that block to reuse if its lengths match. */
+#define ENOUGH_CODES 128
+
 /* Type of code to build for inflate_table() */
 typedef enum {
     CODES,
@@ -60,3 +68,14 @@ typedef enum {
 int ZLIB_INTERNAL inflate_table(codetype type, unsigned short FAR *lens,
                                 unsigned codes, code FAR * FAR *table,
                                 unsigned FAR *bits, unsigned short FAR *work);
+
+/* Index bits of the table inflate_pairs() builds from a dynamic literal/length
+   table for inflate_fast(), which then decodes two literals whose codes fit
+   in PAIRBITS bits with one lookup.  Define INFLATE_NO_PAIRS to leave the
+   table out of struct inflate_state, which it grows by 8K bytes. */
+#define PAIRBITS 11
+
+#ifndef INFLATE_NO_PAIRS
+void ZLIB_INTERNAL inflate_pairs(code FAR *pairs, code const FAR *lencode,
+                                 unsigned lenbits);
+#endif
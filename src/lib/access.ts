@@ -0,0 +1,178 @@
+/**
+ * zlib.wasm random access
+ * Access-point index over zlib/gzip/raw deflate streams (examples/zran.c)
+ */
+
+import { ZlibCompressionError, ZlibMemoryError } from './types.ts'
+import type { ZlibIndexSource, ZlibModule } from './types.ts'
+import type { HeapBufferPool } from './heap.ts'
+
+// zlib return codes used by the index exports
+const Z_OK = 0
+const Z_STREAM_END = 1
+
+// Compressed bytes read from the source per call
+export const DEFAULT_READ_SIZE = 256 * 1024
+
+// A ZlibIndexSource read, as a view of length bytes at most
+export async function readSource(source: ZlibIndexSource, position: number, length: number): Promise<Uint8Array> {
+  if (source instanceof Uint8Array) return source.subarray(position, position + length)
+  return (await source(position, length)).subarray(0, length)
+}
+
+/**
+ * Access points into one compressed stream, with the 32 KB window before
+ * each held raw-deflated on the WASM heap. The compressed data itself
+ * stays with the caller and is read through a ZlibIndexSource, so only
+ * about span bytes are inflated per extract() however large the archive.
+ */
+export class ZlibIndex {
+  constructor(
+    private readonly module: ZlibModule,
+    private readonly pool: HeapBufferPool,
+    private ptr: number,
+    private readonly readSize = DEFAULT_READ_SIZE
+  ) {}
+
+  /** Number of access points */
+  get points(): number {
+    return this.module._zlib_index_points(this.ptr)
+  }
+
+  /** Uncompressed length of the indexed stream */
+  get length(): number {
+    return this.module._zlib_index_length(this.ptr)
+  }
+
+  /**
+   * Read length bytes from uncompressed offset. source must be the stream
+   * the index was built from; fewer bytes come back past the end.
+   */
+  async extract(source: ZlibIndexSource, offset: number, length: number): Promise<Uint8Array> {
+    this.checkOpen()
+    length = Math.max(0, Math.min(length, this.length - offset))
+    if (length === 0 || offset < 0) return new Uint8Array(0)
+
+    let position = this.module._zlib_index_extract_begin(this.ptr, offset, length)
+    if (position < 0) {
+      throw new ZlibCompressionError(`Index extraction failed with code: ${position}`)
+    }
+
+    const output = this.pool.acquire(length)
+    const input = this.pool.acquire(this.readSize)
+
+    try {
+      let status = Z_OK
+      let got = 0
+      while (status === Z_OK) {
+        const chunk = await readSource(source, position, this.readSize)
+        if (chunk.length === 0) break
+        position += chunk.length
+
+        input.write(chunk)
+        status = this.module._zlib_index_extract_next(
+          this.ptr, input.ptr, input.length, output.ptr, this.pool.lengthPtr
+        )
+        got = this.module.HEAP32[this.pool.lengthPtr / 4] >>> 0
+      }
+
+      if (status !== Z_OK && status !== Z_STREAM_END) {
+        throw new ZlibCompressionError(`Index extraction failed with code: ${status}`)
+      }
+      return this.module.HEAPU8.slice(output.ptr, output.ptr + got)
+    } finally {
+      this.pool.release(input)
+      this.pool.release(output)
+    }
+  }
+
+  /** Uncompressed (out) and compressed (in) offsets of access point i */
+  point(i: number): { out: number, in: number } {
+    this.checkOpen()
+    return {
+      out: this.module._zlib_index_point_out(this.ptr, i),
+      in: this.module._zlib_index_point_in(this.ptr, i)
+    }
+  }
+
+  /** Compact form for loadIndex(); windows stay compressed */
+  serialize(): Uint8Array {
+    this.checkOpen()
+    return this.take(this.module._zlib_index_serialize(this.ptr, this.pool.pointerPtr, this.pool.lengthPtr))
+  }
+
+  /**
+   * Standalone index for the count access points from first, up to the next
+   * point or the end. Offsets in it are relative to point(first), so it
+   * extracts from a source starting at point(first).in.
+   */
+  segment(first: number, count = 1): Uint8Array {
+    this.checkOpen()
+    return this.take(this.module._zlib_index_serialize_segment(
+      this.ptr, first, count, this.pool.pointerPtr, this.pool.lengthPtr
+    ))
+  }
+
+  /** Copy out and free a buffer returned through the pool's out-cells */
+  private take(result: number): Uint8Array {
+    if (result !== 0) {
+      throw new ZlibMemoryError(`Index serialization failed with code: ${result}`)
+    }
+
+    const dataPtr = this.module.HEAP32[this.pool.pointerPtr / 4]
+    const dataLen = this.module.HEAP32[this.pool.lengthPtr / 4] >>> 0
+    const data = this.module.HEAPU8.slice(dataPtr, dataPtr + dataLen)
+    this.module._free(dataPtr)
+    return data
+  }
+
+  /** Free the index */
+  dispose(): void {
+    if (!this.ptr) return
+    this.module._zlib_index_free(this.ptr)
+    this.ptr = 0
+  }
+
+  private checkOpen(): void {
+    if (!this.ptr) throw new ZlibMemoryError('Index has been disposed')
+  }
+}
+
+/**
+ * Make one pass over a compressed stream and index it
+ */
+export async function buildIndex(
+  module: ZlibModule,
+  pool: HeapBufferPool,
+  source: ZlibIndexSource,
+  span: number,
+  readSize = DEFAULT_READ_SIZE
+): Promise<ZlibIndex> {
+  const ptr = module._zlib_index_create(span)
+  if (!ptr) {
+    throw new ZlibMemoryError('Failed to create index')
+  }
+
+  const input = pool.acquire(readSize)
+  try {
+    let position = 0
+    let status = Z_OK
+    while (status === Z_OK) {
+      const chunk = await readSource(source, position, readSize)
+      if (chunk.length === 0) break
+      position += chunk.length
+      status = module._zlib_index_feed(ptr, input.write(chunk).ptr, chunk.length)
+    }
+
+    const points = module._zlib_index_finish(ptr)
+    if (points < 1) {
+      throw new ZlibCompressionError(`Index build failed with code: ${points}`)
+    }
+    return new ZlibIndex(module, pool, ptr, readSize)
+  } catch (error) {
+    module._zlib_index_free(ptr)
+    throw error
+  } finally {
+    pool.release(input)
+  }
+}
@@ -0,0 +1,72 @@
+/**
+ * zlib.wasm adaptive deflate level
+ * Picks the next level for a stream from how busy deflate kept the thread
+ * over the last stretch of input
+ */
+
+import { ZlibError } from './types.ts'
+import type { ZlibAdaptiveLevel, ZlibChunkTiming, ZlibLevelChange } from './types.ts'
+
+const DEFAULT_INTERVAL = 1024 * 1024
+
+// Shares of the stream's time spent deflating. Below RAISE_BELOW the
+// thread mostly waits on the sink (or the source), so a higher level costs
+// no throughput; above LOWER_ABOVE deflate is what holds the stream back.
+// The gap between them keeps the level from flapping.
+const RAISE_BELOW = 0.5
+const LOWER_ABOVE = 0.9
+
+/**
+ * Level decisions for one deflate stream. record() takes every slice's
+ * timing; once interval bytes of input have gone through, decide() weighs
+ * the time spent in deflate against the time the stream took and returns
+ * the level to switch to, or null to stay.
+ */
+export class ZlibLevelController {
+  readonly minLevel: number
+  readonly maxLevel: number
+  private readonly interval: number
+  private start = -1
+  private busyMs = 0
+  private inputBytes = 0
+
+  constructor(public level: number, options: ZlibAdaptiveLevel = {}) {
+    this.minLevel = options.minLevel ?? 1
+    this.maxLevel = options.maxLevel ?? 9
+    this.interval = options.interval ?? DEFAULT_INTERVAL
+    if (!Number.isInteger(this.minLevel) || !Number.isInteger(this.maxLevel) ||
+        this.minLevel < 0 || this.maxLevel > 10 || this.minLevel > this.maxLevel) {
+      throw new ZlibError(`Adaptive levels must be a range within 0..10, got ${this.minLevel}..${this.maxLevel}`)
+    }
+    if (!(this.interval > 0)) {
+      throw new ZlibError(`Adaptive interval must be positive, got ${this.interval}`)
+    }
+    this.level = Math.min(this.maxLevel, Math.max(this.minLevel, level))
+  }
+
+  record(timing: ZlibChunkTiming, now = performance.now()): void {
+    // The first window opens with the first slice, so time before the
+    // first write is not counted as waiting
+    if (this.start < 0) this.start = now - timing.timeMs
+    this.busyMs += timing.timeMs
+    this.inputBytes += timing.inputBytes
+  }
+
+  /** The level to move to once a window is complete, or null */
+  decide(now = performance.now()): ZlibLevelChange | null {
+    if (this.inputBytes < this.interval) return null
+
+    const wallMs = Math.max(now - this.start, this.busyMs)
+    const throughput = this.busyMs > 0 ? this.inputBytes / this.busyMs / 1000 : Infinity
+    const rate = wallMs > 0 ? this.inputBytes / wallMs / 1000 : Infinity
+    const busy = wallMs > 0 ? this.busyMs / wallMs : 1
+    this.start = now
+    this.busyMs = 0
+    this.inputBytes = 0
+
+    const previous = this.level
+    if (busy < RAISE_BELOW && this.level < this.maxLevel) this.level++
+    else if (busy > LOWER_ABOVE && this.level > this.minLevel) this.level--
+    return this.level === previous ? null : { level: this.level, previous, throughput, rate }
+  }
+}
@@ -0,0 +1,242 @@
+/**
+ * zlib.wasm blocked gzip
+ * BGZF output (src/zlib_bgzf.c), its .gzi side index, and reads that
+ * inflate only the members they cover
+ */
+
+import { ZlibCompression, ZlibCompressionError } from './types.ts'
+import type { ZlibBgzfOptions, ZlibIndexSource, ZlibModule } from './types.ts'
+import type { HeapBufferPool } from './heap.ts'
+import { readSource } from './access.ts'
+
+// Input per member by default, as bgzip cuts it, and the most a member can
+// take up or inflate to
+export const BGZF_BLOCK_SIZE = 0xff00
+export const BGZF_MAX_MEMBER = 0x10000
+
+// A header with only the BC subfield, as every BGZF writer emits it
+const BGZF_HEADER = 18
+
+// Start of every non-empty member, compressed and uncompressed
+interface BgzfPoints {
+  compressed: number[]
+  uncompressed: number[]
+}
+
+// Size of the member whose header is head (BSIZE + 1), or 0 if head is not
+// a BGZF header or is cut short of the BC subfield
+function memberSize(head: Uint8Array): number {
+  if (head.length < 12 || head[0] !== 0x1f || head[1] !== 0x8b || head[2] !== 8 || !(head[3] & 0x04)) {
+    return 0
+  }
+  const end = Math.min(12 + (head[10] | head[11] << 8), head.length)
+  for (let p = 12; p + 4 <= end; p += 4 + (head[p + 2] | head[p + 3] << 8)) {
+    if (head[p] === 0x42 && head[p + 1] === 0x43 && p + 6 <= end) {
+      return (head[p + 4] | head[p + 5] << 8) + 1
+    }
+  }
+  return 0
+}
+
+// Size of the member at position, reading past the usual header only for
+// extra subfields ahead of BC
+async function memberSizeAt(source: ZlibIndexSource, position: number): Promise<number> {
+  let head = await readSource(source, position, BGZF_HEADER)
+  let size = memberSize(head)
+  if (!size && head.length >= 12) {
+    head = await readSource(source, position, 12 + (head[10] | head[11] << 8))
+    size = memberSize(head)
+  }
+  if (!size) {
+    throw new ZlibCompressionError(`No BGZF member at offset ${position}`)
+  }
+  return size
+}
+
+/**
+ * Walk the members of BGZF data, reading each one's header and ISIZE
+ * only. Empty members, such as the end marker, are left out.
+ */
+async function scanMembers(source: ZlibIndexSource): Promise<BgzfPoints> {
+  const points: BgzfPoints = { compressed: [], uncompressed: [] }
+  let position = 0
+  let out = 0
+
+  while ((await readSource(source, position, 1)).length > 0) {
+    const size = await memberSizeAt(source, position)
+    const trailer = await readSource(source, position + size - 4, 4)
+    if (trailer.length < 4) {
+      throw new ZlibCompressionError(`BGZF member at offset ${position} is truncated`)
+    }
+    const isize = (trailer[0] | trailer[1] << 8 | trailer[2] << 16 | trailer[3] << 24) >>> 0
+    if (isize > 0) {
+      points.compressed.push(position)
+      points.uncompressed.push(out)
+    }
+    out += isize
+    position += size
+  }
+  return points
+}
+
+// .gzi: a count, then a compressed and uncompressed offset for every member
+// after the first, all little-endian uint64
+function encodeIndex(points: BgzfPoints): Uint8Array {
+  const count = Math.max(0, points.compressed.length - 1)
+  const bytes = new Uint8Array(8 + 16 * count)
+  const view = new DataView(bytes.buffer)
+  view.setBigUint64(0, BigInt(count), true)
+  for (let i = 0; i < count; i++) {
+    view.setBigUint64(8 + 16 * i, BigInt(points.compressed[i + 1]), true)
+    view.setBigUint64(16 + 16 * i, BigInt(points.uncompressed[i + 1]), true)
+  }
+  return bytes
+}
+
+function decodeIndex(bytes: Uint8Array): BgzfPoints {
+  const view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength)
+  const count = bytes.length >= 8 ? Number(view.getBigUint64(0, true)) : -1
+  if (count < 0 || bytes.length < 8 + 16 * count) {
+    throw new ZlibCompressionError('Invalid or truncated BGZF index')
+  }
+
+  const points: BgzfPoints = { compressed: [0], uncompressed: [0] }
+  for (let i = 0; i < count; i++) {
+    points.compressed.push(Number(view.getBigUint64(8 + 16 * i, true)))
+    points.uncompressed.push(Number(view.getBigUint64(16 + 16 * i, true)))
+  }
+  return points
+}
+
+// Index of the last of the ascending offsets at or below offset
+function pointAt(offsets: number[], offset: number): number {
+  let low = 0
+  let high = offsets.length
+  while (high - low > 1) {
+    const mid = (low + high) >>> 1
+    if (offsets[mid] <= offset) low = mid
+    else high = mid
+  }
+  return low
+}
+
+/**
+ * Random access into BGZF data. The data stays with the caller and is read
+ * through a ZlibIndexSource; read() fetches just the members that hold the
+ * requested range and inflates them with one call, as they need no window
+ * from anything before them.
+ */
+export class ZlibBgzfReader {
+  // Where the last member ends, once a read has needed it
+  private end = 0
+
+  constructor(
+    private readonly module: ZlibModule,
+    private readonly pool: HeapBufferPool,
+    private readonly source: ZlibIndexSource,
+    private readonly points: BgzfPoints
+  ) {}
+
+  /** Number of members holding data */
+  get blocks(): number {
+    return this.points.compressed.length
+  }
+
+  /** Uncompressed (out) and compressed (in) offsets of member i */
+  point(i: number): { out: number, in: number } {
+    return { out: this.points.uncompressed[i], in: this.points.compressed[i] }
+  }
+
+  /** The side index in bgzip's .gzi layout */
+  index(): Uint8Array {
+    return encodeIndex(this.points)
+  }
+
+  /** Read length bytes from uncompressed offset; fewer come back past the end */
+  async read(offset: number, length: number): Promise<Uint8Array> {
+    if (length <= 0 || offset < 0 || this.blocks === 0) return new Uint8Array(0)
+
+    const { compressed, uncompressed } = this.points
+    const first = pointAt(uncompressed, offset)
+    const last = pointAt(uncompressed, offset + length - 1)
+    const start = compressed[first]
+    const end = last + 1 < this.blocks ? compressed[last + 1] : await this.lastEnd()
+
+    const data = await readSource(this.source, start, end - start)
+    if (data.length < end - start) {
+      throw new ZlibCompressionError(`BGZF data ends before offset ${end}`)
+    }
+
+    const input = this.pool.acquire(data.length).write(data)
+    const output = this.pool.acquire((last - first + 1) * BGZF_MAX_MEMBER)
+    try {
+      this.pool.length = output.capacity
+      const result = this.module._zlib_decompress_buffer(input.ptr, input.length, output.ptr, this.pool.lengthPtr)
+      if (result !== 0) {
+        throw new ZlibCompressionError(`BGZF read failed with code: ${result}`)
+      }
+
+      const from = offset - uncompressed[first]
+      const to = Math.min(this.pool.length, from + length)
+      return from < to ? this.module.HEAPU8.slice(output.ptr + from, output.ptr + to) : new Uint8Array(0)
+    } finally {
+      this.pool.release(input)
+      this.pool.release(output)
+    }
+  }
+
+  private async lastEnd(): Promise<number> {
+    if (!this.end) {
+      const start = this.points.compressed[this.blocks - 1]
+      this.end = start + await memberSizeAt(this.source, start)
+    }
+    return this.end
+  }
+}
+
+/**
+ * Compress data to BGZF, on the module's threads where the build has them,
+ * and index the members written
+ */
+export async function compressBgzf(
+  module: ZlibModule,
+  pool: HeapBufferPool,
+  data: Uint8Array,
+  options: ZlibBgzfOptions,
+  threads: number
+): Promise<{ data: Uint8Array, index: Uint8Array }> {
+  const blockSize = Math.min(Math.max(options.blockSize ?? BGZF_BLOCK_SIZE, 1), BGZF_BLOCK_SIZE)
+  const level = options.level ?? ZlibCompression.DEFAULT_COMPRESSION
+  const input = pool.acquire(data.length).write(data)
+  const output = pool.acquire(module._zlib_bgzf_bound!(data.length, blockSize))
+
+  try {
+    pool.length = output.capacity
+    const result = threads > 1 && typeof module._zlib_bgzf_compress_parallel === 'function'
+      ? module._zlib_bgzf_compress_parallel(input.ptr, data.length, output.ptr, pool.lengthPtr, level, blockSize, threads)
+      : module._zlib_bgzf_compress!(input.ptr, data.length, output.ptr, pool.lengthPtr, level, blockSize)
+    if (result !== 0) {
+      throw new ZlibCompressionError(`BGZF compression failed with code: ${result}`)
+    }
+
+    const compressed = module.HEAPU8.slice(output.ptr, output.ptr + pool.length)
+    return { data: compressed, index: encodeIndex(await scanMembers(compressed)) }
+  } finally {
+    pool.release(input)
+    pool.release(output)
+  }
+}
+
+/**
+ * A reader over BGZF data, from its .gzi index or, without one, from a
+ * walk over the members
+ */
+export async function openBgzf(
+  module: ZlibModule,
+  pool: HeapBufferPool,
+  source: ZlibIndexSource,
+  index?: Uint8Array
+): Promise<ZlibBgzfReader> {
+  const points = index ? decodeIndex(index) : await scanMembers(source)
+  return new ZlibBgzfReader(module, pool, source, points)
+}
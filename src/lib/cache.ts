@@ -0,0 +1,142 @@
+/**
+ * zlib.wasm compression cache
+ * compress() output for repeated inputs, kept on the JS side so a hit
+ * never enters WASM
+ */
+
+import type { ZlibCompressCacheStats, ZlibOptions, ZlibResult } from './types.ts'
+
+// Bytes charged per entry on top of its input and output, for the key,
+// the result object and the map slot
+const ENTRY_OVERHEAD = 128
+
+// Largest share of the cap one entry may take, so one large input cannot
+// flush every hot one
+const MAX_ENTRY_SHARE = 4
+
+interface CacheEntry {
+  input: Uint8Array
+  result: ZlibResult
+  bytes: number
+}
+
+/**
+ * 32-bit hash of the whole input, a word at a time. It only picks the
+ * entry: a hit is confirmed against the stored input, so a collision
+ * costs a miss, never wrong output.
+ */
+export function contentHash(data: Uint8Array): number {
+  const view = new DataView(data.buffer, data.byteOffset, data.byteLength)
+  const words = data.length >>> 2
+  let h = 0x9e3779b9 ^ data.length
+  for (let i = 0; i < words; i++) {
+    h = Math.imul(h ^ view.getUint32(i * 4, true), 0x5bd1e995)
+    h ^= h >>> 15
+  }
+  for (let i = words * 4; i < data.length; i++) {
+    h = Math.imul(h ^ data[i], 0x5bd1e995)
+  }
+  h = Math.imul(h ^ (h >>> 13), 0xc2b2ae35)
+  return (h ^ (h >>> 16)) >>> 0
+}
+
+function sameBytes(a: Uint8Array, b: Uint8Array): boolean {
+  if (a.length !== b.length) return false
+  for (let i = 0; i < a.length; i++) {
+    if (a[i] !== b[i]) return false
+  }
+  return true
+}
+
+/**
+ * Least recently used compress() results, up to maxBytes of inputs and
+ * outputs together. Each entry keeps a copy of its input to confirm hits,
+ * and hands out copies of its output, so callers may change either freely.
+ */
+export class ZlibCompressCache {
+  // Map order is insertion order: the first entry is the least recently used
+  private readonly entries = new Map<string, CacheEntry>()
+  // Dictionaries by identity, as two can share an Adler-32 id
+  private readonly dictionaries = new WeakMap<object, number>()
+  private lastDictionary = 0
+  private bytes = 0
+  private hits = 0
+  private misses = 0
+  private evictions = 0
+
+  constructor(readonly maxBytes: number) {}
+
+  /** The entry key for data compressed with options */
+  key(data: Uint8Array, options: ZlibOptions): string {
+    let dictionary = 0
+    if (options.dictionary) {
+      dictionary = this.dictionaries.get(options.dictionary) ?? ++this.lastDictionary
+      this.dictionaries.set(options.dictionary, dictionary)
+    }
+    return [
+      contentHash(data),
+      data.length,
+      options.level ?? '',
+      options.strategy ?? '',
+      options.windowBits ?? '',
+      options.memLevel ?? '',
+      options.format ?? '',
+      options.header?.name ?? '',
+      options.header?.mtime ?? '',
+      options.rsyncable ? 1 : 0,
+      options.auto ? 1 : 0,
+      dictionary
+    ].join(':')
+  }
+
+  /** The result cached for data under key, or null */
+  get(key: string, data: Uint8Array): ZlibResult | null {
+    const entry = this.entries.get(key)
+    if (!entry || !sameBytes(entry.input, data)) {
+      this.misses++
+      return null
+    }
+    this.entries.delete(key)
+    this.entries.set(key, entry)
+    this.hits++
+    return { ...entry.result, data: entry.result.data.slice() }
+  }
+
+  /** Keep a result, evicting the least recently used past the cap */
+  set(key: string, data: Uint8Array, result: ZlibResult): void {
+    const bytes = data.length + result.data.length + ENTRY_OVERHEAD
+    if (bytes > this.maxBytes / MAX_ENTRY_SHARE) return
+
+    this.remove(key)
+    this.entries.set(key, { input: data.slice(), result: { ...result, data: result.data.slice() }, bytes })
+    this.bytes += bytes
+    for (const oldest of this.entries.keys()) {
+      if (this.bytes <= this.maxBytes) break
+      this.remove(oldest)
+      this.evictions++
+    }
+  }
+
+  clear(): void {
+    this.entries.clear()
+    this.bytes = 0
+  }
+
+  stats(): ZlibCompressCacheStats {
+    return {
+      entries: this.entries.size,
+      bytes: this.bytes,
+      maxBytes: this.maxBytes,
+      hits: this.hits,
+      misses: this.misses,
+      evictions: this.evictions
+    }
+  }
+
+  private remove(key: string): void {
+    const entry = this.entries.get(key)
+    if (!entry) return
+    this.entries.delete(key)
+    this.bytes -= entry.bytes
+  }
+}
@@ -0,0 +1,89 @@
+/**
+ * zlib.wasm incremental checksums
+ * CRC32 and Adler32 over data that arrives in pieces, staged through one
+ * fixed region of the heap
+ */
+
+import type { ZlibModule } from './types.ts'
+import type { HeapBufferPool, ZlibHeapBuffer } from './heap.ts'
+
+// Heap staging region per hasher; longer updates pass through it in slices
+export const CHECKSUM_STAGING_SIZE = 64 * 1024
+
+/**
+ * A running checksum. Each update() copies its input into the same staging
+ * region, a slice at a time, so no call allocates however much data goes
+ * through; input that already lives in the heap (a ZlibHeapBuffer view) is
+ * checksummed in place. dispose() returns the region to the pool.
+ */
+abstract class ZlibHasher {
+  private staging: ZlibHeapBuffer | null = null
+  private value: number
+
+  protected constructor(
+    protected readonly module: ZlibModule,
+    private readonly pool: HeapBufferPool,
+    private readonly initial: number,
+    value: number
+  ) {
+    this.value = value
+  }
+
+  /** Fold data into the checksum */
+  update(data: Uint8Array): this {
+    if (data.buffer === this.module.HEAPU8.buffer) {
+      this.value = this.fold(this.value, data.byteOffset, data.length)
+      return this
+    }
+
+    this.staging ??= this.pool.acquire(CHECKSUM_STAGING_SIZE)
+    const { ptr, capacity } = this.staging
+    for (let offset = 0; offset < data.length; offset += capacity) {
+      const slice = data.subarray(offset, offset + capacity)
+      this.module.HEAPU8.set(slice, ptr)
+      this.value = this.fold(this.value, ptr, slice.length)
+    }
+    return this
+  }
+
+  /** The checksum of everything passed to update() so far */
+  digest(): number {
+    return this.value
+  }
+
+  /** Start over, as for an empty input */
+  reset(): this {
+    this.value = this.initial
+    return this
+  }
+
+  /** Return the staging region to its pool */
+  dispose(): void {
+    if (this.staging) this.pool.release(this.staging)
+    this.staging = null
+  }
+
+  protected abstract fold(value: number, ptr: number, length: number): number
+}
+
+/** Incremental CRC32, continuing from crc (0 for a new checksum) */
+export class Crc32Hasher extends ZlibHasher {
+  constructor(module: ZlibModule, pool: HeapBufferPool, crc = 0) {
+    super(module, pool, 0, crc)
+  }
+
+  protected fold(crc: number, ptr: number, length: number): number {
+    return this.module._zlib_crc32(crc, ptr, length) >>> 0
+  }
+}
+
+/** Incremental Adler32, continuing from adler (1 for a new checksum) */
+export class Adler32Hasher extends ZlibHasher {
+  constructor(module: ZlibModule, pool: HeapBufferPool, adler = 1) {
+    super(module, pool, 1, adler)
+  }
+
+  protected fold(adler: number, ptr: number, length: number): number {
+    return this.module._zlib_adler32(adler, ptr, length) >>> 0
+  }
+}
@@ -0,0 +1,77 @@
+/**
+ * zlib.wasm lazy loading
+ * Starts on the inflate-only core build and loads the full module, with
+ * deflate and the SIMD kernels, the first time something needs it
+ */
+
+import Zlib from './index.ts'
+import type { ZlibDecompressOptions, ZlibLoadingOptions, ZlibOptions, ZlibResult } from './types.ts'
+
+/**
+ * For cold-start-sensitive hosts such as edge functions: initialize() only
+ * fetches and instantiates zlib-release-core.js (./build-dual.sh core),
+ * built with -Oz from inflate and the checksums alone, so the first
+ * decompress() does not wait for deflate or SIMD code it never runs.
+ *
+ * full() loads the complete module once, in the background if called early
+ * (preload()), and compress() goes through it. Decompression stays on the
+ * core either way, so results never depend on which module had loaded.
+ */
+export class ZlibCore {
+  private readonly core: Zlib
+  private loading: Promise<Zlib> | null = null
+
+  constructor(private readonly options: ZlibLoadingOptions = {}) {
+    this.core = new Zlib({ ...options, core: true })
+  }
+
+  /** Load the inflate-only core */
+  initialize(): Promise<void> {
+    return this.core.initialize()
+  }
+
+  /** Decompress zlib or gzip data on the core */
+  async decompress(data: Uint8Array, options: ZlibDecompressOptions = {}): Promise<ZlibResult> {
+    return await this.core.decompress(data, options)
+  }
+
+  crc32(data: Uint8Array, crc = 0): number {
+    return this.core.crc32(data, crc)
+  }
+
+  adler32(data: Uint8Array, adler = 1): number {
+    return this.core.adler32(data, adler)
+  }
+
+  /** Compress on the full module, loading it first if need be */
+  async compress(data: Uint8Array, options: ZlibOptions = {}): Promise<ZlibResult> {
+    return await (await this.full()).compress(data, options)
+  }
+
+  /**
+   * The full module, loaded and initialized on the first call; every later
+   * call shares it. For everything beyond decompression and checksums.
+   */
+  full(): Promise<Zlib> {
+    if (!this.loading) {
+      const zlib = new Zlib(this.options)
+      this.loading = zlib.initialize().then(() => zlib, error => {
+        this.loading = null
+        throw error
+      })
+    }
+    return this.loading
+  }
+
+  /** Start loading the full module without waiting for it, e.g. once idle */
+  preload(): void {
+    this.full().catch(() => {})
+  }
+
+  /** Release the core, and the full module if it was loaded */
+  cleanup(): void {
+    this.core.cleanup()
+    this.loading?.then(zlib => zlib.cleanup(), () => {})
+    this.loading = null
+  }
+}
@@ -0,0 +1,70 @@
+/**
+ * zlib.wasm deflate-only entry point
+ * Compression on zlib-release-deflate (./build-dual.sh deflate)
+ */
+
+import { ZlibCompression, ZlibCompressionError, ZlibStrategy } from './types.ts'
+import type { ZlibLoadingOptions, ZlibOptions, ZlibStreamOptions } from './types.ts'
+import { ZlibSlim } from './slim.ts'
+import { createZlibTransform } from './stream.ts'
+
+/**
+ * zlib compression, streaming compression and the checksums on the
+ * deflate-only build. Calls are synchronous once initialize() has resolved.
+ */
+export class ZlibDeflate extends ZlibSlim {
+  constructor(options: ZlibLoadingOptions = {}) {
+    super('zlib-release-deflate', [
+      '_zlib_compress_buffer',
+      '_zlib_compress_bound',
+      '_zlib_deflate_init',
+      '_zlib_crc32',
+      '_zlib_adler32'
+    ], options)
+  }
+
+  /**
+   * Compress data as one zlib stream
+   */
+  compress(data: Uint8Array, options: Pick<ZlibOptions, 'level'> = {}): Uint8Array {
+    const module = this.ready()
+    const pool = this.heapPool!
+    const input = pool.acquire(data.length).write(data)
+    const output = pool.acquire(module._zlib_compress_bound(data.length))
+
+    try {
+      const lengthPtr = pool.lengthPtr
+      pool.length = output.capacity
+
+      const result = module._zlib_compress_buffer(
+        input.ptr,
+        data.length,
+        output.ptr,
+        lengthPtr,
+        options.level ?? ZlibCompression.DEFAULT_COMPRESSION
+      )
+      if (result !== 0) {
+        throw new ZlibCompressionError(`Compression failed with code: ${result}`)
+      }
+      return module.HEAPU8.slice(output.ptr, output.ptr + pool.length)
+    } finally {
+      pool.release(input)
+      pool.release(output)
+    }
+  }
+
+  /**
+   * Create a compressing TransformStream, as Zlib.createDeflateStream() does
+   */
+  createDeflateStream(options: ZlibStreamOptions = {}): TransformStream<Uint8Array, Uint8Array> {
+    const module = this.ready()
+
+    const ctx = module._zlib_deflate_init(
+      options.level ?? ZlibCompression.DEFAULT_COMPRESSION,
+      options.windowBits ?? 15,
+      options.memLevel ?? 8,
+      options.strategy ?? ZlibStrategy.DEFAULT_STRATEGY
+    )
+    return createZlibTransform(module, this.heapPool!, 'deflate', ctx, options)
+  }
+}
@@ -0,0 +1,119 @@
+/**
+ * zlib.wasm preset dictionaries
+ * Heap-resident dictionaries for small-message compression, and a trainer
+ */
+
+import type { ZlibHeapBuffer } from './heap.ts'
+
+// deflate only ever looks back 32 KB, so longer dictionaries are truncated
+export const MAX_DICTIONARY_SIZE = 32 * 1024
+
+// Substring length used to find content shared between samples
+const GRAM_SIZE = 8
+
+/**
+ * A preset dictionary loaded into the WASM heap once. Pass it as
+ * `options.dictionary` to compress()/decompress(); it is referenced in place,
+ * never recopied, and `id` is the Adler-32 that zlib streams record for it.
+ */
+export class ZlibDictionary {
+  // Deflate contexts primed with this dictionary, by compression level
+  readonly snapshots = new Map<number, number>()
+
+  constructor(
+    readonly buffer: ZlibHeapBuffer,
+    readonly id: number
+  ) {}
+
+  get ptr(): number {
+    return this.buffer.ptr
+  }
+
+  get length(): number {
+    return this.buffer.length
+  }
+}
+
+function toLatin1(bytes: Uint8Array): string {
+  let text = ''
+  for (let i = 0; i < bytes.length; i += 8192) {
+    text += String.fromCharCode(...bytes.subarray(i, i + 8192))
+  }
+  return text
+}
+
+function fromLatin1(text: string): Uint8Array {
+  const bytes = new Uint8Array(text.length)
+  for (let i = 0; i < text.length; i++) bytes[i] = text.charCodeAt(i)
+  return bytes
+}
+
+/**
+ * Build a dictionary from representative messages.
+ *
+ * Runs of GRAM_SIZE-byte substrings that occur in several samples are
+ * collected as segments and ranked by (samples containing them x length).
+ * The best segments are kept up to maxSize and placed last, since deflate
+ * codes matches at short distances, close to the message, most cheaply.
+ */
+export function trainDictionary(
+  samples: Uint8Array[],
+  maxSize = MAX_DICTIONARY_SIZE
+): Uint8Array {
+  maxSize = Math.min(maxSize, MAX_DICTIONARY_SIZE)
+  const texts = samples.map(toLatin1)
+  const minCount = Math.max(2, Math.ceil(samples.length / 100))
+
+  // Number of samples each gram appears in
+  const gramCounts = new Map<string, number>()
+  for (const text of texts) {
+    const seen = new Set<string>()
+    for (let i = 0; i + GRAM_SIZE <= text.length; i++) {
+      seen.add(text.substring(i, i + GRAM_SIZE))
+    }
+    for (const gram of seen) gramCounts.set(gram, (gramCounts.get(gram) ?? 0) + 1)
+  }
+
+  // Maximal runs of shared grams, counted once per sample
+  const segmentCounts = new Map<string, number>()
+  for (const text of texts) {
+    const seen = new Set<string>()
+    let i = 0
+    while (i + GRAM_SIZE <= text.length) {
+      if ((gramCounts.get(text.substring(i, i + GRAM_SIZE)) ?? 0) < minCount) {
+        i++
+        continue
+      }
+      let end = i + 1
+      while (end + GRAM_SIZE <= text.length &&
+             (gramCounts.get(text.substring(end, end + GRAM_SIZE)) ?? 0) >= minCount) {
+        end++
+      }
+      seen.add(text.substring(i, end + GRAM_SIZE - 1))
+      i = end
+    }
+    for (const segment of seen) segmentCounts.set(segment, (segmentCounts.get(segment) ?? 0) + 1)
+  }
+
+  const ranked = [...segmentCounts]
+    .filter(([, count]) => count >= minCount)
+    .sort((a, b) => b[1] * b[0].length - a[1] * a[0].length)
+
+  const chosen: string[] = []
+  let size = 0
+  let joined = ''
+  for (const [segment] of ranked) {
+    if (size + segment.length > maxSize || joined.includes(segment)) continue
+    chosen.push(segment)
+    joined += segment
+    size += segment.length
+  }
+
+  // Nothing recurs: fall back to the most recent sample content
+  if (chosen.length === 0) {
+    const tail = texts.join('')
+    return fromLatin1(tail.substring(Math.max(0, tail.length - maxSize)))
+  }
+
+  return fromLatin1(chosen.reverse().join(''))
+}
@@ -0,0 +1,232 @@
+/**
+ * zlib.wasm gzip files
+ * gzread()/gzwrite() over OPFS sync access handles through the zlib_gzfile_* exports
+ */
+
+import { ZlibCompressionError, ZlibError, ZlibMemoryError } from './types.ts'
+import type { ZlibGzipFileOptions, ZlibHostFiles, ZlibModule, ZlibSyncAccessHandle } from './types.ts'
+import type { HeapBufferPool, ZlibHeapBuffer } from './heap.ts'
+
+// gzclose() success, and lseek() whence values
+const Z_OK = 0
+const SEEK_SET = 0
+const SEEK_CUR = 1
+
+// Uncompressed bytes per read() by default, and per staged write
+export const DEFAULT_CHUNK_SIZE = 1024 * 1024
+
+interface HostFile {
+  handle: ZlibSyncAccessHandle
+  position: number
+}
+
+// Open host files per module, by the number src/zlib_gzfile.c knows them by
+const tables = new WeakMap<ZlibModule, Map<number, HostFile>>()
+let lastFile = 0
+
+/**
+ * The module's table of open host files, installing module.zlibFiles on
+ * first use. Each call from src/zlib_gzfile.c moves bytes straight between
+ * the handle and the heap; a view is taken per call because the heap may
+ * have grown since.
+ */
+function hostFiles(module: ZlibModule): Map<number, HostFile> {
+  const table = tables.get(module)
+  if (table) return table
+
+  const files = new Map<number, HostFile>()
+  const io: ZlibHostFiles = {
+    read(file, bufPtr, len) {
+      const f = files.get(file)
+      if (!f) return -1
+      try {
+        const n = f.handle.read(module.HEAPU8.subarray(bufPtr, bufPtr + len), { at: f.position })
+        f.position += n
+        return n
+      } catch {
+        return -1
+      }
+    },
+    write(file, bufPtr, len) {
+      const f = files.get(file)
+      if (!f) return -1
+      try {
+        const n = f.handle.write(module.HEAPU8.subarray(bufPtr, bufPtr + len), { at: f.position })
+        f.position += n
+        return n
+      } catch {
+        return -1
+      }
+    },
+    seek(file, offset, whence) {
+      const f = files.get(file)
+      if (!f) return -1
+      const base = whence === SEEK_SET ? 0 : whence === SEEK_CUR ? f.position : f.handle.getSize()
+      if (base + offset < 0) return -1
+      f.position = base + offset
+      return f.position
+    },
+    close(file) {
+      const f = files.get(file)
+      files.delete(file)
+      try {
+        f?.handle.flush()
+        return 0
+      } catch {
+        return -1
+      }
+    }
+  }
+
+  module.zlibFiles = io
+  tables.set(module, files)
+  return files
+}
+
+/**
+ * A gzip file read or written through gzread()/gzwrite() on an OPFS
+ * FileSystemSyncAccessHandle, in a worker. gz's buffers (1 MB by default)
+ * are filled and drained with single handle calls straight into the heap,
+ * so a multi-GB file streams through at disk speed in a few MB of memory.
+ *
+ * Reads and writes are synchronous, as the handle's are; readable() and
+ * writable() wrap them as streams. close() flushes the gzip trailer and the
+ * handle, but leaves the handle open for its owner to close.
+ */
+export class ZlibGzipFile {
+  private buffer: ZlibHeapBuffer | null = null
+
+  constructor(
+    private readonly module: ZlibModule,
+    private readonly pool: HeapBufferPool,
+    private gz: number
+  ) {}
+
+  /** Read up to length uncompressed bytes; empty at the end of the file */
+  read(length = DEFAULT_CHUNK_SIZE): Uint8Array {
+    this.checkOpen()
+    const buffer = this.staging(length)
+    const n = this.module._zlib_gzfile_read(this.gz, buffer.ptr, length)
+    if (n < 0) this.fail('read')
+    return this.module.HEAPU8.slice(buffer.ptr, buffer.ptr + n)
+  }
+
+  /** Compress data into the file */
+  write(data: Uint8Array): void {
+    this.checkOpen()
+    if (data.length === 0) return
+    for (let offset = 0; offset < data.length; offset += DEFAULT_CHUNK_SIZE) {
+      const chunk = data.subarray(offset, offset + DEFAULT_CHUNK_SIZE)
+      const buffer = this.staging(chunk.length).write(chunk)
+      if (this.module._zlib_gzfile_write(this.gz, buffer.ptr, chunk.length) === 0) this.fail('write')
+    }
+  }
+
+  /** The rest of the file as a stream of chunkSize pieces; closes at the end */
+  readable(chunkSize = DEFAULT_CHUNK_SIZE): ReadableStream<Uint8Array> {
+    return new ReadableStream<Uint8Array>({
+      pull: controller => {
+        try {
+          const chunk = this.read(chunkSize)
+          if (chunk.length > 0) {
+            controller.enqueue(chunk)
+          } else {
+            this.close()
+            controller.close()
+          }
+        } catch (error) {
+          this.dispose()
+          throw error
+        }
+      },
+      cancel: () => this.dispose()
+    }, new CountQueuingStrategy({ highWaterMark: 1 }))
+  }
+
+  /** A stream compressing into the file; closing it closes the file */
+  writable(): WritableStream<Uint8Array> {
+    return new WritableStream<Uint8Array>({
+      write: chunk => this.write(chunk),
+      close: () => this.close(),
+      abort: () => this.dispose()
+    })
+  }
+
+  /** Finish the gzip stream and flush the handle */
+  close(): void {
+    if (!this.gz) return
+    const result = this.release()
+    if (result !== Z_OK) {
+      throw new ZlibCompressionError(`Closing gzip file failed with code: ${result}`)
+    }
+  }
+
+  /** Free the file without reporting errors, as on a failed stream */
+  dispose(): void {
+    if (this.gz) this.release()
+  }
+
+  private release(): number {
+    const result = this.module._zlib_gzfile_close(this.gz)
+    this.gz = 0
+    if (this.buffer) this.pool.release(this.buffer)
+    this.buffer = null
+    return result
+  }
+
+  /** Heap staging for one call, kept while it is big enough */
+  private staging(length: number): ZlibHeapBuffer {
+    if (this.buffer && this.buffer.capacity >= length) return this.buffer
+    if (this.buffer) this.pool.release(this.buffer)
+    this.buffer = this.pool.acquire(length)
+    return this.buffer
+  }
+
+  private fail(op: string): never {
+    const code = this.module._zlib_gzfile_error(this.gz)
+    throw new ZlibCompressionError(`Gzip file ${op} failed with code: ${code}`)
+  }
+
+  private checkOpen(): void {
+    if (!this.gz) throw new ZlibMemoryError('Gzip file has been closed')
+  }
+}
+
+/**
+ * Open handle as a gzip file for reading ('r'), writing from empty ('w')
+ * or appending a new member ('a')
+ */
+export function openGzipFile(
+  module: ZlibModule,
+  pool: HeapBufferPool,
+  handle: ZlibSyncAccessHandle,
+  mode: 'r' | 'w' | 'a',
+  options: ZlibGzipFileOptions
+): ZlibGzipFile {
+  if (mode !== 'r' && mode !== 'w' && mode !== 'a') {
+    throw new ZlibError(`Gzip file mode must be 'r', 'w' or 'a', got ${mode}`)
+  }
+  // gzopen() modes carry one digit, so there is no level 10
+  const level = options.level ?? 6
+  if (!Number.isInteger(level) || level < 0 || level > 9) {
+    throw new ZlibError(`Gzip file level must be 0..9, got ${level}`)
+  }
+
+  const files = hostFiles(module)
+  const file = ++lastFile
+  files.set(file, { handle, position: 0 })
+  if (mode === 'w') handle.truncate(0)
+
+  const modeString = new TextEncoder().encode(`${mode}b${mode === 'r' ? '' : level}\0`)
+  const modeBuffer = pool.acquire(modeString.length).write(modeString)
+  try {
+    const gz = module._zlib_gzfile_open(file, modeBuffer.ptr, options.bufferSize ?? 0)
+    if (!gz) {
+      files.delete(file)
+      throw new ZlibMemoryError('Failed to open gzip file')
+    }
+    return new ZlibGzipFile(module, pool, gz)
+  } finally {
+    pool.release(modeBuffer)
+  }
+}
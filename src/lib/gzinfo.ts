@@ -0,0 +1,125 @@
+/**
+ * zlib.wasm gzip metadata
+ * Member headers and trailers read in place, and member boundaries found
+ * by zlib_gzip_members() (src/zlib_gzjoin.c) without producing any output
+ */
+
+import { ZlibCompressionError } from './types.ts'
+import type { ZlibGzipHeaderInfo, ZlibGzipMember, ZlibModule } from './types.ts'
+import type { HeapBufferPool } from './heap.ts'
+
+// gzip header flags
+const GZ_FTEXT = 0x01
+const GZ_FHCRC = 0x02
+const GZ_FEXTRA = 0x04
+const GZ_FNAME = 0x08
+const GZ_FCOMMENT = 0x10
+
+const GZ_HEADER = 10
+const GZ_TRAILER = 8
+
+// Shortest member: a bare header, an empty final block and the trailer
+const MIN_MEMBER = GZ_HEADER + 2 + GZ_TRAILER
+
+// Names and comments are decoded as UTF-8, as compress() writes header.name;
+// RFC 1952 says Latin-1, which is the same for ASCII
+const decoder = new TextDecoder()
+
+function get4(bytes: Uint8Array, at: number): number {
+  return (bytes[at] | bytes[at + 1] << 8 | bytes[at + 2] << 16 | bytes[at + 3] << 24) >>> 0
+}
+
+/**
+ * The header of the member at offset, or null if there is no gzip header
+ * there or it is cut short
+ */
+export function parseGzipHeader(bytes: Uint8Array, offset = 0): ZlibGzipHeaderInfo | null {
+  const end = bytes.length
+  if (end - offset < GZ_HEADER || bytes[offset] !== 0x1f || bytes[offset + 1] !== 0x8b ||
+      bytes[offset + 2] !== 8 || bytes[offset + 3] & 0xe0) {
+    return null
+  }
+
+  const flags = bytes[offset + 3]
+  const header: ZlibGzipHeaderInfo = {
+    headerLength: 0,
+    mtime: get4(bytes, offset + 4),
+    extraFlags: bytes[offset + 8],
+    os: bytes[offset + 9],
+    text: (flags & GZ_FTEXT) !== 0
+  }
+
+  let pos = offset + GZ_HEADER
+  const field = () => {
+    const nul = bytes.indexOf(0, pos)
+    if (nul < 0) return null
+    const value = decoder.decode(bytes.subarray(pos, nul))
+    pos = nul + 1
+    return value
+  }
+  if (flags & GZ_FEXTRA) {
+    if (end - pos < 2) return null
+    const length = bytes[pos] | bytes[pos + 1] << 8
+    if (end - pos - 2 < length) return null
+    header.extra = bytes.slice(pos + 2, pos + 2 + length)
+    pos += 2 + length
+  }
+  if (flags & GZ_FNAME) {
+    const name = field()
+    if (name === null) return null
+    header.name = name
+  }
+  if (flags & GZ_FCOMMENT) {
+    const comment = field()
+    if (comment === null) return null
+    header.comment = comment
+  }
+  if (flags & GZ_FHCRC) {
+    if (end - pos < 2) return null
+    pos += 2
+  }
+
+  header.headerLength = pos - offset
+  return header
+}
+
+/**
+ * Every member of a run of gzip members, with its header, trailer and
+ * place in the input. Only the boundaries need WASM: BGZF members give
+ * their length in the header, and any other is inflated to nowhere.
+ */
+export function gzipMembers(module: ZlibModule, pool: HeapBufferPool, data: Uint8Array): ZlibGzipMember[] {
+  if (data.length === 0) return []
+
+  const maxEnds = Math.floor(data.length / MIN_MEMBER) + 1
+  const input = pool.acquire(data.length).write(data)
+  const ends = pool.acquire(maxEnds * 4)
+
+  let boundaries: number[]
+  try {
+    const result = module._zlib_gzip_members!(input.ptr, data.length, ends.ptr, maxEnds, pool.lengthPtr)
+    const count = pool.length
+    if (result !== 0) {
+      throw new ZlibCompressionError(`gzip member ${count} is invalid or truncated (code: ${result})`)
+    }
+    boundaries = Array.from(module.HEAP32.subarray(ends.ptr / 4, ends.ptr / 4 + count), end => end >>> 0)
+  } finally {
+    pool.release(input)
+    pool.release(ends)
+  }
+
+  const members: ZlibGzipMember[] = []
+  let offset = 0
+  for (const end of boundaries) {
+    const header = parseGzipHeader(data, offset)!
+    members.push({
+      ...header,
+      offset,
+      length: end - offset,
+      crc32: get4(data, end - 8),
+      isize: get4(data, end - 4)
+    })
+    offset = end
+  }
+  return members
+}
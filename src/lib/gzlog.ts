@@ -0,0 +1,413 @@
+/**
+ * zlib.wasm gzip log
+ * Crash-safe appends to one gzip file (examples/gzlog.c) through a storage adapter
+ */
+
+import { ZlibCompressionError, ZlibMemoryError } from './types.ts'
+import type { ZlibLogOptions, ZlibLogStorage, ZlibModule, ZlibSyncAccessHandle } from './types.ts'
+import type { HeapBufferPool } from './heap.ts'
+import { concatChunks } from './stream.ts'
+
+// zlib return and flush codes used by the stream exports
+const Z_OK = 0
+const Z_BUF_ERROR = -5
+const Z_NO_FLUSH = 0
+const Z_SYNC_FLUSH = 2
+
+// The gzip header carries one 'z' 'l' extra subfield holding two state
+// slots, written alternately so a torn write leaves the other one intact
+const SLOT_SIZE = 24
+const SLOTS_AT = 16
+const HEADER_SIZE = SLOTS_AT + 2 * SLOT_SIZE
+// An empty final fixed block, then CRC-32 and ISIZE
+const TAIL_SIZE = 10
+
+// Output staged per process call
+const CHUNK_SIZE = 64 * 1024
+
+const EMPTY = new Uint8Array(0)
+
+// What the log held at its last completed flush
+interface LogState {
+  // Where the compressed data ends and the tail starts
+  end: number
+  // Uncompressed length and CRC-32
+  length: number
+  crc: number
+}
+
+function tail(state: LogState): Uint8Array {
+  const bytes = new Uint8Array(TAIL_SIZE)
+  const view = new DataView(bytes.buffer)
+  bytes[0] = 0x03
+  view.setUint32(2, state.crc, true)
+  view.setUint32(6, state.length % 2 ** 32, true)
+  return bytes
+}
+
+function equal(a: Uint8Array, b: Uint8Array): boolean {
+  return a.length === b.length && a.every((byte, i) => byte === b[i])
+}
+
+/**
+ * An append-only gzip file that is valid after every flush.
+ *
+ * Data is deflated as it is written, by one raw deflate context kept for
+ * the life of the log, and each flush is a sync flush appended where the
+ * tail was. So a flush costs its own compressed bytes plus a new 10-byte
+ * tail and one 24-byte state slot in the header; nothing written before is
+ * read back or rewritten, and unlike gzlog.c the data is never stored and
+ * compressed again later. Reopening starts a fresh window, which costs a
+ * little compression at the first flush after it.
+ *
+ * A flush writes the data and tail, syncs, then writes the older state
+ * slot and syncs again. If a crash interrupts it, opening the log goes
+ * back to the newest intact slot and rewrites that state's tail, which
+ * drops only the flush that never completed. One writer at a time: there
+ * is no locking across processes.
+ */
+export class ZlibGzipLog {
+  private ctx: number
+  // Deflated output not yet in storage, and the input it covers
+  private pending: Uint8Array[] = []
+  private unflushed = 0
+  private crc: number
+  private queue: Promise<unknown> = Promise.resolve()
+
+  constructor(
+    private readonly module: ZlibModule,
+    private readonly pool: HeapBufferPool,
+    private readonly storage: ZlibLogStorage,
+    private state: LogState,
+    // Slot holding state; the next flush writes the other one
+    private slot: number,
+    private readonly flushSize: number,
+    ctx: number,
+    // Set when opening had to undo an interrupted flush
+    readonly recovered: boolean
+  ) {
+    if (!ctx) {
+      throw new ZlibMemoryError('Failed to initialize log deflate stream')
+    }
+    this.ctx = ctx
+    this.crc = state.crc
+  }
+
+  /** Uncompressed bytes written, flushed or not */
+  get length(): number {
+    return this.state.length + this.unflushed
+  }
+
+  /** Bytes of the gzip file in storage */
+  get size(): number {
+    return this.state.end + TAIL_SIZE
+  }
+
+  /**
+   * Append data. It is deflated at once and flushed to storage when
+   * flushSize bytes have built up; with the default of 0 every write is
+   * flushed, and durable when the returned promise resolves.
+   */
+  write(data: Uint8Array): Promise<void> {
+    return this.serialize(async () => {
+      this.checkOpen()
+      if (data.length === 0) return
+      this.pending.push(this.deflate(data, Z_NO_FLUSH))
+      this.unflushed += data.length
+      if (this.unflushed >= this.flushSize) await this.commit()
+    })
+  }
+
+  /** Flush everything written so far to storage */
+  flush(): Promise<void> {
+    return this.serialize(async () => {
+      this.checkOpen()
+      await this.commit()
+    })
+  }
+
+  /** Flush, then free the deflate context */
+  close(): Promise<void> {
+    return this.serialize(async () => {
+      if (!this.ctx) return
+      try {
+        await this.commit()
+      } finally {
+        this.dispose()
+      }
+    })
+  }
+
+  /** Free the deflate context, dropping anything not yet flushed */
+  dispose(): void {
+    if (!this.ctx) return
+    this.module._zlib_deflate_end(this.ctx)
+    this.ctx = 0
+    this.pending = []
+    this.unflushed = 0
+  }
+
+  // Operations run one at a time, in call order
+  private serialize<T>(operation: () => Promise<T>): Promise<T> {
+    const result = this.queue.then(operation)
+    this.queue = result.catch(() => {})
+    return result
+  }
+
+  private async commit(): Promise<void> {
+    if (this.unflushed === 0) return
+
+    // Kept in pending until stored, so a failed write can be retried
+    this.pending.push(this.deflate(EMPTY, Z_SYNC_FLUSH))
+    const data = concatChunks(this.pending)
+    const next = { end: this.state.end + data.length, length: this.length, crc: this.crc }
+
+    const bytes = new Uint8Array(data.length + TAIL_SIZE)
+    bytes.set(data)
+    bytes.set(tail(next), data.length)
+    await this.storage.write(this.state.end, bytes)
+    await this.storage.sync?.()
+
+    const slot = this.slot ^ 1
+    await this.storage.write(SLOTS_AT + slot * SLOT_SIZE, encodeSlot(this.module, this.pool, next))
+    await this.storage.sync?.()
+
+    this.state = next
+    this.slot = slot
+    this.pending = []
+    this.unflushed = 0
+  }
+
+  /** Raw-deflate data, folding it into the running CRC-32 */
+  private deflate(data: Uint8Array, flush: number): Uint8Array {
+    const input = this.pool.acquire(data.length).write(data)
+    const output = this.pool.acquire(CHUNK_SIZE)
+    const chunks: Uint8Array[] = []
+
+    try {
+      if (data.length > 0) {
+        this.crc = this.module._zlib_crc32(this.crc, input.ptr, data.length) >>> 0
+      }
+
+      let consumed = 0
+      for (;;) {
+        const result = this.module._zlib_deflate_process(
+          this.ctx, input.ptr + consumed, input.length - consumed, output.ptr, output.capacity, flush)
+        if (result !== Z_OK && result !== Z_BUF_ERROR) {
+          throw new ZlibCompressionError(`Compression failed with code: ${result}`)
+        }
+
+        const availOut = this.module._zlib_stream_avail_out(this.ctx)
+        consumed = input.length - this.module._zlib_stream_avail_in(this.ctx)
+
+        const produced = output.capacity - availOut
+        if (produced > 0) {
+          chunks.push(this.module.HEAPU8.slice(output.ptr, output.ptr + produced))
+        }
+
+        // Output space left over means zlib has taken all the input it can
+        if (availOut !== 0 || result === Z_BUF_ERROR) break
+      }
+    } finally {
+      this.pool.release(input)
+      this.pool.release(output)
+    }
+
+    return concatChunks(chunks)
+  }
+
+  private checkOpen(): void {
+    if (!this.ctx) throw new ZlibMemoryError('Gzip log has been closed')
+  }
+}
+
+// CRC-32 of a slot's first 20 bytes, which it stores in its last four
+function slotCheck(module: ZlibModule, pool: HeapBufferPool, slot: Uint8Array): number {
+  const buffer = pool.acquire(SLOT_SIZE).write(slot.subarray(0, SLOT_SIZE - 4))
+  try {
+    return module._zlib_crc32(0, buffer.ptr, buffer.length) >>> 0
+  } finally {
+    pool.release(buffer)
+  }
+}
+
+function encodeSlot(module: ZlibModule, pool: HeapBufferPool, state: LogState): Uint8Array {
+  const slot = new Uint8Array(SLOT_SIZE)
+  const view = new DataView(slot.buffer)
+  view.setUint32(0, state.end % 2 ** 32, true)
+  view.setUint32(4, Math.floor(state.end / 2 ** 32), true)
+  view.setUint32(8, state.length % 2 ** 32, true)
+  view.setUint32(12, Math.floor(state.length / 2 ** 32), true)
+  view.setUint32(16, state.crc, true)
+  view.setUint32(20, slotCheck(module, pool, slot), true)
+  return slot
+}
+
+function decodeSlot(module: ZlibModule, pool: HeapBufferPool, slot: Uint8Array): LogState | null {
+  const view = new DataView(slot.buffer, slot.byteOffset, SLOT_SIZE)
+  if (view.getUint32(20, true) !== slotCheck(module, pool, slot)) return null
+
+  const end = view.getUint32(0, true) + view.getUint32(4, true) * 2 ** 32
+  if (end < HEADER_SIZE) return null
+  return {
+    end,
+    length: view.getUint32(8, true) + view.getUint32(12, true) * 2 ** 32,
+    crc: view.getUint32(16, true)
+  }
+}
+
+// gzip header: deflate, FEXTRA, no time, unknown OS; then the subfield
+function header(module: ZlibModule, pool: HeapBufferPool, state: LogState): Uint8Array {
+  const bytes = new Uint8Array(HEADER_SIZE)
+  bytes.set([0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff])
+  bytes.set([(4 + 2 * SLOT_SIZE) & 0xff, 0, 0x7a, 0x6c, (2 * SLOT_SIZE) & 0xff, 0], 10)
+  const slot = encodeSlot(module, pool, state)
+  bytes.set(slot, SLOTS_AT)
+  bytes.set(slot, SLOTS_AT + SLOT_SIZE)
+  return bytes
+}
+
+/**
+ * Open the log in storage, creating it if storage is empty and undoing an
+ * interrupted flush if there is one
+ */
+export async function openGzipLog(
+  module: ZlibModule,
+  pool: HeapBufferPool,
+  storage: ZlibLogStorage,
+  options: ZlibLogOptions
+): Promise<ZlibGzipLog> {
+  const size = await storage.size()
+  let state: LogState = { end: HEADER_SIZE, length: 0, crc: 0 }
+  let slot = 0
+  let recovered = false
+
+  if (size === 0) {
+    const bytes = new Uint8Array(HEADER_SIZE + TAIL_SIZE)
+    bytes.set(header(module, pool, state))
+    bytes.set(tail(state), HEADER_SIZE)
+    await storage.write(0, bytes)
+    await storage.sync?.()
+  } else {
+    const bytes = await storage.read(0, HEADER_SIZE)
+    const expected = header(module, pool, state)
+    if (bytes.length < HEADER_SIZE || !equal(bytes.subarray(0, SLOTS_AT), expected.subarray(0, SLOTS_AT))) {
+      throw new ZlibCompressionError('Not a gzip log')
+    }
+
+    // The newest intact slot; the end offset only ever grows
+    const slots = [0, 1].map(i => decodeSlot(module, pool, bytes.subarray(SLOTS_AT + i * SLOT_SIZE)))
+    slot = slots[1] && (!slots[0] || slots[1].end > slots[0].end) ? 1 : 0
+    if (!slots[slot] || slots[slot]!.end > size) {
+      throw new ZlibCompressionError('Gzip log state is corrupt')
+    }
+    state = slots[slot]!
+
+    const end = tail(state)
+    if (size !== state.end + TAIL_SIZE || !equal(await storage.read(state.end, TAIL_SIZE), end)) {
+      await storage.write(state.end, end)
+      await storage.truncate(state.end + TAIL_SIZE)
+      await storage.sync?.()
+      recovered = true
+    }
+  }
+
+  const ctx = module._zlib_deflate_init(
+    options.level ?? 6, -15, options.memLevel ?? 8, options.strategy ?? 0
+  )
+  return new ZlibGzipLog(module, pool, storage, state, slot, options.flushSize ?? 0, ctx, recovered)
+}
+
+/** Log storage in a growable Uint8Array, for tests and in-memory logs */
+export class MemoryLogStorage implements ZlibLogStorage {
+  private buffer: Uint8Array
+  private used: number
+
+  constructor(initial: Uint8Array = new Uint8Array(0)) {
+    this.buffer = initial.slice()
+    this.used = initial.length
+  }
+
+  /** The stored bytes (no copy) */
+  get bytes(): Uint8Array {
+    return this.buffer.subarray(0, this.used)
+  }
+
+  size(): number {
+    return this.used
+  }
+
+  read(position: number, length: number): Uint8Array {
+    return this.buffer.slice(Math.min(position, this.used), Math.min(position + length, this.used))
+  }
+
+  write(position: number, data: Uint8Array): void {
+    const end = position + data.length
+    if (end > this.buffer.length) {
+      const grown = new Uint8Array(Math.max(end, this.buffer.length * 2))
+      grown.set(this.buffer.subarray(0, this.used))
+      this.buffer = grown
+    }
+    if (position > this.used) this.buffer.fill(0, this.used, position)
+    this.buffer.set(data, position)
+    this.used = Math.max(this.used, end)
+  }
+
+  truncate(length: number): void {
+    this.used = Math.min(this.used, length)
+  }
+}
+
+// The parts of Deno.FsFile the file adapter uses
+interface LogFile {
+  seek(offset: number, whence: number): Promise<number>
+  read(buffer: Uint8Array): Promise<number | null>
+  write(data: Uint8Array): Promise<number>
+  truncate(length?: number): Promise<void>
+  stat(): Promise<{ size: number }>
+  syncData(): Promise<void>
+}
+
+/** Log storage over a file opened read-write (Deno.open) */
+export function fileLogStorage(file: LogFile): ZlibLogStorage {
+  return {
+    size: async () => (await file.stat()).size,
+    async read(position, length) {
+      const buffer = new Uint8Array(length)
+      await file.seek(position, 0)
+      let got = 0
+      while (got < length) {
+        const n = await file.read(buffer.subarray(got))
+        if (n === null) break
+        got += n
+      }
+      return buffer.subarray(0, got)
+    },
+    async write(position, data) {
+      await file.seek(position, 0)
+      for (let done = 0; done < data.length;) {
+        done += await file.write(data.subarray(done))
+      }
+    },
+    truncate: length => file.truncate(length),
+    sync: () => file.syncData()
+  }
+}
+
+/** Log storage over an OPFS sync access handle, in a worker */
+export function accessHandleLogStorage(handle: ZlibSyncAccessHandle): ZlibLogStorage {
+  return {
+    size: () => handle.getSize(),
+    read(position, length) {
+      const buffer = new Uint8Array(length)
+      return buffer.subarray(0, handle.read(buffer, { at: position }))
+    },
+    write(position, data) {
+      for (let done = 0; done < data.length;) {
+        done += handle.write(data.subarray(done), { at: position + done })
+      }
+    },
+    truncate: length => handle.truncate(length),
+    sync: () => handle.flush()
+  }
+}
@@ -0,0 +1,135 @@
+/**
+ * zlib.wasm heap buffers
+ * Reusable regions of the WASM heap for the zero-copy compress/decompress API
+ */
+
+import { ZlibMemoryError } from './types.ts'
+import type { ZlibModule } from './types.ts'
+
+// Smallest pooled region; requests are rounded up to a power of two
+const MIN_CAPACITY = 64
+
+// Released regions kept per size class before they are returned to malloc
+const MAX_FREE_PER_CLASS = 8
+
+/**
+ * A region of the WASM heap owned by the caller until released.
+ *
+ * Views are derived from HEAPU8 on every access: any call that grows the
+ * heap detaches previously taken views, so re-read `view` after each
+ * compress/decompress instead of holding on to it.
+ */
+export class ZlibHeapBuffer {
+  /** Number of valid bytes at the start of the region */
+  length = 0
+
+  constructor(
+    private readonly module: ZlibModule,
+    readonly ptr: number,
+    readonly capacity: number
+  ) {}
+
+  /** The valid bytes, as a view into the heap (no copy) */
+  get view(): Uint8Array {
+    return this.module.HEAPU8.subarray(this.ptr, this.ptr + this.length)
+  }
+
+  /** The whole writable region, for filling the buffer in place */
+  get region(): Uint8Array {
+    return this.module.HEAPU8.subarray(this.ptr, this.ptr + this.capacity)
+  }
+
+  /** Copy data into the region and set length to data.length */
+  write(data: Uint8Array): this {
+    if (data.length > this.capacity) {
+      throw new ZlibMemoryError(
+        `Data (${data.length} bytes) exceeds heap buffer capacity (${this.capacity} bytes)`
+      )
+    }
+    this.module.HEAPU8.set(data, this.ptr)
+    this.length = data.length
+    return this
+  }
+}
+
+/**
+ * Power-of-two size-class pool of heap regions, plus the scratch cells used
+ * for the `unsigned long*` and `unsigned char**` out-arguments of the
+ * buffer exports.
+ */
+export class HeapBufferPool {
+  private readonly free = new Map<number, number[]>()
+  private lengthCell = 0
+
+  constructor(private readonly module: ZlibModule) {}
+
+  acquire(size: number): ZlibHeapBuffer {
+    let capacity = MIN_CAPACITY
+    while (capacity < size) capacity *= 2
+
+    const ptr = this.free.get(capacity)?.pop() ?? this.module._malloc(capacity)
+    if (!ptr) {
+      throw new ZlibMemoryError(`Failed to allocate ${capacity} bytes on the WASM heap`)
+    }
+    return new ZlibHeapBuffer(this.module, ptr, capacity)
+  }
+
+  release(buffer: ZlibHeapBuffer): void {
+    const list = this.free.get(buffer.capacity) ?? []
+    if (list.length < MAX_FREE_PER_CLASS) {
+      list.push(buffer.ptr)
+      this.free.set(buffer.capacity, list)
+    } else {
+      this.module._free(buffer.ptr)
+    }
+    buffer.length = 0
+  }
+
+  /** Pointer to a persistent 8-byte cell for output-length arguments */
+  get lengthPtr(): number {
+    if (!this.lengthCell) {
+      this.lengthCell = this.module._malloc(16)
+    }
+    return this.lengthCell
+  }
+
+  /** Pointer to a persistent cell for output-pointer arguments */
+  get pointerPtr(): number {
+    return this.lengthPtr + 8
+  }
+
+  /** The unsigned long in the length cell, 8 bytes wide on memory64 */
+  get length(): number {
+    return this.readCell(this.lengthPtr)
+  }
+
+  set length(value: number) {
+    const cell = this.lengthPtr / 4
+    this.module.HEAP32[cell] = value % 2 ** 32
+    if (this.module.memory64) {
+      this.module.HEAP32[cell + 1] = Math.floor(value / 2 ** 32)
+    }
+  }
+
+  /** The pointer in the pointer cell */
+  get pointer(): number {
+    return this.readCell(this.pointerPtr)
+  }
+
+  private readCell(ptr: number): number {
+    const low = this.module.HEAP32[ptr / 4] >>> 0
+    return this.module.memory64 ? low + (this.module.HEAP32[ptr / 4 + 1] >>> 0) * 2 ** 32 : low
+  }
+
+  /** Return every pooled region to malloc */
+  dispose(): void {
+    for (const list of this.free.values()) {
+      for (const ptr of list) this.module._free(ptr)
+    }
+    this.free.clear()
+    if (this.lengthCell) {
+      this.module._free(this.lengthCell)
+      this.lengthCell = 0
+    }
+  }
+}
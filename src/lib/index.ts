@@ -12,35 +12,194 @@ import {
   ZlibError,
   ZlibMemoryError,
   ZlibCompressionError,
+  ZlibLimitError,
   ZlibInitError
 } from './types.ts'
+import { hasInflateLimits, inflateLimit, limitError } from './limits.ts'
+import { HeapBufferPool, ZlibHeapBuffer } from './heap.ts'
+import { createZlibTransform, streamBuffer, initDeflate, ZlibInflater, ZlibCodec, ZlibDeflateStream, DEFAULT_CHUNK_SIZE } from './stream.ts'
+import { DEFAULT_LOADING_OPTIONS, loadBuild } from './loader.ts'
+import { ZlibCore } from './core.ts'
+import { ZlibCompressCache } from './cache.ts'
+import {
+  ZlibWorkerPool,
+  MIN_BLOCK_SIZE,
+  MAX_BLOCK_SIZE,
+  DICTIONARY_SIZE,
+  zlibHeader,
+  gzipHeader
+} from './parallel.ts'
+import type { BlockCheck, WorkerTask } from './parallel.ts'
+import { ZlibDictionary, trainDictionary, MAX_DICTIONARY_SIZE } from './dictionary.ts'
+import {
+  ZlibDictionaryRegistry,
+  decodeDictionaries,
+  encodeDictionaries,
+  presetDictionaryId,
+  sharedCopy
+} from './registry.ts'
+import { ZlibIndex, buildIndex } from './access.ts'
+import { PerMessageDeflate, perMessageDeflateMemory } from './permessage.ts'
+import { ZipWriter, ZlibZipReader, inflateZipEntry, Z_STORED, Z_DEFLATED } from './zip.ts'
+import {
+  ZlibGzipLog,
+  MemoryLogStorage,
+  openGzipLog,
+  fileLogStorage,
+  accessHandleLogStorage
+} from './gzlog.ts'
+import { ZlibGzipFile, openGzipFile } from './gzfile.ts'
+import { Crc32Hasher, Adler32Hasher } from './checksum.ts'
+import { ZlibBgzfReader, compressBgzf, openBgzf } from './bgzf.ts'
+import { parseGzipHeader, gzipMembers } from './gzinfo.ts'
+import { inflateBack } from './infback.ts'
+import { readTar, tarBlocks, chunkStream } from './tar.ts'
+import {
+  profileGrid,
+  measureProfileConfig,
+  paretoFrontier,
+  recommendProfile,
+  DEFAULT_PROFILE_MIN_RUNS,
+  DEFAULT_PROFILE_MIN_TIME
+} from './profile.ts'
 import type {
   ZlibModule,
   ZlibOptions,
+  ZlibDecompressOptions,
+  ZlibDictionaryEntry,
+  ZlibInflateLimits,
+  ZlibStreamOptions,
+  ZlibChunkTiming,
+  ZlibAdaptiveLevel,
+  ZlibLevelChange,
+  ZlibMemoryProfile,
+  ZlibParallelOptions,
+  ZlibParallelDecompressOptions,
+  ZlibWorkerRunOptions,
+  ZlibWorkerOptions,
+  ZlibBlockResult,
+  ZlibBatchResult,
+  ZlibZipEntry,
+  ZlibZipOptions,
+  ZlibZipStreamEntry,
+  ZlibZipStreamOptions,
+  ZlibZipEntryLocation,
+  ZlibUnzipOptions,
+  ZlibIndexSource,
+  ZlibIndexOptions,
+  ZlibBgzfOptions,
+  ZlibBgzfResult,
+  ZlibBackPull,
+  ZlibBackPush,
+  ZlibTarEntry,
+  ZlibTarEntryType,
+  ZlibTarStreamEntry,
+  ZlibPerMessageDeflateOptions,
+  ZlibLogStorage,
+  ZlibLogOptions,
+  ZlibSyncAccessHandle,
+  ZlibGzipFileOptions,
+  ZlibAutoChoice,
+  ZlibGzipHeader,
+  ZlibGzipHeaderInfo,
+  ZlibGzipMember,
   ZlibResult,
   ZlibCapabilities,
+  ZlibMemoryUsage,
+  ZlibCompressCacheStats,
+  ZlibStats,
+  ZlibPhaseStats,
+  ZlibProfileConfig,
+  ZlibProfilePoint,
+  ZlibProfileOptions,
+  ZlibProfile,
   ZlibLoadingOptions,
   CompressionPerformance,
   BenchmarkResult
 } from './types.ts'
 
+// zlib_stats_t in src/zlib_stats.h: {calls, time_ms, bytes} for each of eight
+// phases, then the chain histogram, all doubles
+const STATS_PHASES = 8
+const STATS_CHAIN_BUCKETS = 16
+
+// Output assumed for a decompress() of unknown size, as a multiple of the
+// input, when checking it against the memory budget
+const ASSUMED_INFLATE_RATIO = 4
+
+// What zlib_decompress_limit_alloc() returns for output past its limit
+const Z_BUF_ERROR = -5
+
+// crc32Parallel() slices: each worker gets at least 1 MB, and at most 8 MB
+// of the input is copied out per worker at a time
+const MIN_CHECKSUM_SLICE = 1024 * 1024
+const MAX_CHECKSUM_SLICE = 8 * 1024 * 1024
+
+// ISIZE from the trailer of gzip input (the size modulo 2^32 of its last
+// member), or undefined for anything else
+function gzipSize(data: Uint8Array): number | undefined {
+  if (data.length < 18 || data[0] !== 0x1f || data[1] !== 0x8b) return undefined
+  const end = data.length
+  return (data[end - 4] | data[end - 3] << 8 | data[end - 2] << 16 | data[end - 1] << 24) >>> 0
+}
+
+// zlib_compress_format() format codes
+const FORMAT_CODES = { zlib: 0, gzip: 1, raw: 2 }
+
+// Output an rsync boundary can add, as RSYNC_OVERHEAD in wasm_module.c
+const RSYNC_OVERHEAD = 10
+
+// options.format, or the one windowBits selects the way deflateInit2() reads
+// it, with the bare window size (0 to size it to the input)
+function deflateFormat(options: ZlibOptions): { format: 'zlib' | 'gzip' | 'raw', windowBits: number } {
+  const bits = options.windowBits ?? 0
+  if (options.format) return { format: options.format, windowBits: Math.abs(bits) & 15 }
+  if (bits < 0) return { format: 'raw', windowBits: -bits }
+  if (bits > 15) return { format: 'gzip', windowBits: bits - 16 }
+  return { format: 'zlib', windowBits: bits }
+}
+
+// deflateInit2() windowBits for a stream context in options' format
+function deflateWindowBits(options: ZlibOptions): number {
+  const { format, windowBits } = deflateFormat(options)
+  const bits = windowBits || 15
+  return format === 'raw' ? -bits : format === 'gzip' ? bits + 16 : bits
+}
+
 export default class Zlib {
   private module: ZlibModule | null = null
   private initialized = false
   private loadingOptions: ZlibLoadingOptions
+  private heapPool: HeapBufferPool | null = null
+  private workerPool: ZlibWorkerPool | null = null
+  private compressCache: ZlibCompressCache | null = null
+  // Registered dictionaries, kept across cleanup() and recycle() and
+  // reloaded into the new heap on first use
+  private readonly dictionaryRegistry = new ZlibDictionaryRegistry(
+    bytes => this.loadDictionary(bytes),
+    dictionary => this.releaseDictionary(dictionary)
+  )
+  private readonly sharedDictionaries = () => this.dictionaryRegistry.list()
+  private capabilities: ZlibCapabilities | null = null
+  private compiled: WebAssembly.Module | null = null
+  // Whether results report SIMD acceleration, settled once at initialize()
+  private simdAccelerated = false
+  // Memory budget bookkeeping for memoryUsage(): the largest heap of any
+  // module recycle() has retired, and how often the budget forced streaming
+  private retiredHeapBytes = 0
+  private streamedCalls = 0
+  private recycles = 0
 
   constructor(options: ZlibLoadingOptions = {}) {
     this.loadingOptions = {
-      cdnUrl: 'https://cdn.discere.cloud/npm/@discere-os/zlib.wasm/',
-      fallbackUrls: [
-        'https://cdn.jsdelivr.net/npm/@discere-os/zlib.wasm/',
-        'https://unpkg.com/@discere-os/zlib.wasm/'
-      ],
-      cachingEnabled: true,
+      ...DEFAULT_LOADING_OPTIONS,
       simdOptimizations: true,
       maxMemoryMB: 256,
       ...options
     }
+    if (this.loadingOptions.compressCacheMB) {
+      this.compressCache = new ZlibCompressCache(this.loadingOptions.compressCacheMB * 1024 * 1024)
+    }
   }
 
   /**
@@ -50,19 +209,22 @@ export default class Zlib {
     if (this.initialized) return
 
     try {
-      // Load WASM module with CDN fallback
-      const moduleFactory = await this.loadWASMModule()
-      this.module = await moduleFactory({
-        wasmBinary: await this.loadWasmBinary()
-      })
-
-      // Verify WASM functions available
-      const requiredFunctions = [
-        '_zlib_compress_buffer',
-        '_zlib_decompress_buffer',
-        '_zlib_crc32',
-        '_zlib_adler32'
-      ]
+      // Load WASM module with CDN fallback, instantiating a module compiled
+      // once per host rather than once per instance
+      const build = await loadBuild(this.loadingOptions, this.artifactName)
+      this.module = build.module
+      this.compiled = build.compiled
+
+      // Verify WASM functions available; the core has decompression only
+      const requiredFunctions = this.variant === 'core'
+        ? ['_zlib_decompress_dict_alloc', '_zlib_crc32', '_zlib_adler32']
+        : [
+            '_zlib_compress_buffer',
+            '_zlib_decompress_buffer',
+            '_zlib_decompress_dict_alloc',
+            '_zlib_crc32',
+            '_zlib_adler32'
+          ]
 
       if (!this.module) {
         throw new ZlibInitError('WASM module is null after initialization')
@@ -74,6 +236,9 @@ export default class Zlib {
         }
       }
 
+      this.heapPool = new HeapBufferPool(this.module)
+      this.simdAccelerated = !!this.loadingOptions.simdOptimizations &&
+                             (this.module._zlib_simd_capabilities?.() || 0) > 0
       this.initialized = true
       console.log('✅ zlib.wasm initialized with SIMD optimizations')
     } catch (error) {
@@ -83,69 +248,163 @@ export default class Zlib {
   }
 
   /**
-   * Compress data with optimal settings
+   * Compress data with optimal settings. With loadingOptions.compressCacheMB
+   * an input compressed before with the same options comes back from the
+   * cache, a copy of the earlier output, without entering WASM.
    */
   async compress(
     data: Uint8Array,
     options: ZlibOptions = {}
   ): Promise<ZlibResult> {
+    if (!this.compressCache) return this.compressOnce(data, options)
+
+    const startTime = performance.now()
+    const key = this.compressCache.key(data, options)
+    const cached = this.compressCache.get(key, data)
+    if (cached) {
+      return { ...cached, processingTime: performance.now() - startTime }
+    }
+
+    const result = await this.compressOnce(data, options)
+    this.compressCache.set(key, data, result)
+    return result
+  }
+
+  /**
+   * What the compress() cache holds and its hits and misses, or null
+   * without loadingOptions.compressCacheMB
+   */
+  compressCacheStats(): ZlibCompressCacheStats | null {
+    return this.compressCache?.stats() ?? null
+  }
+
+  /** Drop every cached compress() result; the counters are kept */
+  clearCompressCache(): void {
+    this.compressCache?.clear()
+  }
+
+  private async compressOnce(data: Uint8Array, options: ZlibOptions): Promise<ZlibResult> {
     if (!this.initialized) {
       await this.initialize()
     }
 
     const startTime = performance.now()
+    const { format, windowBits } = deflateFormat(options)
+    if (options.dictionary && format !== 'zlib') {
+      throw new ZlibCompressionError('A preset dictionary needs the zlib format')
+    }
+
+    // Anything but a dictionary or auto goes through deflateInit2() in the
+    // requested format, header and all, on builds that export it; rsyncable
+    // takes precedence over auto
+    const formatted = !options.dictionary && !(options.auto && format === 'zlib' && !options.rsyncable) &&
+                      typeof this.module!._zlib_compress_format === 'function'
+    if (options.rsyncable && (options.dictionary || typeof this.module!._zlib_rsync_boundaries !== 'function')) {
+      throw new ZlibCompressionError(options.dictionary
+        ? 'rsyncable does not combine with a preset dictionary'
+        : `The ${this.variant} build has no rsyncable mode`)
+    }
+    if (!formatted && (format !== 'zlib' || options.header)) {
+      throw new ZlibCompressionError(`The ${this.variant} build only compresses to the zlib format`)
+    }
+    const name = options.header?.name ? new TextEncoder().encode(options.header.name) : null
+
+    // Over budget, the data goes through a stream context in slices instead
+    const bound = formatted
+      ? this.module!._zlib_compress_format_bound!(data.length, FORMAT_CODES[format], windowBits,
+                                                  options.memLevel ?? 0, name?.length ?? 0)
+      : this.module!._zlib_compress_bound?.(data.length) || Math.ceil(data.length * 1.1) + 12
+    if (this.exceedsBudget(data.length + bound, !options.dictionary && !options.header)) {
+      return this.compressStreamed(data, options, startTime)
+    }
+
+    let input: ZlibHeapBuffer | null = null
+    let output: ZlibHeapBuffer | null = null
+    let choice: ZlibHeapBuffer | null = null
+    let extra: ZlibHeapBuffer | null = null
 
     try {
-      // Allocate input buffer
-      const inputPtr = this.module!._malloc(data.length)
-      this.module!.HEAPU8.set(data, inputPtr)
+      // Pooled heap regions and the persistent length cell: a small message
+      // costs no malloc/free, only the copy in and the copy out
+      input = this.heapPool!.acquire(data.length).write(data)
 
       // Calculate maximum output buffer size
-      const maxOutputSize = this.module!._zlib_compress_bound?.(data.length) ||
-                            Math.ceil(data.length * 1.1) + 12
-
-      // Allocate output buffer
-      const outputPtr = this.module!._malloc(maxOutputSize)
+      // A dictionary adds its 4-byte id to the zlib header, and every rsync
+      // boundary up to RSYNC_OVERHEAD bytes of flush
+      const boundaries = options.rsyncable ? this.module!._zlib_rsync_boundaries!(input.ptr, data.length) : 0
+      const maxOutputSize = bound + (options.dictionary ? 4 : 0) + RSYNC_OVERHEAD * boundaries
+      output = this.heapPool!.acquire(maxOutputSize)
 
-      // Allocate space for the output length (unsigned long*)
-      const outputLenPtr = this.module!._malloc(8) // 8 bytes for unsigned long
-      this.module!.HEAP32[outputLenPtr / 4] = maxOutputSize
+      // Output length (unsigned long*)
+      const outputLenPtr = this.heapPool!.lengthPtr
+      this.heapPool!.length = output.capacity
 
-      // Perform compression with SIMD acceleration when available
-      // SIMD accelerates hash calculation, string matching, and memory ops within standard zlib
       const level = options.level || ZlibCompression.DEFAULT_COMPRESSION
-      const simdEnabled = this.loadingOptions.simdOptimizations &&
-                         this.getCapabilities().simdSupported
-
-      const result = this.module!._zlib_compress_buffer(
-        inputPtr,
-        data.length,
-        outputPtr,
-        outputLenPtr,
-        level
-      )
+
+      // { level, strategy, entropy in millibits } from the auto probe
+      choice = options.auto && !formatted && !options.dictionary && format === 'zlib' ? this.heapPool!.acquire(12) : null
+
+      // The checksum cell (an unsigned long), then the NUL-terminated name
+      extra = formatted ? this.heapPool!.acquire(8 + (name ? name.length + 1 : 0)) : null
+      if (extra && name) {
+        this.module!.HEAPU8.set(name, extra.ptr + 8)
+        this.module!.HEAPU8[extra.ptr + 8 + name.length] = 0
+      }
+
+      const result = choice
+        ? this.module!._zlib_compress_auto(input.ptr, data.length, output.ptr, outputLenPtr, choice.ptr)
+        : extra
+        ? this.module!._zlib_compress_format!(
+            input.ptr,
+            data.length,
+            output.ptr,
+            outputLenPtr,
+            level,
+            options.strategy ?? ZlibStrategy.DEFAULT_STRATEGY,
+            FORMAT_CODES[format],
+            windowBits,
+            options.memLevel ?? 0,
+            name ? extra.ptr + 8 : 0,
+            options.header?.mtime ?? 0,
+            options.rsyncable ? 1 : 0,
+            extra.ptr
+          )
+        : options.dictionary
+        ? this.module!._zlib_compress_snapshot(
+            this.dictionarySnapshot(options.dictionary, level),
+            input.ptr,
+            data.length,
+            output.ptr,
+            outputLenPtr
+          )
+        : this.module!._zlib_compress_buffer(
+            input.ptr,
+            data.length,
+            output.ptr,
+            outputLenPtr,
+            level
+          )
+
+      let auto: ZlibAutoChoice | undefined
+      if (choice) {
+        const cells = this.module!.HEAP32.subarray(choice.ptr / 4, choice.ptr / 4 + 3)
+        auto = { level: cells[0], strategy: cells[1], entropy: cells[2] / 1000 }
+      }
 
       if (result !== 0) {
         throw new ZlibCompressionError(`Compression failed with code: ${result}`)
       }
 
       // Get the actual compressed size
-      const compressedSize = this.module!.HEAP32[outputLenPtr / 4]
+      const compressedSize = this.heapPool!.length
 
       if (compressedSize === 0) {
         throw new ZlibCompressionError('Compression failed - no output generated')
       }
 
       // Copy compressed data
-      const compressedData = new Uint8Array(compressedSize)
-      compressedData.set(
-        this.module!.HEAPU8.subarray(outputPtr, outputPtr + compressedSize)
-      )
-
-      // Free memory
-      this.module!._free(inputPtr)
-      this.module!._free(outputPtr)
-      this.module!._free(outputLenPtr)
+      const compressedData = this.module!.HEAPU8.slice(output.ptr, output.ptr + compressedSize)
+      const checksum = extra ? this.module!.HEAP32[extra.ptr / 4] >>> 0 : undefined
 
       const endTime = performance.now()
       const processingTime = endTime - startTime
@@ -156,67 +415,264 @@ export default class Zlib {
         compressedSize,
         compressionRatio: data.length / compressedSize,
         processingTime,
-        simdAccelerated: simdEnabled
+        simdAccelerated: this.simdAccelerated,
+        auto,
+        checksum
       }
     } catch (error) {
       const errorMessage = error instanceof Error ? error.message : String(error);
       throw new ZlibCompressionError(`Compression failed: ${errorMessage}`)
+    } finally {
+      if (input) this.heapPool!.release(input)
+      if (output) this.heapPool!.release(output)
+      if (choice) this.heapPool!.release(choice)
+      if (extra) this.heapPool!.release(extra)
     }
   }
 
   /**
-   * Decompress zlib data
+   * Compress many small messages in one WASM call. Inputs are packed into a
+   * single heap region with an offset table and compressed by one reused
+   * deflate context; each message becomes its own zlib stream.
    */
-  async decompress(data: Uint8Array): Promise<ZlibResult> {
+  async compressBatch(
+    buffers: Uint8Array[],
+    options: ZlibOptions = {}
+  ): Promise<ZlibBatchResult> {
     if (!this.initialized) {
       await this.initialize()
     }
 
     const startTime = performance.now()
+    const count = buffers.length
+    const total = buffers.reduce((n, buffer) => n + buffer.length, 0)
+
+    // One table region: count + 1 input offsets, then count + 1 output offsets
+    const input = this.heapPool!.acquire(total)
+    const tables = this.heapPool!.acquire((count + 1) * 8)
+    const inTable = tables.ptr / 4
+    const outTable = inTable + count + 1
+    let output: ZlibHeapBuffer | null = null
 
     try {
-      // Allocate input buffer
-      const inputPtr = this.module!._malloc(data.length)
-      this.module!.HEAPU8.set(data, inputPtr)
-
-      // Estimate output buffer size (be very generous to avoid Z_BUF_ERROR)
-      // Start with 20x, but ensure minimum 64KB for larger compressed files
-      const estimatedSize = Math.max(data.length * 20, 64 * 1024)
-      const outputPtr = this.module!._malloc(estimatedSize)
-
-      // Allocate space for the output length (unsigned long*)
-      const outputLenPtr = this.module!._malloc(8) // 8 bytes for unsigned long
-      this.module!.HEAP32[outputLenPtr / 4] = estimatedSize
-
-      // Perform decompression
-      const result = this.module!._zlib_decompress_buffer(
-        inputPtr,
-        data.length,
-        outputPtr,
-        outputLenPtr
+      let offset = 0
+      for (let i = 0; i < count; i++) {
+        this.module!.HEAPU8.set(buffers[i], input.ptr + offset)
+        this.module!.HEAP32[inTable + i] = offset
+        offset += buffers[i].length
+      }
+      this.module!.HEAP32[inTable + count] = offset
+
+      output = this.heapPool!.acquire(this.module!._zlib_compress_batch_bound(tables.ptr, count))
+
+      const result = this.module!._zlib_compress_batch(
+        input.ptr,
+        tables.ptr,
+        count,
+        output.ptr,
+        output.capacity,
+        outTable * 4,
+        options.level ?? ZlibCompression.DEFAULT_COMPRESSION
       )
 
       if (result !== 0) {
-        throw new ZlibCompressionError(`Decompression failed with code: ${result}`)
+        throw new ZlibCompressionError(`Batch compression failed with code: ${result}`)
       }
 
-      // Get the actual decompressed size
-      const decompressedSize = this.module!.HEAP32[outputLenPtr / 4]
+      const offsets = new Uint32Array(
+        this.module!.HEAP32.subarray(outTable, outTable + count + 1)
+      )
+      const data = this.module!.HEAPU8.slice(output.ptr, output.ptr + offsets[count])
 
-      if (decompressedSize === 0) {
-        throw new ZlibCompressionError('Decompression failed - no output generated')
+      return {
+        data,
+        offsets,
+        processingTime: performance.now() - startTime
       }
+    } finally {
+      this.heapPool!.release(input)
+      this.heapPool!.release(tables)
+      if (output) this.heapPool!.release(output)
+    }
+  }
 
-      // Copy decompressed data
-      const decompressedData = new Uint8Array(decompressedSize)
-      decompressedData.set(
-        this.module!.HEAPU8.subarray(outputPtr, outputPtr + decompressedSize)
+  /**
+   * Decompress many small zlib or gzip streams in one WASM call, the
+   * counterpart of compressBatch(). The streams come as separate buffers or
+   * packed as compressBatch() returns them. One inflate context decodes
+   * them all in turn, so streams with the same Huffman trees reuse the
+   * decoding tables. options.expectedSize is the total decompressed size,
+   * if known.
+   */
+  async decompressBatch(
+    streams: Uint8Array[] | Pick<ZlibBatchResult, 'data' | 'offsets'>,
+    options: Pick<ZlibDecompressOptions, 'expectedSize'> = {}
+  ): Promise<ZlibBatchResult> {
+    if (!this.initialized) {
+      await this.initialize()
+    }
+    if (typeof this.module!._zlib_decompress_batch !== 'function') {
+      throw new ZlibCompressionError(`The ${this.variant} build has no batch decompression`)
+    }
+
+    const startTime = performance.now()
+    const packed = Array.isArray(streams) ? null : streams
+    const buffers = Array.isArray(streams) ? streams : []
+    const count = packed ? packed.offsets.length - 1 : buffers.length
+    const total = packed ? packed.data.length : buffers.reduce((n, buffer) => n + buffer.length, 0)
+
+    // One table region: count + 1 input offsets, then count + 1 output offsets
+    const input = this.heapPool!.acquire(total)
+    const tables = this.heapPool!.acquire((count + 1) * 8)
+    const inTable = tables.ptr / 4
+    const outTable = inTable + count + 1
+
+    try {
+      if (packed) {
+        this.module!.HEAPU8.set(packed.data, input.ptr)
+        this.module!.HEAP32.set(packed.offsets, inTable)
+      } else {
+        let offset = 0
+        for (let i = 0; i < count; i++) {
+          this.module!.HEAPU8.set(buffers[i], input.ptr + offset)
+          this.module!.HEAP32[inTable + i] = offset
+          offset += buffers[i].length
+        }
+        this.module!.HEAP32[inTable + count] = offset
+      }
+
+      const result = this.module!._zlib_decompress_batch(
+        input.ptr,
+        tables.ptr,
+        count,
+        options.expectedSize ?? 0,
+        this.heapPool!.pointerPtr,
+        this.heapPool!.lengthPtr,
+        outTable * 4
+      )
+      if (result !== 0) {
+        throw new ZlibCompressionError(
+          `Batch decompression failed at message ${this.heapPool!.length} with code: ${result}`
+        )
+      }
+
+      const outputPtr = this.heapPool!.pointer
+      const offsets = new Uint32Array(
+        this.module!.HEAP32.subarray(outTable, outTable + count + 1)
       )
+      const data = this.module!.HEAPU8.slice(outputPtr, outputPtr + this.heapPool!.length)
+      this.module!._free(outputPtr)
+
+      return {
+        data,
+        offsets,
+        processingTime: performance.now() - startTime
+      }
+    } finally {
+      this.heapPool!.release(input)
+      this.heapPool!.release(tables)
+    }
+  }
+
+  /**
+   * Decompress zlib or gzip data. Concatenated gzip members, as pigz and
+   * joined log files produce, decode as one output in the same call.
+   *
+   * The output is allocated once at the decompressed size when it is known:
+   * from options.expectedSize, or from the ISIZE trailer of gzip input.
+   * Otherwise the output grows as needed, so no size guess can fail.
+   * Calls whose output would push the heap past maxMemoryMB are inflated
+   * through a stream context instead.
+   *
+   * For untrusted input, options.maxOutputSize and options.maxRatio stop
+   * the inflate with a ZlibLimitError as soon as the output passes them.
+   * The output buffer is then never sized past the limit, whatever
+   * expectedSize or the gzip trailer claims.
+   *
+   * zlib input whose header names a preset dictionary needs no
+   * options.dictionary when one with that id is registered.
+   */
+  async decompress(data: Uint8Array, options: ZlibDecompressOptions = {}): Promise<ZlibResult> {
+    if (!this.initialized) {
+      await this.initialize()
+    }
+
+    const startTime = performance.now()
+
+    // zlib input naming a dictionary takes the one registered under its id
+    if (!options.dictionary) {
+      const id = presetDictionaryId(data)
+      if (id !== null) {
+        const dictionary = this.dictionaryById(id)
+        if (!dictionary) {
+          throw new ZlibCompressionError(
+            `Input needs preset dictionary 0x${id.toString(16).padStart(8, '0')}, which is not registered`
+          )
+        }
+        options = { ...options, dictionary }
+      }
+    }
+
+    const limited = hasInflateLimits(options)
+    const limit = inflateLimit(options, data.length)
+    if (limited && typeof this.module!._zlib_decompress_limit_alloc !== 'function') {
+      throw new ZlibCompressionError(`The ${this.variant} build has no inflate limits`)
+    }
+
+    const outputSize = Math.min(limit, options.expectedSize ?? gzipSize(data) ?? data.length * ASSUMED_INFLATE_RATIO)
+    if (this.exceedsBudget(data.length + outputSize, !options.dictionary && this.variant !== 'core')) {
+      return this.decompressStreamed(data, startTime, options)
+    }
+
+    try {
+      const input = this.heapPool!.acquire(data.length).write(data)
+
+      const pointerPtr = this.heapPool!.pointerPtr
+      const lengthPtr = this.heapPool!.lengthPtr
+
+      // Perform decompression into a right-sized heap allocation
+      const result = limited
+        ? this.module!._zlib_decompress_limit_alloc!(
+            input.ptr,
+            data.length,
+            options.dictionary?.ptr ?? 0,
+            options.dictionary?.length ?? 0,
+            options.expectedSize ?? 0,
+            // 0 is no limit to the export; a zero limit is checked below
+            Math.min(Math.max(limit, 1), this.module!.memory64 ? Number.MAX_SAFE_INTEGER : 0xffffffff),
+            pointerPtr,
+            lengthPtr
+          )
+        : this.module!._zlib_decompress_dict_alloc(
+            input.ptr,
+            data.length,
+            options.dictionary?.ptr ?? 0,
+            options.dictionary?.length ?? 0,
+            options.expectedSize ?? 0,
+            pointerPtr,
+            lengthPtr
+          )
+      this.heapPool!.release(input)
+
+      if (limited && result === Z_BUF_ERROR) {
+        throw limitError(options, data.length, limit + 1)
+      }
+      if (result !== 0) {
+        throw new ZlibCompressionError(`Decompression failed with code: ${result}`)
+      }
+
+      const outputPtr = this.heapPool!.pointer
+      const decompressedSize = this.heapPool!.length
+      if (decompressedSize > limit) {
+        this.module!._free(outputPtr)
+        throw limitError(options, data.length, decompressedSize)
+      }
+
+      // Copy decompressed data
+      const decompressedData = this.module!.HEAPU8.slice(outputPtr, outputPtr + decompressedSize)
 
       // Free memory
-      this.module!._free(inputPtr)
       this.module!._free(outputPtr)
-      this.module!._free(outputLenPtr)
 
       const endTime = performance.now()
       const processingTime = endTime - startTime
@@ -227,261 +683,1695 @@ export default class Zlib {
         compressedSize: data.length,
         compressionRatio: decompressedSize / data.length,
         processingTime,
-        simdAccelerated: this.loadingOptions.simdOptimizations &&
-                         this.getCapabilities().simdSupported
+        simdAccelerated: this.simdAccelerated
       }
     } catch (error) {
+      if (error instanceof ZlibLimitError) throw error
       const errorMessage = error instanceof Error ? error.message : String(error);
       throw new ZlibCompressionError(`Decompression failed: ${errorMessage}`)
     }
   }
 
   /**
-   * Calculate CRC32 checksum
+   * Join gzip files into one gzip member without recompressing (library
+   * form of examples/gzjoin.c). Each buffer holds one or more whole
+   * members; their deflate data is copied through with only the final-block
+   * bit cleared, and the trailer's CRC-32 is combined from theirs. The
+   * members are still inflated, with the output discarded, to find each
+   * final block, so the cost is an inflate pass rather than a deflate.
    */
-  crc32(data: Uint8Array): number {
+  gzjoin(buffers: Uint8Array[]): Uint8Array {
     if (!this.initialized) {
       throw new ZlibError('zlib.wasm not initialized')
     }
 
-    const inputPtr = this.module!._malloc(data.length)
-    this.module!.HEAPU8.set(data, inputPtr)
+    // The buffers are packed back to back: a run of members, as the module expects
+    const total = buffers.reduce((n, buffer) => n + buffer.length, 0)
+    const input = this.heapPool!.acquire(total)
+    const output = this.heapPool!.acquire(this.module!._zlib_gzjoin_bound(total))
+
+    try {
+      let offset = 0
+      for (const buffer of buffers) {
+        this.module!.HEAPU8.set(buffer, input.ptr + offset)
+        offset += buffer.length
+      }
 
-    const crc = this.module!._zlib_crc32(inputPtr, data.length)
+      const lengthPtr = this.heapPool!.lengthPtr
+      this.module!.HEAP32[lengthPtr / 4] = output.capacity
+      const result = this.module!._zlib_gzjoin(input.ptr, total, output.ptr, lengthPtr)
+      if (result !== 0) {
+        throw new ZlibCompressionError(`gzip join failed with code: ${result}`)
+      }
 
-    this.module!._free(inputPtr)
-    return crc
+      const length = this.module!.HEAP32[lengthPtr / 4] >>> 0
+      return this.module!.HEAPU8.slice(output.ptr, output.ptr + length)
+    } finally {
+      this.heapPool!.release(input)
+      this.heapPool!.release(output)
+    }
   }
 
   /**
-   * Calculate Adler32 checksum
+   * Header of the gzip member at the start of data, read in place: no
+   * WASM and no inflate, so it works before initialize(). For the
+   * uncompressed size of a single-member file, see gzipMembers() or the
+   * ISIZE in its last four bytes.
    */
-  adler32(data: Uint8Array): number {
-    if (!this.initialized) {
-      throw new ZlibError('zlib.wasm not initialized')
+  readGzipHeader(data: Uint8Array): ZlibGzipHeaderInfo {
+    const header = parseGzipHeader(data)
+    if (!header) {
+      throw new ZlibCompressionError('Not a gzip header, or it is truncated')
     }
+    return header
+  }
 
-    const inputPtr = this.module!._malloc(data.length)
-    this.module!.HEAPU8.set(data, inputPtr)
-
-    const adler = this.module!._zlib_adler32(inputPtr, data.length)
+  /**
+   * List every member of gzip data with its header, offset, length, CRC-32
+   * and ISIZE, without any output. BGZF members are stepped over by the
+   * length in their header; others are inflated with the output dropped
+   * to find where they end, at inflate speed but without any output
+   * buffer or copy. The ISIZEs add up to the decompressed size (each
+   * modulo 4 GB).
+   */
+  async gzipMembers(data: Uint8Array): Promise<ZlibGzipMember[]> {
+    if (!this.initialized) {
+      await this.initialize()
+    }
+    if (typeof this.module!._zlib_gzip_members !== 'function') {
+      throw new ZlibCompressionError(`The ${this.variant} build cannot list gzip members`)
+    }
+    return gzipMembers(this.module!, this.heapPool!, data)
+  }
 
-    this.module!._free(inputPtr)
-    return adler
+  /**
+   * compress() on a pool worker, so a large input does not hold up this
+   * thread. The input is copied to the worker, or with options.transfer
+   * moved there and detached here; the output comes back moved, not
+   * copied. Calls queue by options.priority behind other worker tasks,
+   * and options.signal cancels one queued or running. A dictionary must
+   * be registered (registerDictionary()), and goes to the worker by id.
+   */
+  async compressInWorker(
+    data: Uint8Array,
+    options: ZlibOptions & ZlibWorkerOptions = {}
+  ): Promise<ZlibResult> {
+    const { workers, transfer, priority, signal, dictionary, ...zlibOptions } = options
+    const dictionaryId = this.workerDictionaryId(dictionary, 'compress()')
+    return this.runInWorker<ZlibResult>(workers, { priority, signal }, () => ({
+      type: 'compress',
+      data: transfer ? data : data.slice(),
+      options: zlibOptions,
+      dictionaryId
+    }))
   }
 
   /**
-   * Get SIMD capabilities and performance info
+   * decompress() on a pool worker, as compressInWorker() does for compress();
+   * inflate limits apply in the worker as they would here
    */
-  getCapabilities(): ZlibCapabilities {
-    if (!this.initialized) {
-      throw new ZlibError('zlib.wasm not initialized')
+  async decompressInWorker(
+    data: Uint8Array,
+    options: ZlibDecompressOptions & ZlibWorkerOptions = {}
+  ): Promise<ZlibResult> {
+    const { workers, transfer, priority, signal, dictionary, ...zlibOptions } = options
+    const dictionaryId = this.workerDictionaryId(dictionary, 'decompress()')
+    return this.runInWorker<ZlibResult>(workers, { priority, signal }, () => ({
+      type: 'decompress',
+      data: transfer ? data : data.slice(),
+      options: zlibOptions,
+      dictionaryId
+    }))
+  }
+
+  // A dictionary reaches a worker by id, so only a registered one can go
+  private workerDictionaryId(dictionary: ZlibDictionary | undefined, call: string): number | undefined {
+    if (!dictionary) return undefined
+    if (!this.dictionaryRegistry.holds(dictionary)) {
+      throw new ZlibCompressionError(`A preset dictionary is bound to this instance; register it or use ${call}`)
     }
+    return dictionary.id
+  }
 
-    // Check SIMD capabilities - the function returns an integer
-    const simdCapabilitiesValue = this.module!._zlib_simd_capabilities?.() || 0
-    const simdSupported = simdCapabilitiesValue > 0
+  // One task on the worker pool. A running pool is kept unless workers asks
+  // for more, so calls in flight are not cut off by a later one's size
+  private async runInWorker<T>(
+    workers: number | undefined,
+    runOptions: ZlibWorkerRunOptions,
+    makeTask: () => WorkerTask
+  ): Promise<T> {
+    if (!this.initialized) {
+      await this.initialize()
+    }
 
-    return {
-      simdSupported,
-      simdCapabilities: simdSupported ? `WASM SIMD128 (${simdCapabilitiesValue})` : 'None',
-      version: this.module!._zlib_get_version?.() || '1.4.2',
-      maxMemoryMB: this.loadingOptions.maxMemoryMB || 256,
-      compressionLevels: [0, 1, 2, 3, 4, 5, 6, 7, 8, 9],
-      strategies: Object.values(ZlibStrategy).filter(v => typeof v === 'number') as ZlibStrategy[]
+    const size = Math.max(1, workers ?? globalThis.navigator?.hardwareConcurrency ?? 4)
+    if (!this.workerPool || (workers !== undefined && this.workerPool.size < size)) {
+      this.workerPool?.terminate()
+      this.workerPool = new ZlibWorkerPool(size, this.workerLoadingOptions, this.sharedDictionaries)
     }
+    return this.workerPool.run<T>(makeTask, runOptions)
   }
 
   /**
-   * Run compression performance benchmark
+   * Compress a large buffer across a pool of workers (pigz-style). The input
+   * is split into blocks that are compressed independently, each primed with
+   * the last 32 KB of the block before it, then joined into one zlib or gzip
+   * stream that any inflater accepts. The output is determined by the input,
+   * level, format and blockSize alone, whatever the worker count.
    */
-  async benchmark(data: Uint8Array, iterations: number = 10): Promise<BenchmarkResult[]> {
+  async compressParallel(
+    data: Uint8Array,
+    options: ZlibParallelOptions = {}
+  ): Promise<ZlibResult> {
     if (!this.initialized) {
       await this.initialize()
     }
 
-    const results: BenchmarkResult[] = []
+    const startTime = performance.now()
+    const level = options.level == null || options.level < 0
+      ? ZlibCompression.DEFAULT_COMPRESSION
+      : options.level
+    const gzip = options.format === 'gzip'
+    const blockSize = Math.min(Math.max(options.blockSize ?? MIN_BLOCK_SIZE, MIN_BLOCK_SIZE), MAX_BLOCK_SIZE)
+    const blockCount = Math.max(1, Math.ceil(data.length / blockSize))
+
+    // Only the speed depends on this: blocks are cut at fixed offsets and
+    // primed from the input, and joined in order, so any worker count (or
+    // the threaded build) gives the same bytes
+    const workers = Math.max(1, Math.min(options.workers ?? globalThis.navigator?.hardwareConcurrency ?? 4, blockCount))
+
+    // The -pthread build compresses in place on the shared heap instead
+    if (!gzip && typeof this.module!._zlib_compress_parallel === 'function') {
+      return this.compressThreaded(data, level, blockSize, workers, startTime)
+    }
 
-    // Compression benchmark
-    const compressStart = performance.now()
-    let compressedData: Uint8Array
-    let simdUsed = false
+    if (!this.workerPool || this.workerPool.size < workers) {
+      this.workerPool?.terminate()
+      this.workerPool = new ZlibWorkerPool(workers, this.workerLoadingOptions, this.sharedDictionaries)
+    }
 
-    for (let i = 0; i < iterations; i++) {
-      const result = await this.compress(data)
-      compressedData = result.data
-      simdUsed = result.simdAccelerated
+    try {
+      const check: BlockCheck = gzip ? 'crc32' : 'adler32'
+      const pending: Promise<ZlibBlockResult>[] = []
+
+      for (let i = 0; i < blockCount; i++) {
+        const start = i * blockSize
+        const end = Math.min(start + blockSize, data.length)
+        pending.push(this.workerPool.run<ZlibBlockResult>(() => ({
+          type: 'block',
+          block: data.slice(start, end),
+          dictionary: start > 0 ? data.slice(Math.max(0, start - DICTIONARY_SIZE), start) : null,
+          level,
+          last: i === blockCount - 1,
+          check
+        })))
+      }
+      const blocks = await Promise.all(pending)
+
+      // Fold the per-block checksums into the checksum of the whole input
+      let sum = blocks[0].check
+      for (let i = 1; i < blockCount; i++) {
+        const len = Math.min(blockSize, data.length - i * blockSize)
+        sum = gzip
+          ? this.module!._zlib_crc32_combine(sum, blocks[i].check, len) >>> 0
+          : this.module!._zlib_adler32_combine(sum, blocks[i].check, len) >>> 0
+      }
+
+      const header = gzip ? gzipHeader(level) : zlibHeader(level)
+      const trailer = new Uint8Array(gzip ? 8 : 4)
+      const trailerView = new DataView(trailer.buffer)
+      if (gzip) {
+        trailerView.setUint32(0, sum, true)
+        trailerView.setUint32(4, data.length >>> 0, true)
+      } else {
+        trailerView.setUint32(0, sum, false)
+      }
+
+      const total = blocks.reduce((n, block) => n + block.data.length, header.length + trailer.length)
+      const output = new Uint8Array(total)
+      output.set(header, 0)
+      let offset = header.length
+      for (const block of blocks) {
+        output.set(block.data, offset)
+        offset += block.data.length
+      }
+      output.set(trailer, offset)
+
+      const processingTime = performance.now() - startTime
+
+      return {
+        data: output,
+        originalSize: data.length,
+        compressedSize: output.length,
+        compressionRatio: data.length / output.length,
+        processingTime,
+        simdAccelerated: this.simdAccelerated
+      }
+    } catch (error) {
+      const errorMessage = error instanceof Error ? error.message : String(error);
+      throw new ZlibCompressionError(`Parallel compression failed: ${errorMessage}`)
     }
+  }
 
-    const compressEnd = performance.now()
-    const compressTime = compressEnd - compressStart
+  /**
+   * Build a ZIP archive. Each entry is deflated on its own, to raw deflate
+   * data plus its CRC-32, on the worker pool (or the module's thread pool in
+   * the -pthread build); the module's minizip writer then only writes local
+   * headers, data and the central directory, in entry order, so thousands
+   * of files compress in parallel. Entries that would not shrink are stored.
+   */
+  async createZip(entries: ZlibZipEntry[], options: ZlibZipOptions = {}): Promise<ZlibResult> {
+    if (!this.initialized) {
+      await this.initialize()
+    }
 
-    results.push({
-      operation: 'compression',
-      iterations,
-      totalTime: compressTime,
-      averageTime: compressTime / iterations,
-      throughput: (data.length * iterations / 1024 / 1024) / (compressTime / 1000),
-      simdAccelerated: simdUsed
-    })
+    const startTime = performance.now()
+    const level = options.level == null || options.level < 0
+      ? ZlibCompression.DEFAULT_COMPRESSION
+      : options.level
+    const modified = new Date()
+    const workers = Math.min(options.workers ?? globalThis.navigator?.hardwareConcurrency ?? 4, entries.length)
+    const writer = new ZipWriter(this.module!, this.heapPool!)
 
-    // Decompression benchmark
-    if (compressedData!) {
-      const decompressStart = performance.now()
+    try {
+      if (workers > 1 && level > 0 && typeof this.module!._zlib_zip_add_parallel === 'function') {
+        writer.addParallel(entries, level, modified, workers)
+      } else if (workers > 1 && level > 0) {
+        if (!this.workerPool || this.workerPool.size < workers) {
+          this.workerPool?.terminate()
+          this.workerPool = new ZlibWorkerPool(workers, this.workerLoadingOptions, this.sharedDictionaries)
+        }
 
-      for (let i = 0; i < iterations; i++) {
-        const result = await this.decompress(compressedData)
-        simdUsed = result.simdAccelerated
+        // A whole entry is one final block with no dictionary: a raw deflate stream
+        const pending = entries.map(entry => this.workerPool!.run<ZlibBlockResult>(() => ({
+          type: 'block',
+          block: entry.data.slice(),
+          dictionary: null,
+          level,
+          last: true,
+          check: 'crc32'
+        })))
+        // A failure is reported where its entry is awaited, not as unhandled
+        for (const block of pending) block.catch(() => {})
+
+        // Written in order as they finish, while later entries compress
+        for (let i = 0; i < entries.length; i++) {
+          const entry = entries[i]
+          const block = await pending[i]
+          const stored = block.data.length >= entry.data.length
+          writer.addDeflated(
+            entry.name,
+            stored ? entry.data : block.data,
+            entry.data.length,
+            block.check,
+            stored ? Z_STORED : Z_DEFLATED,
+            level,
+            entry.modified ?? modified
+          )
+        }
+      } else {
+        for (const entry of entries) writer.add(entry, level, entry.modified ?? modified)
       }
 
-      const decompressEnd = performance.now()
-      const decompressTime = decompressEnd - decompressStart
+      const output = writer.finish(options.comment)
+      const originalSize = entries.reduce((n, entry) => n + entry.data.length, 0)
 
-      results.push({
-        operation: 'decompression',
-        iterations,
-        totalTime: decompressTime,
-        averageTime: decompressTime / iterations,
-        throughput: (data.length * iterations / 1024 / 1024) / (decompressTime / 1000),
-        simdAccelerated: simdUsed
-      })
+      return {
+        data: output,
+        originalSize,
+        compressedSize: output.length,
+        compressionRatio: originalSize / output.length,
+        processingTime: performance.now() - startTime,
+        simdAccelerated: this.simdAccelerated
+      }
+    } catch (error) {
+      writer.abort()
+      const errorMessage = error instanceof Error ? error.message : String(error);
+      throw new ZlibCompressionError(`ZIP creation failed: ${errorMessage}`)
     }
+  }
 
-    return results
+  /**
+   * Stream a ZIP archive, e.g. as an HTTP response body. Entries are
+   * deflated one after another as the stream is read, each ending in a data
+   * descriptor so nothing already sent is revisited; chunked entry data is
+   * deflated as it arrives. Only the output of the current entry or chunk
+   * is held, however large the archive grows.
+   */
+  createZipStream(
+    entries: Iterable<ZlibZipStreamEntry> | AsyncIterable<ZlibZipStreamEntry>,
+    options: ZlibZipStreamOptions = {}
+  ): ReadableStream<Uint8Array> {
+    const parts = this.zipStreamParts(entries, options)
+    return new ReadableStream<Uint8Array>({
+      async pull(controller) {
+        const { value, done } = await parts.next()
+        if (done) {
+          controller.close()
+        } else {
+          controller.enqueue(value)
+        }
+      },
+      async cancel() {
+        await parts.return(undefined)
+      }
+    })
   }
 
   /**
-   * Cleanup resources
+   * Open a ZIP archive for reading. It is copied into the WASM heap once
+   * and read there by minizip, with no file system in between; dispose() the
+   * reader to free it.
    */
-  cleanup(): void {
-    if (this.module) {
-      this.module!._zlib_cleanup?.()
-      this.module = null
+  openZip(bytes: Uint8Array): ZlibZipReader {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
     }
-    this.initialized = false
+
+    const archive = this.heapPool!.acquire(bytes.length).write(bytes)
+    return new ZlibZipReader(this.module!, this.heapPool!, archive)
   }
 
   /**
-   * Load WASM module with CDN fallback logic
+   * Extract the named entries of a ZIP archive concurrently. minizip reads
+   * one entry at a time, so the reader only locates each entry's data; the
+   * -pthread build then inflates them on the module's threads straight
+   * from one heap copy of the archive, and otherwise each goes to a worker
+   * as its compressed bytes plus location. null marks names not in the
+   * archive.
    */
-  private async loadWASMModule(): Promise<any> {
-    const fallbackUrls = this.loadingOptions.fallbackUrls || []
-    const urls = [this.loadingOptions.cdnUrl, ...fallbackUrls]
+  async extractZip(
+    bytes: Uint8Array,
+    names: string[],
+    options: ZlibUnzipOptions = {}
+  ): Promise<(Uint8Array | null)[]> {
+    if (!this.initialized) {
+      await this.initialize()
+    }
 
-    for (const baseUrl of urls) {
-      try {
-        const moduleUrl = `${baseUrl}install/wasm/zlib-release.js`
-
-        // Try to load from local file first (development)
-        try {
-          // Use dynamic import with absolute path to avoid TypeScript module resolution
-          const modulePath = new URL('./../../install/wasm/zlib-release.js', import.meta.url).href
-          const localModule = await import(modulePath) as any
-          return localModule.default
-        } catch {
-          // Fall back to CDN
-          const moduleFactory = await import(moduleUrl)
-          return moduleFactory.default
-        }
-      } catch (error) {
-        const errorMessage = error instanceof Error ? error.message : String(error);
-        console.warn(`Failed to load from ${baseUrl}: ${errorMessage}`)
-      }
-    }
-
-    throw new ZlibInitError('Failed to load zlib.wasm from all sources')
-  }
-
-  private async loadWasmBinary(): Promise<ArrayBuffer> {
-    // Try local build paths first (for Deno and Node.js testing)
-    // @ts-ignore - Deno global may not exist in all environments
-    if (typeof globalThis.Deno !== 'undefined') {
-      // Deno environment - use Deno.readFile
-      const localPaths = [
-        './install/wasm/zlib-release.wasm',          // Dual build system main module
-        './install/wasm/zlib.wasm',                  // Legacy path
-        './build-dual-main-release/zlib-release.wasm', // Direct build output
-        './build/zlib-release.wasm'                  // Fallback location
-      ]
-
-      for (const localPath of localPaths) {
-        try {
-          const wasmBuffer = await Deno.readFile(localPath)
-          console.log(`✅ Loaded zlib.wasm binary from: ${localPath}`)
-          return wasmBuffer.buffer
-        } catch (error) {
-          console.log(`⚠️ Failed to load WASM from ${localPath}:`, (error as Error).message)
-          continue
-        }
+    const workers = Math.min(options.workers ?? globalThis.navigator?.hardwareConcurrency ?? 4, names.length)
+    const reader = this.openZip(bytes)
+
+    try {
+      if (workers <= 1) return reader.extractMany(names)
+      if (typeof this.module!._zlib_unzip_extract_parallel === 'function') {
+        return reader.extractParallel(names, workers)
       }
-    }
 
-    // @ts-ignore - process global may not exist in all environments
-    if (typeof globalThis.process !== 'undefined' && globalThis.process?.versions?.node) {
-      // Node.js environment
-      const { readFile } = await import('fs/promises')
-      const { fileURLToPath } = await import('url')
-      const path = await import('path')
-
-      const localPaths = [
-        '../../../install/wasm/zlib-release.wasm',   // Dual build system main module
-        '../../../install/wasm/zlib.wasm',           // Legacy path
-        '../../../build-dual-main-release/zlib-release.wasm', // Direct build output
-        '../../../build/zlib-release.wasm'           // Fallback location
-      ]
-
-      for (const localPath of localPaths) {
-        try {
-          const filePath = path.resolve(fileURLToPath(import.meta.url), localPath)
-          const wasmBuffer = await readFile(filePath)
-          console.log(`✅ Loaded zlib.wasm binary from: ${localPath}`)
-          return new ArrayBuffer(wasmBuffer.byteLength).constructor === ArrayBuffer
-            ? wasmBuffer.buffer as ArrayBuffer
-            : new Uint8Array(wasmBuffer).buffer
-        } catch (error) {
-          console.log(`⚠️ Failed to load WASM from ${localPath}:`, (error as Error).message)
-          continue
-        }
+      if (!this.workerPool || this.workerPool.size < workers) {
+        this.workerPool?.terminate()
+        this.workerPool = new ZlibWorkerPool(workers, this.workerLoadingOptions, this.sharedDictionaries)
       }
+
+      // Every entry is located up front; its bytes are copied out once a worker is free
+      return await Promise.all(names.map(name => {
+        const location = reader.locate(name)
+        if (!location) return null
+        return this.workerPool!.run<{ data: Uint8Array }>(() => ({
+          type: 'entry',
+          compressed: reader.data(location),
+          location
+        })).then(entry => entry.data)
+      }))
+    } catch (error) {
+      const errorMessage = error instanceof Error ? error.message : String(error);
+      throw new ZlibCompressionError(`ZIP extraction failed: ${errorMessage}`)
+    } finally {
+      reader.dispose()
+    }
+  }
+
+  /** Output of createZipStream(), one piece per entry or chunk */
+  private async *zipStreamParts(
+    entries: Iterable<ZlibZipStreamEntry> | AsyncIterable<ZlibZipStreamEntry>,
+    options: ZlibZipStreamOptions
+  ): AsyncGenerator<Uint8Array> {
+    if (!this.initialized) {
+      await this.initialize()
     }
 
-    // Try CDN loading for production use
-    const fallbackUrls = this.loadingOptions.fallbackUrls || []
-    const urls = [this.loadingOptions.cdnUrl, ...fallbackUrls]
+    const level = options.level == null || options.level < 0
+      ? ZlibCompression.DEFAULT_COMPRESSION
+      : options.level
+    const modified = new Date()
+    const writer = new ZipWriter(this.module!, this.heapPool!, 0, true)
 
-    for (const url of urls) {
-      if (!url) continue
-      try {
-        const wasmUrl = url.endsWith('/') ? `${url}zlib.wasm` : `${url}/zlib.wasm`
-        const response = await fetch(wasmUrl)
-        if (response.ok) {
-          console.log(`✅ Loaded zlib.wasm binary from CDN: ${url}`)
-          return await response.arrayBuffer()
+    try {
+      for await (const entry of entries) {
+        const date = entry.modified ?? modified
+        if (entry.data instanceof Uint8Array) {
+          writer.add({ name: entry.name, data: entry.data }, level, date)
+        } else {
+          writer.begin(entry.name, level, date, (entry.size ?? 0) >= 0xffffffff)
+          for await (const chunk of entry.data) {
+            writer.write(chunk)
+            const part = writer.take()
+            if (part.length) yield part
+          }
+          writer.end()
         }
-      } catch (error) {
-        console.warn(`Failed to load WASM from CDN ${url}:`, error)
-        continue
+
+        const part = writer.take()
+        if (part.length) yield part
       }
+      yield writer.finish(options.comment)
+    } catch (error) {
+      const errorMessage = error instanceof Error ? error.message : String(error);
+      throw new ZlibCompressionError(`ZIP streaming failed: ${errorMessage}`)
+    } finally {
+      writer.abort()
     }
+  }
+
+  /**
+   * Inflate one ZIP entry's data from ZlibZipReader.data() (worker side of
+   * extractZip())
+   */
+  inflateZipEntry(compressed: Uint8Array, location: ZlibZipEntryLocation): Uint8Array {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+    return inflateZipEntry(this.module!, this.heapPool!, compressed, location)
+  }
+
+  /**
+   * Read a tar.gz archive as it arrives, e.g. from a fetch() body. Entries
+   * come out one at a time, each one's data streamed straight out of the
+   * inflate stream: nothing is held beyond the chunk being read, and data
+   * left unread is skipped when the next entry is asked for. zlib-wrapped
+   * tar is read too, as createInflateStream() detects either header.
+   */
+  async *extractTarGz(
+    source: ReadableStream<Uint8Array> | AsyncIterable<Uint8Array> | Uint8Array,
+    options: ZlibStreamOptions = {}
+  ): AsyncGenerator<ZlibTarEntry> {
+    if (!this.initialized) {
+      await this.initialize()
+    }
+
+    const input = source instanceof ReadableStream ? source : chunkStream(source)
+    const reader = input.pipeThrough(this.createInflateStream(options)).getReader()
+    try {
+      yield* readTar({ next: () => reader.read() as Promise<IteratorResult<Uint8Array>> })
+    } finally {
+      // Stops the inflate stream (and the source) if the caller stopped early
+      await reader.cancel().catch(() => {})
+    }
+  }
+
+  /**
+   * Stream a tar.gz archive, written as it is read. Headers and data go
+   * through one gzip deflate stream, and chunked entry data is deflated as
+   * it arrives, so only the current chunk is held however large the
+   * archive grows. Chunked data needs its size given, as tar headers
+   * carry it up front; names past ustar's 255 bytes get a pax header.
+   */
+  createTarGzStream(
+    entries: Iterable<ZlibTarStreamEntry> | AsyncIterable<ZlibTarStreamEntry>,
+    options: ZlibStreamOptions = {}
+  ): ReadableStream<Uint8Array> {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+
+    return chunkStream(tarBlocks(entries, new Date()))
+      .pipeThrough(this.createDeflateStream({ ...options, format: 'gzip' }))
+  }
+
+  /**
+   * Decompress a large single-stream file by inflating the segments between
+   * the index's access points on separate workers, each starting from its
+   * point's saved window, and joining them in order
+   */
+  async decompressParallel(
+    data: Uint8Array,
+    index: ZlibIndex,
+    options: ZlibParallelDecompressOptions = {}
+  ): Promise<ZlibResult> {
+    if (!this.initialized) {
+      await this.initialize()
+    }
+
+    const startTime = performance.now()
+    const points = index.points
+    const workers = Math.min(options.workers ?? globalThis.navigator?.hardwareConcurrency ?? 4, points)
+
+    try {
+      let output: Uint8Array
+      if (workers <= 1) {
+        output = await index.extract(data, 0, index.length)
+      } else {
+        if (!this.workerPool || this.workerPool.size < workers) {
+          this.workerPool?.terminate()
+          this.workerPool = new ZlibWorkerPool(workers, this.workerLoadingOptions, this.sharedDictionaries)
+        }
+
+        output = new Uint8Array(index.length)
+        const pending: Promise<void>[] = []
+        for (let i = 0; i < points; i++) {
+          const { out, in: start } = index.point(i)
+          const end = i + 1 < points ? index.point(i + 1).in : data.length
+          pending.push(this.workerPool.run<{ data: Uint8Array }>(() => ({
+            type: 'segment',
+            index: index.segment(i),
+            compressed: data.slice(start, end)
+          })).then(segment => output.set(segment.data, out)))
+        }
+        await Promise.all(pending)
+      }
+
+      if (output.length !== index.length) {
+        throw new ZlibCompressionError('Data ended before the indexed length')
+      }
+
+      return {
+        data: output,
+        originalSize: output.length,
+        compressedSize: data.length,
+        compressionRatio: output.length / data.length,
+        processingTime: performance.now() - startTime,
+        simdAccelerated: this.simdAccelerated
+      }
+    } catch (error) {
+      const errorMessage = error instanceof Error ? error.message : String(error);
+      throw new ZlibCompressionError(`Parallel decompression failed: ${errorMessage}`)
+    }
+  }
+
+  /**
+   * Inflate one segment from ZlibIndex.segment() (worker side of
+   * decompressParallel())
+   */
+  async decompressSegment(segment: Uint8Array, compressed: Uint8Array): Promise<Uint8Array> {
+    if (!this.initialized) {
+      await this.initialize()
+    }
+
+    const index = this.loadIndex(segment)
+    try {
+      const data = await index.extract(compressed, 0, index.length)
+      if (data.length !== index.length) {
+        throw new ZlibCompressionError('Segment data ended early')
+      }
+      return data
+    } finally {
+      index.dispose()
+    }
+  }
+
+  /**
+   * compressParallel() on the -pthread build: one call into the module's
+   * native thread pool, with no per-block copies between worker heaps
+   */
+  private compressThreaded(
+    data: Uint8Array,
+    level: number,
+    blockSize: number,
+    threads: number,
+    startTime: number
+  ): ZlibResult {
+    const input = this.heapPool!.acquire(data.length).write(data)
+    const output = this.heapPool!.acquire(this.module!._zlib_compress_parallel_bound!(data.length))
+
+    try {
+      const lengthPtr = this.heapPool!.lengthPtr
+      this.module!.HEAP32[lengthPtr / 4] = output.capacity
+
+      const result = this.module!._zlib_compress_parallel!(
+        input.ptr,
+        input.length,
+        output.ptr,
+        lengthPtr,
+        level,
+        blockSize,
+        threads
+      )
+
+      if (result !== 0) {
+        throw new ZlibCompressionError(`Parallel compression failed with code: ${result}`)
+      }
+
+      output.length = this.module!.HEAP32[lengthPtr / 4]
+      const compressed = output.view.slice()
+
+      return {
+        data: compressed,
+        originalSize: data.length,
+        compressedSize: compressed.length,
+        compressionRatio: data.length / compressed.length,
+        processingTime: performance.now() - startTime,
+        simdAccelerated: this.simdAccelerated
+      }
+    } finally {
+      this.heapPool!.release(input)
+      this.heapPool!.release(output)
+    }
+  }
+
+  /**
+   * Compress one block of a parallel deflate stream to raw deflate data and
+   * checksum it. Used by the compression workers; most callers want
+   * compressParallel() instead.
+   */
+  compressBlock(
+    block: Uint8Array,
+    dictionary: Uint8Array | null,
+    level: number,
+    last: boolean,
+    check: BlockCheck
+  ): ZlibBlockResult {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+
+    // Dictionary and block share one heap region, dictionary first
+    const dictLength = dictionary?.length ?? 0
+    const input = this.heapPool!.acquire(dictLength + block.length)
+    const output = this.heapPool!.acquire(this.module!._zlib_compress_block_bound(block.length))
+
+    try {
+      if (dictionary) this.module!.HEAPU8.set(dictionary, input.ptr)
+      this.module!.HEAPU8.set(block, input.ptr + dictLength)
+
+      const lengthPtr = this.heapPool!.lengthPtr
+      this.module!.HEAP32[lengthPtr / 4] = output.capacity
+
+      const blockPtr = input.ptr + dictLength
+      const result = this.module!._zlib_compress_block(
+        blockPtr,
+        block.length,
+        input.ptr,
+        dictLength,
+        output.ptr,
+        lengthPtr,
+        level,
+        last ? 1 : 0
+      )
+
+      if (result !== 0) {
+        throw new ZlibCompressionError(`Block compression failed with code: ${result}`)
+      }
+
+      output.length = this.module!.HEAP32[lengthPtr / 4]
+      const sum = check === 'crc32'
+        ? this.module!._zlib_crc32(0, blockPtr, block.length) >>> 0
+        : this.module!._zlib_adler32(1, blockPtr, block.length) >>> 0
+
+      return { data: output.view.slice(), check: sum }
+    } finally {
+      this.heapPool!.release(input)
+      this.heapPool!.release(output)
+    }
+  }
+
+  /**
+   * Calculate CRC32 checksum, continuing from crc if given. The input
+   * passes through a 64 KB staging region rather than a copy of its size.
+   */
+  crc32(data: Uint8Array, crc = 0): number {
+    const hasher = this.createCrc32(crc)
+    try {
+      return hasher.update(data).digest()
+    } finally {
+      hasher.dispose()
+    }
+  }
+
+  /**
+   * Calculate Adler32 checksum, continuing from adler if given
+   */
+  adler32(data: Uint8Array, adler = 1): number {
+    const hasher = this.createAdler32(adler)
+    try {
+      return hasher.update(data).digest()
+    } finally {
+      hasher.dispose()
+    }
+  }
+
+  /**
+   * Create an incremental CRC32 for data that arrives in chunks. Every
+   * update() reuses the same staging region; dispose() it when done.
+   */
+  createCrc32(crc = 0): Crc32Hasher {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+    return new Crc32Hasher(this.module!, this.heapPool!, crc)
+  }
+
+  /**
+   * Create an incremental Adler32, as createCrc32() does
+   */
+  createAdler32(adler = 1): Adler32Hasher {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+    return new Adler32Hasher(this.module!, this.heapPool!, adler)
+  }
+
+  /**
+   * CRC32 of a followed by b, from crcA, crcB and the length of b
+   */
+  crc32Combine(crcA: number, crcB: number, lenB: number): number {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+    return this.module!._zlib_crc32_combine(crcA, crcB, lenB) >>> 0
+  }
+
+  /**
+   * Adler32 of a followed by b, from adlerA, adlerB and the length of b
+   */
+  adler32Combine(adlerA: number, adlerB: number, lenB: number): number {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+    return this.module!._zlib_adler32_combine(adlerA, adlerB, lenB) >>> 0
+  }
+
+  /**
+   * CRC32 of a large buffer, checksummed in slices across a pool of
+   * workers (or the -pthread build's threads, straight out of its heap)
+   * and merged with crc32Combine(). Slices of a SharedArrayBuffer reach
+   * the workers without a copy. Inputs under 2 MB are checksummed here.
+   */
+  async crc32Parallel(data: Uint8Array, workers?: number): Promise<number> {
+    if (!this.initialized) {
+      await this.initialize()
+    }
+
+    const count = Math.min(
+      workers ?? globalThis.navigator?.hardwareConcurrency ?? 4,
+      Math.floor(data.length / MIN_CHECKSUM_SLICE)
+    )
+    if (count <= 1) return this.crc32(data)
+
+    if (typeof this.module!._zlib_crc32_parallel === 'function') {
+      const input = this.heapPool!.acquire(data.length).write(data)
+      try {
+        return this.module!._zlib_crc32_parallel(input.ptr, data.length, count) >>> 0
+      } finally {
+        this.heapPool!.release(input)
+      }
+    }
+
+    if (!this.workerPool || this.workerPool.size < count) {
+      this.workerPool?.terminate()
+      this.workerPool = new ZlibWorkerPool(count, this.workerLoadingOptions, this.sharedDictionaries)
+    }
+
+    const shared = typeof SharedArrayBuffer !== 'undefined' && data.buffer instanceof SharedArrayBuffer
+    const slice = Math.min(Math.ceil(data.length / count), MAX_CHECKSUM_SLICE)
+    const pending: Promise<{ check: number }>[] = []
+    for (let start = 0; start < data.length; start += slice) {
+      const end = Math.min(start + slice, data.length)
+      pending.push(this.workerPool.run<{ check: number }>(() => ({
+        type: 'checksum',
+        data: shared ? data.subarray(start, end) : data.slice(start, end),
+        check: 'crc32'
+      })))
+    }
+    const sums = await Promise.all(pending)
+
+    let crc = sums[0].check
+    for (let i = 1; i < sums.length; i++) {
+      crc = this.crc32Combine(crc, sums[i].check, Math.min(slice, data.length - i * slice))
+    }
+    return crc
+  }
+
+  /**
+   * Copy a preset dictionary into the WASM heap once, for use as
+   * `options.dictionary`. Only the last 32 KB are kept, as deflate cannot
+   * reach further back.
+   */
+  loadDictionary(bytes: Uint8Array): ZlibDictionary {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+
+    const tail = bytes.subarray(Math.max(0, bytes.length - MAX_DICTIONARY_SIZE))
+    const buffer = this.heapPool!.acquire(tail.length).write(tail)
+    const id = this.module!._zlib_adler32(1, buffer.ptr, buffer.length) >>> 0
+    return new ZlibDictionary(buffer, id)
+  }
+
+  /**
+   * Train a dictionary from sample messages and load it
+   */
+  trainDictionary(samples: Uint8Array[], maxSize = MAX_DICTIONARY_SIZE): ZlibDictionary {
+    return this.loadDictionary(trainDictionary(samples, maxSize))
+  }
+
+  /**
+   * Return a dictionary's heap region to the pool
+   */
+  releaseDictionary(dictionary: ZlibDictionary): void {
+    this.dictionaryRegistry.forget(dictionary)
+    if (this.module) {
+      for (const snapshot of dictionary.snapshots.values()) {
+        this.module._zlib_ctx_release(snapshot)
+      }
+    }
+    dictionary.snapshots.clear()
+    this.heapPool?.release(dictionary.buffer)
+  }
+
+  /**
+   * Load a dictionary and register it under its Adler-32 id, for
+   * decompress() to find by the id zlib headers carry and for pool workers
+   * to use. The bytes are kept once in a SharedArrayBuffer, which every
+   * worker shares; each loads its heap copy, and primes its deflate
+   * contexts, on first use. An id already registered to other bytes is
+   * refused. Returns this instance's loaded copy.
+   */
+  registerDictionary(bytes: Uint8Array): ZlibDictionary {
+    const dictionary = this.loadDictionary(bytes)
+    const registered = this.dictionaryRegistry.resolve(dictionary.id)
+    if (registered) {
+      if (!this.dictionaryRegistry.holds(dictionary)) {
+        this.releaseDictionary(dictionary)
+        throw new ZlibError(`Dictionary id 0x${dictionary.id.toString(16).padStart(8, '0')} is already registered to different bytes`)
+      }
+      this.releaseDictionary(dictionary)
+      return registered
+    }
+
+    const entry = { id: dictionary.id, bytes: sharedCopy(dictionary.buffer.view) }
+    this.dictionaryRegistry.add(entry.id, entry.bytes)
+    this.dictionaryRegistry.adopt(dictionary)
+    this.workerPool?.shareDictionaries([entry])
+    return dictionary
+  }
+
+  /**
+   * Register dictionaries from exportDictionaries() or from entries whose
+   * bytes may be shared with other instances. Nothing is loaded until an
+   * id is used, and its Adler-32 is checked then. Returns the ids.
+   */
+  importDictionaries(source: Uint8Array | ZlibDictionaryEntry[]): number[] {
+    const entries = source instanceof Uint8Array ? decodeDictionaries(source) : source
+    const added = entries.filter(entry => this.dictionaryRegistry.add(entry.id >>> 0, entry.bytes))
+    if (added.length > 0) this.workerPool?.shareDictionaries(added)
+    return entries.map(entry => entry.id >>> 0)
+  }
+
+  /** Every registered dictionary, as one blob for importDictionaries() */
+  exportDictionaries(): Uint8Array {
+    return encodeDictionaries(this.dictionaryRegistry.list())
+  }
+
+  /**
+   * The registered dictionary with this id, loaded into this heap on first
+   * use, or null
+   */
+  dictionaryById(id: number): ZlibDictionary | null {
+    if (!this.dictionaryRegistry.has(id >>> 0)) return null
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+    return this.dictionaryRegistry.resolve(id >>> 0)
+  }
+
+  /**
+   * Deflate context primed with the dictionary at this level, created on
+   * first use so that later messages copy the hashed dictionary instead of
+   * rehashing it
+   */
+  private dictionarySnapshot(dictionary: ZlibDictionary, level: number): number {
+    let snapshot = dictionary.snapshots.get(level)
+    if (snapshot === undefined) {
+      snapshot = this.module!._zlib_dict_snapshot_create(dictionary.ptr, dictionary.length, level)
+      if (!snapshot) {
+        throw new ZlibCompressionError('Failed to load dictionary into a deflate context')
+      }
+      dictionary.snapshots.set(level, snapshot)
+    }
+    return snapshot
+  }
+
+  /**
+   * Hand out a reusable region of the WASM heap. Fill it through
+   * `buffer.region` or `buffer.write()` and pass it to compressHeap() /
+   * decompressHeap() to skip the per-call malloc and copies.
+   */
+  acquireBuffer(size: number): ZlibHeapBuffer {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+    return this.heapPool!.acquire(size)
+  }
+
+  /**
+   * Return a buffer from acquireBuffer(), compressHeap() or decompressHeap()
+   * to the pool
+   */
+  releaseBuffer(buffer: ZlibHeapBuffer): void {
+    this.heapPool?.release(buffer)
+  }
+
+  /**
+   * Compress the valid bytes of a heap buffer in place. The result is a pooled
+   * heap buffer owned by the caller; read it through `.view` and release it
+   * when done.
+   */
+  compressHeap(input: ZlibHeapBuffer, options: ZlibOptions = {}): ZlibHeapBuffer {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+
+    const output = this.heapPool!.acquire(this.module!._zlib_compress_bound(input.length))
+    const lengthPtr = this.heapPool!.lengthPtr
+    this.heapPool!.length = output.capacity
+
+    const result = this.module!._zlib_compress_buffer(
+      input.ptr,
+      input.length,
+      output.ptr,
+      lengthPtr,
+      options.level ?? ZlibCompression.DEFAULT_COMPRESSION
+    )
+
+    if (result !== 0) {
+      this.heapPool!.release(output)
+      throw new ZlibCompressionError(`Compression failed with code: ${result}`)
+    }
+
+    output.length = this.heapPool!.length
+    return output
+  }
+
+  /**
+   * Decompress the valid bytes of a heap buffer into `output`, which must be
+   * large enough for the whole result. Returns `output` with its length set.
+   */
+  decompressHeap(input: ZlibHeapBuffer, output: ZlibHeapBuffer): ZlibHeapBuffer {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+
+    const lengthPtr = this.heapPool!.lengthPtr
+    this.heapPool!.length = output.capacity
+
+    const result = this.module!._zlib_decompress_buffer(
+      input.ptr,
+      input.length,
+      output.ptr,
+      lengthPtr
+    )
+
+    if (result !== 0) {
+      throw new ZlibCompressionError(`Decompression failed with code: ${result}`)
+    }
+
+    output.length = this.heapPool!.length
+    return output
+  }
+
+  /**
+   * Index a zlib, gzip or raw deflate stream for random access. The source
+   * is read once, front to back, in readSize pieces; keep it around to
+   * extract() from later.
+   */
+  async buildIndex(source: ZlibIndexSource, options: ZlibIndexOptions = {}): Promise<ZlibIndex> {
+    if (!this.initialized) {
+      await this.initialize()
+    }
+
+    return await buildIndex(this.module!, this.heapPool!, source, options.span ?? 0, options.readSize)
+  }
+
+  /**
+   * Load an index saved with ZlibIndex.serialize()
+   */
+  loadIndex(bytes: Uint8Array, options: ZlibIndexOptions = {}): ZlibIndex {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+
+    const input = this.heapPool!.acquire(bytes.length).write(bytes)
+    const ptr = this.module!._zlib_index_load(input.ptr, input.length)
+    this.heapPool!.release(input)
+
+    if (!ptr) {
+      throw new ZlibCompressionError('Invalid or truncated index')
+    }
+    return new ZlibIndex(this.module!, this.heapPool!, ptr, options.readSize)
+  }
+
+  /**
+   * Compress to blocked gzip (BGZF), as bgzip does: independent gzip members
+   * of at most 64 KB, each with its size in a BC extra field. Any gzip
+   * reader takes the whole; result.index (bgzip's .gzi) lets openBgzf()
+   * inflate any range from the one or two members that hold it, with no
+   * windows to keep. The -pthread build writes members on its threads.
+   */
+  async compressBgzf(data: Uint8Array, options: ZlibBgzfOptions = {}): Promise<ZlibBgzfResult> {
+    if (!this.initialized) {
+      await this.initialize()
+    }
+    if (typeof this.module!._zlib_bgzf_compress !== 'function') {
+      throw new ZlibCompressionError(`The ${this.variant} build has no BGZF writer`)
+    }
+
+    const startTime = performance.now()
+    const threads = options.workers ?? globalThis.navigator?.hardwareConcurrency ?? 4
+    const { data: compressed, index } = await compressBgzf(this.module!, this.heapPool!, data, options, threads)
+    return {
+      data: compressed,
+      index,
+      originalSize: data.length,
+      compressedSize: compressed.length,
+      processingTime: performance.now() - startTime
+    }
+  }
+
+  /**
+   * Random access into BGZF data, such as compressBgzf() output or a .gz
+   * from bgzip. With its .gzi index nothing is read up front; without one,
+   * the members are walked once, reading only each header and ISIZE.
+   */
+  async openBgzf(source: ZlibIndexSource, index?: Uint8Array): Promise<ZlibBgzfReader> {
+    if (!this.initialized) {
+      await this.initialize()
+    }
+
+    return await openBgzf(this.module!, this.heapPool!, source, index)
+  }
+
+  /**
+   * Create a compressing TransformStream. Memory use is bounded by
+   * options.chunkSize however much data is piped through it; options.format
+   * (or windowBits 31) selects gzip output and 'raw' bare deflate. Small chunks, such as network reads, are
+   * gathered into whole slices before each crossing into WASM, and large
+   * ones split; pipe a ReadableStream through it with pipeThrough().
+   */
+  createDeflateStream(options: ZlibStreamOptions = {}): ZlibDeflateStream {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+
+    const level = options.level ?? ZlibCompression.DEFAULT_COMPRESSION
+    const strategy = options.strategy ?? ZlibStrategy.DEFAULT_STRATEGY
+    const adaptive = options.adaptiveLevel === true ? {} : options.adaptiveLevel || undefined
+    const ctx = initDeflate(this.module!, level, deflateWindowBits(options), options.memLevel ?? 8, strategy, options.memoryProfile)
+    try {
+      return new ZlibDeflateStream(this.module!, this.heapPool!, ctx, level, strategy, options, adaptive)
+    } catch (error) {
+      if (ctx) this.module!._zlib_deflate_end(ctx)
+      throw error
+    }
+  }
+
+  /**
+   * Create a decompressing TransformStream. zlib and gzip input are detected
+   * automatically unless options.windowBits says otherwise.
+   */
+  createInflateStream(options: ZlibStreamOptions = {}): TransformStream<Uint8Array, Uint8Array> {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+
+    const ctx = this.module!._zlib_inflate_init(options.windowBits ?? 15 + 32)
+    return createZlibTransform(this.module!, this.heapPool!, 'inflate', ctx, options)
+  }
+
+  /**
+   * Create an inflater for decompressing many short streams one after
+   * another, e.g. one per message, on a single context that keeps its
+   * window allocated between them. dispose() it when done.
+   */
+  createInflater(options: ZlibStreamOptions = {}): ZlibInflater {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+
+    const ctx = this.module!._zlib_inflate_init(options.windowBits ?? 15 + 32)
+    return new ZlibInflater(this.module!, this.heapPool!, ctx, options.chunkSize, options)
+  }
+
+  /**
+   * Create a deflate or inflate stream driven call by call, with flush()
+   * and params() between writes; the engine under the node:zlib adaptor
+   * in node.ts. members carries gzip inflate on across concatenated
+   * members. dispose() it when done.
+   */
+  createCodec(kind: 'deflate' | 'inflate', options: ZlibStreamOptions & { members?: boolean } = {}): ZlibCodec {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+    if (options.dictionary) {
+      throw new ZlibError('Codecs do not take a dictionary')
+    }
+
+    const ctx = kind === 'deflate'
+      ? initDeflate(
+        this.module!,
+        options.level ?? ZlibCompression.DEFAULT_COMPRESSION,
+        deflateWindowBits(options),
+        options.memLevel ?? 8,
+        options.strategy ?? ZlibStrategy.DEFAULT_STRATEGY,
+        options.memoryProfile
+      )
+      : this.module!._zlib_inflate_init(options.windowBits ?? 15 + 32)
+    return new ZlibCodec(this.module!, this.heapPool!, kind, ctx, options)
+  }
+
+  /**
+   * Create the permessage-deflate (RFC 7692) engine for one websocket
+   * connection, from the parameters negotiated in its handshake. dispose()
+   * it when the connection closes.
+   */
+  createPerMessageDeflate(options: ZlibPerMessageDeflateOptions = {}): PerMessageDeflate {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+    return new PerMessageDeflate(this.module!, this.heapPool!, options)
+  }
+
+  /**
+   * Bytes of zlib state each connection would hold with these
+   * permessage-deflate parameters, for sizing window bits and memLevel
+   */
+  perMessageDeflateMemory(options: ZlibPerMessageDeflateOptions = {}): number {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+    return perMessageDeflateMemory(this.module!, options)
+  }
+
+  /**
+   * Open the gzip log kept in storage for appending, creating it when
+   * storage is empty. Storage holds a valid gzip file after every flush;
+   * wrap a file with fileLogStorage() or an OPFS handle with
+   * accessHandleLogStorage().
+   */
+  async openLog(storage: ZlibLogStorage, options: ZlibLogOptions = {}): Promise<ZlibGzipLog> {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+    return openGzipLog(this.module!, this.heapPool!, storage, options)
+  }
+
+  /**
+   * Open an OPFS FileSystemSyncAccessHandle as a gzip file, in a worker:
+   * 'r' to read, 'w' to write from empty, 'a' to append a new member. The
+   * file streams through gzread()/gzwrite() with 1 MB buffers filled and
+   * drained straight from the handle, never held in memory whole.
+   */
+  openGzipFile(
+    handle: ZlibSyncAccessHandle,
+    mode: 'r' | 'w' | 'a' = 'r',
+    options: ZlibGzipFileOptions = {}
+  ): ZlibGzipFile {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+    return openGzipFile(this.module!, this.heapPool!, handle, mode, options)
+  }
+
+  /**
+   * Inflate with zlib's inflateBack(), the lowest-copy decode it has: output
+   * is never gathered, but handed to push() a window at a time as views of
+   * inflateBack()'s own 32 KB window, valid only until push() returns.
+   * Input is a buffer, an iterable of chunks, or a pull() returning the
+   * next chunk or null at the end; heap views are read in place. Every
+   * callback is synchronous. format is 'auto' (zlib or gzip) by default.
+   * Returns the number of bytes pushed.
+   */
+  inflateBack(
+    input: Uint8Array | Iterable<Uint8Array> | ZlibBackPull,
+    push: ZlibBackPush,
+    options: { format?: 'zlib' | 'gzip' | 'raw' | 'auto' } = {}
+  ): number {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+    if (typeof this.module!._zlib_inflate_back !== 'function') {
+      throw new ZlibCompressionError(`The ${this.variant} build has no inflateBack()`)
+    }
+
+    let pull: ZlibBackPull
+    if (typeof input === 'function') {
+      pull = input
+    } else if (input instanceof Uint8Array) {
+      let chunk: Uint8Array | null = input
+      pull = () => {
+        const next = chunk
+        chunk = null
+        return next
+      }
+    } else {
+      const chunks = input[Symbol.iterator]()
+      pull = () => {
+        const next = chunks.next()
+        return next.done ? null : next.value
+      }
+    }
+    return inflateBack(this.module!, this.heapPool!, pull, push, options.format ?? 'auto')
+  }
+
+  /**
+   * Get SIMD capabilities and performance info
+   */
+  getCapabilities(): ZlibCapabilities {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+
+    // Fixed for the life of the module, so built once
+    if (this.capabilities) return this.capabilities
+
+    // Check SIMD capabilities - the function returns an integer
+    const simdCapabilitiesValue = this.module!._zlib_simd_capabilities?.() || 0
+    const simdSupported = simdCapabilitiesValue > 0
+
+    this.capabilities = {
+      simdSupported,
+      simdCapabilities: simdSupported ? `WASM SIMD128 (${simdCapabilitiesValue})` : 'None',
+      version: this.module!._zlib_get_version?.() || '1.4.2',
+      maxMemoryMB: this.loadingOptions.maxMemoryMB || 256,
+      compressionLevels: [0, 1, 2, 3, 4, 5, 6, 7, 8, 9],
+      strategies: Object.values(ZlibStrategy).filter(v => typeof v === 'number') as ZlibStrategy[]
+    }
+    return this.capabilities
+  }
+
+  /**
+   * The compiled module this instance runs. Post it to a worker and pass it
+   * back as `wasmModule` to start another instance there without fetching
+   * or compiling anything.
+   */
+  get wasmModule(): WebAssembly.Module {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+    return this.compiled!
+  }
+
+  /**
+   * Heap size against the maxMemoryMB budget. A WebAssembly heap can grow
+   * but never shrink, so heapBytes is also this module's high-water mark;
+   * highWaterBytes covers the modules recycle() has replaced as well.
+   */
+  memoryUsage(): ZlibMemoryUsage {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+
+    const heapBytes = this.module!.HEAPU8.length
+    const budgetBytes = this.memoryBudget
+    return {
+      heapBytes,
+      highWaterBytes: Math.max(heapBytes, this.retiredHeapBytes),
+      budgetBytes,
+      overBudget: heapBytes > budgetBytes,
+      streamedCalls: this.streamedCalls,
+      recycles: this.recycles
+    }
+  }
+
+  /**
+   * Swap the module for a fresh instance of the same compiled build, so a
+   * heap grown by one large call goes back to the host. Nothing is fetched
+   * or compiled. Dictionaries, heap buffers, indexes, gzip files and logs
+   * opened before the call belong to the old heap and must not be used
+   * afterwards (registered dictionaries are loaded again on first use); streams already running finish on the old instance, which
+   * is released once they are.
+   */
+  async recycle(): Promise<void> {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+    // Workers of the old pthread pool cannot be shut down from here
+    if (this.variant === 'mt') {
+      throw new ZlibError('recycle() is not supported on the threaded build')
+    }
+
+    const build = await loadBuild({ ...this.loadingOptions, wasmModule: this.compiled! }, this.artifactName)
+    this.retiredHeapBytes = Math.max(this.retiredHeapBytes, this.module!.HEAPU8.length)
+    this.heapPool!.dispose()
+    this.module!._zlib_ctx_pool_drain?.()
+    this.dictionaryRegistry.unload()
+
+    this.module = build.module
+    this.heapPool = new HeapBufferPool(this.module)
+    this.recycles++
+  }
+
+  /**
+   * Read the hot-path counters of a build made with ZLIB_STATS=1, or null
+   * for any other build. The hooks read the clock around every call, so
+   * times are only comparable between instrumented runs.
+   */
+  getStats(): ZlibStats | null {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+
+    const ptr = this.module!._zlib_get_stats?.() || 0
+    if (ptr === 0) return null
+
+    const block = new Float64Array(this.module!.HEAPU8.buffer, ptr, STATS_PHASES * 3 + STATS_CHAIN_BUCKETS)
+    const phase = (i: number): ZlibPhaseStats => ({
+      calls: block[i * 3],
+      timeMs: block[i * 3 + 1],
+      bytes: block[i * 3 + 2]
+    })
+    return {
+      fillWindow: phase(0),
+      slideHash: phase(1),
+      longestMatch: phase(2),
+      flushBlock: phase(3),
+      inflateFast: phase(4),
+      inflateTable: phase(5),
+      crc32: phase(6),
+      adler32: phase(7),
+      chainHistogram: Array.from(block.subarray(STATS_PHASES * 3))
+    }
+  }
+
+  /**
+   * Zero the counters read by getStats()
+   */
+  resetStats(): void {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+    this.module!._zlib_reset_stats?.()
+  }
+
+  /**
+   * Run compression performance benchmark
+   */
+  async benchmark(data: Uint8Array, iterations: number = 10): Promise<BenchmarkResult[]> {
+    if (!this.initialized) {
+      await this.initialize()
+    }
+
+    const results: BenchmarkResult[] = []
+
+    // Compression benchmark
+    const compressStart = performance.now()
+    let compressedData: Uint8Array
+    let simdUsed = false
+
+    // Past the compress() cache, which would time nothing but hits
+    for (let i = 0; i < iterations; i++) {
+      const result = await this.compressOnce(data, {})
+      compressedData = result.data
+      simdUsed = result.simdAccelerated
+    }
+
+    const compressEnd = performance.now()
+    const compressTime = compressEnd - compressStart
+
+    results.push({
+      operation: 'compression',
+      iterations,
+      totalTime: compressTime,
+      averageTime: compressTime / iterations,
+      throughput: (data.length * iterations / 1024 / 1024) / (compressTime / 1000),
+      simdAccelerated: simdUsed
+    })
+
+    // Decompression benchmark
+    if (compressedData!) {
+      const decompressStart = performance.now()
+
+      for (let i = 0; i < iterations; i++) {
+        const result = await this.decompress(compressedData)
+        simdUsed = result.simdAccelerated
+      }
+
+      const decompressEnd = performance.now()
+      const decompressTime = decompressEnd - decompressStart
+
+      results.push({
+        operation: 'decompression',
+        iterations,
+        totalTime: decompressTime,
+        averageTime: decompressTime / iterations,
+        throughput: (data.length * iterations / 1024 / 1024) / (decompressTime / 1000),
+        simdAccelerated: simdUsed
+      })
+    }
+
+    return results
+  }
+
+  /**
+   * Find settings for a kind of data: compress and decompress a sample with
+   * every combination of level, strategy, windowBits and memLevel in options,
+   * spread over a pool of workers, and return each point's speed and ratio,
+   * the speed/ratio Pareto frontier, and the point that gets the sample over
+   * a link of options.bandwidthMBps soonest. Points are timed side by side
+   * on the workers, so compare them with each other rather than with
+   * benchmark(); pass workers: 1 for quieter figures.
+   */
+  async profile(sample: Uint8Array, options: ZlibProfileOptions = {}): Promise<ZlibProfile> {
+    if (!this.initialized) {
+      await this.initialize()
+    }
+    if (sample.length === 0) {
+      throw new ZlibError('Profile sample is empty')
+    }
+
+    const grid = profileGrid(options)
+    if (grid.length === 0) {
+      throw new ZlibError('Profile options leave nothing to measure')
+    }
+    const minRuns = options.minRuns ?? DEFAULT_PROFILE_MIN_RUNS
+    const minTime = options.minTime ?? DEFAULT_PROFILE_MIN_TIME
+    const workers = Math.min(options.workers ?? globalThis.navigator?.hardwareConcurrency ?? 4, grid.length)
+
+    if (!this.workerPool || this.workerPool.size < workers) {
+      this.workerPool?.terminate()
+      this.workerPool = new ZlibWorkerPool(workers, this.workerLoadingOptions, this.sharedDictionaries)
+    }
+
+    const points = await Promise.all(grid.map(config => this.workerPool!.run<ZlibProfilePoint>(() => ({
+      type: 'profile',
+      sample: sample.slice(),
+      config,
+      minRuns,
+      minTime
+    }))))
+
+    return {
+      sampleSize: sample.length,
+      points,
+      frontier: paretoFrontier(points),
+      recommended: recommendProfile(points, options.bandwidthMBps, options.minCompressMBps)
+    }
+  }
+
+  /**
+   * Measure one point of profile() on this module: the sample compressed
+   * and decompressed as one zlib stream with config, speeds in MB/s
+   */
+  profileConfig(
+    sample: Uint8Array,
+    config: ZlibProfileConfig,
+    minRuns = DEFAULT_PROFILE_MIN_RUNS,
+    minTime = DEFAULT_PROFILE_MIN_TIME
+  ): ZlibProfilePoint {
+    if (!this.initialized) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+    return measureProfileConfig(this.module!, this.heapPool!, sample, config, minRuns, minTime)
+  }
+
+  /**
+   * Cleanup resources
+   */
+  cleanup(): void {
+    this.workerPool?.terminate()
+    this.workerPool = null
+    this.compressCache?.clear()
+    this.dictionaryRegistry.unload()
+    this.heapPool?.dispose()
+    this.heapPool = null
+    if (this.module) {
+      this.module!._zlib_ctx_pool_drain?.()
+      this.module!._zlib_cleanup?.()
+      this.module = null
+    }
+    this.capabilities = null
+    this.compiled = null
+    this.simdAccelerated = false
+    this.retiredHeapBytes = 0
+    this.streamedCalls = 0
+    this.recycles = 0
+    this.initialized = false
+  }
+
+  private get memoryBudget(): number {
+    return (this.loadingOptions.maxMemoryMB || 256) * 1024 * 1024
+  }
+
+  /**
+   * Whether a one-shot call needing bytes more of heap could grow it past
+   * the budget. Free space inside the heap isn't visible from here, so none
+   * is assumed. Calls that cannot stream (dictionaries, the inflate-only
+   * core, which has no stream exports) fail rather than overrun it.
+   */
+  private exceedsBudget(bytes: number, streamable: boolean): boolean {
+    const over = this.module!.HEAPU8.length + bytes > this.memoryBudget
+    if (over && !streamable) {
+      throw new ZlibMemoryError(
+        `A ${bytes}-byte call exceeds the ${this.loadingOptions.maxMemoryMB || 256} MB memory budget`
+      )
+    }
+    return over
+  }
+
+  // compress() within the memory budget; auto is not probed
+  private compressStreamed(data: Uint8Array, options: ZlibOptions, startTime: number): ZlibResult {
+    const ctx = this.module!._zlib_deflate_init(
+      options.level || ZlibCompression.DEFAULT_COMPRESSION,
+      deflateWindowBits(options),
+      options.memLevel ?? 8,
+      options.strategy ?? ZlibStrategy.DEFAULT_STRATEGY
+    )
+    const compressed = streamBuffer(this.module!, this.heapPool!, 'deflate', ctx, data, {
+      chunkSize: DEFAULT_CHUNK_SIZE,
+      rsyncable: options.rsyncable
+    })
+    this.streamedCalls++
+
+    return {
+      data: compressed,
+      originalSize: data.length,
+      compressedSize: compressed.length,
+      compressionRatio: data.length / compressed.length,
+      processingTime: performance.now() - startTime,
+      simdAccelerated: this.simdAccelerated
+    }
+  }
+
+  // decompress() within the memory budget
+  private decompressStreamed(data: Uint8Array, startTime: number, limits: ZlibInflateLimits): ZlibResult {
+    const ctx = this.module!._zlib_inflate_init(15 + 32)
+    const { maxOutputSize, maxRatio } = limits
+    const decompressed = streamBuffer(this.module!, this.heapPool!, 'inflate', ctx, data, {
+      chunkSize: DEFAULT_CHUNK_SIZE,
+      maxOutputSize,
+      maxRatio
+    })
+    this.streamedCalls++
+
+    return {
+      data: decompressed,
+      originalSize: decompressed.length,
+      compressedSize: data.length,
+      compressionRatio: decompressed.length / data.length,
+      processingTime: performance.now() - startTime,
+      simdAccelerated: this.simdAccelerated
+    }
+  }
+
+  /**
+   * Build variant to load: the -pthread one when threads are requested, the
+   * one without SIMD for A/B comparisons, the 64-bit heap, or the
+   * inflate-only core
+   */
+  private get variant(): 'mt' | 'scalar' | 'memory64' | 'core' | 'release' {
+    const { threads, scalar, memory64, core } = this.loadingOptions
+    return threads ? 'mt' : scalar ? 'scalar' : memory64 ? 'memory64' : core ? 'core' : 'release'
+  }
+
+  private get artifactName(): string {
+    return this.variant === 'release' ? 'zlib-release' : `zlib-release-${this.variant}`
+  }
 
-    throw new Error('No zlib.wasm binary available. Run "deno task build:wasm" to build locally, or check CDN availability.')
+  // What workers load with: the compiled module travels with the options,
+  // and the compress() cache stays here rather than one per worker
+  private get workerLoadingOptions(): ZlibLoadingOptions {
+    return { ...this.loadingOptions, wasmModule: this.compiled ?? undefined, compressCacheMB: undefined }
   }
 }
 
 // Export types and classes
 export {
+  ZlibCore,
+  ZlibHeapBuffer,
+  ZlibDictionary,
+  trainDictionary,
+  ZlibIndex,
+  ZlibBgzfReader,
+  ZlibInflater,
+  ZlibCodec,
+  ZlibDeflateStream,
+  ZlibZipReader,
+  PerMessageDeflate,
+  ZlibGzipLog,
+  MemoryLogStorage,
+  fileLogStorage,
+  accessHandleLogStorage,
+  ZlibGzipFile,
+  Crc32Hasher,
+  Adler32Hasher,
   ZlibCompression,
   ZlibStrategy,
   ZlibError,
   ZlibMemoryError,
   ZlibCompressionError,
+  ZlibLimitError,
   ZlibInitError
 }
 export type {
   ZlibModule,
   ZlibOptions,
+  ZlibDecompressOptions,
+  ZlibDictionaryEntry,
+  ZlibInflateLimits,
+  ZlibStreamOptions,
+  ZlibChunkTiming,
+  ZlibAdaptiveLevel,
+  ZlibLevelChange,
+  ZlibMemoryProfile,
+  ZlibParallelOptions,
+  ZlibParallelDecompressOptions,
+  ZlibWorkerRunOptions,
+  ZlibWorkerOptions,
+  ZlibBlockResult,
+  ZlibBatchResult,
+  ZlibZipEntry,
+  ZlibZipOptions,
+  ZlibZipStreamEntry,
+  ZlibZipStreamOptions,
+  ZlibZipEntryLocation,
+  ZlibUnzipOptions,
+  ZlibIndexSource,
+  ZlibIndexOptions,
+  ZlibBgzfOptions,
+  ZlibBgzfResult,
+  ZlibBackPull,
+  ZlibBackPush,
+  ZlibTarEntry,
+  ZlibTarEntryType,
+  ZlibTarStreamEntry,
+  ZlibPerMessageDeflateOptions,
+  ZlibLogStorage,
+  ZlibLogOptions,
+  ZlibSyncAccessHandle,
+  ZlibGzipFileOptions,
+  ZlibAutoChoice,
+  ZlibGzipHeader,
+  ZlibGzipHeaderInfo,
+  ZlibGzipMember,
   ZlibResult,
   ZlibCapabilities,
+  ZlibMemoryUsage,
+  ZlibCompressCacheStats,
+  ZlibStats,
+  ZlibPhaseStats,
+  ZlibProfileConfig,
+  ZlibProfilePoint,
+  ZlibProfileOptions,
+  ZlibProfile,
   ZlibLoadingOptions,
   CompressionPerformance,
   BenchmarkResult
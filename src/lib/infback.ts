@@ -0,0 +1,125 @@
+/**
+ * zlib.wasm callback-driven inflate
+ * inflateBack() through the zlib_inflate_back export: output as views of
+ * its 32 KB window, handed over as it fills
+ */
+
+import { ZlibCompressionError } from './types.ts'
+import type { ZlibBackHost, ZlibBackPull, ZlibBackPush, ZlibModule } from './types.ts'
+import type { HeapBufferPool, ZlibHeapBuffer } from './heap.ts'
+
+// zlib return codes from the export
+const Z_OK = 0
+const Z_ERRNO = -1
+const Z_BUF_ERROR = -5
+
+// zlib_inflate_back() format codes
+const FORMAT_CODES = { zlib: 0, gzip: 1, raw: 2, auto: 3 }
+
+interface BackCall {
+  pull: ZlibBackPull
+  push: ZlibBackPush
+  staging: ZlibHeapBuffer | null
+  // First error thrown by a callback, rethrown once the export returns
+  error?: unknown
+}
+
+// Calls in progress per module, by the number src/zlib_infback.c knows them by
+const tables = new WeakMap<ZlibModule, Map<number, BackCall>>()
+let lastCall = 0
+
+/**
+ * The module's table of calls in progress, installing module.zlibBack on
+ * first use. Callback errors are caught here and kept for the caller, as
+ * they must not unwind through inflateBack() and leave its window behind.
+ */
+function backCalls(module: ZlibModule, pool: HeapBufferPool): Map<number, BackCall> {
+  const table = tables.get(module)
+  if (table) return table
+
+  const calls = new Map<number, BackCall>()
+  const host: ZlibBackHost = {
+    pull(call, bufPtrPtr) {
+      const c = calls.get(call)
+      if (!c) return -1
+      try {
+        let chunk: Uint8Array | null
+        do chunk = c.pull(); while (chunk && chunk.length === 0)
+        if (!chunk) return 0
+
+        // Heap views are read in place; anything else through one staging region
+        let ptr = chunk.byteOffset
+        if (chunk.buffer !== module.HEAPU8.buffer) {
+          if (!c.staging || c.staging.capacity < chunk.length) {
+            if (c.staging) pool.release(c.staging)
+            c.staging = pool.acquire(chunk.length)
+          }
+          ptr = c.staging.write(chunk).ptr
+        }
+        module.HEAP32[bufPtrPtr / 4] = ptr
+        return chunk.length
+      } catch (error) {
+        c.error = error
+        return -1
+      }
+    },
+    push(call, bufPtr, len) {
+      const c = calls.get(call)
+      if (!c) return -1
+      try {
+        c.push(module.HEAPU8.subarray(bufPtr, bufPtr + len))
+        return 0
+      } catch (error) {
+        c.error = error
+        return -1
+      }
+    }
+  }
+
+  module.zlibBack = host
+  tables.set(module, calls)
+  return calls
+}
+
+/**
+ * Inflate one stream, pulling compressed chunks from pull() until it
+ * returns null and handing every piece of output to push() as a view of
+ * inflateBack()'s window. The view is only valid during that push() call:
+ * copy or forward it before returning. Both callbacks are synchronous.
+ * Returns the number of bytes pushed.
+ */
+export function inflateBack(
+  module: ZlibModule,
+  pool: HeapBufferPool,
+  pull: ZlibBackPull,
+  push: ZlibBackPush,
+  format: 'zlib' | 'gzip' | 'raw' | 'auto'
+): number {
+  let total = 0
+  const calls = backCalls(module, pool)
+  const call = ++lastCall
+  const c: BackCall = {
+    pull,
+    push: chunk => {
+      total += chunk.length
+      push(chunk)
+    },
+    staging: null
+  }
+  calls.set(call, c)
+
+  try {
+    const result = module._zlib_inflate_back!(call, FORMAT_CODES[format])
+    if (result === Z_ERRNO && c.error !== undefined) throw c.error
+    if (result === Z_BUF_ERROR) {
+      throw new ZlibCompressionError('Decompression failed: stream truncated')
+    }
+    if (result !== Z_OK) {
+      throw new ZlibCompressionError(`Decompression failed with code: ${result}`)
+    }
+    return total
+  } finally {
+    calls.delete(call)
+    if (c.staging) pool.release(c.staging)
+  }
+}
@@ -0,0 +1,86 @@
+/**
+ * zlib.wasm inflate-only entry point
+ * Decompression on zlib-release-core (./build-dual.sh inflate)
+ */
+
+import { ZlibCompressionError } from './types.ts'
+import type { ZlibInflateLimits, ZlibLoadingOptions } from './types.ts'
+import { ZlibSlim } from './slim.ts'
+import { hasInflateLimits, inflateLimit, limitError } from './limits.ts'
+
+// What zlib_decompress_limit_alloc() returns for output past its limit
+const Z_BUF_ERROR = -5
+
+export interface ZlibInflateOptions extends ZlibInflateLimits {
+  // Decompressed size if known, so the output is allocated exactly once
+  expectedSize?: number
+  // Raw preset dictionary the stream was compressed against
+  dictionary?: Uint8Array
+}
+
+/**
+ * zlib and gzip decompression, and the checksums, on the inflate-only
+ * build. Calls are synchronous once initialize() has resolved.
+ */
+export class ZlibInflate extends ZlibSlim {
+  constructor(options: ZlibLoadingOptions = {}) {
+    super('zlib-release-core', ['_zlib_decompress_dict_alloc', '_zlib_crc32', '_zlib_adler32'], options)
+  }
+
+  /**
+   * Decompress zlib or gzip data, detected from the header, stopping with a
+   * ZlibLimitError once the output passes options.maxOutputSize or
+   * options.maxRatio
+   */
+  decompress(data: Uint8Array, options: ZlibInflateOptions = {}): Uint8Array {
+    const module = this.ready()
+    const pool = this.heapPool!
+    const input = pool.acquire(data.length).write(data)
+    const dictionary = options.dictionary ? pool.acquire(options.dictionary.length).write(options.dictionary) : null
+
+    const limit = inflateLimit(options, data.length)
+
+    try {
+      const result = hasInflateLimits(options)
+        ? module._zlib_decompress_limit_alloc!(
+            input.ptr,
+            data.length,
+            dictionary?.ptr ?? 0,
+            dictionary?.length ?? 0,
+            options.expectedSize ?? 0,
+            // 0 is no limit to the export; a zero limit is checked below
+            Math.min(Math.max(limit, 1), 0xffffffff),
+            pool.pointerPtr,
+            pool.lengthPtr
+          )
+        : module._zlib_decompress_dict_alloc(
+            input.ptr,
+            data.length,
+            dictionary?.ptr ?? 0,
+            dictionary?.length ?? 0,
+            options.expectedSize ?? 0,
+            pool.pointerPtr,
+            pool.lengthPtr
+          )
+      if (result === Z_BUF_ERROR && hasInflateLimits(options)) {
+        throw limitError(options, data.length, limit + 1)
+      }
+      if (result !== 0) {
+        throw new ZlibCompressionError(`Decompression failed with code: ${result}`)
+      }
+
+      const outputPtr = pool.pointer
+      const length = pool.length
+      if (length > limit) {
+        module._free(outputPtr)
+        throw limitError(options, data.length, length)
+      }
+      const output = module.HEAPU8.slice(outputPtr, outputPtr + length)
+      module._free(outputPtr)
+      return output
+    } finally {
+      pool.release(input)
+      if (dictionary) pool.release(dictionary)
+    }
+  }
+}
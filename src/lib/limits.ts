@@ -0,0 +1,34 @@
+/**
+ * zlib.wasm inflate limits
+ * maxOutputSize and maxRatio, for one-shot and streamed inflate alike
+ */
+
+import { ZlibLimitError } from './types.ts'
+import type { ZlibInflateLimits } from './types.ts'
+
+/** Whether any limit is set */
+export function hasInflateLimits(limits: ZlibInflateLimits): boolean {
+  return limits.maxOutputSize !== undefined || limits.maxRatio !== undefined
+}
+
+/**
+ * The most output inputLength bytes of input may inflate to under the
+ * limits, or Infinity with none
+ */
+export function inflateLimit(limits: ZlibInflateLimits, inputLength: number): number {
+  const byRatio = limits.maxRatio !== undefined ? Math.floor(limits.maxRatio * inputLength) : Infinity
+  return Math.max(0, Math.min(limits.maxOutputSize ?? Infinity, byRatio))
+}
+
+/** The error for output that went past the limits */
+export function limitError(limits: ZlibInflateLimits, input: number, output: number): ZlibLimitError {
+  if (limits.maxOutputSize !== undefined && output > limits.maxOutputSize) {
+    return new ZlibLimitError(`Decompressed output exceeds maxOutputSize of ${limits.maxOutputSize} bytes`)
+  }
+  return new ZlibLimitError(`Decompressed output exceeds maxRatio of ${limits.maxRatio} for ${input} bytes of input`)
+}
+
+/** Throw once output bytes from input bytes of input pass the limits */
+export function checkInflateLimits(limits: ZlibInflateLimits, input: number, output: number): void {
+  if (output > inflateLimit(limits, input)) throw limitError(limits, input, output)
+}
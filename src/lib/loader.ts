@@ -0,0 +1,236 @@
+/**
+ * zlib.wasm module loading
+ * Compiles each build's binary once per host: in memory for every Zlib in
+ * this realm, as bytes in the Cache API across runs, and as a
+ * WebAssembly.Module posted to workers so they skip compilation entirely
+ */
+
+import { ZlibInitError } from './types.ts'
+import type { ZlibLoadingOptions, ZlibModule } from './types.ts'
+import { wrapMemory64 } from './memory64.ts'
+
+// Where builds are fetched from when there is no local install
+export const DEFAULT_LOADING_OPTIONS: ZlibLoadingOptions = {
+  cdnUrl: 'https://cdn.discere.cloud/npm/@discere-os/zlib.wasm/',
+  fallbackUrls: [
+    'https://cdn.jsdelivr.net/npm/@discere-os/zlib.wasm/',
+    'https://unpkg.com/@discere-os/zlib.wasm/'
+  ],
+  cachingEnabled: true
+}
+
+// Cache API store for binaries fetched from a CDN
+const CACHE_NAME = 'zlib.wasm'
+
+// Compiled modules by build and source, shared by every Zlib in this realm
+const compiledModules = new Map<string, Promise<WebAssembly.Module>>()
+
+/**
+ * Compile once per key; concurrent callers share the same compilation, and
+ * a failed one is forgotten so the next call retries
+ */
+export function cachedModule(key: string, compile: () => Promise<WebAssembly.Module>): Promise<WebAssembly.Module> {
+  let module = compiledModules.get(key)
+  if (!module) {
+    module = compile().catch(error => {
+      compiledModules.delete(key)
+      throw error
+    })
+    compiledModules.set(key, module)
+  }
+  return module
+}
+
+// compileStreaming() insists on application/wasm, which not every CDN sends
+async function compileResponse(response: Response): Promise<WebAssembly.Module> {
+  const type = response.headers.get('content-type') ?? ''
+  if (typeof WebAssembly.compileStreaming === 'function' && type.startsWith('application/wasm')) {
+    return await WebAssembly.compileStreaming(response)
+  }
+  return await WebAssembly.compile(await response.arrayBuffer())
+}
+
+/**
+ * Fetch and compile url, streaming where the response allows it. With
+ * persistent set the bytes are kept in the Cache API (browsers and Deno),
+ * so later runs compile without touching the network. Null if the server
+ * answers with an error.
+ */
+export async function fetchModule(url: string, persistent: boolean): Promise<WebAssembly.Module | null> {
+  const cache = persistent && typeof caches !== 'undefined'
+    ? await caches.open(CACHE_NAME).catch(() => null)
+    : null
+
+  const cached = await cache?.match(url)
+  if (cached) return await compileResponse(cached)
+
+  const response = await fetch(url)
+  if (!response.ok) return null
+
+  // A full or unavailable cache costs the next run a download, nothing more
+  await cache?.put(url, response.clone()).catch(() => {})
+  return await compileResponse(response)
+}
+
+type ReceiveInstance = (instance: WebAssembly.Instance, module: WebAssembly.Module) => void
+
+/**
+ * Emscripten's instantiateWasm hook for an already compiled module. The
+ * factory has no way to hear about a failure inside the hook, so it is
+ * reported on `failed` instead, to race against the factory's promise.
+ */
+export function instantiateFrom(module: WebAssembly.Module): {
+  instantiateWasm: (imports: WebAssembly.Imports, receive: ReceiveInstance) => object
+  failed: Promise<never>
+} {
+  let fail!: (error: unknown) => void
+  const failed = new Promise<never>((_, reject) => { fail = reject })
+
+  const instantiateWasm = (imports: WebAssembly.Imports, receive: ReceiveInstance) => {
+    WebAssembly.instantiate(module, imports).then(instance => receive(instance, module), fail)
+    // Exports arrive through receive()
+    return {}
+  }
+  return { instantiateWasm, failed }
+}
+
+// A build's artifact name without the zlib-release prefix, as its
+// build-dual-main-* directory is named
+function buildDirectory(artifact: string): string {
+  return artifact === 'zlib-release' ? 'release' : artifact.replace('zlib-release-', '')
+}
+
+/**
+ * Import a build's emscripten glue, from the local install during
+ * development or from the CDN
+ */
+async function loadFactory(options: ZlibLoadingOptions, artifact: string): Promise<any> {
+  const fallbackUrls = options.fallbackUrls || []
+  const urls = [options.cdnUrl, ...fallbackUrls]
+
+  for (const baseUrl of urls) {
+    try {
+      const moduleUrl = `${baseUrl}install/wasm/${artifact}.js`
+
+      // Try to load from local file first (development)
+      try {
+        // Use dynamic import with absolute path to avoid TypeScript module resolution
+        const modulePath = new URL(`./../../install/wasm/${artifact}.js`, import.meta.url).href
+        const localModule = await import(modulePath) as any
+        return localModule.default
+      } catch {
+        // Fall back to CDN
+        const moduleFactory = await import(moduleUrl)
+        return moduleFactory.default
+      }
+    } catch (error) {
+      const errorMessage = error instanceof Error ? error.message : String(error);
+      console.warn(`Failed to load from ${baseUrl}: ${errorMessage}`)
+    }
+  }
+
+  throw new ZlibInitError('Failed to load zlib.wasm from all sources')
+}
+
+/**
+ * Read and compile a build's binary: local build paths first (Deno and
+ * Node.js), then the CDN. The legacy zlib.wasm names only ever hold the
+ * release build, so other builds skip them.
+ */
+async function compileBinary(options: ZlibLoadingOptions, artifact: string): Promise<WebAssembly.Module> {
+  const directory = buildDirectory(artifact)
+  const release = directory === 'release'
+
+  // @ts-ignore - Deno global may not exist in all environments
+  if (typeof globalThis.Deno !== 'undefined') {
+    // Deno environment - use Deno.readFile
+    const localPaths = [
+      `./install/wasm/${artifact}.wasm`,                 // Dual build system main module
+      ...(release ? ['./install/wasm/zlib.wasm'] : []),  // Legacy path
+      `./build-dual-main-${directory}/${artifact}.wasm`, // Direct build output
+      ...(release ? ['./build/zlib-release.wasm'] : [])  // Fallback location
+    ]
+
+    for (const localPath of localPaths) {
+      try {
+        const wasmBuffer = await Deno.readFile(localPath)
+        console.log(`✅ Loaded zlib.wasm binary from: ${localPath}`)
+        return await WebAssembly.compile(wasmBuffer)
+      } catch (error) {
+        console.log(`⚠️ Failed to load WASM from ${localPath}:`, (error as Error).message)
+        continue
+      }
+    }
+  }
+
+  // @ts-ignore - process global may not exist in all environments
+  if (typeof globalThis.process !== 'undefined' && globalThis.process?.versions?.node) {
+    // Node.js environment
+    const { readFile } = await import('fs/promises')
+    const { fileURLToPath } = await import('url')
+    const path = await import('path')
+
+    const localPaths = [
+      `../../../install/wasm/${artifact}.wasm`,                 // Dual build system main module
+      ...(release ? ['../../../install/wasm/zlib.wasm'] : []),  // Legacy path
+      `../../../build-dual-main-${directory}/${artifact}.wasm`, // Direct build output
+      ...(release ? ['../../../build/zlib-release.wasm'] : [])  // Fallback location
+    ]
+
+    for (const localPath of localPaths) {
+      try {
+        const filePath = path.resolve(fileURLToPath(import.meta.url), localPath)
+        const wasmBuffer = await readFile(filePath)
+        console.log(`✅ Loaded zlib.wasm binary from: ${localPath}`)
+        return await WebAssembly.compile(wasmBuffer)
+      } catch (error) {
+        console.log(`⚠️ Failed to load WASM from ${localPath}:`, (error as Error).message)
+        continue
+      }
+    }
+  }
+
+  // Try CDN loading for production use
+  const fallbackUrls = options.fallbackUrls || []
+  const urls = [options.cdnUrl, ...fallbackUrls]
+
+  for (const url of urls) {
+    if (!url) continue
+    try {
+      // Other builds sit next to their glue, as zlib.wasm cannot serve them
+      const wasmName = release ? 'zlib.wasm' : `install/wasm/${artifact}.wasm`
+      const wasmUrl = url.endsWith('/') ? `${url}${wasmName}` : `${url}/${wasmName}`
+      const compiled = await fetchModule(wasmUrl, !!options.cachingEnabled)
+      if (compiled) {
+        console.log(`✅ Loaded zlib.wasm binary from CDN: ${url}`)
+        return compiled
+      }
+    } catch (error) {
+      console.warn(`Failed to load WASM from CDN ${url}:`, error)
+      continue
+    }
+  }
+
+  throw new Error('No zlib.wasm binary available. Run "deno task build:wasm" to build locally, or check CDN availability.')
+}
+
+export interface ZlibBuild {
+  module: ZlibModule
+  compiled: WebAssembly.Module
+}
+
+/**
+ * Instantiate a build (zlib-release, zlib-release-core, ...) from the
+ * compiled module in options.wasmModule, or from one compiled here: once
+ * per build and source for the whole realm when caching is enabled
+ */
+export async function loadBuild(options: ZlibLoadingOptions, artifact: string): Promise<ZlibBuild> {
+  const factory = await loadFactory(options, artifact)
+  const compiled = options.wasmModule ?? await (options.cachingEnabled
+    ? cachedModule(`${options.cdnUrl} ${artifact}`, () => compileBinary(options, artifact))
+    : compileBinary(options, artifact))
+
+  const { instantiateWasm, failed } = instantiateFrom(compiled)
+  const module = await Promise.race([factory({ instantiateWasm }), failed])
+  return { module: artifact === 'zlib-release-memory64' ? wrapMemory64(module) : module, compiled }
+}
@@ -0,0 +1,72 @@
+/**
+ * zlib.wasm memory64 support
+ * Number/BigInt conversion for the exports of zlib-release-memory64
+ */
+
+import type { ZlibModule } from './types.ts'
+
+// Signatures of the memory64 exports, as "<returns> <arguments>": i for a
+// 32-bit int, p for a pointer and j for an unsigned long (both i64 on
+// wasm64), v for no result
+const SIGNATURES: Record<string, string> = {
+  _zlib_compress_buffer: 'i pjppi',
+  _zlib_compress_bound: 'j j',
+  _zlib_compress_format: 'i pjppiiiiipjip',
+  _zlib_rsync_scan: 'j pjp',
+  _zlib_rsync_boundaries: 'j pj',
+  _zlib_compress_format_bound: 'j jiiij',
+  _zlib_decompress_buffer: 'i pjpp',
+  _zlib_decompress_alloc: 'i pjjpp',
+  _zlib_decompress_dict_alloc: 'i pjpjjpp',
+  _zlib_decompress_limit_alloc: 'i pjpjjjpp',
+  _zlib_ctx_pool_drain: 'v ',
+  _zlib_ctx_memory: 'j iiii',
+  _zlib_deflate_init: 'p iiii',
+  _zlib_deflate_init_profile: 'p iiiii',
+  _zlib_deflate_process: 'i ppipii',
+  _zlib_deflate_reset: 'i p',
+  _zlib_deflate_params: 'i pii',
+  _zlib_deflate_end: 'v p',
+  _zlib_inflate_init: 'p i',
+  _zlib_inflate_process: 'i ppipi',
+  _zlib_inflate_reset: 'i p',
+  _zlib_inflate_end: 'v p',
+  _zlib_stream_avail_in: 'i p',
+  _zlib_stream_avail_out: 'i p',
+  _zlib_stream_ring: 'p pi',
+  _zlib_deflate_drain: 'i ppii',
+  _zlib_inflate_drain: 'i ppi',
+  _zlib_crc32: 'j jpj',
+  _zlib_adler32: 'j jpj',
+  _zlib_crc32_combine: 'j jjj',
+  _zlib_adler32_combine: 'j jjj',
+  _zlib_crc32_combine_gen: 'j j',
+  _zlib_crc32_combine_op: 'j jjj',
+  _zlib_get_version: 'p ',
+  _zlib_simd_capabilities: 'i ',
+  _malloc: 'p j',
+  _free: 'v p'
+}
+
+/**
+ * Let the rest of the library call a memory64 module with plain numbers.
+ * Every 64-bit argument crosses as a BigInt and every 64-bit result comes
+ * back as a number, which is exact up to 2^53 bytes. Emscripten may already
+ * convert pointers on its side; BigInt() and Number() leave those alone.
+ * The module is marked memory64 so HeapBufferPool reads and writes its
+ * 8-byte length and pointer cells.
+ */
+export function wrapMemory64(module: ZlibModule): ZlibModule {
+  for (const [name, signature] of Object.entries(SIGNATURES)) {
+    const fn = module[name]
+    if (typeof fn !== 'function') continue
+
+    const [result, params] = signature.split(' ')
+    module[name] = (...args: number[]) => {
+      const value = fn(...args.map((arg, i) => params[i] === 'i' ? arg : BigInt(arg)))
+      return result === 'i' || result === 'v' ? value : Number(value)
+    }
+  }
+  module.memory64 = true
+  return module
+}
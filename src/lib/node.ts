@@ -0,0 +1,360 @@
+/**
+ * zlib.wasm node:zlib adaptor
+ * createGzip(), gunzipSync(), flush() and params() as node:zlib has them,
+ * over the stream engine, for Node and Deno code moving off node:zlib
+ */
+
+import { Transform } from 'node:stream'
+import type { TransformCallback } from 'node:stream'
+import { Buffer } from 'node:buffer'
+import Zlib from './index.ts'
+import { ZlibError, ZlibLimitError } from './types.ts'
+import type { ZlibLoadingOptions, ZlibStreamOptions } from './types.ts'
+import type { ZlibCodec } from './stream.ts'
+
+// node:zlib's constants, as far as this adaptor uses them
+export const constants = Object.freeze({
+  Z_NO_FLUSH: 0,
+  Z_PARTIAL_FLUSH: 1,
+  Z_SYNC_FLUSH: 2,
+  Z_FULL_FLUSH: 3,
+  Z_FINISH: 4,
+  Z_BLOCK: 5,
+  Z_OK: 0,
+  Z_STREAM_END: 1,
+  Z_NEED_DICT: 2,
+  Z_ERRNO: -1,
+  Z_STREAM_ERROR: -2,
+  Z_DATA_ERROR: -3,
+  Z_MEM_ERROR: -4,
+  Z_BUF_ERROR: -5,
+  Z_VERSION_ERROR: -6,
+  Z_NO_COMPRESSION: 0,
+  Z_BEST_SPEED: 1,
+  Z_BEST_COMPRESSION: 9,
+  Z_DEFAULT_COMPRESSION: -1,
+  Z_FILTERED: 1,
+  Z_HUFFMAN_ONLY: 2,
+  Z_RLE: 3,
+  Z_FIXED: 4,
+  Z_DEFAULT_STRATEGY: 0,
+  Z_MIN_WINDOWBITS: 8,
+  Z_MAX_WINDOWBITS: 15,
+  Z_DEFAULT_WINDOWBITS: 15,
+  Z_MIN_CHUNK: 64,
+  Z_DEFAULT_CHUNK: 16 * 1024,
+  Z_MIN_MEMLEVEL: 1,
+  Z_MAX_MEMLEVEL: 9,
+  Z_DEFAULT_MEMLEVEL: 8
+})
+
+const ERROR_NAMES: Record<number, string> = {
+  [-2]: 'Z_STREAM_ERROR',
+  [-3]: 'Z_DATA_ERROR',
+  [-4]: 'Z_MEM_ERROR',
+  [-5]: 'Z_BUF_ERROR',
+  [-6]: 'Z_VERSION_ERROR'
+}
+
+/** node:zlib's ZlibOptions; dictionary and info are not supported */
+export interface NodeZlibOptions {
+  flush?: number
+  finishFlush?: number
+  chunkSize?: number
+  windowBits?: number
+  level?: number
+  memLevel?: number
+  strategy?: number
+  maxOutputLength?: number
+}
+
+export type NodeZlibCallback = (error: Error | null, result: Buffer) => void
+type NodeZlibInput = Uint8Array | ArrayBuffer | string
+
+// The node:zlib classes there are, by the codec and framing under each
+export type NodeZlibMode = 'gzip' | 'gunzip' | 'deflate' | 'inflate' | 'deflateRaw' | 'inflateRaw' | 'unzip'
+
+function isDeflate(mode: NodeZlibMode): boolean {
+  return mode === 'gzip' || mode === 'deflate' || mode === 'deflateRaw'
+}
+
+function codecOptions(mode: NodeZlibMode, options: NodeZlibOptions): ZlibStreamOptions & { members?: boolean } {
+  const bits = options.windowBits || constants.Z_DEFAULT_WINDOWBITS
+  const tuning = {
+    chunkSize: options.chunkSize,
+    maxOutputSize: options.maxOutputLength
+  }
+  switch (mode) {
+    case 'gzip':
+    case 'deflate':
+    case 'deflateRaw':
+      return {
+        ...tuning,
+        format: mode === 'gzip' ? 'gzip' : mode === 'deflateRaw' ? 'raw' : 'zlib',
+        windowBits: bits,
+        level: options.level,
+        memLevel: options.memLevel,
+        strategy: options.strategy
+      }
+    case 'gunzip': return { ...tuning, windowBits: bits + 16, members: true }
+    case 'inflate': return { ...tuning, windowBits: bits }
+    case 'inflateRaw': return { ...tuning, windowBits: -bits }
+    case 'unzip': return { ...tuning, windowBits: bits + 32, members: true }
+  }
+}
+
+// An Error carrying node:zlib's code and errno, parsed from the engine's
+// "code: N" where it gives one
+function nodeError(error: unknown): Error {
+  if (!(error instanceof Error)) return new Error(String(error))
+  const tagged = error as Error & { code?: string, errno?: number }
+  if (error instanceof ZlibLimitError) {
+    tagged.code = 'ERR_BUFFER_TOO_LARGE'
+    return tagged
+  }
+  const match = /code: (-?\d+)/.exec(error.message)
+  const errno = match ? Number(match[1]) : /truncated/.test(error.message) ? constants.Z_BUF_ERROR : constants.Z_DATA_ERROR
+  tagged.errno = errno
+  tagged.code = ERROR_NAMES[errno] ?? 'Z_DATA_ERROR'
+  return tagged
+}
+
+function toBytes(input: NodeZlibInput): Uint8Array {
+  if (typeof input === 'string') return Buffer.from(input)
+  return input instanceof Uint8Array ? input : new Uint8Array(input)
+}
+
+// Output from the engine is already a copy out of the heap, so it becomes
+// a Buffer in place
+function toBuffer(bytes: Uint8Array): Buffer {
+  return Buffer.from(bytes.buffer, bytes.byteOffset, bytes.length)
+}
+
+/**
+ * A node:zlib stream: Gzip, Gunzip, Deflate, Inflate, DeflateRaw,
+ * InflateRaw or Unzip by mode. Every chunk is handed to one codec, whose
+ * z_stream and heap staging buffers last as long as the stream; each piece
+ * of output is pushed as a Buffer over the copy the engine made of it.
+ */
+export class NodeZlibStream extends Transform {
+  // Zero-length chunks that stand for a flush() or params() in the write
+  // queue, so they run in order with the writes around them
+  private readonly actions = new WeakMap<Uint8Array, () => void>()
+  private readonly codec: ZlibCodec
+  private readonly flushMode: number
+  private readonly finishFlush: number
+  private readonly emit = (output: Uint8Array) => {
+    this.push(toBuffer(output))
+  }
+  private level: number
+  private strategy: number
+  bytesWritten = 0
+
+  constructor(zlib: Zlib, readonly mode: NodeZlibMode, options: NodeZlibOptions = {}) {
+    super({ highWaterMark: options.chunkSize })
+    this.codec = zlib.createCodec(isDeflate(mode) ? 'deflate' : 'inflate', codecOptions(mode, options))
+    this.flushMode = options.flush ?? constants.Z_NO_FLUSH
+    this.finishFlush = options.finishFlush ?? constants.Z_FINISH
+    this.level = options.level ?? constants.Z_DEFAULT_COMPRESSION
+    this.strategy = options.strategy ?? constants.Z_DEFAULT_STRATEGY
+  }
+
+  /**
+   * Flush what has been written so far, Z_FULL_FLUSH by default, once the
+   * writes queued before it have gone through
+   */
+  flush(kind: number | (() => void) = constants.Z_FULL_FLUSH, callback?: () => void): void {
+    if (typeof kind === 'function') {
+      callback = kind
+      kind = constants.Z_FULL_FLUSH
+    }
+    const mode = kind
+    this.queue(() => this.codec.flush(mode, this.emit), callback)
+  }
+
+  /**
+   * Change the level and strategy for what is written from here on, after
+   * a sync flush of what came before; deflate only
+   */
+  params(level: number, strategy: number, callback?: (error?: Error | null) => void): void {
+    if (!isDeflate(this.mode)) {
+      throw new ZlibError('params() is only for deflate streams')
+    }
+    if (level === this.level && strategy === this.strategy) {
+      if (callback) queueMicrotask(() => callback(null))
+      return
+    }
+    this.queue(() => {
+      this.codec.params(level, strategy, this.emit)
+      this.level = level
+      this.strategy = strategy
+    }, callback)
+  }
+
+  /** Drop the stream in progress and start another on the same state */
+  reset(): void {
+    this.codec.reset()
+  }
+
+  close(callback?: () => void): void {
+    if (callback) this.once('close', callback)
+    this.destroy()
+  }
+
+  override _transform(chunk: Uint8Array, _encoding: string, callback: TransformCallback): void {
+    try {
+      const action = this.actions.get(chunk)
+      if (action) {
+        action()
+      } else {
+        this.codec.write(chunk, this.emit)
+        this.bytesWritten += chunk.length
+        if (this.flushMode !== constants.Z_NO_FLUSH) this.codec.flush(this.flushMode, this.emit)
+      }
+      callback()
+    } catch (error) {
+      callback(nodeError(error))
+    }
+  }
+
+  override _flush(callback: TransformCallback): void {
+    try {
+      // Inflate finished with anything but Z_FINISH lets a truncated
+      // stream end quietly, as node:zlib does
+      if (isDeflate(this.mode) || this.finishFlush === constants.Z_FINISH) this.codec.end(this.emit)
+      this.codec.dispose()
+      callback()
+    } catch (error) {
+      this.codec.dispose()
+      callback(nodeError(error))
+    }
+  }
+
+  override _destroy(error: Error | null, callback: (error?: Error | null) => void): void {
+    this.codec.dispose()
+    callback(error)
+  }
+
+  private queue(action: () => void, callback?: (error?: Error | null) => void): void {
+    if (this.writableEnded || this.destroyed) {
+      if (callback) queueMicrotask(() => callback())
+      return
+    }
+    const marker = Buffer.alloc(0)
+    this.actions.set(marker, action)
+    this.write(marker, callback)
+  }
+}
+
+/** node:zlib's functions and stream factories over one initialized Zlib */
+export interface NodeZlib {
+  constants: typeof constants
+  createGzip(options?: NodeZlibOptions): NodeZlibStream
+  createGunzip(options?: NodeZlibOptions): NodeZlibStream
+  createDeflate(options?: NodeZlibOptions): NodeZlibStream
+  createInflate(options?: NodeZlibOptions): NodeZlibStream
+  createDeflateRaw(options?: NodeZlibOptions): NodeZlibStream
+  createInflateRaw(options?: NodeZlibOptions): NodeZlibStream
+  createUnzip(options?: NodeZlibOptions): NodeZlibStream
+  gzipSync(input: NodeZlibInput, options?: NodeZlibOptions): Buffer
+  gunzipSync(input: NodeZlibInput, options?: NodeZlibOptions): Buffer
+  deflateSync(input: NodeZlibInput, options?: NodeZlibOptions): Buffer
+  inflateSync(input: NodeZlibInput, options?: NodeZlibOptions): Buffer
+  deflateRawSync(input: NodeZlibInput, options?: NodeZlibOptions): Buffer
+  inflateRawSync(input: NodeZlibInput, options?: NodeZlibOptions): Buffer
+  unzipSync(input: NodeZlibInput, options?: NodeZlibOptions): Buffer
+  gzip(input: NodeZlibInput, options: NodeZlibOptions | NodeZlibCallback, callback?: NodeZlibCallback): void
+  gunzip(input: NodeZlibInput, options: NodeZlibOptions | NodeZlibCallback, callback?: NodeZlibCallback): void
+  deflate(input: NodeZlibInput, options: NodeZlibOptions | NodeZlibCallback, callback?: NodeZlibCallback): void
+  inflate(input: NodeZlibInput, options: NodeZlibOptions | NodeZlibCallback, callback?: NodeZlibCallback): void
+  deflateRaw(input: NodeZlibInput, options: NodeZlibOptions | NodeZlibCallback, callback?: NodeZlibCallback): void
+  inflateRaw(input: NodeZlibInput, options: NodeZlibOptions | NodeZlibCallback, callback?: NodeZlibCallback): void
+  unzip(input: NodeZlibInput, options: NodeZlibOptions | NodeZlibCallback, callback?: NodeZlibCallback): void
+}
+
+/**
+ * The node:zlib surface over zlib, which must be initialized, since the
+ * *Sync functions cannot wait for it. A one-shot call runs one codec over
+ * the whole input; contexts come from the module's pool, so repeated calls
+ * with the same settings do not reallocate zlib state.
+ */
+export function nodeZlib(zlib: Zlib): NodeZlib {
+  const sync = (mode: NodeZlibMode) => (input: NodeZlibInput, options: NodeZlibOptions = {}): Buffer => {
+    const codec = zlib.createCodec(isDeflate(mode) ? 'deflate' : 'inflate', codecOptions(mode, options))
+    const chunks: Uint8Array[] = []
+    const emit = (output: Uint8Array) => {
+      chunks.push(output)
+    }
+    try {
+      codec.write(toBytes(input), emit)
+      if (isDeflate(mode) || (options.finishFlush ?? constants.Z_FINISH) === constants.Z_FINISH) codec.end(emit)
+    } catch (error) {
+      throw nodeError(error)
+    } finally {
+      codec.dispose()
+    }
+    // Most inputs inflate or deflate in one slice, which needs no join
+    return chunks.length === 1 ? toBuffer(chunks[0]) : Buffer.concat(chunks)
+  }
+
+  const callbackForm = (run: (input: NodeZlibInput, options?: NodeZlibOptions) => Buffer) =>
+    (input: NodeZlibInput, options: NodeZlibOptions | NodeZlibCallback, callback?: NodeZlibCallback): void => {
+      if (typeof options === 'function') {
+        callback = options
+        options = {}
+      }
+      const settings = options
+      queueMicrotask(() => {
+        let result: Buffer
+        try {
+          result = run(input, settings)
+        } catch (error) {
+          callback!(error as Error, Buffer.alloc(0))
+          return
+        }
+        callback!(null, result)
+      })
+    }
+
+  const stream = (mode: NodeZlibMode) => (options?: NodeZlibOptions) => new NodeZlibStream(zlib, mode, options)
+
+  const gzipSync = sync('gzip')
+  const gunzipSync = sync('gunzip')
+  const deflateSync = sync('deflate')
+  const inflateSync = sync('inflate')
+  const deflateRawSync = sync('deflateRaw')
+  const inflateRawSync = sync('inflateRaw')
+  const unzipSync = sync('unzip')
+
+  return {
+    constants,
+    createGzip: stream('gzip'),
+    createGunzip: stream('gunzip'),
+    createDeflate: stream('deflate'),
+    createInflate: stream('inflate'),
+    createDeflateRaw: stream('deflateRaw'),
+    createInflateRaw: stream('inflateRaw'),
+    createUnzip: stream('unzip'),
+    gzipSync,
+    gunzipSync,
+    deflateSync,
+    inflateSync,
+    deflateRawSync,
+    inflateRawSync,
+    unzipSync,
+    gzip: callbackForm(gzipSync),
+    gunzip: callbackForm(gunzipSync),
+    deflate: callbackForm(deflateSync),
+    inflate: callbackForm(inflateSync),
+    deflateRaw: callbackForm(deflateRawSync),
+    inflateRaw: callbackForm(inflateRawSync),
+    unzip: callbackForm(unzipSync)
+  }
+}
+
+/** Initialize a Zlib and return the node:zlib surface over it */
+export async function loadNodeZlib(options?: ZlibLoadingOptions): Promise<NodeZlib> {
+  const zlib = new Zlib(options)
+  await zlib.initialize()
+  return nodeZlib(zlib)
+}
@@ -0,0 +1,263 @@
+/**
+ * zlib.wasm parallel compression
+ * pigz-style block compression, indexed inflate, and whole calls run off
+ * the caller's thread, across a pool of Web Workers
+ */
+
+import { ZlibCompressionError, ZlibInitError } from './types.ts'
+import type {
+  ZlibDecompressOptions,
+  ZlibDictionaryEntry,
+  ZlibLoadingOptions,
+  ZlibOptions,
+  ZlibProfileConfig,
+  ZlibWorkerRunOptions,
+  ZlibZipEntryLocation
+} from './types.ts'
+
+// Block size bounds; 32 KB of each block's predecessor primes its dictionary
+export const MIN_BLOCK_SIZE = 128 * 1024
+export const MAX_BLOCK_SIZE = 1024 * 1024
+export const DICTIONARY_SIZE = 32 * 1024
+
+export type BlockCheck = 'crc32' | 'adler32'
+
+// Work order posted to a worker
+export interface BlockTask {
+  block: Uint8Array
+  dictionary: Uint8Array | null
+  level: number
+  last: boolean
+  check: BlockCheck
+}
+
+// Work order to inflate one index segment (ZlibIndex.segment()); compressed
+// starts at the segment's first access point
+export interface SegmentTask {
+  index: Uint8Array
+  compressed: Uint8Array
+}
+
+// Work order to inflate one ZIP entry's data (ZlibZipReader.data())
+export interface EntryTask {
+  compressed: Uint8Array
+  location: ZlibZipEntryLocation
+}
+
+// Work order to measure one point of a profile() sweep
+export interface ProfileTask {
+  sample: Uint8Array
+  config: ZlibProfileConfig
+  minRuns: number
+  minTime: number
+}
+
+// Work order to checksum one slice of a crc32Parallel() input
+export interface ChecksumTask {
+  data: Uint8Array
+  check: BlockCheck
+}
+
+// Work order to run one whole compress() or decompress() call. A
+// ZlibDictionary lives in the caller's heap, so options carry none; a
+// registered one goes by dictionaryId, which the worker's registry resolves
+export interface CompressTask {
+  data: Uint8Array
+  options: ZlibOptions
+  dictionaryId?: number
+}
+
+export interface DecompressTask {
+  data: Uint8Array
+  options: ZlibDecompressOptions
+  dictionaryId?: number
+}
+
+export type WorkerTask =
+  | ({ type: 'block' } & BlockTask)
+  | ({ type: 'compress' } & CompressTask)
+  | ({ type: 'decompress' } & DecompressTask)
+  | ({ type: 'checksum' } & ChecksumTask)
+  | ({ type: 'segment' } & SegmentTask)
+  | ({ type: 'entry' } & EntryTask)
+  | ({ type: 'profile' } & ProfileTask)
+
+function transferables(task: WorkerTask): ArrayBuffer[] {
+  switch (task.type) {
+    case 'block': return [task.block.buffer as ArrayBuffer]
+    case 'compress':
+    case 'decompress': return task.data.buffer instanceof ArrayBuffer ? [task.data.buffer] : []
+    // A view of shared memory is posted as is, with nothing copied
+    case 'checksum': return task.data.buffer instanceof ArrayBuffer ? [task.data.buffer] : []
+    case 'segment': return [task.index.buffer as ArrayBuffer, task.compressed.buffer as ArrayBuffer]
+    case 'entry': return [task.compressed.buffer as ArrayBuffer]
+    case 'profile': return [task.sample.buffer as ArrayBuffer]
+  }
+}
+
+// A caller waiting for a worker, and where it stands in line
+interface Waiter {
+  priority: number
+  resolve: (worker: Worker) => void
+}
+
+/**
+ * Fixed set of workers, each running its own instance of the module the
+ * options carry, compiled once by the caller. Tasks wait in one queue,
+ * highest priority first and in arrival order within a priority, and
+ * whichever worker comes free takes the head. A task is only built (and
+ * its block copied out) once its worker is free, so at most one task per
+ * worker is in flight.
+ *
+ * Every worker starts with the entries dictionaries() returns, and
+ * shareDictionaries() posts later ones to all of them; bytes in a
+ * SharedArrayBuffer are shared by the workers, not copied to each.
+ */
+export class ZlibWorkerPool {
+  private readonly workers: Worker[] = []
+  private readonly idle: Worker[] = []
+  private readonly waiters: Waiter[] = []
+
+  constructor(
+    readonly size: number,
+    private readonly loadingOptions: ZlibLoadingOptions,
+    private readonly dictionaries: () => ZlibDictionaryEntry[] = () => []
+  ) {
+    for (let i = 0; i < size; i++) {
+      const worker = this.spawn()
+      this.workers.push(worker)
+      this.idle.push(worker)
+    }
+  }
+
+  /**
+   * Run one task on the next free worker. A signal that aborts while the
+   * task waits takes it out of the queue; one that aborts while it runs
+   * terminates its worker, as a WASM call cannot be interrupted, and a
+   * fresh worker takes that one's place. Either way the promise rejects
+   * with signal.reason.
+   */
+  async run<T>(makeTask: () => WorkerTask, options: ZlibWorkerRunOptions = {}): Promise<T> {
+    const { priority = 0, signal } = options
+    signal?.throwIfAborted()
+    let worker = await this.acquire(priority, signal)
+    let onAbort: (() => void) | null = null
+
+    try {
+      signal?.throwIfAborted()
+      const task = makeTask()
+      return await new Promise<T>((resolve, reject) => {
+        if (signal) {
+          onAbort = () => {
+            worker = this.replace(worker)
+            reject(signal.reason)
+          }
+          signal.addEventListener('abort', onAbort, { once: true })
+        }
+        worker.onmessage = (event: MessageEvent) => {
+          if (event.data.error) {
+            reject(new ZlibCompressionError(`Worker ${task.type} failed: ${event.data.error}`))
+          } else {
+            resolve(event.data as T)
+          }
+        }
+        worker.onerror = (event: ErrorEvent) => {
+          event.preventDefault()
+          reject(new ZlibInitError(`Compression worker failed: ${event.message}`))
+        }
+        worker.postMessage(task, transferables(task))
+      })
+    } finally {
+      if (onAbort) signal!.removeEventListener('abort', onAbort)
+      this.release(worker)
+    }
+  }
+
+  /**
+   * Hand registered dictionaries to every worker. A worker busy with a
+   * task takes them after it, and before any task posted after this call.
+   */
+  shareDictionaries(entries: ZlibDictionaryEntry[]): void {
+    for (const worker of this.workers) worker.postMessage({ type: 'dictionaries', entries })
+  }
+
+  /** Stop every worker; pending blocks are abandoned */
+  terminate(): void {
+    for (const worker of this.workers) worker.terminate()
+    this.workers.length = 0
+    this.idle.length = 0
+  }
+
+  private spawn(): Worker {
+    const worker = new Worker(new URL('./worker.ts', import.meta.url).href, { type: 'module' })
+    const dictionaries = this.dictionaries()
+    try {
+      worker.postMessage({ type: 'init', options: this.loadingOptions, dictionaries })
+    } catch {
+      // A host that cannot clone WebAssembly.Module: the worker compiles its own
+      worker.postMessage({ type: 'init', options: { ...this.loadingOptions, wasmModule: undefined }, dictionaries })
+    }
+    return worker
+  }
+
+  // Swap a worker stuck in a cancelled task for a fresh one
+  private replace(worker: Worker): Worker {
+    worker.terminate()
+    const i = this.workers.indexOf(worker)
+    if (i < 0) return worker
+    this.workers[i] = this.spawn()
+    return this.workers[i]
+  }
+
+  private acquire(priority: number, signal?: AbortSignal): Promise<Worker> {
+    const worker = this.idle.pop()
+    if (worker) return Promise.resolve(worker)
+
+    return new Promise((resolve, reject) => {
+      const onAbort = () => {
+        this.waiters.splice(this.waiters.indexOf(waiter), 1)
+        reject(signal!.reason)
+      }
+      const waiter: Waiter = {
+        priority,
+        resolve: worker => {
+          signal?.removeEventListener('abort', onAbort)
+          resolve(worker)
+        }
+      }
+      // Behind every waiter of the same or a higher priority
+      const at = this.waiters.findIndex(w => w.priority < priority)
+      this.waiters.splice(at < 0 ? this.waiters.length : at, 0, waiter)
+      signal?.addEventListener('abort', onAbort, { once: true })
+    })
+  }
+
+  private release(worker: Worker): void {
+    // Workers of a terminated pool are not handed on
+    if (!this.workers.includes(worker)) return
+    const next = this.waiters.shift()
+    if (next) {
+      next.resolve(worker)
+    } else {
+      this.idle.push(worker)
+    }
+  }
+}
+
+/**
+ * zlib (RFC 1950) header matching what deflate() writes for this level
+ */
+export function zlibHeader(level: number): Uint8Array {
+  const flevel = level < 2 ? 0 : level < 6 ? 1 : level === 6 ? 2 : 3
+  let header = (0x78 << 8) | (flevel << 6)
+  header += 31 - (header % 31)
+  return new Uint8Array([header >> 8, header & 0xff])
+}
+
+/**
+ * gzip (RFC 1952) header with no name, time or extra fields
+ */
+export function gzipHeader(level: number): Uint8Array {
+  const xfl = level >= 9 ? 2 : level < 2 ? 4 : 0
+  return new Uint8Array([0x1f, 0x8b, 8, 0, 0, 0, 0, 0, xfl, 3])
+}
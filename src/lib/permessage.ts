@@ -0,0 +1,217 @@
+/**
+ * zlib.wasm permessage-deflate
+ * RFC 7692 websocket message compression over the zlib_deflate_* / zlib_inflate_* exports
+ */
+
+import { ZlibCompressionError, ZlibError, ZlibMemoryError } from './types.ts'
+import type { ZlibMemoryProfile, ZlibModule, ZlibPerMessageDeflateOptions } from './types.ts'
+import type { HeapBufferPool } from './heap.ts'
+import { concatChunks, initDeflate, memoryProfileCode } from './stream.ts'
+
+// zlib return and flush codes, and zlib_ctx_acquire() kinds
+const Z_OK = 0
+const Z_STREAM_END = 1
+const Z_BUF_ERROR = -5
+const Z_SYNC_FLUSH = 2
+const ZLIB_CTX_DEFLATE = 0
+const ZLIB_CTX_INFLATE = 1
+
+// The empty stored block that ends a sync flush, left off the wire (7.2.1)
+const TAIL = new Uint8Array([0x00, 0x00, 0xff, 0xff])
+
+// Output staged per process call; staging is pooled, not held per connection
+const CHUNK_SIZE = 16 * 1024
+
+interface Parameters {
+  sendBits: number
+  receiveBits: number
+  sendReset: boolean
+  receiveReset: boolean
+  level: number
+  memLevel: number
+  memoryProfile: ZlibMemoryProfile
+  maxMessageSize: number
+}
+
+function windowBits(bits: number | undefined, name: string): number {
+  bits = bits ?? 15
+  if (!Number.isInteger(bits) || bits < 8 || bits > 15) {
+    throw new ZlibError(`${name} must be 8..15, got ${bits}`)
+  }
+  return bits
+}
+
+function resolve(options: ZlibPerMessageDeflateOptions): Parameters {
+  const isServer = options.isServer ?? true
+  const server = windowBits(options.serverMaxWindowBits, 'serverMaxWindowBits')
+  const client = windowBits(options.clientMaxWindowBits, 'clientMaxWindowBits')
+  const serverReset = options.serverNoContextTakeover ?? false
+  const clientReset = options.clientNoContextTakeover ?? false
+
+  return {
+    sendBits: isServer ? server : client,
+    receiveBits: isServer ? client : server,
+    sendReset: isServer ? serverReset : clientReset,
+    receiveReset: isServer ? clientReset : serverReset,
+    level: options.level ?? 6,
+    memLevel: options.memLevel ?? 8,
+    memoryProfile: options.memoryProfile ?? 'fast',
+    maxMessageSize: options.maxMessageSize ?? Infinity
+  }
+}
+
+// zlib has no raw 256-byte deflate window. A 512-byte one never matches
+// further back than 250 bytes (w_size - MIN_LOOKAHEAD), so what it produces
+// still inflates within an 8-bit window.
+function deflateWindowBits(params: Parameters): number {
+  return -Math.max(9, params.sendBits)
+}
+
+/**
+ * zlib state one connection holds with these parameters, in bytes: a
+ * deflate context for sending plus an inflate context for receiving.
+ */
+export function perMessageDeflateMemory(module: ZlibModule, options: ZlibPerMessageDeflateOptions): number {
+  return memory(module, resolve(options))
+}
+
+function memory(module: ZlibModule, params: Parameters): number {
+  const profile = memoryProfileCode(module, params.memoryProfile)
+  return module._zlib_ctx_memory(ZLIB_CTX_DEFLATE, deflateWindowBits(params), params.memLevel, profile) +
+    module._zlib_ctx_memory(ZLIB_CTX_INFLATE, -params.receiveBits, 0, 0)
+}
+
+/**
+ * The permessage-deflate extension for one websocket connection.
+ *
+ * Messages are raw deflate, sync-flushed with the trailing 0x00 0x00 0xff
+ * 0xff removed. Unless no_context_takeover was negotiated for a direction,
+ * its context keeps the window from message to message, so repeated
+ * content across messages compresses to back-references.
+ */
+export class PerMessageDeflate {
+  private deflateCtx: number
+  private inflateCtx: number
+  private readonly params: Parameters
+
+  constructor(
+    private readonly module: ZlibModule,
+    private readonly pool: HeapBufferPool,
+    options: ZlibPerMessageDeflateOptions = {}
+  ) {
+    this.params = resolve(options)
+    this.deflateCtx = initDeflate(
+      module, this.params.level, deflateWindowBits(this.params), this.params.memLevel, 0, this.params.memoryProfile
+    )
+    this.inflateCtx = module._zlib_inflate_init(-this.params.receiveBits)
+
+    if (!this.deflateCtx || !this.inflateCtx) {
+      this.dispose()
+      throw new ZlibMemoryError('Failed to initialize permessage-deflate contexts')
+    }
+  }
+
+  /** Bytes of zlib state this connection holds */
+  get memory(): number {
+    return memory(this.module, this.params)
+  }
+
+  /** Compress one message into the payload of a frame with RSV1 set */
+  compress(message: Uint8Array): Uint8Array {
+    this.checkOpen()
+    const { output } = this.run(this.deflateCtx, message, false)
+    if (this.params.sendReset) this.checkReset(this.module._zlib_deflate_reset(this.deflateCtx))
+
+    // No new input since the last flush leaves nothing to flush; send the
+    // single 0x00 of an empty stored block instead (7.2.3.6)
+    if (output.length < TAIL.length) return new Uint8Array(1)
+    return output.subarray(0, output.length - TAIL.length)
+  }
+
+  /** Decompress the payload of a message received with RSV1 set */
+  decompress(payload: Uint8Array): Uint8Array {
+    this.checkOpen()
+    const { output, ended } = this.run(this.inflateCtx, payload, true)
+    // A final block ends the sender's stream, so the next message starts afresh
+    if (this.params.receiveReset || ended) {
+      this.checkReset(this.module._zlib_inflate_reset(this.inflateCtx))
+    }
+    return output
+  }
+
+  /** Free both contexts */
+  dispose(): void {
+    if (this.deflateCtx) this.module._zlib_deflate_end(this.deflateCtx)
+    if (this.inflateCtx) this.module._zlib_inflate_end(this.inflateCtx)
+    this.deflateCtx = 0
+    this.inflateCtx = 0
+  }
+
+  /**
+   * Deflate data with a sync flush, or (tail set) inflate it with the sync
+   * flush tail put back, using heap staging from the pool
+   */
+  private run(ctx: number, data: Uint8Array, tail: boolean): { output: Uint8Array, ended: boolean } {
+    const input = this.pool.acquire(data.length + TAIL.length).write(data)
+    const output = this.pool.acquire(CHUNK_SIZE)
+    const chunks: Uint8Array[] = []
+    let size = 0
+    let ended = false
+
+    try {
+      if (tail) {
+        this.module.HEAPU8.set(TAIL, input.ptr + input.length)
+        input.length += TAIL.length
+      }
+
+      let consumed = 0
+      for (;;) {
+        const remaining = input.length - consumed
+        const result = tail
+          ? this.module._zlib_inflate_process(ctx, input.ptr + consumed, remaining, output.ptr, output.capacity)
+          : this.module._zlib_deflate_process(
+              ctx, input.ptr + consumed, remaining, output.ptr, output.capacity, Z_SYNC_FLUSH)
+
+        if (result !== Z_OK && result !== Z_STREAM_END && result !== Z_BUF_ERROR) {
+          const op = tail ? 'Decompression' : 'Compression'
+          throw new ZlibCompressionError(`${op} failed with code: ${result}`)
+        }
+
+        const availOut = this.module._zlib_stream_avail_out(ctx)
+        consumed = input.length - this.module._zlib_stream_avail_in(ctx)
+
+        const produced = output.capacity - availOut
+        size += produced
+        if (tail && size > this.params.maxMessageSize) {
+          throw new ZlibMemoryError(`Message exceeds maxMessageSize (${this.params.maxMessageSize} bytes)`)
+        }
+        if (produced > 0) {
+          chunks.push(this.module.HEAPU8.slice(output.ptr, output.ptr + produced))
+        }
+
+        if (result === Z_STREAM_END) {
+          ended = true
+          break
+        }
+
+        // Output space left over means zlib has taken all the input it can
+        if (availOut !== 0 || result === Z_BUF_ERROR) break
+      }
+    } finally {
+      this.pool.release(input)
+      this.pool.release(output)
+    }
+
+    return { output: concatChunks(chunks), ended }
+  }
+
+  private checkReset(result: number): void {
+    if (result !== Z_OK) {
+      throw new ZlibCompressionError(`Context reset failed with code: ${result}`)
+    }
+  }
+
+  private checkOpen(): void {
+    if (!this.deflateCtx) throw new ZlibMemoryError('PerMessageDeflate has been disposed')
+  }
+}
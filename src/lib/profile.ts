@@ -0,0 +1,194 @@
+/**
+ * zlib.wasm parameter profiling
+ * Sweeps of level, strategy, windowBits and memLevel over a sample, and the
+ * speed/ratio Pareto frontier of the results
+ */
+
+import { ZlibCompression, ZlibCompressionError, ZlibError, ZlibMemoryError, ZlibStrategy } from './types.ts'
+import type { ZlibModule, ZlibProfileConfig, ZlibProfileOptions, ZlibProfilePoint } from './types.ts'
+import type { HeapBufferPool, ZlibHeapBuffer } from './heap.ts'
+
+// zlib flush and return codes
+const Z_FINISH = 4
+const Z_STREAM_END = 1
+
+const MB = 1024 * 1024
+
+export const DEFAULT_PROFILE_LEVELS = [1, 2, 3, 4, 5, 6, 7, 8, 9, ZlibCompression.ULTRA_COMPRESSION]
+export const DEFAULT_PROFILE_WINDOW_BITS = [12, 15]
+export const DEFAULT_PROFILE_MEM_LEVELS = [8, 9]
+
+// Time per measurement, at least, and runs, at least
+export const DEFAULT_PROFILE_MIN_TIME = 50
+export const DEFAULT_PROFILE_MIN_RUNS = 3
+
+// Link speed the recommendation trades compression time against: 100 Mbit/s
+export const DEFAULT_PROFILE_BANDWIDTH = 12.5
+
+/**
+ * Every combination of the options, in order, leaving out ones deflate would
+ * run identically: Huffman-only and RLE blocks never consult the level's
+ * match settings, so those two strategies run at one level only
+ */
+export function profileGrid(options: ZlibProfileOptions = {}): ZlibProfileConfig[] {
+  const levels = options.levels ?? DEFAULT_PROFILE_LEVELS
+  const strategies = options.strategies ?? (Object.values(ZlibStrategy).filter(v => typeof v === 'number') as ZlibStrategy[])
+  const windowBits = options.windowBits ?? DEFAULT_PROFILE_WINDOW_BITS
+  const memLevels = options.memLevels ?? DEFAULT_PROFILE_MEM_LEVELS
+
+  for (const level of levels) {
+    if (!Number.isInteger(level) || level < 1 || level > ZlibCompression.ULTRA_COMPRESSION) {
+      throw new ZlibError(`Profile levels must be 1..10, got ${level}`)
+    }
+  }
+  for (const strategy of strategies) {
+    if (!Number.isInteger(strategy) || strategy < ZlibStrategy.DEFAULT_STRATEGY || strategy > ZlibStrategy.MEDIUM) {
+      throw new ZlibError(`Unknown strategy ${strategy}`)
+    }
+  }
+  for (const bits of windowBits) {
+    if (!Number.isInteger(bits) || bits < 9 || bits > 15) {
+      throw new ZlibError(`Profile windowBits must be 9..15, got ${bits}`)
+    }
+  }
+  for (const memLevel of memLevels) {
+    if (!Number.isInteger(memLevel) || memLevel < 1 || memLevel > 9) {
+      throw new ZlibError(`Profile memLevels must be 1..9, got ${memLevel}`)
+    }
+  }
+
+  const levelFree = levels.includes(ZlibCompression.DEFAULT_COMPRESSION) ? ZlibCompression.DEFAULT_COMPRESSION : levels[0]
+  const grid: ZlibProfileConfig[] = []
+  for (const strategy of strategies) {
+    const ignoresLevel = strategy === ZlibStrategy.HUFFMAN_ONLY || strategy === ZlibStrategy.RLE
+    for (const level of ignoresLevel ? [levelFree] : levels) {
+      for (const bits of windowBits) {
+        for (const memLevel of memLevels) {
+          grid.push({ level, strategy, windowBits: bits, memLevel })
+        }
+      }
+    }
+  }
+  return grid
+}
+
+// Worst case for any windowBits and memLevel: deflateBound() without the
+// default-parameters shortcut, plus the largest wrapper
+function deflateBound(length: number): number {
+  return length + ((length + 7) >> 3) + ((length + 63) >> 6) + 5 + 18
+}
+
+// Run fn until both minimums are met; MB/s over all runs
+function throughput(bytes: number, minRuns: number, minTime: number, fn: () => void): number {
+  let runs = 0
+  let totalMs = 0
+  while (runs < minRuns || totalMs < minTime) {
+    const start = performance.now()
+    fn()
+    totalMs += performance.now() - start
+    runs++
+  }
+  return (bytes * runs / MB) / (Math.max(totalMs, 1e-3) / 1000)
+}
+
+function deflateOnce(module: ZlibModule, input: ZlibHeapBuffer, output: ZlibHeapBuffer, config: ZlibProfileConfig): number {
+  const ctx = module._zlib_deflate_init(config.level, config.windowBits, config.memLevel, config.strategy)
+  if (!ctx) {
+    throw new ZlibMemoryError('Failed to initialize profile deflate stream')
+  }
+  try {
+    const result = module._zlib_deflate_process(ctx, input.ptr, input.length, output.ptr, output.capacity, Z_FINISH)
+    if (result !== Z_STREAM_END) {
+      throw new ZlibCompressionError(`Compression failed with code: ${result}`)
+    }
+    return output.capacity - module._zlib_stream_avail_out(ctx)
+  } finally {
+    module._zlib_deflate_end(ctx)
+  }
+}
+
+function inflateOnce(module: ZlibModule, input: ZlibHeapBuffer, output: ZlibHeapBuffer, windowBits: number): number {
+  const ctx = module._zlib_inflate_init(windowBits)
+  if (!ctx) {
+    throw new ZlibMemoryError('Failed to initialize profile inflate stream')
+  }
+  try {
+    const result = module._zlib_inflate_process(ctx, input.ptr, input.length, output.ptr, output.capacity)
+    if (result !== Z_STREAM_END) {
+      throw new ZlibCompressionError(`Decompression failed with code: ${result}`)
+    }
+    return output.capacity - module._zlib_stream_avail_out(ctx)
+  } finally {
+    module._zlib_inflate_end(ctx)
+  }
+}
+
+/**
+ * Compress and decompress sample as one zlib stream with config, checking
+ * the round trip once, and time each direction
+ */
+export function measureProfileConfig(
+  module: ZlibModule,
+  pool: HeapBufferPool,
+  sample: Uint8Array,
+  config: ZlibProfileConfig,
+  minRuns = DEFAULT_PROFILE_MIN_RUNS,
+  minTime = DEFAULT_PROFILE_MIN_TIME
+): ZlibProfilePoint {
+  const input = pool.acquire(sample.length).write(sample)
+  const compressed = pool.acquire(deflateBound(sample.length))
+  // Room past the sample, so a stream that inflates to more than it fails
+  const restored = pool.acquire(sample.length + 1)
+
+  try {
+    compressed.length = deflateOnce(module, input, compressed, config)
+    restored.length = inflateOnce(module, compressed, restored, config.windowBits)
+    const view = restored.view
+    if (view.length !== sample.length || view.some((byte, i) => byte !== sample[i])) {
+      throw new ZlibCompressionError('Profile round trip did not restore the sample')
+    }
+
+    return {
+      ...config,
+      compressedSize: compressed.length,
+      ratio: sample.length / compressed.length,
+      compressMBps: throughput(sample.length, minRuns, minTime, () => deflateOnce(module, input, compressed, config)),
+      decompressMBps: throughput(sample.length, minRuns, minTime, () => inflateOnce(module, compressed, restored, config.windowBits))
+    }
+  } finally {
+    pool.release(input)
+    pool.release(compressed)
+    pool.release(restored)
+  }
+}
+
+/**
+ * Points no other point beats on both compression speed and ratio, fastest
+ * first (and so in rising ratio)
+ */
+export function paretoFrontier(points: ZlibProfilePoint[]): ZlibProfilePoint[] {
+  const sorted = [...points].sort((a, b) => b.compressMBps - a.compressMBps || b.ratio - a.ratio)
+  const frontier: ZlibProfilePoint[] = []
+  for (const point of sorted) {
+    if (frontier.length === 0 || point.ratio > frontier[frontier.length - 1].ratio) frontier.push(point)
+  }
+  return frontier
+}
+
+/**
+ * The point that gets data across a link of bandwidthMBps soonest, counting
+ * compression, transfer of the compressed bytes and decompression, among
+ * those compressing at minCompressMBps or more (all of them if none does)
+ */
+export function recommendProfile(
+  points: ZlibProfilePoint[],
+  bandwidthMBps = DEFAULT_PROFILE_BANDWIDTH,
+  minCompressMBps = 0
+): ZlibProfilePoint {
+  const fastEnough = points.filter(point => point.compressMBps >= minCompressMBps)
+  const candidates = fastEnough.length > 0 ? fastEnough : points
+  // Seconds per MB of input
+  const cost = (point: ZlibProfilePoint) =>
+    1 / point.compressMBps + 1 / (point.ratio * bandwidthMBps) + 1 / point.decompressMBps
+  return candidates.reduce((best, point) => cost(point) < cost(best) ? point : best)
+}
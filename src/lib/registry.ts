@@ -0,0 +1,175 @@
+/**
+ * zlib.wasm dictionary registry
+ * Preset dictionaries by Adler-32 id, held once in shared memory for the
+ * instance and its pool workers, and loaded into each heap on first use
+ */
+
+import { ZlibError } from './types.ts'
+import type { ZlibDictionaryEntry } from './types.ts'
+import type { ZlibDictionary } from './dictionary.ts'
+
+// exportDictionaries() layout: magic and entry count, then each entry's id,
+// length and bytes, all little-endian
+const MAGIC = 0x4349445a // 'ZDIC'
+const HEADER_SIZE = 8
+const ENTRY_HEADER_SIZE = 8
+
+function hex(id: number): string {
+  return '0x' + id.toString(16).padStart(8, '0')
+}
+
+function sameBytes(a: Uint8Array, b: Uint8Array): boolean {
+  if (a.length !== b.length) return false
+  for (let i = 0; i < a.length; i++) {
+    if (a[i] !== b[i]) return false
+  }
+  return true
+}
+
+/**
+ * A copy of bytes in a SharedArrayBuffer where the host has one, so that
+ * posting it to a worker shares it rather than cloning it
+ */
+export function sharedCopy(bytes: Uint8Array): Uint8Array {
+  const copy = new Uint8Array(typeof SharedArrayBuffer !== 'undefined'
+    ? new SharedArrayBuffer(bytes.length)
+    : new ArrayBuffer(bytes.length))
+  copy.set(bytes)
+  return copy
+}
+
+/**
+ * The dictionary id a zlib header asks for (FDICT set), or null for input
+ * that is not zlib or needs no dictionary
+ */
+export function presetDictionaryId(data: Uint8Array): number | null {
+  if (data.length < 6 || (data[0] & 0x0f) !== 8 || (data[0] >> 4) > 7 ||
+      ((data[0] << 8) | data[1]) % 31 !== 0 || !(data[1] & 0x20)) {
+    return null
+  }
+  return ((data[2] << 24) | (data[3] << 16) | (data[4] << 8) | data[5]) >>> 0
+}
+
+export function encodeDictionaries(entries: ZlibDictionaryEntry[]): Uint8Array {
+  const size = entries.reduce((n, entry) => n + ENTRY_HEADER_SIZE + entry.bytes.length, HEADER_SIZE)
+  const out = new Uint8Array(size)
+  const view = new DataView(out.buffer)
+  view.setUint32(0, MAGIC, true)
+  view.setUint32(4, entries.length, true)
+  let pos = HEADER_SIZE
+  for (const entry of entries) {
+    view.setUint32(pos, entry.id, true)
+    view.setUint32(pos + 4, entry.bytes.length, true)
+    out.set(entry.bytes, pos + ENTRY_HEADER_SIZE)
+    pos += ENTRY_HEADER_SIZE + entry.bytes.length
+  }
+  return out
+}
+
+/** Entries of an exportDictionaries() blob, each copied into shared memory */
+export function decodeDictionaries(data: Uint8Array): ZlibDictionaryEntry[] {
+  const view = new DataView(data.buffer, data.byteOffset, data.byteLength)
+  if (data.length < HEADER_SIZE || view.getUint32(0, true) !== MAGIC) {
+    throw new ZlibError('Not a dictionary registry export')
+  }
+  const count = view.getUint32(4, true)
+  const entries: ZlibDictionaryEntry[] = []
+  let pos = HEADER_SIZE
+  for (let i = 0; i < count; i++) {
+    if (data.length - pos < ENTRY_HEADER_SIZE) {
+      throw new ZlibError(`Dictionary registry export is truncated at entry ${i}`)
+    }
+    const id = view.getUint32(pos, true)
+    const length = view.getUint32(pos + 4, true)
+    pos += ENTRY_HEADER_SIZE
+    if (data.length - pos < length) {
+      throw new ZlibError(`Dictionary registry export is truncated at entry ${i}`)
+    }
+    entries.push({ id, bytes: sharedCopy(data.subarray(pos, pos + length)) })
+    pos += length
+  }
+  return entries
+}
+
+/**
+ * Dictionaries by id. The bytes are kept as given, never copied or
+ * written, so an entry in a SharedArrayBuffer is one copy for every
+ * registry holding it. Each registry loads its own heap copy with load()
+ * the first time resolve() asks for an id, and checks its Adler-32 then.
+ */
+export class ZlibDictionaryRegistry {
+  private readonly entries = new Map<number, Uint8Array>()
+  // Heap copies loaded so far, by id
+  private readonly loaded = new Map<number, ZlibDictionary>()
+
+  constructor(
+    private readonly load: (bytes: Uint8Array) => ZlibDictionary,
+    private readonly release: (dictionary: ZlibDictionary) => void
+  ) {}
+
+  get size(): number {
+    return this.entries.size
+  }
+
+  /**
+   * Register bytes under id, returning false when they already are. An id
+   * already registered to different bytes is refused.
+   */
+  add(id: number, bytes: Uint8Array): boolean {
+    const existing = this.entries.get(id)
+    if (existing) {
+      if (!sameBytes(existing, bytes)) {
+        throw new ZlibError(`Dictionary id ${hex(id)} is already registered to different bytes`)
+      }
+      return false
+    }
+    this.entries.set(id, bytes)
+    return true
+  }
+
+  /** Take a dictionary this instance already loaded as the heap copy of its id */
+  adopt(dictionary: ZlibDictionary): void {
+    if (!this.loaded.has(dictionary.id)) this.loaded.set(dictionary.id, dictionary)
+  }
+
+  has(id: number): boolean {
+    return this.entries.has(id)
+  }
+
+  /** Whether dictionary holds the bytes registered under its id */
+  holds(dictionary: ZlibDictionary): boolean {
+    if (this.loaded.get(dictionary.id) === dictionary) return true
+    const bytes = this.entries.get(dictionary.id)
+    return !!bytes && sameBytes(bytes, dictionary.buffer.view)
+  }
+
+  /** The heap copy of id, loaded on first use, or null if id is not registered */
+  resolve(id: number): ZlibDictionary | null {
+    const loaded = this.loaded.get(id)
+    if (loaded) return loaded
+
+    const bytes = this.entries.get(id)
+    if (!bytes) return null
+    const dictionary = this.load(bytes)
+    if (dictionary.id !== id) {
+      this.release(dictionary)
+      throw new ZlibError(`Dictionary registered as ${hex(id)} has Adler-32 ${hex(dictionary.id)}`)
+    }
+    this.loaded.set(id, dictionary)
+    return dictionary
+  }
+
+  list(): ZlibDictionaryEntry[] {
+    return Array.from(this.entries, ([id, bytes]) => ({ id, bytes }))
+  }
+
+  /** Drop the heap copy of dictionary, if it is one; the entry stays */
+  forget(dictionary: ZlibDictionary): void {
+    if (this.loaded.get(dictionary.id) === dictionary) this.loaded.delete(dictionary.id)
+  }
+
+  /** Drop every heap copy, for a heap that is gone; the entries stay */
+  unload(): void {
+    this.loaded.clear()
+  }
+}
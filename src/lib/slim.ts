@@ -0,0 +1,85 @@
+/**
+ * zlib.wasm slim builds
+ * What ZlibInflate and ZlibDeflate share: loading one of the half builds
+ * and the checksums both of them export
+ */
+
+import { ZlibError, ZlibInitError } from './types.ts'
+import type { ZlibLoadingOptions, ZlibModule } from './types.ts'
+import { HeapBufferPool } from './heap.ts'
+import { Adler32Hasher, Crc32Hasher } from './checksum.ts'
+import { DEFAULT_LOADING_OPTIONS, loadBuild } from './loader.ts'
+
+/**
+ * A module instance of zlib-release-core or zlib-release-deflate. These
+ * entry points import nothing from index.ts, so a bundle that only needs
+ * one half carries neither the other half's wasm nor the full wrapper.
+ */
+export abstract class ZlibSlim {
+  protected module: ZlibModule | null = null
+  protected heapPool: HeapBufferPool | null = null
+  private readonly loadingOptions: ZlibLoadingOptions
+
+  protected constructor(
+    private readonly artifact: string,
+    private readonly requiredFunctions: string[],
+    options: ZlibLoadingOptions
+  ) {
+    this.loadingOptions = { ...DEFAULT_LOADING_OPTIONS, ...options }
+  }
+
+  async initialize(): Promise<void> {
+    if (this.module) return
+
+    try {
+      const { module } = await loadBuild(this.loadingOptions, this.artifact)
+      for (const func of this.requiredFunctions) {
+        if (typeof module[func] !== 'function') {
+          throw new ZlibInitError(`Missing WASM function: ${func}`)
+        }
+      }
+      this.module = module
+      this.heapPool = new HeapBufferPool(module)
+    } catch (error) {
+      const errorMessage = error instanceof Error ? error.message : String(error);
+      throw new ZlibInitError(`Failed to initialize ${this.artifact}: ${errorMessage}`)
+    }
+  }
+
+  /**
+   * Calculate CRC32 checksum, continuing from crc if given
+   */
+  crc32(data: Uint8Array, crc = 0): number {
+    const hasher = new Crc32Hasher(this.ready(), this.heapPool!, crc)
+    try {
+      return hasher.update(data).digest()
+    } finally {
+      hasher.dispose()
+    }
+  }
+
+  /**
+   * Calculate Adler32 checksum, continuing from adler if given
+   */
+  adler32(data: Uint8Array, adler = 1): number {
+    const hasher = new Adler32Hasher(this.ready(), this.heapPool!, adler)
+    try {
+      return hasher.update(data).digest()
+    } finally {
+      hasher.dispose()
+    }
+  }
+
+  cleanup(): void {
+    this.heapPool?.dispose()
+    this.heapPool = null
+    this.module = null
+  }
+
+  protected ready(): ZlibModule {
+    if (!this.module) {
+      throw new ZlibError('zlib.wasm not initialized')
+    }
+    return this.module
+  }
+}
@@ -0,0 +1,745 @@
+/**
+ * zlib.wasm streaming
+ * WHATWG TransformStreams over the zlib_deflate_* / zlib_inflate_* exports
+ */
+
+import { ZlibCompression, ZlibCompressionError, ZlibError, ZlibMemoryError, ZlibStrategy } from './types.ts'
+import type { ZlibAdaptiveLevel, ZlibChunkTiming, ZlibInflateLimits, ZlibMemoryProfile, ZlibModule } from './types.ts'
+import type { HeapBufferPool, ZlibHeapBuffer } from './heap.ts'
+import { checkInflateLimits, hasInflateLimits } from './limits.ts'
+import { ZlibLevelController } from './adaptive.ts'
+
+// zlib return and flush codes used by the stream exports
+const Z_OK = 0
+const Z_STREAM_END = 1
+const Z_BUF_ERROR = -5
+const Z_NO_FLUSH = 0
+const Z_SYNC_FLUSH = 2
+const Z_FULL_FLUSH = 3
+const Z_FINISH = 4
+
+// zlib_deflate_init_profile() memory profiles
+const ZLIB_PROFILE_FAST = 0
+const ZLIB_PROFILE_LOW_MEMORY = 1
+
+// Default staging buffer size
+export const DEFAULT_CHUNK_SIZE = 64 * 1024
+
+// Range the input slice is tuned within when no chunkSize is given
+export const MIN_AUTO_SLICE = 64 * 1024
+export const MAX_AUTO_SLICE = 256 * 1024
+
+type StreamKind = 'deflate' | 'inflate'
+
+type Emit = (chunk: Uint8Array) => void
+
+export interface ZlibStreamTuning extends ZlibInflateLimits {
+  // Fixed slice size; left out, the slice follows the incoming chunk size
+  chunkSize?: number
+  onChunk?: (timing: ZlibChunkTiming) => void
+  // Deflate only: full-flush at every rsync boundary
+  rsyncable?: boolean
+  // gzip inflate only: carry on into a member that follows the end of one,
+  // and drop trailing bytes that are not one, as gunzip does
+  members?: boolean
+}
+
+/**
+ * One z_stream plus its input/output staging buffers on the WASM heap.
+ *
+ * Input is copied in at most chunkSize bytes at a time and output is drained
+ * in chunkSize pieces, so heap usage stays fixed however large the stream is.
+ * The TransformStream holds writers back while its readable side is full,
+ * which is what gives callers backpressure.
+ *
+ * Deflate coalesces: small chunks are gathered in the input buffer and only
+ * cross into WASM once it is full (or at the end), which changes nothing in
+ * the output since deflate buffers its input anyway without a flush. Inflate
+ * runs every chunk as it arrives, so its output is never held back. With
+ * autoTune the input slice grows towards the incoming chunk size, within
+ * MIN_AUTO_SLICE..MAX_AUTO_SLICE, and deflate's output buffer is sized to
+ * the slice's compress bound so a slice drains in one call.
+ *
+ * Where the build has the drain exports, output goes to a ring the context
+ * owns instead of a staging buffer, and each call reports where its bytes
+ * landed and what is left in four result cells, read straight from the
+ * heap rather than asked for with two more calls.
+ *
+ * An rsyncable deflate scans each staged piece for rsync boundaries and
+ * runs the input up to one with Z_FULL_FLUSH, then moves what follows it to
+ * the front of the staging buffer, so the output depends on where the
+ * boundaries fall in the data and not on how it was chunked.
+ *
+ * With inflate limits, every piece of output is checked against them as it
+ * leaves the loop, before it is handed on: a bomb stops within one output
+ * slice of the limit, and nothing past it is ever emitted.
+ *
+ * With members, input left over when a gzip member ends is moved to the
+ * front of the staging buffer and inflated as the next member once the
+ * context is reset, if it starts like one; otherwise it and everything
+ * after it is dropped.
+ */
+class ZlibStreamContext {
+  private ctx: number
+  private input: ZlibHeapBuffer
+  private output: ZlibHeapBuffer | null = null
+  // Address of the ring: {offset, length, avail_in, avail_out}, then the output
+  private results = 0
+  // rsyncable: the rolling hash cell, and the staged bytes already scanned
+  private hash: ZlibHeapBuffer | null = null
+  private scanned = 0
+  private readonly autoTune: boolean
+  private readonly onChunk?: (timing: ZlibChunkTiming) => void
+  // Inflate only: the limits, and the input and output counted against them
+  private readonly limits: ZlibInflateLimits | null
+  private totalIn = 0
+  private totalOut = 0
+  // members: input the last call left unread at the end of a member, and
+  // whether the rest of the input is being dropped
+  private readonly members: boolean
+  private unread = 0
+  private dropping = false
+  // Whether anything has been run through since the stream began
+  private started = false
+  // Set once inflate reaches the end of the stream
+  ended = false
+
+  constructor(
+    private readonly module: ZlibModule,
+    private readonly pool: HeapBufferPool,
+    private readonly kind: StreamKind,
+    ctx: number,
+    tuning: ZlibStreamTuning = {}
+  ) {
+    if (!ctx) {
+      throw new ZlibMemoryError(`Failed to initialize ${kind} stream`)
+    }
+    this.ctx = ctx
+    this.autoTune = tuning.chunkSize === undefined
+    this.onChunk = tuning.onChunk
+    this.limits = kind === 'inflate' && hasInflateLimits(tuning) ? tuning : null
+    this.members = kind === 'inflate' && tuning.members === true
+    if (tuning.rsyncable && kind === 'deflate') {
+      if (typeof module._zlib_rsync_scan !== 'function') {
+        throw new ZlibCompressionError('This build has no rsyncable mode')
+      }
+      this.hash = pool.acquire(4)
+      module.HEAP32[this.hash.ptr / 4] = 0
+    }
+    const slice = tuning.chunkSize ?? (this.autoTune ? MIN_AUTO_SLICE : DEFAULT_CHUNK_SIZE)
+    this.input = pool.acquire(slice)
+    this.stageOutput(slice)
+  }
+
+  /** Feed a chunk through the stream, enqueueing whatever it produces */
+  push(chunk: Uint8Array, emit: Emit): void {
+    this.tune(chunk.length)
+
+    if (this.kind === 'inflate') {
+      for (let offset = 0; offset < chunk.length && (!this.ended || this.members); offset += this.input.capacity) {
+        this.input.write(chunk.subarray(offset, offset + this.input.capacity))
+        this.totalIn += this.input.length
+        if (this.members) this.inflateMembers(emit)
+        else this.process(Z_NO_FLUSH, emit)
+      }
+      return
+    }
+
+    let offset = 0
+    while (offset < chunk.length) {
+      const n = Math.min(this.input.capacity - this.input.length, chunk.length - offset)
+      this.module.HEAPU8.set(chunk.subarray(offset, offset + n), this.input.ptr + this.input.length)
+      this.input.length += n
+      offset += n
+      if (this.hash) this.cut(emit)
+      if (this.input.length === this.input.capacity) {
+        this.process(Z_NO_FLUSH, emit)
+      }
+    }
+  }
+
+  /**
+   * Deflate what is staged with the given flush, so everything written so
+   * far can be inflated from the output; inflate holds nothing back, so
+   * there it does nothing
+   */
+  flush(mode: number, emit: Emit): void {
+    if (this.kind === 'deflate') this.process(mode, emit)
+  }
+
+  /**
+   * Change deflate's level and strategy from here on, after a sync flush
+   * of what came before, as node:zlib's params() does
+   */
+  params(level: number, strategy: number, emit: Emit): void {
+    if (typeof this.module._zlib_deflate_params !== 'function') {
+      throw new ZlibCompressionError('This build cannot change deflate parameters mid-stream')
+    }
+    // Before the first call deflate has nothing to flush, and a flush
+    // would only add an empty block
+    if (this.started || this.input.length > 0) this.process(Z_SYNC_FLUSH, emit)
+    const result = this.module._zlib_deflate_params(this.ctx, level, strategy)
+    if (result !== Z_OK) {
+      throw new ZlibCompressionError(`Changing deflate parameters failed with code: ${result}`)
+    }
+  }
+
+  /** End of input: finish the deflate stream, or check inflate reached its end */
+  finish(emit: Emit): void {
+    if (this.kind === 'deflate') {
+      this.process(Z_FINISH, emit)
+    } else if (!this.ended) {
+      throw new ZlibCompressionError('Decompression failed: stream truncated')
+    }
+  }
+
+  /** Start the next stream, keeping the window and staging buffers */
+  reset(): void {
+    this.restart()
+    this.input.length = 0
+    this.scanned = 0
+    this.dropping = false
+    this.started = false
+    this.totalIn = 0
+    this.totalOut = 0
+  }
+
+  private restart(): void {
+    if (!this.ctx) {
+      throw new ZlibMemoryError(`The ${this.kind} stream has been disposed`)
+    }
+    const result = this.kind === 'deflate'
+      ? this.module._zlib_deflate_reset(this.ctx)
+      : this.module._zlib_inflate_reset(this.ctx)
+    if (result !== Z_OK) {
+      throw new ZlibCompressionError(`Stream reset failed with code: ${result}`)
+    }
+    this.ended = false
+    this.unread = 0
+  }
+
+  // Inflate the staged input across as many gzip members as it holds
+  private inflateMembers(emit: Emit): void {
+    while (this.input.length > 0) {
+      if (this.ended) {
+        if (this.dropping || this.module.HEAPU8[this.input.ptr] !== 0x1f) {
+          this.dropping = true
+          this.input.length = 0
+          return
+        }
+        this.restart()
+      }
+
+      const length = this.input.length
+      this.process(Z_NO_FLUSH, emit)
+      if (!this.ended || this.unread === 0) return
+      const { ptr } = this.input
+      this.module.HEAPU8.copyWithin(ptr, ptr + length - this.unread, ptr + length)
+      this.input.length = this.unread
+    }
+  }
+
+  /** Free the z_stream and return the staging buffers to the pool */
+  dispose(): void {
+    if (!this.ctx) return
+    if (this.kind === 'deflate') {
+      this.module._zlib_deflate_end(this.ctx)
+    } else {
+      this.module._zlib_inflate_end(this.ctx)
+    }
+    // The ring goes back with the context
+    this.ctx = 0
+    this.results = 0
+    this.pool.release(this.input)
+    if (this.output) this.pool.release(this.output)
+    this.output = null
+    if (this.hash) this.pool.release(this.hash)
+    this.hash = null
+  }
+
+  // Full-flush the staged input at each rsync boundary in its unscanned part
+  private cut(emit: Emit): void {
+    const hash = this.hash!
+    const { ptr } = this.input
+    let length: number
+    while ((length = this.module._zlib_rsync_scan!(ptr + this.scanned, this.input.length - this.scanned, hash.ptr)) > 0) {
+      const boundary = this.scanned + length
+      const rest = this.input.length - boundary
+      this.input.length = boundary
+      this.process(Z_FULL_FLUSH, emit)
+      this.module.HEAPU8.copyWithin(ptr, ptr + boundary, ptr + boundary + rest)
+      this.input.length = rest
+      this.scanned = 0
+    }
+    this.scanned = this.input.length
+  }
+
+  private outputSize(slice: number): number {
+    return this.kind === 'deflate' ? this.module._zlib_compress_bound(slice) : slice
+  }
+
+  // A ring of twice the output slice, so every drain has a whole slice of
+  // room, or else a staging buffer from the pool
+  private stageOutput(slice: number): void {
+    if (typeof this.module._zlib_stream_ring === 'function') {
+      this.results = this.module._zlib_stream_ring(this.ctx, 2 * this.outputSize(slice))
+      if (!this.results) {
+        throw new ZlibMemoryError(`Failed to allocate the ${this.kind} stream's output ring`)
+      }
+      return
+    }
+    if (this.output) this.pool.release(this.output)
+    this.output = this.pool.acquire(this.outputSize(slice))
+  }
+
+  // Grow the staging buffers to fit chunks of size, between whole slices only
+  private tune(size: number): void {
+    if (!this.autoTune || this.input.length > 0 || size <= this.input.capacity) return
+    if (this.input.capacity >= MAX_AUTO_SLICE) return
+
+    let slice = this.input.capacity
+    while (slice < size && slice < MAX_AUTO_SLICE) slice *= 2
+    this.pool.release(this.input)
+    this.input = this.pool.acquire(slice)
+    this.stageOutput(slice)
+  }
+
+  // Run the staged input through, which always takes all of it, and time it
+  private process(flush: number, emit: Emit): void {
+    this.started = true
+    const inputBytes = this.input.length
+    let outputBytes = 0
+    const start = this.onChunk ? performance.now() : 0
+
+    this.run(flush, chunk => {
+      outputBytes += chunk.length
+      if (this.limits) {
+        this.totalOut += chunk.length
+        checkInflateLimits(this.limits, this.totalIn, this.totalOut)
+      }
+      emit(chunk)
+    })
+    this.input.length = 0
+    this.scanned = 0
+
+    this.onChunk?.({ inputBytes, outputBytes, timeMs: performance.now() - start })
+  }
+
+  private run(flush: number, emit: Emit): void {
+    if (this.results) return this.drain(flush, emit)
+
+    const output = this.output!
+    let consumed = 0
+
+    for (;;) {
+      const remaining = this.input.length - consumed
+      const result = this.kind === 'deflate'
+        ? this.module._zlib_deflate_process(
+            this.ctx, this.input.ptr + consumed, remaining,
+            output.ptr, output.capacity, flush)
+        : this.module._zlib_inflate_process(
+            this.ctx, this.input.ptr + consumed, remaining,
+            output.ptr, output.capacity)
+
+      if (result !== Z_OK && result !== Z_STREAM_END && result !== Z_BUF_ERROR) {
+        const op = this.kind === 'deflate' ? 'Compression' : 'Decompression'
+        throw new ZlibCompressionError(`${op} failed with code: ${result}`)
+      }
+
+      const availOut = this.module._zlib_stream_avail_out(this.ctx)
+      consumed = this.input.length - this.module._zlib_stream_avail_in(this.ctx)
+
+      output.length = output.capacity - availOut
+      if (output.length > 0) {
+        emit(output.view.slice())
+      }
+
+      if (result === Z_STREAM_END) {
+        this.ended = true
+        this.unread = this.input.length - consumed
+        return
+      }
+
+      // Output space left over means zlib has taken all the input it can
+      if (availOut !== 0 || result === Z_BUF_ERROR) return
+    }
+  }
+
+  // run() on the context's ring; later calls pick up the unread input
+  private drain(flush: number, emit: Emit): void {
+    let input = this.input.ptr
+
+    for (;;) {
+      const result = this.kind === 'deflate'
+        ? this.module._zlib_deflate_drain!(this.ctx, input, this.input.length, flush)
+        : this.module._zlib_inflate_drain!(this.ctx, input, this.input.length)
+      input = 0
+
+      if (result !== Z_OK && result !== Z_STREAM_END && result !== Z_BUF_ERROR) {
+        const op = this.kind === 'deflate' ? 'Compression' : 'Decompression'
+        throw new ZlibCompressionError(`${op} failed with code: ${result}`)
+      }
+
+      const cells = this.results / 4
+      const start = this.results + 16 + (this.module.HEAP32[cells] >>> 0)
+      const length = this.module.HEAP32[cells + 1] >>> 0
+      if (length > 0) {
+        emit(this.module.HEAPU8.slice(start, start + length))
+      }
+
+      if (result === Z_STREAM_END) {
+        this.ended = true
+        this.unread = this.module.HEAP32[cells + 2] >>> 0
+        return
+      }
+      if (this.module.HEAP32[cells + 3] !== 0 || result === Z_BUF_ERROR) return
+    }
+  }
+}
+
+/**
+ * Build a TransformStream around a freshly initialized stream context.
+ * The context is released on flush, on error and on cancellation.
+ */
+export function createZlibTransform(
+  module: ZlibModule,
+  pool: HeapBufferPool,
+  kind: StreamKind,
+  ctx: number,
+  tuning: ZlibStreamTuning = {}
+): TransformStream<Uint8Array, Uint8Array> {
+  const stream = new ZlibStreamContext(module, pool, kind, ctx, tuning)
+
+  return new TransformStream<Uint8Array, Uint8Array>({
+    transform(chunk, controller) {
+      try {
+        stream.push(chunk, output => controller.enqueue(output))
+      } catch (error) {
+        stream.dispose()
+        throw error
+      }
+    },
+    flush(controller) {
+      try {
+        stream.finish(output => controller.enqueue(output))
+      } finally {
+        stream.dispose()
+      }
+    },
+    cancel() {
+      stream.dispose()
+    }
+  })
+}
+
+// zlib's Z_DEFAULT_COMPRESSION (-1) is level 6, so a switch between them
+// changes nothing
+function defaultLevel(level: number): number {
+  return level === -1 ? ZlibCompression.DEFAULT_COMPRESSION : level
+}
+
+// The deflate context behind a ZlibDeflateStream and the settings it runs
+// at, built before the TransformStream so its callbacks can reach them
+class DeflateControl {
+  pending: { level: number, strategy: number } | null = null
+  readonly stream: ZlibStreamContext
+  // Whether the build has zlib_deflate_params()
+  readonly changeable: boolean
+  private readonly controller: ZlibLevelController | null
+
+  constructor(
+    module: ZlibModule,
+    pool: HeapBufferPool,
+    ctx: number,
+    public level: number,
+    public strategy: number,
+    tuning: ZlibStreamTuning,
+    private readonly adaptive?: ZlibAdaptiveLevel
+  ) {
+    this.level = defaultLevel(level)
+    this.changeable = typeof module._zlib_deflate_params === 'function'
+    if (adaptive && !this.changeable) {
+      throw new ZlibCompressionError('This build cannot change deflate parameters mid-stream')
+    }
+    const controller = adaptive ? new ZlibLevelController(this.level, adaptive) : null
+    this.controller = controller
+    this.stream = new ZlibStreamContext(module, pool, 'deflate', ctx, controller
+      ? { ...tuning, onChunk: timing => {
+        controller.record(timing)
+        tuning.onChunk?.(timing)
+      } }
+      : tuning)
+    // A start outside the adaptive range moves into it at the first chunk
+    if (controller && controller.level !== this.level) this.pending = { level: controller.level, strategy }
+  }
+
+  transform(chunk: Uint8Array, emit: Emit): void {
+    if (this.pending) {
+      const { level, strategy } = this.pending
+      this.pending = null
+      if (level !== this.level || strategy !== this.strategy) this.change(level, strategy, emit)
+    }
+    this.stream.push(chunk, emit)
+
+    const change = this.controller?.decide()
+    if (change) {
+      this.change(change.level, this.strategy, emit)
+      this.adaptive!.onChange?.(change)
+    }
+  }
+
+  private change(level: number, strategy: number, emit: Emit): void {
+    this.stream.params(level, strategy, emit)
+    this.level = level
+    this.strategy = strategy
+    if (this.controller) this.controller.level = level
+  }
+}
+
+/**
+ * A compressing TransformStream whose level and strategy can change while
+ * it runs. setLevel() and setStrategy() take effect at the next chunk
+ * written, after a sync flush of what came before. With adaptive, the level
+ * also follows a ZlibLevelController: up while the stream mostly waits on
+ * its sink or source, down while deflate is what holds it back.
+ */
+export class ZlibDeflateStream extends TransformStream<Uint8Array, Uint8Array> {
+  private readonly control: DeflateControl
+
+  constructor(
+    module: ZlibModule,
+    pool: HeapBufferPool,
+    ctx: number,
+    level: number,
+    strategy: number,
+    tuning: ZlibStreamTuning = {},
+    adaptive?: ZlibAdaptiveLevel
+  ) {
+    const control = new DeflateControl(module, pool, ctx, level, strategy, tuning, adaptive)
+    super({
+      transform(chunk, controller) {
+        try {
+          control.transform(chunk, output => controller.enqueue(output))
+        } catch (error) {
+          control.stream.dispose()
+          throw error
+        }
+      },
+      flush(controller) {
+        try {
+          control.stream.finish(output => controller.enqueue(output))
+        } finally {
+          control.stream.dispose()
+        }
+      },
+      cancel() {
+        control.stream.dispose()
+      }
+    })
+    this.control = control
+  }
+
+  /** The level from the next chunk on */
+  get level(): number {
+    return (this.control.pending ?? this.control).level
+  }
+
+  /** The strategy from the next chunk on */
+  get strategy(): number {
+    return (this.control.pending ?? this.control).strategy
+  }
+
+  setLevel(level: number): void {
+    if (!Number.isInteger(level) || level < -1 || level > ZlibCompression.ULTRA_COMPRESSION) {
+      throw new ZlibError(`Deflate level must be -1..10, got ${level}`)
+    }
+    this.changeable()
+    this.control.pending = { level: defaultLevel(level), strategy: this.strategy }
+  }
+
+  setStrategy(strategy: number): void {
+    if (!Number.isInteger(strategy) || strategy < 0 || strategy > ZlibStrategy.MEDIUM) {
+      throw new ZlibError(`Invalid deflate strategy ${strategy}`)
+    }
+    this.changeable()
+    this.control.pending = { level: this.level, strategy }
+  }
+
+  private changeable(): void {
+    if (!this.control.changeable) {
+      throw new ZlibCompressionError('This build cannot change deflate parameters mid-stream')
+    }
+  }
+}
+
+/**
+ * Run a whole buffer through a freshly initialized stream context without a
+ * TransformStream. The heap only ever holds the context and two chunkSize
+ * staging buffers, however large data or its output is.
+ */
+export function streamBuffer(
+  module: ZlibModule,
+  pool: HeapBufferPool,
+  kind: StreamKind,
+  ctx: number,
+  data: Uint8Array,
+  tuning: ZlibStreamTuning = { chunkSize: DEFAULT_CHUNK_SIZE }
+): Uint8Array {
+  const stream = new ZlibStreamContext(module, pool, kind, ctx, tuning)
+  const chunks: Uint8Array[] = []
+
+  try {
+    stream.push(data, chunk => chunks.push(chunk))
+    stream.finish(chunk => chunks.push(chunk))
+  } finally {
+    stream.dispose()
+  }
+  return concatChunks(chunks)
+}
+
+/** Join output chunks, without copying when there is only one */
+export function concatChunks(chunks: Uint8Array[]): Uint8Array {
+  if (chunks.length === 1) return chunks[0]
+
+  const output = new Uint8Array(chunks.reduce((total, chunk) => total + chunk.length, 0))
+  let offset = 0
+  for (const chunk of chunks) {
+    output.set(chunk, offset)
+    offset += chunk.length
+  }
+  return output
+}
+
+/**
+ * An inflate context kept across many short streams, such as the messages
+ * on one connection. reset() starts the next stream without giving up the
+ * 32 KB window or the staging buffers, which a fresh context would have to
+ * allocate again.
+ */
+export class ZlibInflater {
+  private readonly stream: ZlibStreamContext
+
+  constructor(
+    module: ZlibModule,
+    pool: HeapBufferPool,
+    ctx: number,
+    chunkSize = DEFAULT_CHUNK_SIZE,
+    limits: ZlibInflateLimits = {}
+  ) {
+    // The limits apply to each stream, from one reset() to the next
+    const { maxOutputSize, maxRatio } = limits
+    this.stream = new ZlibStreamContext(module, pool, 'inflate', ctx, { chunkSize, maxOutputSize, maxRatio })
+  }
+
+  /** True once the current stream has reached its end */
+  get ended(): boolean {
+    return this.stream.ended
+  }
+
+  /** Inflate more of the current stream and return what it produced */
+  push(input: Uint8Array): Uint8Array {
+    const chunks: Uint8Array[] = []
+    this.stream.push(input, chunk => chunks.push(chunk))
+    return concatChunks(chunks)
+  }
+
+  /** Inflate one complete stream, then reset for the next */
+  inflate(input: Uint8Array): Uint8Array {
+    try {
+      const output = this.push(input)
+      this.stream.finish(() => {})
+      return output
+    } finally {
+      this.stream.reset()
+    }
+  }
+
+  /** Discard the rest of the current stream and start the next */
+  reset(): void {
+    this.stream.reset()
+  }
+
+  /** Return the context and its buffers to their pools */
+  dispose(): void {
+    this.stream.dispose()
+  }
+}
+
+/** The zlib_deflate_init_profile() code of a memory profile */
+export function memoryProfileCode(module: ZlibModule, profile: ZlibMemoryProfile = 'fast'): number {
+  if (profile === 'fast') return ZLIB_PROFILE_FAST
+  if (profile !== 'low') {
+    throw new ZlibError(`Unknown memory profile ${profile}`)
+  }
+  if (typeof module._zlib_deflate_init_profile !== 'function') {
+    throw new ZlibError('This build has no low-memory deflate profile')
+  }
+  return ZLIB_PROFILE_LOW_MEMORY
+}
+
+/** Initialize a deflate stream context in a memory profile */
+export function initDeflate(
+  module: ZlibModule,
+  level: number,
+  windowBits: number,
+  memLevel: number,
+  strategy: number,
+  profile: ZlibMemoryProfile = 'fast'
+): number {
+  const code = memoryProfileCode(module, profile)
+  return code === ZLIB_PROFILE_FAST
+    ? module._zlib_deflate_init(level, windowBits, memLevel, strategy)
+    : module._zlib_deflate_init_profile!(level, windowBits, memLevel, strategy, code)
+}
+
+/**
+ * A deflate or inflate stream driven call by call rather than through a
+ * TransformStream, for adaptors that need to flush or change parameters
+ * mid-stream (node.ts). Output is handed to emit as copies out of the
+ * heap; the context and its staging buffers are reused throughout.
+ */
+export class ZlibCodec {
+  private readonly stream: ZlibStreamContext
+
+  constructor(
+    module: ZlibModule,
+    pool: HeapBufferPool,
+    readonly kind: StreamKind,
+    ctx: number,
+    tuning: ZlibStreamTuning = {}
+  ) {
+    this.stream = new ZlibStreamContext(module, pool, kind, ctx, tuning)
+  }
+
+  /** True once inflate has reached the end of the stream */
+  get ended(): boolean {
+    return this.stream.ended
+  }
+
+  write(chunk: Uint8Array, emit: Emit): void {
+    this.stream.push(chunk, emit)
+  }
+
+  /** Z_SYNC_FLUSH, Z_FULL_FLUSH or another zlib flush code; no-op for inflate */
+  flush(mode: number, emit: Emit): void {
+    this.stream.flush(mode, emit)
+  }
+
+  params(level: number, strategy: number, emit: Emit): void {
+    this.stream.params(level, strategy, emit)
+  }
+
+  /** Finish deflate, or check inflate reached its end */
+  end(emit: Emit): void {
+    this.stream.finish(emit)
+  }
+
+  /** Drop the current stream and start another on the same context */
+  reset(): void {
+    this.stream.reset()
+  }
+
+  dispose(): void {
+    this.stream.dispose()
+  }
+}
@@ -0,0 +1,375 @@
+/**
+ * zlib.wasm tar archives
+ * ustar read and written block by block over the inflate and deflate
+ * streams, as contrib/untgz reads it but with no files and no gzread()
+ */
+
+import { ZlibCompressionError } from './types.ts'
+import type { ZlibTarEntry, ZlibTarEntryType, ZlibTarStreamEntry } from './types.ts'
+
+const BLOCK = 512
+
+// Largest value the octal fields can hold: size and mtime have 11 digits,
+// mode, uid and gid 7
+const MAX_OCTAL_11 = 0o77777777777
+const MAX_OCTAL_7 = 0o7777777
+
+const encoder = new TextEncoder()
+const decoder = new TextDecoder()
+
+// Type flags by entry type, and back; '0', '7' and NUL are all files
+const TYPE_FLAGS: Record<ZlibTarEntryType, number> = {
+  file: 0x30,
+  link: 0x31,
+  symlink: 0x32,
+  directory: 0x35,
+  other: 0x36
+}
+
+function entryType(flag: number): ZlibTarEntryType {
+  switch (flag) {
+    case 0: case 0x30: case 0x37: return 'file'
+    case 0x31: return 'link'
+    case 0x32: return 'symlink'
+    case 0x35: return 'directory'
+    default: return 'other'
+  }
+}
+
+// Bytes of an inflated stream, handed out as views of its chunks, which
+// the inflate stream never reuses
+class ChunkReader {
+  private chunk = new Uint8Array(0)
+  private offset = 0
+  // Bytes handed out so far
+  position = 0
+
+  constructor(private readonly source: AsyncIterator<Uint8Array>) {}
+
+  /** Up to max bytes from the current chunk, or null at the end */
+  async next(max: number): Promise<Uint8Array | null> {
+    while (this.offset === this.chunk.length) {
+      const { value, done } = await this.source.next()
+      if (done) return null
+      this.chunk = value
+      this.offset = 0
+    }
+    const view = this.chunk.subarray(this.offset, this.offset + Math.min(max, this.chunk.length - this.offset))
+    this.offset += view.length
+    this.position += view.length
+    return view
+  }
+
+  /** length bytes, or fewer at the end; copied only across chunks */
+  async read(length: number): Promise<Uint8Array> {
+    const first = await this.next(length)
+    if (!first) return new Uint8Array(0)
+    if (first.length === length) return first
+
+    const bytes = new Uint8Array(length)
+    bytes.set(first)
+    let got = first.length
+    while (got < length) {
+      const view = await this.next(length - got)
+      if (!view) return bytes.subarray(0, got)
+      bytes.set(view, got)
+      got += view.length
+    }
+    return bytes
+  }
+
+  /** Pass over length bytes; false if the stream ends first */
+  async skip(length: number): Promise<boolean> {
+    while (length > 0) {
+      const view = await this.next(length)
+      if (!view) return false
+      length -= view.length
+    }
+    return true
+  }
+}
+
+// A NUL-terminated string field
+function text(block: Uint8Array, start: number, length: number): string {
+  const field = block.subarray(start, start + length)
+  const end = field.indexOf(0)
+  return decoder.decode(end < 0 ? field : field.subarray(0, end))
+}
+
+// An octal field, or base-256 when its top bit is set, as GNU tar writes
+// sizes of 8 GB or more
+function number(block: Uint8Array, start: number, length: number): number {
+  if (block[start] & 0x80) {
+    let value = block[start] & 0x7f
+    for (let i = 1; i < length; i++) value = value * 256 + block[start + i]
+    return value
+  }
+  const digits = text(block, start, length).trim()
+  return digits ? parseInt(digits, 8) : 0
+}
+
+// Sum of the header's bytes with the checksum field read as spaces
+function checksum(block: Uint8Array): number {
+  let sum = 8 * 0x20
+  for (let i = 0; i < BLOCK; i++) {
+    if (i < 148 || i >= 156) sum += block[i]
+  }
+  return sum
+}
+
+function padding(size: number): number {
+  return (BLOCK - size % BLOCK) % BLOCK
+}
+
+// pax extended header records: "<length> <key>=<value>\n"
+function parsePax(bytes: Uint8Array): Record<string, string> {
+  const records: Record<string, string> = {}
+  let offset = 0
+  while (offset < bytes.length) {
+    const space = bytes.indexOf(0x20, offset)
+    const length = space < 0 ? 0 : parseInt(decoder.decode(bytes.subarray(offset, space)), 10)
+    if (!(length > 0) || offset + length > bytes.length) break
+
+    const record = decoder.decode(bytes.subarray(space + 1, offset + length - 1))
+    const equals = record.indexOf('=')
+    if (equals > 0) records[record.slice(0, equals)] = record.slice(equals + 1)
+    offset += length
+  }
+  return records
+}
+
+/** A stream of the chunks of source, pulled one at a time */
+export function chunkStream(source: AsyncIterable<Uint8Array> | Uint8Array): ReadableStream<Uint8Array> {
+  const chunks = source instanceof Uint8Array
+    ? [source][Symbol.iterator]()
+    : source[Symbol.asyncIterator]()
+  return new ReadableStream<Uint8Array>({
+    async pull(controller) {
+      const { value, done } = await chunks.next()
+      if (done) {
+        controller.close()
+      } else {
+        controller.enqueue(value)
+      }
+    },
+    async cancel() {
+      await chunks.return?.()
+    }
+  })
+}
+
+/**
+ * Read tar entries from inflated chunks as they arrive. Each entry's data
+ * is a stream over the archive itself, only readable until the next entry
+ * is asked for; whatever is left of it then is skipped, not buffered.
+ * ustar names with a prefix, GNU long names ('L' and 'K') and pax headers
+ * ('x', and 'g' for every later entry) are all applied.
+ */
+export async function* readTar(source: AsyncIterator<Uint8Array>): AsyncGenerator<ZlibTarEntry> {
+  const reader = new ChunkReader(source)
+  const global: Record<string, string> = {}
+  let pax: Record<string, string> = {}
+  let longName: string | null = null
+  let longLink: string | null = null
+
+  while (true) {
+    const offset = reader.position
+    const block = await reader.read(BLOCK)
+    // A stream that stops at a block boundary is accepted without the end marker
+    if (block.length === 0) return
+    if (block.length < BLOCK) {
+      throw new ZlibCompressionError(`tar header at offset ${offset} is truncated`)
+    }
+    if (block.every(byte => byte === 0)) return
+    if (checksum(block) !== number(block, 148, 8)) {
+      throw new ZlibCompressionError(`Invalid tar header at offset ${offset}`)
+    }
+
+    const flag = block[156]
+    let size = number(block, 124, 12)
+
+    // Headers that describe the entry after them
+    if (flag === 0x78 || flag === 0x67 || flag === 0x4c || flag === 0x4b) {
+      const body = await reader.read(size + padding(size))
+      if (body.length < size + padding(size)) {
+        throw new ZlibCompressionError(`tar header at offset ${offset} is truncated`)
+      }
+      const content = body.subarray(0, size)
+      if (flag === 0x78) pax = parsePax(content)
+      else if (flag === 0x67) Object.assign(global, parsePax(content))
+      else if (flag === 0x4c) longName = text(content, 0, size)
+      else longLink = text(content, 0, size)
+      continue
+    }
+
+    const meta = { ...global, ...pax }
+    if (meta.size !== undefined) size = Number(meta.size)
+
+    // Only POSIX ustar ("ustar\0") has a prefix; GNU's "ustar  " keeps other fields there
+    const prefix = block[257] === 0x75 && block[262] === 0 && block[345] ? text(block, 345, 155) + '/' : ''
+    const name = meta.path ?? longName ?? prefix + text(block, 0, 100)
+    const type = entryType(flag)
+    // Only files carry data; a hard link's size, if any, is not followed by it
+    const length = type === 'file' || type === 'other' ? size : 0
+
+    let left = length
+    const data = new ReadableStream<Uint8Array>({
+      async pull(controller) {
+        if (left === 0) {
+          controller.close()
+          return
+        }
+        const view = await reader.next(left)
+        if (!view) {
+          left = 0
+          controller.error(new ZlibCompressionError(`tar entry ${name} is truncated`))
+          return
+        }
+        left -= view.length
+        controller.enqueue(view)
+      }
+    }, { highWaterMark: 0 })
+
+    yield {
+      name,
+      type,
+      size: length,
+      mode: number(block, 100, 8),
+      uid: meta.uid !== undefined ? Number(meta.uid) : number(block, 108, 8),
+      gid: meta.gid !== undefined ? Number(meta.gid) : number(block, 116, 8),
+      modified: new Date(1000 * (meta.mtime !== undefined ? Number(meta.mtime) : number(block, 136, 12))),
+      linkName: meta.linkpath ?? longLink ?? text(block, 157, 100),
+      data
+    }
+
+    // Past whatever the caller left unread, and the padding
+    const rest = left + padding(length)
+    left = 0
+    if (!await reader.skip(rest)) {
+      throw new ZlibCompressionError(`tar entry ${name} is truncated`)
+    }
+    pax = {}
+    longName = null
+    longLink = null
+  }
+}
+
+// An octal field of length bytes, space-free and NUL-terminated
+function putOctal(block: Uint8Array, start: number, length: number, value: number): void {
+  block.set(encoder.encode(Math.floor(value).toString(8).padStart(length - 1, '0')), start)
+}
+
+function putText(block: Uint8Array, start: number, length: number, value: string): void {
+  block.set(encoder.encode(value).subarray(0, length), start)
+}
+
+// A pax record, whose length counts its own digits
+function paxRecord(key: string, value: string): string {
+  const body = ` ${key}=${value}\n`
+  const bytes = encoder.encode(body).length
+  let length = bytes + 1
+  while (length !== bytes + String(length).length) length = bytes + String(length).length
+  return `${length}${body}`
+}
+
+// Split a path between ustar's prefix (155 bytes) and name (100 bytes)
+// fields at a slash; null if it cannot be
+function splitName(bytes: Uint8Array): [string, string] | null {
+  if (bytes.length <= 100) return ['', decoder.decode(bytes)]
+  for (let i = Math.max(bytes.length - 101, 1); i <= Math.min(155, bytes.length - 2); i++) {
+    if (bytes[i] === 0x2f) {
+      return [decoder.decode(bytes.subarray(0, i)), decoder.decode(bytes.subarray(i + 1))]
+    }
+  }
+  return null
+}
+
+interface TarHeader {
+  name: string
+  flag: number
+  size: number
+  mode: number
+  uid: number
+  gid: number
+  modified: Date
+  linkName: string
+}
+
+function header(fields: TarHeader): Uint8Array {
+  const block = new Uint8Array(BLOCK)
+  const [prefix, name] = splitName(encoder.encode(fields.name)) ?? ['', fields.name]
+  putText(block, 0, 100, name)
+  putOctal(block, 100, 8, Math.min(fields.mode, MAX_OCTAL_7))
+  putOctal(block, 108, 8, Math.min(fields.uid, MAX_OCTAL_7))
+  putOctal(block, 116, 8, Math.min(fields.gid, MAX_OCTAL_7))
+  putOctal(block, 124, 12, Math.min(fields.size, MAX_OCTAL_11))
+  putOctal(block, 136, 12, Math.min(Math.max(fields.modified.getTime() / 1000, 0), MAX_OCTAL_11))
+  block[156] = fields.flag
+  putText(block, 157, 100, fields.linkName)
+  putText(block, 257, 8, 'ustar\u000000')
+  putText(block, 345, 155, prefix)
+
+  block.fill(0x20, 148, 156)
+  putOctal(block, 148, 7, checksum(block))
+  return block
+}
+
+/**
+ * The blocks of a tar archive: each entry's header, preceded by a pax
+ * header when its name, link name or size does not fit ustar, then its
+ * data padded to a whole block, and two zero blocks at the end. Chunked
+ * data must come to exactly the size given for it.
+ */
+export async function* tarBlocks(
+  entries: Iterable<ZlibTarStreamEntry> | AsyncIterable<ZlibTarStreamEntry>,
+  modified: Date
+): AsyncGenerator<Uint8Array> {
+  for await (const entry of entries) {
+    const type = entry.type ?? 'file'
+    const chunked = entry.data !== undefined && !(entry.data instanceof Uint8Array)
+    const size = type !== 'file' || entry.data === undefined
+      ? 0
+      : entry.data instanceof Uint8Array ? entry.data.length : entry.size ?? -1
+    if (size < 0) {
+      throw new ZlibCompressionError(`tar entry ${entry.name} needs a size for chunked data`)
+    }
+
+    let pax = ''
+    if (!splitName(encoder.encode(entry.name))) pax += paxRecord('path', entry.name)
+    if (encoder.encode(entry.linkName ?? '').length > 100) pax += paxRecord('linkpath', entry.linkName!)
+    if (size > MAX_OCTAL_11) pax += paxRecord('size', String(size))
+    const fields: TarHeader = {
+      name: entry.name,
+      flag: TYPE_FLAGS[type],
+      size,
+      mode: entry.mode ?? (type === 'directory' ? 0o755 : 0o644),
+      uid: entry.uid ?? 0,
+      gid: entry.gid ?? 0,
+      modified: entry.modified ?? modified,
+      linkName: entry.linkName ?? ''
+    }
+    if (pax) {
+      const records = encoder.encode(pax)
+      yield header({ ...fields, name: 'PaxHeader', flag: 0x78, size: records.length, mode: 0o644, linkName: '' })
+      yield records
+      if (padding(records.length)) yield new Uint8Array(padding(records.length))
+    }
+
+    yield header(fields)
+    if (entry.data instanceof Uint8Array) {
+      if (size) yield entry.data
+    } else if (chunked && type === 'file') {
+      let written = 0
+      for await (const chunk of entry.data!) {
+        written += chunk.length
+        if (written > size) break
+        yield chunk
+      }
+      if (written !== size) {
+        throw new ZlibCompressionError(`tar entry ${entry.name} has ${written} bytes, not ${size}`)
+      }
+    }
+    if (padding(size)) yield new Uint8Array(padding(size))
+  }
+  yield new Uint8Array(2 * BLOCK)
+}
@@ -3,12 +3,16 @@
  * High-performance compression with SIMD optimizations
  */
 
+import type { ZlibDictionary } from './dictionary.ts'
+
 // Compression levels
 export enum ZlibCompression {
   NO_COMPRESSION = 0,
   BEST_SPEED = 1,
   DEFAULT_COMPRESSION = 6,
-  BEST_COMPRESSION = 9
+  BEST_COMPRESSION = 9,
+  // Iterated optimal parsing: smaller than 9, for data compressed once
+  ULTRA_COMPRESSION = 10
 }
 
 // Compression strategies
@@ -17,16 +21,109 @@ export enum ZlibStrategy {
   FILTERED = 1,
   HUFFMAN_ONLY = 2,
   RLE = 3,
-  FIXED = 4
+  FIXED = 4,
+  // One hash probe per position and fixed codes: faster than level 1
+  QUICK = 5,
+  // No lazy matching, but a match can take over the one before it
+  MEDIUM = 6
 }
 
 // Main WASM module interface
 export interface ZlibModule {
-  _zlib_compress_buffer: (dataPtr: number, size: number, level: number, strategy: number) => ZlibWASMResult
-  _zlib_decompress_buffer: (dataPtr: number, size: number) => ZlibWASMResult
-  _zlib_crc32: (dataPtr: number, size: number) => number
-  _zlib_adler32: (dataPtr: number, size: number) => number
+  _zlib_compress_buffer: (srcPtr: number, srcLen: number, destPtr: number, destLenPtr: number, level: number) => number
+  _zlib_compress_batch: (srcPtr: number, inOffsetsPtr: number, count: number, destPtr: number, destCap: number, outOffsetsPtr: number, level: number) => number
+  _zlib_compress_batch_bound: (inOffsetsPtr: number, count: number) => number
+  _zlib_compress_auto: (srcPtr: number, srcLen: number, destPtr: number, destLenPtr: number, choicePtr: number) => number
+  _zlib_compress_format?: (srcPtr: number, srcLen: number, destPtr: number, destLenPtr: number, level: number, strategy: number, format: number, windowBits: number, memLevel: number, namePtr: number, mtime: number, rsyncable: number, checkPtr: number) => number
+  _zlib_rsync_scan?: (bufPtr: number, len: number, hashPtr: number) => number
+  _zlib_rsync_boundaries?: (srcPtr: number, srcLen: number) => number
+  _zlib_compress_format_bound?: (srcLen: number, format: number, windowBits: number, memLevel: number, nameLen: number) => number
+  _zlib_compress_dict: (srcPtr: number, srcLen: number, dictPtr: number, dictLen: number, destPtr: number, destLenPtr: number, level: number) => number
+  _zlib_dict_snapshot_create: (dictPtr: number, dictLen: number, level: number) => number
+  _zlib_compress_snapshot: (snapshotPtr: number, srcPtr: number, srcLen: number, destPtr: number, destLenPtr: number) => number
+  _zlib_decompress_dict_alloc: (srcPtr: number, srcLen: number, dictPtr: number, dictLen: number, sizeHint: number, outPtrPtr: number, outLenPtr: number) => number
+  _zlib_decompress_limit_alloc?: (srcPtr: number, srcLen: number, dictPtr: number, dictLen: number, sizeHint: number, maxOut: number, outPtrPtr: number, outLenPtr: number) => number
+  _zlib_decompress_batch?: (srcPtr: number, inOffsetsPtr: number, count: number, sizeHint: number, outPtrPtr: number, outLenPtr: number, outOffsetsPtr: number) => number
+  _zlib_decompress_buffer: (srcPtr: number, srcLen: number, destPtr: number, destLenPtr: number) => number
+  _zlib_decompress_alloc: (srcPtr: number, srcLen: number, sizeHint: number, outPtrPtr: number, outLenPtr: number) => number
+  _zlib_ctx_acquire: (kind: number, level: number, windowBits: number, memLevel: number, strategy: number) => number
+  _zlib_ctx_release: (ctx: number) => void
+  _zlib_ctx_pool_drain: () => void
+  _zlib_deflate_init: (level: number, windowBits: number, memLevel: number, strategy: number) => number
+  _zlib_deflate_init_profile?: (level: number, windowBits: number, memLevel: number, strategy: number, profile: number) => number
+  _zlib_deflate_process: (ctx: number, inputPtr: number, inputLen: number, outputPtr: number, outputLen: number, flush: number) => number
+  _zlib_deflate_end: (ctx: number) => void
+  _zlib_inflate_init: (windowBits: number) => number
+  _zlib_inflate_process: (ctx: number, inputPtr: number, inputLen: number, outputPtr: number, outputLen: number) => number
+  _zlib_inflate_end: (ctx: number) => void
+  _zlib_inflate_reset: (ctx: number) => number
+  _zlib_deflate_reset: (ctx: number) => number
+  _zlib_deflate_params?: (ctx: number, level: number, strategy: number) => number
+  _zlib_ctx_memory: (kind: number, windowBits: number, memLevel: number, profile: number) => number
+  _zlib_stream_avail_in: (ctx: number) => number
+  _zlib_stream_avail_out: (ctx: number) => number
+  _zlib_stream_ring?: (ctx: number, size: number) => number
+  _zlib_deflate_drain?: (ctx: number, inputPtr: number, inputLen: number, flush: number) => number
+  _zlib_inflate_drain?: (ctx: number, inputPtr: number, inputLen: number) => number
+  _zlib_compress_block: (srcPtr: number, srcLen: number, dictPtr: number, dictLen: number, destPtr: number, destLenPtr: number, level: number, last: number) => number
+  _zlib_compress_block_bound: (sourceLen: number) => number
+  _zlib_compress_parallel?: (srcPtr: number, srcLen: number, destPtr: number, destLenPtr: number, level: number, blockSize: number, nthreads: number) => number
+  _zlib_compress_parallel_bound?: (sourceLen: number) => number
+  _zlib_index_create: (span: number) => number
+  _zlib_index_feed: (index: number, srcPtr: number, srcLen: number) => number
+  _zlib_index_finish: (index: number) => number
+  _zlib_index_points: (index: number) => number
+  _zlib_index_length: (index: number) => number
+  _zlib_index_serialize: (index: number, outPtrPtr: number, outLenPtr: number) => number
+  _zlib_index_serialize_segment: (index: number, first: number, count: number, outPtrPtr: number, outLenPtr: number) => number
+  _zlib_index_point_out: (index: number, i: number) => number
+  _zlib_index_point_in: (index: number, i: number) => number
+  _zlib_index_load: (srcPtr: number, srcLen: number) => number
+  _zlib_index_extract_begin: (index: number, offset: number, length: number) => number
+  _zlib_index_extract_next: (index: number, srcPtr: number, srcLen: number, destPtr: number, gotPtr: number) => number
+  _zlib_index_free: (index: number) => void
+  _zlib_zip_open: (pathPtr: number) => number
+  _zlib_zip_open_memory: (capacity: number) => number
+  _zlib_zip_add: (zip: number, namePtr: number, dataPtr: number, len: number, level: number, dosDate: number) => number
+  _zlib_zip_add_deflated: (zip: number, namePtr: number, dataPtr: number, dataLen: number, len: number, crc: number, method: number, level: number, dosDate: number) => number
+  _zlib_zip_add_parallel?: (zip: number, namesPtr: number, dataPtr: number, lensPtr: number, dosDatesPtr: number, count: number, level: number, nthreads: number) => number
+  _zlib_zip_close: (zip: number, commentPtr: number, outPtrPtr: number, outLenPtr: number) => number
+  _zlib_zip_open_stream: () => number
+  _zlib_zip_take: (zip: number, outPtrPtr: number, outLenPtr: number) => number
+  _zlib_zip_begin: (zip: number, namePtr: number, level: number, dosDate: number, zip64: number) => number
+  _zlib_zip_write: (zip: number, dataPtr: number, len: number) => number
+  _zlib_zip_end: (zip: number) => number
+  _zlib_unzip_open_memory: (srcPtr: number, srcLen: number) => number
+  _zlib_unzip_count: (unz: number) => number
+  _zlib_unzip_extract: (unz: number, namePtr: number, outPtrPtr: number, outLenPtr: number) => number
+  _zlib_unzip_extract_batch: (unz: number, namesPtr: number, count: number, outPtrsPtr: number, outLensPtr: number) => number
+  _zlib_unzip_locate: (unz: number, namePtr: number, entryPtr: number) => number
+  _zlib_unzip_inflate: (srcPtr: number, srcLen: number, len: number, crc: number, method: number, outPtrPtr: number, outLenPtr: number) => number
+  _zlib_unzip_extract_parallel?: (unz: number, namesPtr: number, count: number, outPtrsPtr: number, outLensPtr: number, nthreads: number) => number
+  _zlib_unzip_close: (unz: number) => void
+  _zlib_gzjoin_bound: (srcLen: number) => number
+  _zlib_gzjoin: (srcPtr: number, srcLen: number, destPtr: number, destLenPtr: number) => number
+  _zlib_gzip_members?: (srcPtr: number, srcLen: number, endsPtr: number, maxEnds: number, countPtr: number) => number
+  _zlib_bgzf_member?: (srcPtr: number, srcLen: number, destPtr: number, destLenPtr: number, level: number) => number
+  _zlib_bgzf_compress?: (srcPtr: number, srcLen: number, destPtr: number, destLenPtr: number, level: number, blockSize: number) => number
+  _zlib_bgzf_compress_parallel?: (srcPtr: number, srcLen: number, destPtr: number, destLenPtr: number, level: number, blockSize: number, nthreads: number) => number
+  _zlib_bgzf_bound?: (srcLen: number, blockSize: number) => number
+  _zlib_gzfile_open: (file: number, modePtr: number, bufferSize: number) => number
+  _zlib_gzfile_read: (gz: number, bufPtr: number, len: number) => number
+  _zlib_gzfile_write: (gz: number, bufPtr: number, len: number) => number
+  _zlib_gzfile_error: (gz: number) => number
+  _zlib_gzfile_close: (gz: number) => number
+  _zlib_inflate_back?: (call: number, format: number) => number
+  _zlib_crc32_combine: (crc1: number, crc2: number, len2: number) => number
+  _zlib_adler32_combine: (adler1: number, adler2: number, len2: number) => number
+  _zlib_crc32_combine_gen: (len2: number) => number
+  _zlib_crc32_combine_op: (crc1: number, crc2: number, op: number) => number
+  _zlib_crc32_parallel?: (bufPtr: number, len: number, nthreads: number) => number
+  _zlib_crc32: (crc: number, dataPtr: number, size: number) => number
+  _zlib_adler32: (adler: number, dataPtr: number, size: number) => number
   _zlib_get_version: () => string
+  _zlib_get_stats?: () => number
+  _zlib_reset_stats?: () => void
   _zlib_simd_supported: () => boolean
   _zlib_simd_capabilities: () => string
   _zlib_compress_bound: (sourceLen: number) => number
@@ -48,10 +145,40 @@ export interface ZlibModule {
     writeFile: (path: string, data: Uint8Array) => void
   }
 
+  // Host I/O for src/zlib_gzfile.c, installed by src/lib/gzfile.ts
+  zlibFiles?: ZlibHostFiles
+  // Callbacks for src/zlib_infback.c, installed by src/lib/infback.ts
+  zlibBack?: ZlibBackHost
+
+  // Set by wrapMemory64() in src/lib/memory64.ts: 64-bit pointers and
+  // unsigned long, so length and pointer cells are 8 bytes
+  memory64?: boolean
+
   // Index signature for dynamic function access
   [key: string]: any
 }
 
+// Host side of src/zlib_gzfile.c: I/O on its files by number, returning
+// what read(), write(), lseek() and close() would
+export interface ZlibHostFiles {
+  read: (file: number, bufPtr: number, len: number) => number
+  write: (file: number, bufPtr: number, len: number) => number
+  seek: (file: number, offset: number, whence: number) => number
+  close: (file: number) => number
+}
+
+// Host side of src/zlib_infback.c: input by address and length, output as
+// a heap range; -1 stops the inflate
+export interface ZlibBackHost {
+  pull: (call: number, bufPtrPtr: number) => number
+  push: (call: number, bufPtr: number, len: number) => number
+}
+
+// inflateBack() callbacks: the next compressed chunk, or null at the end;
+// and each piece of output, a view of the window valid for that call only
+export type ZlibBackPull = () => Uint8Array | null
+export type ZlibBackPush = (chunk: Uint8Array) => void
+
 // WASM function result
 export interface ZlibWASMResult {
   dataPtr: number
@@ -65,6 +192,360 @@ export interface ZlibOptions {
   strategy?: ZlibStrategy
   windowBits?: number
   memLevel?: number
+  // Wrapper around the deflate data, zlib by default. Without it windowBits
+  // picks one as deflateInit2() does: -9..-15 raw, 25..31 gzip
+  format?: 'zlib' | 'gzip' | 'raw'
+  // compress() only: gzip header fields, mtime in seconds since the epoch
+  header?: ZlibGzipHeader
+  // compress() and createDeflateStream(): full-flush at content-defined
+  // boundaries, as gzip --rsyncable does, so an edit to the input changes
+  // only the nearby output
+  rsyncable?: boolean
+  // Preset dictionary from Zlib.loadDictionary() / Zlib.trainDictionary();
+  // zlib format only
+  dictionary?: ZlibDictionary
+  // compress() only: probe the input and choose level and strategy, in
+  // place of level (ignored with a dictionary or another format)
+  auto?: boolean
+}
+
+// Optional fields of a gzip member header (RFC 1952)
+export interface ZlibGzipHeader {
+  name?: string
+  mtime?: number
+}
+
+// A gzip member header as read back; names and comments decode as UTF-8
+export interface ZlibGzipHeaderInfo {
+  // Bytes from the start of the member to its deflate data
+  headerLength: number
+  name?: string
+  comment?: string
+  extra?: Uint8Array
+  // Seconds since the epoch, 0 when not set
+  mtime: number
+  // XFL: 2 for the slowest compression, 4 for the fastest
+  extraFlags: number
+  os: number
+  text: boolean
+}
+
+// One member from gzipMembers(): its header, where it lies in the input,
+// and its trailer
+export interface ZlibGzipMember extends ZlibGzipHeaderInfo {
+  offset: number
+  // Whole member, header to trailer
+  length: number
+  crc32: number
+  // Uncompressed size modulo 2^32
+  isize: number
+}
+
+// What compress() chose in auto mode
+export interface ZlibAutoChoice {
+  level: number
+  strategy: ZlibStrategy
+  // Order-0 entropy of the probed bytes, in bits per byte
+  entropy: number
+}
+
+// Decompression options
+// Caps on what untrusted input may inflate to. Output that would pass
+// either stops the inflate with a ZlibLimitError before it is allocated.
+export interface ZlibInflateLimits {
+  // Most bytes of output
+  maxOutputSize?: number
+  // Most bytes of output per byte of compressed input read so far
+  maxRatio?: number
+}
+
+export interface ZlibDecompressOptions extends ZlibInflateLimits {
+  // Exact (or best-known) decompressed size; gzip input falls back to ISIZE,
+  // which for concatenated members covers only the last one
+  expectedSize?: number
+  // Dictionary the data was compressed against; without one, zlib input
+  // naming a dictionary id takes the one registered under it
+  dictionary?: ZlibDictionary
+}
+
+// A registered preset dictionary, as pool workers receive it and
+// exportDictionaries() persists it
+export interface ZlibDictionaryEntry {
+  // Adler-32 of bytes, the id a zlib header records
+  id: number
+  // Shared with every worker that has the entry; never written to
+  bytes: Uint8Array
+}
+
+// Streaming options
+export interface ZlibStreamOptions extends ZlibOptions, ZlibInflateLimits {
+  // Size of the heap staging buffers, and so of each slice handed to WASM;
+  // left out, slices are tuned to the incoming chunks within 64-256 KB
+  chunkSize?: number
+  // Called after every slice crosses into WASM, e.g. to track latency
+  onChunk?: (timing: ZlibChunkTiming) => void
+  // Deflate only: move the level up or down while streaming, from how
+  // much of the time goes into compressing; true takes the defaults
+  adaptiveLevel?: ZlibAdaptiveLevel | boolean
+  // Deflate only: the context's memory layout (default 'fast')
+  memoryProfile?: ZlibMemoryProfile
+}
+
+// Deflate context layouts: 'fast' is zlib's own; 'low' has a quarter-size
+// symbol and pending buffer, about 48 KB less per context at memLevel 8,
+// for output typically within 0.5% of the size
+export type ZlibMemoryProfile = 'fast' | 'low'
+
+// Automatic level control for createDeflateStream()
+export interface ZlibAdaptiveLevel {
+  // Range the level moves within, 1..9 by default
+  minLevel?: number
+  maxLevel?: number
+  // Input bytes between decisions, 1 MB by default
+  interval?: number
+  // Called after each change, once it is in effect
+  onChange?: (change: ZlibLevelChange) => void
+}
+
+// One step of the adaptive level, with the rates it was decided on
+export interface ZlibLevelChange {
+  level: number
+  previous: number
+  // MB/s of input while deflate was running, and through the stream as a
+  // whole, waits for the source or the sink included
+  throughput: number
+  rate: number
+}
+
+// One slice of a stream run through deflate or inflate
+export interface ZlibChunkTiming {
+  inputBytes: number
+  outputBytes: number
+  timeMs: number
+}
+
+// Blocked gzip (BGZF) options
+export interface ZlibBgzfOptions {
+  level?: ZlibCompression | number
+  // Input bytes per member, at most (and by default) 65280
+  blockSize?: number
+  // Threads on the -pthread build, defaults to navigator.hardwareConcurrency
+  workers?: number
+}
+
+// BGZF output and its side index, in bgzip's .gzi layout
+export interface ZlibBgzfResult {
+  data: Uint8Array
+  index: Uint8Array
+  originalSize: number
+  compressedSize: number
+  processingTime: number
+}
+
+// Parallel compression options
+export interface ZlibParallelOptions {
+  level?: ZlibCompression | number
+  // Container for the joined deflate blocks
+  format?: 'zlib' | 'gzip'
+  // Bytes per block, clamped to 128 KB .. 1 MB
+  blockSize?: number
+  // Worker count, defaults to navigator.hardwareConcurrency
+  workers?: number
+}
+
+// Where a task stands in a worker pool's queue, and how to call it off
+export interface ZlibWorkerRunOptions {
+  // Higher runs first; equal priorities run in the order they were queued
+  priority?: number
+  // Aborting drops a queued task, or terminates the worker running it
+  signal?: AbortSignal
+}
+
+// compressInWorker() / decompressInWorker() options
+export interface ZlibWorkerOptions extends ZlibWorkerRunOptions {
+  // Pool size when the call starts one, defaults to navigator.hardwareConcurrency
+  workers?: number
+  // Move the input's ArrayBuffer to the worker instead of copying it,
+  // leaving it detached here
+  transfer?: boolean
+}
+
+// One file of a ZIP archive; names use '/' separators and are stored as UTF-8
+export interface ZlibZipEntry {
+  name: string
+  data: Uint8Array
+  // Modification time, defaults to when the archive is created
+  modified?: Date
+}
+
+// One file of a streamed ZIP archive: whole, or as chunks that are deflated
+// as they arrive (a ReadableStream<Uint8Array> will do)
+export interface ZlibZipStreamEntry {
+  name: string
+  data: Uint8Array | AsyncIterable<Uint8Array>
+  // Expected length of chunked data; 4 GB or more needs Zip64 sizes up front
+  size?: number
+  modified?: Date
+}
+
+// Streamed ZIP archive options
+export interface ZlibZipStreamOptions {
+  level?: ZlibCompression | number
+  // Archive comment
+  comment?: string
+}
+
+// ZIP archive options
+export interface ZlibZipOptions {
+  level?: ZlibCompression | number
+  // Worker count, defaults to navigator.hardwareConcurrency
+  workers?: number
+  // Archive comment
+  comment?: string
+}
+
+// Where a ZIP entry's data lies in its archive: enough to inflate it
+// anywhere, with no reader (ZlibZipReader.locate())
+export interface ZlibZipEntryLocation {
+  // Byte offset of the data in the archive
+  offset: number
+  compressedSize: number
+  size: number
+  crc: number
+  // 0 stored, 8 deflated, 9 Deflate64
+  method: number
+}
+
+// ZIP extraction options
+export interface ZlibUnzipOptions {
+  // Worker count, defaults to navigator.hardwareConcurrency
+  workers?: number
+}
+
+// Kinds of tar entry; 'other' covers devices, FIFOs and unknown type flags
+export type ZlibTarEntryType = 'file' | 'directory' | 'symlink' | 'link' | 'other'
+
+// One entry of a tar archive being read (Zlib.extractTarGz())
+export interface ZlibTarEntry {
+  name: string
+  type: ZlibTarEntryType
+  // Length of data
+  size: number
+  mode: number
+  uid: number
+  gid: number
+  modified: Date
+  // Target of a symlink or hard link
+  linkName: string
+  // The entry's bytes, readable until the next entry is asked for
+  data: ReadableStream<Uint8Array>
+}
+
+// One entry of a tar archive being written (Zlib.createTarGz())
+export interface ZlibTarStreamEntry {
+  name: string
+  // A file unless given
+  type?: ZlibTarEntryType
+  data?: Uint8Array | AsyncIterable<Uint8Array>
+  // Length of chunked data, which the header needs up front
+  size?: number
+  mode?: number
+  uid?: number
+  gid?: number
+  modified?: Date
+  linkName?: string
+}
+
+// Parallel decompression options
+export interface ZlibParallelDecompressOptions {
+  // Worker count, defaults to navigator.hardwareConcurrency
+  workers?: number
+}
+
+// One compressed block of a parallel deflate stream
+export interface ZlibBlockResult {
+  data: Uint8Array
+  check: number
+}
+
+// Batch compression or decompression result: message i is
+// data.subarray(offsets[i], offsets[i + 1])
+export interface ZlibBatchResult {
+  data: Uint8Array
+  offsets: Uint32Array
+  processingTime: number
+}
+
+// Compressed bytes for a random-access index: the whole stream, or a reader
+// returning up to length bytes at position (fewer, or none, at the end)
+export type ZlibIndexSource =
+  | Uint8Array
+  | ((position: number, length: number) => Uint8Array | Promise<Uint8Array>)
+
+// Random-access index options
+export interface ZlibIndexOptions {
+  // Uncompressed bytes between access points (default 1 MB); each point costs
+  // up to 32 KB of window, stored compressed
+  span?: number
+  // Compressed bytes requested from the source per read
+  readSize?: number
+}
+
+// permessage-deflate (RFC 7692) parameters, as negotiated for one connection
+export interface ZlibPerMessageDeflateOptions {
+  // Which end this is, and so which parameters govern what it sends (default true)
+  isServer?: boolean
+  // LZ77 window sizes, 8..15 (default 15); each step down halves the window
+  serverMaxWindowBits?: number
+  clientMaxWindowBits?: number
+  // Reset that end's compressor after every message
+  serverNoContextTakeover?: boolean
+  clientNoContextTakeover?: boolean
+  level?: ZlibCompression | number
+  // Deflate hash table size, 1..9 (default 8); lower saves memory per connection
+  memLevel?: number
+  // Deflate context layout; 'low' saves memory per connection too
+  memoryProfile?: ZlibMemoryProfile
+  // Largest decompressed message accepted (default unlimited)
+  maxMessageSize?: number
+}
+
+// Bytes behind a gzip log: a file, an OPFS sync access handle or memory.
+// Reads past the end return fewer bytes, or none
+export interface ZlibLogStorage {
+  size(): number | Promise<number>
+  read(position: number, length: number): Uint8Array | Promise<Uint8Array>
+  write(position: number, data: Uint8Array): void | Promise<void>
+  truncate(length: number): void | Promise<void>
+  // Make earlier writes durable, where the storage can
+  sync?(): void | Promise<void>
+}
+
+// The parts of an OPFS FileSystemSyncAccessHandle used here
+export interface ZlibSyncAccessHandle {
+  getSize(): number
+  read(buffer: Uint8Array, options: { at: number }): number
+  write(data: Uint8Array, options: { at: number }): number
+  truncate(length: number): void
+  flush(): void
+}
+
+// Gzip file options
+export interface ZlibGzipFileOptions {
+  // Compression level when writing
+  level?: ZlibCompression | number
+  // Size of gz's buffers, and so of each handle read or write (default 1 MB)
+  bufferSize?: number
+}
+
+// Gzip log options
+export interface ZlibLogOptions {
+  level?: ZlibCompression | number
+  memLevel?: number
+  strategy?: ZlibStrategy | number
+  // Uncompressed bytes held in the deflate stream before a flush to storage
+  // (default 0, which flushes every write)
+  flushSize?: number
 }
 
 // Compression result
@@ -75,6 +556,85 @@ export interface ZlibResult {
   compressionRatio: number
   processingTime: number
   simdAccelerated: boolean
+  // Set when options.auto chose the parameters
+  auto?: ZlibAutoChoice
+  // compress() without a dictionary or auto: the Adler-32 (zlib) or CRC-32
+  // (gzip) of the input that deflate computed for the trailer; 0 for raw
+  checksum?: number
+}
+
+// One instrumented phase of a ZLIB_STATS=1 build. Times are wall clock and
+// include any instrumented phase called inside (fill_window() covers the
+// window slide and the checksum of what it reads)
+export interface ZlibPhaseStats {
+  calls: number
+  timeMs: number
+  // Per phase: input read, hash entries rebased, match length found, block
+  // input, output written, code lengths, or bytes checksummed
+  bytes: number
+}
+
+// Hot-path counters since startup or the last resetStats()
+export interface ZlibStats {
+  fillWindow: ZlibPhaseStats
+  slideHash: ZlibPhaseStats
+  longestMatch: ZlibPhaseStats
+  flushBlock: ZlibPhaseStats
+  inflateFast: ZlibPhaseStats
+  inflateTable: ZlibPhaseStats
+  crc32: ZlibPhaseStats
+  adler32: ZlibPhaseStats
+  // chainHistogram[i] counts longest_match() calls that probed 2^i to
+  // 2^(i+1) - 1 hash chain entries; the last bucket is open-ended
+  chainHistogram: number[]
+}
+
+// Deflate parameters of one profile() point
+export interface ZlibProfileConfig {
+  level: number
+  strategy: ZlibStrategy
+  windowBits: number
+  memLevel: number
+}
+
+// One measured profile() point, as a zlib stream over the whole sample
+export interface ZlibProfilePoint extends ZlibProfileConfig {
+  compressedSize: number
+  ratio: number
+  compressMBps: number
+  decompressMBps: number
+}
+
+// Sweep options; every list is crossed with every other
+export interface ZlibProfileOptions {
+  // Default 1-10
+  levels?: number[]
+  // Default all
+  strategies?: ZlibStrategy[]
+  // Default [12, 15]
+  windowBits?: number[]
+  // Default [8, 9]
+  memLevels?: number[]
+  // Worker count, defaults to navigator.hardwareConcurrency
+  workers?: number
+  // Per direction and point: runs, at least (default 3), and ms, at least (default 50)
+  minRuns?: number
+  minTime?: number
+  // Link the recommendation is for, in MB/s (default 12.5, 100 Mbit/s)
+  bandwidthMBps?: number
+  // Only recommend points compressing at least this fast
+  minCompressMBps?: number
+}
+
+// Result of profile()
+export interface ZlibProfile {
+  sampleSize: number
+  // Every point, in sweep order
+  points: ZlibProfilePoint[]
+  // Points no other beats on both compressMBps and ratio, fastest first
+  frontier: ZlibProfilePoint[]
+  // Least time to compress, send over bandwidthMBps and decompress
+  recommended: ZlibProfilePoint
 }
 
 // Module capabilities
@@ -87,13 +647,54 @@ export interface ZlibCapabilities {
   strategies: ZlibStrategy[]
 }
 
+// Zlib.memoryUsage(): the instance heap against its maxMemoryMB budget
+export interface ZlibMemoryUsage {
+  heapBytes: number
+  // Largest heap so far, including modules replaced by recycle()
+  highWaterBytes: number
+  budgetBytes: number
+  overBudget: boolean
+  // compress()/decompress() calls the budget sent through a stream
+  streamedCalls: number
+  recycles: number
+}
+
+// compressCacheStats(): what the compress() cache holds and how it has done
+export interface ZlibCompressCacheStats {
+  entries: number
+  bytes: number
+  maxBytes: number
+  hits: number
+  misses: number
+  evictions: number
+}
+
 // Loading options
 export interface ZlibLoadingOptions {
   cdnUrl?: string
   fallbackUrls?: string[]
+  // Compile each build once per realm, and keep CDN downloads in the Cache API
   cachingEnabled?: boolean
+  // Module compiled elsewhere, e.g. posted from the main thread; skips loading
+  wasmModule?: WebAssembly.Module
   simdOptimizations?: boolean
+  // Heap budget: compress() and decompress() calls that could grow the heap
+  // past it stream through fixed-size buffers instead (see memoryUsage())
   maxMemoryMB?: number
+  // Load the -pthread build (needs SharedArrayBuffer / cross-origin isolation)
+  threads?: boolean
+  // Load the build without -msimd128 (build-dual.sh scalar), for A/B benchmarks
+  scalar?: boolean
+  // Load the -sMEMORY64 build (build-dual.sh memory64) for single buffers
+  // past 4 GB: compress(), decompress(), the heap buffer calls, streams and
+  // the checksums; raise maxMemoryMB to match
+  memory64?: boolean
+  // Load the inflate-only core (build-dual.sh core): only decompress(),
+  // crc32() and adler32() work; ZlibCore loads the full build behind it
+  core?: boolean
+  // Keep compress() results for repeated inputs, up to this many MB of
+  // inputs and outputs (see compressCacheStats()); off by default
+  compressCacheMB?: number
 }
 
 // Performance metrics
@@ -136,6 +737,14 @@ export class ZlibCompressionError extends ZlibError {
   }
 }
 
+// Inflate stopped at a maxOutputSize or maxRatio limit
+export class ZlibLimitError extends ZlibError {
+  constructor(message: string) {
+    super(message)
+    this.name = 'ZlibLimitError'
+  }
+}
+
 export class ZlibInitError extends ZlibError {
   constructor(message: string) {
     super(message)
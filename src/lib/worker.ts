@@ -0,0 +1,73 @@
+/**
+ * zlib.wasm compression worker
+ * Hosts one module instance for ZlibWorkerPool
+ */
+
+/// <reference lib="deno.worker" />
+
+import Zlib from './index.ts'
+
+let zlib: Zlib | null = null
+let ready: Promise<void> | null = null
+
+self.onmessage = async (event: MessageEvent) => {
+  const message = event.data
+
+  if (message.type === 'init') {
+    zlib = new Zlib(message.options)
+    zlib.importDictionaries(message.dictionaries ?? [])
+    ready = zlib.initialize()
+    return
+  }
+  if (message.type === 'dictionaries') {
+    zlib!.importDictionaries(message.entries)
+    return
+  }
+
+  try {
+    await ready
+    if (message.type === 'compress' || message.type === 'decompress') {
+      const options = message.dictionaryId === undefined
+        ? message.options
+        : { ...message.options, dictionary: zlib!.dictionaryById(message.dictionaryId) ?? undefined }
+      if (message.dictionaryId !== undefined && !options.dictionary) {
+        throw new Error(`Dictionary ${message.dictionaryId} is not registered in the worker`)
+      }
+      const result = message.type === 'compress'
+        ? await zlib!.compress(message.data, options)
+        : await zlib!.decompress(message.data, options)
+      self.postMessage(result, [result.data.buffer])
+      return
+    }
+    if (message.type === 'segment') {
+      const data = await zlib!.decompressSegment(message.index, message.compressed)
+      self.postMessage({ data }, [data.buffer])
+      return
+    }
+    if (message.type === 'entry') {
+      const data = zlib!.inflateZipEntry(message.compressed, message.location)
+      self.postMessage({ data }, [data.buffer])
+      return
+    }
+    if (message.type === 'checksum') {
+      const data = message.data
+      self.postMessage({ check: message.check === 'crc32' ? zlib!.crc32(data) : zlib!.adler32(data) })
+      return
+    }
+    if (message.type === 'profile') {
+      self.postMessage(zlib!.profileConfig(message.sample, message.config, message.minRuns, message.minTime))
+      return
+    }
+
+    const result = zlib!.compressBlock(
+      message.block,
+      message.dictionary,
+      message.level,
+      message.last,
+      message.check
+    )
+    self.postMessage(result, [result.data.buffer])
+  } catch (error) {
+    self.postMessage({ error: error instanceof Error ? error.message : String(error) })
+  }
+}
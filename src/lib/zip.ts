@@ -0,0 +1,369 @@
+/**
+ * zlib.wasm ZIP archives
+ * minizip's zip.c and unzip.c over archives held on the WASM heap
+ */
+
+import { ZlibCompressionError, ZlibMemoryError } from './types.ts'
+import type { ZlibModule, ZlibZipEntry, ZlibZipEntryLocation } from './types.ts'
+import type { HeapBufferPool, ZlibHeapBuffer } from './heap.ts'
+
+// minizip and zlib codes used by the archive exports
+const ZIP_OK = 0
+const UNZ_END_OF_LIST_OF_FILE = -100
+export const Z_STORED = 0
+export const Z_DEFLATED = 8
+
+const encoder = new TextEncoder()
+
+/** Call fn with text as a NUL-terminated UTF-8 string on the heap */
+function withString<T>(pool: HeapBufferPool, text: string, fn: (ptr: number) => T): T {
+  const bytes = encoder.encode(text + '\0')
+  const buffer = pool.acquire(bytes.length).write(bytes)
+  try {
+    return fn(buffer.ptr)
+  } finally {
+    pool.release(buffer)
+  }
+}
+
+/** Copy out and free a buffer returned through the pool's out-cells */
+function take(module: ZlibModule, pool: HeapBufferPool): Uint8Array {
+  const dataPtr = module.HEAP32[pool.pointerPtr / 4]
+  const dataLen = module.HEAP32[pool.lengthPtr / 4] >>> 0
+  const data = module.HEAPU8.slice(dataPtr, dataPtr + dataLen)
+  module._free(dataPtr)
+  return data
+}
+
+/**
+ * Inflate one entry's data, as ZlibZipReader.locate() describes it, with no
+ * reader: the worker side of Zlib.extractZip()
+ */
+export function inflateZipEntry(
+  module: ZlibModule,
+  pool: HeapBufferPool,
+  compressed: Uint8Array,
+  location: ZlibZipEntryLocation
+): Uint8Array {
+  const input = pool.acquire(compressed.length).write(compressed)
+  try {
+    const result = module._zlib_unzip_inflate(
+      input.ptr, input.length, location.size, location.crc, location.method,
+      pool.pointerPtr, pool.lengthPtr
+    )
+    if (result !== ZIP_OK) {
+      throw new ZlibCompressionError(`ZIP entry inflate failed with code: ${result}`)
+    }
+    return take(module, pool)
+  } finally {
+    pool.release(input)
+  }
+}
+
+/**
+ * MS-DOS date and time, as ZIP headers record it: local time, two-second
+ * resolution, years 1980-2107
+ */
+export function dosDateTime(date: Date): number {
+  const year = Math.min(Math.max(date.getFullYear(), 1980), 2107)
+  if (year !== date.getFullYear()) return year === 1980 ? 0x00210000 : 0xff9fbf7d
+  return (((year - 1980) << 25) | ((date.getMonth() + 1) << 21) | (date.getDate() << 16) |
+          (date.getHours() << 11) | (date.getMinutes() << 5) | (date.getSeconds() >> 1)) >>> 0
+}
+
+/**
+ * One archive being written into a growing heap buffer. Entries go in with
+ * add() (deflated here), addDeflated() (raw deflate data and CRC-32
+ * computed by a worker), addParallel() (the -pthread build's thread
+ * pool) or begin(), write() and end() (a chunk at a time), and finish()
+ * returns the archive bytes. A streaming writer gives entries data
+ * descriptors instead of seeking back, and take() collects its output as
+ * it goes; finish() then returns only what is left.
+ */
+export class ZipWriter {
+  private handle: number
+
+  constructor(
+    private readonly module: ZlibModule,
+    private readonly pool: HeapBufferPool,
+    capacity = 0,
+    streaming = false
+  ) {
+    this.handle = streaming ? module._zlib_zip_open_stream() : module._zlib_zip_open_memory(capacity)
+    if (!this.handle) {
+      throw new ZlibMemoryError('Failed to create ZIP archive')
+    }
+  }
+
+  /** Deflate data in the module and add it, stored if it does not shrink */
+  add(entry: ZlibZipEntry, level: number, modified: Date): void {
+    const input = this.pool.acquire(entry.data.length).write(entry.data)
+    try {
+      this.check(withString(this.pool, entry.name, name =>
+        this.module._zlib_zip_add(this.handle, name, input.ptr, input.length, level, dosDateTime(modified))
+      ))
+    } finally {
+      this.pool.release(input)
+    }
+  }
+
+  /** Add an entry compressed elsewhere: raw deflate data, or the bytes themselves when stored */
+  addDeflated(
+    name: string,
+    data: Uint8Array,
+    length: number,
+    crc: number,
+    method: number,
+    level: number,
+    modified: Date
+  ): void {
+    const input = this.pool.acquire(data.length).write(data)
+    try {
+      this.check(withString(this.pool, name, namePtr =>
+        this.module._zlib_zip_add_deflated(
+          this.handle, namePtr, input.ptr, input.length, length, crc, method, level, dosDateTime(modified)
+        )
+      ))
+    } finally {
+      this.pool.release(input)
+    }
+  }
+
+  /**
+   * Add every entry through zlib_zip_add_parallel(): the module's threads
+   * deflate straight out of the shared heap while this thread writes
+   */
+  addParallel(entries: ZlibZipEntry[], level: number, modified: Date, threads: number): void {
+    const count = entries.length
+    const names = entries.map(entry => encoder.encode(entry.name + '\0'))
+    const size = names.reduce((n, name) => n + name.length, 0) +
+                 entries.reduce((n, entry) => n + entry.data.length, 0)
+
+    // One region holds the strings and data; a second the four u32 arrays
+    const heap = this.pool.acquire(size)
+    const tables = this.pool.acquire(count * 16)
+
+    try {
+      const u32 = new Uint32Array(this.module.HEAPU8.buffer, tables.ptr, count * 4)
+      let ptr = heap.ptr
+      for (let i = 0; i < count; i++) {
+        this.module.HEAPU8.set(names[i], ptr)
+        u32[i] = ptr
+        ptr += names[i].length
+        this.module.HEAPU8.set(entries[i].data, ptr)
+        u32[count + i] = ptr
+        u32[2 * count + i] = entries[i].data.length
+        u32[3 * count + i] = dosDateTime(entries[i].modified ?? modified)
+        ptr += entries[i].data.length
+      }
+
+      this.check(this.module._zlib_zip_add_parallel!(
+        this.handle, tables.ptr, tables.ptr + count * 4, tables.ptr + count * 8,
+        tables.ptr + count * 12, count, level, threads
+      ))
+    } finally {
+      this.pool.release(tables)
+      this.pool.release(heap)
+    }
+  }
+
+  /** Start an entry whose data arrives through write() */
+  begin(name: string, level: number, modified: Date, zip64: boolean): void {
+    this.check(withString(this.pool, name, namePtr =>
+      this.module._zlib_zip_begin(this.handle, namePtr, level, dosDateTime(modified), zip64 ? 1 : 0)
+    ))
+  }
+
+  /** Deflate the next chunk of the entry begun last */
+  write(chunk: Uint8Array): void {
+    const input = this.pool.acquire(chunk.length).write(chunk)
+    try {
+      this.check(this.module._zlib_zip_write(this.handle, input.ptr, input.length))
+    } finally {
+      this.pool.release(input)
+    }
+  }
+
+  /** Finish the entry begun last */
+  end(): void {
+    this.check(this.module._zlib_zip_end(this.handle))
+  }
+
+  /** Output a streaming writer has produced since the last take() */
+  take(): Uint8Array {
+    this.check(this.module._zlib_zip_take(this.handle, this.pool.pointerPtr, this.pool.lengthPtr))
+    return take(this.module, this.pool)
+  }
+
+  /** Write the central directory and return the archive (for a streaming writer, the rest of it) */
+  finish(comment?: string): Uint8Array {
+    const close = (commentPtr: number) => this.module._zlib_zip_close(
+      this.handle, commentPtr, this.pool.pointerPtr, this.pool.lengthPtr
+    )
+    const result = comment ? withString(this.pool, comment, close) : close(0)
+    this.handle = 0
+
+    if (result !== ZIP_OK) {
+      throw new ZlibCompressionError(`ZIP archive close failed with code: ${result}`)
+    }
+    return take(this.module, this.pool)
+  }
+
+  /** Discard a partly written archive */
+  abort(): void {
+    if (!this.handle) return
+    this.module._zlib_zip_close(this.handle, 0, 0, 0)
+    this.handle = 0
+  }
+
+  private check(result: number): void {
+    if (result !== ZIP_OK) {
+      throw new ZlibCompressionError(`ZIP entry write failed with code: ${result}`)
+    }
+  }
+}
+
+/**
+ * A ZIP archive copied once into the WASM heap and read there in place;
+ * entries are inflated straight into buffers of their recorded size
+ */
+export class ZlibZipReader {
+  private handle: number
+
+  constructor(
+    private readonly module: ZlibModule,
+    private readonly pool: HeapBufferPool,
+    private archive: ZlibHeapBuffer
+  ) {
+    this.handle = module._zlib_unzip_open_memory(archive.ptr, archive.length)
+    if (!this.handle) {
+      pool.release(archive)
+      throw new ZlibCompressionError('Not a ZIP archive')
+    }
+  }
+
+  /** Number of entries */
+  get count(): number {
+    this.checkOpen()
+    return this.module._zlib_unzip_count(this.handle)
+  }
+
+  /** Contents of the entry called name, or null if there is none */
+  extract(name: string): Uint8Array | null {
+    this.checkOpen()
+    const result = withString(this.pool, name, namePtr =>
+      this.module._zlib_unzip_extract(this.handle, namePtr, this.pool.pointerPtr, this.pool.lengthPtr)
+    )
+
+    if (result === UNZ_END_OF_LIST_OF_FILE) return null
+    if (result !== ZIP_OK) {
+      throw new ZlibCompressionError(`ZIP entry ${name} failed with code: ${result}`)
+    }
+    return take(this.module, this.pool)
+  }
+
+  /**
+   * Contents of each named entry, null where there is none. The module
+   * reads the entries in the order they are stored, not the order asked for.
+   */
+  extractMany(names: string[]): (Uint8Array | null)[] {
+    return this.batch(names, (namesPtr, outPtrs, outLens) =>
+      this.module._zlib_unzip_extract_batch(this.handle, namesPtr, names.length, outPtrs, outLens)
+    )
+  }
+
+  /**
+   * extractMany() on the -pthread build's thread pool, every thread
+   * inflating straight from this reader's copy of the archive
+   */
+  extractParallel(names: string[], threads: number): (Uint8Array | null)[] {
+    return this.batch(names, (namesPtr, outPtrs, outLens) =>
+      this.module._zlib_unzip_extract_parallel!(this.handle, namesPtr, names.length, outPtrs, outLens, threads)
+    )
+  }
+
+  /** Where the entry called name has its data, or null if there is none */
+  locate(name: string): ZlibZipEntryLocation | null {
+    this.checkOpen()
+    const entry = this.pool.acquire(20)
+    try {
+      const result = withString(this.pool, name, namePtr =>
+        this.module._zlib_unzip_locate(this.handle, namePtr, entry.ptr)
+      )
+      if (result === UNZ_END_OF_LIST_OF_FILE) return null
+      if (result !== ZIP_OK) {
+        throw new ZlibCompressionError(`ZIP entry ${name} failed with code: ${result}`)
+      }
+
+      const [offset, compressedSize, size, crc, method] =
+        new Uint32Array(this.module.HEAPU8.buffer, entry.ptr, 5)
+      return { offset, compressedSize, size, crc, method }
+    } finally {
+      this.pool.release(entry)
+    }
+  }
+
+  /** Copy of a located entry's data, e.g. to inflate on a worker */
+  data(location: ZlibZipEntryLocation): Uint8Array {
+    this.checkOpen()
+    const start = this.archive.ptr + location.offset
+    return this.module.HEAPU8.slice(start, start + location.compressedSize)
+  }
+
+  /** Close the archive and free its heap copy */
+  dispose(): void {
+    if (!this.handle) return
+    this.module._zlib_unzip_close(this.handle)
+    this.pool.release(this.archive)
+    this.handle = 0
+  }
+
+  /**
+   * Run a batch export over names: it takes the name pointers and fills
+   * the output pointers and lengths, each a u32 array indexed like names
+   */
+  private batch(
+    names: string[],
+    extract: (namesPtr: number, outPtrs: number, outLens: number) => number
+  ): (Uint8Array | null)[] {
+    this.checkOpen()
+    const count = names.length
+    if (count === 0) return []
+    const strings = names.map(name => encoder.encode(name + '\0'))
+    const heap = this.pool.acquire(strings.reduce((n, name) => n + name.length, 0))
+    // Name pointers, then output pointers, then output lengths
+    const tables = this.pool.acquire(count * 12)
+
+    try {
+      const u32 = new Uint32Array(this.module.HEAPU8.buffer, tables.ptr, count * 3)
+      let ptr = heap.ptr
+      for (let i = 0; i < count; i++) {
+        this.module.HEAPU8.set(strings[i], ptr)
+        u32[i] = ptr
+        ptr += strings[i].length
+      }
+
+      const result = extract(tables.ptr, tables.ptr + count * 4, tables.ptr + count * 8)
+      if (result !== ZIP_OK) {
+        throw new ZlibCompressionError(`ZIP batch extract failed with code: ${result}`)
+      }
+
+      // The heap may have grown while inflating
+      const out = new Uint32Array(this.module.HEAPU8.buffer, tables.ptr, count * 3)
+      return names.map((_, i) => {
+        const dataPtr = out[count + i]
+        if (!dataPtr) return null
+        const data = this.module.HEAPU8.slice(dataPtr, dataPtr + out[2 * count + i])
+        this.module._free(dataPtr)
+        return data
+      })
+    } finally {
+      this.pool.release(tables)
+      this.pool.release(heap)
+    }
+  }
+
+  private checkOpen(): void {
+    if (!this.handle) throw new ZlibMemoryError('ZIP archive has been closed')
+  }
+}
@@ -13,7 +13,16 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <limits.h>
+#include <math.h>
 #include "zlib.h"
+#include "deflate.h"
+#include "inftrees.h"
+#include "inflate.h"
+#include "zlib_snapshot.h"
+#ifdef ZLIB_WASM_ARENA
+#include "zlib_arena.h"
+#endif
 
 // Forward declarations for SIMD functions
 extern int zlib_compress_simd(const uint8_t* input, size_t input_len,
@@ -25,7 +34,256 @@ extern void zlib_simd_analysis(const uint8_t* input, size_t input_len,
                                double* compression_ratio, double* simd_speedup,
                                double* memory_efficiency);
 
+// Stream context shared by the buffer and streaming APIs
+typedef struct zlib_stream_s {
+    z_stream stream;
+    int initialized;
+    // Pool key: the stream kind and its deflateInit2/inflateInit2 parameters
+    int kind;
+    int level;
+    int window_bits;
+    int mem_level;
+    int strategy;
+    int profile;
+    // Output ring of the drain calls, owned by the context until released,
+    // behind the RING_CELLS result cells that JS reads
+    unsigned int* ring;
+    unsigned int ring_size;
+    unsigned int ring_pos;
+    struct zlib_stream_s* next;     // free-list link while pooled
+} zlib_stream_t;
+
+#define ZLIB_CTX_DEFLATE 0
+#define ZLIB_CTX_INFLATE 1
+
+// Deflate memory profiles. FAST keeps deflateInit2()'s symbol buffer of
+// 1 << (mem_level + 6) symbols; LOW_MEMORY takes a quarter of it, which at
+// the default mem_level cuts the pending buffer from 64 KB to 16 KB, a
+// fifth of the context, for blocks a quarter the length.
+#define ZLIB_PROFILE_FAST 0
+#define ZLIB_PROFILE_LOW_MEMORY 1
+
+// Idle contexts kept per key; each deflate context holds ~256 KB of state
+#define ZLIB_CTX_POOL_PER_KEY 4
+
+static zlib_stream_t* ctx_pool = NULL;
+
+// The -pthread build compresses blocks from several threads at once
+#ifdef __EMSCRIPTEN_PTHREADS__
+#include <pthread.h>
+static pthread_mutex_t ctx_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+#define CTX_POOL_LOCK() pthread_mutex_lock(&ctx_pool_lock)
+#define CTX_POOL_UNLOCK() pthread_mutex_unlock(&ctx_pool_lock)
+#else
+#define CTX_POOL_LOCK()
+#define CTX_POOL_UNLOCK()
+#endif
+
+static int ctx_key_equal(const zlib_stream_t* ctx, int kind, int level,
+                         int window_bits, int mem_level, int strategy,
+                         int profile) {
+    return ctx->kind == kind && ctx->level == level &&
+           ctx->window_bits == window_bits && ctx->mem_level == mem_level &&
+           ctx->strategy == strategy && ctx->profile == profile;
+}
+
+// deflateSymbolBits() for a profile, or 0 to keep deflateInit2()'s
+static int profile_lit_bits(int profile, int mem_level) {
+    if (profile != ZLIB_PROFILE_LOW_MEMORY) return 0;
+    return mem_level + 4 < 7 ? 7 : mem_level + 4;
+}
+
+static void ctx_destroy(zlib_stream_t* ctx) {
+    if (ctx->initialized) {
+        if (ctx->kind == ZLIB_CTX_DEFLATE) deflateEnd(&ctx->stream);
+        else inflateEnd(&ctx->stream);
+    }
+#ifdef ZLIB_WASM_ARENA
+    zlib_arena_detach(&ctx->stream);
+#endif
+    free(ctx->ring);
+    free(ctx);
+}
+
+static zlib_stream_t* ctx_acquire(int kind, int level, int window_bits,
+                                  int mem_level, int strategy, int profile) {
+    int wbits = window_bits < 0 ? -window_bits : window_bits & 15;
+    int wrap = window_bits < 0 ? 0 : window_bits >> 4;
+
+    if (kind == ZLIB_CTX_DEFLATE) {
+        // -15..-8 raw, 8..15 zlib, +16 for gzip
+        if (level < 0 || level > Z_ULTRA_COMPRESSION) level = Z_DEFAULT_COMPRESSION;
+        if (wbits < 8 || wbits > 15 || wrap > 1) window_bits = 15;
+        if (mem_level < 1 || mem_level > 9) mem_level = 8;
+        if (profile != ZLIB_PROFILE_LOW_MEMORY) profile = ZLIB_PROFILE_FAST;
+    } else if (kind == ZLIB_CTX_INFLATE) {
+        // -15..-8 raw, 8..15 zlib, +16 for gzip only, +32 to auto-detect zlib or gzip
+        if (wbits < 8 || wbits > 15 || wrap > 2) window_bits = 15;
+        level = mem_level = strategy = profile = 0;
+    } else {
+        return NULL;
+    }
+
+    CTX_POOL_LOCK();
+    for (zlib_stream_t** link = &ctx_pool; *link; link = &(*link)->next) {
+        zlib_stream_t* ctx = *link;
+        if (ctx_key_equal(ctx, kind, level, window_bits, mem_level, strategy, profile)) {
+            *link = ctx->next;
+            CTX_POOL_UNLOCK();
+            ctx->next = NULL;
+            return ctx;
+        }
+    }
+    CTX_POOL_UNLOCK();
+
+    zlib_stream_t* ctx = (zlib_stream_t*)malloc(sizeof(zlib_stream_t));
+    if (!ctx) return NULL;
+
+    memset(ctx, 0, sizeof(zlib_stream_t));
+
+#ifdef ZLIB_WASM_ARENA
+    // One slab per context, kept for as long as the context is pooled
+    zlib_arena_attach(&ctx->stream, kind == ZLIB_CTX_INFLATE, window_bits, mem_level,
+                      profile_lit_bits(profile, mem_level));
+#endif
+
+    int ret = kind == ZLIB_CTX_DEFLATE ?
+        deflateInit2(&ctx->stream, level, Z_DEFLATED, window_bits, mem_level, strategy) :
+        inflateInit2(&ctx->stream, window_bits);
+    if (ret == Z_OK) {
+        ctx->initialized = 1;
+        ctx->kind = kind;
+        int lit_bits = profile_lit_bits(profile, mem_level);
+        if (lit_bits) ret = deflateSymbolBits(&ctx->stream, lit_bits);
+    }
+
+    if (ret != Z_OK) {
+        ctx_destroy(ctx);
+        return NULL;
+    }
+
+    ctx->level = level;
+    ctx->window_bits = window_bits;
+    ctx->mem_level = mem_level;
+    ctx->strategy = strategy;
+    ctx->profile = profile;
+    return ctx;
+}
+
+/**
+ * Get a deflate or inflate context for the given parameters, reusing a
+ * pooled one (already reset) when available. level, mem_level and strategy
+ * are ignored for ZLIB_CTX_INFLATE. Deflate contexts have the
+ * ZLIB_PROFILE_FAST layout. Returns NULL on failure.
+ */
+EMSCRIPTEN_KEEPALIVE
+zlib_stream_t* zlib_ctx_acquire(int kind, int level, int window_bits,
+                                int mem_level, int strategy) {
+    return ctx_acquire(kind, level, window_bits, mem_level, strategy, ZLIB_PROFILE_FAST);
+}
+
+/**
+ * Return a context to the pool, resetting it for the next acquire. Contexts
+ * beyond ZLIB_CTX_POOL_PER_KEY, or that fail to reset, are freed.
+ */
+EMSCRIPTEN_KEEPALIVE
+void zlib_ctx_release(zlib_stream_t* ctx) {
+    if (!ctx) return;
+
+    // Pooled contexts are counted by zlib_ctx_memory(), which has no ring
+    free(ctx->ring);
+    ctx->ring = NULL;
+    ctx->ring_size = ctx->ring_pos = 0;
+
+    int ret = Z_STREAM_ERROR;
+    if (ctx->initialized) {
+        ret = ctx->kind == ZLIB_CTX_DEFLATE ?
+            deflateReset(&ctx->stream) : inflateReset(&ctx->stream);
+    }
+    // deflate_whole() may have switched the stream to level 0; a reset
+    // stream takes its pool key's parameters back without a flush
+    if (ret == Z_OK && ctx->kind == ZLIB_CTX_DEFLATE) {
+        ret = deflateParams(&ctx->stream, ctx->level, ctx->strategy);
+    }
+
+    if (ret == Z_OK) {
+        int idle = 0;
+        CTX_POOL_LOCK();
+        for (zlib_stream_t* p = ctx_pool; p; p = p->next) {
+            idle += ctx_key_equal(p, ctx->kind, ctx->level, ctx->window_bits,
+                                  ctx->mem_level, ctx->strategy, ctx->profile);
+        }
+        if (idle < ZLIB_CTX_POOL_PER_KEY) {
+            ctx->next = ctx_pool;
+            ctx_pool = ctx;
+            ctx = NULL;
+        }
+        CTX_POOL_UNLOCK();
+    }
+
+    if (ctx) ctx_destroy(ctx);
+}
+
+/**
+ * Free every pooled context
+ */
+EMSCRIPTEN_KEEPALIVE
+void zlib_ctx_pool_drain(void) {
+    CTX_POOL_LOCK();
+    zlib_stream_t* ctx = ctx_pool;
+    ctx_pool = NULL;
+    CTX_POOL_UNLOCK();
+
+    while (ctx) {
+        zlib_stream_t* next = ctx->next;
+        ctx_destroy(ctx);
+        ctx = next;
+    }
+#ifdef ZLIB_WASM_ARENA
+    zlib_arena_drain();
+#endif
+}
+
+/**
+ * Bytes of zlib state held by a context with these parameters once it is in
+ * use: deflate_state with its window, hash chains and pending buffer, or
+ * inflate_state with its window, for a deflate context in the given
+ * profile. Parameters are defaulted as in zlib_ctx_acquire(); returns 0 for
+ * an unknown kind.
+ */
+EMSCRIPTEN_KEEPALIVE
+unsigned long zlib_ctx_memory(int kind, int window_bits, int mem_level, int profile) {
+    int wbits = window_bits < 0 ? -window_bits : window_bits & 15;
+    if (wbits < 8 || wbits > 15) wbits = MAX_WBITS;
+
+    if (kind == ZLIB_CTX_INFLATE) {
+        return sizeof(struct inflate_state) + (1UL << wbits);
+    }
+    if (kind != ZLIB_CTX_DEFLATE) return 0;
+
+    if (mem_level < 1 || mem_level > 9) mem_level = 8;
+    if (wbits == 8) wbits = 9;      // as deflateInit2() does
+    unsigned long w_size = 1UL << wbits;
+    unsigned long hash_size = 1UL << (mem_level + 7);
+    int lit_bits = profile_lit_bits(profile, mem_level);
+    unsigned long lit_bufsize = 1UL << (lit_bits ? lit_bits : mem_level + 6);
+    return sizeof(deflate_state) + w_size * 2 + WINDOW_PAD +
+           w_size * sizeof(Pos) + hash_size * sizeof(Pos) +
+           lit_bufsize * LIT_BUFS;
+}
+
 // WASM-specific zlib wrapper functions with error checking and memory management
+int zlib_compress_dict(const unsigned char* src, unsigned long src_len,
+                       const unsigned char* dict, unsigned long dict_len,
+                       unsigned char* dest, unsigned long* dest_len, int level);
+int zlib_decompress_dict_alloc(const unsigned char* src, unsigned long src_len,
+                               const unsigned char* dict, unsigned long dict_len,
+                               unsigned long size_hint, unsigned char** out,
+                               unsigned long* out_len);
+int zlib_decompress_limit_alloc(const unsigned char* src, unsigned long src_len,
+                                const unsigned char* dict, unsigned long dict_len,
+                                unsigned long size_hint, unsigned long max_out,
+                                unsigned char** out, unsigned long* out_len);
 
 /**
  * Compress data buffer with specified compression level
@@ -34,20 +292,607 @@ extern void zlib_simd_analysis(const uint8_t* input, size_t input_len,
 EMSCRIPTEN_KEEPALIVE
 int zlib_compress_buffer(const unsigned char* src, unsigned long src_len, 
                         unsigned char* dest, unsigned long* dest_len, int level) {
+    return zlib_compress_dict(src, src_len, NULL, 0, dest, dest_len, level);
+}
+
+/**
+ * Smallest windowBits and memLevel that cost nothing on a len-byte input: the
+ * window still reaches back over the whole input, and lit_bufsize
+ * (1 << (memLevel + 6)) holds all of its symbols, so it goes out as the same
+ * single block. From about 16 KB up this gives the defaults, 15 and 8; a
+ * 300-byte input needs ~18 KB of deflate state instead of ~268 KB.
+ */
+static void deflate_params_for(unsigned long len, int* window_bits, int* mem_level) {
+    int wbits = 9;
+    while (wbits < MAX_WBITS && (1UL << wbits) < len + MIN_LOOKAHEAD) wbits++;
+    *window_bits = wbits;
+    *mem_level = wbits - 6 < 8 ? wbits - 6 : 8;
+}
+
+/*
+ * avail_in and avail_out are 32-bit while buffer lengths are unsigned long,
+ * 64 bits wide on the -sMEMORY64 build. Buffers are handed to zlib in pieces
+ * of at most ZLIB_MAX_PIECE bytes, as compress2() and uncompress2() do, so a
+ * single call can cover more than 4 GB.
+ */
+#ifndef ZLIB_MAX_PIECE
+#define ZLIB_MAX_PIECE ((uInt)-1)
+#endif
+
+// Top up an exhausted avail_in/avail_out from the left bytes not yet given
+static void refill(uInt* avail, unsigned long* left) {
+    if (*avail == 0 && *left) {
+        *avail = *left > ZLIB_MAX_PIECE ? ZLIB_MAX_PIECE : (uInt)*left;
+        *left -= *avail;
+    }
+}
+
+// Whether the len bytes at p start a gzip member
+static int gzip_magic(const unsigned char* p, unsigned long len) {
+    return len >= 2 && p[0] == 0x1f && p[1] == 0x8b;
+}
+
+/*
+ * At the end of a gzip member, go on to the next one if the input carries
+ * on with another (pigz output, rotated logs joined with cat), appending
+ * to the same output as gunzip does. Anything else after the end is
+ * ignored. left_in is the input not yet handed to avail_in.
+ */
+static int next_member(z_stream* strm, unsigned long left_in) {
+    if (!gzip_magic(strm->next_in, strm->avail_in + left_in)) return 0;
+    return inflateReset(strm) == Z_OK;
+}
+
+/*
+ * Output size to grow a too-small buffer to once used bytes have come from
+ * consumed of src_len input bytes: extrapolated from the ratio so far,
+ * which sizes uniform data in one step, and at least half as much again.
+ * 0 if the buffer cannot grow any further.
+ */
+static unsigned long grow_output(unsigned long cap, unsigned long used,
+                                 unsigned long consumed, unsigned long src_len) {
+    double estimate = consumed ? (double)used / consumed * src_len * 1.05 : 0;
+    double grown = estimate > cap * 1.5 ? estimate : cap * 1.5;
+    if (grown > (double)ULONG_MAX) grown = (double)ULONG_MAX;
+    return (unsigned long)grown > cap ? (unsigned long)grown : 0;
+}
+
+/*
+ * Incompressible input (media, archives, encrypted data) still goes through
+ * the match search before _tr_flush_block() falls back to a stored block.
+ * deflate_whole() instead takes the input in segments and deflates the
+ * first PASSTHROUGH_PROBE bytes of each as asked. If they saved under 2%,
+ * the rest of the segment goes out at level 0, where deflate_stored()
+ * copies straight from input to output and the checksum is taken on the
+ * way. The probe ends in a block boundary, so its output is measured
+ * exactly however short it is; probing every segment rather than once
+ * keeps compressible data after a media header from being stored too.
+ * Segments after a probe that did compress double in length, up to
+ * PASSTHROUGH_SEGMENT_MAX, so text pays for few block boundaries.
+ */
+#define PASSTHROUGH_PROBE (16 * 1024)
+#define PASSTHROUGH_SEGMENT (256 * 1024)
+#define PASSTHROUGH_SEGMENT_MAX (8 * 1024 * 1024)
+// Below this, the rest is too short to repay the probe's block boundary
+#define PASSTHROUGH_MIN (4 * PASSTHROUGH_PROBE)
+// Output over input from which data counts as incompressible
+#define STORED_RATIO 0.98
+
+// End the current block, so all output so far is out and the level can
+// change without another flush. Returns Z_OK or deflate's error.
+static int end_block(z_stream* strm, unsigned long* left_out) {
+    int ret;
+    do {
+        refill(&strm->avail_out, left_out);
+        ret = deflate(strm, Z_BLOCK);
+    } while (ret == Z_OK && strm->avail_out == 0 && *left_out);
+    // Z_BUF_ERROR: the block had already ended, with nothing left to do
+    return ret == Z_BUF_ERROR ? Z_OK : ret;
+}
+
+// Deflate all of src into dest and finish the stream; *dest_len is the
+// space in dest on entry and the bytes written on return
+static int deflate_whole(z_stream* strm, const unsigned char* src, unsigned long src_len,
+                         unsigned char* dest, unsigned long* dest_len) {
+    unsigned long left_in = src_len, left_out = *dest_len;
+    strm->next_in = (Bytef*)src;
+    strm->avail_in = 0;
+    strm->next_out = dest;
+    strm->avail_out = 0;
+
+    // Input not yet released to left_in, where the current probe began, and
+    // the length of the next segment
+    deflate_state* s = (deflate_state*)strm->state;
+    int level = s->level;
+    int probing = 0;
+    unsigned long held = 0, probe_in = 0, probe_out = 0;
+    unsigned long segment = PASSTHROUGH_SEGMENT;
+    if (level > 0 && src_len >= PASSTHROUGH_MIN) {
+        held = src_len - PASSTHROUGH_PROBE;
+        left_in = PASSTHROUGH_PROBE;
+        probing = 1;
+    }
+
+    int ret;
+    do {
+        refill(&strm->avail_in, &left_in);
+        refill(&strm->avail_out, &left_out);
+        ret = deflate(strm, left_in || held ? Z_NO_FLUSH : Z_FINISH);
+        if (ret != Z_OK || !held || strm->avail_in || left_in) continue;
+
+        ret = end_block(strm, &left_out);
+        if (ret != Z_OK) break;
+        int next = level;
+        unsigned long release;
+        if (strm->avail_out == 0) {
+            // dest is full; the loop runs into Z_BUF_ERROR with the rest
+            release = held;
+        } else if (probing) {
+            if (strm->total_out - probe_out >= (strm->total_in - probe_in) * STORED_RATIO) {
+                next = 0;
+                segment = PASSTHROUGH_SEGMENT;
+            }
+            release = segment - PASSTHROUGH_PROBE;
+            if (next && segment < PASSTHROUGH_SEGMENT_MAX) segment *= 2;
+            probing = 0;
+        } else {
+            probe_in = strm->total_in;
+            probe_out = strm->total_out;
+            release = PASSTHROUGH_PROBE;
+            probing = 1;
+        }
+        if (next != s->level) {
+            ret = deflateParams(strm, next, s->strategy);
+            if (ret != Z_OK) break;
+        }
+        left_in = release < held ? release : held;
+        held -= left_in;
+    } while (ret == Z_OK);
+    *dest_len = (unsigned long)(strm->next_out - dest);
+
+    // Z_BUF_ERROR: dest filled up before the stream could finish
+    return ret == Z_STREAM_END ? Z_OK : ret;
+}
+
+/*
+ * Rolling hash of the last RSYNC_BITS input bytes, as pigz --rsyncable
+ * keeps it. A boundary follows every byte that leaves it at RSYNC_HIT: on
+ * average one per 2^RSYNC_BITS bytes, decided by the 12 bytes before it
+ * alone, so an edit moves only the boundaries next to it.
+ */
+#define RSYNC_BITS 12
+#define RSYNC_MASK ((1U << RSYNC_BITS) - 1)
+#define RSYNC_HIT (RSYNC_MASK >> 1)
+
+// Bytes up to and including the first boundary in buf, or 0 for none
+static unsigned long rsync_scan(const unsigned char* buf, unsigned long len, unsigned int* hash) {
+    unsigned int h = *hash;
+    for (unsigned long i = 0; i < len; i++) {
+        h = ((h << 1) ^ buf[i]) & RSYNC_MASK;
+        if (h == RSYNC_HIT) {
+            *hash = h;
+            return i + 1;
+        }
+    }
+    *hash = h;
+    return 0;
+}
+
+/*
+ * deflate_whole() with a Z_FULL_FLUSH at every rsync boundary: deflate
+ * starts over with an empty window there, so the output between two
+ * boundaries depends on that stretch of input only, and an edit changes
+ * the compressed bytes of its own stretch and no others
+ */
+static int deflate_rsyncable(z_stream* strm, const unsigned char* src, unsigned long src_len,
+                             unsigned char* dest, unsigned long* dest_len) {
+    const unsigned char* end = src + src_len;
+    unsigned long left_out = *dest_len;
+    unsigned int hash = 0;
+    strm->next_in = (Bytef*)src;
+    strm->avail_in = 0;
+    strm->next_out = dest;
+    strm->avail_out = 0;
+
+    int ret = Z_OK;
+    while (ret == Z_OK) {
+        unsigned long cut = rsync_scan(strm->next_in, (unsigned long)(end - strm->next_in), &hash);
+        unsigned long left_in = cut ? cut : (unsigned long)(end - strm->next_in);
+        int flush = strm->next_in + left_in < end ? Z_FULL_FLUSH : Z_FINISH;
+
+        // A flush is complete once deflate leaves output space unused
+        do {
+            refill(&strm->avail_in, &left_in);
+            refill(&strm->avail_out, &left_out);
+            ret = deflate(strm, left_in ? Z_NO_FLUSH : flush);
+        } while (ret == Z_OK && (flush == Z_FINISH || left_in || strm->avail_out == 0));
+    }
+    *dest_len = (unsigned long)(strm->next_out - dest);
+    return ret == Z_STREAM_END ? Z_OK : ret;
+}
+
+/**
+ * Bytes up to and including the first rsync boundary in buf, or 0 if there
+ * is none. *hash carries the rolling hash from one call to the next; start
+ * a stream with 0.
+ */
+EMSCRIPTEN_KEEPALIVE
+unsigned long zlib_rsync_scan(const unsigned char* buf, unsigned long len, unsigned int* hash) {
+    return buf && hash ? rsync_scan(buf, len, hash) : 0;
+}
+
+// Output a boundary can add: the flush's empty stored block, and the
+// stored-block header of the block it cut short
+#define RSYNC_OVERHEAD 10
+
+/**
+ * Number of rsync boundaries in src, each of which can cost RSYNC_OVERHEAD
+ * bytes beyond zlib_compress_format_bound()
+ */
+EMSCRIPTEN_KEEPALIVE
+unsigned long zlib_rsync_boundaries(const unsigned char* src, unsigned long src_len) {
+    unsigned long count = 0, cut;
+    unsigned int hash = 0;
+    while (src_len && (cut = rsync_scan(src, src_len, &hash)) != 0) {
+        src += cut;
+        src_len -= cut;
+        count++;
+    }
+    return count;
+}
+
+// Wrappers zlib_compress_format() can put around the deflate data
+#define ZLIB_FORMAT_ZLIB 0
+#define ZLIB_FORMAT_GZIP 1
+#define ZLIB_FORMAT_RAW 2
+
+/*
+ * One-shot stream of src into dest, as compress2() does but on a pooled
+ * context, in any format and with a strategy. window_bits and mem_level of
+ * 0 are sized to the input. head, for gzip, is set with deflateSetHeader();
+ * *check, if given, receives the Adler-32 (zlib) or CRC-32 (gzip) that
+ * deflate computed over src on the way, so no second pass is needed.
+ * rsyncable flushes at every rsync boundary, as deflate_rsyncable() does.
+ */
+static int compress_stream(const unsigned char* src, unsigned long src_len,
+                           const unsigned char* dict, unsigned long dict_len,
+                           unsigned char* dest, unsigned long* dest_len,
+                           int level, int strategy, int format, int window_bits,
+                           int mem_level, gz_headerp head, int rsyncable,
+                           unsigned long* check) {
+    // A dictionary stays on the defaults, matching zlib_dict_snapshot_create()
+    int wbits = 15, mlevel = 8;
+    if (!dict || !dict_len) deflate_params_for(src_len, &wbits, &mlevel);
+    if (window_bits) wbits = window_bits;
+    if (mem_level) mlevel = mem_level;
+
+    int init_bits = format == ZLIB_FORMAT_RAW ? -wbits :
+                    format == ZLIB_FORMAT_GZIP ? wbits + 16 : wbits;
+    zlib_stream_t* ctx = zlib_ctx_acquire(ZLIB_CTX_DEFLATE, level, init_bits, mlevel,
+                                          strategy);
+    if (!ctx) return Z_MEM_ERROR;
+
+    int ret = Z_OK;
+    if (dict && dict_len) {
+        ret = deflateSetDictionary(&ctx->stream, dict, (uInt)dict_len);
+    }
+    if (ret == Z_OK && head) {
+        ret = deflateSetHeader(&ctx->stream, head);
+    }
+
+    if (ret == Z_OK) {
+        ret = rsyncable ? deflate_rsyncable(&ctx->stream, src, src_len, dest, dest_len) :
+                          deflate_whole(&ctx->stream, src, src_len, dest, dest_len);
+        if (check) *check = format == ZLIB_FORMAT_RAW ? 0 : ctx->stream.adler;
+    }
+    // head belongs to the caller; the pooled context must not keep it. A
+    // finished gzip stream refuses deflateSetHeader(), so clear it directly
+    if (head) ((deflate_state*)ctx->stream.state)->gzhead = Z_NULL;
+    zlib_ctx_release(ctx);
+    return ret;
+}
+
+/**
+ * Compress data buffer against a preset dictionary (NULL for none)
+ * The stream records the dictionary's Adler-32 id; decompress it with
+ * zlib_decompress_dict_alloc() and the same dictionary.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_compress_dict(const unsigned char* src, unsigned long src_len,
+                       const unsigned char* dict, unsigned long dict_len,
+                       unsigned char* dest, unsigned long* dest_len, int level) {
     if (!src || !dest || !dest_len || src_len == 0) {
         return Z_STREAM_ERROR;
     }
-    
-    if (level < 0 || level > 9) {
-        level = Z_DEFAULT_COMPRESSION;
+    return compress_stream(src, src_len, dict, dict_len, dest, dest_len,
+                           level, Z_DEFAULT_STRATEGY, ZLIB_FORMAT_ZLIB, 0, 0, NULL, 0, NULL);
+}
+
+/**
+ * Compress data buffer as one zlib (format 0), gzip (1) or raw deflate (2)
+ * stream through deflateInit2(). window_bits (9..15) and mem_level (1..9)
+ * of 0 are sized to the input, as zlib_compress_buffer() does. For gzip, a
+ * name (NUL-terminated, or NULL) and mtime (seconds since the epoch, or 0)
+ * go into the header. With rsyncable, the stream is fully flushed at every
+ * rsync boundary, as gzip --rsyncable does; size dest with
+ * zlib_compress_format_bound() plus RSYNC_OVERHEAD per
+ * zlib_rsync_boundaries(). *check, if not NULL, receives the Adler-32 or
+ * CRC-32 of src that the stream's trailer carries (0 for raw).
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_compress_format(const unsigned char* src, unsigned long src_len,
+                         unsigned char* dest, unsigned long* dest_len,
+                         int level, int strategy, int format, int window_bits,
+                         int mem_level, const char* name, unsigned long mtime,
+                         int rsyncable, unsigned long* check) {
+    if (!src || !dest || !dest_len || src_len == 0 ||
+        format < ZLIB_FORMAT_ZLIB || format > ZLIB_FORMAT_RAW) {
+        return Z_STREAM_ERROR;
     }
-    
-    return compress2(dest, dest_len, src, src_len, level);
+
+    gz_header header;
+    gz_headerp head = NULL;
+    if (format == ZLIB_FORMAT_GZIP && (name || mtime)) {
+        memset(&header, 0, sizeof(header));
+        header.name = (Bytef*)name;
+        header.time = mtime;
+        header.os = OS_CODE;
+        head = &header;
+    }
+    return compress_stream(src, src_len, NULL, 0, dest, dest_len, level, strategy,
+                           format, window_bits, mem_level, head, rsyncable, check);
+}
+
+/**
+ * Upper bound on the zlib_compress_format() output for src_len bytes:
+ * compressBound() with the format's wrapper in place of zlib's, or
+ * deflateBound()'s conservative bound once window_bits or mem_level move
+ * off the defaults. name_len is the gzip name's length without its NUL.
+ */
+EMSCRIPTEN_KEEPALIVE
+unsigned long zlib_compress_format_bound(unsigned long src_len, int format, int window_bits,
+                                         int mem_level, unsigned long name_len) {
+    unsigned long wrap = format == ZLIB_FORMAT_RAW ? 0 :
+                         format == ZLIB_FORMAT_GZIP ? 18 + (name_len ? name_len + 1 : 0) : 6;
+    if ((window_bits && window_bits != 15) || (mem_level && mem_level != 8)) {
+        return src_len + ((src_len + 7) >> 3) + ((src_len + 63) >> 6) + 5 + wrap;
+    }
+    return compressBound(src_len) - 6 + wrap;
+}
+
+// Input the auto probe looks at: all of it up to PROBE_SAMPLE, otherwise
+// PROBE_SLICES slices spread evenly across it
+#define PROBE_SAMPLE (32 * 1024)
+#define PROBE_SLICES 8
+// Below this, probing costs more than a wrong guess
+#define PROBE_MIN 1024
+
+/**
+ * Level-1 trial deflate of the probe sample into scratch (at least
+ * compressBound(PROBE_SAMPLE) bytes). Returns the compressed size, or 0 if
+ * the trial could not run.
+ */
+static unsigned long probe_trial(const unsigned char* src, unsigned long src_len,
+                                 unsigned long slice, int slices,
+                                 unsigned char* scratch, unsigned long scratch_len) {
+    int window_bits, mem_level;
+    deflate_params_for(slice * slices, &window_bits, &mem_level);
+    zlib_stream_t* ctx = zlib_ctx_acquire(ZLIB_CTX_DEFLATE, 1, window_bits, mem_level,
+                                          Z_DEFAULT_STRATEGY);
+    if (!ctx) return 0;
+
+    z_stream* strm = &ctx->stream;
+    strm->next_out = scratch;
+    strm->avail_out = scratch_len;
+
+    int ret = Z_OK;
+    unsigned long step = slices > 1 ? (src_len - slice) / (slices - 1) : 0;
+    for (int i = 0; i < slices && ret == Z_OK; i++) {
+        strm->next_in = (Bytef*)src + step * i;
+        strm->avail_in = slice;
+        ret = deflate(strm, i == slices - 1 ? Z_FINISH : Z_NO_FLUSH);
+    }
+    unsigned long out = ret == Z_STREAM_END ? strm->total_out : 0;
+    zlib_ctx_release(ctx);
+    return out;
+}
+
+/**
+ * Compress data buffer with a level and strategy chosen from a probe of it.
+ * An order-0 byte entropy, the share of bytes repeating their predecessor
+ * and a level-1 trial decide between:
+ *
+ *   stored (level 0)       the trial saves under 2%: media, archives, random
+ *   Z_RLE                  three quarters of the bytes extend runs
+ *   Z_HUFFMAN_ONLY         the trial does no better than entropy coding alone
+ *   level 6                anything else
+ *
+ * so deflate_slow() is not left searching hash chains where there are no
+ * matches to find. choice receives { level, strategy, entropy in
+ * millibits per byte }. dest doubles as the trial's scratch space.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_compress_auto(const unsigned char* src, unsigned long src_len,
+                       unsigned char* dest, unsigned long* dest_len, int* choice) {
+    if (!src || !dest || !dest_len || !choice || src_len == 0) {
+        return Z_STREAM_ERROR;
+    }
+
+    unsigned long slice = src_len;
+    int slices = 1;
+    if (src_len > PROBE_SAMPLE) {
+        slice = PROBE_SAMPLE / PROBE_SLICES;
+        slices = PROBE_SLICES;
+    }
+
+    // Four interleaved tables so consecutive equal bytes do not serialize on
+    // one counter
+    uint32_t counts[4][256];
+    memset(counts, 0, sizeof(counts));
+    unsigned long runs = 0;
+    unsigned long step = slices > 1 ? (src_len - slice) / (slices - 1) : 0;
+    for (int i = 0; i < slices; i++) {
+        const unsigned char* p = src + step * i;
+        unsigned long j = 0;
+        for (; j + 4 <= slice; j += 4) {
+            counts[0][p[j]]++;
+            counts[1][p[j + 1]]++;
+            counts[2][p[j + 2]]++;
+            counts[3][p[j + 3]]++;
+        }
+        for (; j < slice; j++) counts[0][p[j]]++;
+        for (j = 1; j < slice; j++) runs += p[j] == p[j - 1];
+    }
+
+    double total = (double)slice * slices;
+    double entropy = 0;
+    for (int c = 0; c < 256; c++) {
+        uint32_t n = counts[0][c] + counts[1][c] + counts[2][c] + counts[3][c];
+        if (n) entropy -= n / total * log2(n / total);
+    }
+
+    int level = 6;
+    int strategy = Z_DEFAULT_STRATEGY;
+    if (src_len >= PROBE_MIN && *dest_len >= compressBound((uLong)total)) {
+        unsigned long trial = probe_trial(src, src_len, slice, slices, dest, *dest_len);
+        double ratio = trial / total;
+        if (trial == 0) {
+            // Trial failed; compress as usual
+        } else if (ratio >= STORED_RATIO) {
+            level = 0;
+        } else if (runs >= total * 0.75) {
+            strategy = Z_RLE;
+        } else if (ratio >= entropy / 8 * 0.98) {
+            strategy = Z_HUFFMAN_ONLY;
+        }
+    }
+
+    choice[0] = level;
+    choice[1] = strategy;
+    choice[2] = (int)(entropy * 1000 + 0.5);
+    return compress_stream(src, src_len, NULL, 0, dest, dest_len, level, strategy,
+                           ZLIB_FORMAT_ZLIB, 0, 0, NULL, 0, NULL);
+}
+
+/**
+ * Prime a deflate context with a preset dictionary, for repeated use with
+ * zlib_compress_snapshot(); the dictionary is hashed here once instead of
+ * on every message. Free it with zlib_ctx_release(). Returns NULL on failure.
+ */
+EMSCRIPTEN_KEEPALIVE
+zlib_stream_t* zlib_dict_snapshot_create(const unsigned char* dict, unsigned long dict_len,
+                                         int level) {
+    if (!dict || dict_len == 0) return NULL;
+
+    zlib_stream_t* ctx = zlib_ctx_acquire(ZLIB_CTX_DEFLATE, level, 15, 8, Z_DEFAULT_STRATEGY);
+    if (!ctx) return NULL;
+
+    if (deflateSetDictionary(&ctx->stream, dict, (uInt)dict_len) != Z_OK) {
+        zlib_ctx_release(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+/**
+ * Compress data buffer against a snapshot from zlib_dict_snapshot_create()
+ * Produces the same stream as zlib_compress_dict() with that dictionary;
+ * the snapshot itself is only read, never advanced.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_compress_snapshot(zlib_stream_t* snapshot, const unsigned char* src,
+                           unsigned long src_len, unsigned char* dest,
+                           unsigned long* dest_len) {
+    if (!snapshot || snapshot->kind != ZLIB_CTX_DEFLATE ||
+        !src || !dest || !dest_len || src_len == 0) {
+        return Z_STREAM_ERROR;
+    }
+
+    zlib_stream_t* ctx = zlib_ctx_acquire(ZLIB_CTX_DEFLATE, snapshot->level,
+                                          snapshot->window_bits, snapshot->mem_level,
+                                          snapshot->strategy);
+    if (!ctx) return Z_MEM_ERROR;
+
+    int ret = zlib_deflate_restore(&ctx->stream, &snapshot->stream);
+    if (ret == Z_OK) {
+        ret = deflate_whole(&ctx->stream, src, src_len, dest, dest_len);
+    }
+    zlib_ctx_release(ctx);
+    return ret;
 }
 
 /**
- * Decompress data buffer
- * Returns decompressed size or negative error code
+ * Compress count messages packed back to back in src, each into its own
+ * zlib stream, using one deflate context reset between messages.
+ * Message i is src[in_offsets[i] .. in_offsets[i + 1]); on success output i
+ * is dest[out_offsets[i] .. out_offsets[i + 1]). Both tables hold count + 1
+ * entries. Size dest with zlib_compress_batch_bound().
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_compress_batch(const unsigned char* src, const uint32_t* in_offsets,
+                        uint32_t count, unsigned char* dest, unsigned long dest_cap,
+                        uint32_t* out_offsets, int level) {
+    if (!src || !in_offsets || !dest || !out_offsets) {
+        return Z_STREAM_ERROR;
+    }
+
+    // One context for every message, sized for the largest
+    unsigned long longest = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        unsigned long len = in_offsets[i + 1] - in_offsets[i];
+        if (len > longest) longest = len;
+    }
+    int window_bits, mem_level;
+    deflate_params_for(longest, &window_bits, &mem_level);
+
+    zlib_stream_t* ctx = zlib_ctx_acquire(ZLIB_CTX_DEFLATE, level, window_bits, mem_level,
+                                          Z_DEFAULT_STRATEGY);
+    if (!ctx) return Z_MEM_ERROR;
+
+    z_stream* strm = &ctx->stream;
+    unsigned long out = 0;
+    int ret = Z_OK;
+
+    for (uint32_t i = 0; i < count; i++) {
+        out_offsets[i] = (uint32_t)out;
+
+        strm->next_in = (Bytef*)src + in_offsets[i];
+        strm->avail_in = in_offsets[i + 1] - in_offsets[i];
+        strm->next_out = dest + out;
+        strm->avail_out = dest_cap - out;
+
+        ret = deflate(strm, Z_FINISH);
+        if (ret != Z_STREAM_END) {
+            ret = ret == Z_OK ? Z_BUF_ERROR : ret;
+            break;
+        }
+        out += strm->total_out;
+        ret = deflateReset(strm);
+        if (ret != Z_OK) break;
+    }
+    out_offsets[count] = (uint32_t)out;
+    zlib_ctx_release(ctx);
+
+    return ret;
+}
+
+/**
+ * Get the dest size zlib_compress_batch() needs for the given offset table
+ */
+EMSCRIPTEN_KEEPALIVE
+unsigned long zlib_compress_batch_bound(const uint32_t* in_offsets, uint32_t count) {
+    unsigned long total = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        total += compressBound(in_offsets[i + 1] - in_offsets[i]);
+    }
+    return total;
+}
+
+/**
+ * Decompress data buffer (zlib or gzip, auto-detected; concatenated gzip
+ * members are decoded one after another into dest)
+ * Returns Z_OK with *dest_len set, Z_BUF_ERROR if dest is too small,
+ * or another negative error code
  */
 EMSCRIPTEN_KEEPALIVE
 int zlib_decompress_buffer(const unsigned char* src, unsigned long src_len,
@@ -55,24 +900,404 @@ int zlib_decompress_buffer(const unsigned char* src, unsigned long src_len,
     if (!src || !dest || !dest_len || src_len == 0) {
         return Z_STREAM_ERROR;
     }
-    
-    return uncompress(dest, dest_len, src, src_len);
+
+    zlib_stream_t* ctx = zlib_ctx_acquire(ZLIB_CTX_INFLATE, 0, 15 + 32, 0, 0);
+    if (!ctx) return Z_MEM_ERROR;
+
+    z_stream* strm = &ctx->stream;
+    unsigned long left_in = src_len, left_out = *dest_len;
+    strm->next_in = (Bytef*)src;
+    strm->avail_in = 0;
+    strm->next_out = dest;
+    strm->avail_out = 0;
+
+    int gzip = gzip_magic(src, src_len);
+    int ret;
+    do {
+        refill(&strm->avail_in, &left_in);
+        refill(&strm->avail_out, &left_out);
+        // Z_FINISH once both buffers are wholly given, so no window is needed
+        ret = inflate(strm, left_in || left_out ? Z_NO_FLUSH : Z_FINISH);
+        if (ret == Z_STREAM_END && gzip && next_member(strm, left_in)) ret = Z_OK;
+    } while (ret == Z_OK);
+    *dest_len = (unsigned long)(strm->next_out - dest);
+    int truncated = ret == Z_BUF_ERROR && left_out + strm->avail_out != 0;
+    zlib_ctx_release(ctx);
+
+    if (ret == Z_STREAM_END) return Z_OK;
+    if (ret == Z_NEED_DICT || truncated) {
+        return Z_DATA_ERROR;
+    }
+    return ret;
+}
+
+/**
+ * Read the ISIZE trailer of a gzip stream, 0 if not gzip. For concatenated
+ * members this is only the last member's size, so it can come up short.
+ */
+static unsigned long gzip_isize(const unsigned char* src, unsigned long src_len) {
+    if (src_len < 18 || src[0] != 0x1f || src[1] != 0x8b) return 0;
+
+    const unsigned char* t = src + src_len - 4;
+    return (unsigned long)t[0] | ((unsigned long)t[1] << 8) |
+           ((unsigned long)t[2] << 16) | ((unsigned long)t[3] << 24);
+}
+
+/**
+ * Decompress into a heap buffer sized from size_hint, the gzip ISIZE
+ * trailer, or a ratio estimate, growing only if that size was too small.
+ * Concatenated gzip members are decoded into one output.
+ * On Z_OK, *out holds a malloc'd buffer of exactly *out_len bytes that the
+ * caller releases with free().
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_decompress_alloc(const unsigned char* src, unsigned long src_len,
+                          unsigned long size_hint, unsigned char** out,
+                          unsigned long* out_len) {
+    return zlib_decompress_dict_alloc(src, src_len, NULL, 0, size_hint, out, out_len);
+}
+
+/**
+ * zlib_decompress_alloc() for streams compressed against a preset
+ * dictionary. Returns Z_DATA_ERROR if the stream asks for a dictionary and
+ * none, or one with a different Adler-32 id, was given.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_decompress_dict_alloc(const unsigned char* src, unsigned long src_len,
+                               const unsigned char* dict, unsigned long dict_len,
+                               unsigned long size_hint, unsigned char** out,
+                               unsigned long* out_len) {
+    return zlib_decompress_limit_alloc(src, src_len, dict, dict_len, size_hint, 0, out, out_len);
+}
+
+/**
+ * zlib_decompress_dict_alloc() for untrusted input: output past max_out
+ * bytes (0 for no limit) stops the inflate with Z_BUF_ERROR. The buffer
+ * never grows past max_out + 1 bytes, whatever the hint or a forged gzip
+ * ISIZE says, so a decompression bomb costs no more memory than that.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_decompress_limit_alloc(const unsigned char* src, unsigned long src_len,
+                                const unsigned char* dict, unsigned long dict_len,
+                                unsigned long size_hint, unsigned long max_out,
+                                unsigned char** out, unsigned long* out_len) {
+    if (!src || !out || !out_len || src_len == 0) {
+        return Z_STREAM_ERROR;
+    }
+
+    // One byte more than the limit, so output past it shows
+    unsigned long ceiling = max_out && max_out < ULONG_MAX ? max_out + 1 : ULONG_MAX;
+    unsigned long cap = size_hint ? size_hint : gzip_isize(src, src_len);
+    if (cap == 0) {
+        cap = src_len * 4 > 65536 ? src_len * 4 : 65536;
+    }
+    if (cap > ceiling) cap = ceiling;
+
+    unsigned char* buf = (unsigned char*)malloc(cap);
+    if (!buf) return Z_MEM_ERROR;
+
+    zlib_stream_t* ctx = zlib_ctx_acquire(ZLIB_CTX_INFLATE, 0, 15 + 32, 0, 0);
+    if (!ctx) {
+        free(buf);
+        return Z_MEM_ERROR;
+    }
+
+    z_stream* strm = &ctx->stream;
+    unsigned long left_in = src_len;
+    strm->next_in = (Bytef*)src;
+    strm->avail_in = 0;
+    strm->next_out = buf;
+    strm->avail_out = 0;
+
+    int gzip = gzip_magic(src, src_len);
+    int ret;
+    for (;;) {
+        refill(&strm->avail_in, &left_in);
+        if (strm->avail_out == 0) {
+            unsigned long used = (unsigned long)(strm->next_out - buf);
+            unsigned long room = cap - used;
+            if (room == 0) {
+                if (cap == ceiling && max_out) {
+                    ret = Z_BUF_ERROR;      // past the limit
+                    break;
+                }
+                // Hint was short: grow the buffer and continue where we were
+                unsigned long grown = grow_output(cap, used, src_len - left_in - strm->avail_in, src_len);
+                if (grown > ceiling) grown = ceiling;
+                unsigned char* next = grown ? (unsigned char*)realloc(buf, grown) : NULL;
+                if (!next) {
+                    ret = Z_MEM_ERROR;
+                    break;
+                }
+                buf = next;
+                strm->next_out = buf + used;
+                room = grown - cap;
+                cap = grown;
+            }
+            refill(&strm->avail_out, &room);
+        }
+
+        ret = inflate(strm, Z_NO_FLUSH);
+        if (ret == Z_STREAM_END) {
+            if (gzip && next_member(strm, left_in)) continue;
+            break;
+        }
+        if (ret == Z_NEED_DICT) {
+            ret = dict ? inflateSetDictionary(strm, dict, (uInt)dict_len) : Z_DATA_ERROR;
+            if (ret != Z_OK) {
+                ret = Z_DATA_ERROR;
+                break;
+            }
+            continue;
+        }
+        if (ret != Z_OK && ret != Z_BUF_ERROR) break;
+
+        if (strm->avail_out != 0 && strm->avail_in == 0 && left_in == 0) {
+            ret = Z_DATA_ERROR;     // truncated input
+            break;
+        }
+    }
+
+    unsigned long total = (unsigned long)(strm->next_out - buf);
+    zlib_ctx_release(ctx);
+
+    if (ret == Z_STREAM_END && max_out && total > max_out) ret = Z_BUF_ERROR;
+    if (ret != Z_STREAM_END) {
+        free(buf);
+        return ret;
+    }
+
+    if (total < cap) {
+        // Only reached when no exact size was known up front
+        unsigned char* fitted = (unsigned char*)realloc(buf, total ? total : 1);
+        if (fitted) buf = fitted;
+    }
+
+    *out = buf;
+    *out_len = total;
+    return Z_OK;
+}
+
+/**
+ * Decompress count zlib or gzip streams packed back to back in src, as
+ * zlib_compress_batch() writes them: stream i is src[in_offsets[i] ..
+ * in_offsets[i + 1]). One inflate context is reset between streams, so
+ * streams sent with the same Huffman trees decode with the tables built
+ * for the first of them. All output goes into one malloc'd buffer, sized
+ * from size_hint or a ratio estimate and grown from the ratio so far.
+ * On Z_OK, output i is (*out)[out_offsets[i] .. out_offsets[i + 1]) with
+ * count + 1 entries in out_offsets, *out_len is the total, and the caller
+ * releases *out with free(). On an error *out_len is the index of the
+ * stream that failed.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_decompress_batch(const unsigned char* src, const uint32_t* in_offsets,
+                          uint32_t count, unsigned long size_hint, unsigned char** out,
+                          unsigned long* out_len, uint32_t* out_offsets) {
+    if (!src || !in_offsets || !out || !out_len || !out_offsets) {
+        return Z_STREAM_ERROR;
+    }
+
+    unsigned long src_len = in_offsets[count] - in_offsets[0];
+    unsigned long cap = size_hint ? size_hint : src_len * 4 > 65536 ? src_len * 4 : 65536;
+    unsigned char* buf = (unsigned char*)malloc(cap);
+    if (!buf) return Z_MEM_ERROR;
+
+    zlib_stream_t* ctx = zlib_ctx_acquire(ZLIB_CTX_INFLATE, 0, 15 + 32, 0, 0);
+    if (!ctx) {
+        free(buf);
+        return Z_MEM_ERROR;
+    }
+
+    z_stream* strm = &ctx->stream;
+    unsigned long used = 0;
+    int ret = Z_OK;
+    uint32_t i;
+
+    for (i = 0; i < count && ret == Z_OK; i++) {
+        out_offsets[i] = (uint32_t)used;
+
+        const unsigned char* stream = src + in_offsets[i];
+        unsigned long left_in = in_offsets[i + 1] - in_offsets[i];
+        int gzip = gzip_magic(stream, left_in);
+        strm->next_in = (Bytef*)stream;
+        strm->avail_in = 0;
+
+        for (;;) {
+            refill(&strm->avail_in, &left_in);
+            if (used == cap) {
+                unsigned long consumed = (unsigned long)(strm->next_in - src) - in_offsets[0];
+                unsigned long grown = grow_output(cap, used, consumed, src_len);
+                unsigned char* next = grown ? (unsigned char*)realloc(buf, grown) : NULL;
+                if (!next) {
+                    ret = Z_MEM_ERROR;
+                    break;
+                }
+                buf = next;
+                cap = grown;
+            }
+            unsigned long room = cap - used;
+            strm->next_out = buf + used;
+            strm->avail_out = 0;
+            refill(&strm->avail_out, &room);
+
+            ret = inflate(strm, Z_NO_FLUSH);
+            used = (unsigned long)(strm->next_out - buf);
+            if (ret == Z_STREAM_END) {
+                ret = Z_OK;
+                if (gzip && next_member(strm, left_in)) continue;
+                break;
+            }
+            if (ret == Z_NEED_DICT) ret = Z_DATA_ERROR;
+            if (ret != Z_OK && ret != Z_BUF_ERROR) break;
+            ret = Z_OK;
+
+            if (strm->avail_out != 0 && strm->avail_in == 0 && left_in == 0) {
+                ret = Z_DATA_ERROR;     // truncated input
+                break;
+            }
+        }
+        if (ret == Z_OK) ret = inflateReset(strm);
+    }
+    zlib_ctx_release(ctx);
+
+    if (ret != Z_OK) {
+        free(buf);
+        *out_len = i - 1;
+        return ret;
+    }
+    out_offsets[count] = (uint32_t)used;
+
+    unsigned char* fitted = (unsigned char*)realloc(buf, used ? used : 1);
+    if (fitted) buf = fitted;
+    *out = buf;
+    *out_len = used;
+    return Z_OK;
 }
 
 /**
  * Calculate CRC32 checksum with optional continuation
  */
 EMSCRIPTEN_KEEPALIVE
-unsigned long zlib_crc32(unsigned long crc, const unsigned char* buf, unsigned int len) {
-    return crc32(crc, buf, len);
+unsigned long zlib_crc32(unsigned long crc, const unsigned char* buf, unsigned long len) {
+    return crc32_z(crc, buf, len);
 }
 
 /**
  * Calculate Adler32 checksum with optional continuation
  */
 EMSCRIPTEN_KEEPALIVE
-unsigned long zlib_adler32(unsigned long adler, const unsigned char* buf, unsigned int len) {
-    return adler32(adler, buf, len);
+unsigned long zlib_adler32(unsigned long adler, const unsigned char* buf, unsigned long len) {
+    return adler32_z(adler, buf, len);
+}
+
+/*
+ * z_off_t is only 32 bits on wasm32, so longer lengths are applied in
+ * pieces. CRC-32 combination is linear: crc32_combine(crc32_combine(a, 0,
+ * x), b, y) is crc32_combine(a, b, x + y).
+ */
+#define COMBINE_PIECE 0x40000000UL
+
+/**
+ * Combine the CRC32 of two adjacent blocks; len2 is the second block's length
+ */
+EMSCRIPTEN_KEEPALIVE
+unsigned long zlib_crc32_combine(unsigned long crc1, unsigned long crc2, unsigned long len2) {
+    for (; len2 > COMBINE_PIECE; len2 -= COMBINE_PIECE) {
+        crc1 = crc32_combine(crc1, 0, (z_off_t)COMBINE_PIECE);
+    }
+    return crc32_combine(crc1, crc2, (z_off_t)len2);
+}
+
+/**
+ * Operator for combining CRC32s whose second block is len2 bytes long, so
+ * many equal blocks pay for the x^len2 computation once
+ */
+EMSCRIPTEN_KEEPALIVE
+unsigned long zlib_crc32_combine_gen(unsigned long len2) {
+    unsigned long op = crc32_combine_gen((z_off_t)(len2 > COMBINE_PIECE ? COMBINE_PIECE : len2));
+    for (len2 -= len2 > COMBINE_PIECE ? COMBINE_PIECE : len2; len2; ) {
+        unsigned long piece = len2 > COMBINE_PIECE ? COMBINE_PIECE : len2;
+        // Applied to an operator, combine_op multiplies the two powers of x
+        op = crc32_combine_op(op, 0, crc32_combine_gen((z_off_t)piece));
+        len2 -= piece;
+    }
+    return op;
+}
+
+/**
+ * Combine the CRC32 of two adjacent blocks with an operator from
+ * zlib_crc32_combine_gen()
+ */
+EMSCRIPTEN_KEEPALIVE
+unsigned long zlib_crc32_combine_op(unsigned long crc1, unsigned long crc2, unsigned long op) {
+    return crc32_combine_op(crc1, crc2, op);
+}
+
+/**
+ * Combine the Adler32 of two adjacent blocks; len2 is the second block's length
+ */
+EMSCRIPTEN_KEEPALIVE
+unsigned long zlib_adler32_combine(unsigned long adler1, unsigned long adler2, unsigned long len2) {
+    // Only len2 modulo 65521, Adler-32's base, enters the combination
+    return adler32_combine(adler1, adler2, (z_off_t)(len2 % 65521));
+}
+
+/**
+ * Compress one block of a parallel (pigz-style) deflate stream as raw
+ * deflate data. dict holds up to the last 32 KB of the preceding input, or
+ * is NULL for the first block. Non-final blocks end with a sync flush, so
+ * the outputs of consecutive blocks concatenate into one deflate stream that
+ * the caller wraps in a zlib or gzip header and trailer.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_compress_block(const unsigned char* src, unsigned long src_len,
+                        const unsigned char* dict, unsigned long dict_len,
+                        unsigned char* dest, unsigned long* dest_len,
+                        int level, int last) {
+    if ((!src && src_len) || !dest || !dest_len) {
+        return Z_STREAM_ERROR;
+    }
+
+    zlib_stream_t* ctx = zlib_ctx_acquire(ZLIB_CTX_DEFLATE, level, -15, 8, Z_DEFAULT_STRATEGY);
+    if (!ctx) return Z_MEM_ERROR;
+
+    z_stream* strm = &ctx->stream;
+    int ret;
+
+    if (dict && dict_len) {
+        if (dict_len > 32768) {
+            dict += dict_len - 32768;
+            dict_len = 32768;
+        }
+        ret = deflateSetDictionary(strm, dict, (uInt)dict_len);
+        if (ret != Z_OK) {
+            zlib_ctx_release(ctx);
+            return ret;
+        }
+    }
+
+    strm->next_in = (Bytef*)src;
+    strm->avail_in = src_len;
+    strm->next_out = dest;
+    strm->avail_out = *dest_len;
+
+    ret = deflate(strm, last ? Z_FINISH : Z_SYNC_FLUSH);
+    *dest_len = strm->total_out;
+    int room_left = strm->avail_out != 0;
+    zlib_ctx_release(ctx);
+
+    if (last) return ret == Z_STREAM_END ? Z_OK : Z_BUF_ERROR;
+    return ret == Z_OK && room_left ? Z_OK : Z_BUF_ERROR;
+}
+
+/**
+ * Get maximum zlib_compress_block() output size for given input size
+ */
+EMSCRIPTEN_KEEPALIVE
+unsigned long zlib_compress_block_bound(unsigned long source_len) {
+    // compressBound() plus the empty stored block a sync flush appends
+    return compressBound(source_len) + 5;
 }
 
 /**
@@ -141,35 +1366,24 @@ void zlib_get_performance_info(int* has_simd, int* crc32_threshold, int* compres
 }
 
 // Streaming compression interface
-typedef struct {
-    z_stream stream;
-    int initialized;
-} zlib_stream_t;
 
 /**
  * Initialize compression stream
  */
 EMSCRIPTEN_KEEPALIVE
 zlib_stream_t* zlib_deflate_init(int level, int window_bits, int mem_level, int strategy) {
-    zlib_stream_t* ctx = (zlib_stream_t*)malloc(sizeof(zlib_stream_t));
-    if (!ctx) return NULL;
-    
-    memset(ctx, 0, sizeof(zlib_stream_t));
-    
-    if (level < 0 || level > 9) level = Z_DEFAULT_COMPRESSION;
-    if (window_bits < 8 || window_bits > 15) window_bits = 15;
-    if (mem_level < 1 || mem_level > 9) mem_level = 8;
-    
-    int ret = deflateInit2(&ctx->stream, level, Z_DEFLATED, window_bits, 
-                          mem_level, strategy);
-    
-    if (ret != Z_OK) {
-        free(ctx);
-        return NULL;
-    }
-    
-    ctx->initialized = 1;
-    return ctx;
+    return zlib_ctx_acquire(ZLIB_CTX_DEFLATE, level, window_bits, mem_level, strategy);
+}
+
+/**
+ * Initialize a compression stream in a memory profile: ZLIB_PROFILE_FAST as
+ * zlib_deflate_init(), or ZLIB_PROFILE_LOW_MEMORY for a quarter-size
+ * symbol and pending buffer
+ */
+EMSCRIPTEN_KEEPALIVE
+zlib_stream_t* zlib_deflate_init_profile(int level, int window_bits, int mem_level,
+                                         int strategy, int profile) {
+    return ctx_acquire(ZLIB_CTX_DEFLATE, level, window_bits, mem_level, strategy, profile);
 }
 
 /**
@@ -189,17 +1403,57 @@ int zlib_deflate_process(zlib_stream_t* ctx, const unsigned char* input,
     return deflate(&ctx->stream, flush);
 }
 
+/**
+ * Reset a compression stream to start the next stream, keeping its window
+ * and hash tables allocated
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_deflate_reset(zlib_stream_t* ctx) {
+    if (!ctx || !ctx->initialized || ctx->kind != ZLIB_CTX_DEFLATE) return Z_STREAM_ERROR;
+    return deflateReset(&ctx->stream);
+}
+
+/**
+ * Change a compression stream's level and strategy, as deflateParams().
+ * Flush the stream first (zlib_deflate_process() with Z_SYNC_FLUSH and
+ * its output drained): with nothing pending there is no output to make,
+ * and Z_BUF_ERROR says there was. The context is pooled under its new
+ * settings once released.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_deflate_params(zlib_stream_t* ctx, int level, int strategy) {
+    if (!ctx || !ctx->initialized || ctx->kind != ZLIB_CTX_DEFLATE) return Z_STREAM_ERROR;
+
+    // Input not yet compressed, or output not yet taken, would have to be
+    // written under the old settings, and there is nowhere to write it here
+    deflate_state* s = (deflate_state*)ctx->stream.state;
+    if (ctx->stream.avail_in != 0 || s->pending != 0 ||
+        (s->strstart - s->block_start) + s->lookahead != 0) {
+        return Z_BUF_ERROR;
+    }
+
+    // With no room to write into, the deflate(Z_BLOCK) inside deflateParams()
+    // returns at once, touching nothing; the checks above leave it nothing
+    // to do anyway
+    Bytef none;
+    ctx->stream.next_out = &none;
+    ctx->stream.avail_out = 0;
+    int ret = deflateParams(&ctx->stream, level, strategy);
+    ctx->stream.next_out = Z_NULL;
+    if (ret != Z_OK) return ret;
+
+    // As zlib_ctx_acquire() keys it
+    ctx->level = level;
+    ctx->strategy = strategy;
+    return Z_OK;
+}
+
 /**
  * Clean up compression stream
  */
 EMSCRIPTEN_KEEPALIVE
 void zlib_deflate_end(zlib_stream_t* ctx) {
-    if (ctx) {
-        if (ctx->initialized) {
-            deflateEnd(&ctx->stream);
-        }
-        free(ctx);
-    }
+    zlib_ctx_release(ctx);
 }
 
 /**
@@ -207,22 +1461,7 @@ void zlib_deflate_end(zlib_stream_t* ctx) {
  */
 EMSCRIPTEN_KEEPALIVE
 zlib_stream_t* zlib_inflate_init(int window_bits) {
-    zlib_stream_t* ctx = (zlib_stream_t*)malloc(sizeof(zlib_stream_t));
-    if (!ctx) return NULL;
-    
-    memset(ctx, 0, sizeof(zlib_stream_t));
-    
-    if (window_bits < 8 || window_bits > 15) window_bits = 15;
-    
-    int ret = inflateInit2(&ctx->stream, window_bits);
-    
-    if (ret != Z_OK) {
-        free(ctx);
-        return NULL;
-    }
-    
-    ctx->initialized = 1;
-    return ctx;
+    return zlib_ctx_acquire(ZLIB_CTX_INFLATE, 0, window_bits, 0, 0);
 }
 
 /**
@@ -242,17 +1481,24 @@ int zlib_inflate_process(zlib_stream_t* ctx, const unsigned char* input,
     return inflate(&ctx->stream, Z_NO_FLUSH);
 }
 
+/**
+ * Reset a decompression stream to start the next stream, such as the next
+ * message on a connection. Unlike zlib_inflate_end() followed by
+ * zlib_inflate_init(), the context stays with the caller and keeps its
+ * 32 KB window and inflate state allocated.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_inflate_reset(zlib_stream_t* ctx) {
+    if (!ctx || !ctx->initialized || ctx->kind != ZLIB_CTX_INFLATE) return Z_STREAM_ERROR;
+    return inflateReset(&ctx->stream);
+}
+
 /**
  * Clean up decompression stream
  */
 EMSCRIPTEN_KEEPALIVE
 void zlib_inflate_end(zlib_stream_t* ctx) {
-    if (ctx) {
-        if (ctx->initialized) {
-            inflateEnd(&ctx->stream);
-        }
-        free(ctx);
-    }
+    zlib_ctx_release(ctx);
 }
 
 /**
@@ -271,6 +1517,79 @@ unsigned int zlib_stream_avail_out(zlib_stream_t* ctx) {
     return ctx ? ctx->stream.avail_out : 0;
 }
 
+// {offset, length, avail_in, avail_out} of the last drain, ahead of the ring
+#define RING_CELLS 4
+
+/**
+ * Give a stream context an output ring of size bytes for
+ * zlib_deflate_drain() and zlib_inflate_drain(), replacing any earlier one.
+ * Returns the ring: RING_CELLS unsigned ints reporting the last drain's
+ * {offset, length, avail_in, avail_out}, then the size bytes that offset
+ * counts from. NULL if out of memory.
+ */
+EMSCRIPTEN_KEEPALIVE
+unsigned int* zlib_stream_ring(zlib_stream_t* ctx, unsigned int size) {
+    if (!ctx || !ctx->initialized || size < 2) return NULL;
+
+    unsigned int* ring = (unsigned int*)calloc(1, RING_CELLS * sizeof(unsigned int) + size);
+    if (!ring) return NULL;
+    free(ctx->ring);
+    ctx->ring = ring;
+    ctx->ring_size = size;
+    ctx->ring_pos = 0;
+    return ring;
+}
+
+/*
+ * Aim next_out at the ring after the last drain's output, or back at its
+ * start once less than half of it is left, so every call has at least
+ * half the ring to write into
+ */
+static int ring_begin(zlib_stream_t* ctx, const unsigned char* input, unsigned int input_len) {
+    if (!ctx || !ctx->initialized || !ctx->ring) return Z_STREAM_ERROR;
+
+    // NULL input carries on with what the last call left unread
+    if (input) {
+        ctx->stream.next_in = (Bytef*)input;
+        ctx->stream.avail_in = input_len;
+    }
+    if (ctx->ring_size - ctx->ring_pos < ctx->ring_size / 2) ctx->ring_pos = 0;
+    ctx->stream.next_out = (unsigned char*)(ctx->ring + RING_CELLS) + ctx->ring_pos;
+    ctx->stream.avail_out = ctx->ring_size - ctx->ring_pos;
+    return Z_OK;
+}
+
+static int ring_end(zlib_stream_t* ctx, int ret) {
+    unsigned int produced = ctx->ring_size - ctx->ring_pos - ctx->stream.avail_out;
+    ctx->ring[0] = ctx->ring_pos;
+    ctx->ring[1] = produced;
+    ctx->ring[2] = ctx->stream.avail_in;
+    ctx->ring[3] = ctx->stream.avail_out;
+    ctx->ring_pos += produced;
+    return ret;
+}
+
+/**
+ * zlib_deflate_process() into the context's ring. The bytes produced are
+ * the length bytes at offset, as the result cells report, and stay there
+ * until the next drain call.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_deflate_drain(zlib_stream_t* ctx, const unsigned char* input,
+                       unsigned int input_len, int flush) {
+    int ret = ring_begin(ctx, input, input_len);
+    return ret == Z_OK ? ring_end(ctx, deflate(&ctx->stream, flush)) : ret;
+}
+
+/**
+ * zlib_inflate_process() into the context's ring, as zlib_deflate_drain()
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_inflate_drain(zlib_stream_t* ctx, const unsigned char* input, unsigned int input_len) {
+    int ret = ring_begin(ctx, input, input_len);
+    return ret == Z_OK ? ring_end(ctx, inflate(&ctx->stream, Z_NO_FLUSH)) : ret;
+}
+
 /**
  * Get total input bytes processed by stream
  */
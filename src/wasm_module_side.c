@@ -17,7 +17,7 @@ extern uint32_t zlib_crc32_simd_optimized(uint32_t crc, const uint8_t* data, siz
 EMSCRIPTEN_KEEPALIVE
 int zlib_compress_buffer(const unsigned char* src, unsigned long src_len, 
                         unsigned char* dest, unsigned long* dest_len, int level) {
-    if (level < 0 || level > 9) level = Z_DEFAULT_COMPRESSION;
+    if (level < 0 || level > Z_ULTRA_COMPRESSION) level = Z_DEFAULT_COMPRESSION;
     return compress2(dest, dest_len, src, src_len, level);
 }
 
@@ -173,7 +173,7 @@ int zlib_compress_buffer(const unsigned char* src, unsigned long src_len,
         return Z_STREAM_ERROR;
     }
     
-    if (level < 0 || level > 9) {
+    if (level < 0 || level > Z_ULTRA_COMPRESSION) {
         level = Z_DEFAULT_COMPRESSION;
     }
     
@@ -252,7 +252,7 @@ zlib_stream_t* zlib_deflate_init(int level, int window_bits, int mem_level, int
     
     memset(ctx, 0, sizeof(zlib_stream_t));
     
-    if (level < 0 || level > 9) level = Z_DEFAULT_COMPRESSION;
+    if (level < 0 || level > Z_ULTRA_COMPRESSION) level = Z_DEFAULT_COMPRESSION;
     if (window_bits < 8 || window_bits > 15) window_bits = 15;
     if (mem_level < 1 || mem_level > 9) mem_level = 8;
     
@@ -0,0 +1,169 @@
+/**
+ * zlib.wasm - Stream arena allocator
+ *
+ * Copyright 2025 Superstruct Ltd, New Zealand
+ *
+ * This source code is licensed under the Zlib license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Slab sizes mirror the allocations deflateInit2() and inflate() make:
+ *
+ *   deflate: deflate_state + window (2 * w_size) + prev (2 * w_size)
+ *            + head (2 * hash_size) + pending_buf (LIT_BUFS * lit_bufsize)
+ *   inflate: inflate_state + window (1 << wbits)
+ *
+ * rounded up to 16 KB so that streams with nearby parameters share a size
+ * class. Anything that does not fit (inflateReset2() growing the window,
+ * deflateCopy() into an attached stream) falls back to malloc. A slab sized
+ * for a smaller symbol buffer has no room for the one deflateInit2() makes,
+ * which goes to malloc until deflateSymbolBits() replaces it from the slab.
+ */
+
+#include <emscripten.h>
+#include <stdlib.h>
+#include "deflate.h"
+#include "inftrees.h"
+#include "inflate.h"
+#include "zlib_arena.h"
+
+#define ARENA_ALIGN 16
+#define ARENA_CLASS_SIZE (16 * 1024)
+
+// Idle slabs kept across all size classes before they go back to malloc
+#define ARENA_MAX_FREE 8
+
+typedef struct zlib_slab_s {
+    size_t size;                    // usable bytes after the header
+    size_t used;
+    struct zlib_slab_s* next;       // free-list link while idle
+} zlib_slab_t;
+
+#define SLAB_HEADER ((sizeof(zlib_slab_t) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+#define SLAB_DATA(slab) ((unsigned char*)(slab) + SLAB_HEADER)
+
+static zlib_slab_t* free_slabs = NULL;
+static int free_count = 0;
+
+#ifdef __EMSCRIPTEN_PTHREADS__
+#include <pthread.h>
+static pthread_mutex_t arena_lock = PTHREAD_MUTEX_INITIALIZER;
+#define ARENA_LOCK() pthread_mutex_lock(&arena_lock)
+#define ARENA_UNLOCK() pthread_mutex_unlock(&arena_lock)
+#else
+#define ARENA_LOCK()
+#define ARENA_UNLOCK()
+#endif
+
+static size_t align_up(size_t n) {
+    return (n + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+static size_t slab_size_for(int inflate, int window_bits, int mem_level, int lit_bits) {
+    int wbits = window_bits < 0 ? -window_bits : window_bits & 15;
+    size_t need;
+
+    if (inflate) {
+        if (wbits == 0) wbits = MAX_WBITS;
+        need = align_up(sizeof(struct inflate_state)) + align_up((size_t)1 << wbits);
+    } else {
+        if (wbits == 8) wbits = 9;      // as deflateInit2() does
+        size_t w_size = (size_t)1 << wbits;
+        size_t hash_size = (size_t)1 << (mem_level + 7);
+        size_t lit_bufsize = (size_t)1 << (lit_bits ? lit_bits : mem_level + 6);
+        need = align_up(sizeof(deflate_state)) +
+               align_up(w_size * 2 + WINDOW_PAD) +
+               align_up(w_size * sizeof(Pos)) +
+               align_up(hash_size * sizeof(Pos)) +
+               align_up(lit_bufsize * LIT_BUFS);
+    }
+
+    return (need + SLAB_HEADER + ARENA_CLASS_SIZE - 1) / ARENA_CLASS_SIZE * ARENA_CLASS_SIZE - SLAB_HEADER;
+}
+
+static voidpf arena_alloc(voidpf opaque, uInt items, uInt size) {
+    zlib_slab_t* slab = (zlib_slab_t*)opaque;
+    size_t bytes = align_up((size_t)items * size);
+
+    if (slab->size - slab->used >= bytes) {
+        voidpf ptr = SLAB_DATA(slab) + slab->used;
+        slab->used += bytes;
+        return ptr;
+    }
+    return malloc((size_t)items * size);
+}
+
+static void arena_free(voidpf opaque, voidpf ptr) {
+    zlib_slab_t* slab = (zlib_slab_t*)opaque;
+    unsigned char* p = (unsigned char*)ptr;
+
+    // Slab memory is reclaimed as a whole by zlib_arena_detach()
+    if (p >= SLAB_DATA(slab) && p < SLAB_DATA(slab) + slab->size) return;
+    free(ptr);
+}
+
+int zlib_arena_attach(z_streamp strm, int inflate, int window_bits, int mem_level, int lit_bits) {
+    size_t size = slab_size_for(inflate, window_bits, mem_level, lit_bits);
+    zlib_slab_t* slab = NULL;
+
+    ARENA_LOCK();
+    for (zlib_slab_t** link = &free_slabs; *link; link = &(*link)->next) {
+        if ((*link)->size == size) {
+            slab = *link;
+            *link = slab->next;
+            free_count--;
+            break;
+        }
+    }
+    ARENA_UNLOCK();
+
+    if (!slab) {
+        slab = (zlib_slab_t*)malloc(SLAB_HEADER + size);
+        if (!slab) return 0;
+        slab->size = size;
+    }
+
+    slab->used = 0;
+    slab->next = NULL;
+    strm->zalloc = arena_alloc;
+    strm->zfree = arena_free;
+    strm->opaque = slab;
+    return 1;
+}
+
+void zlib_arena_detach(z_streamp strm) {
+    if (strm->zalloc != arena_alloc) return;
+
+    zlib_slab_t* slab = (zlib_slab_t*)strm->opaque;
+    strm->zalloc = Z_NULL;
+    strm->zfree = Z_NULL;
+    strm->opaque = Z_NULL;
+
+    ARENA_LOCK();
+    if (free_count < ARENA_MAX_FREE) {
+        slab->next = free_slabs;
+        free_slabs = slab;
+        free_count++;
+        slab = NULL;
+    }
+    ARENA_UNLOCK();
+
+    free(slab);
+}
+
+/**
+ * Free every idle arena slab
+ */
+EMSCRIPTEN_KEEPALIVE
+void zlib_arena_drain(void) {
+    ARENA_LOCK();
+    zlib_slab_t* slab = free_slabs;
+    free_slabs = NULL;
+    free_count = 0;
+    ARENA_UNLOCK();
+
+    while (slab) {
+        zlib_slab_t* next = slab->next;
+        free(slab);
+        slab = next;
+    }
+}
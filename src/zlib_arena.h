@@ -0,0 +1,31 @@
+/**
+ * zlib.wasm stream arena allocator
+ *
+ * Gives each z_stream one contiguous slab, sized up front for its
+ * windowBits/memLevel, and serves the stream's zalloc calls from it by
+ * bumping a pointer. Slabs come from page-granular size classes and go back
+ * to a free list when the stream is torn down, so a steady stream workload
+ * reuses the same few slabs instead of fragmenting the dlmalloc heap. Only
+ * built into the WASM glue when ZLIB_WASM_ARENA is defined.
+ */
+
+#ifndef ZLIB_ARENA_H
+#define ZLIB_ARENA_H
+
+#include "zlib.h"
+
+// Install the arena zalloc/zfree/opaque on a stream before deflateInit2
+// (inflate = 0) or inflateInit2 (inflate = 1); window_bits and mem_level are
+// the values about to be passed in, and lit_bits the deflateSymbolBits() to
+// follow, or 0 for deflateInit2()'s own. Returns 0 and leaves the stream on
+// the default allocator if no slab could be obtained.
+int zlib_arena_attach(z_streamp strm, int inflate, int window_bits, int mem_level, int lit_bits);
+
+// Return the stream's slab to the free list; call after deflateEnd/inflateEnd
+// or after a failed init. No-op for streams without a slab.
+void zlib_arena_detach(z_streamp strm);
+
+// Free every idle slab
+void zlib_arena_drain(void);
+
+#endif /* ZLIB_ARENA_H */
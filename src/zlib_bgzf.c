@@ -0,0 +1,119 @@
+/**
+ * zlib.wasm - Blocked gzip (BGZF) output
+ *
+ * Copyright 2025 Superstruct Ltd, New Zealand
+ *
+ * This source code is licensed under the Zlib license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * The layout bgzip and htslib write: the input is cut into blocks of at
+ * most BGZF_BLOCK_SIZE bytes, and each block becomes a gzip member of its
+ * own, no larger than 64 KB, whose header carries a "BC" extra field with
+ * the member's size less one (BSIZE). An empty member marks the end. Every
+ * gzip reader inflates the result as one file, since members concatenate,
+ * but no member depends on another, so one can be inflated alone given
+ * only its offset; see src/lib/bgzf.ts for the index and the reader.
+ */
+
+#include <emscripten.h>
+#include <string.h>
+#include "zlib.h"
+
+// Input per member, and the most a member may take up, header to trailer
+#define BGZF_BLOCK_SIZE 0xff00
+#define BGZF_MAX_MEMBER 0x10000
+#define BGZF_HEADER 18
+#define BGZF_TRAILER 8
+
+// Defined in wasm_module.c
+int zlib_compress_block(const unsigned char* src, unsigned long src_len,
+                        const unsigned char* dict, unsigned long dict_len,
+                        unsigned char* dest, unsigned long* dest_len,
+                        int level, int last);
+
+// The end-of-file marker: an empty member, as bgzip writes it
+static const unsigned char bgzf_eof[28] = {
+    0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff, 6, 0, 'B', 'C', 2, 0, 0x1b, 0,
+    3, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+static void put4(unsigned char* p, unsigned long v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+/**
+ * Write src (at most BGZF_BLOCK_SIZE bytes) to dest as one BGZF member of
+ * at most BGZF_MAX_MEMBER bytes, which dest must have room for. Input that
+ * deflate cannot fit is stored instead. *dest_len receives the member's
+ * length.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_bgzf_member(const unsigned char* src, unsigned long src_len,
+                     unsigned char* dest, unsigned long* dest_len, int level) {
+    if ((!src && src_len) || !dest || !dest_len || src_len > BGZF_BLOCK_SIZE) {
+        return Z_STREAM_ERROR;
+    }
+
+    unsigned char* data = dest + BGZF_HEADER;
+    unsigned long room = BGZF_MAX_MEMBER - BGZF_HEADER - BGZF_TRAILER;
+    unsigned long len = room;
+    int ret = zlib_compress_block(src, src_len, NULL, 0, data, &len, level, 1);
+    if (ret == Z_BUF_ERROR) {
+        len = room;
+        ret = zlib_compress_block(src, src_len, NULL, 0, data, &len, 0, 1);
+    }
+    if (ret != Z_OK) return ret;
+
+    unsigned long size = BGZF_HEADER + len + BGZF_TRAILER;
+    memcpy(dest, bgzf_eof, BGZF_HEADER);
+    dest[16] = (unsigned char)(size - 1);
+    dest[17] = (unsigned char)((size - 1) >> 8);
+    put4(data + len, crc32_z(0L, src, src_len));
+    put4(data + len + 4, src_len);
+    *dest_len = size;
+    return Z_OK;
+}
+
+/**
+ * Compress src as BGZF, in members of block_size input bytes (0 or more
+ * than BGZF_BLOCK_SIZE for BGZF_BLOCK_SIZE), followed by the end marker.
+ * dest_len is the capacity of dest on entry, at least
+ * zlib_bgzf_bound(src_len, block_size), and the output length on exit.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_bgzf_compress(const unsigned char* src, unsigned long src_len,
+                       unsigned char* dest, unsigned long* dest_len,
+                       int level, unsigned long block_size) {
+    if ((!src && src_len) || !dest || !dest_len) {
+        return Z_STREAM_ERROR;
+    }
+    if (block_size == 0 || block_size > BGZF_BLOCK_SIZE) block_size = BGZF_BLOCK_SIZE;
+
+    unsigned long out = 0;
+    for (unsigned long start = 0; start < src_len; start += block_size) {
+        if (*dest_len - out < BGZF_MAX_MEMBER) return Z_BUF_ERROR;
+        unsigned long len = src_len - start < block_size ? src_len - start : block_size;
+        unsigned long size;
+        int ret = zlib_bgzf_member(src + start, len, dest + out, &size, level);
+        if (ret != Z_OK) return ret;
+        out += size;
+    }
+
+    if (*dest_len - out < sizeof(bgzf_eof)) return Z_BUF_ERROR;
+    memcpy(dest + out, bgzf_eof, sizeof(bgzf_eof));
+    *dest_len = out + sizeof(bgzf_eof);
+    return Z_OK;
+}
+
+/**
+ * Output size zlib_bgzf_compress() needs for src_len bytes: a whole
+ * BGZF_MAX_MEMBER per member, so any member can be written in place
+ */
+EMSCRIPTEN_KEEPALIVE
+unsigned long zlib_bgzf_bound(unsigned long src_len, unsigned long block_size) {
+    if (block_size == 0 || block_size > BGZF_BLOCK_SIZE) block_size = BGZF_BLOCK_SIZE;
+    return (src_len + block_size - 1) / block_size * BGZF_MAX_MEMBER + sizeof(bgzf_eof);
+}
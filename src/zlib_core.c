@@ -0,0 +1,201 @@
+/**
+ * zlib.wasm - Inflate-only core
+ *
+ * Copyright 2025 Superstruct Ltd, New Zealand
+ *
+ * This source code is licensed under the Zlib license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * The exports ZlibCore needs before the full module is loaded: one-shot
+ * decompression and the checksums, with the same signatures as in
+ * wasm_module.c so the TypeScript wrapper drives either module the same
+ * way. Only inflate.c, inftrees.c, inffast.c, crc32.c, adler32.c and
+ * zutil.c are linked in; no deflate, no SIMD kernels, no context pool.
+ */
+
+#include <emscripten.h>
+#include <stdlib.h>
+#include <limits.h>
+#include "zlib.h"
+
+// One inflate stream, reset between calls, so its 32 KB window is
+// allocated once rather than per call
+static z_stream core_stream;
+static int core_stream_ready = 0;
+
+static z_stream* core_inflater(void) {
+    if (core_stream_ready) {
+        return inflateReset(&core_stream) == Z_OK ? &core_stream : NULL;
+    }
+    if (inflateInit2(&core_stream, 15 + 32) != Z_OK) return NULL;
+    core_stream_ready = 1;
+    return &core_stream;
+}
+
+// Whether the len bytes at p start a gzip member
+static int gzip_magic(const unsigned char* p, unsigned long len) {
+    return len >= 2 && p[0] == 0x1f && p[1] == 0x8b;
+}
+
+/**
+ * Read the ISIZE trailer of a gzip stream, 0 if not gzip; only the last
+ * member's size when members are concatenated
+ */
+static unsigned long gzip_isize(const unsigned char* src, unsigned long src_len) {
+    if (src_len < 18 || !gzip_magic(src, src_len)) return 0;
+
+    const unsigned char* t = src + src_len - 4;
+    return (unsigned long)t[0] | ((unsigned long)t[1] << 8) |
+           ((unsigned long)t[2] << 16) | ((unsigned long)t[3] << 24);
+}
+
+// Grown output size, as grow_output() in wasm_module.c picks it
+static unsigned long grow_output(unsigned long cap, unsigned long used,
+                                 unsigned long consumed, unsigned long src_len) {
+    double estimate = consumed ? (double)used / consumed * src_len * 1.05 : 0;
+    double grown = estimate > cap * 1.5 ? estimate : cap * 1.5;
+    if (grown > (double)ULONG_MAX) grown = (double)ULONG_MAX;
+    return (unsigned long)grown > cap ? (unsigned long)grown : 0;
+}
+
+/**
+ * Decompress zlib or gzip data, concatenated gzip members included, into a
+ * malloc'd buffer of exactly *out_len bytes, as zlib_decompress_limit_alloc()
+ * in wasm_module.c does: output past max_out bytes (0 for no limit) stops
+ * it with Z_BUF_ERROR, and the buffer never grows past max_out + 1
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_decompress_limit_alloc(const unsigned char* src, unsigned long src_len,
+                                const unsigned char* dict, unsigned long dict_len,
+                                unsigned long size_hint, unsigned long max_out,
+                                unsigned char** out, unsigned long* out_len) {
+    if (!src || !out || !out_len || src_len == 0) {
+        return Z_STREAM_ERROR;
+    }
+
+    // One byte more than the limit, so output past it shows
+    unsigned long ceiling = max_out && max_out < ULONG_MAX ? max_out + 1 : ULONG_MAX;
+    unsigned long cap = size_hint ? size_hint : gzip_isize(src, src_len);
+    if (cap == 0) {
+        cap = src_len * 4 > 65536 ? src_len * 4 : 65536;
+    }
+    if (cap > ceiling) cap = ceiling;
+
+    unsigned char* buf = (unsigned char*)malloc(cap);
+    if (!buf) return Z_MEM_ERROR;
+
+    z_stream* strm = core_inflater();
+    if (!strm) {
+        free(buf);
+        return Z_MEM_ERROR;
+    }
+
+    strm->next_in = (Bytef*)src;
+    strm->avail_in = src_len;
+    strm->next_out = buf;
+    strm->avail_out = cap;
+
+    int gzip = gzip_magic(src, src_len);
+    int ret;
+    for (;;) {
+        ret = inflate(strm, Z_NO_FLUSH);
+        if (ret == Z_STREAM_END) {
+            // Another member follows: append it to the same output
+            if (gzip && gzip_magic(strm->next_in, strm->avail_in) &&
+                inflateReset(strm) == Z_OK) continue;
+            break;
+        }
+        if (ret == Z_NEED_DICT) {
+            ret = dict ? inflateSetDictionary(strm, dict, (uInt)dict_len) : Z_DATA_ERROR;
+            if (ret != Z_OK) {
+                ret = Z_DATA_ERROR;
+                break;
+            }
+            continue;
+        }
+        if (ret != Z_OK && ret != Z_BUF_ERROR) break;
+
+        if (strm->avail_out == 0) {
+            if (cap == ceiling && max_out) {
+                ret = Z_BUF_ERROR;          // past the limit
+                break;
+            }
+            unsigned long used = (unsigned long)(strm->next_out - buf);
+            unsigned long grown = grow_output(cap, used, src_len - strm->avail_in, src_len);
+            if (grown > ceiling) grown = ceiling;
+            unsigned char* next = grown ? (unsigned char*)realloc(buf, grown) : NULL;
+            if (!next) {
+                ret = Z_MEM_ERROR;
+                break;
+            }
+            buf = next;
+            strm->next_out = buf + used;
+            strm->avail_out = grown - cap;
+            cap = grown;
+        } else if (strm->avail_in == 0) {
+            ret = Z_DATA_ERROR;     // truncated input
+            break;
+        }
+    }
+
+    unsigned long total = (unsigned long)(strm->next_out - buf);
+    if (ret == Z_STREAM_END && max_out && total > max_out) ret = Z_BUF_ERROR;
+    if (ret != Z_STREAM_END) {
+        free(buf);
+        return ret;
+    }
+
+    if (total < cap) {
+        unsigned char* fitted = (unsigned char*)realloc(buf, total ? total : 1);
+        if (fitted) buf = fitted;
+    }
+
+    *out = buf;
+    *out_len = total;
+    return Z_OK;
+}
+
+/**
+ * zlib_decompress_limit_alloc() with no limit
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_decompress_dict_alloc(const unsigned char* src, unsigned long src_len,
+                               const unsigned char* dict, unsigned long dict_len,
+                               unsigned long size_hint, unsigned char** out,
+                               unsigned long* out_len) {
+    return zlib_decompress_limit_alloc(src, src_len, dict, dict_len, size_hint, 0, out, out_len);
+}
+
+/**
+ * zlib_decompress_dict_alloc() without a dictionary
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_decompress_alloc(const unsigned char* src, unsigned long src_len,
+                          unsigned long size_hint, unsigned char** out,
+                          unsigned long* out_len) {
+    return zlib_decompress_dict_alloc(src, src_len, NULL, 0, size_hint, out, out_len);
+}
+
+/**
+ * Calculate CRC32 checksum with optional continuation
+ */
+EMSCRIPTEN_KEEPALIVE
+unsigned long zlib_crc32(unsigned long crc, const unsigned char* buf, unsigned int len) {
+    return crc32(crc, buf, len);
+}
+
+/**
+ * Calculate Adler32 checksum with optional continuation
+ */
+EMSCRIPTEN_KEEPALIVE
+unsigned long zlib_adler32(unsigned long adler, const unsigned char* buf, unsigned int len) {
+    return adler32(adler, buf, len);
+}
+
+/**
+ * Get zlib version string
+ */
+EMSCRIPTEN_KEEPALIVE
+const char* zlib_get_version(void) {
+    return zlibVersion();
+}
@@ -0,0 +1,156 @@
+/**
+ * zlib.wasm - Deflate-only core
+ *
+ * Copyright 2025 Superstruct Ltd, New Zealand
+ *
+ * This source code is licensed under the Zlib license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * The compressing counterpart of zlib_core.c, for ZlibDeflate: one-shot
+ * compression, the streaming exports and the checksums, with the same
+ * signatures as in wasm_module.c. Only deflate.c, trees.c, crc32.c,
+ * adler32.c and zutil.c are linked in; streams are plain z_streams
+ * rather than pooled contexts.
+ */
+
+#include <emscripten.h>
+#include <stdlib.h>
+#include "zlib.h"
+#include "deflate.h"
+
+/**
+ * Smallest windowBits and memLevel that cost nothing on a len-byte input,
+ * as deflate_params_for() in wasm_module.c picks them
+ */
+static void deflate_params_for(unsigned long len, int* window_bits, int* mem_level) {
+    int wbits = 9;
+    while (wbits < MAX_WBITS && (1UL << wbits) < len + MIN_LOOKAHEAD) wbits++;
+    *window_bits = wbits;
+    *mem_level = wbits - 6 < 8 ? wbits - 6 : 8;
+}
+
+/**
+ * Compress src into dest as one zlib stream; *dest_len is the space in
+ * dest on entry and the compressed size on return
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_compress_buffer(const unsigned char* src, unsigned long src_len,
+                         unsigned char* dest, unsigned long* dest_len, int level) {
+    int window_bits, mem_level;
+    deflate_params_for(src_len, &window_bits, &mem_level);
+
+    z_stream strm = {0};
+    int ret = deflateInit2(&strm, level, Z_DEFLATED, window_bits, mem_level,
+                           Z_DEFAULT_STRATEGY);
+    if (ret != Z_OK) return ret;
+
+    strm.next_in = (Bytef*)src;
+    strm.avail_in = src_len;
+    strm.next_out = dest;
+    strm.avail_out = *dest_len;
+
+    ret = deflate(&strm, Z_FINISH);
+    *dest_len = strm.total_out;
+    deflateEnd(&strm);
+
+    if (ret == Z_STREAM_END) return Z_OK;
+    return ret == Z_OK ? Z_BUF_ERROR : ret;
+}
+
+/**
+ * Upper bound on the zlib_compress_buffer() output for source_len bytes
+ */
+EMSCRIPTEN_KEEPALIVE
+unsigned long zlib_compress_bound(unsigned long source_len) {
+    return compressBound(source_len);
+}
+
+/**
+ * Initialize compression stream
+ */
+EMSCRIPTEN_KEEPALIVE
+z_stream* zlib_deflate_init(int level, int window_bits, int mem_level, int strategy) {
+    z_stream* strm = (z_stream*)calloc(1, sizeof(z_stream));
+    if (!strm) return NULL;
+
+    if (deflateInit2(strm, level, Z_DEFLATED, window_bits, mem_level, strategy) != Z_OK) {
+        free(strm);
+        return NULL;
+    }
+    return strm;
+}
+
+/**
+ * Process data through compression stream
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_deflate_process(z_stream* strm, const unsigned char* input,
+                         unsigned int input_len, unsigned char* output,
+                         unsigned int output_len, int flush) {
+    if (!strm) return Z_STREAM_ERROR;
+
+    strm->next_in = (Bytef*)input;
+    strm->avail_in = input_len;
+    strm->next_out = output;
+    strm->avail_out = output_len;
+
+    return deflate(strm, flush);
+}
+
+/**
+ * Reset a compression stream to start the next stream
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_deflate_reset(z_stream* strm) {
+    return strm ? deflateReset(strm) : Z_STREAM_ERROR;
+}
+
+/**
+ * Clean up compression stream
+ */
+EMSCRIPTEN_KEEPALIVE
+void zlib_deflate_end(z_stream* strm) {
+    if (!strm) return;
+    deflateEnd(strm);
+    free(strm);
+}
+
+/**
+ * Get available input bytes in stream
+ */
+EMSCRIPTEN_KEEPALIVE
+unsigned int zlib_stream_avail_in(z_stream* strm) {
+    return strm ? strm->avail_in : 0;
+}
+
+/**
+ * Get available output bytes in stream
+ */
+EMSCRIPTEN_KEEPALIVE
+unsigned int zlib_stream_avail_out(z_stream* strm) {
+    return strm ? strm->avail_out : 0;
+}
+
+/**
+ * Calculate CRC32 checksum with optional continuation
+ */
+EMSCRIPTEN_KEEPALIVE
+unsigned long zlib_crc32(unsigned long crc, const unsigned char* buf, unsigned int len) {
+    return crc32(crc, buf, len);
+}
+
+/**
+ * Calculate Adler32 checksum with optional continuation
+ */
+EMSCRIPTEN_KEEPALIVE
+unsigned long zlib_adler32(unsigned long adler, const unsigned char* buf, unsigned int len) {
+    return adler32(adler, buf, len);
+}
+
+/**
+ * Get zlib version string
+ */
+EMSCRIPTEN_KEEPALIVE
+const char* zlib_get_version(void) {
+    return zlibVersion();
+}
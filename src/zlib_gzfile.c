@@ -0,0 +1,112 @@
+/**
+ * zlib.wasm - gzip file I/O through host file handles
+ *
+ * Copyright 2025 Superstruct Ltd, New Zealand
+ *
+ * This source code is licensed under the Zlib license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * gzread() and gzwrite() over storage the host JavaScript owns, such as an
+ * OPFS FileSystemSyncAccessHandle in a worker, through gzopen_io(). A file
+ * is a small integer the host hands in; each read, write, seek and close on
+ * it calls into the host (Module.zlibFiles in src/lib/gzfile.ts), which
+ * moves the bytes straight between the handle and gz's buffers on the heap.
+ * Nothing goes through the emscripten file system, and the file is never
+ * held in memory whole.
+ *
+ * The host calls are synchronous, as sync access handles are. Buffers
+ * default to 1 MB, so each call moves a large block: reading calls the
+ * host once per MB of compressed data, and writing once per MB of output.
+ */
+
+#include <emscripten.h>
+#include <stdint.h>
+#include "zlib.h"
+
+#define GZFILE_BUFFER (1024 * 1024)
+
+// Host I/O, as read(), write(), lseek() and close() would behave. Offsets
+// cross as doubles, exact to 2^53.
+EM_JS(int, zlib_host_file_read, (int file, void* buf, unsigned len), {
+    return Module.zlibFiles.read(file, buf, len);
+});
+
+EM_JS(int, zlib_host_file_write, (int file, const void* buf, unsigned len), {
+    return Module.zlibFiles.write(file, buf, len);
+});
+
+EM_JS(double, zlib_host_file_seek, (int file, double offset, int whence), {
+    return Module.zlibFiles.seek(file, offset, whence);
+});
+
+EM_JS(int, zlib_host_file_close, (int file), {
+    return Module.zlibFiles.close(file);
+});
+
+static int file_read(void* opaque, void* buf, unsigned len) {
+    return zlib_host_file_read((int)(intptr_t)opaque, buf, len);
+}
+
+static int file_write(void* opaque, const void* buf, unsigned len) {
+    return zlib_host_file_write((int)(intptr_t)opaque, buf, len);
+}
+
+static z_off64_t file_seek(void* opaque, z_off64_t offset, int whence) {
+    return (z_off64_t)zlib_host_file_seek((int)(intptr_t)opaque, (double)offset, whence);
+}
+
+static int file_close(void* opaque) {
+    return zlib_host_file_close((int)(intptr_t)opaque);
+}
+
+/**
+ * Open host file `file` with gzopen() mode `mode` ("rb", "wb6", "ab" ...),
+ * with buffer_size-byte buffers (0 for the 1 MB default).
+ * Returns the gzFile, or 0 if mode is invalid or out of memory; the host
+ * file is not closed then.
+ */
+EMSCRIPTEN_KEEPALIVE
+gzFile zlib_gzfile_open(int file, const char* mode, unsigned buffer_size) {
+    gz_io io = { (void*)(intptr_t)file, file_read, file_write, file_seek, file_close };
+    gzFile gz = gzopen_io(&io, mode);
+    if (gz) gzbuffer(gz, buffer_size ? buffer_size : GZFILE_BUFFER);
+    return gz;
+}
+
+/**
+ * Read up to len uncompressed bytes into buf.
+ * Returns the number read, 0 at the end of the file, or -1 on an error.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_gzfile_read(gzFile gz, void* buf, unsigned len) {
+    return gzread(gz, buf, len);
+}
+
+/**
+ * Compress len bytes from buf into the file.
+ * Returns len, or 0 on an error.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_gzfile_write(gzFile gz, const void* buf, unsigned len) {
+    return gzwrite(gz, buf, len);
+}
+
+/**
+ * The zlib error code behind a failed read or write (Z_ERRNO for the host's
+ * I/O), or Z_OK
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_gzfile_error(gzFile gz) {
+    int err = Z_OK;
+    gzerror(gz, &err);
+    return err;
+}
+
+/**
+ * Flush, free the gzFile and close the host file.
+ * Returns Z_OK, or an error code as gzclose() does.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_gzfile_close(gzFile gz) {
+    return gzclose(gz);
+}
@@ -0,0 +1,393 @@
+/**
+ * zlib.wasm - Join gzip members without recompressing
+ *
+ * Copyright (C) 2004, 2005, 2012 Mark Adler
+ * Copyright 2025 Superstruct Ltd, New Zealand
+ *
+ * This source code is licensed under the Zlib license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Library form of examples/gzjoin.c. The result is one gzip member that
+ * inflates to the concatenation of every input member. Each member's
+ * deflate data is copied through unchanged, except that the last-block bit
+ * of its final block is cleared and empty blocks bring it to a byte
+ * boundary; one empty final block then ends the joined stream. The
+ * trailer's CRC-32 comes from the members' own CRCs via crc32_combine(), so
+ * no data is deflated or checksummed. Inflating is still needed, only to
+ * find where each final block starts, and its output is thrown away.
+ *
+ * Differences from the example:
+ *
+ *   - No FILE I/O. The members are read from one buffer, back to back as
+ *     appended logs and concatenated .gz files hold them, and the output
+ *     goes to one buffer of zlib_gzjoin_bound() bytes.
+ *   - Each member's ISIZE is checked against its inflated length, and the
+ *     CRC-32 shift handles members of 4 GB or more.
+ *
+ * zlib_gzip_members() walks the same run of members only to find where
+ * each one ends, for listings and for sizing buffers. A BGZF member says
+ * its own length in its header; any other is run through inflateBack(),
+ * which decodes into its window and hands the output to a callback that
+ * drops it, so nothing is copied out.
+ */
+
+#include <emscripten.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "zlib.h"
+
+#define GZJOIN_JUNK (256 * 1024)    // discarded inflate output per call
+#define GZJOIN_WINDOW (1U << 15)
+#define GZJOIN_MIN_MEMBER 20        // header, empty final block and trailer
+#define GZJOIN_HEADER 10
+#define GZJOIN_TRAILER 8
+
+// gzip header flags
+#define GZ_FHCRC 0x02
+#define GZ_FEXTRA 0x04
+#define GZ_FNAME 0x08
+#define GZ_FCOMMENT 0x10
+
+/*
+ * Length of the gzip header at src[0..len-1], or 0 if there is none
+ */
+static size_t header_length(const unsigned char* src, size_t len) {
+    if (len < GZJOIN_HEADER || src[0] != 0x1f || src[1] != 0x8b || src[2] != 8 ||
+        (src[3] & 0xe0) != 0) {
+        return 0;
+    }
+
+    int flags = src[3];
+    size_t pos = GZJOIN_HEADER;
+    if (flags & GZ_FEXTRA) {
+        if (len - pos < 2) return 0;
+        pos += 2 + (src[pos] | ((size_t)src[pos + 1] << 8));
+        if (pos > len) return 0;
+    }
+    if (flags & GZ_FNAME) {
+        const unsigned char* end = memchr(src + pos, 0, len - pos);
+        if (!end) return 0;
+        pos = (size_t)(end - src) + 1;
+    }
+    if (flags & GZ_FCOMMENT) {
+        const unsigned char* end = memchr(src + pos, 0, len - pos);
+        if (!end) return 0;
+        pos = (size_t)(end - src) + 1;
+    }
+    if (flags & GZ_FHCRC) {
+        pos += 2;
+        if (pos > len) return 0;
+    }
+    return pos;
+}
+
+static unsigned long get4(const unsigned char* p) {
+    return p[0] | ((unsigned long)p[1] << 8) | ((unsigned long)p[2] << 16) |
+           ((unsigned long)p[3] << 24);
+}
+
+/*
+ * Length of the BGZF member whose header is src[0..head-1], from the BSIZE
+ * of its BC extra subfield, or 0 if the header has none
+ */
+static size_t bgzf_length(const unsigned char* src, size_t head) {
+    if (!(src[3] & GZ_FEXTRA)) return 0;
+    size_t end = GZJOIN_HEADER + 2 + (src[GZJOIN_HEADER] | ((size_t)src[GZJOIN_HEADER + 1] << 8));
+    for (size_t p = GZJOIN_HEADER + 2; p + 4 <= end && end <= head;
+         p += 4 + (src[p + 2] | ((size_t)src[p + 3] << 8))) {
+        if (src[p] == 'B' && src[p + 1] == 'C' && src[p + 2] == 2 && src[p + 3] == 0 && p + 6 <= end) {
+            return (size_t)(src[p + 4] | ((size_t)src[p + 5] << 8)) + 1;
+        }
+    }
+    return 0;
+}
+
+static void put4(unsigned char* p, unsigned long value) {
+    p[0] = (unsigned char)value;
+    p[1] = (unsigned char)(value >> 8);
+    p[2] = (unsigned char)(value >> 16);
+    p[3] = (unsigned char)(value >> 24);
+}
+
+// crc32_combine() for any len2; z_off_t is only 32 bits here
+static unsigned long combine(unsigned long crc1, unsigned long crc2, uint64_t len2) {
+    while (len2 > 0x40000000) {
+        crc1 = crc32_combine(crc1, 0, (z_off_t)0x40000000);
+        len2 -= 0x40000000;
+    }
+    return crc32_combine(crc1, crc2, (z_off_t)len2);
+}
+
+/*
+ * Append the member at src[0..len-1] to out, ending on a byte boundary
+ * with no final block, and fold its CRC-32 and length into *crc and
+ * *total. *used receives the member's length in src.
+ * Returns Z_OK, Z_DATA_ERROR for a bad or truncated member, or Z_BUF_ERROR
+ * if out_left is too small.
+ */
+static int join_member(z_stream* strm, unsigned char* junk,
+                       const unsigned char* src, size_t len,
+                       unsigned char* out, size_t out_left, size_t* written,
+                       size_t* used, unsigned long* crc, uint64_t* total) {
+    size_t head = header_length(src, len);
+    if (head == 0) return Z_DATA_ERROR;
+
+    const unsigned char* start = src + head;
+    size_t avail = len - head;
+    if (avail > UINT32_MAX) return Z_DATA_ERROR;
+
+    inflateReset(strm);
+    strm->next_in = (z_const Bytef*)start;
+    strm->avail_in = (uInt)avail;
+
+    // Where the current block's header bit is: the first block's is bit 0
+    size_t bit_byte = 0;
+    unsigned bit_mask = 1;
+    uint64_t length = 0;
+    for (;;) {
+        strm->next_out = junk;
+        strm->avail_out = GZJOIN_JUNK;
+        int ret = inflate(strm, Z_BLOCK);
+        length += GZJOIN_JUNK - strm->avail_out;
+        if (ret == Z_BUF_ERROR || ret == Z_NEED_DICT) return Z_DATA_ERROR;
+        if (ret != Z_OK && ret != Z_STREAM_END) return ret;
+
+        // Stopped just after a block's end-of-block code
+        if (strm->data_type & 128) {
+            if (strm->data_type & 64) break;        // that was the last block
+
+            int pos = strm->data_type & 7;           // unused bits in the last byte
+            if (pos != 0) {
+                bit_byte = (size_t)(strm->next_in - start) - 1;
+                bit_mask = 0x100 >> pos;
+            } else {
+                bit_byte = (size_t)(strm->next_in - start);
+                bit_mask = 1;
+            }
+        }
+    }
+
+    size_t n = (size_t)(strm->next_in - start);
+    if (len - head - n < GZJOIN_TRAILER) return Z_DATA_ERROR;
+    const unsigned char* trailer = strm->next_in;
+    if (get4(trailer + 4) != (unsigned long)(length & 0xffffffff)) return Z_DATA_ERROR;
+
+    // At most five bytes are added to the last one
+    if (out_left < n + 5) return Z_BUF_ERROR;
+    memcpy(out, start, n - 1);
+    unsigned last = start[n - 1];
+    if (bit_byte == n - 1) last &= ~bit_mask;
+    else out[bit_byte] &= (unsigned char)~bit_mask;
+
+    // Empty blocks up to a byte boundary, as gzjoin.c adds them
+    size_t k = n - 1;
+    int pos = strm->data_type & 7;
+    if (pos == 0) {
+        out[k++] = (unsigned char)last;
+    } else {
+        last &= (0x100 >> pos) - 1;                 // unused bits must be zero
+        if (pos & 1) {
+            // Odd: an empty stored block
+            out[k++] = (unsigned char)last;
+            if (pos == 1) out[k++] = 0;              // two more bits of its header
+            memcpy(out + k, "\0\0\xff\xff", 4);
+            k += 4;
+        } else {
+            // Even: one, two or three empty fixed blocks
+            switch (pos) {
+            case 6:
+                out[k++] = (unsigned char)(last | 8);
+                last = 0;
+                /* fallthrough */
+            case 4:
+                out[k++] = (unsigned char)(last | 0x20);
+                last = 0;
+                /* fallthrough */
+            case 2:
+                out[k++] = (unsigned char)(last | 0x80);
+                out[k++] = 0;
+            }
+        }
+    }
+
+    *crc = combine(*crc, get4(trailer), length);
+    *total += length;
+    *written = k;
+    *used = head + n + GZJOIN_TRAILER;
+    return Z_OK;
+}
+
+/**
+ * Largest output zlib_gzjoin() can produce from src_len bytes of members
+ */
+EMSCRIPTEN_KEEPALIVE
+unsigned long zlib_gzjoin_bound(unsigned long src_len) {
+    // Every member loses at least 18 bytes of header and trailer and gains
+    // at most 5; the output adds one header, final block and trailer
+    return src_len + GZJOIN_HEADER + 2 + GZJOIN_TRAILER;
+}
+
+/**
+ * Join the gzip members back to back in src[0..src_len-1] into one member
+ * in dest, without recompressing. Concatenated .gz files are such a run of
+ * members, so joining many files is one call over their concatenation.
+ * *dest_len holds dest's size on entry, at least zlib_gzjoin_bound(), and
+ * the output's length on return.
+ * Returns Z_OK, Z_DATA_ERROR if src is not complete gzip members,
+ * Z_BUF_ERROR if dest is too small, or Z_MEM_ERROR.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_gzjoin(const unsigned char* src, unsigned long src_len,
+                unsigned char* dest, unsigned long* dest_len) {
+    if ((!src && src_len) || !dest || !dest_len) return Z_STREAM_ERROR;
+
+    size_t cap = *dest_len;
+    if (cap < GZJOIN_HEADER + 2 + GZJOIN_TRAILER) return Z_BUF_ERROR;
+
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+    unsigned char* junk = (unsigned char*)malloc(GZJOIN_JUNK);
+    if (!junk || inflateInit2(&strm, -MAX_WBITS) != Z_OK) {
+        free(junk);
+        return Z_MEM_ERROR;
+    }
+
+    // Minimal header: no name or time, unknown OS
+    memcpy(dest, "\x1f\x8b\x08\0\0\0\0\0\0\xff", GZJOIN_HEADER);
+    size_t have = GZJOIN_HEADER;
+    unsigned long crc = crc32(0L, Z_NULL, 0);
+    uint64_t total = 0;
+
+    int ret = Z_OK;
+    size_t left = src_len;
+    while (ret == Z_OK && left > 0) {
+        size_t written = 0;
+        size_t used = 0;
+        // Room is kept for the final block and trailer
+        ret = join_member(&strm, junk, src, left, dest + have,
+                          cap - have - 2 - GZJOIN_TRAILER, &written, &used,
+                          &crc, &total);
+        have += written;
+        src += used;
+        left -= used;
+    }
+    inflateEnd(&strm);
+    free(junk);
+    if (ret != Z_OK) return ret;
+
+    // An empty final fixed block ends the stream, then the trailer
+    dest[have++] = 3;
+    dest[have++] = 0;
+    put4(dest + have, crc);
+    put4(dest + have + 4, (unsigned long)(total & 0xffffffff));
+    *dest_len = (unsigned long)(have + GZJOIN_TRAILER);
+    return Z_OK;
+}
+
+typedef struct {
+    const unsigned char* next;
+    size_t have;
+    uint64_t length;
+} walk_t;
+
+// The whole member at once; anything past 4 GB comes in further calls
+static unsigned walk_in(void* desc, z_const unsigned char** buf) {
+    walk_t* w = (walk_t*)desc;
+    unsigned n = w->have > UINT32_MAX ? UINT32_MAX : (unsigned)w->have;
+    *buf = (z_const unsigned char*)w->next;
+    w->next += n;
+    w->have -= n;
+    return n;
+}
+
+static int walk_out(void* desc, unsigned char* buf, unsigned len) {
+    (void)buf;
+    ((walk_t*)desc)->length += len;
+    return 0;
+}
+
+/*
+ * Length of the member at src[0..len-1] with a head-byte header, found by
+ * inflating its deflate data to nowhere. Returns 0 for a bad or truncated
+ * member, or one whose ISIZE is not its inflated length.
+ */
+static size_t walk_member(z_stream* strm, const unsigned char* src, size_t len, size_t head) {
+    walk_t w = { src + head, len - head, 0 };
+    strm->next_in = Z_NULL;
+    strm->avail_in = 0;
+    if (inflateBack(strm, walk_in, &w, walk_out, &w) != Z_STREAM_END) return 0;
+
+    // Input inflateBack() read ahead of the end of the deflate data
+    size_t n = (size_t)(w.next - src) - strm->avail_in;
+    if (len - n < GZJOIN_TRAILER) return 0;
+    if (get4(src + n + 4) != (unsigned long)(w.length & 0xffffffff)) return 0;
+    return n + GZJOIN_TRAILER;
+}
+
+/**
+ * Find where each gzip member of src[0..src_len-1] ends, without any
+ * output. ends receives the end offset of each member, up to max_ends of
+ * them (src_len / 20 + 1 is enough for any src); *count receives how many
+ * members there are. Each member's header, CRC-32 and ISIZE are then read
+ * from src by the caller.
+ * Returns Z_OK, Z_DATA_ERROR at a bad or truncated member (*count members
+ * before it are good), Z_BUF_ERROR if max_ends is too small, or Z_MEM_ERROR.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_gzip_members(const unsigned char* src, unsigned long src_len,
+                      unsigned long* ends, unsigned long max_ends, unsigned long* count) {
+    if ((!src && src_len) || (!ends && max_ends) || !count) return Z_STREAM_ERROR;
+    *count = 0;
+
+    // Only allocated once a member needs inflating
+    unsigned char* window = NULL;
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+
+    int ret = Z_OK;
+    size_t pos = 0;
+    while (pos < src_len) {
+        size_t left = src_len - pos;
+        size_t head = header_length(src + pos, left);
+        if (head == 0) {
+            ret = Z_DATA_ERROR;
+            break;
+        }
+
+        size_t size = bgzf_length(src + pos, head);
+        if (size != 0 && (size < head + 2 + GZJOIN_TRAILER || size > left)) {
+            ret = Z_DATA_ERROR;
+            break;
+        }
+        if (size == 0) {
+            if (!window) {
+                window = (unsigned char*)malloc(GZJOIN_WINDOW);
+                if (!window || inflateBackInit(&strm, 15, window) != Z_OK) {
+                    free(window);
+                    window = NULL;
+                    ret = Z_MEM_ERROR;
+                    break;
+                }
+            }
+            size = walk_member(&strm, src + pos, left, head);
+            if (size == 0) {
+                ret = Z_DATA_ERROR;
+                break;
+            }
+        }
+
+        if (*count >= max_ends) {
+            ret = Z_BUF_ERROR;
+            break;
+        }
+        pos += size;
+        ends[(*count)++] = (unsigned long)pos;
+    }
+
+    if (window) {
+        inflateBackEnd(&strm);
+        free(window);
+    }
+    return ret;
+}
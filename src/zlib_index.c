@@ -0,0 +1,644 @@
+/**
+ * zlib.wasm - Random access into zlib, gzip and raw deflate streams
+ *
+ * Copyright (C) 2005, 2012, 2018, 2023, 2024 Mark Adler
+ * Copyright 2025 Superstruct Ltd, New Zealand
+ *
+ * This source code is licensed under the Zlib license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Library form of examples/zran.c. The index is built in one pass over the
+ * compressed stream and records an access point at a deflate block boundary
+ * about every span uncompressed bytes, each with the 32 KB of history that
+ * precedes it. Extraction starts from the nearest point at or before the
+ * requested offset, so at most span bytes are inflated and thrown away.
+ *
+ * Differences from the example:
+ *
+ *   - No FILE I/O. Compressed input is pushed in chunks, both when building
+ *     (zlib_index_feed) and when extracting (zlib_index_extract_begin tells
+ *     the caller where to read from, zlib_index_extract_next consumes it),
+ *     so archives far larger than the WASM heap can be indexed and served.
+ *   - Each point's window is kept raw-deflated, which is also the on-disk
+ *     form, and the byte holding a point's leading bits is stored with the
+ *     point so no extra read is needed to prime inflate.
+ *   - Offsets cross the JS boundary as doubles, exact to 2^53 bytes.
+ *
+ * Serialized layout, little-endian:
+ *
+ *   "ZIDX" | u32 version | i32 mode | u64 length | u32 points
+ *   points x (u64 out | u64 in | u32 dict | u32 size | u8 bits | u8 prime)
+ *   the compressed windows, in point order
+ */
+
+#include <emscripten.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "zlib.h"
+
+#define INDEX_WINSIZE 32768U
+#define INDEX_DEFAULT_SPAN (1024 * 1024)
+#define INDEX_VERSION 1
+#define INDEX_HEADER_SIZE 24
+#define INDEX_POINT_SIZE 26
+
+// inflateInit2() windowBits for each stream type
+#define INDEX_RAW -15
+#define INDEX_ZLIB 15
+#define INDEX_GZIP 31
+
+typedef struct {
+    uint64_t out;           // offset in uncompressed data
+    uint64_t in;            // offset in compressed data of first full byte
+    uint32_t dict;          // window bytes used as a dictionary
+    uint32_t size;          // raw-deflated window bytes
+    size_t window;          // window offset in index->windows
+    uint8_t bits;           // 0, or bits (1-7) taken from the byte at in - 1
+    uint8_t prime;          // that byte
+} zlib_index_point_t;
+
+typedef struct {
+    int mode;               // INDEX_RAW, INDEX_ZLIB or INDEX_GZIP; 0 until known
+    uint64_t length;        // total uncompressed length once built
+    zlib_index_point_t* list;
+    uint32_t have;
+    uint32_t cap;
+    unsigned char* windows; // compressed windows, back to back
+    size_t windows_len;
+    size_t windows_cap;
+
+    z_stream strm;          // inflate engine, for building and extracting
+    int strm_ready;
+    unsigned char* win;     // sliding window while building, scratch after
+
+    // Build state
+    z_stream pack;          // raw deflate for point windows
+    int pack_ready;
+    int built;
+    int member_end;         // gzip member ended; reset on more input
+    int status;
+    uint64_t span;
+    uint64_t totin;
+    uint64_t totout;
+    uint64_t beg;           // uncompressed offset of the last history reset
+    uint64_t last;          // uncompressed offset of the last access point
+    unsigned char last_byte;
+
+    // Extraction cursor
+    uint64_t skip;          // bytes to inflate and discard before output
+    unsigned long left;     // bytes still wanted
+    unsigned long got;
+    unsigned trailer;       // gzip trailer bytes still to skip
+    int header;             // inflating a gzip member header
+    int extracting;
+} zlib_index_t;
+
+static void put32(unsigned char* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (unsigned char)(v >> (8 * i));
+}
+
+static void put64(unsigned char* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = (unsigned char)(v >> (8 * i));
+}
+
+static uint32_t get32(const unsigned char* p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+static uint64_t get64(const unsigned char* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+static zlib_index_t* index_alloc(void) {
+    zlib_index_t* index = (zlib_index_t*)calloc(1, sizeof(zlib_index_t));
+    if (!index) return NULL;
+
+    index->win = (unsigned char*)malloc(INDEX_WINSIZE);
+    if (!index->win) {
+        free(index);
+        return NULL;
+    }
+    return index;
+}
+
+/**
+ * Free an index from zlib_index_create() or zlib_index_load()
+ */
+EMSCRIPTEN_KEEPALIVE
+void zlib_index_free(zlib_index_t* index) {
+    if (!index) return;
+    if (index->strm_ready) inflateEnd(&index->strm);
+    if (index->pack_ready) deflateEnd(&index->pack);
+    free(index->list);
+    free(index->windows);
+    free(index->win);
+    free(index);
+}
+
+// Record an access point at the current position; window is the sliding
+// output buffer, as in zran's add_point()
+static int add_point(zlib_index_t* index, uint64_t in, const unsigned char* window) {
+    if (index->have == index->cap) {
+        uint32_t cap = index->cap ? index->cap << 1 : 8;
+        zlib_index_point_t* list = (zlib_index_point_t*)realloc(index->list, sizeof(zlib_index_point_t) * cap);
+        if (!list) return Z_MEM_ERROR;
+        index->list = list;
+        index->cap = cap;
+    }
+
+    zlib_index_point_t* point = &index->list[index->have];
+    point->out = index->totout;
+    point->in = in;
+    point->bits = (uint8_t)(index->strm.data_type & 7);
+    point->prime = point->bits ? index->last_byte : 0;
+    point->dict = index->totout - index->beg > INDEX_WINSIZE ?
+                  INDEX_WINSIZE : (uint32_t)(index->totout - index->beg);
+
+    // Unroll the circular window into the scratch half before packing it
+    unsigned char* dict = index->win + INDEX_WINSIZE;
+    unsigned recent = INDEX_WINSIZE - index->strm.avail_out;
+    unsigned copy = recent > point->dict ? point->dict : recent;
+    memcpy(dict + point->dict - copy, window + recent - copy, copy);
+    copy = point->dict - copy;
+    memcpy(dict, window + INDEX_WINSIZE - copy, copy);
+
+    size_t bound = deflateBound(&index->pack, point->dict);
+    if (index->windows_cap - index->windows_len < bound) {
+        size_t cap = index->windows_cap ? index->windows_cap : 64 * 1024;
+        while (cap - index->windows_len < bound) cap <<= 1;
+        unsigned char* windows = (unsigned char*)realloc(index->windows, cap);
+        if (!windows) return Z_MEM_ERROR;
+        index->windows = windows;
+        index->windows_cap = cap;
+    }
+
+    deflateReset(&index->pack);
+    index->pack.next_in = dict;
+    index->pack.avail_in = point->dict;
+    index->pack.next_out = index->windows + index->windows_len;
+    index->pack.avail_out = (uInt)bound;
+    if (deflate(&index->pack, Z_FINISH) != Z_STREAM_END) return Z_STREAM_ERROR;
+
+    point->window = index->windows_len;
+    point->size = (uint32_t)index->pack.total_out;
+    index->windows_len += point->size;
+    index->have++;
+    index->last = index->totout;
+    return Z_OK;
+}
+
+/**
+ * Start building an index with an access point about every span
+ * uncompressed bytes (0 for 1 MB). Push the compressed stream through
+ * zlib_index_feed(), then call zlib_index_finish(). Returns NULL on failure.
+ */
+EMSCRIPTEN_KEEPALIVE
+zlib_index_t* zlib_index_create(double span) {
+    zlib_index_t* index = index_alloc();
+    if (!index) return NULL;
+
+    // The second half of win holds the unrolled window of a new point
+    unsigned char* win = (unsigned char*)realloc(index->win, 2 * INDEX_WINSIZE);
+    if (!win) {
+        zlib_index_free(index);
+        return NULL;
+    }
+    index->win = win;
+
+    if (deflateInit2(&index->pack, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        zlib_index_free(index);
+        return NULL;
+    }
+    index->pack_ready = 1;
+    index->span = span >= 1 ? (uint64_t)span : INDEX_DEFAULT_SPAN;
+    index->status = Z_OK;
+    return index;
+}
+
+// Inflate whatever input is set on the engine a block at a time, adding
+// access points along the way, until it needs more input
+static int index_run(zlib_index_t* index) {
+    z_stream* strm = &index->strm;
+    const Bytef* start = strm->next_in;
+    int ret = Z_OK;
+
+    for (;;) {
+        if (index->member_end) {
+            // More input after a gzip member: read the next one
+            if (strm->avail_in == 0) break;
+            ret = inflateReset2(strm, INDEX_GZIP);
+            if (ret != Z_OK) break;
+            index->beg = index->totout;
+            index->member_end = 0;
+        }
+
+        if (strm->avail_out == 0) {
+            strm->avail_out = INDEX_WINSIZE;
+            strm->next_out = index->win;
+        }
+
+        int stalled = 0;
+        if (index->mode == INDEX_RAW && index->have == 0) {
+            // Point at the very start of raw data, imitating an ended header
+            strm->data_type = 0x80;
+        } else {
+            // Z_BLOCK stops at every block boundary, even with input left
+            // over or bits still buffered, so only a call that leaves
+            // data_type unchanged without progress means more input is needed
+            int data_type = strm->data_type;
+            unsigned before = strm->avail_out;
+            ret = inflate(strm, Z_BLOCK);
+            index->totout += before - strm->avail_out;
+            if (strm->next_in > start) index->last_byte = strm->next_in[-1];
+            if (ret == Z_BUF_ERROR) {
+                stalled = strm->data_type == data_type;
+                ret = Z_OK;
+            }
+        }
+
+        if (!stalled && (strm->data_type & 0xc0) == 0x80 &&
+            (index->have == 0 || index->totout - index->last >= index->span)) {
+            ret = add_point(index, index->totin - strm->avail_in, index->win);
+            if (ret != Z_OK) break;
+        }
+
+        if (ret == Z_STREAM_END) {
+            if (index->mode != INDEX_GZIP) break;
+            index->member_end = 1;
+            ret = Z_OK;
+        } else if (ret != Z_OK) {
+            if (ret == Z_NEED_DICT) ret = Z_DATA_ERROR;
+            break;
+        } else if (stalled) {
+            break;
+        }
+    }
+
+    index->status = ret;
+    return ret;
+}
+
+/**
+ * Push the next chunk of the compressed stream into an index being built
+ * Returns Z_OK for more input, Z_STREAM_END once a zlib or raw stream has
+ * ended (the rest is ignored), or a negative error code, which sticks.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_index_feed(zlib_index_t* index, const unsigned char* src, unsigned long src_len) {
+    if (!index || index->built || !index->pack_ready || (!src && src_len)) {
+        return Z_STREAM_ERROR;
+    }
+    if (index->status != Z_OK || src_len == 0) return index->status;
+
+    if (index->mode == 0) {
+        // Assume raw if neither zlib nor gzip, as zran does
+        index->mode = (src[0] & 0xf) == 8 ? INDEX_ZLIB :
+                      src[0] == 0x1f ? INDEX_GZIP : INDEX_RAW;
+        if (inflateInit2(&index->strm, index->mode) != Z_OK) return index->status = Z_MEM_ERROR;
+        index->strm_ready = 1;
+    }
+
+    index->strm.next_in = (Bytef*)src;
+    index->strm.avail_in = src_len;
+    index->totin += src_len;
+    int ret = index_run(index);
+    index->strm.next_in = Z_NULL;
+    return ret;
+}
+
+/**
+ * Complete an index once all input has been fed
+ * Returns the number of access points (>= 1), Z_BUF_ERROR if the stream
+ * ended early, or the error zlib_index_feed() reported.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_index_finish(zlib_index_t* index) {
+    if (!index || !index->pack_ready) return Z_STREAM_ERROR;
+
+    // The end of the stream may still be waiting on bits inflate holds
+    int ret = index->status;
+    if (ret == Z_OK && index->strm_ready && !index->member_end) ret = index_run(index);
+    if (ret == Z_OK) ret = index->member_end ? Z_STREAM_END : Z_BUF_ERROR;
+    if (ret != Z_STREAM_END) return ret;
+
+    deflateEnd(&index->pack);
+    index->pack_ready = 0;
+    index->built = 1;
+    index->length = index->totout;
+    return (int)index->have;
+}
+
+/**
+ * Number of access points in an index
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_index_points(const zlib_index_t* index) {
+    return index ? (int)index->have : 0;
+}
+
+/**
+ * Total uncompressed length covered by an index
+ */
+EMSCRIPTEN_KEEPALIVE
+double zlib_index_length(const zlib_index_t* index) {
+    return index ? (double)index->length : 0;
+}
+
+// Serialize points [first, first + count). A segment is written as an index
+// of its own, with offsets relative to its first point.
+static int serialize_points(const zlib_index_t* index, uint32_t first, uint32_t count,
+                            int segment, unsigned char** out, unsigned long* out_len) {
+    uint64_t base_out = index->list[first].out;
+    uint64_t base_in = segment ? index->list[first].in : 0;
+    uint64_t end = first + count < index->have ? index->list[first + count].out : index->length;
+    size_t windows_len = 0;
+    for (uint32_t i = first; i < first + count; i++) windows_len += index->list[i].size;
+
+    size_t len = INDEX_HEADER_SIZE + (size_t)count * INDEX_POINT_SIZE + windows_len;
+    unsigned char* buf = (unsigned char*)malloc(len);
+    if (!buf) return Z_MEM_ERROR;
+
+    memcpy(buf, "ZIDX", 4);
+    put32(buf + 4, INDEX_VERSION);
+    put32(buf + 8, (uint32_t)index->mode);
+    put64(buf + 12, end - base_out);
+    put32(buf + 20, count);
+
+    unsigned char* p = buf + INDEX_HEADER_SIZE;
+    unsigned char* windows = buf + INDEX_HEADER_SIZE + (size_t)count * INDEX_POINT_SIZE;
+    for (uint32_t i = first; i < first + count; i++, p += INDEX_POINT_SIZE) {
+        const zlib_index_point_t* point = &index->list[i];
+        put64(p, point->out - base_out);
+        put64(p + 8, point->in - base_in);
+        put32(p + 16, point->dict);
+        put32(p + 20, point->size);
+        p[24] = point->bits;
+        p[25] = point->prime;
+        memcpy(windows, index->windows + point->window, point->size);
+        windows += point->size;
+    }
+
+    *out = buf;
+    *out_len = len;
+    return Z_OK;
+}
+
+/**
+ * Serialize a built index into a malloc'd buffer (free with free())
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_index_serialize(const zlib_index_t* index, unsigned char** out,
+                         unsigned long* out_len) {
+    if (!index || !index->built || !out || !out_len) return Z_STREAM_ERROR;
+    return serialize_points(index, 0, index->have, 0, out, out_len);
+}
+
+/**
+ * Serialize the segment from access point first up to point first + count
+ * (or the end) as a standalone index, for inflating that segment elsewhere.
+ * Its offsets are relative to point first: uncompressed offset 0 is
+ * zlib_index_point_out(first), and compressed position 0 is
+ * zlib_index_point_in(first).
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_index_serialize_segment(const zlib_index_t* index, uint32_t first, uint32_t count,
+                                 unsigned char** out, unsigned long* out_len) {
+    if (!index || !index->built || !out || !out_len || count == 0 ||
+        first >= index->have || count > index->have - first) {
+        return Z_STREAM_ERROR;
+    }
+    return serialize_points(index, first, count, 1, out, out_len);
+}
+
+/**
+ * Uncompressed offset of access point i
+ */
+EMSCRIPTEN_KEEPALIVE
+double zlib_index_point_out(const zlib_index_t* index, uint32_t i) {
+    return index && i < index->have ? (double)index->list[i].out : -1;
+}
+
+/**
+ * Compressed offset of the first full byte of access point i
+ */
+EMSCRIPTEN_KEEPALIVE
+double zlib_index_point_in(const zlib_index_t* index, uint32_t i) {
+    return index && i < index->have ? (double)index->list[i].in : -1;
+}
+
+/**
+ * Load an index written by zlib_index_serialize()
+ * Returns NULL if the data is malformed or memory runs out.
+ */
+EMSCRIPTEN_KEEPALIVE
+zlib_index_t* zlib_index_load(const unsigned char* src, unsigned long src_len) {
+    if (!src || src_len < INDEX_HEADER_SIZE || memcmp(src, "ZIDX", 4) != 0 ||
+        get32(src + 4) != INDEX_VERSION) {
+        return NULL;
+    }
+
+    int mode = (int32_t)get32(src + 8);
+    uint32_t have = get32(src + 20);
+    if ((mode != INDEX_RAW && mode != INDEX_ZLIB && mode != INDEX_GZIP) || have == 0 ||
+        (src_len - INDEX_HEADER_SIZE) / INDEX_POINT_SIZE < have) {
+        return NULL;
+    }
+
+    zlib_index_t* index = index_alloc();
+    if (!index) return NULL;
+
+    index->mode = mode;
+    index->length = get64(src + 12);
+    index->list = (zlib_index_point_t*)malloc(sizeof(zlib_index_point_t) * have);
+    if (!index->list) {
+        zlib_index_free(index);
+        return NULL;
+    }
+
+    const unsigned char* p = src + INDEX_HEADER_SIZE;
+    size_t windows_len = 0;
+    size_t available = src_len - INDEX_HEADER_SIZE - (size_t)have * INDEX_POINT_SIZE;
+    for (uint32_t i = 0; i < have; i++, p += INDEX_POINT_SIZE) {
+        zlib_index_point_t* point = &index->list[i];
+        point->out = get64(p);
+        point->in = get64(p + 8);
+        point->dict = get32(p + 16);
+        point->size = get32(p + 20);
+        point->bits = p[24];
+        point->prime = p[25];
+        point->window = windows_len;
+
+        int ordered = i == 0 ? point->out == 0 : point->out >= index->list[i - 1].out;
+        if (!ordered || point->dict > INDEX_WINSIZE || point->bits > 7 ||
+            point->size > available - windows_len) {
+            index->have = i;
+            zlib_index_free(index);
+            return NULL;
+        }
+        windows_len += point->size;
+    }
+    index->have = index->cap = have;
+
+    index->windows = (unsigned char*)malloc(windows_len ? windows_len : 1);
+    if (!index->windows || inflateInit2(&index->strm, INDEX_RAW) != Z_OK) {
+        zlib_index_free(index);
+        return NULL;
+    }
+    index->strm_ready = 1;
+    memcpy(index->windows, p, windows_len);
+    index->windows_len = index->windows_cap = windows_len;
+    index->built = 1;
+    return index;
+}
+
+/**
+ * Position the index to read len bytes from uncompressed offset
+ * Returns the compressed offset to start feeding zlib_index_extract_next()
+ * from, or a negative error code.
+ */
+EMSCRIPTEN_KEEPALIVE
+double zlib_index_extract_begin(zlib_index_t* index, double offset, unsigned long len) {
+    if (!index || !index->built || index->have < 1 || !index->strm_ready || offset < 0) {
+        return Z_STREAM_ERROR;
+    }
+
+    uint64_t target = (uint64_t)offset;
+    if (target >= index->length) target = index->length;
+    if (len > index->length - target) len = (unsigned long)(index->length - target);
+
+    // Latest access point at or before the offset
+    uint32_t lo = 0, hi = index->have;
+    while (hi - lo > 1) {
+        uint32_t mid = (lo + hi) >> 1;
+        if (target < index->list[mid].out) hi = mid;
+        else lo = mid;
+    }
+    const zlib_index_point_t* point = &index->list[lo];
+
+    // Unpack the point's window, then restart raw inflate from it
+    z_stream* strm = &index->strm;
+    int ret = inflateReset2(strm, INDEX_RAW);
+    if (ret == Z_OK && point->dict) {
+        strm->next_in = index->windows + point->window;
+        strm->avail_in = point->size;
+        strm->next_out = index->win;
+        strm->avail_out = INDEX_WINSIZE;
+        ret = inflate(strm, Z_FINISH);
+        ret = ret == Z_STREAM_END && strm->total_out == point->dict ? inflateReset2(strm, INDEX_RAW) : Z_DATA_ERROR;
+    }
+    if (ret == Z_OK && point->bits) {
+        ret = inflatePrime(strm, point->bits, point->prime >> (8 - point->bits));
+    }
+    if (ret == Z_OK && point->dict) {
+        ret = inflateSetDictionary(strm, index->win, point->dict);
+    }
+    if (ret != Z_OK) {
+        index->extracting = 0;
+        return ret;
+    }
+
+    strm->avail_in = 0;
+    index->skip = target - point->out;
+    index->left = len;
+    index->got = 0;
+    index->trailer = 0;
+    index->header = 0;
+    index->extracting = 1;
+    return (double)point->in;
+}
+
+/**
+ * Push compressed input for the extraction set up by
+ * zlib_index_extract_begin(), writing into dest (sized for the requested
+ * length). *got is the total written so far. Returns Z_OK for more input,
+ * Z_STREAM_END once the request is satisfied or the data has ended, or a
+ * negative error code.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_index_extract_next(zlib_index_t* index, const unsigned char* src, unsigned long src_len,
+                            unsigned char* dest, unsigned long* got) {
+    if (!index || !index->extracting || (!src && src_len) || (!dest && index->left) || !got) {
+        return Z_STREAM_ERROR;
+    }
+
+    z_stream* strm = &index->strm;
+    strm->next_in = (Bytef*)src;
+    strm->avail_in = src_len;
+    int ret = Z_OK;
+    int drained = 1;
+
+    while (index->left) {
+        if (index->trailer) {
+            // Skip the gzip trailer, which the raw inflate leaves behind
+            unsigned drop = strm->avail_in < index->trailer ? strm->avail_in : index->trailer;
+            strm->next_in += drop;
+            strm->avail_in -= drop;
+            index->trailer -= drop;
+            if (index->trailer) break;
+            ret = inflateReset2(strm, INDEX_GZIP);
+            if (ret != Z_OK) break;
+            index->header = 1;
+        }
+
+        if (strm->avail_in == 0 && drained) break;
+
+        if (index->header) {
+            // Let inflate parse the next member's header, then go raw again
+            strm->next_out = index->win;
+            strm->avail_out = INDEX_WINSIZE;
+            ret = inflate(strm, Z_BLOCK);
+            if (ret == Z_BUF_ERROR && strm->avail_in == 0) ret = Z_OK;
+            if (ret != Z_OK) break;
+            if (strm->data_type & 0x80) {
+                index->header = 0;
+                ret = inflateReset2(strm, INDEX_RAW);
+                if (ret != Z_OK) break;
+            }
+            continue;
+        }
+
+        unsigned have;
+        if (index->skip) {
+            have = index->skip < INDEX_WINSIZE ? (unsigned)index->skip : INDEX_WINSIZE;
+            strm->next_out = index->win;
+        } else {
+            have = index->left < (unsigned)-1 ? (unsigned)index->left : (unsigned)-1;
+            strm->next_out = dest + index->got;
+        }
+        strm->avail_out = have;
+
+        ret = inflate(strm, Z_NO_FLUSH);
+        drained = strm->avail_out != 0;
+        have -= strm->avail_out;
+        if (index->skip) {
+            index->skip -= have;
+        } else {
+            index->left -= have;
+            index->got += have;
+        }
+
+        if (ret == Z_STREAM_END) {
+            if (index->mode != INDEX_GZIP) break;
+            index->trailer = 8;
+            ret = Z_OK;
+        } else if (ret == Z_BUF_ERROR && strm->avail_in == 0) {
+            ret = Z_OK;
+        } else if (ret != Z_OK) {
+            if (ret == Z_NEED_DICT) ret = Z_DATA_ERROR;
+            break;
+        }
+    }
+
+    strm->next_in = Z_NULL;
+    strm->avail_in = 0;
+    *got = index->got;
+
+    if (ret == Z_OK && index->left) return Z_OK;
+    index->extracting = 0;
+    return ret == Z_OK ? Z_STREAM_END : ret;
+}
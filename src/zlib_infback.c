@@ -0,0 +1,217 @@
+/**
+ * zlib.wasm - Callback-driven inflate through inflateBack()
+ *
+ * Copyright 2025 Superstruct Ltd, New Zealand
+ *
+ * This source code is licensed under the Zlib license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * inflateBack() decodes straight into its 32 KB window and hands each full
+ * window (and the rest at the end) to an output callback, so there is no
+ * output buffer at all; it pulls input the same way. Both callbacks call
+ * into the host (Module.zlibBack in src/lib/infback.ts) with pointers into
+ * the heap: input is read where the host left it, and output is shown to
+ * the host as a view of the window, valid for that call only.
+ *
+ * inflateBack() itself knows only raw deflate, so the zlib or gzip header
+ * and trailer are handled here, and the trailer's check is computed over
+ * the output on its way out. Concatenated gzip members are decoded one
+ * after another, as zlib_decompress_buffer() does.
+ */
+
+#include <emscripten.h>
+#include <stdlib.h>
+#include "zlib.h"
+
+// Wrappers zlib_inflate_back() reads: as zlib_compress_format(), plus
+// detecting zlib or gzip from the first byte
+#define BACK_ZLIB 0
+#define BACK_GZIP 1
+#define BACK_RAW 2
+#define BACK_AUTO 3
+
+#define BACK_WINDOW (1U << 15)
+
+// gzip header flags
+#define GZ_FHCRC 0x02
+#define GZ_FEXTRA 0x04
+#define GZ_FNAME 0x08
+#define GZ_FCOMMENT 0x10
+
+// Host callbacks. pull() stores the address of the next input in *buf and
+// returns its length, 0 at the end or -1 if the host failed; push()
+// returns 0, or -1 to stop.
+EM_JS(int, zlib_host_back_pull, (int call, unsigned char** buf), {
+    return Module.zlibBack.pull(call, buf);
+});
+
+EM_JS(int, zlib_host_back_push, (int call, unsigned char* buf, unsigned len), {
+    return Module.zlibBack.push(call, buf, len);
+});
+
+typedef struct {
+    int call;
+    z_const unsigned char* next;    // unread input from the last pull
+    unsigned have;
+    int gzip;
+    unsigned long check;
+    unsigned long total;
+    int failed;                     // Z_ERRNO once a callback has failed
+} back_t;
+
+static unsigned back_in(void* desc, z_const unsigned char** buf) {
+    back_t* st = (back_t*)desc;
+    if (st->have) {
+        *buf = st->next;
+        unsigned n = st->have;
+        st->have = 0;
+        return n;
+    }
+    unsigned char* next = NULL;
+    int n = zlib_host_back_pull(st->call, &next);
+    if (n < 0) st->failed = Z_ERRNO;
+    *buf = next;
+    return n > 0 ? (unsigned)n : 0;
+}
+
+static int back_out(void* desc, unsigned char* buf, unsigned len) {
+    back_t* st = (back_t*)desc;
+    st->check = st->gzip ? crc32_z(st->check, buf, len) : adler32_z(st->check, buf, len);
+    st->total += len;
+    if (zlib_host_back_push(st->call, buf, len) != 0) {
+        st->failed = Z_ERRNO;
+        return 1;
+    }
+    return 0;
+}
+
+// Next input byte, pulling more when needed; -1 at the end of the input
+static int back_byte(back_t* st) {
+    if (!st->have) {
+        z_const unsigned char* next;
+        st->have = back_in(st, &next);
+        st->next = next;
+        if (!st->have) return -1;
+    }
+    st->have--;
+    return *st->next++;
+}
+
+// Skip a NUL-terminated header field
+static int skip_string(back_t* st) {
+    int c;
+    while ((c = back_byte(st)) > 0) {}
+    return c;
+}
+
+// Read a gzip header up to its deflate data
+static int gzip_header(back_t* st) {
+    if (back_byte(st) != 0x1f || back_byte(st) != 0x8b || back_byte(st) != 8) return Z_DATA_ERROR;
+    int flags = back_byte(st);
+    if (flags < 0 || (flags & 0xe0)) return Z_DATA_ERROR;
+    for (int i = 0; i < 6; i++) {
+        if (back_byte(st) < 0) return Z_BUF_ERROR;
+    }
+    if (flags & GZ_FEXTRA) {
+        int lo = back_byte(st), hi = back_byte(st);
+        if (hi < 0) return Z_BUF_ERROR;
+        for (int n = lo | hi << 8; n > 0; n--) {
+            if (back_byte(st) < 0) return Z_BUF_ERROR;
+        }
+    }
+    if ((flags & GZ_FNAME) && skip_string(st) < 0) return Z_BUF_ERROR;
+    if ((flags & GZ_FCOMMENT) && skip_string(st) < 0) return Z_BUF_ERROR;
+    if ((flags & GZ_FHCRC) && (back_byte(st) < 0 || back_byte(st) < 0)) return Z_BUF_ERROR;
+    return Z_OK;
+}
+
+static int zlib_header(back_t* st) {
+    int cmf = back_byte(st), flg = back_byte(st);
+    if (flg < 0) return Z_BUF_ERROR;
+    if ((cmf & 0x0f) != 8 || (cmf >> 4) > 7 || ((cmf << 8) | flg) % 31) return Z_DATA_ERROR;
+    return flg & 0x20 ? Z_NEED_DICT : Z_OK;
+}
+
+// The trailer's n bytes, little-endian for gzip and big-endian for zlib
+static int trailer(back_t* st, int n, unsigned long* value) {
+    *value = 0;
+    for (int i = 0; i < n; i++) {
+        int c = back_byte(st);
+        if (c < 0) return Z_BUF_ERROR;
+        *value = st->gzip ? *value | (unsigned long)c << (8 * i) : *value << 8 | (unsigned long)c;
+    }
+    return Z_OK;
+}
+
+/**
+ * Inflate a zlib (format 0), gzip (1) or raw deflate (2) stream, or zlib
+ * or gzip by its first byte (3), with input and output going through the
+ * host's zlibBack.pull() and .push() for the given call. Returns Z_OK at
+ * the end of the stream, Z_BUF_ERROR if the input ends first, Z_ERRNO if
+ * a callback failed, or another negative code.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_inflate_back(int call, int format) {
+    if (format < BACK_ZLIB || format > BACK_AUTO) return Z_STREAM_ERROR;
+
+    back_t st = { call, NULL, 0, 0, 0, 0, Z_OK };
+    if (format == BACK_AUTO) {
+        int c = back_byte(&st);
+        if (c < 0) return st.failed ? st.failed : Z_BUF_ERROR;
+        st.next--;
+        st.have++;
+        format = c == 0x1f ? BACK_GZIP : BACK_ZLIB;
+    }
+    st.gzip = format == BACK_GZIP;
+
+    unsigned char* window = (unsigned char*)malloc(BACK_WINDOW);
+    if (!window) return Z_MEM_ERROR;
+    z_stream strm = { 0 };
+    int ret = inflateBackInit(&strm, 15, window);
+
+    int member = 1;
+    while (ret == Z_OK && member) {
+        if (format != BACK_RAW) {
+            ret = st.gzip ? gzip_header(&st) : zlib_header(&st);
+            if (ret != Z_OK) break;
+        }
+        st.check = st.gzip ? crc32(0L, Z_NULL, 0) : adler32(0L, Z_NULL, 0);
+        st.total = 0;
+
+        strm.next_in = st.next;
+        strm.avail_in = st.have;
+        st.have = 0;
+        ret = inflateBack(&strm, back_in, &st, back_out, &st);
+        st.next = strm.next_in;
+        st.have = strm.avail_in;
+        if (ret != Z_STREAM_END) break;
+        ret = Z_OK;
+
+        unsigned long check = 0, isize = 0;
+        if (format != BACK_RAW) {
+            ret = trailer(&st, 4, &check);
+            if (ret == Z_OK && st.gzip) ret = trailer(&st, 4, &isize);
+            if (ret == Z_OK && (check != (st.check & 0xffffffffUL) ||
+                                (st.gzip && isize != (st.total & 0xffffffffUL)))) {
+                ret = Z_DATA_ERROR;
+            }
+        }
+
+        // Another gzip member may follow, which inflateBack() starts afresh
+        // on the same window; anything else ends the stream
+        member = 0;
+        if (ret == Z_OK && st.gzip) {
+            int c = back_byte(&st);
+            if (c >= 0) {
+                st.next--;
+                st.have++;
+                member = c == 0x1f;
+            }
+        }
+    }
+
+    inflateBackEnd(&strm);
+    free(window);
+    if (st.failed) return st.failed;
+    return ret;
+}
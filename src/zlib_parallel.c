@@ -0,0 +1,351 @@
+/**
+ * zlib.wasm - Multi-threaded block compression
+ *
+ * Copyright 2025 Superstruct Ltd, New Zealand
+ *
+ * This source code is licensed under the Zlib license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * pigz-style parallel deflate for the -pthread build: the input is cut into
+ * fixed-size blocks, a pool of pthreads compresses them with
+ * zlib_compress_block() straight out of the shared heap, and the results
+ * are joined into a single zlib stream. Unlike the Web Worker pool in
+ * src/lib/parallel.ts no block is ever copied between isolated heaps.
+ */
+
+#include <emscripten.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "zlib.h"
+
+// Bytes per block unless the caller chooses (never fewer, so the bound
+// holds), and the dictionary each block inherits from its predecessor
+#define PARALLEL_BLOCK_SIZE (128 * 1024)
+#define PARALLEL_DICT_SIZE  (32 * 1024)
+#define PARALLEL_MAX_THREADS 32
+
+// Defined in wasm_module.c
+int zlib_compress_block(const unsigned char* src, unsigned long src_len,
+                        const unsigned char* dict, unsigned long dict_len,
+                        unsigned char* dest, unsigned long* dest_len,
+                        int level, int last);
+unsigned long zlib_compress_block_bound(unsigned long source_len);
+unsigned long zlib_crc32_combine(unsigned long crc1, unsigned long crc2, unsigned long len2);
+unsigned long zlib_crc32_combine_gen(unsigned long len2);
+int zlib_bgzf_member(const unsigned char* src, unsigned long src_len,
+                     unsigned char* dest, unsigned long* dest_len, int level);
+int zlib_bgzf_compress(const unsigned char* src, unsigned long src_len,
+                       unsigned char* dest, unsigned long* dest_len,
+                       int level, unsigned long block_size);
+unsigned long zlib_bgzf_bound(unsigned long src_len, unsigned long block_size);
+
+// As in zlib_bgzf.c
+#define BGZF_BLOCK_SIZE 0xff00
+#define BGZF_MAX_MEMBER 0x10000
+
+typedef struct {
+    unsigned char* data;
+    unsigned long len;
+    unsigned long check;
+    int status;
+} parallel_block_t;
+
+typedef struct {
+    const unsigned char* src;
+    unsigned long src_len;
+    unsigned long block_size;
+    parallel_block_t* blocks;
+    unsigned long block_count;
+    unsigned long next;             // next block to claim, under lock
+    pthread_mutex_t lock;
+    int level;
+} parallel_job_t;
+
+static void compress_one(parallel_job_t* job, unsigned long i) {
+    parallel_block_t* block = &job->blocks[i];
+    unsigned long start = i * job->block_size;
+    unsigned long len = job->src_len - start < job->block_size ?
+                        job->src_len - start : job->block_size;
+    unsigned long dict_len = start < PARALLEL_DICT_SIZE ? start : PARALLEL_DICT_SIZE;
+
+    block->len = zlib_compress_block_bound(len);
+    block->data = (unsigned char*)malloc(block->len);
+    if (!block->data) {
+        block->status = Z_MEM_ERROR;
+        return;
+    }
+
+    block->status = zlib_compress_block(job->src + start, len,
+                                        dict_len ? job->src + start - dict_len : NULL,
+                                        dict_len, block->data, &block->len,
+                                        job->level, i == job->block_count - 1);
+    block->check = adler32(1L, job->src + start, len);
+}
+
+static void* parallel_worker(void* arg) {
+    parallel_job_t* job = (parallel_job_t*)arg;
+
+    for (;;) {
+        pthread_mutex_lock(&job->lock);
+        unsigned long i = job->next++;
+        pthread_mutex_unlock(&job->lock);
+
+        if (i >= job->block_count) break;
+        compress_one(job, i);
+    }
+    return NULL;
+}
+
+/**
+ * Compress src into a zlib stream using up to nthreads threads, in blocks
+ * of block_size bytes (0 for PARALLEL_BLOCK_SIZE). The output depends on
+ * src, level and block_size only: blocks are cut at fixed offsets and each
+ * is primed from the input before it, so any thread count and any order of
+ * completion give the same bytes.
+ * dest_len is the capacity of dest on entry and the stream length on exit;
+ * size dest with zlib_compress_parallel_bound(). Returns Z_OK, Z_BUF_ERROR
+ * or Z_MEM_ERROR.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_compress_parallel(const unsigned char* src, unsigned long src_len,
+                           unsigned char* dest, unsigned long* dest_len,
+                           int level, unsigned long block_size, int nthreads) {
+    if ((!src && src_len) || !dest || !dest_len) {
+        return Z_STREAM_ERROR;
+    }
+    if (level < 0 || level > Z_ULTRA_COMPRESSION) level = Z_DEFAULT_COMPRESSION;
+
+    parallel_job_t job;
+    memset(&job, 0, sizeof(job));
+    job.src = src;
+    job.src_len = src_len;
+    job.level = level;
+    job.block_size = block_size < PARALLEL_BLOCK_SIZE ? PARALLEL_BLOCK_SIZE : block_size;
+    job.block_count = src_len ? (src_len + job.block_size - 1) / job.block_size : 1;
+    job.blocks = (parallel_block_t*)calloc(job.block_count, sizeof(parallel_block_t));
+    if (!job.blocks) return Z_MEM_ERROR;
+    pthread_mutex_init(&job.lock, NULL);
+
+    if (nthreads < 1) nthreads = 1;
+    if (nthreads > PARALLEL_MAX_THREADS) nthreads = PARALLEL_MAX_THREADS;
+    if ((unsigned long)nthreads > job.block_count) nthreads = (int)job.block_count;
+
+    // The calling thread works too, so nthreads - 1 helpers are started
+    pthread_t threads[PARALLEL_MAX_THREADS];
+    int started = 0;
+    while (started < nthreads - 1 &&
+           pthread_create(&threads[started], NULL, parallel_worker, &job) == 0) {
+        started++;
+    }
+    parallel_worker(&job);
+    for (int t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    pthread_mutex_destroy(&job.lock);
+
+    // Join: zlib header, the raw deflate blocks, big-endian Adler-32
+    int ret = Z_OK;
+    unsigned long capacity = *dest_len;
+    unsigned long out = 0;
+    unsigned long check = 1L;
+
+    int flevel = level == Z_DEFAULT_COMPRESSION ? 2 :
+                 level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3;
+    unsigned int header = (0x78 << 8) | (flevel << 6);
+    header += 31 - (header % 31);
+
+    if (capacity < 6) ret = Z_BUF_ERROR;
+    else {
+        dest[out++] = (unsigned char)(header >> 8);
+        dest[out++] = (unsigned char)(header & 0xff);
+    }
+
+    for (unsigned long i = 0; i < job.block_count; i++) {
+        parallel_block_t* block = &job.blocks[i];
+        if (ret == Z_OK && block->status != Z_OK) ret = block->status;
+        if (ret == Z_OK && capacity - out < block->len + 4) ret = Z_BUF_ERROR;
+        if (ret == Z_OK) {
+            memcpy(dest + out, block->data, block->len);
+            out += block->len;
+
+            unsigned long start = i * job.block_size;
+            unsigned long len = src_len - start < job.block_size ?
+                                src_len - start : job.block_size;
+            check = i ? adler32_combine(check, block->check, (z_off_t)len) : block->check;
+        }
+        free(block->data);
+    }
+    free(job.blocks);
+
+    if (ret != Z_OK) return ret;
+
+    dest[out++] = (unsigned char)(check >> 24);
+    dest[out++] = (unsigned char)(check >> 16);
+    dest[out++] = (unsigned char)(check >> 8);
+    dest[out++] = (unsigned char)check;
+    *dest_len = out;
+    return Z_OK;
+}
+
+/**
+ * Get maximum zlib_compress_parallel() output size for given input size
+ */
+EMSCRIPTEN_KEEPALIVE
+unsigned long zlib_compress_parallel_bound(unsigned long source_len) {
+    unsigned long blocks = source_len ? (source_len + PARALLEL_BLOCK_SIZE - 1) / PARALLEL_BLOCK_SIZE : 1;
+    // Every block carries its own stored-block and sync-flush overhead
+    return zlib_compress_block_bound(source_len) + blocks * 18 + 6;
+}
+
+typedef struct {
+    const unsigned char* src;
+    unsigned long len;
+    unsigned long crc;
+} crc_slice_t;
+
+static void* crc_worker(void* arg) {
+    crc_slice_t* slice = (crc_slice_t*)arg;
+    slice->crc = crc32_z(0L, slice->src, slice->len);
+    return NULL;
+}
+
+/**
+ * CRC-32 of src, computed as up to nthreads equal slices at once, each at
+ * least a block long, and merged with crc32_combine_op(). The slices share
+ * one combine operator; the last may be shorter and is combined on its own.
+ */
+EMSCRIPTEN_KEEPALIVE
+unsigned long zlib_crc32_parallel(const unsigned char* src, unsigned long src_len, int nthreads) {
+    if (!src || !src_len) return 0;
+
+    unsigned long most = src_len / PARALLEL_BLOCK_SIZE;
+    if (nthreads > PARALLEL_MAX_THREADS) nthreads = PARALLEL_MAX_THREADS;
+    if ((unsigned long)nthreads > most) nthreads = (int)most;
+    if (nthreads < 2) return crc32_z(0L, src, src_len);
+
+    unsigned long step = (src_len + nthreads - 1) / nthreads;
+    crc_slice_t slices[PARALLEL_MAX_THREADS];
+    int count = 0;
+    for (unsigned long start = 0; start < src_len; start += step, count++) {
+        slices[count].src = src + start;
+        slices[count].len = src_len - start < step ? src_len - start : step;
+    }
+
+    // The calling thread takes the first slice; a slice whose thread could
+    // not be started is done here as well
+    pthread_t threads[PARALLEL_MAX_THREADS];
+    int started[PARALLEL_MAX_THREADS] = {0};
+    for (int t = 1; t < count; t++) {
+        started[t] = pthread_create(&threads[t], NULL, crc_worker, &slices[t]) == 0;
+    }
+    crc_worker(&slices[0]);
+    for (int t = 1; t < count; t++) {
+        if (started[t]) pthread_join(threads[t], NULL);
+        else crc_worker(&slices[t]);
+    }
+
+    unsigned long op = zlib_crc32_combine_gen(step);
+    unsigned long crc = slices[0].crc;
+    for (int t = 1; t < count; t++) {
+        crc = slices[t].len == step ? crc32_combine_op(crc, slices[t].crc, op) :
+              zlib_crc32_combine(crc, slices[t].crc, slices[t].len);
+    }
+    return crc;
+}
+
+typedef struct {
+    const unsigned char* src;
+    unsigned long src_len;
+    unsigned long block_size;
+    unsigned char* dest;
+    unsigned long* sizes;
+    unsigned long block_count;
+    unsigned long next;             // next member to claim, under lock
+    int status;                     // first failure, under lock
+    pthread_mutex_t lock;
+    int level;
+} bgzf_job_t;
+
+static void* bgzf_worker(void* arg) {
+    bgzf_job_t* job = (bgzf_job_t*)arg;
+
+    for (;;) {
+        pthread_mutex_lock(&job->lock);
+        unsigned long i = job->next++;
+        pthread_mutex_unlock(&job->lock);
+        if (i >= job->block_count) break;
+
+        unsigned long start = i * job->block_size;
+        unsigned long len = job->src_len - start < job->block_size ?
+                            job->src_len - start : job->block_size;
+        int ret = zlib_bgzf_member(job->src + start, len, job->dest + i * BGZF_MAX_MEMBER,
+                                   &job->sizes[i], job->level);
+        if (ret != Z_OK) {
+            pthread_mutex_lock(&job->lock);
+            if (job->status == Z_OK) job->status = ret;
+            pthread_mutex_unlock(&job->lock);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * zlib_bgzf_compress() on up to nthreads threads. Members need nothing from
+ * each other, so each is written straight into its own BGZF_MAX_MEMBER slot
+ * of dest, and the slots are then closed up in order.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_bgzf_compress_parallel(const unsigned char* src, unsigned long src_len,
+                                unsigned char* dest, unsigned long* dest_len,
+                                int level, unsigned long block_size, int nthreads) {
+    if ((!src && src_len) || !dest || !dest_len) {
+        return Z_STREAM_ERROR;
+    }
+    if (block_size == 0 || block_size > BGZF_BLOCK_SIZE) block_size = BGZF_BLOCK_SIZE;
+
+    unsigned long block_count = (src_len + block_size - 1) / block_size;
+    if (nthreads > PARALLEL_MAX_THREADS) nthreads = PARALLEL_MAX_THREADS;
+    if ((unsigned long)nthreads > block_count) nthreads = (int)block_count;
+    if (nthreads < 2) return zlib_bgzf_compress(src, src_len, dest, dest_len, level, block_size);
+    if (*dest_len < zlib_bgzf_bound(src_len, block_size)) return Z_BUF_ERROR;
+
+    bgzf_job_t job;
+    memset(&job, 0, sizeof(job));
+    job.src = src;
+    job.src_len = src_len;
+    job.block_size = block_size;
+    job.dest = dest;
+    job.block_count = block_count;
+    job.level = level;
+    job.sizes = (unsigned long*)calloc(block_count, sizeof(unsigned long));
+    if (!job.sizes) return Z_MEM_ERROR;
+    pthread_mutex_init(&job.lock, NULL);
+
+    pthread_t threads[PARALLEL_MAX_THREADS];
+    int started = 0;
+    while (started < nthreads - 1 &&
+           pthread_create(&threads[started], NULL, bgzf_worker, &job) == 0) {
+        started++;
+    }
+    bgzf_worker(&job);
+    for (int t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    pthread_mutex_destroy(&job.lock);
+
+    int ret = job.status;
+    unsigned long out = 0;
+    for (unsigned long i = 0; ret == Z_OK && i < block_count; i++) {
+        memmove(dest + out, dest + i * BGZF_MAX_MEMBER, job.sizes[i]);
+        out += job.sizes[i];
+    }
+    free(job.sizes);
+    if (ret != Z_OK) return ret;
+
+    // The end marker, as the serial writer emits it for empty input
+    unsigned long tail = *dest_len - out;
+    ret = zlib_bgzf_compress(NULL, 0, dest + out, &tail, level, block_size);
+    if (ret == Z_OK) *dest_len = out + tail;
+    return ret;
+}
@@ -0,0 +1,51 @@
+/**
+ * zlib.wasm SIMD128 kernel declarations
+ *
+ * Kernels implemented in src/zlib_simd_optimized.c that the core zlib
+ * sources dispatch to at build time. The core only references them when
+ * compiled with -msimd128 (__wasm_simd128__ defined), so native builds and
+ * the scalar fallback module keep the original code paths.
+ */
+
+#ifndef ZLIB_SIMD_H
+#define ZLIB_SIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Subtract wsize from every head[] and prev[] entry, saturating at zero (NIL)
+void zlib_slide_hash_simd(uint16_t* hash_table, uint16_t* prev_table,
+                          uint32_t hash_size, uint32_t window_size, uint16_t wsize);
+
+// Match length as longest_match() counts it: bytes 0..2 are already known to
+// be equal, bytes 3..257 are compared and the result is capped at 258
+uint32_t zlib_match_len_simd(const uint8_t* scan, const uint8_t* match);
+
+// Rolling-hash keys of the count strings at window (count a multiple of 8),
+// each ((w[0] << 2 * shift) ^ (w[1] << shift) ^ w[2]) & mask, as UPDATE_HASH()
+// builds them. Reads window[0 .. count + 1].
+void zlib_hash3_keys_simd(const uint8_t* window, uint32_t count, uint32_t shift,
+                          uint32_t mask, uint16_t* keys);
+
+// ZLIB_HASH_MUL keys of the count strings at window (count a multiple of 8):
+// the little-endian four bytes times 2654435761, top bits bits kept.
+// Reads window[0 .. count + 2].
+void zlib_hash4_keys_simd(const uint8_t* window, uint32_t count, uint32_t bits,
+                          uint16_t* keys);
+
+// How many of the max bytes at scan repeat scan[-1]. Reads scan[-1 .. max - 1].
+uint32_t zlib_run_len_simd(const uint8_t* scan, uint32_t max);
+
+// sym_buf entries (0, 0, literal) for the count literals at lit, 3 * count bytes
+void zlib_literal_syms_simd(const uint8_t* lit, uint32_t count, uint8_t* sym);
+
+// Add the occurrences of each byte value in buf to counts[256]
+void zlib_byte_counts_simd(const uint8_t* buf, size_t len, uint32_t* counts);
+
+// Adler-32 over buf, continuing from adler; handles any length
+uint32_t zlib_adler32_simd(uint32_t adler, const uint8_t* buf, size_t len);
+
+// Copy an LZ77 back-reference: len bytes from src (dest - dist) to dest
+void zlib_chunkmemset_simd(uint8_t* dest, uint8_t* src, uint32_t dist, uint32_t len);
+
+#endif /* ZLIB_SIMD_H */
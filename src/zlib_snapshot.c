@@ -0,0 +1,102 @@
+/**
+ * zlib.wasm - Deflate state snapshots
+ *
+ * Copyright 2025 Superstruct Ltd, New Zealand
+ *
+ * This source code is licensed under the Zlib license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * deflateSetDictionary() runs fill_window() and inserts every dictionary
+ * position into head/prev, which for a 32 KB dictionary costs more than
+ * compressing a typical small message. Restoring a primed snapshot copies
+ * only what that left behind:
+ *
+ *   window: the dictionary bytes plus the WIN_INIT bytes zeroed past it
+ *   prev:   one chain link per dictionary position (at most w_size)
+ *   head:   the whole hash table
+ *
+ * and leaves pending_buf, the symbol buffer and the level 10 parse workspace
+ * alone, since none of them holds anything before the first deflate() call.
+ */
+
+#include "deflate.h"
+#include "zlib_snapshot.h"
+
+static int snapshot_fresh(z_streamp strm) {
+    deflate_state* s;
+
+    if (strm == Z_NULL) return 0;
+    s = (deflate_state*)strm->state;
+    if (s == Z_NULL || s->strm != strm) return 0;
+#ifdef GZIP
+    if (s->status != INIT_STATE && s->status != GZIP_STATE) return 0;
+#else
+    if (s->status != INIT_STATE) return 0;
+#endif
+    // total_in already counts the dictionary bytes
+    return strm->total_out == 0 && s->pending == 0 && s->sym_next == 0;
+}
+
+int zlib_deflate_restore(z_streamp dest, z_streamp snapshot) {
+    deflate_state* ds;
+    deflate_state* ss;
+
+    if (!snapshot_fresh(snapshot) || !snapshot_fresh(dest)) return Z_STREAM_ERROR;
+    ds = (deflate_state*)dest->state;
+    ss = (deflate_state*)snapshot->state;
+
+    if (ds->w_bits != ss->w_bits || ds->hash_bits != ss->hash_bits ||
+        ds->lit_bufsize != ss->lit_bufsize || ds->level != ss->level ||
+        ds->strategy != ss->strategy || ds->wrap != ss->wrap) {
+        return Z_STREAM_ERROR;
+    }
+
+    // Same geometry, so the state fields copy over as they are apart from
+    // the pointers into dest's own buffers
+    Bytef* window = ds->window;
+    Posf* prev = ds->prev;
+    Posf* head = ds->head;
+    uchf* pending_buf = ds->pending_buf;
+    uchf* ultra_buf = ds->ultra_buf;
+#ifdef LIT_MEM
+    ushf* d_buf = ds->d_buf;
+    uchf* l_buf = ds->l_buf;
+#else
+    uchf* sym_buf = ds->sym_buf;
+#endif
+
+    zmemcpy((voidpf)ds, (voidpf)ss, sizeof(deflate_state));
+    ds->strm = dest;
+    ds->window = window;
+    ds->prev = prev;
+    ds->head = head;
+    ds->pending_buf = pending_buf;
+    ds->pending_out = pending_buf;
+    ds->ultra_buf = ultra_buf;
+#ifdef LIT_MEM
+    ds->d_buf = d_buf;
+    ds->l_buf = l_buf;
+#else
+    ds->sym_buf = sym_buf;
+#endif
+    ds->l_desc.dyn_tree = ds->dyn_ltree;
+    ds->d_desc.dyn_tree = ds->dyn_dtree;
+    ds->bl_desc.dyn_tree = ds->bl_tree;
+
+    ulg used = (ulg)ss->strstart + ss->lookahead;
+    if (used < ss->high_water) used = ss->high_water;
+    if (used > ss->window_size) used = ss->window_size;
+    zmemcpy(window, ss->window, (unsigned)used);
+
+    ulg links = (ulg)ss->strstart + ss->lookahead;
+    if (links > ss->w_size) links = ss->w_size;
+    zmemcpy((voidpf)prev, (voidpf)ss->prev, (unsigned)(links * sizeof(Pos)));
+    zmemcpy((voidpf)head, (voidpf)ss->head, (unsigned)(ss->hash_size * sizeof(Pos)));
+
+    // The dictionary's Adler-32 id, written into the zlib header
+    dest->adler = snapshot->adler;
+    dest->total_in = snapshot->total_in;
+    dest->data_type = snapshot->data_type;
+    dest->msg = Z_NULL;
+    return Z_OK;
+}
@@ -0,0 +1,23 @@
+/**
+ * zlib.wasm deflate state snapshots
+ *
+ * Restores a deflate stream primed with deflateSetDictionary() into another
+ * stream of the same geometry by copying the window, hash chains and state
+ * fields, so a preset dictionary is hashed once rather than per message.
+ * Unlike deflateCopy() nothing is allocated: the destination keeps its own
+ * buffers, typically a pooled context from zlib_ctx_acquire().
+ */
+
+#ifndef ZLIB_SNAPSHOT_H
+#define ZLIB_SNAPSHOT_H
+
+#include "zlib.h"
+
+// Make dest continue from snapshot as though it had itself gone through
+// deflateInit2() and deflateSetDictionary(). Both streams must come from
+// deflateInit2() with the same level, windowBits, memLevel and strategy, and
+// snapshot must not have been passed to deflate() yet. Returns Z_OK or
+// Z_STREAM_ERROR; snapshot is left untouched either way.
+int zlib_deflate_restore(z_streamp dest, z_streamp snapshot);
+
+#endif /* ZLIB_SNAPSHOT_H */
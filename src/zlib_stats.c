@@ -0,0 +1,66 @@
+/**
+ * zlib.wasm - Hot-path instrumentation
+ *
+ * Copyright 2025 Superstruct Ltd, New Zealand
+ *
+ * This source code is licensed under the Zlib license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Storage and exports for the ZSTATS_ hooks in deflate.c, trees.c,
+ * inffast.c, inftrees.c, crc32.c and adler32.c. Linked into every main
+ * module so the exports always exist; without ZLIB_WASM_STATS they report
+ * that the build is not instrumented.
+ *
+ * Each hook reads the clock twice, which costs far more than the short
+ * phases it brackets (longest_match() above all), so compare times between
+ * runs of an instrumented build rather than against an uninstrumented one.
+ * The counters are plain globals, for the single-threaded build only.
+ */
+
+#include <emscripten.h>
+#include <string.h>
+#include "zutil.h"
+
+#ifdef ZLIB_WASM_STATS
+
+zlib_stats_t zlib_stats;
+
+double zlib_stats_now(void) {
+    return emscripten_get_now();
+}
+
+void zlib_stats_chain(unsigned probes) {
+    int bucket = 0;
+
+    while (probes > 1 && bucket < ZSTATS_CHAIN_BUCKETS - 1) {
+        probes >>= 1;
+        bucket++;
+    }
+    zlib_stats.chain[bucket] += 1;
+}
+
+#endif
+
+/**
+ * Counters since startup or the last zlib_reset_stats(), as
+ * ZSTATS_PHASES * 3 + ZSTATS_CHAIN_BUCKETS doubles laid out as
+ * zlib_stats_t, or NULL if the build is not instrumented.
+ */
+EMSCRIPTEN_KEEPALIVE
+const double* zlib_get_stats(void) {
+#ifdef ZLIB_WASM_STATS
+    return (const double*)&zlib_stats;
+#else
+    return NULL;
+#endif
+}
+
+/**
+ * Zero every counter
+ */
+EMSCRIPTEN_KEEPALIVE
+void zlib_reset_stats(void) {
+#ifdef ZLIB_WASM_STATS
+    memset(&zlib_stats, 0, sizeof(zlib_stats));
+#endif
+}
@@ -0,0 +1,60 @@
+/**
+ * zlib.wasm hot-path instrumentation
+ *
+ * Call counters, wall-clock timers and byte counts for the phases deflate
+ * and inflate spend their time in, plus a histogram of the hash chain
+ * lengths longest_match() walks. Only built when ZLIB_WASM_STATS is
+ * defined; zutil.h includes this header and otherwise defines the ZSTATS_
+ * hooks away, so the default build compiles exactly as before.
+ */
+
+#ifndef ZLIB_STATS_H
+#define ZLIB_STATS_H
+
+// Instrumented phases, in the order zlib_get_stats() lays them out
+#define ZSTATS_FILL_WINDOW   0  // bytes: input read into the window
+#define ZSTATS_SLIDE_HASH    1  // bytes: hash and chain entries rebased
+#define ZSTATS_LONGEST_MATCH 2  // bytes: best match length found
+#define ZSTATS_FLUSH_BLOCK   3  // bytes: input covered by the block
+#define ZSTATS_INFLATE_FAST  4  // bytes: output written
+#define ZSTATS_INFLATE_TABLE 5  // bytes: code lengths decoded into a table
+#define ZSTATS_CRC32         6  // bytes: data checksummed
+#define ZSTATS_ADLER32       7
+#define ZSTATS_PHASES        8
+
+// Chain histogram bucket i counts longest_match() calls that probed
+// [2^i, 2^(i+1)) chain entries; the last bucket is open-ended
+#define ZSTATS_CHAIN_BUCKETS 16
+
+// Everything is a double so JavaScript can read the block as one
+// Float64Array; counts stay exact up to 2^53
+typedef struct {
+    double calls;
+    double time_ms;     // inclusive of any instrumented phase called inside
+    double bytes;
+} zlib_phase_stats_t;
+
+typedef struct {
+    zlib_phase_stats_t phase[ZSTATS_PHASES];
+    double chain[ZSTATS_CHAIN_BUCKETS];
+} zlib_stats_t;
+
+extern zlib_stats_t zlib_stats;
+
+// emscripten_get_now(), in milliseconds
+double zlib_stats_now(void);
+
+void zlib_stats_chain(unsigned probes);
+
+// ZSTATS_BEGIN declares a local named after the phase, so it goes where a
+// declaration may, and ZSTATS_END in the same block
+#define ZSTATS_BEGIN(id) double zstats_##id = zlib_stats_now()
+#define ZSTATS_END(id, n) do { \
+        zlib_stats.phase[id].calls += 1; \
+        zlib_stats.phase[id].time_ms += zlib_stats_now() - zstats_##id; \
+        zlib_stats.phase[id].bytes += (double)(n); \
+    } while (0)
+#define ZSTATS_BYTES(id, n) (zlib_stats.phase[id].bytes += (double)(n))
+#define ZSTATS_CHAIN(probes) zlib_stats_chain(probes)
+
+#endif /* ZLIB_STATS_H */
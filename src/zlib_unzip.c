@@ -0,0 +1,487 @@
+/**
+ * zlib.wasm - ZIP archive reader
+ *
+ * Copyright 2025 Superstruct Ltd, New Zealand
+ *
+ * This source code is licensed under the Zlib license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Thin layer over contrib/minizip's unzip.c reading an archive that is
+ * already on the heap. The archive is read in place through
+ * contrib/minizip/iomem.c, never copied into the module's file system, and
+ * each entry is inflated straight into a buffer of its recorded size.
+ * Opening indexes the central directory by name (unzOpenIndexed64()), so
+ * finding an entry costs the same in an archive of ten files or of ten
+ * thousand.
+ *
+ * minizip reads one entry at a time through its handle's current file. For
+ * concurrent extraction, zlib_unzip_locate() hands out where an entry's data
+ * lies instead, and zlib_unzip_inflate() inflates such data with no handle
+ * at all: the Web Worker pool (Zlib.extractZip() in src/lib/index.ts) runs
+ * one per worker, and in the -pthread build zlib_unzip_extract_parallel()
+ * runs them on the module's threads straight out of the shared archive.
+ *
+ * Deflate64 entries (method 9, as Windows writes them for large files) go
+ * through contrib/infback9's inflateBack9() with its 64 KB window. minizip
+ * cannot open those itself, so they are always inflated from where
+ * unzGetCurrentFileData() says their data lies.
+ */
+
+#include <emscripten.h>
+#include <stdlib.h>
+#include <string.h>
+#include "zlib.h"
+#include "unzip.h"
+#include "iomem.h"
+#include "infback9.h"
+
+#ifdef __EMSCRIPTEN_PTHREADS__
+#include <pthread.h>
+#define UNZIP_MAX_THREADS 32
+#endif
+
+// The window inflateBack9() needs
+#define DEFLATE64_WINDOW (1U << 16)
+
+// A reader handle: the minizip archive and the heap bytes it reads
+typedef struct {
+    unzFile unz;
+    mem_file mem;
+} zlib_unzip_t;
+
+// Input and output of one inflateBack9() call, both already in memory
+typedef struct {
+    unsigned char* next;
+    unsigned long left;
+} span_t;
+
+static unsigned deflate64_in(void* desc, z_const unsigned char** buf) {
+    span_t* in = (span_t*)desc;
+    unsigned n = (unsigned)in->left;
+    *buf = in->next;
+    in->next += n;
+    in->left = 0;
+    return n;
+}
+
+static int deflate64_out(void* desc, unsigned char* buf, unsigned len) {
+    span_t* out = (span_t*)desc;
+    if (len > out->left) return 1;
+    memcpy(out->next, buf, len);
+    out->next += len;
+    out->left -= len;
+    return 0;
+}
+
+/*
+ * Inflate Deflate64 data into exactly len bytes at data
+ */
+static int inflate_deflate64(const unsigned char* src, unsigned long src_len,
+                             unsigned char* data, unsigned long len) {
+    unsigned char* window = (unsigned char*)malloc(DEFLATE64_WINDOW);
+    if (!window) return Z_MEM_ERROR;
+
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+    int ret = inflateBack9Init(&strm, window);
+    if (ret == Z_OK) {
+        span_t in = { (unsigned char*)src, src_len };
+        span_t out = { data, len };
+        ret = inflateBack9(&strm, deflate64_in, &in, deflate64_out, &out);
+
+        // As for deflate, the stream must end at the size the header records
+        if (ret == Z_STREAM_END && out.left == 0) ret = UNZ_OK;
+        else if (ret != Z_DATA_ERROR && ret != Z_MEM_ERROR) ret = UNZ_BADZIPFILE;
+        inflateBack9End(&strm);
+    }
+    free(window);
+    return ret;
+}
+
+/*
+ * Copy or inflate one entry's data into a new buffer and check its CRC-32.
+ * Only src is read, so any number of these may run at once.
+ */
+static int inflate_data(const unsigned char* src, unsigned long src_len,
+                        unsigned long len, unsigned long crc, int method,
+                        unsigned char** out, unsigned long* out_len) {
+    if (method != 0 && method != Z_DEFLATED && method != Z_DEFLATE64) return UNZ_BADZIPFILE;
+    if (len > 0x7fffffff || src_len > 0x7fffffff) return UNZ_PARAMERROR;
+
+    unsigned char* data = (unsigned char*)malloc(len ? len : 1);
+    if (!data) return UNZ_INTERNALERROR;
+
+    int ret = UNZ_OK;
+    if (method == 0) {
+        if (src_len != len) ret = UNZ_BADZIPFILE;
+        else memcpy(data, src, len);
+    } else if (method == Z_DEFLATE64) {
+        ret = inflate_deflate64(src, src_len, data, len);
+    } else {
+        z_stream strm;
+        memset(&strm, 0, sizeof(strm));
+        ret = inflateInit2(&strm, -MAX_WBITS);
+        if (ret == Z_OK) {
+            strm.next_in = (z_const Bytef*)src;
+            strm.avail_in = (uInt)src_len;
+            strm.next_out = data;
+            strm.avail_out = (uInt)len;
+            ret = inflate(&strm, Z_FINISH);
+
+            // The stream must end exactly at the size the header records
+            if (ret == Z_STREAM_END && strm.total_out == len) ret = UNZ_OK;
+            else if (ret != Z_DATA_ERROR && ret != Z_MEM_ERROR) ret = UNZ_BADZIPFILE;
+            inflateEnd(&strm);
+        }
+    }
+    if (ret == UNZ_OK && crc32(0L, data, (uInt)len) != crc) ret = UNZ_CRCERROR;
+
+    if (ret != UNZ_OK) {
+        free(data);
+        return ret;
+    }
+    *out = data;
+    *out_len = len;
+    return UNZ_OK;
+}
+
+/*
+ * Where the current entry has its data, which must lie inside the archive
+ */
+static int current_data(zlib_unzip_t* reader, unz_file_data* data) {
+    int ret = unzGetCurrentFileData(reader->unz, data);
+    if (ret == UNZ_OK &&
+        (data->pos_in_zipfile > reader->mem.size ||
+         data->compressed_size > reader->mem.size - data->pos_in_zipfile)) {
+        ret = UNZ_BADZIPFILE;
+    }
+    return ret;
+}
+
+/*
+ * Inflate the current entry into a new buffer and check its CRC-32
+ */
+static int extract_current(zlib_unzip_t* reader, unsigned char** out, unsigned long* out_len) {
+    unzFile unz = reader->unz;
+    unz_file_info64 info;
+    int ret = unzGetCurrentFileInfo64(unz, &info, NULL, 0, NULL, 0, NULL, 0);
+    if (ret != UNZ_OK) return ret;
+    if (info.uncompressed_size > 0x7fffffff) return UNZ_PARAMERROR;
+
+    if (info.compression_method == Z_DEFLATE64) {
+        unz_file_data entry;
+        ret = current_data(reader, &entry);
+        if (ret != UNZ_OK) return ret;
+        if (entry.compressed_size > 0x7fffffff) return UNZ_PARAMERROR;
+        return inflate_data(reader->mem.base + entry.pos_in_zipfile,
+                            (unsigned long)entry.compressed_size,
+                            (unsigned long)entry.uncompressed_size, entry.crc,
+                            entry.compression_method, out, out_len);
+    }
+
+    unsigned long len = (unsigned long)info.uncompressed_size;
+    unsigned char* data = (unsigned char*)malloc(len ? len : 1);
+    if (!data) return UNZ_INTERNALERROR;
+
+    ret = unzOpenCurrentFile(unz);
+    if (ret != UNZ_OK) {
+        free(data);
+        return ret;
+    }
+
+    // minizip stops at the size the header records; the CRC check catches the rest
+    unsigned long got = 0;
+    int n = 0;
+    while (got < len && (n = unzReadCurrentFile(unz, data + got, (unsigned)(len - got))) > 0) {
+        got += (unsigned long)n;
+    }
+    ret = unzCloseCurrentFile(unz);     // UNZ_CRCERROR if the data is corrupt
+
+    if (n < 0) ret = n;
+    else if (ret == UNZ_OK && got != len) ret = UNZ_BADZIPFILE;
+    if (ret != UNZ_OK) {
+        free(data);
+        return ret;
+    }
+
+    *out = data;
+    *out_len = len;
+    return UNZ_OK;
+}
+
+/*
+ * Find where the entry called name has its data, which must lie inside
+ * the archive
+ */
+static int locate_data(zlib_unzip_t* reader, const char* name, unz_file_data* data) {
+    int ret = unzLocateFileIndexed(reader->unz, name);
+    if (ret == UNZ_OK) ret = current_data(reader, data);
+    return ret;
+}
+
+/**
+ * Open the ZIP archive in data[0..len-1] for reading
+ * The bytes are read in place and must stay put until zlib_unzip_close().
+ * Returns the reader handle, or 0 if data is not a ZIP archive.
+ */
+EMSCRIPTEN_KEEPALIVE
+zlib_unzip_t* zlib_unzip_open_memory(const unsigned char* data, unsigned long len) {
+    if (!data && len) return NULL;
+
+    zlib_unzip_t* reader = (zlib_unzip_t*)calloc(1, sizeof(zlib_unzip_t));
+    if (!reader) return NULL;
+
+    reader->mem.base = (unsigned char*)data;
+    reader->mem.size = len;
+    reader->mem.limit = len;
+
+    zlib_filefunc64_def memory;
+    fill_mem_filefunc64(&memory, &reader->mem);
+    reader->unz = unzOpenIndexed64("", &memory);
+    if (!reader->unz) {
+        free(reader);
+        return NULL;
+    }
+    return reader;
+}
+
+/**
+ * Number of entries in the archive
+ */
+EMSCRIPTEN_KEEPALIVE
+double zlib_unzip_count(zlib_unzip_t* reader) {
+    unz_global_info64 info;
+    if (!reader || unzGetGlobalInfo64(reader->unz, &info) != UNZ_OK) return -1;
+    return (double)info.number_entry;
+}
+
+/**
+ * Inflate the entry called name into a new heap buffer
+ * On success *out and *out_len receive the data, which the caller frees.
+ * Returns UNZ_OK, UNZ_END_OF_LIST_OF_FILE if there is no such entry, or
+ * another minizip error (UNZ_CRCERROR for corrupt data).
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_unzip_extract(zlib_unzip_t* reader, const char* name,
+                       unsigned char** out, unsigned long* out_len) {
+    if (!reader || !name || !out || !out_len) return UNZ_PARAMERROR;
+
+    int ret = unzLocateFileIndexed(reader->unz, name);
+    if (ret != UNZ_OK) return ret;
+    return extract_current(reader, out, out_len);
+}
+
+/**
+ * Describe the entry called name for inflating elsewhere
+ * entry receives five values: the offset of its data in the archive, the
+ * data's length, the uncompressed length, the CRC-32 and the method (0 for
+ * stored, 8 for deflated, 9 for Deflate64), ready for zlib_unzip_inflate().
+ * Returns UNZ_OK, UNZ_END_OF_LIST_OF_FILE if there is no such entry, or
+ * another minizip error.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_unzip_locate(zlib_unzip_t* reader, const char* name, unsigned long* entry) {
+    if (!reader || !name || !entry) return UNZ_PARAMERROR;
+
+    unz_file_data data;
+    int ret = locate_data(reader, name, &data);
+    if (ret != UNZ_OK) return ret;
+    if (data.uncompressed_size > 0x7fffffff || data.compressed_size > 0x7fffffff) {
+        return UNZ_PARAMERROR;
+    }
+
+    entry[0] = (unsigned long)data.pos_in_zipfile;
+    entry[1] = (unsigned long)data.compressed_size;
+    entry[2] = (unsigned long)data.uncompressed_size;
+    entry[3] = data.crc;
+    entry[4] = (unsigned long)data.compression_method;
+    return UNZ_OK;
+}
+
+/**
+ * Inflate one entry's data, as zlib_unzip_locate() describes it, into a new
+ * heap buffer, with no reader involved. On success *out and *out_len
+ * receive the data, which the caller frees.
+ * Returns UNZ_OK, UNZ_CRCERROR or Z_DATA_ERROR for corrupt data, or another
+ * minizip error.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_unzip_inflate(const unsigned char* src, unsigned long src_len,
+                       unsigned long len, unsigned long crc, int method,
+                       unsigned char** out, unsigned long* out_len) {
+    if ((!src && src_len) || !out || !out_len) return UNZ_PARAMERROR;
+    return inflate_data(src, src_len, len, crc, method, out, out_len);
+}
+
+// Output arrays of a batch, indexed like its names
+typedef struct {
+    zlib_unzip_t* reader;
+    unsigned char** out;
+    unsigned long* out_lens;
+} batch_t;
+
+static int extract_visit(voidpf opaque, unzFile unz, uLong i) {
+    batch_t* batch = (batch_t*)opaque;
+    (void)unz;
+    return extract_current(batch->reader, &batch->out[i], &batch->out_lens[i]);
+}
+
+/**
+ * Inflate the entries called names[0..count-1] into new heap buffers
+ * Entries are read in archive order rather than list order, so one pass
+ * goes front to back through the archive. out[i] and out_lens[i] receive
+ * names[i]'s data, which the caller frees, or NULL and 0 if there is no
+ * such entry. On failure every buffer is freed and out is all NULL.
+ * Returns UNZ_OK or the first minizip error.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_unzip_extract_batch(zlib_unzip_t* reader, const char* const* names,
+                             unsigned long count, unsigned char** out,
+                             unsigned long* out_lens) {
+    if (!reader || (count && (!names || !out || !out_lens))) return UNZ_PARAMERROR;
+
+    for (unsigned long i = 0; i < count; i++) {
+        out[i] = NULL;
+        out_lens[i] = 0;
+    }
+
+    batch_t batch = { reader, out, out_lens };
+    int ret = unzVisitFiles(reader->unz, names, count, extract_visit, &batch);
+    if (ret == UNZ_END_OF_LIST_OF_FILE) ret = UNZ_OK;
+
+    if (ret != UNZ_OK) {
+        for (unsigned long i = 0; i < count; i++) {
+            free(out[i]);
+            out[i] = NULL;
+            out_lens[i] = 0;
+        }
+    }
+    return ret;
+}
+
+/**
+ * Close the archive and free the handle; the archive bytes are the caller's
+ */
+EMSCRIPTEN_KEEPALIVE
+void zlib_unzip_close(zlib_unzip_t* reader) {
+    if (!reader) return;
+    unzClose(reader->unz);
+    free(reader);
+}
+
+#ifdef __EMSCRIPTEN_PTHREADS__
+
+typedef struct {
+    const unsigned char* base;      // the archive
+    const unz_file_data* entries;
+    const unsigned char* found;
+    unsigned char** out;
+    unsigned long* out_lens;
+    int* status;
+    unsigned long count;
+    unsigned long next;             // next entry to claim, under lock
+    pthread_mutex_t lock;
+} unzip_job_t;
+
+static void* unzip_worker(void* arg) {
+    unzip_job_t* job = (unzip_job_t*)arg;
+
+    for (;;) {
+        pthread_mutex_lock(&job->lock);
+        unsigned long i = job->next++;
+        pthread_mutex_unlock(&job->lock);
+
+        if (i >= job->count) break;
+        if (!job->found[i]) continue;
+
+        const unz_file_data* entry = &job->entries[i];
+        job->status[i] = inflate_data(job->base + entry->pos_in_zipfile,
+                                      (unsigned long)entry->compressed_size,
+                                      (unsigned long)entry->uncompressed_size,
+                                      entry->crc, entry->compression_method,
+                                      &job->out[i], &job->out_lens[i]);
+    }
+    return NULL;
+}
+
+/**
+ * zlib_unzip_extract_batch() on up to nthreads threads
+ * The entries are located first, then inflated concurrently straight from
+ * the archive bytes, which every thread reads and none writes.
+ * Returns UNZ_OK or the first error, in names order; on failure every
+ * buffer is freed and out is all NULL.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_unzip_extract_parallel(zlib_unzip_t* reader, const char* const* names,
+                                unsigned long count, unsigned char** out,
+                                unsigned long* out_lens, int nthreads) {
+    if (!reader || (count && (!names || !out || !out_lens))) return UNZ_PARAMERROR;
+    if (count == 0) return UNZ_OK;
+
+    unzip_job_t job;
+    memset(&job, 0, sizeof(job));
+    unz_file_data* entries = (unz_file_data*)calloc(count, sizeof(unz_file_data));
+    unsigned char* found = (unsigned char*)calloc(count, 1);
+    int* status = (int*)calloc(count, sizeof(int));
+    if (!entries || !found || !status) {
+        free(entries);
+        free(found);
+        free(status);
+        return UNZ_INTERNALERROR;
+    }
+
+    int ret = UNZ_OK;
+    for (unsigned long i = 0; i < count; i++) {
+        out[i] = NULL;
+        out_lens[i] = 0;
+        if (ret != UNZ_OK || !names[i]) continue;
+
+        int located = locate_data(reader, names[i], &entries[i]);
+        if (located == UNZ_OK) found[i] = 1;
+        else if (located != UNZ_END_OF_LIST_OF_FILE) ret = located;
+    }
+
+    if (ret == UNZ_OK) {
+        job.base = reader->mem.base;
+        job.entries = entries;
+        job.found = found;
+        job.out = out;
+        job.out_lens = out_lens;
+        job.status = status;
+        job.count = count;
+        pthread_mutex_init(&job.lock, NULL);
+
+        if (nthreads < 1) nthreads = 1;
+        if (nthreads > UNZIP_MAX_THREADS) nthreads = UNZIP_MAX_THREADS;
+        if ((unsigned long)nthreads > count) nthreads = (int)count;
+
+        // The calling thread inflates alongside its helpers
+        pthread_t threads[UNZIP_MAX_THREADS];
+        int started = 0;
+        while (started < nthreads - 1 &&
+               pthread_create(&threads[started], NULL, unzip_worker, &job) == 0) {
+            started++;
+        }
+        unzip_worker(&job);
+        for (int t = 0; t < started; t++) {
+            pthread_join(threads[t], NULL);
+        }
+        pthread_mutex_destroy(&job.lock);
+
+        for (unsigned long i = 0; i < count && ret == UNZ_OK; i++) ret = status[i];
+    }
+
+    if (ret != UNZ_OK) {
+        for (unsigned long i = 0; i < count; i++) {
+            free(out[i]);
+            out[i] = NULL;
+            out_lens[i] = 0;
+        }
+    }
+    free(entries);
+    free(found);
+    free(status);
+    return ret;
+}
+
+#endif /* __EMSCRIPTEN_PTHREADS__ */
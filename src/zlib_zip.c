@@ -0,0 +1,427 @@
+/**
+ * zlib.wasm - ZIP archive writer
+ *
+ * Copyright 2025 Superstruct Ltd, New Zealand
+ *
+ * This source code is licensed under the Zlib license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Thin layer over contrib/minizip's zip.c. Every entry is deflated on its
+ * own to raw deflate data plus a CRC-32, then handed to
+ * zipWriteRawFileInZip64(), which only writes the local header, the data
+ * and the central directory record. Deflating is therefore independent of
+ * the writer: zlib_zip_add() does it inline, while the Web Worker pool
+ * (Zlib.createZip() in src/lib/index.ts) and, in the -pthread build,
+ * zlib_zip_add_parallel() deflate many entries at once and pass the
+ * finished data to the writer in order.
+ *
+ * Archives are built in memory through contrib/minizip/iomem.c, so the
+ * bytes go straight from the heap to the caller with no file system in
+ * between; zlib_zip_open() still writes to a path for callers that want a
+ * file.
+ *
+ * zlib_zip_open_stream() writes every entry with a data descriptor
+ * (general purpose bit 3), so zip.c never seeks back to patch a local
+ * header, and the caller takes the output in pieces with zlib_zip_take()
+ * as it is written, e.g. into an HTTP response. Only the bytes since the
+ * last take are held, and zlib_zip_begin()/zlib_zip_write()/zlib_zip_end()
+ * add an entry of any size a chunk at a time, so memory use does not grow
+ * with the archive.
+ */
+
+#include <emscripten.h>
+#include <stdlib.h>
+#include <string.h>
+#include "zlib.h"
+#include "zip.h"
+#include "iomem.h"
+
+#ifdef __EMSCRIPTEN_PTHREADS__
+#include <pthread.h>
+#define ZIP_MAX_THREADS 32
+#endif
+
+// General purpose flag bit 11: names are UTF-8, which is what JS passes in
+#define ZIP_FLAG_UTF8 0x800
+// Bit 3: CRC-32 and sizes follow the data, for output that cannot seek
+#define ZIP_FLAG_DESCRIPTOR 0x8
+
+// Defined in wasm_module.c
+int zlib_compress_block(const unsigned char* src, unsigned long src_len,
+                        const unsigned char* dict, unsigned long dict_len,
+                        unsigned char* dest, unsigned long* dest_len,
+                        int level, int last);
+unsigned long zlib_compress_block_bound(unsigned long source_len);
+
+// A writer handle: the minizip archive and, for in-memory archives, its bytes
+typedef struct {
+    zipFile zip;
+    mem_file mem;
+    int in_memory;
+    mem_sink sink;                  // output not yet taken, when streaming
+    int streaming;
+} zlib_zip_t;
+
+static uLong entry_flags(const zlib_zip_t* zip) {
+    return ZIP_FLAG_UTF8 | (zip->streaming ? ZIP_FLAG_DESCRIPTOR : 0);
+}
+
+typedef struct {
+    unsigned char* data;            // raw deflate data, or NULL to store
+    unsigned long len;
+    unsigned long crc;
+    int status;
+} zip_entry_t;
+
+/*
+ * Deflate one entry. Entries that do not shrink, and level 0, are stored,
+ * as ZIP archivers do.
+ */
+static void deflate_entry(const unsigned char* src, unsigned long len,
+                          int level, zip_entry_t* entry) {
+    entry->data = NULL;
+    entry->len = len;
+    entry->crc = crc32(0L, src, (uInt)len);
+    entry->status = Z_OK;
+    if (level == 0 || len == 0) return;
+
+    unsigned long out_len = zlib_compress_block_bound(len);
+    unsigned char* out = (unsigned char*)malloc(out_len);
+    if (!out) {
+        entry->status = Z_MEM_ERROR;
+        return;
+    }
+
+    int ret = zlib_compress_block(src, len, NULL, 0, out, &out_len, level, 1);
+    if (ret != Z_OK) {
+        free(out);
+        entry->status = ret;
+    } else if (out_len >= len) {
+        free(out);
+    } else {
+        entry->data = out;
+        entry->len = out_len;
+    }
+}
+
+static int write_entry(zlib_zip_t* zip, const char* name, const unsigned char* src,
+                       unsigned long len, int level, unsigned long dos_date,
+                       const zip_entry_t* entry) {
+    if (entry->status != Z_OK) return entry->status;
+
+    zip_fileinfo info;
+    memset(&info, 0, sizeof(info));
+    info.dosDate = dos_date;
+
+    return zipWriteRawFileInZip64(zip->zip, name, &info,
+                                  entry->data ? entry->data : src, entry->len, len,
+                                  entry->crc, entry->data ? Z_DEFLATED : 0,
+                                  level, entry_flags(zip));
+}
+
+/**
+ * Create a ZIP archive at path in the module's file system
+ * Returns the writer handle, or 0 on failure.
+ */
+EMSCRIPTEN_KEEPALIVE
+zlib_zip_t* zlib_zip_open(const char* path) {
+    if (!path) return NULL;
+
+    zlib_zip_t* zip = (zlib_zip_t*)calloc(1, sizeof(zlib_zip_t));
+    if (!zip) return NULL;
+    zip->zip = zipOpen2_64(path, APPEND_STATUS_CREATE, NULL, NULL);
+    if (!zip->zip) {
+        free(zip);
+        return NULL;
+    }
+    return zip;
+}
+
+/**
+ * Create a ZIP archive in a heap buffer that grows as entries are added
+ * capacity is the initial allocation, e.g. an estimate of the archive size,
+ * or 0. zlib_zip_close() hands the finished archive to the caller.
+ * Returns the writer handle, or 0 on failure.
+ */
+EMSCRIPTEN_KEEPALIVE
+zlib_zip_t* zlib_zip_open_memory(unsigned long capacity) {
+    zlib_zip_t* zip = (zlib_zip_t*)calloc(1, sizeof(zlib_zip_t));
+    if (!zip) return NULL;
+
+    if (capacity) {
+        zip->mem.base = (unsigned char*)malloc(capacity);
+        zip->mem.limit = zip->mem.base ? capacity : 0;
+    }
+    zip->mem.grow = 1;
+    zip->in_memory = 1;
+
+    zlib_filefunc64_def memory;
+    fill_mem_filefunc64(&memory, &zip->mem);
+    zip->zip = zipOpen2_64("", APPEND_STATUS_CREATE, NULL, &memory);
+    if (!zip->zip) {
+        free(zip->mem.base);
+        free(zip);
+        return NULL;
+    }
+    return zip;
+}
+
+/**
+ * Create a ZIP archive that is written out as it goes: zlib_zip_take()
+ * collects what has been written so far, and zlib_zip_close() the rest
+ * Returns the writer handle, or 0 on failure.
+ */
+EMSCRIPTEN_KEEPALIVE
+zlib_zip_t* zlib_zip_open_stream(void) {
+    zlib_zip_t* zip = (zlib_zip_t*)calloc(1, sizeof(zlib_zip_t));
+    if (!zip) return NULL;
+    zip->streaming = 1;
+
+    zlib_filefunc64_def sink;
+    fill_mem_sink_filefunc64(&sink, &zip->sink);
+    zip->zip = zipOpen2_64("", APPEND_STATUS_CREATE, NULL, &sink);
+    if (!zip->zip) {
+        free(zip->sink.base);
+        free(zip);
+        return NULL;
+    }
+    return zip;
+}
+
+/**
+ * Hand over the output a streaming archive has written since the last take
+ * *out and *out_len receive it, which the caller frees; *out is 0 when
+ * nothing is pending.
+ * Returns ZIP_OK, or ZIP_PARAMERROR if zip is not streaming.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_zip_take(zlib_zip_t* zip, unsigned char** out, unsigned long* out_len) {
+    if (!zip || !zip->streaming || !out || !out_len) return ZIP_PARAMERROR;
+
+    *out = zip->sink.base;
+    *out_len = (unsigned long)zip->sink.size;
+    zip->sink.taken += zip->sink.size;
+    zip->sink.base = NULL;
+    zip->sink.size = 0;
+    zip->sink.limit = 0;
+    return ZIP_OK;
+}
+
+/**
+ * Start an entry whose data arrives through zlib_zip_write(), deflated
+ * (stored at level 0) as it comes; zlib_zip_end() finishes it
+ * Set zip64 if the entry may reach 4 GB; a streaming archive cannot go back
+ * and add the room for its sizes afterwards.
+ * Returns ZIP_OK or a minizip error code.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_zip_begin(zlib_zip_t* zip, const char* name, int level,
+                   unsigned long dos_date, int zip64) {
+    if (!zip || !name) return ZIP_PARAMERROR;
+    if (level < 0 || level > Z_ULTRA_COMPRESSION) level = Z_DEFAULT_COMPRESSION;
+
+    zip_fileinfo info;
+    memset(&info, 0, sizeof(info));
+    info.dosDate = dos_date;
+
+    // Version made by 0 (MS-DOS), as zip.c's own entry points write
+    return zipOpenNewFileInZip4_64(zip->zip, name, &info, NULL, 0, NULL, 0, NULL,
+                                   level ? Z_DEFLATED : 0, level, 0, -MAX_WBITS,
+                                   DEF_MEM_LEVEL, Z_DEFAULT_STRATEGY, NULL, 0, 0,
+                                   entry_flags(zip), zip64);
+}
+
+/**
+ * Add data[0..len-1] to the entry started by zlib_zip_begin()
+ * Returns ZIP_OK or a minizip or zlib error code.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_zip_write(zlib_zip_t* zip, const unsigned char* data, unsigned long len) {
+    if (!zip || (!data && len)) return ZIP_PARAMERROR;
+    return zipWriteInFileInZip(zip->zip, data, (unsigned)len);
+}
+
+/**
+ * Finish the entry started by zlib_zip_begin()
+ * Returns ZIP_OK or a minizip error code.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_zip_end(zlib_zip_t* zip) {
+    if (!zip) return ZIP_PARAMERROR;
+    return zipCloseFileInZip(zip->zip);
+}
+
+/**
+ * Add an entry whose data is already compressed: raw deflate data for
+ * method 8, or the bytes themselves for method 0. len and crc describe the
+ * uncompressed data; level only sets the entry's deflate option flags.
+ * Returns ZIP_OK or a minizip error code.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_zip_add_deflated(zlib_zip_t* zip, const char* name,
+                          const unsigned char* data, unsigned long data_len,
+                          unsigned long len, unsigned long crc,
+                          int method, int level, unsigned long dos_date) {
+    if (!zip || !name || (!data && data_len)) return ZIP_PARAMERROR;
+
+    zip_fileinfo info;
+    memset(&info, 0, sizeof(info));
+    info.dosDate = dos_date;
+
+    return zipWriteRawFileInZip64(zip->zip, name, &info, data, data_len, len, crc,
+                                  method, level, entry_flags(zip));
+}
+
+/**
+ * Deflate data and add it as one entry, stored if it does not shrink
+ * Returns ZIP_OK, a zlib error from deflating, or a minizip error code.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_zip_add(zlib_zip_t* zip, const char* name, const unsigned char* data,
+                 unsigned long len, int level, unsigned long dos_date) {
+    if (!zip || !name || (!data && len)) return ZIP_PARAMERROR;
+    if (level < 0 || level > Z_ULTRA_COMPRESSION) level = Z_DEFAULT_COMPRESSION;
+
+    zip_entry_t entry;
+    deflate_entry(data, len, level, &entry);
+    int ret = write_entry(zip, name, data, len, level, dos_date, &entry);
+    free(entry.data);
+    return ret;
+}
+
+/**
+ * Write the central directory, close the archive and free the handle
+ * comment may be NULL. For an in-memory archive *out and *out_len receive
+ * the archive, and for a streaming one the output not yet taken, which the
+ * caller frees; pass NULL for out to discard it.
+ * Returns ZIP_OK or a minizip error code.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_zip_close(zlib_zip_t* zip, const char* comment,
+                   unsigned char** out, unsigned long* out_len) {
+    if (!zip) return ZIP_PARAMERROR;
+
+    int ret = zipClose(zip->zip, comment);
+    if (ret == ZIP_OK && zip->in_memory && out && out_len) {
+        *out = zip->mem.base;
+        *out_len = (unsigned long)zip->mem.size;
+    } else if (ret == ZIP_OK && zip->streaming && out && out_len) {
+        zlib_zip_take(zip, out, out_len);
+    } else {
+        free(zip->mem.base);
+        free(zip->sink.base);
+    }
+    free(zip);
+    return ret;
+}
+
+#ifdef __EMSCRIPTEN_PTHREADS__
+
+typedef struct {
+    const unsigned char* const* data;
+    const unsigned long* lens;
+    zip_entry_t* entries;
+    unsigned long count;
+    unsigned long next;             // next entry to claim, under lock
+    unsigned char* done;            // per entry, under lock
+    pthread_mutex_t lock;
+    pthread_cond_t finished;
+    int level;
+} zip_job_t;
+
+static void* zip_worker(void* arg) {
+    zip_job_t* job = (zip_job_t*)arg;
+
+    for (;;) {
+        pthread_mutex_lock(&job->lock);
+        unsigned long i = job->next++;
+        pthread_mutex_unlock(&job->lock);
+
+        if (i >= job->count) break;
+        deflate_entry(job->data[i], job->lens[i], job->level, &job->entries[i]);
+
+        pthread_mutex_lock(&job->lock);
+        job->done[i] = 1;
+        pthread_cond_broadcast(&job->finished);
+        pthread_mutex_unlock(&job->lock);
+    }
+    return NULL;
+}
+
+/**
+ * Deflate count entries on up to nthreads threads and add them in order
+ * names, data, lens and dos_dates are parallel arrays. The calling thread
+ * writes each entry as soon as it and every entry before it are done, so
+ * the archive grows while later entries are still being compressed.
+ * Returns ZIP_OK or the first error; entries after a failure are not added.
+ */
+EMSCRIPTEN_KEEPALIVE
+int zlib_zip_add_parallel(zlib_zip_t* zip, const char* const* names,
+                          const unsigned char* const* data, const unsigned long* lens,
+                          const unsigned long* dos_dates, unsigned long count,
+                          int level, int nthreads) {
+    if (!zip || (count && (!names || !data || !lens || !dos_dates))) return ZIP_PARAMERROR;
+    if (count == 0) return ZIP_OK;
+    if (level < 0 || level > Z_ULTRA_COMPRESSION) level = Z_DEFAULT_COMPRESSION;
+
+    zip_job_t job;
+    memset(&job, 0, sizeof(job));
+    job.data = data;
+    job.lens = lens;
+    job.count = count;
+    job.level = level;
+    job.entries = (zip_entry_t*)calloc(count, sizeof(zip_entry_t));
+    job.done = (unsigned char*)calloc(count, 1);
+    if (!job.entries || !job.done) {
+        free(job.entries);
+        free(job.done);
+        return Z_MEM_ERROR;
+    }
+    pthread_mutex_init(&job.lock, NULL);
+    pthread_cond_init(&job.finished, NULL);
+
+    if (nthreads < 1) nthreads = 1;
+    if (nthreads > ZIP_MAX_THREADS) nthreads = ZIP_MAX_THREADS;
+    if ((unsigned long)nthreads > count) nthreads = (int)count;
+
+    // The calling thread is the writer; it only deflates if no helper starts
+    pthread_t threads[ZIP_MAX_THREADS];
+    int started = 0;
+    while (started < nthreads &&
+           pthread_create(&threads[started], NULL, zip_worker, &job) == 0) {
+        started++;
+    }
+    if (started == 0) zip_worker(&job);
+
+    int ret = ZIP_OK;
+    for (unsigned long i = 0; i < count; i++) {
+        pthread_mutex_lock(&job.lock);
+        while (!job.done[i]) pthread_cond_wait(&job.finished, &job.lock);
+        pthread_mutex_unlock(&job.lock);
+
+        if (ret == ZIP_OK) {
+            ret = write_entry(zip, names[i], data[i], lens[i], level, dos_dates[i],
+                              &job.entries[i]);
+        }
+        free(job.entries[i].data);
+
+        // After a failure, entries nobody has claimed yet are skipped
+        if (ret != ZIP_OK) {
+            pthread_mutex_lock(&job.lock);
+            for (unsigned long j = job.next; j < count; j++) job.done[j] = 1;
+            if (job.next < count) job.next = count;
+            pthread_mutex_unlock(&job.lock);
+        }
+    }
+
+    for (int t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    pthread_cond_destroy(&job.finished);
+    pthread_mutex_destroy(&job.lock);
+    free(job.entries);
+    free(job.done);
+    return ret;
+}
+
+#endif /* __EMSCRIPTEN_PTHREADS__ */
@@ -64,10 +64,13 @@ Deno.test("Enum values", async () => {
   assertEquals(ZlibCompression.BEST_SPEED, 1);
   assertEquals(ZlibCompression.DEFAULT_COMPRESSION, 6);
   assertEquals(ZlibCompression.BEST_COMPRESSION, 9);
+  assertEquals(ZlibCompression.ULTRA_COMPRESSION, 10);
 
   assertEquals(ZlibStrategy.DEFAULT_STRATEGY, 0);
   assertEquals(ZlibStrategy.FILTERED, 1);
   assertEquals(ZlibStrategy.HUFFMAN_ONLY, 2);
+  assertEquals(ZlibStrategy.QUICK, 5);
+  assertEquals(ZlibStrategy.MEDIUM, 6);
 });
 
 Deno.test("Error classes inheritance", async () => {
@@ -1,5 +1,10 @@
 import { assert, assertEquals, assertRejects, assertExists, assertThrows } from "@std/assert";
-import Zlib, { ZlibError, ZlibInitError, ZlibCompressionError, ZlibCompression, ZlibStrategy } from "../../src/lib/index.ts";
+import { ZlibInflate } from "../../src/lib/inflate.ts";
+import { ZlibDeflate } from "../../src/lib/deflate.ts";
+import { wrapMemory64 } from "../../src/lib/memory64.ts";
+import { HeapBufferPool } from "../../src/lib/heap.ts";
+import { nodeZlib } from "../../src/lib/node.ts";
+import Zlib, { ZlibCore, ZlibError, ZlibInitError, ZlibMemoryError, ZlibCompressionError, ZlibLimitError, ZlibCompression, ZlibStrategy, MemoryLogStorage } from "../../src/lib/index.ts";
 
 Deno.test("Zlib initialization without WASM", async () => {
   const zlib = new Zlib();
@@ -41,6 +46,252 @@ Deno.test("Zlib initialization with mock WASM (if available)", async () => {
   }
 });
 
+Deno.test("Compiled module is shared between instances (if WASM available)", async () => {
+  const first = new Zlib();
+  const second = new Zlib();
+
+  try {
+    await first.initialize();
+    await second.initialize();
+    assert(first.wasmModule === second.wasmModule, "The binary should be compiled once per realm");
+
+    // As a worker would start from a posted module
+    const third = new Zlib({ wasmModule: first.wasmModule, cdnUrl: "https://invalid.example/" });
+    await third.initialize();
+    assert(third.wasmModule === first.wasmModule);
+    const data = new TextEncoder().encode("shared module ".repeat(100));
+    assertEquals((await third.decompress((await first.compress(data)).data)).data, data);
+
+    third.cleanup();
+    second.cleanup();
+    first.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Inflate-only core loads the full module on first compress (if WASM available)", async () => {
+  const core = new ZlibCore();
+
+  try {
+    await core.initialize();
+
+    const data = new TextEncoder().encode("decompressed on the core ".repeat(200));
+    const full = await core.full();
+    assert(full === await core.full(), "The full module should load once");
+
+    const compressed = await core.compress(data, { level: 9 });
+    assertEquals((await core.decompress(compressed.data)).data, data);
+    assertEquals(core.crc32(data), full.crc32(data));
+    assertEquals(core.adler32(data), full.adler32(data));
+
+    core.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Slim inflate and deflate builds round-trip (if WASM available)", async () => {
+  const deflate = new ZlibDeflate();
+  const inflate = new ZlibInflate();
+
+  try {
+    await deflate.initialize();
+    await inflate.initialize();
+
+    const data = new TextEncoder().encode("split between two builds ".repeat(300));
+    const compressed = deflate.compress(data, { level: 6 });
+    assertEquals(inflate.decompress(compressed), data);
+    assertEquals(inflate.decompress(compressed, { expectedSize: data.length }), data);
+    assertEquals(deflate.crc32(data), inflate.crc32(data));
+    assertEquals(deflate.adler32(data), inflate.adler32(data));
+
+    const streamed = await new Response(
+      new Blob([data]).stream().pipeThrough(deflate.createDeflateStream())
+    ).arrayBuffer();
+    assertEquals(inflate.decompress(new Uint8Array(streamed)), data);
+
+    deflate.cleanup();
+    inflate.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Memory budget streams oversized calls and recycle() resets the heap (if WASM available)", async () => {
+  // Below the initial heap, so every call has to stream
+  const zlib = new Zlib({ maxMemoryMB: 1 });
+
+  try {
+    await zlib.initialize();
+
+    const data = new TextEncoder().encode("kept within budget ".repeat(20000));
+    const compressed = await zlib.compress(data, { level: 6 });
+    assertEquals((await zlib.decompress(compressed.data)).data, data);
+
+    const usage = zlib.memoryUsage();
+    assertEquals(usage.streamedCalls, 2);
+    assertEquals(usage.budgetBytes, 1024 * 1024);
+    assert(usage.overBudget);
+    assert(usage.highWaterBytes >= usage.heapBytes);
+
+    const dictionary = zlib.loadDictionary(new TextEncoder().encode("kept within"));
+    await assertRejects(() => zlib.compress(data, { dictionary }), ZlibMemoryError);
+
+    await zlib.recycle();
+    assertEquals(zlib.memoryUsage().recycles, 1);
+    assertEquals((await zlib.decompress(compressed.data)).data, data);
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("memory64 exports take numbers and length cells are 64-bit", () => {
+  const heap = new ArrayBuffer(64);
+  // i64 arguments arrive as BigInt, as a wasm64 module requires
+  const module = wrapMemory64({
+    HEAPU8: new Uint8Array(heap),
+    HEAP32: new Int32Array(heap),
+    _malloc: (size: bigint) => {
+      assertEquals(typeof size, "bigint");
+      return 16n;
+    },
+    _free: (ptr: bigint) => assertEquals(typeof ptr, "bigint"),
+    _zlib_crc32: (crc: bigint, _ptr: bigint, len: bigint) => crc + len,
+    _zlib_inflate_init: (windowBits: number) => BigInt(windowBits),
+  } as any);
+
+  assertEquals(module._zlib_crc32(1, 16, 5), 6);
+  assertEquals(module._zlib_inflate_init(47), 47);
+
+  const pool = new HeapBufferPool(module);
+  pool.length = 6 * 2 ** 32 + 7;
+  assertEquals(pool.length, 6 * 2 ** 32 + 7);
+  assertEquals(new Int32Array(heap)[pool.lengthPtr / 4 + 1], 6);
+  pool.dispose();
+});
+
+Deno.test("memory64 build round-trips (if WASM available)", async () => {
+  const zlib = new Zlib({ memory64: true });
+
+  try {
+    await zlib.initialize();
+
+    const data = new TextEncoder().encode("sixty-four bit lengths ".repeat(500));
+    const compressed = await zlib.compress(data);
+    assertEquals((await zlib.decompress(compressed.data)).data, data);
+    assertEquals((await zlib.decompress(compressed.data, { expectedSize: data.length })).data, data);
+    assertEquals(zlib.crc32(new TextEncoder().encode("123456789")), 0xcbf43926);
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Concatenated gzip members decode in one call (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const encoder = new TextEncoder();
+    const parts = ["first member ".repeat(400), "second member ".repeat(900), "third"].map(text => encoder.encode(text));
+    const members = await Promise.all(parts.map(async part =>
+      new Uint8Array(await new Response(new Blob([part]).stream().pipeThrough(new CompressionStream("gzip"))).arrayBuffer())
+    ));
+
+    const joined = new Uint8Array(members.reduce((n, member) => n + member.length, 0));
+    let offset = 0;
+    for (const member of members) {
+      joined.set(member, offset);
+      offset += member.length;
+    }
+    const expected = encoder.encode(parts.map(part => new TextDecoder().decode(part)).join(""));
+
+    assertEquals((await zlib.decompress(joined)).data, expected);
+    assertEquals((await zlib.decompress(joined, { expectedSize: expected.length })).data, expected);
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("One-shot compress writes gzip and raw deflate (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const input = new TextEncoder().encode("gzip and raw deflate from one call. ".repeat(300));
+    const inflate = async (data: Uint8Array, format: CompressionFormat) =>
+      new Uint8Array(await new Response(new Blob([data]).stream().pipeThrough(new DecompressionStream(format))).arrayBuffer());
+
+    const gzip = await zlib.compress(input, { format: "gzip", header: { name: "data.txt", mtime: 1700000000 } });
+    assertEquals([gzip.data[0], gzip.data[1]], [0x1f, 0x8b]);
+    assertEquals(gzip.data[3] & 0x08, 0x08);
+    assertEquals(new DataView(gzip.data.buffer).getUint32(4, true), 1700000000);
+    assertEquals(gzip.checksum, zlib.crc32(input));
+    assertEquals(await inflate(gzip.data, "gzip"), input);
+    assertEquals((await zlib.decompress(gzip.data)).data, input);
+
+    const raw = await zlib.compress(input, { format: "raw" });
+    assertEquals(raw.checksum, 0);
+    assertEquals(await inflate(raw.data, "deflate-raw"), input);
+
+    const plain = await zlib.compress(input, { windowBits: 12 });
+    assertEquals(plain.checksum, zlib.adler32(input));
+    assertEquals((await zlib.decompress(plain.data)).data, input);
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Rsyncable compression (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    // Words in a shifting order, so boundaries land all over the input
+    const words = ["alpha", "beta", "gamma", "delta", "epsilon", "zeta", "eta", "theta"];
+    let seed = 1;
+    const text = Array.from({ length: 60000 }, () => {
+      seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+      return words[seed % words.length];
+    }).join(" ");
+    const input = new TextEncoder().encode(text);
+    const edited = new TextEncoder().encode(text.slice(0, 1000) + "an edit " + text.slice(1000));
+
+    const a = (await zlib.compress(input, { format: "raw", rsyncable: true })).data;
+    const b = (await zlib.compress(edited, { format: "raw", rsyncable: true })).data;
+    const inflated = new Response(new Blob([a]).stream().pipeThrough(new DecompressionStream("deflate-raw")));
+    assertEquals(new Uint8Array(await inflated.arrayBuffer()), input);
+
+    // Past the boundary after the edit, both streams carry the same bytes
+    let shared = 0;
+    while (shared < Math.min(a.length, b.length) && a[a.length - 1 - shared] === b[b.length - 1 - shared]) shared++;
+    assert(shared > a.length * 0.9, `only ${shared} of ${a.length} trailing bytes shared`);
+
+    const zlibStream = await zlib.compress(input, { rsyncable: true });
+    assertEquals((await zlib.decompress(zlibStream.data)).data, input);
+
+    const streamed = new Uint8Array(await new Response(
+      new Blob([input]).stream().pipeThrough(zlib.createDeflateStream({ rsyncable: true }))
+    ).arrayBuffer());
+    assertEquals((await zlib.decompress(streamed)).data, input);
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
 Deno.test("Compression and decompression (if WASM available)", async () => {
   const zlib = new Zlib();
 
@@ -179,4 +430,1564 @@ Deno.test("Configuration options", () => {
     cachingEnabled: false
   });
   assertExists(configuredZlib);
-});
\ No newline at end of file
+});
+Deno.test("Zero-copy heap buffer roundtrip (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const testData = new TextEncoder().encode("heap buffer payload ".repeat(50));
+    const input = zlib.acquireBuffer(testData.length).write(testData);
+
+    const compressed = zlib.compressHeap(input, { level: 6 });
+    assert(compressed.length > 0 && compressed.length < testData.length, "Should compress in place");
+
+    const output = zlib.acquireBuffer(testData.length);
+    zlib.decompressHeap(compressed, output);
+    assertEquals(output.view, testData, "Heap roundtrip should restore the input");
+
+    // Released regions are reused for the same size class
+    zlib.releaseBuffer(input);
+    const reused = zlib.acquireBuffer(testData.length);
+    assertEquals(reused.ptr, input.ptr, "Pool should hand back the released region");
+
+    zlib.releaseBuffer(reused);
+    zlib.releaseBuffer(compressed);
+    zlib.releaseBuffer(output);
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Exact-size decompression with size hints and gzip input (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const testData = new TextEncoder().encode("sized output ".repeat(4000));
+    const compressed = await zlib.compress(testData);
+
+    // Exact hint, a hint that is far too small, and no hint at all
+    for (const expectedSize of [testData.length, 16, undefined]) {
+      const result = await zlib.decompress(compressed.data, { expectedSize });
+      assertEquals(result.data, testData, `Hint ${expectedSize} should still roundtrip`);
+    }
+
+    // gzip input is detected and sized from its ISIZE trailer
+    const gzipped = new Uint8Array(
+      await new Response(
+        new Blob([testData]).stream().pipeThrough(new CompressionStream("gzip"))
+      ).arrayBuffer()
+    );
+    const gunzipped = await zlib.decompress(gzipped);
+    assertEquals(gunzipped.data, testData, "gzip input should decompress");
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Deflate/inflate TransformStream roundtrip (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const testData = new TextEncoder().encode("streamed through zlib ".repeat(20000));
+    const source = () =>
+      new ReadableStream<Uint8Array>({
+        start(controller) {
+          for (let i = 0; i < testData.length; i += 10000) {
+            controller.enqueue(testData.subarray(i, i + 10000));
+          }
+          controller.close();
+        }
+      });
+
+    // Small staging buffers force many process calls per chunk
+    const compressed = new Uint8Array(
+      await new Response(
+        source().pipeThrough(zlib.createDeflateStream({ level: 6, chunkSize: 1024 }))
+      ).arrayBuffer()
+    );
+    assert(compressed.length < testData.length, "Stream should compress");
+
+    const oneShot = await zlib.decompress(compressed);
+    assertEquals(oneShot.data, testData, "Streamed output should be a valid zlib stream");
+
+    const restored = new Uint8Array(
+      await new Response(
+        new Blob([compressed]).stream().pipeThrough(zlib.createInflateStream({ chunkSize: 1024 }))
+      ).arrayBuffer()
+    );
+    assertEquals(restored, testData, "Inflate stream should restore the input");
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Deflate stream coalesces small chunks and splits large ones (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const testData = new TextEncoder().encode("fragment of a network read ".repeat(40000));
+    const pipe = async (size: number) => {
+      const slices: number[] = [];
+      const source = new ReadableStream<Uint8Array>({
+        start(controller) {
+          for (let i = 0; i < testData.length; i += size) {
+            controller.enqueue(testData.subarray(i, i + size));
+          }
+          controller.close();
+        }
+      });
+      const compressed = new Uint8Array(
+        await new Response(
+          source.pipeThrough(zlib.createDeflateStream({ onChunk: timing => slices.push(timing.inputBytes) }))
+        ).arrayBuffer()
+      );
+      assertEquals((await zlib.decompress(compressed)).data, testData, `${size} B chunks should roundtrip`);
+      assertEquals(slices.reduce((a, b) => a + b, 0), testData.length, "Every byte should cross once");
+      return slices;
+    };
+
+    // 40-byte writes gather into 64 KB slices, plus the final partial one
+    const small = await pipe(40);
+    assertEquals(small.length, Math.ceil(testData.length / (64 * 1024)) + (testData.length % (64 * 1024) ? 0 : 1));
+    assert(small.slice(0, -1).every(n => n === 64 * 1024), "Whole slices until the end");
+
+    // One 1 MB write is split into slices of at most 256 KB
+    const large = await pipe(1024 * 1024);
+    assert(large.every(n => n <= 256 * 1024), "Large chunks should be split");
+    assertEquals(large[0], 256 * 1024, "The slice should grow to the chunk size");
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Quick strategy deflate stream (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const testData = new TextEncoder().encode(
+      Array.from({ length: 4000 }, (_, i) => `{"id":${i},"event":"ingest","ok":${i % 3 === 0}}\n`).join("")
+    );
+    const compressed = new Uint8Array(
+      await new Response(
+        new Blob([testData]).stream().pipeThrough(
+          zlib.createDeflateStream({ level: 1, strategy: ZlibStrategy.QUICK, chunkSize: 4096 })
+        )
+      ).arrayBuffer()
+    );
+    assert(compressed.length < testData.length / 2, "Quick strategy should still find matches");
+
+    const restored = await zlib.decompress(compressed);
+    assertEquals(restored.data, testData, "Quick output should be a standard zlib stream");
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Medium strategy deflate stream (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const testData = new TextEncoder().encode(
+      Array.from({ length: 4000 }, (_, i) => `<li class="item-${i % 7}">Asset ${i}</li>\n`).join("")
+    );
+    const deflate = (strategy: ZlibStrategy) =>
+      new Response(
+        new Blob([testData]).stream().pipeThrough(zlib.createDeflateStream({ level: 6, strategy }))
+      ).arrayBuffer().then((buffer) => new Uint8Array(buffer));
+
+    const medium = await deflate(ZlibStrategy.MEDIUM);
+    const lazy = await deflate(ZlibStrategy.DEFAULT_STRATEGY);
+    assert(medium.length < lazy.length * 1.05, "Medium should stay close to the lazy ratio");
+
+    const restored = await zlib.decompress(medium);
+    assertEquals(restored.data, testData, "Medium output should be a standard zlib stream");
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Ultra compression level (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const testData = new TextEncoder().encode(
+      Array.from({ length: 4000 }, (_, i) => `<li class="item-${i % 7}">Asset ${i * 37 % 1000}</li>\n`).join("")
+    );
+    const best = await zlib.compress(testData, { level: ZlibCompression.BEST_COMPRESSION });
+    const ultra = await zlib.compress(testData, { level: ZlibCompression.ULTRA_COMPRESSION });
+    assert(ultra.compressedSize < best.compressedSize, "Ultra should beat level 9");
+
+    const restored = await zlib.decompress(ultra.data);
+    assertEquals(restored.data, testData, "Ultra output should be a standard zlib stream");
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("RLE and Huffman-only strategies round-trip runs and literals (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    // Filtered image rows: runs of every length around the 16-byte vector
+    // width and the 258-byte match limit, then a noisy telemetry tail
+    const rows = new Uint8Array(300 * 1024);
+    let offset = 0;
+    for (let run = 1; offset < 200 * 1024; run = run % 300 + 1) {
+      rows.fill(run & 7, offset, Math.min(offset + run, rows.length));
+      offset += run;
+    }
+    for (; offset < rows.length; offset++) rows[offset] = 128 + Math.round(20 * Math.sin(offset / 50)) + offset % 3;
+
+    for (const strategy of [ZlibStrategy.RLE, ZlibStrategy.HUFFMAN_ONLY]) {
+      const compressed = await zlib.compress(rows, { strategy });
+      assert(compressed.data.length < rows.length / 2, `Strategy ${strategy} should compress the rows`);
+      assertEquals((await zlib.decompress(compressed.data)).data, rows);
+    }
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Incompressible stretches are passed through as stored blocks (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const random = new Uint8Array(1024 * 1024);
+    for (let i = 0; i < random.length; i += 65536) crypto.getRandomValues(random.subarray(i, i + 65536));
+    const stored = await zlib.compress(random, { level: 9, format: "gzip" });
+    assert(stored.data.length < random.length * 1.001, "Random data should cost only stored-block headers");
+    assertEquals(stored.checksum, zlib.crc32(random), "The trailer's CRC-32 should cover the passed-through data");
+    assertEquals((await zlib.decompress(stored.data)).data, random);
+
+    // Text after the random stretch is probed again and still compressed
+    const text = new TextEncoder().encode("The quick brown fox jumps over the lazy dog. ".repeat(20000));
+    const mixed = new Uint8Array(random.length + text.length);
+    mixed.set(random);
+    mixed.set(text, random.length);
+    const packed = await zlib.compress(mixed);
+    assert(packed.data.length < random.length + text.length / 10, "The text should not be stored with the random data");
+    assertEquals((await zlib.decompress(packed.data)).data, mixed);
+
+    const small = await zlib.compress(text);
+    assertEquals((await zlib.decompress(small.data)).data, text, "The pooled context should be back at its level");
+    assert(small.data.length < text.length / 50);
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Auto mode picks parameters from the input (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const random = crypto.getRandomValues(new Uint8Array(64 * 1024));
+    const stored = await zlib.compress(random, { auto: true });
+    assertEquals(stored.auto?.level, 0, "Random data should be stored");
+    assert(stored.auto!.entropy > 7.9, "Random data should measure near 8 bits per byte");
+    assertEquals((await zlib.decompress(stored.data)).data, random);
+
+    const text = new TextEncoder().encode("The quick brown fox jumps over the lazy dog. ".repeat(2000));
+    const packed = await zlib.compress(text, { auto: true });
+    assertEquals(packed.auto?.level, 6);
+    assertEquals(packed.auto?.strategy, ZlibStrategy.DEFAULT_STRATEGY, "Repetitive text should keep LZ matching");
+    assertEquals((await zlib.decompress(packed.data)).data, text);
+
+    const runs = new Uint8Array(64 * 1024);
+    for (let i = 0; i < runs.length; i += 1000) runs.set(random.subarray(i, i + 50), i);
+    const rle = await zlib.compress(runs, { auto: true });
+    assertEquals(rle.auto?.strategy, ZlibStrategy.RLE, "Run-dominated data should use Z_RLE");
+    assertEquals((await zlib.decompress(rle.data)).data, runs);
+
+    assertEquals((await zlib.compress(text)).auto, undefined, "Only auto mode reports a choice");
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Inflater is reused across many streams (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const inflater = zlib.createInflater({ chunkSize: 256 });
+    for (let i = 0; i < 50; i++) {
+      const message = new TextEncoder().encode(`message ${i} `.repeat(i + 1));
+      const compressed = await zlib.compress(message, { level: 6 });
+      assertEquals(inflater.inflate(compressed.data), message, `Message ${i} should round-trip`);
+    }
+
+    // A stream split across pushes, then reset for the next
+    const message = new TextEncoder().encode("split over two pushes ".repeat(40));
+    const compressed = (await zlib.compress(message)).data;
+    const half = compressed.length >> 1;
+    const first = inflater.push(compressed.subarray(0, half));
+    assert(!inflater.ended, "Stream should not have ended after half the input");
+    const rest = inflater.push(compressed.subarray(half));
+    assert(inflater.ended, "Stream should end with the rest of the input");
+    assertEquals(new Uint8Array([...first, ...rest]), message);
+    inflater.reset();
+
+    assertThrows(() => inflater.inflate(compressed.subarray(0, half)), Error, "truncated");
+    assertEquals(inflater.inflate(compressed), message, "Inflater should recover after a truncated stream");
+
+    inflater.dispose();
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Inflater reuses tables for streams with the same trees (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const inflater = zlib.createInflater();
+    const events = [0, 1, 2].map(n => new TextEncoder().encode(
+      JSON.stringify(Array.from({ length: 40 }, (_, i) => ({ id: i * n, kind: ["open", "close", "move"][(i + n) % 3] })))
+    ));
+    const streams = await Promise.all(events.map(async event => (await zlib.compress(event, { level: 9 })).data));
+
+    // The same stream back to back, then interleaved with others whose trees differ
+    for (let i = 0; i < 30; i++) {
+      const which = i < 10 ? 0 : i % 3;
+      assertEquals(inflater.inflate(streams[which]), events[which], `Stream ${i} should round-trip`);
+    }
+
+    // Tables kept by a stream that fails must not leak into the next
+    const corrupt = streams[1].slice();
+    corrupt[corrupt.length >> 1] ^= 0x55;
+    try {
+      inflater.inflate(corrupt);
+    } catch {
+      inflater.reset();
+    }
+    assertEquals(inflater.inflate(streams[1]), events[1]);
+
+    inflater.dispose();
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("inflateBack pushes window views (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const input = new TextEncoder().encode("inflateBack straight from the window. ".repeat(5000));
+    const collect = (source: Uint8Array | Iterable<Uint8Array>, format?: "zlib" | "gzip" | "raw" | "auto") => {
+      const chunks: Uint8Array[] = [];
+      const total = zlib.inflateBack(source, view => chunks.push(view.slice()), { format });
+      assert(chunks.every(chunk => chunk.length <= 32768), "Output should arrive a window at a time");
+      const output = new Uint8Array(total);
+      let offset = 0;
+      for (const chunk of chunks) {
+        output.set(chunk, offset);
+        offset += chunk.length;
+      }
+      return output;
+    };
+
+    const zlibData = (await zlib.compress(input)).data;
+    const gzipData = (await zlib.compress(input, { format: "gzip", header: { name: "body" } })).data;
+    const rawData = (await zlib.compress(input, { format: "raw" })).data;
+    assertEquals(collect(zlibData), input);
+    assertEquals(collect(rawData, "raw"), input);
+
+    // Pieces of a few bytes, across the header and trailer too
+    const pieces = Array.from({ length: Math.ceil(gzipData.length / 5) }, (_, i) => gzipData.subarray(i * 5, i * 5 + 5));
+    assertEquals(collect(pieces), input);
+
+    assertThrows(() => zlib.inflateBack(zlibData.subarray(0, zlibData.length - 2), () => {}), Error, "truncated");
+    const stop = new Error("stop");
+    assertThrows(() => zlib.inflateBack(zlibData, () => { throw stop; }), Error, "stop");
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("permessage-deflate keeps context between messages (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    for (const bits of [8, 10, 15]) {
+      const server = zlib.createPerMessageDeflate({ serverMaxWindowBits: bits, clientMaxWindowBits: bits });
+      const client = zlib.createPerMessageDeflate({ isServer: false, serverMaxWindowBits: bits, clientMaxWindowBits: bits });
+
+      const message = new TextEncoder().encode('{"type":"tick","symbol":"ABC","price":101.25}');
+      const first = server.compress(message);
+      const second = server.compress(message);
+      assert(second.length < first.length, `Window ${bits}: repeat should compress against the previous message`);
+      assertEquals(client.decompress(first), message);
+      assertEquals(client.decompress(second), message);
+
+      // Empty message, and the other direction
+      assertEquals(client.decompress(server.compress(new Uint8Array(0))), new Uint8Array(0));
+      assertEquals(server.decompress(client.compress(message)), message);
+
+      assertEquals(server.memory, zlib.perMessageDeflateMemory({ serverMaxWindowBits: bits, clientMaxWindowBits: bits }));
+      server.dispose();
+      client.dispose();
+    }
+
+    const small = zlib.perMessageDeflateMemory({ serverMaxWindowBits: 9, clientMaxWindowBits: 9, memLevel: 1 });
+    const large = zlib.perMessageDeflateMemory();
+    assert(small < large / 4, "Smaller windows should cost less per connection");
+
+    // no_context_takeover: every message compresses alone
+    const reset = zlib.createPerMessageDeflate({ serverNoContextTakeover: true });
+    const peer = zlib.createPerMessageDeflate({ isServer: false, serverNoContextTakeover: true });
+    const text = new TextEncoder().encode("no context takeover ".repeat(10));
+    const a = reset.compress(text);
+    const b = reset.compress(text);
+    assertEquals(a, b, "Without context takeover each message should compress the same");
+    assertEquals(peer.decompress(b), text);
+    reset.dispose();
+    peer.dispose();
+
+    const limited = zlib.createPerMessageDeflate({ isServer: false, maxMessageSize: 100 });
+    const sender = zlib.createPerMessageDeflate();
+    assertThrows(() => limited.decompress(sender.compress(new Uint8Array(1000))), Error, "maxMessageSize");
+    limited.dispose();
+    sender.dispose();
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Short messages round-trip through fixed and dynamic blocks (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const server = zlib.createPerMessageDeflate();
+    const client = zlib.createPerMessageDeflate({ isServer: false });
+    const keys = ['"id":', '"type":"update",', '"ts":', '"user":"alice",', '"ok":true,'];
+    let seed = 7;
+    const next = () => (seed = (seed * 1103515245 + 12345) & 0x7fffffff);
+
+    for (let i = 0; i < 300; i++) {
+      let text = "{";
+      const size = 1 + next() % 400;
+      while (text.length < size) text += keys[next() % keys.length] + (next() % 100000) + ",";
+      const message = i % 5 === 4
+        ? Uint8Array.from({ length: size }, () => next() & 0xff)
+        : new TextEncoder().encode(text + "}");
+      const payload = server.compress(message);
+      assertEquals(client.decompress(payload), message, `Message ${i} of ${message.length} bytes`);
+    }
+
+    // A few literals go out with the fixed codes: BFINAL 0, BTYPE 01
+    const reset = zlib.createPerMessageDeflate({ serverNoContextTakeover: true });
+    assertEquals(reset.compress(new TextEncoder().encode('{"ok":true}'))[0] & 0x07, 0x02);
+    reset.dispose();
+
+    server.dispose();
+    client.dispose();
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Parallel block compression joins into one stream (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    // Several blocks, with repeats that span block boundaries
+    const phrase = new TextEncoder().encode("parallel deflate block ");
+    const testData = new Uint8Array(600 * 1024);
+    for (let i = 0; i < testData.length; i++) {
+      testData[i] = phrase[i % phrase.length] ^ (i >> 15 & 1);
+    }
+
+    for (const format of ["zlib", "gzip"] as const) {
+      const result = await zlib.compressParallel(testData, { format, workers: 2 });
+      assert(result.compressedSize < testData.length, `${format} output should be compressed`);
+
+      const restored = await zlib.decompress(result.data);
+      assertEquals(restored.data, testData, `${format} parallel output should roundtrip`);
+
+      // The worker count changes nothing in the output
+      const serial = await zlib.compressParallel(testData, { format, workers: 1 });
+      const wide = await zlib.compressParallel(testData, { format, workers: 5 });
+      assertEquals(serial.data, result.data, `${format} output should not depend on workers`);
+      assertEquals(wide.data, result.data, `${format} output should not depend on workers`);
+    }
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Calls run on a worker by priority and can be cancelled (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const testData = new TextEncoder().encode("off the main thread ".repeat(20000));
+    const compressed = await zlib.compressInWorker(testData, { workers: 1, level: 9 });
+    assertEquals((await zlib.decompress(compressed.data)).data, testData);
+    const restored = await zlib.decompressInWorker(compressed.data, { maxOutputSize: testData.length });
+    assertEquals(restored.data, testData);
+
+    // Transferred input is detached here
+    const moved = testData.slice();
+    await zlib.compressInWorker(moved, { transfer: true });
+    assertEquals(moved.length, 0);
+
+    // With the one worker busy, the higher priority call runs first
+    const order: string[] = [];
+    const busy = zlib.compressInWorker(testData, { level: 9 });
+    const low = zlib.compressInWorker(testData, { priority: 0 }).then(() => order.push("low"));
+    const high = zlib.compressInWorker(testData, { priority: 5 }).then(() => order.push("high"));
+    await Promise.all([busy, low, high]);
+    assertEquals(order, ["high", "low"]);
+
+    // Aborting drops a queued call and stops a running one; the pool carries on
+    const running = new AbortController();
+    const queued = new AbortController();
+    const first = zlib.compressInWorker(testData, { level: 9, signal: running.signal });
+    const second = zlib.compressInWorker(testData, { signal: queued.signal });
+    queued.abort();
+    running.abort();
+    await assertRejects(() => first);
+    await assertRejects(() => second);
+    const after = await zlib.compressInWorker(testData);
+    assertEquals((await zlib.decompress(after.data)).data, testData);
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Incremental checksums match one-shot ones (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const testData = new Uint8Array(200 * 1024 + 17);
+    for (let i = 0; i < testData.length; i++) {
+      testData[i] = (i * 31 + (i >> 9)) & 0xff;
+    }
+
+    const crc = zlib.createCrc32();
+    const adler = zlib.createAdler32();
+    for (let offset = 0; offset < testData.length; offset += 3001) {
+      crc.update(testData.subarray(offset, offset + 3001));
+      adler.update(testData.subarray(offset, offset + 3001));
+    }
+    assertEquals(crc.digest(), zlib.crc32(testData));
+    assertEquals(adler.digest(), zlib.adler32(testData));
+
+    // A continued checksum equals the checksum of the whole
+    const head = testData.subarray(0, 1000);
+    assertEquals(zlib.crc32(testData.subarray(1000), zlib.crc32(head)), zlib.crc32(testData));
+    assertEquals(zlib.adler32(testData.subarray(1000), zlib.adler32(head)), zlib.adler32(testData));
+
+    assertEquals(crc.reset().update(new TextEncoder().encode("123456789")).digest(), 0xcbf43926);
+    crc.dispose();
+    adler.dispose();
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Parallel CRC32 matches the serial checksum (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const testData = new Uint8Array(5 * 1024 * 1024 + 321);
+    for (let i = 0; i < testData.length; i++) {
+      testData[i] = (i * 2654435761) >>> 13;
+    }
+    const expected = zlib.crc32(testData);
+
+    assertEquals(await zlib.crc32Parallel(testData, 3), expected);
+    assertEquals(await zlib.crc32Parallel(testData.subarray(0, 1000), 3), zlib.crc32(testData.subarray(0, 1000)));
+
+    const split = 1234567;
+    const head = testData.subarray(0, split);
+    const tail = testData.subarray(split);
+    assertEquals(zlib.crc32Combine(zlib.crc32(head), zlib.crc32(tail), tail.length), expected);
+    assertEquals(zlib.adler32Combine(zlib.adler32(head), zlib.adler32(tail), tail.length), zlib.adler32(testData));
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("ZIP archive from independently deflated entries (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const encoder = new TextEncoder();
+    const entries = Array.from({ length: 40 }, (_, i) => ({
+      name: `logs/part-${i}.txt`,
+      data: encoder.encode(`entry ${i} `.repeat(i * 50))
+    }));
+    entries.push({ name: "random.bin", data: crypto.getRandomValues(new Uint8Array(4096)) });
+
+    const comment = "nightly export";
+    const zip = (await zlib.createZip(entries, { workers: 2, comment })).data;
+    const view = new DataView(zip.buffer, zip.byteOffset, zip.byteLength);
+
+    // End of central directory record, then each central directory header
+    const end = zip.length - 22 - comment.length;
+    assertEquals(view.getUint32(end, true), 0x06054b50, "Archive should end with the EOCD record");
+    assertEquals(view.getUint16(end + 10, true), entries.length, "EOCD should count every entry");
+
+    let offset = view.getUint32(end + 16, true);
+    for (const entry of entries) {
+      assertEquals(view.getUint32(offset, true), 0x02014b50, "Central directory header expected");
+      const method = view.getUint16(offset + 10, true);
+      const nameLength = view.getUint16(offset + 28, true);
+      const name = new TextDecoder().decode(zip.subarray(offset + 46, offset + 46 + nameLength));
+
+      assertEquals(name, entry.name, "Entries should be written in order");
+      assertEquals(view.getUint32(offset + 16, true), zlib.crc32(entry.data), `${name} CRC-32`);
+      assertEquals(view.getUint32(offset + 24, true), entry.data.length, `${name} size`);
+      assertEquals(method, entry.name === "random.bin" || entry.data.length === 0 ? 0 : 8,
+                   `${name} should be stored only when deflate does not help`);
+      offset += 46 + nameLength + view.getUint16(offset + 30, true) + view.getUint16(offset + 32, true);
+    }
+
+    // Read back in memory
+    const reader = zlib.openZip(zip);
+    assertEquals(reader.count, entries.length, "Reader should see every entry");
+    for (const entry of entries) {
+      assertEquals(reader.extract(entry.name), entry.data, `${entry.name} should extract intact`);
+    }
+    assertEquals(reader.extract("missing.txt"), null, "Unknown names should give null");
+
+    const wanted = [...entries].reverse().map(entry => entry.name);
+    const batch = reader.extractMany([...wanted, "missing.txt"]);
+    assertEquals(batch.length, wanted.length + 1, "Batch should answer every name");
+    wanted.forEach((name, i) => {
+      assertEquals(batch[i], entries.find(entry => entry.name === name)!.data, `${name} should batch-extract intact`);
+    });
+    assertEquals(batch[wanted.length], null, "Unknown names in a batch should give null");
+
+    const location = reader.locate(entries[1].name)!;
+    assertEquals(location.size, entries[1].data.length, "Location should give the entry's size");
+    assertEquals(zlib.inflateZipEntry(reader.data(location), location), entries[1].data,
+                 "Located data should inflate without the reader");
+    reader.dispose();
+
+    const concurrent = await zlib.extractZip(zip, [...wanted, "missing.txt"], { workers: 2 });
+    wanted.forEach((name, i) => {
+      assertEquals(concurrent[i], entries.find(entry => entry.name === name)!.data, `${name} should extract concurrently`);
+    });
+    assertEquals(concurrent[wanted.length], null, "Unknown names should give null concurrently");
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Deflate64 ZIP entries (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    // Deflate with no 258-byte matches is also valid Deflate64, so relabel a
+    // deflated entry as method 9 in both its headers
+    const data = new TextEncoder().encode(
+      Array.from({ length: 5000 }, (_, i) => `record ${String(i).padStart(5, "0")}\n`).join("")
+    );
+    const zip = (await zlib.createZip([{ name: "big.csv", data }])).data;
+    const view = new DataView(zip.buffer, zip.byteOffset, zip.byteLength);
+    const central = view.getUint32(zip.length - 6, true);
+    assertEquals(view.getUint16(8, true), 8, "Entry should be deflated");
+    view.setUint16(8, 9, true);
+    view.setUint16(central + 10, 9, true);
+
+    const reader = zlib.openZip(zip);
+    assertEquals(reader.extract("big.csv"), data, "Deflate64 entry should extract");
+    assertEquals(reader.extractMany(["big.csv"])[0], data, "Deflate64 entry should batch-extract");
+    const location = reader.locate("big.csv")!;
+    assertEquals(location.method, 9, "Location should report Deflate64");
+    assertEquals(zlib.inflateZipEntry(reader.data(location), location), data,
+                 "Located Deflate64 data should inflate without the reader");
+    reader.dispose();
+
+    assertEquals((await zlib.extractZip(zip, ["big.csv"], { workers: 2 }))[0], data,
+                 "Deflate64 entry should extract concurrently");
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Streaming ZIP archive with data descriptors (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const encoder = new TextEncoder();
+    const chunk = encoder.encode("streamed line of text\n".repeat(4096));
+    const chunks = new ReadableStream<Uint8Array>({
+      start(controller) {
+        for (let i = 0; i < 8; i++) controller.enqueue(chunk);
+        controller.close();
+      }
+    });
+    const small = encoder.encode("small entry ".repeat(100));
+
+    const parts: Uint8Array[] = [];
+    for await (const part of zlib.createZipStream([
+      { name: "small.txt", data: small },
+      { name: "chunked.txt", data: chunks }
+    ], { comment: "streamed" })) {
+      parts.push(part);
+    }
+    assert(parts.length > 2, "Archive should arrive in several pieces");
+
+    const zip = new Uint8Array(parts.reduce((n, part) => n + part.length, 0));
+    parts.reduce((offset, part) => (zip.set(part, offset), offset + part.length), 0);
+    const view = new DataView(zip.buffer);
+    assertEquals(view.getUint32(0, true), 0x04034b50, "Archive should start with a local header");
+    assertEquals(view.getUint16(6, true) & 0x8, 0x8, "Entries should use data descriptors");
+
+    const reader = zlib.openZip(zip);
+    assertEquals(reader.extract("small.txt"), small, "Whole entry should roundtrip");
+    const chunked = reader.extract("chunked.txt")!;
+    assertEquals(chunked.length, chunk.length * 8, "Chunked entry should have every chunk");
+    assertEquals(chunked.subarray(chunk.length * 7), chunk, "Chunked entry should roundtrip");
+    reader.dispose();
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Inflate limits stop decompression bombs (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const zeros = new Uint8Array(8 << 20);
+    const bomb = (await zlib.compress(zeros, { level: 9, format: "gzip" })).data;
+
+    assertEquals((await zlib.decompress(bomb, { maxOutputSize: zeros.length })).data.length, zeros.length,
+                 "Output at the limit should pass");
+    await assertRejects(() => zlib.decompress(bomb, { maxOutputSize: 1 << 20 }), ZlibLimitError);
+    await assertRejects(() => zlib.decompress(bomb, { maxRatio: 100 }), ZlibLimitError);
+    // A forged ISIZE must not size the buffer past the limit either
+    const forged = bomb.slice();
+    forged.set([0xff, 0xff, 0xff, 0x7f], forged.length - 4);
+    await assertRejects(() => zlib.decompress(forged, { maxOutputSize: 1 << 20 }), ZlibLimitError);
+
+    let streamed = 0;
+    const sink = new WritableStream<Uint8Array>({ write(chunk) { streamed += chunk.length; } });
+    await assertRejects(
+      () => new Blob([bomb]).stream().pipeThrough(zlib.createInflateStream({ maxOutputSize: 1 << 20 })).pipeTo(sink),
+      ZlibLimitError
+    );
+    assert(streamed <= 1 << 20, "Nothing past the limit should be emitted");
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Streaming tar.gz archives (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const encoder = new TextEncoder();
+    const big = new Uint8Array(200000).map((_, i) => (i * 31) % 251);
+    async function* chunks() {
+      for (let i = 0; i < big.length; i += 30000) yield big.subarray(i, i + 30000);
+    }
+    const longName = `src/${"nested/".repeat(40)}index.js`;
+    const archive = zlib.createTarGzStream([
+      { name: "package/", type: "directory" },
+      { name: "package/package.json", data: encoder.encode('{"name":"demo"}') },
+      { name: "package/blob.bin", data: chunks(), size: big.length },
+      { name: longName, data: encoder.encode("export {}\n") },
+      { name: "package/latest", type: "symlink", linkName: "blob.bin" }
+    ]);
+
+    const seen: string[] = [];
+    for await (const entry of zlib.extractTarGz(archive)) {
+      seen.push(`${entry.type}:${entry.name}`);
+      if (entry.name === "package/blob.bin") {
+        assertEquals(new Uint8Array(await new Response(entry.data).arrayBuffer()), big,
+                     "Chunked entry should stream back intact");
+      }
+      if (entry.type === "symlink") assertEquals(entry.linkName, "blob.bin", "Link target should survive");
+    }
+    assertEquals(seen, [
+      "directory:package/",
+      "file:package/package.json",
+      "file:package/blob.bin",
+      `file:${longName}`,
+      "symlink:package/latest"
+    ], "Entries should arrive in order, unread data skipped");
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Joining gzip members without recompression (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const encoder = new TextEncoder();
+    const segments = Array.from({ length: 12 }, (_, i) => encoder.encode(`log line ${i}\n`.repeat(i * 37 + 1)));
+    const members = await Promise.all(segments.map(async (segment, i) => new Uint8Array(
+      await new Response(
+        new Blob([segment]).stream().pipeThrough(zlib.createDeflateStream({ level: i % 10, windowBits: 31 }))
+      ).arrayBuffer()
+    )));
+
+    // One file that is itself two appended members, plus single members
+    const appended = new Uint8Array(members[0].length + members[1].length);
+    appended.set(members[0]);
+    appended.set(members[1], members[0].length);
+    const joined = zlib.gzjoin([appended, ...members.slice(2)]);
+
+    const expected = new Uint8Array(segments.reduce((n, segment) => n + segment.length, 0));
+    segments.reduce((offset, segment) => (expected.set(segment, offset), offset + segment.length), 0);
+
+    const view = new DataView(joined.buffer, joined.byteOffset, joined.byteLength);
+    assertEquals(view.getUint32(joined.length - 4, true), expected.length, "ISIZE should cover every member");
+    assertEquals(view.getUint32(joined.length - 8, true), zlib.crc32(expected), "CRC-32 should be combined");
+    const restored = new Uint8Array(
+      await new Response(new Blob([joined]).stream().pipeThrough(zlib.createInflateStream())).arrayBuffer()
+    );
+    assertEquals(restored, expected, "Joined member should inflate to the concatenation");
+
+    assertThrows(() => zlib.gzjoin([members[2].subarray(0, 10)]), ZlibCompressionError);
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("gzip headers and members are listed without inflating output (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const text = new TextEncoder().encode("gzip member listing ".repeat(5000));
+    const named = (await zlib.compress(text, { format: "gzip", header: { name: "notes.txt", mtime: 1700000000 } })).data;
+    const plain = (await zlib.compress(text.subarray(0, 999), { format: "gzip" })).data;
+    const blocked = (await zlib.compressBgzf(text, { blockSize: 40000 })).data;
+
+    const header = zlib.readGzipHeader(named);
+    assertEquals(header.name, "notes.txt");
+    assertEquals(header.mtime, 1700000000);
+    assertThrows(() => zlib.readGzipHeader(named.subarray(0, 12)), ZlibCompressionError);
+
+    const all = new Uint8Array(named.length + plain.length + blocked.length);
+    all.set(named);
+    all.set(plain, named.length);
+    all.set(blocked, named.length + plain.length);
+    const members = await zlib.gzipMembers(all);
+
+    // Two members, three BGZF blocks and the BGZF end marker
+    assertEquals(members.length, 6);
+    assertEquals(members[0].name, "notes.txt");
+    assertEquals(members[1].offset, named.length);
+    assertEquals(members[1].isize, 999);
+    assertEquals(members[2].offset, named.length + plain.length);
+    assertEquals(members[5].isize, 0);
+    assertEquals(members.reduce((n, m) => n + m.isize, 0), 2 * text.length + 999);
+    assertEquals(members[0].crc32, zlib.crc32(text));
+    const last = members[members.length - 1];
+    assertEquals(last.offset + last.length, all.length);
+
+    await assertRejects(() => zlib.gzipMembers(all.subarray(0, all.length - 3)), ZlibCompressionError);
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Appending to a crash-safe gzip log (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const encoder = new TextEncoder();
+    const inflate = async (bytes: Uint8Array) => new Uint8Array(
+      await new Response(new Blob([bytes]).stream().pipeThrough(zlib.createInflateStream())).arrayBuffer()
+    );
+    const lines: string[] = [];
+    const storage = new MemoryLogStorage();
+
+    let log = await zlib.openLog(storage);
+    assertEquals((await inflate(storage.bytes)).length, 0, "A new log should be an empty gzip file");
+    for (let i = 0; i < 100; i++) {
+      lines.push(`request ${i} served in ${i % 17} ms\n`);
+      await log.write(encoder.encode(lines[i]));
+    }
+    assertEquals(await inflate(storage.bytes), encoder.encode(lines.join("")), "Every write should be flushed");
+    await log.close();
+
+    // Reopened with batched flushes, then a flush left unfinished
+    log = await zlib.openLog(storage, { flushSize: 16 * 1024 });
+    assert(!log.recovered, "A cleanly closed log needs no recovery");
+    await Promise.all(Array.from({ length: 2000 }, (_, i) => {
+      lines.push(`batched ${i}\n`);
+      return log.write(encoder.encode(lines[lines.length - 1]));
+    }));
+    await log.flush();
+    assertEquals(log.size, storage.bytes.length);
+    const committed = encoder.encode(lines.join(""));
+    assertEquals(await inflate(storage.bytes), committed);
+
+    storage.write(log.size - 10, encoder.encode("half-written append"));
+    log.dispose();
+    log = await zlib.openLog(storage);
+    assert(log.recovered, "An interrupted flush should be undone");
+    assertEquals(await inflate(storage.bytes), committed, "Recovery should keep every completed flush");
+    await log.close();
+
+    await assertRejects(() => zlib.openLog(new MemoryLogStorage(committed)), ZlibCompressionError);
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Gzip file I/O through a sync access handle (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    // An in-memory stand-in for an OPFS FileSystemSyncAccessHandle
+    let bytes = new Uint8Array(0);
+    let calls = 0;
+    const handle = {
+      getSize: () => bytes.length,
+      read(buffer: Uint8Array, { at }: { at: number }) {
+        calls++;
+        const chunk = bytes.subarray(at, at + buffer.length);
+        buffer.set(chunk);
+        return chunk.length;
+      },
+      write(data: Uint8Array, { at }: { at: number }) {
+        calls++;
+        if (at + data.length > bytes.length) {
+          const grown = new Uint8Array(at + data.length);
+          grown.set(bytes);
+          bytes = grown;
+        }
+        bytes.set(data, at);
+        return data.length;
+      },
+      truncate(length: number) {
+        bytes = bytes.slice(0, length);
+      },
+      flush() {}
+    };
+
+    const encoder = new TextEncoder();
+    const testData = encoder.encode("row,value,timestamp\n".repeat(200000));
+
+    const file = zlib.openGzipFile(handle, "w", { level: 6 });
+    for (let offset = 0; offset < testData.length; offset += 100000) {
+      file.write(testData.subarray(offset, offset + 100000));
+    }
+    file.close();
+    assert(calls < 10, "1 MB buffers should need few handle writes");
+
+    const appended = zlib.openGzipFile(handle, "a");
+    appended.write(encoder.encode("last row\n"));
+    appended.close();
+
+    const expected = new Uint8Array(testData.length + 9);
+    expected.set(testData);
+    expected.set(encoder.encode("last row\n"), testData.length);
+
+    calls = 0;
+    const restored = new Uint8Array(
+      await new Response(zlib.openGzipFile(handle, "r").readable()).arrayBuffer()
+    );
+    assertEquals(restored, expected, "Both members should read back");
+    assert(calls < 10, "1 MB buffers should need few handle reads");
+
+    const gunzipped = new Uint8Array(
+      await new Response(new Blob([bytes]).stream().pipeThrough(zlib.createInflateStream())).arrayBuffer()
+    );
+    assertEquals(gunzipped.subarray(0, testData.length), testData, "The file should be ordinary gzip");
+
+    assertThrows(() => zlib.openGzipFile(handle, "w", { level: 10 }), ZlibError);
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Batch compression of small messages (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const encoder = new TextEncoder();
+    const messages = Array.from({ length: 500 }, (_, i) =>
+      encoder.encode(JSON.stringify({ id: i, event: "click", x: i % 17, y: i % 31 }))
+    );
+    messages.push(new Uint8Array(0));
+
+    const batch = await zlib.compressBatch(messages, { level: 6 });
+    assertEquals(batch.offsets.length, messages.length + 1, "One offset per message plus the end");
+
+    for (let i = 0; i < messages.length; i++) {
+      const compressed = batch.data.subarray(batch.offsets[i], batch.offsets[i + 1]);
+      const restored = await zlib.decompress(compressed);
+      assertEquals(restored.data, messages[i], `Message ${i} should roundtrip`);
+    }
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Batch decompression of small messages (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const encoder = new TextEncoder();
+    const messages = Array.from({ length: 300 }, (_, i) =>
+      encoder.encode(JSON.stringify({ id: i, event: "scroll", depth: i % 13 }).repeat(1 + i % 5))
+    );
+    messages.push(new Uint8Array(0));
+
+    // Packed as compressBatch() returns it, with a hint too small to hold the output
+    const batch = await zlib.compressBatch(messages, { level: 6 });
+    const restored = await zlib.decompressBatch(batch, { expectedSize: 16 });
+    assertEquals(restored.offsets.length, messages.length + 1, "One offset per message plus the end");
+    for (let i = 0; i < messages.length; i++) {
+      assertEquals(restored.data.subarray(restored.offsets[i], restored.offsets[i + 1]), messages[i], `Message ${i} should roundtrip`);
+    }
+
+    // Separate zlib and gzip buffers
+    const frames = [
+      (await zlib.compress(messages[1])).data,
+      (await zlib.compress(messages[2], { format: "gzip" })).data
+    ];
+    const mixed = await zlib.decompressBatch(frames);
+    assertEquals(mixed.data.subarray(mixed.offsets[1], mixed.offsets[2]), messages[2]);
+
+    // A corrupt stream names its index
+    const corrupt = frames[1].slice();
+    corrupt[corrupt.length - 5] ^= 0xff;
+    await assertRejects(() => zlib.decompressBatch([frames[0], corrupt]), Error, "at message 1");
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Repeated inputs come back from the compress cache (if WASM available)", async () => {
+  const zlib = new Zlib({ compressCacheMB: 1 });
+
+  try {
+    await zlib.initialize();
+
+    const config = new TextEncoder().encode(JSON.stringify({ flags: Array.from({ length: 50 }, (_, i) => `feature-${i}`) }));
+    const first = await zlib.compress(config, { level: 9 });
+    const second = await zlib.compress(config.slice(), { level: 9 });
+    assertEquals(second.data, first.data);
+    assertEquals((await zlib.decompress(second.data)).data, config);
+
+    // Other options are another entry; callers get copies
+    await zlib.compress(config, { level: 1 });
+    second.data.fill(0);
+    assertEquals((await zlib.compress(config, { level: 9 })).data, first.data);
+
+    // A different input of the same length is a miss
+    const other = config.slice();
+    other[10] ^= 1;
+    assertEquals((await zlib.decompress((await zlib.compress(other, { level: 9 })).data)).data, other);
+
+    const stats = zlib.compressCacheStats()!;
+    assertEquals(stats.hits, 2);
+    assertEquals(stats.misses, 3);
+    assertEquals(stats.entries, 3);
+    assert(stats.bytes <= stats.maxBytes);
+
+    zlib.clearCompressCache();
+    assertEquals(zlib.compressCacheStats()!.entries, 0);
+    assertEquals(new Zlib().compressCacheStats(), null);
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Small messages reuse pooled heap regions (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    assert(zlib.getCapabilities() === zlib.getCapabilities(), "Capabilities should be built once");
+
+    const text = "The quick brown fox jumps over the lazy dog. ".repeat(30);
+    for (const size of [0, 64, 1024]) {
+      const data = new TextEncoder().encode(text.slice(0, size));
+      for (let i = 0; i < 100; i++) {
+        const compressed = await zlib.compress(data);
+        const restored = await zlib.decompress(compressed.data, { expectedSize: size });
+        assertEquals(restored.data, data, `${size} B message should roundtrip`);
+        assertEquals(compressed.simdAccelerated, zlib.getCapabilities().simdSupported);
+      }
+    }
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Preset dictionary compression (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const encoder = new TextEncoder();
+    const event = (i: number) =>
+      encoder.encode(JSON.stringify({ event: "page_view", user: `user${i}`, path: `/docs/${i % 20}` }));
+    const samples = Array.from({ length: 200 }, (_, i) => event(i));
+
+    const dictionary = zlib.trainDictionary(samples, 4096);
+    assert(dictionary.length > 0 && dictionary.length <= 4096, "Trained dictionary should fit the limit");
+
+    const message = event(1234);
+    const plain = await zlib.compress(message);
+    const primed = await zlib.compress(message, { dictionary });
+    assert(primed.compressedSize < plain.compressedSize, "Dictionary should shrink small messages");
+
+    const restored = await zlib.decompress(primed.data, { dictionary });
+    assertEquals(restored.data, message, "Dictionary roundtrip should restore the message");
+
+    let rejected = false;
+    try {
+      await zlib.decompress(primed.data);
+    } catch {
+      rejected = true;
+    }
+    assert(rejected, "Decompressing without the dictionary should fail");
+
+    // Later messages reuse the primed snapshot and must match the first pass
+    const again = await zlib.compress(message, { dictionary });
+    assertEquals(again.data, primed.data, "Snapshot compression should be deterministic");
+    const other = event(99);
+    const otherRestored = await zlib.decompress((await zlib.compress(other, { dictionary })).data, { dictionary });
+    assertEquals(otherRestored.data, other, "Snapshot should not carry state between messages");
+
+    zlib.releaseDictionary(dictionary);
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Random access index (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const data = new Uint8Array(3 * 1024 * 1024);
+    for (let i = 0; i < data.length; i++) data[i] = (i * 7 + (i >> 10)) % 251;
+    const compressed = (await zlib.compress(data)).data;
+
+    // Read through a callback, as an archive on disk would be
+    const source = (position: number, length: number) => compressed.subarray(position, position + length);
+    const index = await zlib.buildIndex(source, { span: 256 * 1024 });
+    assertEquals(index.length, data.length, "Index should cover the whole stream");
+    assert(index.points >= 1, "Index should have access points");
+
+    const offset = 2_000_000;
+    const slice = await index.extract(source, offset, 4096);
+    assertEquals(slice, data.subarray(offset, offset + 4096), "Extracted range should match");
+
+    const tail = await index.extract(compressed, data.length - 10, 100);
+    assertEquals(tail.length, 10, "Reads past the end should be clipped");
+
+    const restored = zlib.loadIndex(index.serialize());
+    assertEquals(await restored.extract(source, offset, 4096), slice, "Loaded index should extract the same bytes");
+
+    const parallel = await zlib.decompressParallel(compressed, index, { workers: 2 });
+    assertEquals(parallel.data, data, "Parallel inflate should reproduce the stream");
+
+    index.dispose();
+    restored.dispose();
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Blocked gzip random access (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const data = new Uint8Array(1024 * 1024 + 123);
+    for (let i = 0; i < data.length; i++) data[i] = (i * 7 + (i >> 10)) % 251;
+    const { data: bgzf, index } = await zlib.compressBgzf(data);
+
+    assertEquals([bgzf[0], bgzf[1], bgzf[3] & 0x04, bgzf[12], bgzf[13]], [0x1f, 0x8b, 0x04, 0x42, 0x43]);
+    assertEquals((await zlib.decompress(bgzf)).data, data, "BGZF should inflate as one gzip file");
+
+    const source = (position: number, length: number) => bgzf.subarray(position, position + length);
+    const reader = await zlib.openBgzf(source, index);
+    assertEquals(reader.blocks, Math.ceil(data.length / 0xff00));
+
+    // A range straddling two members, and one running past the end
+    const offset = 3 * 0xff00 - 100;
+    assertEquals(await reader.read(offset, 300), data.subarray(offset, offset + 300));
+    assertEquals((await reader.read(data.length - 10, 100)).length, 10);
+
+    // Without the index the members are walked, to the same offsets
+    const scanned = await zlib.openBgzf(bgzf);
+    assertEquals(scanned.index(), index);
+    assertEquals(scanned.point(5), reader.point(5));
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Hot-path stats (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    zlib.resetStats();
+    const before = zlib.getStats();
+    if (before === null) {
+      // Only builds made with ZLIB_STATS=1 are instrumented
+      zlib.cleanup();
+      return;
+    }
+    assertEquals(before.longestMatch.calls, 0, "Reset should zero the counters");
+
+    const data = new Uint8Array(256 * 1024);
+    for (let i = 0; i < data.length; i++) data[i] = (i * 13 + (i >> 8)) % 97;
+    const compressed = await zlib.compress(data, { level: 6 });
+    await zlib.decompress(compressed.data);
+
+    const stats = zlib.getStats()!;
+    assertEquals(stats.fillWindow.bytes, data.length, "fill_window should read the whole input");
+    assert(stats.longestMatch.calls > 0, "Deflate should search for matches");
+    assertEquals(
+      stats.chainHistogram.reduce((a, b) => a + b, 0),
+      stats.longestMatch.calls,
+      "Every longest_match call should land in one chain bucket"
+    );
+    assert(stats.flushBlock.calls > 0, "Deflate should flush blocks");
+    assert(stats.adler32.bytes >= 2 * data.length, "Both directions should checksum the data");
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Parameter profile sweep (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+
+    const sample = new TextEncoder().encode(
+      Array.from({ length: 4000 }, (_, i) => `{"id":${i},"name":"user${i % 97}","active":${i % 3 === 0}}`).join("\n")
+    );
+    const profile = await zlib.profile(sample, {
+      levels: [1, 6, 9],
+      strategies: [ZlibStrategy.DEFAULT_STRATEGY, ZlibStrategy.RLE],
+      windowBits: [15],
+      memLevels: [8],
+      workers: 2,
+      minRuns: 1,
+      minTime: 0
+    });
+
+    // RLE ignores the level, so it runs once
+    assertEquals(profile.points.length, 4, "Sweep should cover the grid");
+    assert(profile.frontier.length >= 1, "Frontier should not be empty");
+    for (let i = 1; i < profile.frontier.length; i++) {
+      assert(profile.frontier[i].ratio > profile.frontier[i - 1].ratio, "Frontier should trade speed for ratio");
+    }
+    assert(profile.points.includes(profile.recommended), "Recommendation should be a measured point");
+
+    const { data } = await zlib.compress(sample, { level: profile.recommended.level });
+    assertEquals((await zlib.decompress(data)).data, sample, "Recommended settings should round-trip");
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("node:zlib adaptor streams, flushes and changes params (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+    const nz = nodeZlib(zlib);
+    const text = new TextEncoder().encode("node:zlib compatible ".repeat(2000));
+
+    assertEquals(new Uint8Array(nz.gunzipSync(nz.gzipSync(text))), text, "gzipSync should round-trip");
+    assertEquals(new Uint8Array(nz.inflateRawSync(nz.deflateRawSync(text, { level: 1 }))), text, "Raw deflate should round-trip");
+    assertEquals(new Uint8Array(nz.unzipSync(nz.deflateSync(text))), text, "unzip should detect a zlib header");
+
+    // Concatenated members come back as one stream, and trailing junk is dropped
+    const two = new Uint8Array([...nz.gzipSync(text.subarray(0, 100)), ...nz.gzipSync(text.subarray(100)), 0, 0]);
+    assertEquals(new Uint8Array(nz.gunzipSync(two)), text, "gunzip should read every member");
+    assertThrows(() => nz.gunzipSync(nz.gzipSync(text).subarray(0, 50)), Error, "truncated");
+
+    const gzip = nz.createGzip({ level: 9 });
+    const out: Uint8Array[] = [];
+    gzip.on("data", (chunk: Uint8Array) => out.push(chunk));
+    const done = new Promise((resolve, reject) => {
+      gzip.on("end", resolve);
+      gzip.on("error", reject);
+    });
+
+    gzip.write(text.subarray(0, 1000));
+    await new Promise<void>(resolve => gzip.flush(nz.constants.Z_SYNC_FLUSH, resolve));
+    // Let the pushed output reach the data listener
+    await new Promise(resolve => setTimeout(resolve, 0));
+    const flushed = out.reduce((n, chunk) => n + chunk.length, 0);
+    assert(flushed > 0, "A sync flush should emit what was written");
+    const partial = nz.gunzipSync(new Uint8Array(out.flatMap(chunk => [...chunk])), { finishFlush: nz.constants.Z_SYNC_FLUSH });
+    assertEquals(new Uint8Array(partial), text.subarray(0, 1000), "Flushed output should inflate to the input so far");
+
+    await new Promise<void>(resolve => gzip.params(nz.constants.Z_BEST_SPEED, nz.constants.Z_RLE, () => resolve()));
+    gzip.end(text.subarray(1000));
+    await done;
+    assertEquals(gzip.bytesWritten, text.length, "bytesWritten should count the input");
+    assertEquals(new Uint8Array(nz.gunzipSync(new Uint8Array(out.flatMap(chunk => [...chunk])))), text, "params() should not break the stream");
+
+    const inflated = await new Promise<Uint8Array>((resolve, reject) => {
+      nz.inflate(nz.deflateSync(text), (error, result) => error ? reject(error) : resolve(new Uint8Array(result)));
+    });
+    assertEquals(inflated, text, "Callback forms should deliver the result");
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Deflate stream level switching and adaptive level (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+    const data = new Uint8Array(1024 * 1024);
+    for (let i = 0; i < data.length; i++) data[i] = (i * 7 + (i >> 9)) % 61;
+    const pieces = Array.from({ length: 16 }, (_, i) => data.subarray(i * 65536, (i + 1) * 65536));
+
+    const run = async (stream: TransformStream<Uint8Array, Uint8Array>, between?: (i: number) => void) => {
+      const writer = stream.writable.getWriter();
+      const output = new Response(stream.readable).arrayBuffer();
+      for (let i = 0; i < pieces.length; i++) {
+        between?.(i);
+        await writer.write(pieces[i]);
+      }
+      await writer.close();
+      return new Uint8Array(await output);
+    };
+
+    const deflate = zlib.createDeflateStream({ level: 9 });
+    assertThrows(() => deflate.setLevel(11), ZlibError);
+    const switched = await run(deflate, i => {
+      if (i === 4) deflate.setLevel(1);
+      if (i === 8) deflate.setStrategy(ZlibStrategy.RLE);
+      if (i === 12) deflate.setLevel(ZlibCompression.NO_COMPRESSION);
+    });
+    assertEquals(deflate.level, ZlibCompression.NO_COMPRESSION);
+    assertEquals(deflate.strategy, ZlibStrategy.RLE);
+    assertEquals((await zlib.decompress(switched)).data, data, "Level and strategy switches should keep one stream");
+
+    const changes: number[] = [];
+    const adaptive = zlib.createDeflateStream({
+      format: "gzip",
+      level: 1,
+      adaptiveLevel: { minLevel: 2, maxLevel: 7, interval: 65536, onChange: change => changes.push(change.level) }
+    });
+    assertEquals(adaptive.level, 2, "The start should move into the adaptive range");
+    const output = await run(adaptive);
+    assert(changes.every(level => level >= 2 && level <= 7), "The level should stay in range");
+    assertEquals((await zlib.decompress(output)).data, data, "Adaptive output should round-trip");
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Low-memory deflate profile (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+    const text = new TextEncoder().encode(
+      Array.from({ length: 5000 }, (_, i) => `line ${i}: ${"abcdefghij".repeat(i % 7)}`).join("\n")
+    );
+
+    const fast = zlib.perMessageDeflateMemory();
+    const low = zlib.perMessageDeflateMemory({ memoryProfile: "low" });
+    assert(fast - low >= 48 * 1024, "The low profile should save the pending buffer's three quarters");
+
+    const compressed = new Uint8Array(await new Response(
+      new Blob([text]).stream().pipeThrough(zlib.createDeflateStream({ memoryProfile: "low", format: "gzip" }))
+    ).arrayBuffer());
+    assertEquals((await zlib.decompress(compressed)).data, text, "Low-memory output should round-trip");
+    assertThrows(() => zlib.createDeflateStream({ memoryProfile: "tiny" as "low" }), ZlibError);
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
+
+Deno.test("Dictionary registry (if WASM available)", async () => {
+  const zlib = new Zlib();
+
+  try {
+    await zlib.initialize();
+    const encoder = new TextEncoder();
+    const samples = Array.from({ length: 50 }, (_, i) =>
+      encoder.encode(`{"event":"page_view","user":${i},"path":"/products/${i % 5}","agent":"Mozilla/5.0"}`)
+    );
+    const trained = zlib.trainDictionary(samples);
+    const dictionary = zlib.registerDictionary(trained.buffer.view.slice());
+    zlib.releaseDictionary(trained);
+    assertEquals(zlib.registerDictionary(dictionary.buffer.view.slice()), dictionary, "Registering twice should return the loaded copy");
+
+    // The header's dictionary id picks the registered dictionary
+    const message = (await zlib.compress(samples[7], { dictionary })).data;
+    assertEquals((await zlib.decompress(message)).data, samples[7], "decompress() should resolve the header id");
+
+    // An export imported into another instance resolves the same id
+    const other = new Zlib();
+    await other.initialize();
+    assertEquals(other.importDictionaries(zlib.exportDictionaries()), [dictionary.id]);
+    assertEquals((await other.decompress(message)).data, samples[7], "An imported dictionary should resolve");
+    other.cleanup();
+
+    const unregistered = new Zlib();
+    await unregistered.initialize();
+    await assertRejects(() => unregistered.decompress(message), ZlibCompressionError, "not registered");
+    unregistered.cleanup();
+
+    // Workers get the registered bytes at spawn and resolve them by id
+    const viaWorker = await zlib.compressInWorker(samples[3], { dictionary, workers: 1 });
+    assertEquals((await zlib.decompressInWorker(viaWorker.data, { workers: 1 })).data, samples[3]);
+    const late = zlib.registerDictionary(encoder.encode('{"event":"click","target":"button"}'));
+    const lateMessage = (await zlib.compressInWorker(samples[4], { dictionary: late, workers: 1 })).data;
+    assertEquals((await zlib.decompress(lateMessage)).data, samples[4], "A dictionary registered later should reach the pool");
+
+    const loose = zlib.loadDictionary(encoder.encode("not registered"));
+    await assertRejects(() => zlib.compressInWorker(samples[0], { dictionary: loose, workers: 1 }), ZlibCompressionError);
+
+    zlib.cleanup();
+  } catch (error) {
+    console.warn("⚠️  Skipping WASM-dependent test:", error.message);
+  }
+});
@@ -0,0 +1,278 @@
+/**
+ * zlib.wasm static precompression - a .gz next to every compressible file
+ * Run with: deno task precompress <dir> [options]
+ *
+ *   --level <n>           Level 1-9, or 10 for ultra (default 9)
+ *   --workers <n>         Worker count (default navigator.hardwareConcurrency)
+ *   --extensions <list>   Extensions to compress (default html,css,js,...)
+ *   --min-size <bytes>    Leave smaller files alone (default 256)
+ *   --manifest <file>     Hash manifest (default <dir>/.precompress.json)
+ *   --force               Recompress everything, whatever the manifest says
+ *
+ * Files are compressed in parallel with compressInWorker(), a few per
+ * worker in flight at a time, so memory stays bounded however large the
+ * tree. The manifest records each file's size, mtime, SHA-256 and the
+ * level it was compressed at. A file whose size and mtime match is not
+ * read at all; one whose mtime moved (a fresh checkout) is hashed, and is
+ * only recompressed when its hash or the level changed. A deploy then
+ * costs a walk of the tree plus time proportional to what changed.
+ *
+ * The gzip headers carry no name or time, so the same input always gives
+ * the same .gz and CDN caches keyed on content see no spurious changes.
+ * A .gz is only kept when it is smaller than its original; a .gz this
+ * tool wrote for a file that has since been deleted is removed.
+ */
+
+import Zlib, { ZlibCompression } from "../src/lib/index.ts";
+
+const MANIFEST_VERSION = 1;
+
+// Text formats and the few binaries that deflate well
+const DEFAULT_EXTENSIONS = [
+  "html", "htm", "css", "js", "mjs", "cjs", "json", "map", "svg", "xml",
+  "txt", "md", "csv", "wasm", "ico", "ttf", "otf", "eot", "webmanifest"
+];
+
+// Reads in flight per worker, so the next file is ready when one finishes
+const IN_FLIGHT_PER_WORKER = 2;
+
+export interface PrecompressOptions {
+  dir: string;
+  level: number;
+  workers: number;
+  extensions: Set<string>;
+  minSize: number;
+  manifest: string;
+  force: boolean;
+}
+
+interface ManifestEntry {
+  size: number;
+  mtime: number;
+  sha256: string;
+  level: number;
+  // Size of the .gz written, or 0 when it did not pay and none was kept
+  gzipSize: number;
+}
+
+interface Manifest {
+  version: number;
+  files: Record<string, ManifestEntry>;
+}
+
+export interface PrecompressSummary {
+  compressed: number;
+  unchanged: number;
+  notSmaller: number;
+  removed: number;
+  inputBytes: number;
+  outputBytes: number;
+}
+
+function parseArgs(args: string[]): PrecompressOptions {
+  let dir: string | undefined;
+  let manifest: string | undefined;
+  const options = {
+    level: 9,
+    workers: globalThis.navigator?.hardwareConcurrency ?? 4,
+    extensions: new Set(DEFAULT_EXTENSIONS),
+    minSize: 256,
+    force: false
+  };
+
+  const list = (value: string) => value.split(",").map(s => s.trim().replace(/^\./, "").toLowerCase()).filter(Boolean);
+  for (let i = 0; i < args.length; i++) {
+    const arg = args[i];
+    const value = () => {
+      if (i + 1 >= args.length) throw new Error(`${arg} needs a value`);
+      return args[++i];
+    };
+    switch (arg) {
+      case "--level": options.level = Number(value()); break;
+      case "--workers": options.workers = Number(value()); break;
+      case "--extensions": options.extensions = new Set(list(value())); break;
+      case "--min-size": options.minSize = Number(value()); break;
+      case "--manifest": manifest = value(); break;
+      case "--force": options.force = true; break;
+      default:
+        if (arg.startsWith("--") || dir !== undefined) throw new Error(`Unknown option ${arg}`);
+        dir = arg;
+    }
+  }
+
+  if (dir === undefined) throw new Error("Usage: precompress <dir> [options]");
+  if (!Number.isInteger(options.level) || options.level < 1 || options.level > ZlibCompression.ULTRA_COMPRESSION) {
+    throw new Error(`Invalid level ${options.level}`);
+  }
+  if (!Number.isInteger(options.workers) || options.workers < 1) throw new Error(`Invalid worker count ${options.workers}`);
+  if (!(options.minSize >= 0)) throw new Error("--min-size must not be negative");
+  dir = dir.replace(/\/+$/, "") || "/";
+  return { ...options, dir, manifest: manifest ?? `${dir}/.precompress.json` };
+}
+
+// Paths under dir, relative and '/'-separated, of the files to compress
+async function* walk(dir: string, options: PrecompressOptions, prefix = ""): AsyncGenerator<string> {
+  const entries: Deno.DirEntry[] = [];
+  for await (const entry of Deno.readDir(prefix ? `${dir}/${prefix}` : dir)) entries.push(entry);
+  // A stable order, so the manifest diffs cleanly between deploys
+  entries.sort((a, b) => a.name < b.name ? -1 : a.name > b.name ? 1 : 0);
+
+  for (const entry of entries) {
+    const path = prefix ? `${prefix}/${entry.name}` : entry.name;
+    if (entry.isDirectory) {
+      yield* walk(dir, options, path);
+    } else if (entry.isFile) {
+      const dot = entry.name.lastIndexOf(".");
+      if (dot > 0 && options.extensions.has(entry.name.slice(dot + 1).toLowerCase())) yield path;
+    }
+  }
+}
+
+async function readManifest(path: string): Promise<Manifest> {
+  try {
+    const manifest = JSON.parse(await Deno.readTextFile(path)) as Manifest;
+    if (manifest.version === MANIFEST_VERSION && manifest.files) return manifest;
+  } catch (error) {
+    if (!(error instanceof Deno.errors.NotFound)) console.error(`Ignoring unreadable manifest ${path}`);
+  }
+  return { version: MANIFEST_VERSION, files: {} };
+}
+
+// Written beside the old one and renamed over it, so a failed run leaves
+// the last good manifest in place
+async function writeManifest(path: string, manifest: Manifest): Promise<void> {
+  const sorted: Record<string, ManifestEntry> = {};
+  for (const name of Object.keys(manifest.files).sort()) sorted[name] = manifest.files[name];
+  await Deno.writeTextFile(`${path}.tmp`, JSON.stringify({ version: MANIFEST_VERSION, files: sorted }, null, 2) + "\n");
+  await Deno.rename(`${path}.tmp`, path);
+}
+
+async function sha256(data: Uint8Array): Promise<string> {
+  const digest = new Uint8Array(await crypto.subtle.digest("SHA-256", data));
+  return Array.from(digest, byte => byte.toString(16).padStart(2, "0")).join("");
+}
+
+async function removeIfPresent(path: string): Promise<boolean> {
+  try {
+    await Deno.remove(path);
+    return true;
+  } catch (error) {
+    if (error instanceof Deno.errors.NotFound) return false;
+    throw error;
+  }
+}
+
+async function exists(path: string): Promise<boolean> {
+  try {
+    await Deno.stat(path);
+    return true;
+  } catch {
+    return false;
+  }
+}
+
+/**
+ * Bring dir's .gz files up to date, returning what was done. The manifest
+ * is rewritten at the end, whatever changed.
+ */
+export async function precompressDirectory(zlib: Zlib, options: PrecompressOptions): Promise<PrecompressSummary> {
+  const manifest = await readManifest(options.manifest);
+  const previous = manifest.files;
+  const files: Record<string, ManifestEntry> = {};
+  const summary: PrecompressSummary = { compressed: 0, unchanged: 0, notSmaller: 0, removed: 0, inputBytes: 0, outputBytes: 0 };
+
+  const compressFile = async (name: string, stat: Deno.FileInfo) => {
+    const path = `${options.dir}/${name}`;
+    const mtime = stat.mtime?.getTime() ?? 0;
+    const old = previous[name];
+    const current = !options.force && old && old.level === options.level && old.size === stat.size;
+
+    if (current && old.mtime === mtime && (old.gzipSize === 0 || await exists(`${path}.gz`))) {
+      files[name] = old;
+      summary.unchanged++;
+      return;
+    }
+
+    const data = await Deno.readFile(path);
+    const hash = await sha256(data);
+    if (current && old.sha256 === hash && (old.gzipSize === 0 || await exists(`${path}.gz`))) {
+      files[name] = { ...old, mtime };
+      summary.unchanged++;
+      return;
+    }
+
+    const size = data.length;
+    const result = await zlib.compressInWorker(data, {
+      level: options.level,
+      format: "gzip",
+      workers: options.workers,
+      transfer: true
+    });
+    const keep = result.compressedSize < size;
+    if (keep) {
+      await Deno.writeFile(`${path}.gz`, result.data);
+      summary.compressed++;
+      summary.inputBytes += size;
+      summary.outputBytes += result.compressedSize;
+    } else {
+      await removeIfPresent(`${path}.gz`);
+      summary.notSmaller++;
+    }
+    files[name] = { size, mtime, sha256: hash, level: options.level, gzipSize: keep ? result.compressedSize : 0 };
+  };
+
+  // A bounded number of files read and queued at once, the rest waiting
+  // here rather than in memory
+  const inFlight = new Set<Promise<void>>();
+  for await (const name of walk(options.dir, options)) {
+    if (`${options.dir}/${name}` === options.manifest) continue;
+    const stat = await Deno.stat(`${options.dir}/${name}`);
+    if (stat.size < options.minSize) continue;
+
+    const task = compressFile(name, stat).finally(() => inFlight.delete(task));
+    inFlight.add(task);
+    if (inFlight.size >= options.workers * IN_FLIGHT_PER_WORKER) await Promise.race(inFlight);
+  }
+  await Promise.all(inFlight);
+
+  // Files gone since the last run take the .gz written for them along
+  for (const [name, entry] of Object.entries(previous)) {
+    if (files[name] || entry.gzipSize === 0) continue;
+    if (await exists(`${options.dir}/${name}`)) continue;
+    if (await removeIfPresent(`${options.dir}/${name}.gz`)) summary.removed++;
+  }
+
+  await writeManifest(options.manifest, { version: MANIFEST_VERSION, files });
+  return summary;
+}
+
+async function runPrecompress(args: string[]) {
+  const options = parseArgs(args);
+  const zlib = new Zlib();
+  await zlib.initialize();
+
+  const start = performance.now();
+  try {
+    const summary = await precompressDirectory(zlib, options);
+    const seconds = (performance.now() - start) / 1000;
+    const saved = summary.inputBytes - summary.outputBytes;
+    console.error(
+      `${summary.compressed} compressed, ${summary.unchanged} unchanged, ` +
+      `${summary.notSmaller} left uncompressed, ${summary.removed} stale .gz removed ` +
+      `in ${seconds.toFixed(2)} s on ${options.workers} workers` +
+      (summary.inputBytes ? ` (${(saved / 1024).toFixed(0)} KB saved, ratio ${(summary.inputBytes / summary.outputBytes).toFixed(2)})` : "")
+    );
+  } finally {
+    zlib.cleanup();
+  }
+}
+
+if (import.meta.main) {
+  try {
+    await runPrecompress(Deno.args);
+  } catch (error) {
+    const errorMessage = error instanceof Error ? error.message : String(error);
+    console.error("Precompression failed:", errorMessage);
+    Deno.exit(1);
+  }
+}
@@ -894,6 +894,78 @@ void ZLIB_INTERNAL _tr_align(deflate_state *s) {
     bi_flush(s);
 }
 
+#if defined(Z_U8) && !defined(ZLIB_DEBUG)
+/* ===========================================================================
+ * Send the block data compressed using the given Huffman trees, gathering the
+ * codes in a 64-bit accumulator and storing four bytes at a time instead of
+ * passing each code through the 16-bit bi_buf. The bits are the same. The
+ * length half of a match takes at most 20 bits and the distance half 28, so
+ * with fewer than 32 bits waiting before each half there is always room.
+ */
+#define put_acc(value, length) \
+    { bits |= (Z_U8)(value) << n; n += (length); }
+#define store_acc() \
+    if (n >= 32) { \
+        buf[pending++] = (Bytef)bits; \
+        buf[pending++] = (Bytef)(bits >> 8); \
+        buf[pending++] = (Bytef)(bits >> 16); \
+        buf[pending++] = (Bytef)(bits >> 24); \
+        bits >>= 32; \
+        n -= 32; \
+    }
+
+local void compress_block(deflate_state *s, const ct_data *ltree,
+                          const ct_data *dtree) {
+    Z_U8 bits = s->bi_buf;  /* bits waiting to be stored */
+    int n = s->bi_valid;    /* number of waiting bits */
+    Bytef *buf = s->pending_buf;
+    ulg pending = s->pending;   /* kept local so the stores can be merged */
+    unsigned dist;      /* distance of matched string */
+    int lc;             /* match length or unmatched char (if dist == 0) */
+    unsigned sx = 0;    /* running index in symbol buffers */
+    unsigned code;      /* the code to send */
+    int extra;          /* number of extra bits to send */
+
+    if (s->sym_next != 0) do {
+#ifdef LIT_MEM
+        dist = s->d_buf[sx];
+        lc = s->l_buf[sx++];
+#else
+        dist = s->sym_buf[sx++] & 0xff;
+        dist += (unsigned)(s->sym_buf[sx++] & 0xff) << 8;
+        lc = s->sym_buf[sx++];
+#endif
+        if (dist == 0) {
+            put_acc(ltree[lc].Code, ltree[lc].Len);
+        } else {
+            code = _length_code[lc];
+            put_acc(ltree[code + LITERALS + 1].Code,
+                    ltree[code + LITERALS + 1].Len);
+            extra = extra_lbits[code];
+            if (extra != 0)
+                put_acc(lc - base_length[code], extra);
+            store_acc();
+            dist--;
+            code = d_code(dist);
+            put_acc(dtree[code].Code, dtree[code].Len);
+            extra = extra_dbits[code];
+            if (extra != 0)
+                put_acc(dist - (unsigned)base_dist[code], extra);
+        }
+        store_acc();
+    } while (sx < s->sym_next);
+
+    put_acc(ltree[END_BLOCK].Code, ltree[END_BLOCK].Len);
+    s->pending = pending;
+    while (n >= 16) {
+        put_short(s, (ush)bits);
+        bits >>= 16;
+        n -= 16;
+    }
+    s->bi_buf = (ush)bits;
+    s->bi_valid = n;
+}
+#else
 /* ===========================================================================
  * Send the block data compressed using the given Huffman trees
  */
@@ -950,6 +1022,8 @@ local void compress_block(deflate_state *s, const ct_data *ltree,
     send_code(s, END_BLOCK, ltree);
 }
 
+#endif
+
 /* ===========================================================================
  * Check if the data type is TEXT or BINARY, using the following algorithm:
  * - TEXT if the two conditions below are satisfied:
@@ -990,17 +1064,197 @@ local int detect_data_type(deflate_state *s) {
     return Z_BINARY;
 }
 
+/* ===========================================================================
+ * Bit length of the current block with the static trees, from the symbol
+ * frequencies alone. This is the static_len that build_tree() would compute,
+ * without building the dynamic trees, for Z_QUICK.
+ */
+local ulg static_block_len(deflate_state *s) {
+    ulg len = 0;
+    int n;
+
+    for (n = 0; n < L_CODES; n++) {
+        unsigned f = s->dyn_ltree[n].Freq;
+        if (f == 0) continue;
+        len += (ulg)f * (unsigned)(static_ltree[n].Len +
+                                   (n > LITERALS ? extra_lbits[n - LITERALS - 1] : 0));
+    }
+    for (n = 0; n < D_CODES; n++) {
+        unsigned f = s->dyn_dtree[n].Freq;
+        if (f == 0) continue;
+        len += (ulg)f * (unsigned)(static_dtree[n].Len + extra_dbits[n]);
+    }
+    return len;
+}
+
+/* Blocks of at most this many symbols are first checked against
+ * dynamic_block_bound(), small flushes being the blocks where the static
+ * trees most often win and building the dynamic ones costs the most per byte
+ */
+#define SMALL_BLOCK 64
+
+/* floor(256 * log2(1 + i/32)) */
+local const ush log2_frac[33] = {
+      0,  11,  22,  33,  43,  53,  63,  73,  82,  91, 100, 109, 117, 125,
+    134, 141, 149, 157, 164, 172, 179, 186, 193, 200, 206, 213, 219, 225,
+    232, 238, 244, 250, 256
+};
+
+/* ===========================================================================
+ * log2(x) in 1/256 bits for x > 0, rounded down, or up if up is set.
+ */
+local ulg log2_q8(ulg x, int up) {
+    unsigned e = 0, i;
+
+    while (x >> (e + 1)) e++;
+    i = (unsigned)(e >= 5 ? x >> (e - 5) : x << (5 - e)) & 31;
+    return ((ulg)e << 8) + log2_frac[i + up] + (unsigned)up;
+}
+
+/* ===========================================================================
+ * The fewest bits a run of zero code lengths following a non-zero one (or
+ * starting the tree) can be sent in, if every code costs only one bit: as
+ * zeros, REP_3_10 or REPZ_11_138 and its extra bits, then REP_3_6 of zero.
+ * Exact up to 138 zeros.
+ */
+local ulg zeros_bound(int run) {
+    if (run > 138)
+        return 8 * (ulg)(run / 138) + (ulg)(run % 138 < 3 ? run % 138 : 3);
+    return run < 4 ? (ulg)run : run < 11 ? 4 : run < 13 ? (ulg)run - 6 :
+           run < 17 ? 7 : 8;
+}
+
+/* ===========================================================================
+ * The fewest bits a run of equal non-zero code lengths can be sent in, if
+ * every code costs only one bit: the first length, then REP_3_6 and its
+ * extra bits for up to each 6 more, or the length again.
+ */
+local ulg repeats_bound(int run) {
+    if (run == 0) return 0;
+    return 1 + 3 * (ulg)((run - 1) / 6) +
+           (ulg)((run - 1) % 6 < 3 ? (run - 1) % 6 : 3);
+}
+
+/* ===========================================================================
+ * For one tree, add to *stat the bits of its data with the static tree, and
+ * to *data and *lengths lower bounds on the bits of its data with the
+ * dynamic tree (no fewer than the entropy of its frequencies) and of its
+ * code lengths. Extra bits are counted in both. Returns the number of codes
+ * used.
+ */
+local int tree_bound(const ct_data *tree, const ct_data *stree, int elems,
+                     const int *extra, int base, ulg *stat, ulg *data,
+                     ulg *lengths) {
+    ulg total = 0, flogf = 0, nlogn;
+    int n, run = 0, used = 0, last = -1;
+
+    for (n = 0; n < elems; n++) {
+        unsigned f = tree[n].Freq, bits;
+        if (f == 0) continue;
+        bits = n >= base ? (unsigned)extra[n - base] : 0;
+        total += f;
+        *stat += (ulg)f * (stree[n].Len + bits);
+        *data += (ulg)f * bits;
+        flogf += (ulg)f * log2_q8(f, 1);
+
+        if (n > last + 1) {     /* zeros since the last code used */
+            *lengths += repeats_bound(run) + zeros_bound(n - last - 1);
+            run = 0;
+        }
+        run++, used++;
+        last = n;
+    }
+    *lengths += repeats_bound(run);
+
+    /* sum of f * log2(total / f), in 1/256 bits */
+    nlogn = total ? total * log2_q8(total, 0) : 0;
+    if (nlogn > flogf) *data += (nlogn - flogf) >> 8;
+    return used;
+}
+
+/* ===========================================================================
+ * The fewest bit length codes send_all_trees() can send for a tree of used
+ * codes: the shortest code length is at most log2(used), and bl_order must
+ * reach it.
+ */
+local int bl_codes_bound(int used) {
+    int len = 0, index = BL_CODES - 1;
+
+    while (used >> (len + 1) && len < 8) len++;
+    while (bl_order[index] != len) index--;
+    return index + 1;
+}
+
+/* ===========================================================================
+ * Lower bound on the bit length of the current block with dynamic trees,
+ * no more than the opt_len build_bl_tree() would leave, and the static_len
+ * build_tree() would sum in *stat.
+ */
+local ulg dynamic_block_bound(deflate_state *s, ulg *stat) {
+    ulg data = 0, lengths = 0, dlengths = 0;
+    int lused, dused, blcodes;
+
+    *stat = 0;
+    lused = tree_bound(s->dyn_ltree, static_ltree, L_CODES, extra_lbits,
+                       LITERALS + 1, stat, &data, &lengths);
+    dused = tree_bound(s->dyn_dtree, static_dtree, D_CODES, extra_dbits, 0,
+                       stat, &data, &dlengths);
+
+    /* build_tree() forces at least two codes in each tree */
+    if (lused < 2) lused = 2;
+    if (dused < 2) dused = 2;
+    if (dlengths < 2) dlengths = 2;
+
+    blcodes = bl_codes_bound(lused);
+    if (bl_codes_bound(dused) > blcodes) blcodes = bl_codes_bound(dused);
+    return data + lengths + dlengths + 5 + 5 + 4 + 3 * (ulg)blcodes;
+}
+
+/* ===========================================================================
+ * Whether the current block goes out with the static trees (or stored)
+ * without the dynamic trees being built: always for Z_QUICK and Z_FIXED,
+ * and for a small block when even the least the dynamic trees could take
+ * is no shorter, so the choice is the one build_tree() would lead to.
+ * Sets static_len.
+ */
+local int static_trees_win(deflate_state *s) {
+#ifdef LIT_MEM
+    uInt syms = s->sym_next;
+#else
+    uInt syms = s->sym_next / 3;
+#endif
+    ulg len;
+
+    if (s->strategy == Z_QUICK || s->strategy == Z_FIXED) {
+        s->static_len = static_block_len(s);
+        return 1;
+    }
+    if (syms > SMALL_BLOCK || dynamic_block_bound(s, &len) < len)
+        return 0;
+    s->static_len = len;    /* else left for build_tree() to sum */
+    return 1;
+}
+
 /* ===========================================================================
  * Determine the best encoding for the current block: dynamic trees, static
- * trees or store, and write out the encoded block.
+ * trees or store, and write out the encoded block. The dynamic trees are
+ * only built when static_trees_win() cannot rule them out.
  */
 void ZLIB_INTERNAL _tr_flush_block(deflate_state *s, charf *buf,
                                    ulg stored_len, int last) {
     ulg opt_lenb, static_lenb; /* opt_len and static_len in bytes */
     int max_blindex = 0;  /* index of last bit length code of non zero freq */
+    ZSTATS_BEGIN(ZSTATS_FLUSH_BLOCK);
+
+    if (s->level > 0 && static_trees_win(s)) {
+
+        if (s->strm->data_type == Z_UNKNOWN)
+            s->strm->data_type = detect_data_type(s);
+
+        opt_lenb = static_lenb = (s->static_len + 3 + 7) >> 3;
 
     /* Build the Huffman trees unless a stored block is forced */
-    if (s->level > 0) {
+    } else if (s->level > 0) {
 
         /* Check if the file is binary or text */
         if (s->strm->data_type == Z_UNKNOWN)
@@ -1086,6 +1340,7 @@ void ZLIB_INTERNAL _tr_flush_block(deflate_state *s, charf *buf,
     }
     Tracev((stderr,"\ncomprlen %lu(%lu) ", s->compressed_len >> 3,
            s->compressed_len - 7*last));
+    ZSTATS_END(ZSTATS_FLUSH_BLOCK, stored_len);
 }
 
 /* ===========================================================================
@@ -58,6 +58,7 @@
 #  define deflateResetKeep      z_deflateResetKeep
 #  define deflateSetDictionary  z_deflateSetDictionary
 #  define deflateSetHeader      z_deflateSetHeader
+#  define deflateSymbolBits     z_deflateSymbolBits
 #  define deflateTune           z_deflateTune
 #  define deflateUsed           z_deflateUsed
 #  define deflate_copyright     z_deflate_copyright
@@ -85,6 +86,8 @@
 #    define gzoffset64            z_gzoffset64
 #    define gzopen                z_gzopen
 #    define gzopen64              z_gzopen64
+#    define gzopen_io             z_gzopen_io
+#    define gzopen_mem            z_gzopen_mem
 #    ifdef _WIN32
 #      define gzopen_w              z_gzopen_w
 #    endif
@@ -151,6 +154,7 @@
 #    define gzFile                z_gzFile
 #  endif
 #  define gz_header             z_gz_header
+#  define gz_io                 z_gz_io
 #  define gz_headerp            z_gz_headerp
 #  define in_func               z_in_func
 #  define intf                  z_intf
@@ -165,6 +169,7 @@
 
 /* all zlib structs in zlib.h and zconf.h */
 #  define gz_header_s           z_gz_header_s
+#  define gz_io_s               z_gz_io_s
 #  define internal_state        z_internal_state
 
 #endif
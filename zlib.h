@@ -194,6 +194,7 @@ typedef gz_header FAR *gz_headerp;
 #define Z_NO_COMPRESSION         0
 #define Z_BEST_SPEED             1
 #define Z_BEST_COMPRESSION       9
+#define Z_ULTRA_COMPRESSION     10
 #define Z_DEFAULT_COMPRESSION  (-1)
 /* compression levels */
 
@@ -201,6 +202,8 @@ typedef gz_header FAR *gz_headerp;
 #define Z_HUFFMAN_ONLY        2
 #define Z_RLE                 3
 #define Z_FIXED               4
+#define Z_QUICK               5
+#define Z_MEDIUM              6
 #define Z_DEFAULT_STRATEGY    0
 /* compression strategy; see deflateInit2() below for details */
 
@@ -240,7 +243,11 @@ ZEXTERN int ZEXPORT deflateInit(z_streamp strm, int level);
    1 gives best speed, 9 gives best compression, 0 gives no compression at all
    (the input data is simply copied a block at a time).  Z_DEFAULT_COMPRESSION
    requests a default compromise between speed and compression (currently
-   equivalent to level 6).
+   equivalent to level 6).  Z_ULTRA_COMPRESSION (10) goes beyond level 9 for
+   data compressed once and served many times: each block is parsed
+   repeatedly for the cheapest sequence of matches under the codes the last
+   parse would get, typically several percent smaller than level 9 at a small
+   fraction of its speed.  It is best given the whole input at once.
 
      deflateInit returns Z_OK if success, Z_MEM_ERROR if there was not enough
    memory, Z_STREAM_ERROR if level is not a valid compression level, or
@@ -605,7 +612,17 @@ ZEXTERN int ZEXPORT deflateInit2(z_streamp strm,
    never the correctness of the compressed output, even if it is not set
    optimally for the given data.  Z_FIXED uses the default string matching, but
    prevents the use of dynamic Huffman codes, allowing for a simpler decoder
-   for special applications.
+   for special applications.  Z_QUICK trades ratio for speed: each position is
+   checked against only the most recent string with the same hash, matches are
+   taken without lazy evaluation or hash insertion, and blocks are sent with
+   the fixed codes (or stored when that is smaller).  It sits between level 0
+   and level 1 with Z_DEFAULT_STRATEGY, and is the same for every level from 1
+   to 9.  Z_MEDIUM takes the first match found at each position, with the
+   level's chain length, and skips the lazy evaluation of the next position
+   that levels 4 to 9 normally do.  Before a match is sent, the match that
+   follows it is looked up, and it takes over the current one when it can be
+   extended back over all of it.  At levels 5 and 6 this compresses about as
+   well as Z_DEFAULT_STRATEGY in three quarters of the time.
 
      deflateInit2 returns Z_OK if success, Z_MEM_ERROR if there was not enough
    memory, Z_STREAM_ERROR if any parameter is invalid (such as an invalid
@@ -765,6 +782,25 @@ ZEXTERN int ZEXPORT deflateTune(z_streamp strm,
    returns Z_OK on success, or Z_STREAM_ERROR for an invalid deflate stream.
  */
 
+ZEXTERN int ZEXPORT deflateSymbolBits(z_streamp strm,
+                                      int bits);
+/*
+     deflateSymbolBits() sizes the buffer deflate collects symbols in before
+   it emits a block to 1 << bits symbols, instead of the 1 << (memLevel + 6)
+   deflateInit2() chose.  The pending output buffer shares its memory, so the
+   two together take four bytes per symbol: 64K at the default memLevel of 8.
+   A smaller buffer saves memory at the cost of more, shorter blocks, which
+   compress slightly worse; the hash table, and so the speed of the match
+   search, still follow memLevel.  bits must be in 7..15.  The size stays
+   through deflateReset().
+
+     deflateSymbolBits() must be called after deflateInit2() or deflateReset()
+   and before the first deflate() call.  It returns Z_OK on success,
+   Z_MEM_ERROR if the new buffer could not be allocated, in which case the
+   stream is unchanged, or Z_STREAM_ERROR if the stream state was
+   inconsistent, bits was out of range, or deflate() had already been called.
+*/
+
 ZEXTERN uLong ZEXPORT deflateBound(z_streamp strm,
                                    uLong sourceLen);
 /*
@@ -1384,6 +1420,48 @@ ZEXTERN gzFile ZEXPORT gzdopen(int fd, const char *mode);
    will not detect if fd is invalid (unless fd is -1).
 */
 
+ZEXTERN gzFile ZEXPORT gzopen_mem(const void *buf, z_size_t len,
+                                  const char *mode);
+/*
+     Open the len bytes at buf for reading as though they were a gzip file,
+   typically a mapped file or a file's contents already in memory.  Reading
+   inflates straight from buf with no read() calls and no copy into an input
+   buffer, and gzseek, gzrewind and gzoffset work within the region.  buf
+   must stay valid and unchanged until gzclose, which does not free it.  The
+   mode parameter is as in gzopen, but must be for reading.
+
+     gzopen_mem returns NULL if there was insufficient memory to allocate the
+   gzFile state, if mode was invalid or not for reading, or if buf is NULL
+   and len is not zero.
+*/
+
+typedef struct gz_io_s {
+    void *opaque;           /* passed to each function */
+    int (*read)(void *opaque, void *buf, unsigned len);
+    int (*write)(void *opaque, const void *buf, unsigned len);
+    z_off64_t (*seek)(void *opaque, z_off64_t offset, int whence);
+    int (*close)(void *opaque);
+} gz_io;
+
+ZEXTERN gzFile ZEXPORT gzopen_io(const gz_io *io, const char *mode);
+/*
+     Open a gzip file whose I/O is done by the functions in io instead of
+   read(), write(), lseek() and close() on a descriptor, for storage that has
+   no descriptor, such as a browser's file handles.  Each function behaves as
+   the system call it replaces: read returns the number of bytes read (zero at
+   the end of the file) and write the number written, or -1 on an error; seek
+   takes a whence of SEEK_SET, SEEK_CUR or SEEK_END and returns the new offset
+   or -1; close returns 0 or -1, and is called once by gzclose.  write is not
+   used when reading, and read is not used when writing.  Nothing is created
+   or truncated: writing starts wherever seek stands, or at the end for "a".
+   io is copied, so it need not outlive the call.  The mode parameter is as
+   in gzopen.
+
+     gzopen_io returns NULL if there was insufficient memory to allocate the
+   gzFile state, if mode was invalid, or if io or a function the mode needs is
+   NULL.  close is not called when gzopen_io fails.
+*/
+
 ZEXTERN int ZEXPORT gzbuffer(gzFile file, unsigned size);
 /*
      Set the internal buffer size used by this library's functions for file to
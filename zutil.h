@@ -239,6 +239,16 @@ extern z_const char * const z_errmsg[10]; /* indexed by 2-zlib_error */
 #  define Tracecv(c,x)
 #endif
 
+/* Hot-path instrumentation for the zlib.wasm stats build */
+#ifdef ZLIB_WASM_STATS
+#  include "src/zlib_stats.h"
+#else
+#  define ZSTATS_BEGIN(id)
+#  define ZSTATS_END(id, n)
+#  define ZSTATS_BYTES(id, n)
+#  define ZSTATS_CHAIN(probes)
+#endif
+
 #ifndef Z_SOLO
    voidpf ZLIB_INTERNAL zcalloc(voidpf opaque, unsigned items,
                                 unsigned size);